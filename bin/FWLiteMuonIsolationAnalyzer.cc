@@ -40,7 +40,7 @@
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
 
 #include "TauAnalysis/TauIdEfficiency/interface/MuonIsolationHistManager.h"
-#include "TauAnalysis/RecoTools/interface/PATObjectLUTvalueExtractorFromKNN.h"
+#include "TauAnalysis/TauIdEfficiency/interface/PATMuonLUTvalueGridFromKNN.h"
 
 #include <TFile.h>
 #include <TTree.h>
@@ -70,28 +70,24 @@ double getUserFloat(const T& lepton, const std::string& userFloatName)
 struct histManagerEntryType
 {
   histManagerEntryType(const edm::ParameterSet& cfg, 
-		       const std::string& triggerPath, double muonIsoThreshold_loose, double muonIsoThreshold_tight)
+		       const std::string& triggerPath, double muonIsoThreshold_loose, double muonIsoThreshold_tight,
+		       PATMuonLUTvalueGridFromKNN* muonIsoProbExtractor)
     : triggerPath_(triggerPath),
       muonIsoThreshold_loose_(muonIsoThreshold_loose),
       muonIsoThreshold_tight_(muonIsoThreshold_tight),
       histManager_all_weighted_(0),
-      muonIsoProbExtractor_(0),
+      muonIsoProbExtractor_(muonIsoProbExtractor),
       ntuple_(0)
   {
     histManager_all_ = new MuonIsolationHistManager(cfg);
     histManager_passed_ = new MuonIsolationHistManager(cfg);
     histManager_failed_ = new MuonIsolationHistManager(cfg);
 
-    if ( cfg.exists("muonIsoProbExtractor") ) {
-      edm::ParameterSet cfgMuonIsoProbExtractor = cfg.getParameter<edm::ParameterSet>("muonIsoProbExtractor");
-      muonIsoProbExtractor_ = new PATMuonLUTvalueExtractorFromKNN(cfgMuonIsoProbExtractor);
+    if ( muonIsoProbExtractor_ ) {
       histManager_all_weighted_ = new MuonIsolationHistManager(cfg);
     }
   }
-  ~histManagerEntryType() 
-  {
-    delete muonIsoProbExtractor_;
-  }
+  ~histManagerEntryType() {}
   void bookHistograms(TFileDirectory& dir)
   {
     std::string subdirectory = Form("%s_loose%02.0f_tight%02.0f", triggerPath_.data(), muonIsoThreshold_loose_*10., muonIsoThreshold_tight_*10.);
@@ -160,7 +156,7 @@ struct histManagerEntryType
   MuonIsolationHistManager* histManager_failed_;
 
   MuonIsolationHistManager* histManager_all_weighted_;
-  PATMuonLUTvalueExtractorFromKNN* muonIsoProbExtractor_;
+  PATMuonLUTvalueGridFromKNN* muonIsoProbExtractor_; // shared by all histManagerEntries, not owned
 
   TTree* ntuple_;
   Float_t muonPt_;
@@ -216,9 +212,12 @@ int main(int argc, char* argv[])
 //--- book histograms
   TFileDirectory dir = ( directory != "" ) ? fs.mkdir(directory) : fs;
   edm::ParameterSet cfgMuonIsolationHistManager;
+//--- CV: k-NN look-up table is loaded once and shared by all histManagerEntries,
+//        so that muon isolation probability is computed once per event
+  PATMuonLUTvalueGridFromKNN* muonIsoProbExtractor = 0;
   if ( cfgMuonIsolationAnalyzer.exists("muonIsoProbExtractor") ) {
     edm::ParameterSet cfgMuonIsoProbExtractor = cfgMuonIsolationAnalyzer.getParameter<edm::ParameterSet>("muonIsoProbExtractor");
-    cfgMuonIsolationHistManager.addParameter<edm::ParameterSet>("muonIsoProbExtractor", cfgMuonIsoProbExtractor);
+    muonIsoProbExtractor = new PATMuonLUTvalueGridFromKNN(cfgMuonIsoProbExtractor);
   }
   std::vector<histManagerEntryType*> histManagerEntries;
   vstring triggerPaths = cfgMuonIsolationAnalyzer.getParameter<vstring>("triggerPaths");
@@ -231,7 +230,7 @@ int main(int argc, char* argv[])
       for ( vdouble::const_iterator muonIsoThreshold_tight = muonIsoThresholds_tight.begin();
 	    muonIsoThreshold_tight != muonIsoThresholds_tight.end(); ++muonIsoThreshold_tight ) {
 	histManagerEntryType* histManagerEntry = 
-	  new histManagerEntryType(cfgMuonIsolationHistManager, *triggerPath, *muonIsoThreshold_loose, *muonIsoThreshold_tight);
+	  new histManagerEntryType(cfgMuonIsolationHistManager, *triggerPath, *muonIsoThreshold_loose, *muonIsoThreshold_tight, muonIsoProbExtractor);
 	histManagerEntry->bookHistograms(dir);
 	histManagerEntries.push_back(histManagerEntry);
       }
@@ -325,6 +324,7 @@ int main(int argc, char* argv[])
       evt.getByLabel(srcVertices, vertices);
       size_t numVertices = vertices->size();
 
+      if ( muonIsoProbExtractor ) muonIsoProbExtractor->beginEvent();
       for ( std::vector<histManagerEntryType*>::iterator histManagerEntry = histManagerEntries.begin();
 	    histManagerEntry != histManagerEntries.end(); ++histManagerEntry ) {
 	(*histManagerEntry)->fillHistograms(*bestMuTauPair, numVertices, evtWeight);
@@ -340,6 +340,9 @@ int main(int argc, char* argv[])
     delete (*it);
   }
 
+  if ( muonIsoProbExtractor ) muonIsoProbExtractor->print(std::cout);
+  delete muonIsoProbExtractor;
+
   std::cout << "<FWLiteMuonIsolationAnalyzer>:" << std::endl;
   std::cout << " numEvents_processed: " << numEvents_processed 
 	    << " (weighted = " << numEventsWeighted_processed << ")" << std::endl;
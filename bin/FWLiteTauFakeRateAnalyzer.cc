@@ -47,6 +47,9 @@
 
 #include "TauAnalysis/TauIdEfficiency/interface/TauFakeRateEventSelector.h"
 #include "TauAnalysis/TauIdEfficiency/interface/TauFakeRateHistManager.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TriggerPrescaleProbabilityCache.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffCheckpoint.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffLumiMask.h"
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
 
 #include <TFile.h>
@@ -54,6 +57,7 @@
 #include <TSystem.h>
 #include <TROOT.h>
 #include <TBenchmark.h>
+#include <TString.h>
 
 typedef std::vector<std::string> vstring;
 typedef StringCutObjectSelector<pat::Tau> StringCutPatTauSelector;
@@ -62,7 +66,7 @@ struct regionEntryType
 {
   regionEntryType(TFileDirectory& dir,
 		  const std::string& process, const std::string& region, 
-		  const vstring& tauIdDiscriminators, const std::string& tauIdName)
+		  const vstring& tauIdDiscriminators, const std::string& tauIdName, bool writeHistogramBundle)
     : process_(process),
       region_(region),
       tauIdDiscriminators_(tauIdDiscriminators),
@@ -87,6 +91,7 @@ struct regionEntryType
     cfgHistManager.addParameter<std::string>("process", process_);
     cfgHistManager.addParameter<std::string>("region", region_);
     cfgHistManager.addParameter<std::string>("tauIdDiscriminator", tauIdName_);
+    cfgHistManager.addParameter<bool>("writeHistogramBundle", writeHistogramBundle);
 
     histograms_ = new TauFakeRateHistManager(cfgHistManager);
     histograms_->bookHistograms(dir);
@@ -97,13 +102,15 @@ struct regionEntryType
 
     delete histograms_;
   }
-  void analyze(const pat::Tau& tauJetCand, size_t numVertices, double sumEt, double evtWeight)
+  void analyze(const pat::Tau& tauJetCand, bool tauIdDiscriminators_passed, size_t numVertices, double sumEt, double evtWeight)
   {
     ++numTauJetCands_processed_;
     numTauJetCandsWeighted_processed_ += evtWeight;
 
-    pat::strbitset evtSelFlags;   
-    if ( selector_->operator()(tauJetCand, evtSelFlags) ) {
+//--- preselection and tau id. discriminators have already been evaluated
+//    once per tau-jet candidate (and are shared by all regions);
+//    apply region specific requirements only
+    if ( selector_->passesRegion(tauIdDiscriminators_passed) ) {
       //if      ( region_ == "P" ) std::cout << " passes tauId." << std::endl;
       //else if ( region_ == "F" ) std::cout << " fails tauId." << std::endl;
 
@@ -129,6 +136,56 @@ struct regionEntryType
   double numTauJetCandsWeighted_selected_;
 };
 
+struct tauIdEntryType
+{
+  tauIdEntryType(const vstring& tauIdDiscriminators, const std::string& tauIdName)
+    : tauIdDiscriminators_(tauIdDiscriminators),
+      tauIdName_(tauIdName),
+      selector_(0)
+  {
+    edm::ParameterSet cfgSelector;
+    cfgSelector.addParameter<vstring>("tauIdDiscriminators", tauIdDiscriminators_);
+    cfgSelector.addParameter<std::string>("region", "A");
+
+    selector_ = new TauFakeRateEventSelector(cfgSelector);
+  }
+  ~tauIdEntryType()
+  {
+    delete selector_;
+  }
+  void analyze(const pat::Tau& tauJetCand, size_t numVertices, double sumEt, double evtWeight)
+  {
+//--- evaluate tau id. discriminators once per tau-jet candidate,
+//    for all regions using the same tau id. discriminators
+    bool tauIdDiscriminators_passed = selector_->passesTauIdDiscriminators(tauJetCand);
+
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries_.begin();
+	  regionEntry != regionEntries_.end(); ++regionEntry ) {
+      (*regionEntry)->analyze(tauJetCand, tauIdDiscriminators_passed, numVertices, sumEt, evtWeight);
+    }
+  }
+
+  vstring tauIdDiscriminators_;
+  std::string tauIdName_;
+
+  TauFakeRateEventSelector* selector_;
+
+  std::vector<regionEntryType*> regionEntries_;
+};
+
+//
+// Check if any luminosity section contained in input file passes run-range and luminosity section selection;
+// the check uses the LuminosityBlocks tree only, without reading any event data
+//
+bool isSelectedInputFile(TFile* inputFile, const TauIdEffLumiMask& lumiMask)
+{
+  fwlite::LuminosityBlock ls(inputFile);
+  for ( ls.toBegin(); !ls.atEnd(); ++ls ) {
+    if ( lumiMask(ls.id().run(), ls.id().luminosityBlock()) ) return true;
+  }
+  return false;
+}
+
 int main(int argc, char* argv[]) 
 {
 //--- parse command-line arguments
@@ -171,11 +228,31 @@ int main(int argc, char* argv[])
   int verbosity = ( cfgTauFakeRateAnalyzer.exists("verbosity") ) ? 
     cfgTauFakeRateAnalyzer.getParameter<int>("verbosity") : 0;
 
+  bool writeHistogramBundles = ( cfgTauFakeRateAnalyzer.exists("writeHistogramBundles") ) ? 
+    cfgTauFakeRateAnalyzer.getParameter<bool>("writeHistogramBundles") : false;
+
+  TriggerPrescaleProbabilityCache* prescaleProbabilityCache = new TriggerPrescaleProbabilityCache(hltPaths, verbosity);
+
+//--- write checkpoints at the end of each input file and every 'checkpointInterval' events (optional),
+//    in order to resume job from last checkpoint in case it gets killed before completion
+  std::string checkpointFileName = ( cfgTauFakeRateAnalyzer.exists("checkpointFileName") ) ?
+    cfgTauFakeRateAnalyzer.getParameter<std::string>("checkpointFileName") : "";
+  int checkpointInterval = ( cfgTauFakeRateAnalyzer.exists("checkpointInterval") ) ?
+    cfgTauFakeRateAnalyzer.getParameter<int>("checkpointInterval") : 0;
+
   fwlite::InputSource inputFiles(cfg); 
+  edm::ParameterSet cfgInputSource = cfg.getParameter<edm::ParameterSet>("fwliteInput");
+  int firstRun = ( cfgInputSource.exists("firstRun") ) ?
+    cfgInputSource.getParameter<int>("firstRun") : -1;
+  int lastRun = ( cfgInputSource.exists("lastRun") ) ?
+    cfgInputSource.getParameter<int>("lastRun") : -1;
+  std::string lumiMaskFileName = ( cfgInputSource.exists("lumiMaskFileName") ) ?
+    cfgInputSource.getParameter<std::string>("lumiMaskFileName") : "";
+  TauIdEffLumiMask lumiMask(lumiMaskFileName, firstRun, lastRun);
   int maxEvents = inputFiles.maxEvents();
 
   fwlite::OutputFiles outputFile(cfg);
-  fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
+  fwlite::TFileService* fs = new fwlite::TFileService(outputFile.file().data());
 
 //--- initialize selections and histograms
 //    for P(assed)/F(ailed) and A(ll) regions
@@ -187,19 +264,37 @@ int main(int argc, char* argv[])
   std::cout << " type = " << processType << std::endl;
   bool isData = (processType == "Data");
   std::string evtSel = cfgTauFakeRateAnalyzer.getParameter<std::string>("evtSel");
-  TFileDirectory dir = fs.mkdir(evtSel);
+  TFileDirectory dir = fs->mkdir(evtSel);
   vstring regions = cfgTauFakeRateAnalyzer.getParameter<vstring>("regions");
   typedef std::vector<edm::ParameterSet> vParameterSet;
   vParameterSet cfgTauIdDiscriminators = cfgTauFakeRateAnalyzer.getParameter<vParameterSet>("tauIds");
+  std::vector<tauIdEntryType*> tauIdEntries;
   for ( vParameterSet::const_iterator cfgTauIdDiscriminator = cfgTauIdDiscriminators.begin();
 	cfgTauIdDiscriminator != cfgTauIdDiscriminators.end(); ++cfgTauIdDiscriminator ) {
+    vstring tauIdDiscriminators = cfgTauIdDiscriminator->getParameter<vstring>("discriminators");
+    std::string tauIdName = cfgTauIdDiscriminator->getParameter<std::string>("name");
+    tauIdEntryType* tauIdEntry = new tauIdEntryType(tauIdDiscriminators, tauIdName);
     for ( vstring::const_iterator region = regions.begin();
 	  region != regions.end(); ++region ) {
-      vstring tauIdDiscriminators = cfgTauIdDiscriminator->getParameter<vstring>("discriminators");
-      std::string tauIdName = cfgTauIdDiscriminator->getParameter<std::string>("name");
-      regionEntryType* regionEntry = new regionEntryType(dir, process, *region, tauIdDiscriminators, tauIdName);
+      regionEntryType* regionEntry = new regionEntryType(dir, process, *region, tauIdDiscriminators, tauIdName, writeHistogramBundles);
       regionEntries.push_back(regionEntry);
+      tauIdEntry->regionEntries_.push_back(regionEntry);
     }
+    tauIdEntries.push_back(tauIdEntry);
+  }
+
+//--- Pt and eta cuts and preselection criteria are the same for all regions and tau id. discriminators;
+//    evaluate them once per tau-jet candidate
+  edm::ParameterSet cfgPreselector;
+  cfgPreselector.addParameter<vstring>("tauIdDiscriminators", vstring());
+  cfgPreselector.addParameter<std::string>("region", "A");
+  TauFakeRateEventSelector* preselector = new TauFakeRateEventSelector(cfgPreselector);
+  for ( std::vector<regionEntryType*>::const_iterator regionEntry = regionEntries.begin();
+	regionEntry != regionEntries.end(); ++regionEntry ) {
+    if ( (*regionEntry)->selector_->getPreselCriteria() != preselector->getPreselCriteria() )
+      throw cms::Exception("FWLiteTauFakeRateAnalyzer") 
+	<< "Preselection criteria of region = " << (*regionEntry)->region_ << ", tauId = " << (*regionEntry)->tauIdName_ 
+	<< " differ from common preselection --> cannot share preselection between regions !!\n";
   }
   std::vector<StringCutPatTauSelector*> tauJetCandSelection;
   vstring tauJetCandSelection_string = cfgTauFakeRateAnalyzer.getParameter<vstring>("tauJetCandSelection");
@@ -209,7 +304,7 @@ int main(int argc, char* argv[])
   }
 
 //--- book "dummy" histogram counting number of processed events
-  TH1* histogramEventCounter = fs.make<TH1F>("numEventsProcessed", "Number of processed Events", 3, -0.5, +2.5);
+  TH1* histogramEventCounter = fs->make<TH1F>("numEventsProcessed", "Number of processed Events", 3, -0.5, +2.5);
   histogramEventCounter->GetXaxis()->SetBinLabel(1, "all Events (DBS)");      // CV: bin numbers start at 1 (not 0) !!
   histogramEventCounter->GetXaxis()->SetBinLabel(2, "processed by Skimming");
   histogramEventCounter->GetXaxis()->SetBinLabel(3, "analyzed in PAT-tuple");
@@ -238,9 +333,43 @@ int main(int argc, char* argv[])
   double intLumiData_analyzed = 0.;
   edm::InputTag srcLumiProducer = cfgTauFakeRateAnalyzer.getParameter<edm::InputTag>("srcLumiProducer");
 
-  bool maxEvents_processed = false;
+//--- save histograms and event counters periodically (optional),
+//    so that job can be resumed in case it gets killed before completion
+  TauIdEffCheckpoint* checkpoint = 0;
+  unsigned idxInputFile_resume = 0;
+  long numEvents_resume = 0;
+  if ( checkpointFileName != "" ) {
+    if ( selEventsFileName != "" ) {
+      std::cout << "Warning: selEventsFileName = " << selEventsFileName << " --> disabling checkpoints !!" << std::endl;
+    } else {
+      checkpoint = new TauIdEffCheckpoint(checkpointFileName, cfg.toString(), &fs->file(), checkpointInterval);
+      checkpoint->addCounter("numEvents_processed", &numEvents_processed);
+      checkpoint->addCounter("numEventsWeighted_processed", &numEventsWeighted_processed);
+      checkpoint->addCounter("numEvents_passedTrigger", &numEvents_passedTrigger);
+      checkpoint->addCounter("numEventsWeighted_passedTrigger", &numEventsWeighted_passedTrigger);
+      checkpoint->addCounter("intLumiData_analyzed", &intLumiData_analyzed);
+      checkpoint->addCounter("lastLumiBlock_run", &lastLumiBlock_run);
+      checkpoint->addCounter("lastLumiBlock_ls", &lastLumiBlock_ls);
+      for ( size_t idxRegionEntry = 0; idxRegionEntry < regionEntries.size(); ++idxRegionEntry ) {
+	regionEntryType* regionEntry = regionEntries[idxRegionEntry];
+	std::string counterName = Form("%s_%s", regionEntry->tauIdName_.data(), regionEntry->region_.data());
+	checkpoint->addCounter(std::string(counterName).append("_numTauJetCands_processed"), &regionEntry->numTauJetCands_processed_);
+	checkpoint->addCounter(std::string(counterName).append("_numTauJetCandsWeighted_processed"), &regionEntry->numTauJetCandsWeighted_processed_);
+	checkpoint->addCounter(std::string(counterName).append("_numTauJetCands_selected"), &regionEntry->numTauJetCands_selected_);
+	checkpoint->addCounter(std::string(counterName).append("_numTauJetCandsWeighted_selected"), &regionEntry->numTauJetCandsWeighted_selected_);
+      }
+      if ( checkpoint->resume(idxInputFile_resume, numEvents_resume) ) 
+	std::cout << "resuming job from checkpoint: inputFile #" << idxInputFile_resume << ", event #" << numEvents_resume << std::endl;
+    }
+  }
+
+  bool maxEvents_processed = ( maxEvents > 0 && numEvents_processed >= maxEvents );
+  unsigned idxInputFile = 0;
   for ( vstring::const_iterator inputFileName = inputFiles.files().begin();
-	inputFileName != inputFiles.files().end() && !maxEvents_processed; ++inputFileName ) {
+	inputFileName != inputFiles.files().end() && !maxEvents_processed; ++inputFileName, ++idxInputFile ) {
+
+//--- skip input files processed completely before job got interrupted
+    if ( idxInputFile < idxInputFile_resume ) continue;
 
 //--- open input file
     TFile* inputFile = TFile::Open(inputFileName->data());
@@ -253,8 +382,28 @@ int main(int argc, char* argv[])
     if ( tree ) std::cout << " (" << tree->GetEntries() << " Events)";
     std::cout << std::endl;
 
+//--- skip input files which contain no luminosity section passing run-range and luminosity section selection
+    if ( !lumiMask.isEmpty() && !isSelectedInputFile(inputFile, lumiMask) ) {
+      std::cout << "no selected luminosity sections in inputFile = " << (*inputFileName) << " --> skipping." << std::endl;
+      delete inputFile;
+      if ( checkpoint ) checkpoint->write(idxInputFile + 1, 0);
+      continue;
+    }
+
     fwlite::Event evt(inputFile);
-    for ( evt.toBegin(); !(evt.atEnd() || maxEvents_processed); ++evt ) {
+    long numEvents_inputFile = 0;
+    evt.toBegin();
+    if ( idxInputFile == idxInputFile_resume && numEvents_resume > 0 ) {
+      evt.to(numEvents_resume);
+      numEvents_inputFile = numEvents_resume;
+    }
+    for ( ; !(evt.atEnd() || maxEvents_processed); ++evt, ++numEvents_inputFile ) {
+
+      if ( checkpoint && checkpoint->isDue(numEvents_inputFile) ) checkpoint->write(idxInputFile, numEvents_inputFile);
+
+//--- check if current event is within specified run-range and certified luminosity sections
+//   (done before any event data is read, only the event auxiliary information is needed)
+      if ( !lumiMask(evt.id().run(), evt.luminosityBlock()) ) continue;
 
       if ( verbosity ) 
 	std::cout << "processing run = " << evt.id().run() << ":" 
@@ -302,63 +451,13 @@ int main(int argc, char* argv[])
 //        weight Data events by probability to pass trigger prescales.
 //        Note that this assumes that the prescales of all HLT paths are uncorrelated
 //       (assumption is not valid in case HLT paths share L1 conditions and those L1 conditions are prescaled)
-//     
+//        The prescales are looked-up once per luminosity section and cached.
+//
       edm::Handle<pat::TriggerEvent> hltEvent;
       evt.getByLabel(srcTrigger, hltEvent);
   
-      bool isTriggered = false;
       double probFailedPrescale = 1.;
-      for ( vstring::const_iterator hltPathName = hltPaths.begin();
-	    hltPathName != hltPaths.end() && !isTriggered; ++hltPathName ) {
-	if ( verbosity ) std::cout << "hltPathName = " << (*hltPathName) << std::endl;
-	if ( (*hltPathName) == "*" ) { // check for wildcard character "*" that accepts all events
-	  isTriggered = true;
-	  probFailedPrescale = 0.;
-	  break;
-	} else {
-	  const pat::TriggerPath* hltPath = hltEvent->path(*hltPathName);
-	  if ( hltPath && hltPath->wasAccept() ) {
-	    isTriggered = true;
-	    unsigned hltPrescale = hltPath->prescale();
-	    if ( hltPrescale < 1 ) hltPrescale = 1;
-	    if ( verbosity ) std::cout << "HLT path = " << hltPath->name() << ": prescale = " << hltPrescale << std::endl;
-	    double probFailedL1Prescale = 1.;
-	    const pat::L1SeedCollection& l1Seeds = hltPath->l1Seeds();
-	    for ( pat::L1SeedCollection::const_iterator l1Seed_status = l1Seeds.begin();
-		  l1Seed_status != l1Seeds.end(); ++l1Seed_status ) {
-	      const std::string& l1SeedName = l1Seed_status->second;
-	      if ( verbosity ) std::cout << "l1SeedName = " << l1SeedName << std::endl;	      
-	      const pat::TriggerAlgorithm* l1Seed = hltEvent->algorithm(l1SeedName);
-	      if ( !l1Seed ) {
-		if ( verbosity ) 
-		  std::cout << "Failed to access L1 seed = " << l1SeedName << "," 
-			    << " needed for HLT path = " << hltPath->name() << " !!" << std::endl;
-		vstring l1SeedNames;
-		const pat::TriggerAlgorithmCollection* l1Seeds = hltEvent->algorithms();
-		if ( l1Seeds ) {
-		  for ( pat::TriggerAlgorithmCollection::const_iterator l1Seed = l1Seeds->begin();
-			l1Seed != l1Seeds->end(); ++l1Seed ) {
-		    l1SeedNames.push_back(l1Seed->name());
-		  }
-		  if ( verbosity ) std::cout << "Available L1 seeds = " << format_vstring(l1SeedNames) << std::endl;
-		} else {
-		  if ( verbosity ) std::cout << "No L1 seeds available in pat::TriggerEvent !!" << std::endl;
-		}
-		continue;
-	      }
-	      bool l1Passed = l1Seed->gtlResult();
-	      if ( l1Passed ) {
-		unsigned l1Prescale = l1Seed->prescale();
-		if ( l1Prescale < 1 ) l1Prescale = 1;
-		if ( verbosity ) std::cout << " L1 seed = " << l1Seed->name() << ": prescale = " << l1Prescale << std::endl;
-		if ( l1Prescale <= 1 ) probFailedL1Prescale = 0.;
-		else probFailedL1Prescale *= (1. - 1./l1Prescale);
-	      }
-	    }
-	    probFailedPrescale *= (1. - (1./hltPrescale)*(1. - probFailedL1Prescale));
-	  }
-	}
-      }
+      bool isTriggered = (*prescaleProbabilityCache)(evt.id().run(), evt.luminosityBlock(), *hltEvent, probFailedPrescale);
       
       if ( !isTriggered ) continue;
       ++numEvents_passedTrigger;
@@ -412,9 +511,21 @@ int main(int argc, char* argv[])
 
 	if ( !passesTauJetCandSelection ) continue;
 
-	for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
-	      regionEntry != regionEntries.end(); ++regionEntry ) {
-	  (*regionEntry)->analyze(*tauJetCand, numVertices, sumEt, evtWeight);
+	bool passesTauJetCandPreselection = preselector->passesPreselection(*tauJetCand);
+
+	for ( std::vector<tauIdEntryType*>::iterator tauIdEntry = tauIdEntries.begin();
+	      tauIdEntry != tauIdEntries.end(); ++tauIdEntry ) {
+	  if ( passesTauJetCandPreselection ) {
+	    (*tauIdEntry)->analyze(*tauJetCand, numVertices, sumEt, evtWeight);
+	  } else {
+	    // CV: count tau-jet candidates failing preselection as processed by each region,
+	    //     in order to keep numTauJetCands_processed unchanged
+	    for ( std::vector<regionEntryType*>::iterator regionEntry = (*tauIdEntry)->regionEntries_.begin();
+		  regionEntry != (*tauIdEntry)->regionEntries_.end(); ++regionEntry ) {
+	      ++(*regionEntry)->numTauJetCands_processed_;
+	      (*regionEntry)->numTauJetCandsWeighted_processed_ += evtWeight;
+	    }
+	  }
 	}
 
 	++idxTauJetCand;
@@ -426,6 +537,8 @@ int main(int argc, char* argv[])
 
 //--- close input file
     delete inputFile;
+
+    if ( checkpoint ) checkpoint->write(idxInputFile + 1, 0);
   }
 
 //--- scale histograms taken from Monte Carlo simulation
@@ -468,6 +581,21 @@ int main(int argc, char* argv[])
     lastTauIdName = (*regionEntry)->tauIdName_;
   }
   
+  delete preselector;
+
+  std::cout << " prescales looked-up for " << prescaleProbabilityCache->numLumiSectionsCached() << " luminosity sections." << std::endl;
+  delete prescaleProbabilityCache;
+
+  for ( std::vector<tauIdEntryType*>::iterator it = tauIdEntries.begin();
+	it != tauIdEntries.end(); ++it ) {
+    delete (*it);
+  }
+
+  for ( std::vector<regionEntryType*>::iterator it = regionEntries.begin();
+	it != regionEntries.end(); ++it ) {
+    delete (*it);
+  }
+  
   if ( isData ) {
     std::cout << " intLumiData (recorded, Trigger prescale corr.) = " << intLumiData << " pb" << std::endl;
     // CV: luminosity is recorded in some 'weird' units,
@@ -475,6 +603,16 @@ int main(int argc, char* argv[])
     std::cout << " intLumiData_analyzed (recorded) = " << intLumiData_analyzed*1.e-6*0.10 << " pb" << std::endl;
   }
 
+//--- write output file before removing checkpoint,
+//    so that job can be resumed from last checkpoint in case it gets killed while the output is written
+  delete fs;
+
+//--- job completed successfully, checkpoint no longer needed
+  if ( checkpoint ) {
+    checkpoint->remove();
+    delete checkpoint;
+  }
+
   clock.Show("FWLiteTauFakeRateAnalyzer");
 
   return 0;
@@ -41,14 +41,19 @@
 #include "DataFormats/Common/interface/MergeableCounter.h"
 #include "DataFormats/Luminosity/interface/LumiSummary.h"
 #include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/ValueMap.h"
 
 #include "PhysicsTools/JetMCUtils/interface/JetMCTag.h"
 #include "PhysicsTools/SelectorUtils/interface/PFJetIDSelectionFunctor.h"
 
 #include "TauAnalysis/TauIdEfficiency/interface/TauIdEffEventSelector.h"
 #include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistManager.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMiniTuple.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffResultCache.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffCheckpoint.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffLumiMask.h"
 #include "TauAnalysis/TauIdEfficiency/interface/tauIdEffAuxFunctions.h"
-#include "TauAnalysis/RecoTools/interface/PATObjectLUTvalueExtractorFromKNN.h"
+#include "TauAnalysis/TauIdEfficiency/interface/PATMuonLUTvalueGridFromKNN.h"
 
 #include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEt.h"
 #include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEtFwd.h"
@@ -59,10 +64,14 @@
 #include <TROOT.h>
 #include <TBenchmark.h>
 #include <TF1.h>
+#include <TString.h>
 
 #include <vector>
 #include <string>
+#include <set>
+#include <utility>
 #include <fstream>
+#include <algorithm>
 
 typedef std::vector<std::string> vstring;
 
@@ -110,29 +119,21 @@ struct histManagerEntryType
       histManagerGenTau_->bookHistograms(dir);
     }
   }
-  void fillHistograms(double x, const PATMuTauPair& muTauPair, const pat::MET& caloMEt, 
-		      size_t numJets, size_t numJets_bTagged,
-		      size_t numVertices, const std::map<std::string, bool>& plot_triggerBits_passed, int genMatchType, double weight)
+  void fillHistograms(double x, const TauIdEffMiniTupleEntry& muTauPair, double caloMEtPt, 
+		      const std::map<std::string, bool>& plot_triggerBits_passed, double weight)
   {
     if ( x > min_ && x <= max_ ) {
-      histManager_->fillHistograms(muTauPair, caloMEt, 
-				   numJets, numJets_bTagged, 
-				   numVertices, plot_triggerBits_passed, weight);
+      histManager_->fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, weight);
 
       if ( fillGenMatchHistograms_ ) {
+	int genMatchType = muTauPair.genMatchType_;
 	if      ( genMatchType == kJetToTauFakeMatched ) 
-	  histManagerJetToTauFake_->fillHistograms(muTauPair, caloMEt, 
-						   numJets, numJets_bTagged, 
-						   numVertices, plot_triggerBits_passed, weight);
+	  histManagerJetToTauFake_->fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, weight);
 	else if ( genMatchType == kMuToTauFakeMatched  ) 
-	  histManagerMuToTauFake_->fillHistograms(muTauPair, caloMEt, 
-						  numJets, numJets_bTagged, 
-						  numVertices, plot_triggerBits_passed, weight);
+	  histManagerMuToTauFake_->fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, weight);
 	else if ( genMatchType == kGenTauHadMatched    ||
 		  genMatchType == kGenTauOtherMatched  ) 
-	  histManagerGenTau_->fillHistograms(muTauPair, caloMEt, 
-					     numJets, numJets_bTagged, 
-					     numVertices, plot_triggerBits_passed, weight);
+	  histManagerGenTau_->fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, weight);
       }
     }
   }
@@ -158,7 +159,7 @@ struct regionEntryType
 		  const vstring& tauIdDiscriminators, const std::string& tauIdName, const std::string& sysShift,
 		  const edm::ParameterSet& cfgBinning, const std::string& svFitMassHypothesis, 
 		  const std::string& tauChargeMode, bool disableTauCandPreselCuts, const edm::ParameterSet& cfgEventSelCuts, 
-		  bool fillGenMatchHistograms, bool fillControlPlots, const vstring& plot_triggerBits,
+		  bool fillGenMatchHistograms, bool fillControlPlots, bool writeHistogramBundles, const vstring& plot_triggerBits,
 		  const std::string& selEventsFileName)
     : process_(process),
       region_(region),
@@ -190,6 +191,7 @@ struct regionEntryType
     cfgHistManager.addParameter<std::string>("label", label_);
     cfgHistManager.addParameter<std::string>("svFitMassHypothesis", svFitMassHypothesis);
     cfgHistManager.addParameter<bool>("fillControlPlots", fillControlPlots);
+    cfgHistManager.addParameter<bool>("writeHistogramBundle", writeHistogramBundles);
     cfgHistManager.addParameter<vstring>("triggerBits", plot_triggerBits);
 
     histogramsUnbinned_ = new histManagerEntryType(cfgHistManager, fillGenMatchHistograms);
@@ -239,16 +241,27 @@ struct regionEntryType
     
     delete selEventsFile_;
   }
-  void analyze(const fwlite::Event& evt, const PATMuTauPair& muTauPair, const pat::MET& caloMEt, 
-	       size_t numJets, size_t numJets_bTagged,
-	       size_t numVertices, const std::map<std::string, bool>& plot_triggerBits_passed, int genMatchType, double evtWeight)
+  void setEntryTauIdDiscriminators(const vstring& entryTauIdDiscriminators)
+  {
+    selector_->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+  }
+  void analyze(const TauIdEffMiniTupleEntry& muTauPair, double caloMEtPt, 
+	       const std::map<std::string, bool>& plot_triggerBits_passed, double evtWeight)
   {
     pat::strbitset evtSelFlags;
-    if ( selector_->operator()(muTauPair, caloMEt, numJets_bTagged, evtSelFlags) ) {
+    if ( selector_->operator()(muTauPair, caloMEtPt, evtSelFlags) ) {
+      fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, evtWeight);
+    }
+  }
+  void select(const TauIdEffEventSelector::inputBatchType& muTauPairInputs)
+  {
+    selector_->operator()(muTauPairInputs, selFlags_);
+  }
+  void fillHistograms(const TauIdEffMiniTupleEntry& muTauPair, double caloMEtPt, 
+		      const std::map<std::string, bool>& plot_triggerBits_passed, double evtWeight)
+  {
 //--- fill histograms for "inclusive" tau id. efficiency measurement
-      histogramsUnbinned_->fillHistograms(0., muTauPair, caloMEt, 
-					  numJets, numJets_bTagged,
-					  numVertices, plot_triggerBits_passed, genMatchType, evtWeight);
+    histogramsUnbinned_->fillHistograms(0., muTauPair, caloMEtPt, plot_triggerBits_passed, evtWeight);
 
 //--- fill histograms for tau id. efficiency measurement as function of 
 //   o tau-jet transverse momentum
@@ -256,26 +269,23 @@ struct regionEntryType
 //   o reconstructed vertex multiplicity
 //   o sumEt
 //   o ...
-      for ( std::vector<histManagerEntryType*>::iterator histManagerEntry = histogramEntriesBinned_.begin();
-	    histManagerEntry != histogramEntriesBinned_.end(); ++histManagerEntry ) {
-	double x = 0.;
-	if      ( (*histManagerEntry)->binVariable_ == "tauPt"       ) x = muTauPair.leg2()->pt();
-	else if ( (*histManagerEntry)->binVariable_ == "tauAbsEta"   ) x = TMath::Abs(muTauPair.leg2()->eta());
-	else if ( (*histManagerEntry)->binVariable_ == "numVertices" ) x = numVertices;
-	else if ( (*histManagerEntry)->binVariable_ == "sumEt"       ) x = muTauPair.met()->sumEt();
-	else throw cms::Exception("regionEntryType::analyze")
-	  << "Invalid binVariable = " << (*histManagerEntry)->binVariable_ << " !!\n";
-	(*histManagerEntry)->fillHistograms(x, muTauPair, caloMEt, 
-					    numJets, numJets_bTagged,
-					    numVertices, plot_triggerBits_passed, genMatchType, evtWeight);
-      }
+    for ( std::vector<histManagerEntryType*>::iterator histManagerEntry = histogramEntriesBinned_.begin();
+	  histManagerEntry != histogramEntriesBinned_.end(); ++histManagerEntry ) {
+      double x = 0.;
+      if      ( (*histManagerEntry)->binVariable_ == "tauPt"       ) x = muTauPair.tauPt_;
+      else if ( (*histManagerEntry)->binVariable_ == "tauAbsEta"   ) x = TMath::Abs(muTauPair.tauEta_);
+      else if ( (*histManagerEntry)->binVariable_ == "numVertices" ) x = muTauPair.numVertices_;
+      else if ( (*histManagerEntry)->binVariable_ == "sumEt"       ) x = muTauPair.pfMEtSumEt_;
+      else throw cms::Exception("regionEntryType::analyze")
+	<< "Invalid binVariable = " << (*histManagerEntry)->binVariable_ << " !!\n";
+      (*histManagerEntry)->fillHistograms(x, muTauPair, caloMEtPt, plot_triggerBits_passed, evtWeight);
+    }
  
-      if ( selEventsFile_ ) 
-	(*selEventsFile_) << evt.id().run() << ":" << evt.luminosityBlock() << ":" << evt.id().event() << std::endl;
+    if ( selEventsFile_ ) 
+      (*selEventsFile_) << muTauPair.run_ << ":" << muTauPair.ls_ << ":" << muTauPair.event_ << std::endl;
 
-      ++numMuTauPairs_selected_;
-      numMuTauPairsWeighted_selected_ += evtWeight;
-    }
+    ++numMuTauPairs_selected_;
+    numMuTauPairsWeighted_selected_ += evtWeight;
   }
 
   std::string process_;
@@ -289,6 +299,7 @@ struct regionEntryType
   bool appyTauFakeRateWeights;
 
   TauIdEffEventSelector* selector_;
+  std::vector<unsigned char> selFlags_; // flags indicating which muon + tau-jet pairs in current batch pass selection
 
   histManagerEntryType* histogramsUnbinned_;
   std::vector<histManagerEntryType*> histogramEntriesBinned_;
@@ -299,6 +310,282 @@ struct regionEntryType
   std::ofstream* selEventsFile_;
 };
 
+//-------------------------------------------------------------------------------
+//
+// Scan of ordered list of nested tau id. working-points
+// (e.g. 'loose', 'medium' and 'tight' isolation, each tighter than the previous one):
+// all cuts not related to tau id. are evaluated once per muon + tau-jet pair and "base" region
+// (region without the "p"/"f" tau id. requirement), followed by a single pass 
+// over the working-points, which determines the number of working-points passed by the tau-jet candidate.
+// The histograms of all working-points are then filled cumulatively,
+// i.e. a tau-jet candidate passing the 'medium', but failing the 'tight' working-point
+// enters the "passed" histograms of the 'loose' and 'medium' and the "failed" histograms of the 'tight' working-point.
+//
+// NOTE: histograms are booked with the same names as if each working-point was given as separate entry in 'tauIds'.
+//       In addition, the number of working-points passed is histogrammed for each "base" region.
+//
+enum { kTauIdNotApplied, kTauIdPassed, kTauIdFailed };
+
+std::string getBaseRegion(const std::string& region, int& tauIdCut)
+{
+  size_t pos_separator = region.find("_");
+  std::string region_cuts = std::string(region, 0, pos_separator);
+  std::string region_suffix = ( pos_separator != std::string::npos ) ? std::string(region, pos_separator) : "";
+  
+  if      ( region_cuts.find("p") != std::string::npos ) tauIdCut = kTauIdPassed;
+  else if ( region_cuts.find("f") != std::string::npos ) tauIdCut = kTauIdFailed;
+  else                                                   tauIdCut = kTauIdNotApplied;
+
+  std::string baseRegion;
+  for ( std::string::const_iterator character = region_cuts.begin();
+	character != region_cuts.end(); ++character ) {
+    if ( (*character) != 'p' && (*character) != 'f' ) baseRegion.push_back(*character);
+  }
+  baseRegion.append(region_suffix);
+
+  return baseRegion;
+}
+
+std::vector<int> getEntryTauIdDiscriminatorIndices(const vstring& tauIdDiscriminators, const vstring& entryTauIdDiscriminators)
+{
+  std::vector<int> retVal;
+  for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators.begin();
+	tauIdDiscriminator != tauIdDiscriminators.end(); ++tauIdDiscriminator ) {
+    vstring::const_iterator entryTauIdDiscriminator = 
+      std::find(entryTauIdDiscriminators.begin(), entryTauIdDiscriminators.end(), *tauIdDiscriminator);
+    if ( entryTauIdDiscriminator == entryTauIdDiscriminators.end() )
+      throw cms::Exception("getEntryTauIdDiscriminatorIndices")
+	<< "Values of tau id. discriminator = " << (*tauIdDiscriminator) << " not contained in mini-tuple entries !!\n";
+    retVal.push_back(entryTauIdDiscriminator - entryTauIdDiscriminators.begin());
+  }
+  return retVal;
+}
+
+struct tauIdScanEntryType
+{
+  struct baseRegionEntryType
+  {
+    std::string region_;
+    bool applyMuonIsoWeights_;
+    TauIdEffEventSelector* selector_;
+    std::vector<unsigned char> selFlags_;
+    TH1* histogramNumWorkingPointsPassed_;
+  };
+
+  struct scannedRegionEntryType
+  {
+    regionEntryType* regionEntry_;
+    size_t idxBaseRegion_;
+    size_t idxWorkingPoint_;
+    int tauIdCut_;
+    bool applyMuonIsoWeights_;
+  };
+
+  tauIdScanEntryType(fwlite::TFileService& fs, const edm::ParameterSet& cfgTauIdScan,
+		     const std::string& process, const vstring& regions, const std::string& sysShift,
+		     const edm::ParameterSet& cfgBinning, const std::string& svFitMassHypothesis, 
+		     const std::string& tauChargeMode, bool disableTauCandPreselCuts, const edm::ParameterSet& cfgEventSelCuts, 
+		     bool fillGenMatchHistograms, bool fillControlPlots, bool writeHistogramBundles, const vstring& plot_triggerBits)
+    : name_(cfgTauIdScan.getParameter<std::string>("name")),
+      tauIdDiscriminators_(cfgTauIdScan.getParameter<vstring>("discriminators")),
+      numMuTauPairs_nonNested_(0)
+  {
+    typedef std::vector<edm::ParameterSet> vParameterSet;
+    vParameterSet cfgWorkingPoints = cfgTauIdScan.getParameter<vParameterSet>("workingPoints");
+    if ( cfgWorkingPoints.size() == 0 )
+      throw cms::Exception("tauIdScanEntryType")
+	<< "No working-points defined for tau id. scan = " << name_ << " !!\n";
+    for ( vParameterSet::const_iterator cfgWorkingPoint = cfgWorkingPoints.begin();
+	  cfgWorkingPoint != cfgWorkingPoints.end(); ++cfgWorkingPoint ) {
+      workingPointNames_.push_back(cfgWorkingPoint->getParameter<std::string>("name"));
+      workingPointDiscriminators_.push_back(cfgWorkingPoint->getParameter<vstring>("discriminators"));
+    }
+    size_t numWorkingPoints = workingPointNames_.size();
+
+    for ( vstring::const_iterator region = regions.begin();
+	  region != regions.end(); ++region ) {
+      int tauIdCut = kTauIdNotApplied;
+      std::string baseRegion = getBaseRegion(*region, tauIdCut);
+      bool isNewBaseRegion = true;
+      for ( std::vector<baseRegionEntryType>::const_iterator baseRegionEntry = baseRegionEntries_.begin();
+	    baseRegionEntry != baseRegionEntries_.end(); ++baseRegionEntry ) {
+	if ( baseRegionEntry->region_ == baseRegion ) isNewBaseRegion = false;
+      }
+      if ( !isNewBaseRegion ) continue;
+
+      baseRegionEntryType baseRegionEntry;
+      baseRegionEntry.region_ = baseRegion;
+      baseRegionEntry.applyMuonIsoWeights_ = ( baseRegion.find("_mW") != std::string::npos );
+
+      edm::ParameterSet cfgSelector = cfgEventSelCuts;
+      cfgSelector.addParameter<vstring>("tauIdDiscriminators", tauIdDiscriminators_);
+      cfgSelector.addParameter<std::string>("region", baseRegion);
+      cfgSelector.addParameter<std::string>("tauChargeMode", tauChargeMode);
+      cfgSelector.addParameter<bool>("disableTauCandPreselCuts", disableTauCandPreselCuts);
+      baseRegionEntry.selector_ = new TauIdEffEventSelector(cfgSelector);
+
+      std::string histogramName = std::string(process).append("_").append(baseRegion).append("_").append("numWorkingPointsPassed");
+      histogramName.append("_").append(name_).append("_").append("all");
+      if ( sysShift != "CENTRAL_VALUE" ) histogramName.append("_").append(sysShift);
+      baseRegionEntry.histogramNumWorkingPointsPassed_ = 
+	fs.make<TH1D>(histogramName.data(), "Number of tau id. working-points passed", numWorkingPoints + 1, -0.5, numWorkingPoints + 0.5);
+      if ( !baseRegionEntry.histogramNumWorkingPointsPassed_->GetSumw2N() ) baseRegionEntry.histogramNumWorkingPointsPassed_->Sumw2();
+      TAxis* xAxis = baseRegionEntry.histogramNumWorkingPointsPassed_->GetXaxis();
+      xAxis->SetBinLabel(1, "none"); // CV: bin numbers start at 1 (not 0) !!
+      for ( size_t idxWorkingPoint = 0; idxWorkingPoint < numWorkingPoints; ++idxWorkingPoint ) {
+	xAxis->SetBinLabel(idxWorkingPoint + 2, workingPointNames_[idxWorkingPoint].data());
+      }
+
+      baseRegionEntries_.push_back(baseRegionEntry);
+    }
+
+    for ( size_t idxWorkingPoint = 0; idxWorkingPoint < numWorkingPoints; ++idxWorkingPoint ) {
+      vstring tauIdDiscriminators = tauIdDiscriminators_;
+      tauIdDiscriminators.insert(tauIdDiscriminators.end(), 
+				 workingPointDiscriminators_[idxWorkingPoint].begin(), workingPointDiscriminators_[idxWorkingPoint].end());
+      for ( vstring::const_iterator region = regions.begin();
+	    region != regions.end(); ++region ) {
+	scannedRegionEntryType scannedRegionEntry;
+	// CV: run + event numbers of selected events are written for entries in 'tauIds' only
+	scannedRegionEntry.regionEntry_ = 
+	  new regionEntryType(fs, process, *region, tauIdDiscriminators, workingPointNames_[idxWorkingPoint], 
+			      sysShift, cfgBinning, svFitMassHypothesis, 
+			      tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
+			      fillGenMatchHistograms, fillControlPlots, writeHistogramBundles, plot_triggerBits, "");
+	std::string baseRegion = getBaseRegion(*region, scannedRegionEntry.tauIdCut_);
+	for ( size_t idxBaseRegion = 0; idxBaseRegion < baseRegionEntries_.size(); ++idxBaseRegion ) {
+	  if ( baseRegionEntries_[idxBaseRegion].region_ == baseRegion ) scannedRegionEntry.idxBaseRegion_ = idxBaseRegion;
+	}
+	scannedRegionEntry.idxWorkingPoint_ = idxWorkingPoint;
+	scannedRegionEntry.applyMuonIsoWeights_ = ( region->find("_mW") != std::string::npos );
+	scannedRegionEntries_.push_back(scannedRegionEntry);
+	regionEntries_.push_back(scannedRegionEntry.regionEntry_);
+      }
+    }
+
+    basePassed_.resize(baseRegionEntries_.size());
+  }
+  void setEntryTauIdDiscriminators(const vstring& entryTauIdDiscriminators)
+  {
+    for ( std::vector<baseRegionEntryType>::iterator baseRegionEntry = baseRegionEntries_.begin();
+	  baseRegionEntry != baseRegionEntries_.end(); ++baseRegionEntry ) {
+      baseRegionEntry->selector_->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    }
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries_.begin();
+	  regionEntry != regionEntries_.end(); ++regionEntry ) {
+      (*regionEntry)->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    }
+
+//--- determine indices of tau id. discriminator values in mini-tuple entries
+    tauIdDiscriminatorIndices_ = getEntryTauIdDiscriminatorIndices(tauIdDiscriminators_, entryTauIdDiscriminators);
+    workingPointDiscriminatorIndices_.clear();
+    for ( std::vector<vstring>::const_iterator workingPointDiscriminators = workingPointDiscriminators_.begin();
+	  workingPointDiscriminators != workingPointDiscriminators_.end(); ++workingPointDiscriminators ) {
+      workingPointDiscriminatorIndices_.push_back(getEntryTauIdDiscriminatorIndices(*workingPointDiscriminators, entryTauIdDiscriminators));
+    }
+  }
+  ~tauIdScanEntryType()
+  {
+    for ( std::vector<baseRegionEntryType>::iterator it = baseRegionEntries_.begin();
+	  it != baseRegionEntries_.end(); ++it ) {
+      delete it->selector_;
+    }
+
+    for ( std::vector<regionEntryType*>::iterator it = regionEntries_.begin();
+	  it != regionEntries_.end(); ++it ) {
+      delete (*it);
+    }
+  }
+  void select(const TauIdEffEventSelector::inputBatchType& muTauPairInputs)
+  {
+    for ( std::vector<baseRegionEntryType>::iterator baseRegionEntry = baseRegionEntries_.begin();
+	  baseRegionEntry != baseRegionEntries_.end(); ++baseRegionEntry ) {
+      baseRegionEntry->selector_->operator()(muTauPairInputs, baseRegionEntry->selFlags_);
+    }
+  }
+  size_t getNumWorkingPointsPassed(const TauIdEffMiniTupleEntry& muTauPair)
+  {
+    const TauIdEffEventSelector* selector = baseRegionEntries_.front().selector_;
+    if ( !selector->passesTauIdDiscriminators(muTauPair, tauIdDiscriminatorIndices_) ) return 0;
+
+    size_t numWorkingPoints_passed = 0;
+    bool isNested = true;
+    for ( std::vector<std::vector<int> >::const_iterator workingPointDiscriminatorIndices = workingPointDiscriminatorIndices_.begin();
+	  workingPointDiscriminatorIndices != workingPointDiscriminatorIndices_.end(); ++workingPointDiscriminatorIndices ) {
+      bool isPassed = selector->passesTauIdDiscriminators(muTauPair, *workingPointDiscriminatorIndices);
+      if      ( isPassed && numWorkingPoints_passed == (size_t)(workingPointDiscriminatorIndices - workingPointDiscriminatorIndices_.begin()) ) ++numWorkingPoints_passed;
+      else if ( isPassed                                                                                                       ) isNested = false;
+    }
+    if ( !isNested ) ++numMuTauPairs_nonNested_;
+
+    return numWorkingPoints_passed;
+  }
+  void analyze(size_t idxMuTauPair, const TauIdEffMiniTupleEntry& muTauPair, double caloMEtPt, 
+	       const std::map<std::string, bool>& plot_triggerBits_passed, 
+	       double evtWeight, double evtWeight_mW, bool useBatchSelection)
+  {
+//--- evaluate cuts not related to tau id. once per "base" region
+    bool anyBaseRegion_passed = false;
+    for ( size_t idxBaseRegion = 0; idxBaseRegion < baseRegionEntries_.size(); ++idxBaseRegion ) {
+      baseRegionEntryType& baseRegionEntry = baseRegionEntries_[idxBaseRegion];
+      if ( useBatchSelection ) {
+	basePassed_[idxBaseRegion] = baseRegionEntry.selFlags_[idxMuTauPair];
+      } else {
+	pat::strbitset evtSelFlags;
+	basePassed_[idxBaseRegion] = baseRegionEntry.selector_->operator()(muTauPair, caloMEtPt, evtSelFlags);
+      }
+      if ( basePassed_[idxBaseRegion] ) anyBaseRegion_passed = true;
+    }
+    if ( !anyBaseRegion_passed ) return;
+
+//--- evaluate tau id. working-points once per muon + tau-jet pair
+    size_t numWorkingPoints_passed = getNumWorkingPointsPassed(muTauPair);
+
+    for ( size_t idxBaseRegion = 0; idxBaseRegion < baseRegionEntries_.size(); ++idxBaseRegion ) {
+      if ( !basePassed_[idxBaseRegion] ) continue;
+      const baseRegionEntryType& baseRegionEntry = baseRegionEntries_[idxBaseRegion];
+      baseRegionEntry.histogramNumWorkingPointsPassed_->Fill(numWorkingPoints_passed, 
+							     baseRegionEntry.applyMuonIsoWeights_ ? evtWeight_mW : evtWeight);
+    }
+
+//--- fill histograms of all working-points cumulatively
+    for ( std::vector<scannedRegionEntryType>::iterator scannedRegionEntry = scannedRegionEntries_.begin();
+	  scannedRegionEntry != scannedRegionEntries_.end(); ++scannedRegionEntry ) {
+      if ( !basePassed_[scannedRegionEntry->idxBaseRegion_] ) continue;
+      bool isWorkingPoint_passed = ( scannedRegionEntry->idxWorkingPoint_ < numWorkingPoints_passed );
+      if ( (scannedRegionEntry->tauIdCut_ == kTauIdPassed &&  !isWorkingPoint_passed) ||
+	   (scannedRegionEntry->tauIdCut_ == kTauIdFailed &&   isWorkingPoint_passed) ) continue;
+      scannedRegionEntry->regionEntry_->fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, 
+						       scannedRegionEntry->applyMuonIsoWeights_ ? evtWeight_mW : evtWeight);
+    }
+  }
+  void scaleHistograms(double factor)
+  {
+    for ( std::vector<baseRegionEntryType>::iterator baseRegionEntry = baseRegionEntries_.begin();
+	  baseRegionEntry != baseRegionEntries_.end(); ++baseRegionEntry ) {
+      baseRegionEntry->histogramNumWorkingPointsPassed_->Scale(factor);
+    }
+  }
+
+  std::string name_;
+  vstring tauIdDiscriminators_; // discriminators common to all working-points (e.g. 'decayModeFinding')
+
+  vstring workingPointNames_;
+  std::vector<vstring> workingPointDiscriminators_;
+
+  std::vector<int> tauIdDiscriminatorIndices_;
+  std::vector<std::vector<int> > workingPointDiscriminatorIndices_;
+
+  std::vector<baseRegionEntryType> baseRegionEntries_;
+  std::vector<unsigned char> basePassed_;
+
+  std::vector<scannedRegionEntryType> scannedRegionEntries_;
+  std::vector<regionEntryType*> regionEntries_;
+
+  int numMuTauPairs_nonNested_; // number of tau-jet candidates passing a tighter, but failing a looser working-point
+};
+//-------------------------------------------------------------------------------
+
 std::string getHLTpath_key(const std::string& hltPath)
 {
   std::string key = hltPath;
@@ -407,9 +694,345 @@ Double_t integralCrystalBall_data_div_mc(Double_t* x, Double_t* par)
     return 1.;
   }
 }
+
+TF1* makeTriggerEffCorrection(const std::string& name, int shiftCaloMEtResponse)
+{
+  TF1* triggerEffCorrection = new TF1(name.data(), &integralCrystalBall_data_div_mc, 0., 1.e+6, 10);
+  double triggerEffCorr_parameter_data[] = {
+    // CV: HLT_IsoMu15_eta2p1_L1ETM20 efficiency correction parameters for 2012 run A
+    3.56934e+01, 8.95771e+00, 3.81006e+01, 3.29700e-02, 9.88290e-01, // Zmumu Data
+  };
+  double triggerEffCorr_parameter_mc[] = {
+    3.51723e+01, 9.44549e+00, 2.13250e+01, 1.64246e+02, 1.00001e+00  // Zmumu Spring'12 MC (pile-up reweighted)
+  };
+  double triggerEffCorr_parameter_mc_shiftUp[] = {
+    2.99172e+01, 8.04091e+00, 4.13981e+01, 2.10489e+00, 9.99198e-01 // Zmumu Spring'12 MC (raw CaloMEt shifted by +15% wrt. corrected CaloMEt)
+  };
+  double triggerEffCorr_parameter_mc_shiftDown[] = {
+    4.04481e+01, 1.08623e+01, 2.45109e+01, 1.64435e+02, 1.00001e+00 // Zmumu Spring'12 MC (raw CaloMEt shifted by -15% wrt. corrected CaloMEt)
+  };
+  int numParameter_data_or_mc = (triggerEffCorrection->GetNpar() / 2);
+  assert(2*numParameter_data_or_mc == triggerEffCorrection->GetNpar());
+  for ( int iPar = 0; iPar < (2*numParameter_data_or_mc); ++iPar ) {
+    if ( iPar <= numParameter_data_or_mc ) { // data
+      triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_data[iPar]);
+    } else {                                 // mc (either central value or CaloMEt response shifted up/down)
+      if      ( shiftCaloMEtResponse ==  0 ) triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_mc[iPar - numParameter_data_or_mc]);
+      else if ( shiftCaloMEtResponse == +1 ) triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_mc_shiftUp[iPar - numParameter_data_or_mc]);
+      else if ( shiftCaloMEtResponse == -1 ) triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_mc_shiftDown[iPar - numParameter_data_or_mc]);
+      else assert(0);      
+    }
+  }
+  return triggerEffCorrection;
+}
 //-------------------------------------------------------------------------------
 
-int main(int argc, char* argv[]) 
+//-------------------------------------------------------------------------------
+//
+// Systematic shifts processed in the same event loop:
+// the central value and each shifted muon + tau-jet pair collection have their own regions, selectors and histograms,
+// while the event weights, trigger decisions, vertices and generator level information are computed once per event.
+// Tau-jet energy shifts/smearing may alternatively be given as per tau-jet shift factors 
+// (produced by PATTauShiftFactorProducer), which are applied "on-the-fly" to the muon + tau-jet pairs given by 'srcMuTauPairs';
+// the PF MEt is then taken from the shifted MEt collection given by 'srcMEt'
+// (if 'srcMEt' is not given, only the shift of the tau-jet momentum itself is propagated to the PF MEt)
+//
+struct sysShiftEntryType
+{
+  sysShiftEntryType(const edm::ParameterSet& cfgSysShift)
+    : sysShift_(cfgSysShift.getParameter<std::string>("sysShift")),
+      srcMuTauPairs_(cfgSysShift.getParameter<edm::InputTag>("srcMuTauPairs")),
+      srcJets_(cfgSysShift.getParameter<edm::InputTag>("srcJets")),
+      srcTauShiftFactors_(cfgSysShift.exists("srcTauShiftFactors") ? 
+			  cfgSysShift.getParameter<edm::InputTag>("srcTauShiftFactors") : edm::InputTag()),
+      srcMEt_(cfgSysShift.exists("srcMEt") ? 
+	      cfgSysShift.getParameter<edm::InputTag>("srcMEt") : edm::InputTag()),
+      shiftCaloMEtResponse_(0),
+      triggerEffCorrection_(0),
+      selectorABCD_(0),
+      caloMEtPt_(0.),
+      evtWeight_(1.),
+      numEvents_processed_(0),
+      numEventsWeighted_processed_(0.),
+      numEvents_passedTrigger_(0),
+      numEventsWeighted_passedTrigger_(0.),
+      numEvents_passedDiMuonVeto_(0),
+      numEventsWeighted_passedDiMuonVeto_(0.),
+      numEvents_passedDiMuTauPairVeto_(0),
+      numEventsWeighted_passedDiMuTauPairVeto_(0.)
+  {
+    //  0: no shift applied
+    // +1: shift reconstructed CaloMEt by +15% and corresponding turn-on curve for L1_ETM20 trigger
+    // -1: shift reconstructed CaloMEt by -15% and corresponding turn-on curve for L1_ETM20 trigger
+    if      ( sysShift_ == "CaloMEtResponseUp"   ) shiftCaloMEtResponse_ = +1;
+    else if ( sysShift_ == "CaloMEtResponseDown" ) shiftCaloMEtResponse_ = -1;
+
+    triggerEffCorrection_ = makeTriggerEffCorrection(std::string("triggerEffCorrection").append("_").append(sysShift_), shiftCaloMEtResponse_);
+  }
+  ~sysShiftEntryType()
+  {
+    delete triggerEffCorrection_;
+
+    for ( std::vector<regionEntryType*>::iterator it = regionEntries_.begin();
+	  it != regionEntries_.end(); ++it ) {
+      delete (*it);
+    }
+    for ( std::vector<tauIdScanEntryType*>::iterator it = tauIdScanEntries_.begin();
+	  it != tauIdScanEntries_.end(); ++it ) {
+      delete (*it);
+    }
+
+    delete selectorABCD_;
+  }
+  void setEntryTauIdDiscriminators(const vstring& entryTauIdDiscriminators)
+  {
+    muTauPairInputs_.setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    selectorABCD_->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries_.begin();
+	  regionEntry != regionEntries_.end(); ++regionEntry ) {
+      (*regionEntry)->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    }
+    for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = tauIdScanEntries_.begin();
+	  tauIdScanEntry != tauIdScanEntries_.end(); ++tauIdScanEntry ) {
+      (*tauIdScanEntry)->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    }
+  }
+  void setCaloMEtAndEvtWeight(double caloMEtPt, double evtWeight, bool isData)
+  {
+    if      ( shiftCaloMEtResponse_ == +1 ) caloMEtPt *= 1.15;
+    else if ( shiftCaloMEtResponse_ == -1 ) caloMEtPt *= 0.85;
+    caloMEtPt_ = caloMEtPt;
+    //std::cout << " caloMEtPt = " << caloMEtPt_ << std::endl;
+
+//--- apply trigger efficiency correction (to MC only)
+    evtWeight_ = evtWeight;
+    if ( !isData ) {
+      double triggerEffCorrection_value = triggerEffCorrection_->Eval(caloMEtPt_);
+      //std::cout << " triggerEffCorrection_value = " << triggerEffCorrection_value << std::endl;
+      evtWeight_ *= triggerEffCorrection_value;
+    }
+  }
+
+  std::string sysShift_;
+  edm::InputTag srcMuTauPairs_;
+  edm::InputTag srcJets_;
+  edm::InputTag srcTauShiftFactors_; // shift factors applied to tau-jet momenta "on-the-fly" (optional)
+  edm::InputTag srcMEt_;             // shifted MEt matching the shift factors (optional)
+
+  int shiftCaloMEtResponse_;
+  TF1* triggerEffCorrection_;
+
+  std::vector<regionEntryType*> regionEntries_;
+  std::vector<tauIdScanEntryType*> tauIdScanEntries_;
+
+  TauIdEffEventSelector* selectorABCD_;
+  TauIdEffEventSelector::inputBatchType muTauPairInputs_;
+  std::vector<unsigned char> selFlagsABCD_;
+
+  std::vector<TauIdEffMiniTupleEntry> muTauPairEntries_; // muon + tau-jet pairs of current event
+
+  double caloMEtPt_;  // CaloMEt of current event, shifted in case of CaloMEtResponseUp/Down
+  double evtWeight_;  // event weight of current event, including trigger efficiency correction
+
+  // CV: event counters are kept per systematic shift,
+  //     as the trigger efficiency correction applied to the event weight depends on the shift
+  int    numEvents_processed_;
+  double numEventsWeighted_processed_;
+  int    numEvents_passedTrigger_;
+  double numEventsWeighted_passedTrigger_;
+  int    numEvents_passedDiMuonVeto_;
+  double numEventsWeighted_passedDiMuonVeto_;
+  int    numEvents_passedDiMuTauPairVeto_;
+  double numEventsWeighted_passedDiMuTauPairVeto_;
+};
+
+//-------------------------------------------------------------------------------
+//
+// Selection of muon + tau-jet pairs and filling of histograms for one systematic shift,
+// common to the analysis of PAT-tuples and of mini-tuples produced by FWLiteTauIdEffMiniTupleProducer
+//
+void analyzeMuTauPairs(sysShiftEntryType& sysShiftEntry, std::vector<TauIdEffMiniTupleEntry>& muTauPairs, 
+		       const std::map<std::string, bool>& plot_triggerBits_passed,
+		       bool applyMuonIsoWeights, bool requireUniqueMuTauPair, bool useBatchSelection)
+{
+  double caloMEtPt = sysShiftEntry.caloMEtPt_;
+  double evtWeight = sysShiftEntry.evtWeight_;
+  TauIdEffEventSelector::inputBatchType& muTauPairInputs = sysShiftEntry.muTauPairInputs_;
+  std::vector<regionEntryType*>& regionEntries = sysShiftEntry.regionEntries_;
+  std::vector<tauIdScanEntryType*>& tauIdScanEntries = sysShiftEntry.tauIdScanEntries_;
+
+//--- require event to contain exactly one muon + tau-jet pair
+//    passing the selection criteria for region "ABCD"
+  size_t numMuTauPairs = muTauPairs.size();
+  unsigned numMuTauPairsABCD = 0; // Note: no b-jet veto applied
+  if ( useBatchSelection ) {
+    muTauPairInputs.clear();
+    for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+      muTauPairInputs.push_back(muTauPairs[idxMuTauPair], caloMEtPt);
+    }
+    std::fill(muTauPairInputs.numJets_bTagged_.begin(), muTauPairInputs.numJets_bTagged_.end(), 0.);
+    sysShiftEntry.selectorABCD_->operator()(muTauPairInputs, sysShiftEntry.selFlagsABCD_);
+    numMuTauPairsABCD = std::count(sysShiftEntry.selFlagsABCD_.begin(), sysShiftEntry.selFlagsABCD_.end(), 1);
+  } else {
+    for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+      TauIdEffMiniTupleEntry& muTauPair = muTauPairs[idxMuTauPair];
+      unsigned numJets_bTagged = muTauPair.numJets_bTagged_;
+      muTauPair.numJets_bTagged_ = 0;
+      pat::strbitset evtSelFlags;
+      if ( sysShiftEntry.selectorABCD_->operator()(muTauPair, caloMEtPt, evtSelFlags) ) ++numMuTauPairsABCD;
+      muTauPair.numJets_bTagged_ = numJets_bTagged;
+    }
+  }
+      
+  if ( !(numMuTauPairsABCD <= 1) ) return;
+  ++sysShiftEntry.numEvents_passedDiMuTauPairVeto_;
+  sysShiftEntry.numEventsWeighted_passedDiMuTauPairVeto_ += evtWeight;
+
+//--- iterate over collection of muon + tau-jet pairs:
+//    check which region muon + tau-jet pair is selected in,
+//    fill histograms for that region
+  if ( requireUniqueMuTauPair && numMuTauPairs > 1 ) return;
+
+  if ( useBatchSelection ) {
+    for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+      muTauPairInputs.numJets_bTagged_[idxMuTauPair] = muTauPairs[idxMuTauPair].numJets_bTagged_;
+    }
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
+	  regionEntry != regionEntries.end(); ++regionEntry ) {	
+      (*regionEntry)->select(muTauPairInputs);
+    }
+    for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = tauIdScanEntries.begin();
+	  tauIdScanEntry != tauIdScanEntries.end(); ++tauIdScanEntry ) {
+      (*tauIdScanEntry)->select(muTauPairInputs);
+    }
+  }
+
+  for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+    const TauIdEffMiniTupleEntry& muTauPair = muTauPairs[idxMuTauPair];
+    double evtWeight_mW = evtWeight;
+    if ( applyMuonIsoWeights ) evtWeight_mW *= muTauPair.muonIsoProb_;
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
+	  regionEntry != regionEntries.end(); ++regionEntry ) {	  
+      if ( useBatchSelection && !(*regionEntry)->selFlags_[idxMuTauPair] ) continue;
+      double evtWeight_region = ( (*regionEntry)->region_.find("_mW") != std::string::npos ) ? evtWeight_mW : evtWeight;
+      if ( useBatchSelection ) 
+	(*regionEntry)->fillHistograms(muTauPair, caloMEtPt, plot_triggerBits_passed, evtWeight_region);
+      else
+	(*regionEntry)->analyze(muTauPair, caloMEtPt, plot_triggerBits_passed, evtWeight_region);
+    }
+    for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = tauIdScanEntries.begin();
+	  tauIdScanEntry != tauIdScanEntries.end(); ++tauIdScanEntry ) {
+      (*tauIdScanEntry)->analyze(idxMuTauPair, muTauPair, caloMEtPt, plot_triggerBits_passed, 
+				 evtWeight, evtWeight_mW, useBatchSelection);
+    }
+  }
+}
+
+void addTauIdDiscriminators(vstring& tauIdDiscriminators, const vstring& tauIdDiscriminatorsToAdd)
+{
+  for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminatorsToAdd.begin();
+	tauIdDiscriminator != tauIdDiscriminatorsToAdd.end(); ++tauIdDiscriminator ) {
+    if ( std::find(tauIdDiscriminators.begin(), tauIdDiscriminators.end(), *tauIdDiscriminator) == tauIdDiscriminators.end() ) 
+      tauIdDiscriminators.push_back(*tauIdDiscriminator);
+  }
+}
+//-------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------
+//
+// Register event counters of all systematic shifts, regions and tau id. scans
+// with TauIdEffResultCache or TauIdEffCheckpoint
+//
+template <typename T>
+void addSysShiftCounters(T* counterStore, std::vector<sysShiftEntryType*>& sysShiftEntries)
+{
+  for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+    std::string sysShift = (*sysShiftEntry)->sysShift_;
+    counterStore->addCounter(std::string(sysShift).append("_numEvents_processed"), &(*sysShiftEntry)->numEvents_processed_);
+    counterStore->addCounter(std::string(sysShift).append("_numEventsWeighted_processed"), &(*sysShiftEntry)->numEventsWeighted_processed_);
+    counterStore->addCounter(std::string(sysShift).append("_numEvents_passedTrigger"), &(*sysShiftEntry)->numEvents_passedTrigger_);
+    counterStore->addCounter(std::string(sysShift).append("_numEventsWeighted_passedTrigger"), &(*sysShiftEntry)->numEventsWeighted_passedTrigger_);
+    counterStore->addCounter(std::string(sysShift).append("_numEvents_passedDiMuonVeto"), &(*sysShiftEntry)->numEvents_passedDiMuonVeto_);
+    counterStore->addCounter(std::string(sysShift).append("_numEventsWeighted_passedDiMuonVeto"), &(*sysShiftEntry)->numEventsWeighted_passedDiMuonVeto_);
+    counterStore->addCounter(std::string(sysShift).append("_numEvents_passedDiMuTauPairVeto"), &(*sysShiftEntry)->numEvents_passedDiMuTauPairVeto_);
+    counterStore->addCounter(std::string(sysShift).append("_numEventsWeighted_passedDiMuTauPairVeto"), &(*sysShiftEntry)->numEventsWeighted_passedDiMuTauPairVeto_);
+    std::vector<regionEntryType*> regionEntries = (*sysShiftEntry)->regionEntries_;
+    for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = (*sysShiftEntry)->tauIdScanEntries_.begin();
+	  tauIdScanEntry != (*sysShiftEntry)->tauIdScanEntries_.end(); ++tauIdScanEntry ) {
+      regionEntries.insert(regionEntries.end(), (*tauIdScanEntry)->regionEntries_.begin(), (*tauIdScanEntry)->regionEntries_.end());
+      counterStore->addCounter(std::string(sysShift).append("_").append((*tauIdScanEntry)->name_).append("_numMuTauPairs_nonNested"), 
+			       &(*tauIdScanEntry)->numMuTauPairs_nonNested_);
+    }
+    // CV: names of regions are not unique in case same tau id. discriminator is used in tau id. scans,
+    //     add index to make names of counters unique
+    for ( size_t idxRegionEntry = 0; idxRegionEntry < regionEntries.size(); ++idxRegionEntry ) {
+      regionEntryType* regionEntry = regionEntries[idxRegionEntry];
+      std::string counterName = Form("%s_%s_%s_%u", sysShift.data(), regionEntry->tauIdName_.data(), regionEntry->region_.data(), (unsigned)idxRegionEntry);
+      counterStore->addCounter(std::string(counterName).append("_numMuTauPairs_selected"), &regionEntry->numMuTauPairs_selected_);
+      counterStore->addCounter(std::string(counterName).append("_numMuTauPairsWeighted_selected"), &regionEntry->numMuTauPairsWeighted_selected_);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------
+//
+// Increment event counters of all systematic shifts,
+// using the event weight of each systematic shift
+//
+void incrementSysShiftCounters(std::vector<sysShiftEntryType*>& sysShiftEntries,
+			       int sysShiftEntryType::* numEvents, double sysShiftEntryType::* numEventsWeighted)
+{
+  for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+    ++((*sysShiftEntry)->*numEvents);
+    (*sysShiftEntry)->*numEventsWeighted += (*sysShiftEntry)->evtWeight_;
+  }
+}
+
+//-------------------------------------------------------------------------------
+//
+// Check if any luminosity section contained in input file passes run-range and luminosity section selection;
+// the check uses the LuminosityBlocks tree only, without reading any event data
+//
+bool isSelectedInputFile(TFile* inputFile, const TauIdEffLumiMask& lumiMask)
+{
+  fwlite::LuminosityBlock ls(inputFile);
+  for ( ls.toBegin(); !ls.atEnd(); ++ls ) {
+    if ( lumiMask(ls.id().run(), ls.id().luminosityBlock()) ) return true;
+  }
+  return false;
+}
+
+//
+// Compose string representing all configuration parameters that affect the histograms and event counters
+// filled for one input file; used as key of TauIdEffResultCache
+// (parameters used for normalization of Monte Carlo samples only and names of input files are excluded)
+//
+std::string getResultCacheConfigDigest(const edm::ParameterSet& cfgTauIdEffAnalyzer, const TauIdEffLumiMask& lumiMask)
+{
+  vstring excludedParameterNames;
+  excludedParameterNames.push_back("allEvents_DBS");
+  excludedParameterNames.push_back("xSection");
+  excludedParameterNames.push_back("intLumiData");
+  excludedParameterNames.push_back("miniTupleFileNames");
+  excludedParameterNames.push_back("resultCacheDirectory");
+  excludedParameterNames.push_back("checkpointFileName");
+  excludedParameterNames.push_back("checkpointInterval");
+
+  edm::ParameterSet cfgDigest;
+  vstring parameterNames = cfgTauIdEffAnalyzer.getParameterNames();
+  for ( vstring::const_iterator parameterName = parameterNames.begin();
+	parameterName != parameterNames.end(); ++parameterName ) {
+    if ( std::find(excludedParameterNames.begin(), excludedParameterNames.end(), *parameterName) != excludedParameterNames.end() ) continue;
+    cfgDigest.copyFrom(cfgTauIdEffAnalyzer, *parameterName);
+  }
+  cfgDigest.addParameter<std::string>("lumiMask", lumiMask.toString());
+
+  return cfgDigest.toString();
+}
+
+int main(int argc, char* argv[])
 {
 //--- parse command-line arguments
   if ( argc < 2 ) {
@@ -436,7 +1059,6 @@ int main(int argc, char* argv[])
 
   edm::ParameterSet cfgTauIdEffAnalyzer = cfg.getParameter<edm::ParameterSet>("tauIdEffAnalyzer");
 
-  edm::InputTag srcMuTauPairs = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcMuTauPairs");
   bool requireUniqueMuTauPair = ( cfgTauIdEffAnalyzer.exists("") ) ? 
     cfgTauIdEffAnalyzer.getParameter<bool>("requireUniqueMuTauPair") : false;
   std::string svFitMassHypothesis = cfgTauIdEffAnalyzer.getParameter<std::string>("svFitMassHypothesis");
@@ -447,7 +1069,6 @@ int main(int argc, char* argv[])
   vstring hltPaths = cfgTauIdEffAnalyzer.getParameter<vstring>("hltPaths");
   edm::InputTag srcCaloMEt = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcCaloMEt");
   edm::InputTag srcGoodMuons = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcGoodMuons");
-  edm::InputTag srcJets = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcJets");
   edm::ParameterSet cfgJetId;
   cfgJetId.addParameter<std::string>("version", "FIRSTDATA");
   cfgJetId.addParameter<std::string>("quality", "LOOSE");
@@ -456,6 +1077,8 @@ int main(int argc, char* argv[])
   edm::InputTag srcGenParticles = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcGenParticles");
   bool fillGenMatchHistograms = cfgTauIdEffAnalyzer.getParameter<bool>("fillGenMatchHistograms");
   bool fillControlPlots = cfgTauIdEffAnalyzer.getParameter<bool>("fillControlPlots");
+  bool writeHistogramBundles = ( cfgTauIdEffAnalyzer.exists("writeHistogramBundles") ) ?
+    cfgTauIdEffAnalyzer.getParameter<bool>("writeHistogramBundles") : false;
   typedef std::vector<int> vint;
   vint skipPdgIdsGenParticleMatch = cfgTauIdEffAnalyzer.getParameter<vint>("skipPdgIdsGenParticleMatch");  
   vstring plot_hltPaths = cfgTauIdEffAnalyzer.getParameter<vstring>("plot_hltPaths");
@@ -468,66 +1091,87 @@ int main(int argc, char* argv[])
   vInputTag srcWeights = cfgTauIdEffAnalyzer.getParameter<vInputTag>("weights");
   double minWeight = cfgTauIdEffAnalyzer.getParameter<double>("minWeight");
   double maxWeight = cfgTauIdEffAnalyzer.getParameter<double>("maxWeight");
-  std::string sysShift = cfgTauIdEffAnalyzer.exists("sysShift") ?
-    cfgTauIdEffAnalyzer.getParameter<std::string>("sysShift") : "CENTRAL_VALUE";
-  int shiftCaloMEtResponse = 0; //  0: no shift applied
-                                // +1: shift reconstructed CaloMEt by +15% and corresponding turn-on curve for L1_ETM20 trigger
-                                // -1: shift reconstructed CaloMEt by -15% and corresponding turn-on curve for L1_ETM20 trigger
-  if      ( sysShift == "CaloMEtResponseUp"   ) shiftCaloMEtResponse = +1;
-  else if ( sysShift == "CaloMEtResponseDown" ) shiftCaloMEtResponse = -1;
-  
+
+//--- central value (or systematic shift given by 'sysShift' parameter),
+//    followed by optional list of additional systematic shifts processed in the same event loop
+//   (each entry in 'sysShifts' specifies 'sysShift', 'srcMuTauPairs' and optionally 'srcJets', 'srcTauShiftFactors' and 'srcMEt')
+  typedef std::vector<edm::ParameterSet> vParameterSet;
+  vParameterSet cfgSysShifts;
+  edm::ParameterSet cfgSysShift_default;
+  cfgSysShift_default.addParameter<std::string>("sysShift", cfgTauIdEffAnalyzer.exists("sysShift") ?
+    cfgTauIdEffAnalyzer.getParameter<std::string>("sysShift") : "CENTRAL_VALUE");
+  cfgSysShift_default.addParameter<edm::InputTag>("srcMuTauPairs", cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcMuTauPairs"));
+  cfgSysShift_default.addParameter<edm::InputTag>("srcJets", cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcJets"));
+  if ( cfgTauIdEffAnalyzer.exists("srcTauShiftFactors") ) 
+    cfgSysShift_default.addParameter<edm::InputTag>("srcTauShiftFactors", cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcTauShiftFactors"));
+  if ( cfgTauIdEffAnalyzer.exists("srcMEt") ) 
+    cfgSysShift_default.addParameter<edm::InputTag>("srcMEt", cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcMEt"));
+  cfgSysShifts.push_back(cfgSysShift_default);
+  if ( cfgTauIdEffAnalyzer.exists("sysShifts") ) {
+    vParameterSet cfgSysShifts_additional = cfgTauIdEffAnalyzer.getParameter<vParameterSet>("sysShifts");
+    for ( vParameterSet::const_iterator cfgSysShift_additional = cfgSysShifts_additional.begin();
+	  cfgSysShift_additional != cfgSysShifts_additional.end(); ++cfgSysShift_additional ) {
+      edm::ParameterSet cfgSysShift = (*cfgSysShift_additional);
+      if ( !cfgSysShift.exists("srcJets") ) cfgSysShift.addParameter<edm::InputTag>("srcJets", cfgSysShift_default.getParameter<edm::InputTag>("srcJets"));
+      cfgSysShifts.push_back(cfgSysShift);
+    }
+  }
+
   edm::InputTag srcEventCounter = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcEventCounter");
 
-  PATMuonLUTvalueExtractorFromKNN* muonIsoProbExtractor = 0;
+  PATMuonLUTvalueGridFromKNN* muonIsoProbExtractor = 0;
   bool applyMuonIsoWeights = false;
   if ( cfgTauIdEffAnalyzer.exists("muonIsoProbExtractor") ) {
     edm::ParameterSet cfgMuonIsoProbExtractor = cfgTauIdEffAnalyzer.getParameter<edm::ParameterSet>("muonIsoProbExtractor");
-    muonIsoProbExtractor = new PATMuonLUTvalueExtractorFromKNN(cfgMuonIsoProbExtractor);
+    muonIsoProbExtractor = new PATMuonLUTvalueGridFromKNN(cfgMuonIsoProbExtractor);
+    applyMuonIsoWeights = cfgTauIdEffAnalyzer.getParameter<bool>("applyMuonIsoWeights");
+  } else if ( cfgTauIdEffAnalyzer.exists("applyMuonIsoWeights") ) {
+    // CV: muon isolation probabilities may alternatively be taken from mini-tuple
     applyMuonIsoWeights = cfgTauIdEffAnalyzer.getParameter<bool>("applyMuonIsoWeights");
-  }
-
-  TF1* triggerEffCorrection = new TF1("triggerEffCorrection", &integralCrystalBall_data_div_mc, 0., 1.e+6, 10);
-  double triggerEffCorr_parameter_data[] = {
-    // CV: HLT_IsoMu15_eta2p1_L1ETM20 efficiency correction parameters for 2012 run A
-    3.56934e+01, 8.95771e+00, 3.81006e+01, 3.29700e-02, 9.88290e-01, // Zmumu Data
-  };
-  double triggerEffCorr_parameter_mc[] = {
-    3.51723e+01, 9.44549e+00, 2.13250e+01, 1.64246e+02, 1.00001e+00  // Zmumu Spring'12 MC (pile-up reweighted)
-  };
-  double triggerEffCorr_parameter_mc_shiftUp[] = {
-    2.99172e+01, 8.04091e+00, 4.13981e+01, 2.10489e+00, 9.99198e-01 // Zmumu Spring'12 MC (raw CaloMEt shifted by +15% wrt. corrected CaloMEt)
-  };
-  double triggerEffCorr_parameter_mc_shiftDown[] = {
-    4.04481e+01, 1.08623e+01, 2.45109e+01, 1.64435e+02, 1.00001e+00 // Zmumu Spring'12 MC (raw CaloMEt shifted by -15% wrt. corrected CaloMEt)
-  };
-  int numParameter_data_or_mc = (triggerEffCorrection->GetNpar() / 2);
-  assert(2*numParameter_data_or_mc == triggerEffCorrection->GetNpar());
-  for ( int iPar = 0; iPar < (2*numParameter_data_or_mc); ++iPar ) {
-    if ( iPar <= numParameter_data_or_mc ) { // data
-      triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_data[iPar]);
-    } else {                                 // mc (either central value or CaloMEt response shifted up/down)
-      if      ( shiftCaloMEtResponse ==  0 ) triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_mc[iPar - numParameter_data_or_mc]);
-      else if ( shiftCaloMEtResponse == +1 ) triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_mc_shiftUp[iPar - numParameter_data_or_mc]);
-      else if ( shiftCaloMEtResponse == -1 ) triggerEffCorrection->SetParameter(iPar, triggerEffCorr_parameter_mc_shiftDown[iPar - numParameter_data_or_mc]);
-      else assert(0);      
-    }
   }
 
   std::string selEventsFileName = ( cfgTauIdEffAnalyzer.exists("selEventsFileName") ) ? 
     cfgTauIdEffAnalyzer.getParameter<std::string>("selEventsFileName") : "";
 
+//--- evaluate selection for all muon + tau-jet pairs of an event in one go,
+//    using the "structure-of-arrays" interface of TauIdEffEventSelector
+//   (per-pair evaluation is kept, in order to allow for cross-checks of the two modes)
+  bool useBatchSelection = ( cfgTauIdEffAnalyzer.exists("useBatchSelection") ) ?
+    cfgTauIdEffAnalyzer.getParameter<bool>("useBatchSelection") : true;
+
+//--- read muon + tau-jet pairs from mini-tuples produced by FWLiteTauIdEffMiniTupleProducer 
+//    instead of PAT-tuples (optional)
+//   (run-range, HLT paths and maximum number of events are applied when producing the mini-tuples)
+  vstring miniTupleFileNames = ( cfgTauIdEffAnalyzer.exists("miniTupleFileNames") ) ?
+    cfgTauIdEffAnalyzer.getParameter<vstring>("miniTupleFileNames") : vstring();
+
+//--- cache histograms and event counters per input file (optional),
+//    so that only input files that changed need to be reprocessed when job is rerun with same configuration
+  std::string resultCacheDirectory = ( cfgTauIdEffAnalyzer.exists("resultCacheDirectory") ) ?
+    cfgTauIdEffAnalyzer.getParameter<std::string>("resultCacheDirectory") : "";
+
+//--- write checkpoints at the end of each input file and every 'checkpointInterval' events (optional),
+//    in order to resume job from last checkpoint in case it gets killed before completion
+  std::string checkpointFileName = ( cfgTauIdEffAnalyzer.exists("checkpointFileName") ) ?
+    cfgTauIdEffAnalyzer.getParameter<std::string>("checkpointFileName") : "";
+  int checkpointInterval = ( cfgTauIdEffAnalyzer.exists("checkpointInterval") ) ?
+    cfgTauIdEffAnalyzer.getParameter<int>("checkpointInterval") : 0;
+
   fwlite::InputSource inputFiles(cfg); 
   edm::ParameterSet cfgInputSource = cfg.getParameter<edm::ParameterSet>("fwliteInput");
   int firstRun = cfgInputSource.getParameter<int>("firstRun");
   int lastRun = cfgInputSource.getParameter<int>("lastRun");
+  std::string lumiMaskFileName = ( cfgInputSource.exists("lumiMaskFileName") ) ?
+    cfgInputSource.getParameter<std::string>("lumiMaskFileName") : "";
+  TauIdEffLumiMask lumiMask(lumiMaskFileName, firstRun, lastRun);
   int maxEvents = inputFiles.maxEvents();
 
   fwlite::OutputFiles outputFile(cfg);
-  fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
+  fwlite::TFileService* fs = new fwlite::TFileService(outputFile.file().data());
 
 //--- initialize selections and histograms
-//    for different ABCD regions
-  std::vector<regionEntryType*> regionEntries;
+//    for different ABCD regions and systematic shifts
+  std::vector<sysShiftEntryType*> sysShiftEntries;
 
   std::string process = cfgTauIdEffAnalyzer.getParameter<std::string>("process");
   std::cout << " process = " << process << std::endl;
@@ -536,51 +1180,102 @@ int main(int argc, char* argv[])
   bool isData = (processType == "Data");
   vstring regions = cfgTauIdEffAnalyzer.getParameter<vstring>("regions");
   edm::ParameterSet cfgBinning = cfgTauIdEffAnalyzer.getParameter<edm::ParameterSet>("binning");
-  typedef std::vector<edm::ParameterSet> vParameterSet;
   vParameterSet cfgTauIdDiscriminators = cfgTauIdEffAnalyzer.getParameter<vParameterSet>("tauIds");
+  vParameterSet cfgTauIdScans;
+  if ( cfgTauIdEffAnalyzer.exists("tauIdScans") ) cfgTauIdScans = cfgTauIdEffAnalyzer.getParameter<vParameterSet>("tauIdScans");
+  for ( vParameterSet::const_iterator cfgSysShift = cfgSysShifts.begin();
+	cfgSysShift != cfgSysShifts.end(); ++cfgSysShift ) {
+    sysShiftEntryType* sysShiftEntry = new sysShiftEntryType(*cfgSysShift);
+    const std::string& sysShift = sysShiftEntry->sysShift_;
+    std::cout << " sysShift = " << sysShift << ": srcMuTauPairs = " << sysShiftEntry->srcMuTauPairs_.label() << std::endl;
+
+    // CV: run + event numbers of selected events are written for the first systematic shift only
+    std::string selEventsFileName_sysShift = ( sysShiftEntries.size() == 0 ) ? selEventsFileName : "";
+
+    for ( vParameterSet::const_iterator cfgTauIdDiscriminator = cfgTauIdDiscriminators.begin();
+	  cfgTauIdDiscriminator != cfgTauIdDiscriminators.end(); ++cfgTauIdDiscriminator ) {
+      for ( vstring::const_iterator region = regions.begin();
+	    region != regions.end(); ++region ) {
+	vstring tauIdDiscriminators = cfgTauIdDiscriminator->getParameter<vstring>("discriminators");
+	std::string tauIdName = cfgTauIdDiscriminator->getParameter<std::string>("name");
+
+	// all tau charges
+	regionEntryType* regionEntry = 
+	  new regionEntryType(*fs, process, *region, tauIdDiscriminators, tauIdName, 
+			      sysShift, cfgBinning, svFitMassHypothesis, 
+			      tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
+			      fillGenMatchHistograms, fillControlPlots, writeHistogramBundles, plot_triggerBits, selEventsFileName_sysShift);
+	sysShiftEntry->regionEntries_.push_back(regionEntry);
+
+	// tau+ candidates only
+	//regionEntryType* regionEntry_plus = 
+	//  new regionEntryType(*fs, process, std::string(*region).append("+"), tauIdDiscriminators, tauIdName, 
+	//		      sysShift, cfgBinning, svFitMassHypothesis, 
+	//		      tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
+	//		      fillGenMatchHistograms, fillControlPlots, writeHistogramBundles, plot_triggerBits, selEventsFileName_sysShift);
+	//sysShiftEntry->regionEntries_.push_back(regionEntry_plus);
+	//
+	// tau- candidates only
+	//regionEntryType* regionEntry_minus = 
+	//  new regionEntryType(*fs, process, std::string(*region).append("-"), tauIdDiscriminators, tauIdName, 
+	//		      sysShift, cfgBinning, svFitMassHypothesis, 
+	//		      tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
+	//		      fillGenMatchHistograms, fillControlPlots, writeHistogramBundles, plot_triggerBits, selEventsFileName_sysShift);
+	//sysShiftEntry->regionEntries_.push_back(regionEntry_minus);
+      }
+    }
+
+//--- initialize scans of nested tau id. working-points
+//   (optional)
+    for ( vParameterSet::const_iterator cfgTauIdScan = cfgTauIdScans.begin();
+	  cfgTauIdScan != cfgTauIdScans.end(); ++cfgTauIdScan ) {
+      tauIdScanEntryType* tauIdScanEntry = 
+	new tauIdScanEntryType(*fs, *cfgTauIdScan, process, regions, 
+			       sysShift, cfgBinning, svFitMassHypothesis, 
+			       tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
+			       fillGenMatchHistograms, fillControlPlots, writeHistogramBundles, plot_triggerBits);
+      sysShiftEntry->tauIdScanEntries_.push_back(tauIdScanEntry);
+    }
+
+    edm::ParameterSet cfgSelectorABCD = cfgEventSelCuts;
+    cfgSelectorABCD.addParameter<vstring>("tauIdDiscriminators", vstring());
+    cfgSelectorABCD.addParameter<std::string>("region", "ABCD");
+    cfgSelectorABCD.addParameter<std::string>("tauChargeMode", tauChargeMode);
+    cfgSelectorABCD.addParameter<bool>("disableTauCandPreselCuts", disableTauCandPreselCuts);
+
+    sysShiftEntry->selectorABCD_ = new TauIdEffEventSelector(cfgSelectorABCD);
+
+    for ( vParameterSet::const_iterator cfgTauIdDiscriminator = cfgTauIdDiscriminators.begin();
+	  cfgTauIdDiscriminator != cfgTauIdDiscriminators.end(); ++cfgTauIdDiscriminator ) {
+      sysShiftEntry->muTauPairInputs_.addTauIdDiscriminators(cfgTauIdDiscriminator->getParameter<vstring>("discriminators"));
+    }
+
+    sysShiftEntries.push_back(sysShiftEntry);
+  }
+
+//--- determine tau id. discriminators the values of which need to be extracted per muon + tau-jet pair
+  vstring entryTauIdDiscriminators;
   for ( vParameterSet::const_iterator cfgTauIdDiscriminator = cfgTauIdDiscriminators.begin();
 	cfgTauIdDiscriminator != cfgTauIdDiscriminators.end(); ++cfgTauIdDiscriminator ) {
-    for ( vstring::const_iterator region = regions.begin();
-	  region != regions.end(); ++region ) {
-      vstring tauIdDiscriminators = cfgTauIdDiscriminator->getParameter<vstring>("discriminators");
-      std::string tauIdName = cfgTauIdDiscriminator->getParameter<std::string>("name");
-
-      // all tau charges
-      regionEntryType* regionEntry = 
-	new regionEntryType(fs, process, *region, tauIdDiscriminators, tauIdName, 
-			    sysShift, cfgBinning, svFitMassHypothesis, 
-			    tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
-			    fillGenMatchHistograms, fillControlPlots, plot_triggerBits, selEventsFileName);
-      regionEntries.push_back(regionEntry);
-
-      // tau+ candidates only
-      //regionEntryType* regionEntry_plus = 
-      //  new regionEntryType(fs, process, std::string(*region).append("+"), tauIdDiscriminators, tauIdName, 
-      //		      sysShift, cfgBinning, svFitMassHypothesis, 
-      //		      tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
-      //		      fillGenMatchHistograms, fillControlPlots, plot_triggerBits, selEventsFileName);
-      //regionEntries.push_back(regionEntry_plus);
-      //
-      // tau- candidates only
-      //regionEntryType* regionEntry_minus = 
-      //  new regionEntryType(fs, process, std::string(*region).append("-"), tauIdDiscriminators, tauIdName, 
-      //		      sysShift, cfgBinning, svFitMassHypothesis, 
-      //		      tauChargeMode, disableTauCandPreselCuts, cfgEventSelCuts, 
-      //		      fillGenMatchHistograms, fillControlPlots, plot_triggerBits, selEventsFileName);
-      //regionEntries.push_back(regionEntry_minus);
-    }
-  }
-
-  edm::ParameterSet cfgSelectorABCD = cfgEventSelCuts;
-  cfgSelectorABCD.addParameter<vstring>("tauIdDiscriminators", vstring());
-  cfgSelectorABCD.addParameter<std::string>("region", "ABCD");
-  cfgSelectorABCD.addParameter<std::string>("tauChargeMode", tauChargeMode);
-  cfgSelectorABCD.addParameter<bool>("disableTauCandPreselCuts", disableTauCandPreselCuts);
-
-  TauIdEffEventSelector* selectorABCD = new TauIdEffEventSelector(cfgSelectorABCD);
+    addTauIdDiscriminators(entryTauIdDiscriminators, cfgTauIdDiscriminator->getParameter<vstring>("discriminators"));
+  }
+  for ( std::vector<tauIdScanEntryType*>::const_iterator tauIdScanEntry = sysShiftEntries.front()->tauIdScanEntries_.begin();
+	tauIdScanEntry != sysShiftEntries.front()->tauIdScanEntries_.end(); ++tauIdScanEntry ) {
+    addTauIdDiscriminators(entryTauIdDiscriminators, (*tauIdScanEntry)->tauIdDiscriminators_);
+    for ( std::vector<vstring>::const_iterator workingPointDiscriminators = (*tauIdScanEntry)->workingPointDiscriminators_.begin();
+	  workingPointDiscriminators != (*tauIdScanEntry)->workingPointDiscriminators_.end(); ++workingPointDiscriminators ) {
+      addTauIdDiscriminators(entryTauIdDiscriminators, *workingPointDiscriminators);
+    }
+  }
+  if ( miniTupleFileNames.size() == 0 ) {
+    for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	  sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+      (*sysShiftEntry)->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    }
+  }
 
 //--- book "dummy" histogram counting number of processed events
-  TH1* histogramEventCounter = fs.make<TH1F>("numEventsProcessed", "Number of processed Events", 3, -0.5, +2.5);
+  TH1* histogramEventCounter = fs->make<TH1F>("numEventsProcessed", "Number of processed Events", 3, -0.5, +2.5);
   histogramEventCounter->GetXaxis()->SetBinLabel(1, "all Events (DBS)");      // CV: bin numbers start at 1 (not 0) !!
   histogramEventCounter->GetXaxis()->SetBinLabel(2, "processed by Skimming");
   histogramEventCounter->GetXaxis()->SetBinLabel(3, "analyzed in PAT-tuple");
@@ -595,24 +1290,87 @@ int main(int argc, char* argv[])
   double xSection = cfgTauIdEffAnalyzer.getParameter<double>("xSection");
   double intLumiData = cfgTauIdEffAnalyzer.getParameter<double>("intLumiData");
 
-  int    numEvents_processed                     = 0; 
-  double numEventsWeighted_processed             = 0.;
-  int    numEvents_passedTrigger                 = 0;
-  double numEventsWeighted_passedTrigger         = 0.;
-  int    numEvents_passedDiMuonVeto              = 0;
-  double numEventsWeighted_passedDiMuonVeto      = 0.;
-  int    numEvents_passedDiMuTauPairVeto         = 0;
-  double numEventsWeighted_passedDiMuTauPairVeto = 0.;
+  // CV: number of processed events is the same for all systematic shifts,
+  //     take it from the first one in order to check if maximal number of events to be processed is reached
+  const int& numEvents_processed = sysShiftEntries.front()->numEvents_processed_;
 
   edm::RunNumber_t lastLumiBlock_run = -1;
   edm::LuminosityBlockNumber_t lastLumiBlock_ls = -1;
 
+//--- keep track of luminosity sections counted already,
+//    as luminosity sections may be split across input files
+  typedef std::pair<edm::RunNumber_t, edm::LuminosityBlockNumber_t> lumiBlockType;
+  std::set<lumiBlockType> processedLumiBlocks;
+
+  double numEvents_skimmed = 0.;
   double intLumiData_analyzed = 0.;
   edm::InputTag srcLumiProducer = cfgTauIdEffAnalyzer.getParameter<edm::InputTag>("srcLumiProducer");
 
-  bool maxEvents_processed = false;
+  if ( miniTupleFileNames.size() == 0 ) applyMuonIsoWeights &= ( muonIsoProbExtractor != 0 );
+
+  TauIdEffResultCache* resultCache = 0;
+  if ( resultCacheDirectory != "" ) {
+    if ( maxEvents > 0 ) {
+      std::cout << "Warning: maxEvents = " << maxEvents << " --> disabling cache of results per input file !!" << std::endl;
+    } else if ( selEventsFileName != "" ) {
+      std::cout << "Warning: selEventsFileName = " << selEventsFileName << " --> disabling cache of results per input file !!" << std::endl;
+    } else {
+      resultCache = new TauIdEffResultCache(resultCacheDirectory, getResultCacheConfigDigest(cfgTauIdEffAnalyzer, lumiMask), &fs->file());
+      resultCache->addLumiBlockCounter("numEvents_skimmed", &numEvents_skimmed);
+      resultCache->addLumiBlockCounter("intLumiData_analyzed", &intLumiData_analyzed);
+      addSysShiftCounters(resultCache, sysShiftEntries);
+    }
+  }
+
+//--- save histograms and event counters periodically (optional),
+//    so that job can be resumed in case it gets killed before completion
+  TauIdEffCheckpoint* checkpoint = 0;
+  unsigned idxInputFile_resume = 0;
+  long numEvents_resume = 0;
+  if ( checkpointFileName != "" ) {
+    if ( resultCache ) {
+      std::cout << "Warning: cache of results per input file enabled --> disabling checkpoints !!" << std::endl;
+    } else if ( selEventsFileName != "" ) {
+      std::cout << "Warning: selEventsFileName = " << selEventsFileName << " --> disabling checkpoints !!" << std::endl;
+    } else {
+      checkpoint = new TauIdEffCheckpoint(checkpointFileName, cfg.toString(), &fs->file(), checkpointInterval);
+      checkpoint->addCounter("numEvents_skimmed", &numEvents_skimmed);
+      checkpoint->addCounter("intLumiData_analyzed", &intLumiData_analyzed);
+      checkpoint->addCounter("lastLumiBlock_run", &lastLumiBlock_run);
+      checkpoint->addCounter("lastLumiBlock_ls", &lastLumiBlock_ls);
+      addSysShiftCounters(checkpoint, sysShiftEntries);
+      if ( checkpoint->resume(idxInputFile_resume, numEvents_resume) ) {
+	std::cout << "resuming job from checkpoint: inputFile #" << idxInputFile_resume << ", event #" << numEvents_resume << std::endl;
+	// CV: luminosity sections processed before the job got interrupted are not stored in the checkpoint,
+	//     except for the last one (which may continue after the position at which the job is resumed)
+	processedLumiBlocks.insert(lumiBlockType(lastLumiBlock_run, lastLumiBlock_ls));
+      }
+    }
+  }
+
+  bool maxEvents_processed = ( maxEvents > 0 && numEvents_processed >= maxEvents );
+  unsigned idxInputFile = 0;
   for ( vstring::const_iterator inputFileName = inputFiles.files().begin();
-	inputFileName != inputFiles.files().end() && !maxEvents_processed; ++inputFileName ) {
+	inputFileName != inputFiles.files().end() && !maxEvents_processed && miniTupleFileNames.size() == 0; ++inputFileName, ++idxInputFile ) {
+
+//--- skip input files processed completely before job got interrupted
+    if ( idxInputFile < idxInputFile_resume ) continue;
+
+//--- take histograms and event counters from cache, 
+//    in case input file has already been processed with same configuration
+    if ( resultCache ) {
+      if ( resultCache->load(*inputFileName) ) {
+	std::cout << "taking results for inputFile = " << (*inputFileName) << " from cache." << std::endl;
+	continue;
+      }
+      resultCache->beginFile();
+      // CV: luminosity sections may be split across input files;
+      //     count luminosity sections per input file, in order to make result independent of which files are cached
+      //    (luminosity sections contained in more than one input file are counted once only by TauIdEffResultCache)
+      lastLumiBlock_run = -1;
+      lastLumiBlock_ls = -1;
+      processedLumiBlocks.clear();
+    }
 
 //--- open input file
     TFile* inputFile = TFile::Open(inputFileName->data());
@@ -625,8 +1383,36 @@ int main(int argc, char* argv[])
     if ( tree ) std::cout << " (" << tree->GetEntries() << " Events)";
     std::cout << std::endl;
 
+//--- skip input files which contain no luminosity section passing run-range and luminosity section selection
+    if ( !lumiMask.isEmpty() && !isSelectedInputFile(inputFile, lumiMask) ) {
+      std::cout << "no selected luminosity sections in inputFile = " << (*inputFileName) << " --> skipping." << std::endl;
+      delete inputFile;
+      if ( resultCache ) resultCache->endFile(*inputFileName);
+      if ( checkpoint ) checkpoint->write(idxInputFile + 1, 0);
+      continue;
+    }
+
     fwlite::Event evt(inputFile);
-    for ( evt.toBegin(); !(evt.atEnd() || maxEvents_processed); ++evt ) {
+    long numEvents_inputFile = 0;
+    evt.toBegin();
+    if ( idxInputFile == idxInputFile_resume && numEvents_resume > 0 ) {
+      evt.to(numEvents_resume);
+      numEvents_inputFile = numEvents_resume;
+    }
+    for ( ; !(evt.atEnd() || maxEvents_processed); ++evt, ++numEvents_inputFile ) {
+
+      if ( checkpoint && checkpoint->isDue(numEvents_inputFile) ) checkpoint->write(idxInputFile, numEvents_inputFile);
+
+//--- check if current event is within specified run-range and certified luminosity sections
+//   (this check is important in case triggers changed or became active/inactive **during** a data-taking period)
+//
+//    CV: check is done before any event data is read,
+//        only the event auxiliary information (run, luminosity section and event numbers) is needed
+//
+      if ( !lumiMask(evt.id().run(), evt.luminosityBlock()) ) continue;
+
+//--- muon isolation probabilities are memoized per event
+      if ( muonIsoProbExtractor ) muonIsoProbExtractor->beginEvent();
 
 //--- compute event weight
 //   (pile-up reweighting, Data/MC correction factors,...)
@@ -647,30 +1433,15 @@ int main(int argc, char* argv[])
       if ( caloMETs->size() != 1 )
 	throw cms::Exception("FWLiteTauIdEffAnalyzer")
 	  << "Failed to find unique CaloMEt object !!\n";
-      pat::MET caloMEt = caloMETs->front();
+      const pat::MET& caloMEt = caloMETs->front();
       //std::cout << " " << srcCaloMEt.label() << ": " << caloMEt.pt() << std::endl;
-      if ( shiftCaloMEtResponse != 0 ) {
-        reco::Candidate::LorentzVector caloMEtP4 = caloMEt.p4();
-        if      ( shiftCaloMEtResponse == +1 ) caloMEtP4 *= 1.15;
-        else if ( shiftCaloMEtResponse == -1 ) caloMEtP4 *= 0.85;
-        else assert(0);
-        caloMEt.setP4(caloMEtP4);
+      for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	    sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+	(*sysShiftEntry)->setCaloMEtAndEvtWeight(caloMEt.pt(), evtWeight, isData);
       }
 
-      if ( !isData ) {
-	double triggerEffCorrection_value = triggerEffCorrection->Eval(caloMEt.pt());
-	//std::cout << " triggerEffCorrection_value = " << triggerEffCorrection_value << std::endl;
-	evtWeight *= triggerEffCorrection_value;
-      }
-
-//--- check if current event is within specified run-range
-//   (this check is important in case triggers changed or became active/inactive **during** a data-taking period)
-      if ( (firstRun != -1 && (int)evt.id().run() < firstRun) || 
-	   (lastRun  != -1 && (int)evt.id().run() > lastRun ) ) continue;
-
 //--- quit event loop if maximal number of events to be processed is reached 
-      ++numEvents_processed;
-      numEventsWeighted_processed += evtWeight;
+      incrementSysShiftCounters(sysShiftEntries, &sysShiftEntryType::numEvents_processed_, &sysShiftEntryType::numEventsWeighted_processed_);
       if ( maxEvents > 0 && numEvents_processed >= maxEvents ) maxEvents_processed = true;
 
       //std::cout << "processing run = " << evt.id().run() << ":" 
@@ -678,19 +1449,33 @@ int main(int argc, char* argv[])
 
 //--- check if new luminosity section has started;
 //    if so, retrieve number of events contained in this luminosity section before skimming
+//   (each luminosity section is counted once only, also in case it is split across input files)
       if ( !(evt.id().run() == lastLumiBlock_run && evt.luminosityBlock() == lastLumiBlock_ls) ) {
-	const fwlite::LuminosityBlock& ls = evt.getLuminosityBlock();
-	edm::Handle<edm::MergeableCounter> numEvents_skimmed;
-	ls.getByLabel(srcEventCounter, numEvents_skimmed);
-	if ( numEvents_skimmed.isValid() ) histogramEventCounter->Fill(1, numEvents_skimmed->value);
 	lastLumiBlock_run = evt.id().run();
 	lastLumiBlock_ls = evt.luminosityBlock();
 
-	if ( isData ) {
-	  edm::Handle<LumiSummary> lumiSummary;
-	  edm::InputTag srcLumiProducer("lumiProducer");
-	  ls.getByLabel(srcLumiProducer, lumiSummary);
-	  intLumiData_analyzed += lumiSummary->intgRecLumi();
+	if ( processedLumiBlocks.insert(lumiBlockType(lastLumiBlock_run, lastLumiBlock_ls)).second ) {
+	  const fwlite::LuminosityBlock& ls = evt.getLuminosityBlock();
+	  edm::Handle<edm::MergeableCounter> numEvents_skimmed_ls;
+	  ls.getByLabel(srcEventCounter, numEvents_skimmed_ls);
+	  double numEvents_skimmed_increment = ( numEvents_skimmed_ls.isValid() ) ? numEvents_skimmed_ls->value : 0.;
+
+	  double intLumiData_increment = 0.;
+	  if ( isData ) {
+	    edm::Handle<LumiSummary> lumiSummary;
+	    edm::InputTag srcLumiProducer("lumiProducer");
+	    ls.getByLabel(srcLumiProducer, lumiSummary);
+	    intLumiData_increment = lumiSummary->intgRecLumi();
+	  }
+
+	  numEvents_skimmed += numEvents_skimmed_increment;
+	  intLumiData_analyzed += intLumiData_increment;
+	  if ( resultCache ) {
+	    std::vector<double> lumiBlockIncrements;
+	    lumiBlockIncrements.push_back(numEvents_skimmed_increment);
+	    lumiBlockIncrements.push_back(intLumiData_increment);
+	    resultCache->addLumiBlock(lastLumiBlock_run, lastLumiBlock_ls, lumiBlockIncrements);
+	  }
 	}
       }
 
@@ -707,8 +1492,7 @@ int main(int argc, char* argv[])
 
       if ( !anyHLTpath_passed ) continue;
 
-      ++numEvents_passedTrigger;
-      numEventsWeighted_passedTrigger += evtWeight;
+      incrementSysShiftCounters(sysShiftEntries, &sysShiftEntryType::numEvents_passedTrigger_, &sysShiftEntryType::numEventsWeighted_passedTrigger_);
 
 //--- require event to contain only one "good quality" muon
       typedef std::vector<pat::Muon> PATMuonCollection;
@@ -717,28 +1501,8 @@ int main(int argc, char* argv[])
       size_t numGoodMuons = goodMuons->size();
 	
       if ( !(numGoodMuons <= 1) ) continue;
-      ++numEvents_passedDiMuonVeto;
-      numEventsWeighted_passedDiMuonVeto += evtWeight;
-
-//--- require event to contain exactly one muon + tau-jet pair
-//    passing the selection criteria for region "ABCD"
-      edm::Handle<PATMuTauPairCollection> muTauPairs;
-      evt.getByLabel(srcMuTauPairs, muTauPairs);           
+      incrementSysShiftCounters(sysShiftEntries, &sysShiftEntryType::numEvents_passedDiMuonVeto_, &sysShiftEntryType::numEventsWeighted_passedDiMuonVeto_);
 
-      unsigned numMuTauPairsABCD = 0; // Note: no b-jet veto applied
-      for ( PATMuTauPairCollection::const_iterator muTauPair = muTauPairs->begin();
-	    muTauPair != muTauPairs->end(); ++muTauPair ) {
-	pat::strbitset evtSelFlags;
-	if ( selectorABCD->operator()(*muTauPair, caloMEt, 0, evtSelFlags) ) ++numMuTauPairsABCD;
-      }
-      
-      if ( !(numMuTauPairsABCD <= 1) ) continue;
-      ++numEvents_passedDiMuTauPairVeto;
-      numEventsWeighted_passedDiMuTauPairVeto += evtWeight;
-
-      edm::Handle<pat::JetCollection> jets;
-      evt.getByLabel(srcJets, jets);         
-      
 //--- determine number of vertices reconstructed in the event
 //   (needed to parametrize dependency of tau id. efficiency on number of pile-up interactions)
       edm::Handle<reco::VertexCollection> vertices;
@@ -751,53 +1515,224 @@ int main(int argc, char* argv[])
 	checkHLTpaths(evt, plot_hltPaths, srcHLTresults, &plot_triggerBits_passed, NULL);
       }
 
-//--- iterate over collection of muon + tau-jet pairs:
-//    check which region muon + tau-jet pair is selected in,
-//    fill histograms for that region
-      if ( requireUniqueMuTauPair && muTauPairs->size () > 1 ) continue;  
-      for ( PATMuTauPairCollection::const_iterator muTauPair = muTauPairs->begin();
-	    muTauPair != muTauPairs->end(); ++muTauPair ) {
+      edm::Handle<reco::GenParticleCollection> genParticles;
+      if ( fillGenMatchHistograms ) evt.getByLabel(srcGenParticles, genParticles);
+
+//--- process central value and systematic shifts
+      for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	    sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+	edm::Handle<PATMuTauPairCollection> muTauPairs;
+	evt.getByLabel((*sysShiftEntry)->srcMuTauPairs_, muTauPairs);           
+
+	size_t numMuTauPairs = muTauPairs->size();
+	std::vector<double> muTauPairTauShiftFactors(numMuTauPairs, 1.);
+	if ( (*sysShiftEntry)->srcTauShiftFactors_.label() != "" ) {
+	  edm::Handle<edm::ValueMap<float> > tauShiftFactors;
+	  evt.getByLabel((*sysShiftEntry)->srcTauShiftFactors_, tauShiftFactors);
+	  for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+	    muTauPairTauShiftFactors[idxMuTauPair] = (*tauShiftFactors)[muTauPairs->at(idxMuTauPair).leg2()];
+	  }
+	}
+	edm::Handle<PATMETCollection> shiftedMETs;
+	const reco::Candidate::LorentzVector* metP4_shifted = 0;
+	if ( (*sysShiftEntry)->srcMEt_.label() != "" ) {
+	  evt.getByLabel((*sysShiftEntry)->srcMEt_, shiftedMETs);
+	  if ( shiftedMETs->size() != 1 )
+	    throw cms::Exception("FWLiteTauIdEffAnalyzer")
+	      << "Failed to find unique MEt object in collection = " << (*sysShiftEntry)->srcMEt_.label() << " !!\n";
+	  metP4_shifted = &shiftedMETs->front().p4();
+	}
+
+	edm::Handle<pat::JetCollection> jets;
+	evt.getByLabel((*sysShiftEntry)->srcJets_, jets);         
+
+//--- extract all quantities needed for the selection of muon + tau-jet pairs 
+//    and for filling histograms once per muon + tau-jet pair
+	std::vector<TauIdEffMiniTupleEntry>& muTauPairEntries = (*sysShiftEntry)->muTauPairEntries_;
+	muTauPairEntries.resize(numMuTauPairs);
+	for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+	  const PATMuTauPair& muTauPair = muTauPairs->at(idxMuTauPair);
+	  TauIdEffMiniTupleEntry& muTauPairEntry = muTauPairEntries[idxMuTauPair];
+	  fillMiniTupleEntry(muTauPair, muTauPairTauShiftFactors[idxMuTauPair], svFitMassHypothesis, entryTauIdDiscriminators, muTauPairEntry,
+			     metP4_shifted);
+	  muTauPairEntry.run_          = evt.id().run();
+	  muTauPairEntry.ls_           = evt.luminosityBlock();
+	  muTauPairEntry.event_        = evt.id().event();
+	  muTauPairEntry.numVertices_  = numVertices;
+	  muTauPairEntry.caloMEtPt_    = caloMETs->front().pt();
+	  muTauPairEntry.caloMEtSumEt_ = caloMETs->front().sumEt();
+	  muTauPairEntry.idxMuTauPair_ = idxMuTauPair;
 
 //--- require event to contain to b-jets
 //   (not overlapping with muon or tau-jet candidate)
-	size_t numJets         = 0;
-	size_t numJets_bTagged = 0;
-	for ( pat::JetCollection::const_iterator jet = jets->begin();
-	      jet != jets->end(); ++jet ) {
-	  if ( deltaR(jet->p4(), muTauPair->leg1()->p4()) > 0.5 &&
-	       deltaR(jet->p4(), muTauPair->leg2()->p4()) > 0.5 &&
-               jet->pt() > 30. && TMath::Abs(jet->eta()) < 2.4 && jetId(*jet) ) {
-	    ++numJets;
-	    if ( jet->bDiscriminator("combinedSecondaryVertexBJetTags") > 0.679 ) ++numJets_bTagged; // "medium" WP
+	  size_t numJets         = 0;
+	  size_t numJets_bTagged = 0;
+	  for ( pat::JetCollection::const_iterator jet = jets->begin();
+		jet != jets->end(); ++jet ) {
+	    if ( deltaR(jet->p4(), muTauPair.leg1()->p4()) > 0.5 &&
+		 deltaR(jet->p4(), muTauPair.leg2()->p4()) > 0.5 &&
+		 jet->pt() > 30. && TMath::Abs(jet->eta()) < 2.4 && jetId(*jet) ) {
+	      ++numJets;
+	      if ( jet->bDiscriminator("combinedSecondaryVertexBJetTags") > 0.679 ) ++numJets_bTagged; // "medium" WP
+	    }
 	  }
-	}
+	  muTauPairEntry.numJets_         = numJets;
+	  muTauPairEntry.numJets_bTagged_ = numJets_bTagged;
 
 //--- determine type of particle matching reconstructed tau-jet candidate
 //    on generator level (used in case of Ztautau or Zmumu Monte Carlo samples only,
 //    in order to distinguish between jet --> tau fakes, muon --> tau fakes and genuine taus)
-	int genMatchType = kUnmatched;
-	if ( fillGenMatchHistograms ) {
-	  edm::Handle<reco::GenParticleCollection> genParticles;
-	  evt.getByLabel(srcGenParticles, genParticles);	  
-	  genMatchType = getGenMatchType(*muTauPair, *genParticles);
-	}
+	  muTauPairEntry.genMatchType_ = ( fillGenMatchHistograms ) ? 
+	    getGenMatchType(muTauPair, *genParticles) : kUnmatched;
 
-	for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
-	      regionEntry != regionEntries.end(); ++regionEntry ) {	  
-	  double evtWeight_region = evtWeight;
-	  if ( muonIsoProbExtractor && applyMuonIsoWeights && (*regionEntry)->region_.find("_mW") != std::string::npos ) 
-	    evtWeight_region *= (*muonIsoProbExtractor)(*muTauPair->leg1());
-	  (*regionEntry)->analyze(evt, *muTauPair, caloMEt, 
-				  numJets, numJets_bTagged,
-				  numVertices, plot_triggerBits_passed, genMatchType, evtWeight_region);
+	  muTauPairEntry.muonIsoProb_ = ( applyMuonIsoWeights ) ? 
+	    (*muonIsoProbExtractor)(*muTauPair.leg1()) : 1.;
 	}
+
+	analyzeMuTauPairs(**sysShiftEntry, muTauPairEntries, plot_triggerBits_passed, 
+			  applyMuonIsoWeights, requireUniqueMuTauPair, useBatchSelection);
       }
     }
 
 //--- close input file
     delete inputFile;
+
+    if ( resultCache ) resultCache->endFile(*inputFileName);
+    if ( checkpoint ) checkpoint->write(idxInputFile + 1, 0);
+  }
+
+//--- process mini-tuples
+//   (optional)
+//
+//    CV: run-range and luminosity section selection are applied when mini-tuples are produced
+//       (event counters stored in mini-tuple refer to selected luminosity sections only)
+//
+  vstring miniTupleTauIdDiscriminators;
+  bool miniTupleTauIdDiscriminators_initialized = false;
+  std::vector<TauIdEffMiniTupleEntry> miniTupleEntries;
+  unsigned idxMiniTupleFile = 0;
+  for ( vstring::const_iterator miniTupleFileName = miniTupleFileNames.begin();
+	miniTupleFileName != miniTupleFileNames.end(); ++miniTupleFileName, ++idxMiniTupleFile ) {
+    // CV: checkpoints are written after each mini-tuple file only
+    if ( idxMiniTupleFile < idxInputFile_resume ) continue;
+
+    if ( resultCache ) {
+      if ( resultCache->load(*miniTupleFileName) ) {
+	std::cout << "taking results for miniTupleFile = " << (*miniTupleFileName) << " from cache." << std::endl;
+	continue;
+      }
+      resultCache->beginFile();
+    }
+
+    TauIdEffMiniTupleReader miniTuple(*miniTupleFileName);
+    std::cout << "opening miniTupleFile = " << (*miniTupleFileName) 
+	      << " (" << miniTuple.numEntries() << " muon + tau-jet pairs)" << std::endl;
+
+//--- check that all quantities needed are stored in mini-tuple
+    if ( !miniTupleTauIdDiscriminators_initialized ) {
+      miniTupleTauIdDiscriminators = miniTuple.tauIdDiscriminators();
+      miniTupleTauIdDiscriminators_initialized = true;
+      for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	    sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+	(*sysShiftEntry)->setEntryTauIdDiscriminators(miniTupleTauIdDiscriminators);
+      }
+    } else if ( miniTuple.tauIdDiscriminators() != miniTupleTauIdDiscriminators ) {
+      throw cms::Exception("FWLiteTauIdEffAnalyzer") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains different tau id. discriminators than previous files !!\n";
+    }
+    if ( fillGenMatchHistograms && !miniTuple.hasColumn("genMatchType") )
+      throw cms::Exception("FWLiteTauIdEffAnalyzer") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains no generator level matching information !!\n";
+    if ( applyMuonIsoWeights && !miniTuple.hasColumn("muonIsoProb") )
+      throw cms::Exception("FWLiteTauIdEffAnalyzer") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains no muon isolation probabilities !!\n";
+    if ( svFitMassHypothesis != "" && !miniTuple.hasColumn("svFitMass") )
+      throw cms::Exception("FWLiteTauIdEffAnalyzer") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains no SVfit masses !!\n";
+
+//--- match systematic shifts stored in mini-tuple to systematic shifts to be processed
+    const vstring& miniTupleSysShifts = miniTuple.sysShifts();
+    std::vector<sysShiftEntryType*> miniTupleSysShiftEntries(miniTupleSysShifts.size());
+    for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	  sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+      vstring::const_iterator miniTupleSysShift = std::find(miniTupleSysShifts.begin(), miniTupleSysShifts.end(), (*sysShiftEntry)->sysShift_);
+      if ( miniTupleSysShift == miniTupleSysShifts.end() )
+	throw cms::Exception("FWLiteTauIdEffAnalyzer") 
+	  << "Mini-tuple file = " << (*miniTupleFileName) << " contains no muon + tau-jet pairs for sysShift = " << (*sysShiftEntry)->sysShift_ << " !!\n";
+      miniTupleSysShiftEntries[miniTupleSysShift - miniTupleSysShifts.begin()] = (*sysShiftEntry);
+    }
+
+//--- take event counters from mini-tuple
+//   (CV: weighted event counters stored in mini-tuple do not include the trigger efficiency correction,
+//        the same numbers are hence added to all systematic shifts)
+    for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	  sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+      (*sysShiftEntry)->numEvents_processed_                += TMath::Nint(miniTuple.getCounter("numEvents_processed"));
+      (*sysShiftEntry)->numEventsWeighted_processed_        += miniTuple.getCounter("numEventsWeighted_processed");
+      (*sysShiftEntry)->numEvents_passedTrigger_            += TMath::Nint(miniTuple.getCounter("numEvents_passedTrigger"));
+      (*sysShiftEntry)->numEventsWeighted_passedTrigger_    += miniTuple.getCounter("numEventsWeighted_passedTrigger");
+      (*sysShiftEntry)->numEvents_passedDiMuonVeto_         += TMath::Nint(miniTuple.getCounter("numEvents_passedDiMuonVeto"));
+      (*sysShiftEntry)->numEventsWeighted_passedDiMuonVeto_ += miniTuple.getCounter("numEventsWeighted_passedDiMuonVeto");
+    }
+    numEvents_skimmed += miniTuple.getCounter("numEvents_skimmed");
+    histogramEventCounter->Fill(2, miniTuple.getCounter("numEvents_processed"));
+    if ( isData ) intLumiData_analyzed += miniTuple.getCounter("intLumiData_analyzed");
+
+    const vstring& miniTupleTriggerBits = miniTuple.triggerBits();
+
+    size_t idxEntry = 0;
+    while ( idxEntry < miniTuple.numEntries() ) {
+      idxEntry = miniTuple.readEvent(idxEntry, miniTupleEntries);
+      const TauIdEffMiniTupleEntry& miniTupleEvent = miniTupleEntries.front();
+
+//--- check L1 bits for trigger efficiency control plots
+      std::map<std::string, bool> plot_triggerBits_passed;
+      for ( size_t idxTriggerBit = 0; idxTriggerBit < miniTupleTriggerBits.size(); ++idxTriggerBit ) {
+	if ( std::find(plot_triggerBits.begin(), plot_triggerBits.end(), miniTupleTriggerBits[idxTriggerBit]) != plot_triggerBits.end() )
+	  plot_triggerBits_passed[miniTupleTriggerBits[idxTriggerBit]] = ((miniTupleEvent.triggerBits_ >> idxTriggerBit) & 1);
+      }
+
+//--- compute event weight
+      double evtWeight = miniTupleEvent.evtWeight_;
+      if ( evtWeight < minWeight ) evtWeight = minWeight;
+      if ( evtWeight > maxWeight ) evtWeight = maxWeight;
+
+      for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	    sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+	(*sysShiftEntry)->setCaloMEtAndEvtWeight(miniTupleEvent.caloMEtPt_, evtWeight, isData);
+	(*sysShiftEntry)->muTauPairEntries_.clear();
+      }
+      for ( std::vector<TauIdEffMiniTupleEntry>::const_iterator miniTupleEntry = miniTupleEntries.begin();
+	    miniTupleEntry != miniTupleEntries.end(); ++miniTupleEntry ) {
+	sysShiftEntryType* sysShiftEntry = miniTupleSysShiftEntries[miniTupleEntry->idxSysShift_];
+	if ( sysShiftEntry ) sysShiftEntry->muTauPairEntries_.push_back(*miniTupleEntry);
+      }
+
+//--- process central value and systematic shifts
+//   (CV: mini-tuples contain events with at least one muon + tau-jet pair only)
+      for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	    sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+	if ( (*sysShiftEntry)->muTauPairEntries_.size() == 0 ) continue;
+	analyzeMuTauPairs(**sysShiftEntry, (*sysShiftEntry)->muTauPairEntries_, plot_triggerBits_passed, 
+			  applyMuonIsoWeights, requireUniqueMuTauPair, useBatchSelection);
+      }
+    }
+
+    if ( resultCache ) resultCache->endFile(*miniTupleFileName);
+    if ( checkpoint ) checkpoint->write(idxMiniTupleFile + 1, 0);
+  }
+
+//--- set histograms and event counters to sum over all input files
+  if ( resultCache ) {
+    resultCache->finish();
+    std::cout << "results for " << resultCache->numFilesLoaded() << " input files taken from cache," 
+	      << " " << resultCache->numFilesStored() << " input files processed." << std::endl;
+    delete resultCache;
   }
 
+//--- fill number of events contained in processed luminosity sections before skimming
+  histogramEventCounter->Fill(1, numEvents_skimmed);
+
 //--- scale histograms taken from Monte Carlo simulation
 //    according to cross-section times luminosity
   if ( !isData ) {
@@ -820,9 +1755,19 @@ int main(int argc, char* argv[])
       std::cout << "    due to aborted skimming/crab or PAT-tuple production/lxbatch jobs." << std::endl;
     }
 
+    std::vector<regionEntryType*> regionEntriesToScale;
+    for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	  sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+      regionEntriesToScale.insert(regionEntriesToScale.end(), (*sysShiftEntry)->regionEntries_.begin(), (*sysShiftEntry)->regionEntries_.end());
+      for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = (*sysShiftEntry)->tauIdScanEntries_.begin();
+	    tauIdScanEntry != (*sysShiftEntry)->tauIdScanEntries_.end(); ++tauIdScanEntry ) {
+	regionEntriesToScale.insert(regionEntriesToScale.end(), (*tauIdScanEntry)->regionEntries_.begin(), (*tauIdScanEntry)->regionEntries_.end());
+	(*tauIdScanEntry)->scaleHistograms(mcScaleFactor*lostStatCorrFactor);
+      }
+    }
     std::vector<histManagerEntryType*> histManagerEntriesToScale;
-    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
-	  regionEntry != regionEntries.end(); ++regionEntry ) {  
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntriesToScale.begin();
+	  regionEntry != regionEntriesToScale.end(); ++regionEntry ) {  
       histManagerEntriesToScale.push_back((*regionEntry)->histogramsUnbinned_);
       for ( std::vector<histManagerEntryType*>::iterator histManagerEntry = (*regionEntry)->histogramEntriesBinned_.begin();
 	    histManagerEntry != (*regionEntry)->histogramEntriesBinned_.end(); ++histManagerEntry ) {
@@ -842,35 +1787,60 @@ int main(int argc, char* argv[])
   }
 
   std::cout << "<FWLiteTauIdEffAnalyzer>:" << std::endl;
-  std::cout << " numEvents_processed: " << numEvents_processed 
-	    << " (weighted = " << numEventsWeighted_processed << ")" << std::endl;
-  std::cout << " numEvents_passedTrigger: " << numEvents_passedTrigger 
-	    << " (weighted = " << numEventsWeighted_passedTrigger << ")" << std::endl;
-  std::cout << " numEvents_passedDiMuonVeto: " << numEvents_passedDiMuonVeto 
-	    << " (weighted = " << numEventsWeighted_passedDiMuonVeto << ")" << std::endl;
-  std::cout << " numEvents_passedDiMuTauPairVeto: " << numEvents_passedDiMuTauPairVeto
-	    << " (weighted = " << numEventsWeighted_passedDiMuTauPairVeto << ")" << std::endl;
-  std::string lastTauIdName = "";
-  for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
-	regionEntry != regionEntries.end(); ++regionEntry ) {
-    if ( (*regionEntry)->tauIdName_ != lastTauIdName ) 
-      std::cout << " numMuTauPairs_selected, " << (*regionEntry)->tauIdName_ << std::endl;
-    std::cout << "  region " << (*regionEntry)->region_ << ":" 
-	      << " " << (*regionEntry)->numMuTauPairs_selected_ 
-	      << " (weighted = " << (*regionEntry)->numMuTauPairsWeighted_selected_ << ")" << std::endl;
-    lastTauIdName = (*regionEntry)->tauIdName_;
+  for ( std::vector<sysShiftEntryType*>::iterator sysShiftEntry = sysShiftEntries.begin();
+	sysShiftEntry != sysShiftEntries.end(); ++sysShiftEntry ) {
+    if ( sysShiftEntries.size() > 1 ) std::cout << "sysShift = " << (*sysShiftEntry)->sysShift_ << ":" << std::endl;
+    std::cout << " numEvents_processed: " << (*sysShiftEntry)->numEvents_processed_
+	      << " (weighted = " << (*sysShiftEntry)->numEventsWeighted_processed_ << ")" << std::endl;
+    std::cout << " numEvents_passedTrigger: " << (*sysShiftEntry)->numEvents_passedTrigger_
+	      << " (weighted = " << (*sysShiftEntry)->numEventsWeighted_passedTrigger_ << ")" << std::endl;
+    std::cout << " numEvents_passedDiMuonVeto: " << (*sysShiftEntry)->numEvents_passedDiMuonVeto_
+	      << " (weighted = " << (*sysShiftEntry)->numEventsWeighted_passedDiMuonVeto_ << ")" << std::endl;
+    std::cout << " numEvents_passedDiMuTauPairVeto: " << (*sysShiftEntry)->numEvents_passedDiMuTauPairVeto_
+	      << " (weighted = " << (*sysShiftEntry)->numEventsWeighted_passedDiMuTauPairVeto_ << ")" << std::endl;
+    std::vector<regionEntryType*> regionEntriesToPrint = (*sysShiftEntry)->regionEntries_;
+    for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = (*sysShiftEntry)->tauIdScanEntries_.begin();
+	  tauIdScanEntry != (*sysShiftEntry)->tauIdScanEntries_.end(); ++tauIdScanEntry ) {
+      regionEntriesToPrint.insert(regionEntriesToPrint.end(), (*tauIdScanEntry)->regionEntries_.begin(), (*tauIdScanEntry)->regionEntries_.end());
+    }
+    std::string lastTauIdName = "";
+    for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntriesToPrint.begin();
+	  regionEntry != regionEntriesToPrint.end(); ++regionEntry ) {
+      if ( (*regionEntry)->tauIdName_ != lastTauIdName ) 
+	std::cout << " numMuTauPairs_selected, " << (*regionEntry)->tauIdName_ << std::endl;
+      std::cout << "  region " << (*regionEntry)->region_ << ":" 
+		<< " " << (*regionEntry)->numMuTauPairs_selected_ 
+		<< " (weighted = " << (*regionEntry)->numMuTauPairsWeighted_selected_ << ")" << std::endl;
+      lastTauIdName = (*regionEntry)->tauIdName_;
+    }
+    for ( std::vector<tauIdScanEntryType*>::iterator tauIdScanEntry = (*sysShiftEntry)->tauIdScanEntries_.begin();
+	  tauIdScanEntry != (*sysShiftEntry)->tauIdScanEntries_.end(); ++tauIdScanEntry ) {
+      if ( (*tauIdScanEntry)->numMuTauPairs_nonNested_ > 0 )
+	std::cout << "Warning: tau id. scan " << (*tauIdScanEntry)->name_ << ":" 
+		  << " " << (*tauIdScanEntry)->numMuTauPairs_nonNested_ << " tau-jet candidates passed a tighter, but failed a looser working-point"
+		  << " --> working-points are not nested !!" << std::endl;
+    }
   }
 
+  if ( muonIsoProbExtractor ) muonIsoProbExtractor->print(std::cout);
   delete muonIsoProbExtractor;
 
-  delete triggerEffCorrection;
-
 //--- close ASCII files containing run + event numbers of events selected in different regions
-  for ( std::vector<regionEntryType*>::iterator it = regionEntries.begin();
-	it != regionEntries.end(); ++it ) {
+  for ( std::vector<sysShiftEntryType*>::iterator it = sysShiftEntries.begin();
+	it != sysShiftEntries.end(); ++it ) {
     delete (*it);
   }
   
+//--- write output file before removing checkpoint,
+//    so that job can be resumed from last checkpoint in case it gets killed while the output is written
+  delete fs;
+
+//--- job completed successfully, checkpoint no longer needed
+  if ( checkpoint ) {
+    checkpoint->remove();
+    delete checkpoint;
+  }
+
   if ( isData ) {
     std::cout << " intLumiData = " << intLumiData << " pb" << std::endl;
     // CV: luminosity is recorded in some 'weird' units,
@@ -0,0 +1,510 @@
+/** \executable FWLiteTauIdEffMiniTupleProducer
+ *
+ * Extract all quantities needed for tau id. efficiency and tau charge misidentification rate measurements
+ * once per muon + tau-jet pair and write them into compact "mini-tuple",
+ * which can be analyzed by FWLiteTauIdEffAnalyzer, FWLiteTauIdEffPreselNumbers and FWLiteTauChargeMisIdPreselNumbers
+ * (via their 'miniTupleFileNames' parameter) without deserializing PAT objects
+ *
+ */
+
+#include "FWCore/FWLite/interface/AutoLibraryLoader.h"
+
+#include "DataFormats/FWLite/interface/Event.h"
+#include "DataFormats/FWLite/interface/LuminosityBlock.h"
+#include "DataFormats/FWLite/interface/Run.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "DataFormats/FWLite/interface/InputSource.h"
+#include "DataFormats/FWLite/interface/OutputFiles.h"
+
+#include "DataFormats/PatCandidates/interface/Tau.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+#include "DataFormats/PatCandidates/interface/Jet.h"
+#include "DataFormats/PatCandidates/interface/MET.h"
+#include "DataFormats/Common/interface/TriggerResults.h"
+#include "FWCore/Common/interface/TriggerNames.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticleFwd.h"
+#include "DataFormats/Common/interface/MergeableCounter.h"
+#include "DataFormats/Luminosity/interface/LumiSummary.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+
+#include "PhysicsTools/SelectorUtils/interface/PFJetIDSelectionFunctor.h"
+#include "DataFormats/Math/interface/deltaR.h"
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMiniTuple.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffLumiMask.h"
+#include "TauAnalysis/TauIdEfficiency/interface/tauIdEffAuxFunctions.h"
+#include "TauAnalysis/TauIdEfficiency/interface/PATMuonLUTvalueGridFromKNN.h"
+
+#include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEt.h"
+#include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEtFwd.h"
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TSystem.h>
+#include <TROOT.h>
+#include <TBenchmark.h>
+#include <TMath.h>
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+
+typedef std::vector<std::string> vstring;
+
+std::string getHLTpath_key(const std::string& hltPath)
+{
+  std::string key = hltPath;
+  size_t idx = hltPath.find_last_of("_v");
+  if ( idx != std::string::npos ) {
+    // CV: std::string.find_last_of returns position of 'v' character
+    //    --> need to decrease 'idx' by one in order to eliminate trailing underscore
+    key = std::string(hltPath, 0, idx - 1);
+  }
+  return key;
+}
+
+void checkHLTpaths(const fwlite::Event& evt,
+		   const vstring& hltPaths,
+		   const edm::InputTag& srcHLTresults,
+		   std::map<std::string, bool>* hltPaths_passed, bool* anyHLTpath_passed)
+{
+  edm::Handle<edm::TriggerResults> hltResults;
+  evt.getByLabel(srcHLTresults, hltResults);
+
+  const edm::TriggerNames& triggerNames = evt.triggerNames(*hltResults);
+
+  if ( hltPaths_passed ) {
+    for ( vstring::const_iterator hltPath = hltPaths.begin();
+	  hltPath != hltPaths.end(); ++hltPath ) {
+      std::string key = getHLTpath_key(*hltPath);
+      (*hltPaths_passed)[key] = false;
+    }
+  }
+
+  if ( anyHLTpath_passed ) {
+    (*anyHLTpath_passed) = false;
+  }
+
+  for ( vstring::const_iterator hltPath = hltPaths.begin();
+	hltPath != hltPaths.end(); ++hltPath ) {
+    bool isHLTpath_passed = false;
+    unsigned int idx = triggerNames.triggerIndex(*hltPath);
+    if ( idx < triggerNames.size() ) {
+      isHLTpath_passed = hltResults->accept(idx);
+    }
+
+    if ( isHLTpath_passed ) {
+      if ( hltPaths_passed ) {
+	std::string key = getHLTpath_key(*hltPath);
+	(*hltPaths_passed)[key] = isHLTpath_passed;
+      }
+
+      if ( anyHLTpath_passed ) {
+	(*anyHLTpath_passed) = true;
+      }
+    }
+  }
+}
+
+struct sysShiftEntryType
+{
+  sysShiftEntryType(const edm::ParameterSet& cfgSysShift)
+    : sysShift_(cfgSysShift.getParameter<std::string>("sysShift")),
+      srcMuTauPairs_(cfgSysShift.getParameter<edm::InputTag>("srcMuTauPairs")),
+      srcJets_(cfgSysShift.getParameter<edm::InputTag>("srcJets")),
+      srcTauShiftFactors_(cfgSysShift.exists("srcTauShiftFactors") ?
+			  cfgSysShift.getParameter<edm::InputTag>("srcTauShiftFactors") : edm::InputTag()),
+      srcMEt_(cfgSysShift.exists("srcMEt") ?
+	      cfgSysShift.getParameter<edm::InputTag>("srcMEt") : edm::InputTag())
+  {}
+  ~sysShiftEntryType() {}
+
+  std::string sysShift_;
+  edm::InputTag srcMuTauPairs_;
+  edm::InputTag srcJets_;
+  edm::InputTag srcTauShiftFactors_; // shift factors applied to tau-jet momenta "on-the-fly" (optional)
+  edm::InputTag srcMEt_;             // shifted MEt matching the shift factors (optional)
+};
+
+//
+// Check if any luminosity section contained in input file passes run-range and luminosity section selection;
+// the check uses the LuminosityBlocks tree only, without reading any event data
+//
+bool isSelectedInputFile(TFile* inputFile, const TauIdEffLumiMask& lumiMask)
+{
+  fwlite::LuminosityBlock ls(inputFile);
+  for ( ls.toBegin(); !ls.atEnd(); ++ls ) {
+    if ( lumiMask(ls.id().run(), ls.id().luminosityBlock()) ) return true;
+  }
+  return false;
+}
+
+int main(int argc, char* argv[])
+{
+//--- parse command-line arguments
+  if ( argc < 2 ) {
+    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    return 0;
+  }
+
+  std::cout << "<FWLiteTauIdEffMiniTupleProducer>:" << std::endl;
+
+//--- load framework libraries
+  gSystem->Load("libFWCoreFWLite");
+  AutoLibraryLoader::enable();
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("FWLiteTauIdEffMiniTupleProducer");
+
+//--- read python configuration parameters
+  if ( !edm::readPSetsFrom(argv[1])->existsAs<edm::ParameterSet>("process") )
+    throw cms::Exception("FWLiteTauIdEffMiniTupleProducer")
+      << "No ParameterSet 'process' found in configuration file = " << argv[1] << " !!\n";
+
+  edm::ParameterSet cfg = edm::readPSetsFrom(argv[1])->getParameter<edm::ParameterSet>("process");
+
+  edm::ParameterSet cfgMiniTupleProducer = cfg.getParameter<edm::ParameterSet>("tauIdEffMiniTupleProducer");
+
+  std::string svFitMassHypothesis = cfgMiniTupleProducer.getParameter<std::string>("svFitMassHypothesis");
+  edm::InputTag srcHLTresults = cfgMiniTupleProducer.getParameter<edm::InputTag>("srcHLTresults");
+  vstring hltPaths = cfgMiniTupleProducer.getParameter<vstring>("hltPaths");
+  edm::InputTag srcCaloMEt = cfgMiniTupleProducer.getParameter<edm::InputTag>("srcCaloMEt");
+  edm::InputTag srcGoodMuons = cfgMiniTupleProducer.getParameter<edm::InputTag>("srcGoodMuons");
+  edm::ParameterSet cfgJetId;
+  cfgJetId.addParameter<std::string>("version", "FIRSTDATA");
+  cfgJetId.addParameter<std::string>("quality", "LOOSE");
+  PFJetIDSelectionFunctor jetId(cfgJetId);
+  edm::InputTag srcVertices = cfgMiniTupleProducer.getParameter<edm::InputTag>("srcVertices");
+  // CV: generator level matching is performed only in case 'srcGenParticles' is given
+  edm::InputTag srcGenParticles = cfgMiniTupleProducer.exists("srcGenParticles") ?
+    cfgMiniTupleProducer.getParameter<edm::InputTag>("srcGenParticles") : edm::InputTag();
+  bool fillGenMatch = ( srcGenParticles.label() != "" );
+  vstring plot_hltPaths = cfgMiniTupleProducer.getParameter<vstring>("plot_hltPaths");
+  vstring plot_triggerBits;
+  for ( vstring::const_iterator plot_hltPath = plot_hltPaths.begin();
+	plot_hltPath != plot_hltPaths.end(); ++plot_hltPath ) {
+    std::string plot_triggerBit = getHLTpath_key(*plot_hltPath);
+    if ( std::find(plot_triggerBits.begin(), plot_triggerBits.end(), plot_triggerBit) == plot_triggerBits.end() )
+      plot_triggerBits.push_back(plot_triggerBit);
+  }
+  if ( plot_triggerBits.size() > 32 )
+    throw cms::Exception("FWLiteTauIdEffMiniTupleProducer")
+      << "Number of trigger bits = " << plot_triggerBits.size() << " exceeds maximum of 32 supported by mini-tuple format !!\n";
+  typedef std::vector<edm::InputTag> vInputTag;
+  vInputTag srcWeights = cfgMiniTupleProducer.getParameter<vInputTag>("weights");
+  vstring tauIdDiscriminators = cfgMiniTupleProducer.getParameter<vstring>("tauIdDiscriminators");
+
+//--- central value (or systematic shift given by 'sysShift' parameter),
+//    followed by optional list of additional systematic shifts
+//   (same format as for FWLiteTauIdEffAnalyzer)
+  typedef std::vector<edm::ParameterSet> vParameterSet;
+  vParameterSet cfgSysShifts;
+  edm::ParameterSet cfgSysShift_default;
+  cfgSysShift_default.addParameter<std::string>("sysShift", cfgMiniTupleProducer.exists("sysShift") ?
+    cfgMiniTupleProducer.getParameter<std::string>("sysShift") : "CENTRAL_VALUE");
+  cfgSysShift_default.addParameter<edm::InputTag>("srcMuTauPairs", cfgMiniTupleProducer.getParameter<edm::InputTag>("srcMuTauPairs"));
+  cfgSysShift_default.addParameter<edm::InputTag>("srcJets", cfgMiniTupleProducer.getParameter<edm::InputTag>("srcJets"));
+  if ( cfgMiniTupleProducer.exists("srcTauShiftFactors") )
+    cfgSysShift_default.addParameter<edm::InputTag>("srcTauShiftFactors", cfgMiniTupleProducer.getParameter<edm::InputTag>("srcTauShiftFactors"));
+  if ( cfgMiniTupleProducer.exists("srcMEt") )
+    cfgSysShift_default.addParameter<edm::InputTag>("srcMEt", cfgMiniTupleProducer.getParameter<edm::InputTag>("srcMEt"));
+  cfgSysShifts.push_back(cfgSysShift_default);
+  if ( cfgMiniTupleProducer.exists("sysShifts") ) {
+    vParameterSet cfgSysShifts_additional = cfgMiniTupleProducer.getParameter<vParameterSet>("sysShifts");
+    for ( vParameterSet::const_iterator cfgSysShift_additional = cfgSysShifts_additional.begin();
+	  cfgSysShift_additional != cfgSysShifts_additional.end(); ++cfgSysShift_additional ) {
+      edm::ParameterSet cfgSysShift = (*cfgSysShift_additional);
+      if ( !cfgSysShift.exists("srcJets") ) cfgSysShift.addParameter<edm::InputTag>("srcJets", cfgSysShift_default.getParameter<edm::InputTag>("srcJets"));
+      cfgSysShifts.push_back(cfgSysShift);
+    }
+  }
+  std::vector<sysShiftEntryType> sysShiftEntries;
+  vstring sysShifts;
+  for ( vParameterSet::const_iterator cfgSysShift = cfgSysShifts.begin();
+	cfgSysShift != cfgSysShifts.end(); ++cfgSysShift ) {
+    sysShiftEntries.push_back(sysShiftEntryType(*cfgSysShift));
+    sysShifts.push_back(sysShiftEntries.back().sysShift_);
+    std::cout << " sysShift = " << sysShifts.back() << ": srcMuTauPairs = " << sysShiftEntries.back().srcMuTauPairs_.label() << std::endl;
+  }
+
+  edm::InputTag srcEventCounter = cfgMiniTupleProducer.getParameter<edm::InputTag>("srcEventCounter");
+
+  PATMuonLUTvalueGridFromKNN* muonIsoProbExtractor = 0;
+  if ( cfgMiniTupleProducer.exists("muonIsoProbExtractor") ) {
+    edm::ParameterSet cfgMuonIsoProbExtractor = cfgMiniTupleProducer.getParameter<edm::ParameterSet>("muonIsoProbExtractor");
+    muonIsoProbExtractor = new PATMuonLUTvalueGridFromKNN(cfgMuonIsoProbExtractor);
+  }
+
+  std::string processType = cfgMiniTupleProducer.getParameter<std::string>("type");
+  std::cout << " type = " << processType << std::endl;
+  bool isData = (processType == "Data");
+
+  fwlite::InputSource inputFiles(cfg);
+  edm::ParameterSet cfgInputSource = cfg.getParameter<edm::ParameterSet>("fwliteInput");
+  int firstRun = cfgInputSource.getParameter<int>("firstRun");
+  int lastRun = cfgInputSource.getParameter<int>("lastRun");
+  std::string lumiMaskFileName = ( cfgInputSource.exists("lumiMaskFileName") ) ?
+    cfgInputSource.getParameter<std::string>("lumiMaskFileName") : "";
+  TauIdEffLumiMask lumiMask(lumiMaskFileName, firstRun, lastRun);
+  int maxEvents = inputFiles.maxEvents();
+
+  fwlite::OutputFiles outputFile(cfg);
+  TauIdEffMiniTupleWriter miniTuple(outputFile.file(), sysShifts, plot_triggerBits, tauIdDiscriminators,
+				    muonIsoProbExtractor != 0, svFitMassHypothesis != "", fillGenMatch);
+
+  int    numEvents_processed                     = 0;
+  double numEventsWeighted_processed             = 0.;
+  int    numEvents_passedTrigger                 = 0;
+  double numEventsWeighted_passedTrigger         = 0.;
+  int    numEvents_passedDiMuonVeto              = 0;
+  double numEventsWeighted_passedDiMuonVeto      = 0.;
+  double numEvents_skimmed                       = 0.;
+  int    numMuTauPairs_written                   = 0;
+
+  edm::RunNumber_t lastLumiBlock_run = -1;
+  edm::LuminosityBlockNumber_t lastLumiBlock_ls = -1;
+
+  double intLumiData_analyzed = 0.;
+  edm::InputTag srcLumiProducer = cfgMiniTupleProducer.getParameter<edm::InputTag>("srcLumiProducer");
+
+  TauIdEffMiniTupleEntry muTauPairEntry;
+
+  bool maxEvents_processed = false;
+  for ( vstring::const_iterator inputFileName = inputFiles.files().begin();
+	inputFileName != inputFiles.files().end() && !maxEvents_processed; ++inputFileName ) {
+
+//--- open input file
+    TFile* inputFile = TFile::Open(inputFileName->data());
+    if ( !inputFile )
+      throw cms::Exception("FWLiteTauIdEffMiniTupleProducer")
+	<< "Failed to open inputFile = " << (*inputFileName) << " !!\n";
+
+    std::cout << "opening inputFile = " << (*inputFileName);
+    TTree* tree = dynamic_cast<TTree*>(inputFile->Get("Events"));
+    if ( tree ) std::cout << " (" << tree->GetEntries() << " Events)";
+    std::cout << std::endl;
+
+//--- skip input files which contain no luminosity section passing run-range and luminosity section selection
+    if ( !lumiMask.isEmpty() && !isSelectedInputFile(inputFile, lumiMask) ) {
+      std::cout << "no selected luminosity sections in inputFile = " << (*inputFileName) << " --> skipping." << std::endl;
+      delete inputFile;
+      continue;
+    }
+
+    fwlite::Event evt(inputFile);
+    for ( evt.toBegin(); !(evt.atEnd() || maxEvents_processed); ++evt ) {
+
+//--- check if current event is within specified run-range and certified luminosity sections
+//   (this check is important in case triggers changed or became active/inactive **during** a data-taking period)
+//
+//    CV: check is done before any event data is read,
+//        only the event auxiliary information (run, luminosity section and event numbers) is needed
+//
+      if ( !lumiMask(evt.id().run(), evt.luminosityBlock()) ) continue;
+
+//--- muon isolation probabilities are memoized per event
+      if ( muonIsoProbExtractor ) muonIsoProbExtractor->beginEvent();
+
+//--- compute event weight
+//   (pile-up reweighting, Data/MC correction factors,...)
+//    CV: cut-off on event weight and trigger efficiency correction are applied when analyzing the mini-tuple
+      double evtWeight = 1.0;
+      for ( vInputTag::const_iterator srcWeight = srcWeights.begin();
+	    srcWeight != srcWeights.end(); ++srcWeight ) {
+	edm::Handle<double> weight;
+	evt.getByLabel(*srcWeight, weight);
+	evtWeight *= (*weight);
+      }
+
+//--- quit event loop if maximal number of events to be processed is reached
+      ++numEvents_processed;
+      numEventsWeighted_processed += evtWeight;
+      if ( maxEvents > 0 && numEvents_processed >= maxEvents ) maxEvents_processed = true;
+
+//--- check if new luminosity section has started;
+//    if so, retrieve number of events contained in this luminosity section before skimming
+      if ( !(evt.id().run() == lastLumiBlock_run && evt.luminosityBlock() == lastLumiBlock_ls) ) {
+	const fwlite::LuminosityBlock& ls = evt.getLuminosityBlock();
+	edm::Handle<edm::MergeableCounter> numEvents_skimmed_ls;
+	ls.getByLabel(srcEventCounter, numEvents_skimmed_ls);
+	if ( numEvents_skimmed_ls.isValid() ) numEvents_skimmed += numEvents_skimmed_ls->value;
+	lastLumiBlock_run = evt.id().run();
+	lastLumiBlock_ls = evt.luminosityBlock();
+
+	if ( isData ) {
+	  edm::Handle<LumiSummary> lumiSummary;
+	  ls.getByLabel(srcLumiProducer, lumiSummary);
+	  intLumiData_analyzed += lumiSummary->intgRecLumi();
+	}
+      }
+
+//--- check that event has passed triggers
+      bool anyHLTpath_passed = false;
+      if ( hltPaths.size() == 0 ) {
+	anyHLTpath_passed = true;
+      } else {
+	checkHLTpaths(evt, hltPaths, srcHLTresults, NULL, &anyHLTpath_passed);
+      }
+
+      if ( !anyHLTpath_passed ) continue;
+
+      ++numEvents_passedTrigger;
+      numEventsWeighted_passedTrigger += evtWeight;
+
+//--- require event to contain only one "good quality" muon
+      typedef std::vector<pat::Muon> PATMuonCollection;
+      edm::Handle<PATMuonCollection> goodMuons;
+      evt.getByLabel(srcGoodMuons, goodMuons);
+      size_t numGoodMuons = goodMuons->size();
+
+      if ( !(numGoodMuons <= 1) ) continue;
+      ++numEvents_passedDiMuonVeto;
+      numEventsWeighted_passedDiMuonVeto += evtWeight;
+
+//--- extract event level quantities
+      typedef std::vector<pat::MET> PATMETCollection;
+      edm::Handle<PATMETCollection> caloMETs;
+      evt.getByLabel(srcCaloMEt, caloMETs);
+      if ( caloMETs->size() != 1 )
+	throw cms::Exception("FWLiteTauIdEffMiniTupleProducer")
+	  << "Failed to find unique CaloMEt object !!\n";
+
+      edm::Handle<reco::VertexCollection> vertices;
+      evt.getByLabel(srcVertices, vertices);
+
+      std::map<std::string, bool> plot_triggerBits_passed;
+      if ( plot_hltPaths.size() > 0 ) {
+	checkHLTpaths(evt, plot_hltPaths, srcHLTresults, &plot_triggerBits_passed, NULL);
+      }
+      unsigned triggerBits = 0;
+      for ( size_t idxTriggerBit = 0; idxTriggerBit < plot_triggerBits.size(); ++idxTriggerBit ) {
+	if ( plot_triggerBits_passed[plot_triggerBits[idxTriggerBit]] ) triggerBits |= (1u << idxTriggerBit);
+      }
+
+      edm::Handle<reco::GenParticleCollection> genParticles;
+      if ( fillGenMatch ) evt.getByLabel(srcGenParticles, genParticles);
+
+      muTauPairEntry.run_          = evt.id().run();
+      muTauPairEntry.ls_           = evt.luminosityBlock();
+      muTauPairEntry.event_        = evt.id().event();
+      muTauPairEntry.evtWeight_    = evtWeight;
+      muTauPairEntry.numVertices_  = vertices->size();
+      muTauPairEntry.triggerBits_  = triggerBits;
+      muTauPairEntry.caloMEtPt_    = caloMETs->front().pt();
+      muTauPairEntry.caloMEtSumEt_ = caloMETs->front().sumEt();
+
+//--- write muon + tau-jet pairs for central value and systematic shifts
+      for ( size_t idxSysShift = 0; idxSysShift < sysShiftEntries.size(); ++idxSysShift ) {
+	const sysShiftEntryType& sysShiftEntry = sysShiftEntries[idxSysShift];
+
+	edm::Handle<PATMuTauPairCollection> muTauPairs;
+	evt.getByLabel(sysShiftEntry.srcMuTauPairs_, muTauPairs);
+	size_t numMuTauPairs = muTauPairs->size();
+	if ( numMuTauPairs == 0 ) continue;
+
+	edm::Handle<edm::ValueMap<float> > tauShiftFactors;
+	if ( sysShiftEntry.srcTauShiftFactors_.label() != "" ) evt.getByLabel(sysShiftEntry.srcTauShiftFactors_, tauShiftFactors);
+
+	edm::Handle<PATMETCollection> shiftedMETs;
+	const reco::Candidate::LorentzVector* metP4_shifted = 0;
+	if ( sysShiftEntry.srcMEt_.label() != "" ) {
+	  evt.getByLabel(sysShiftEntry.srcMEt_, shiftedMETs);
+	  if ( shiftedMETs->size() != 1 )
+	    throw cms::Exception("FWLiteTauIdEffMiniTupleProducer")
+	      << "Failed to find unique MEt object in collection = " << sysShiftEntry.srcMEt_.label() << " !!\n";
+	  metP4_shifted = &shiftedMETs->front().p4();
+	}
+
+	edm::Handle<pat::JetCollection> jets;
+	evt.getByLabel(sysShiftEntry.srcJets_, jets);
+
+	for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+	  const PATMuTauPair& muTauPair = muTauPairs->at(idxMuTauPair);
+
+	  double tauShiftFactor = ( tauShiftFactors.isValid() ) ? (*tauShiftFactors)[muTauPair.leg2()] : 1.;
+	  fillMiniTupleEntry(muTauPair, tauShiftFactor, svFitMassHypothesis, tauIdDiscriminators, muTauPairEntry, metP4_shifted);
+	  muTauPairEntry.idxSysShift_  = idxSysShift;
+	  muTauPairEntry.idxMuTauPair_ = idxMuTauPair;
+
+//--- count b-jets, with and without cleaning wrt. muon and tau-jet candidate
+	  unsigned numJets                    = 0;
+	  unsigned numJets_bTagged            = 0;
+	  unsigned numJets_bTagged_noCleaning = 0;
+	  for ( pat::JetCollection::const_iterator jet = jets->begin();
+		jet != jets->end(); ++jet ) {
+	    if ( !(jet->pt() > 30. && TMath::Abs(jet->eta()) < 2.4 && jetId(*jet)) ) continue;
+	    bool isBTagged = ( jet->bDiscriminator("combinedSecondaryVertexBJetTags") > 0.679 ); // "medium" WP
+	    if ( isBTagged ) ++numJets_bTagged_noCleaning;
+	    if ( deltaR(jet->p4(), muTauPair.leg1()->p4()) > 0.5 &&
+		 deltaR(jet->p4(), muTauPair.leg2()->p4()) > 0.5 ) {
+	      ++numJets;
+	      if ( isBTagged ) ++numJets_bTagged;
+	    }
+	  }
+	  muTauPairEntry.numJets_                    = numJets;
+	  muTauPairEntry.numJets_bTagged_            = numJets_bTagged;
+	  muTauPairEntry.numJets_bTagged_noCleaning_ = numJets_bTagged_noCleaning;
+
+//--- determine type of particle matching reconstructed tau-jet candidate on generator level
+	  muTauPairEntry.genMatchType_    = kUnmatched;
+	  muTauPairEntry.genTauCharge_    = 0.;
+	  muTauPairEntry.genTauDecayMode_ = kGenTauDecayModeUndefined;
+	  if ( fillGenMatch ) {
+	    double genTauCharge;
+	    std::string genTauDecayMode;
+	    muTauPairEntry.genMatchType_    = getGenMatchType(muTauPair, *genParticles, &genTauCharge, 0, &genTauDecayMode);
+	    muTauPairEntry.genTauCharge_    = genTauCharge;
+	    muTauPairEntry.genTauDecayMode_ = getGenTauDecayModeCode(genTauDecayMode);
+	  }
+
+	  muTauPairEntry.muonIsoProb_ = ( muonIsoProbExtractor ) ?
+	    (*muonIsoProbExtractor)(*muTauPair.leg1()) : 1.;
+
+	  miniTuple.fill(muTauPairEntry);
+	  ++numMuTauPairs_written;
+	}
+      }
+    }
+
+//--- close input file
+    delete inputFile;
+  }
+
+  miniTuple.setCounter("numEvents_processed", numEvents_processed);
+  miniTuple.setCounter("numEventsWeighted_processed", numEventsWeighted_processed);
+  miniTuple.setCounter("numEvents_passedTrigger", numEvents_passedTrigger);
+  miniTuple.setCounter("numEventsWeighted_passedTrigger", numEventsWeighted_passedTrigger);
+  miniTuple.setCounter("numEvents_passedDiMuonVeto", numEvents_passedDiMuonVeto);
+  miniTuple.setCounter("numEventsWeighted_passedDiMuonVeto", numEventsWeighted_passedDiMuonVeto);
+  miniTuple.setCounter("numEvents_skimmed", numEvents_skimmed);
+  miniTuple.setCounter("intLumiData_analyzed", intLumiData_analyzed);
+  miniTuple.close();
+
+  if ( muonIsoProbExtractor ) muonIsoProbExtractor->print(std::cout);
+  delete muonIsoProbExtractor;
+
+  std::cout << "<FWLiteTauIdEffMiniTupleProducer>:" << std::endl;
+  std::cout << " numEvents_processed: " << numEvents_processed
+	    << " (weighted = " << numEventsWeighted_processed << ")" << std::endl;
+  std::cout << " numEvents_passedTrigger: " << numEvents_passedTrigger
+	    << " (weighted = " << numEventsWeighted_passedTrigger << ")" << std::endl;
+  std::cout << " numEvents_passedDiMuonVeto: " << numEvents_passedDiMuonVeto
+	    << " (weighted = " << numEventsWeighted_passedDiMuonVeto << ")" << std::endl;
+  std::cout << " numMuTauPairs_written: " << numMuTauPairs_written << std::endl;
+
+  clock.Show("FWLiteTauIdEffMiniTupleProducer");
+
+  return 0;
+}
@@ -42,6 +42,8 @@
 
 #include "TauAnalysis/TauIdEfficiency/interface/TauIdEffEventSelector.h"
 #include "TauAnalysis/TauIdEfficiency/interface/TauIdEffCutFlowTable.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMiniTuple.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffCheckpoint.h"
 #include "TauAnalysis/TauIdEfficiency/interface/tauIdEffAuxFunctions.h"
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
 
@@ -53,6 +55,9 @@
 #include <TSystem.h>
 #include <TROOT.h>
 #include <TBenchmark.h>
+#include <TString.h>
+
+#include <algorithm>
 
 typedef std::vector<std::string> vstring;
 typedef std::vector<bool> vbool;
@@ -267,33 +272,37 @@ struct regionEntryType
       delete (*it);
     }
   }
-  void analyze(const PATMuTauPair& muTauPair, 
-	       int genMatchType, double genTauCharge, double recTauCharge,
-	       const pat::MET& caloMEt, 
-	       size_t numJets_bTagged,
-	       size_t numVertices, 
-	       double evtWeight)
+  void setEntryTauIdDiscriminators(const vstring& entryTauIdDiscriminators)
+  {
+    selector_->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+    tauIdDiscriminatorIndices_.clear();
+    for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators_.begin();
+	  tauIdDiscriminator != tauIdDiscriminators_.end(); ++tauIdDiscriminator ) {
+      tauIdDiscriminatorIndices_.push_back(std::find(entryTauIdDiscriminators.begin(), entryTauIdDiscriminators.end(), *tauIdDiscriminator) 
+					   - entryTauIdDiscriminators.begin());
+    }
+  }
+  void analyze(const TauIdEffMiniTupleEntry& muTauPair, double caloMEtPt, double evtWeight)
   {
     pat::strbitset evtSelFlags;
-    if ( selector_->operator()(muTauPair, caloMEt, numJets_bTagged, evtSelFlags) ) {
+    if ( selector_->operator()(muTauPair, caloMEtPt, evtSelFlags) ) {
 
 //--- set flags indicating whether tau-jet candidate passes 
 //    "leading" track finding, leading track Pt and loose (PF)isolation requirements 
 //    plus tau id. discriminators
       tauIdFlags_[0] = true;
-      tauIdFlags_[1] = (muTauPair.leg2()->userFloat("hasLeadTrack")       > 0.5);
-      tauIdFlags_[2] = (muTauPair.leg2()->userFloat("leadTrackPt")        > 5.0);      
-      tauIdFlags_[3] = (muTauPair.leg2()->userFloat("preselLoosePFIsoPt") < 2.5);
-      tauIdFlags_[4] = (muTauPair.leg2()->userFloat("PFElectronMVA")      < 0.6);
-      tauIdFlags_[5] = (muTauPair.leg2()->userFloat("dRnearestMuon")      > 0.5);
-      tauIdFlags_[6] = (TMath::Abs(muTauPair.leg1()->vertex().z() - muTauPair.leg2()->vertex().z()) < 0.2);
-      double muTauPairChargeProd = muTauPair.leg1()->charge()*muTauPair.leg2()->userFloat("leadTrackCharge");
+      tauIdFlags_[1] = (muTauPair.tauHasLeadTrack_  > 0.5);
+      tauIdFlags_[2] = (muTauPair.tauLeadTrackPt_   > 5.0);      
+      tauIdFlags_[3] = (muTauPair.tauIso_           < 2.5);
+      tauIdFlags_[4] = (muTauPair.tauPFElectronMVA_ < 0.6);
+      tauIdFlags_[5] = (muTauPair.tauDRnearestMuon_ > 0.5);
+      tauIdFlags_[6] = (muTauPair.muTauPairAbsDz_   < 0.2);
+      double muTauPairChargeProd = muTauPair.muonCharge_*muTauPair.tauLeadTrackCharge_;
       tauIdFlags_[7] = (muTauPairChargeProd > muTauPairChargeProdMin_ && muTauPairChargeProd < muTauPairChargeProdMax_);
       for ( int iTauIdDiscriminator = 0; iTauIdDiscriminator < numTauIdDiscriminators_; ++iTauIdDiscriminator ) {
-	const std::string tauIdDiscriminator = tauIdDiscriminators_[iTauIdDiscriminator];
-	//std::cout << " tauIdDiscriminator = " << tauIdDiscriminator << ":" 
-	//	    << " " << muTauPair.leg2()->tauID(tauIdDiscriminator.data()) << std::endl;
-	tauIdFlags_[numPreselCuts_ + iTauIdDiscriminator] = (muTauPair.leg2()->tauID(tauIdDiscriminator.data()) > 0.5);
+	//std::cout << " tauIdDiscriminator = " << tauIdDiscriminators_[iTauIdDiscriminator] << ":" 
+	//	    << " " << muTauPair.tauIdDiscriminatorValues_[tauIdDiscriminatorIndices_[iTauIdDiscriminator]] << std::endl;
+	tauIdFlags_[numPreselCuts_ + iTauIdDiscriminator] = (muTauPair.tauIdDiscriminatorValues_[tauIdDiscriminatorIndices_[iTauIdDiscriminator]] > 0.5);
       }
       //std::cout << "tauIdFlags = " << format_vbool(tauIdFlags_) << std::endl;
       
@@ -306,6 +315,10 @@ struct regionEntryType
       }
       //std::cout << "tauIdFlagsReversed = " << format_vbool(tauIdFlagsReversed_) << std::endl;
 
+      int genMatchType = muTauPair.genMatchType_;
+      double genTauCharge = muTauPair.genTauCharge_;
+      double recTauCharge = muTauPair.tauCharge_;
+
 //--- fill histograms for "inclusive" tau id. efficiency measurement
       cutFlowUnbinned_->fillCutFlowTables(0., 
 					  tauIdFlags_, tauIdFlagsReversed_, 
@@ -321,10 +334,10 @@ struct regionEntryType
       for ( std::vector<cutFlowEntryType*>::iterator cutFlowEntry = cutFlowEntriesBinned_.begin();
 	    cutFlowEntry != cutFlowEntriesBinned_.end(); ++cutFlowEntry ) {
 	double x = 0.;
-	if      ( (*cutFlowEntry)->binVariable_ == "tauPt"       ) x = muTauPair.leg2()->pt();
-	else if ( (*cutFlowEntry)->binVariable_ == "tauAbsEta"   ) x = TMath::Abs(muTauPair.leg2()->eta());
-	else if ( (*cutFlowEntry)->binVariable_ == "numVertices" ) x = numVertices;
-	else if ( (*cutFlowEntry)->binVariable_ == "sumEt"       ) x = muTauPair.met()->sumEt();
+	if      ( (*cutFlowEntry)->binVariable_ == "tauPt"       ) x = muTauPair.tauPt_;
+	else if ( (*cutFlowEntry)->binVariable_ == "tauAbsEta"   ) x = TMath::Abs(muTauPair.tauEta_);
+	else if ( (*cutFlowEntry)->binVariable_ == "numVertices" ) x = muTauPair.numVertices_;
+	else if ( (*cutFlowEntry)->binVariable_ == "sumEt"       ) x = muTauPair.pfMEtSumEt_;
 	else throw cms::Exception("regionEntryType::analyze")
 	  << "Invalid binVariable = " << (*cutFlowEntry)->binVariable_ << " !!\n";
 	(*cutFlowEntry)->fillCutFlowTables(x, 
@@ -349,6 +362,7 @@ struct regionEntryType
   
   int numPreselCuts_;
   int numTauIdDiscriminators_;
+  std::vector<int> tauIdDiscriminatorIndices_; // indices of tau id. discriminator values in TauIdEffMiniTupleEntry
 
   TauIdEffEventSelector* selector_;
  
@@ -365,6 +379,76 @@ struct regionEntryType
   double numMuTauPairsWeighted_selected_;
 };
 
+//-------------------------------------------------------------------------------
+//
+// Selection of muon + tau-jet pairs and filling of cut-flow tables,
+// common to the analysis of PAT-tuples and of mini-tuples produced by FWLiteTauIdEffMiniTupleProducer
+//
+struct muTauPairAnalyzerType
+{
+  muTauPairAnalyzerType(std::vector<regionEntryType*>& regionEntries, TauIdEffEventSelector* selectorABCD, 
+			const std::vector<int>& selEventsTauIdDiscriminatorIndices, std::ofstream* selEventsFile)
+    : regionEntries_(regionEntries),
+      selectorABCD_(selectorABCD),
+      selEventsTauIdDiscriminatorIndices_(selEventsTauIdDiscriminatorIndices),
+      selEventsFile_(selEventsFile),
+      numEvents_passedDiMuTauPairVeto_(0),
+      numEventsWeighted_passedDiMuTauPairVeto_(0.)
+  {}
+  void operator()(std::vector<TauIdEffMiniTupleEntry>& muTauPairs, double caloMEtPt, double evtWeight)
+  {
+//--- require event to contain exactly one muon + tau-jet pair
+//    passing the selection criteria for region "ABCD"
+    unsigned numMuTauPairsABCD = 0; // Note: no b-jet veto applied
+    for ( std::vector<TauIdEffMiniTupleEntry>::iterator muTauPair = muTauPairs.begin();
+	  muTauPair != muTauPairs.end(); ++muTauPair ) {
+      unsigned numJets_bTagged = muTauPair->numJets_bTagged_;
+      muTauPair->numJets_bTagged_ = 0;
+      pat::strbitset evtSelFlags;
+      if ( selectorABCD_->operator()(*muTauPair, caloMEtPt, evtSelFlags) ) ++numMuTauPairsABCD;
+      muTauPair->numJets_bTagged_ = numJets_bTagged;
+    }
+      
+    if ( !(numMuTauPairsABCD <= 1) ) return;
+    ++numEvents_passedDiMuTauPairVeto_;
+    numEventsWeighted_passedDiMuTauPairVeto_ += evtWeight;
+
+//--- iterate over collection of muon + tau-jet pairs:
+//    check which region muon + tau-jet pair is selected in
+//    and whether reconstructed tau-jet matches "true" hadronic tau decay on generator level or is fake,
+//    count number of "true" and fake taus selected in all regions
+    for ( std::vector<TauIdEffMiniTupleEntry>::const_iterator muTauPair = muTauPairs.begin();
+	  muTauPair != muTauPairs.end(); ++muTauPair ) {
+      for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries_.begin();
+	    regionEntry != regionEntries_.end(); ++regionEntry ) {   
+	(*regionEntry)->analyze(*muTauPair, caloMEtPt, evtWeight);
+      }
+
+      if ( selEventsFile_ && 
+	   muTauPair->genMatchType_ == kGenTauHadMatched &&
+	   muTauPair->tauIdDiscriminatorValues_[selEventsTauIdDiscriminatorIndices_[0]] > 0.5 &&
+	   muTauPair->tauIdDiscriminatorValues_[selEventsTauIdDiscriminatorIndices_[1]] > 0.5 &&
+	   muTauPair->tauHasLeadTrack_ > 0.5 &&
+	   muTauPair->tauLeadTrackPt_ > 5.0 &&     
+	   muTauPair->tauIso_ > 2.5 ) {
+	//std::cout << "run = " << muTauPair->run_ << "," 
+	//	    << " ls = " << muTauPair->ls_ << ", event = " << muTauPair->event_ << ":" << std::endl;
+	  
+	(*selEventsFile_) << muTauPair->run_ << ":" << muTauPair->ls_ << ":" << muTauPair->event_ << std::endl;
+      }
+    }
+  }
+
+  std::vector<regionEntryType*>& regionEntries_;
+  TauIdEffEventSelector* selectorABCD_;
+  std::vector<int> selEventsTauIdDiscriminatorIndices_;
+  std::ofstream* selEventsFile_;
+
+  int    numEvents_passedDiMuTauPairVeto_;
+  double numEventsWeighted_passedDiMuTauPairVeto_;
+};
+//-------------------------------------------------------------------------------
+
 int main(int argc, char* argv[]) 
 {
 //--- parse command-line arguments
@@ -413,11 +497,24 @@ int main(int argc, char* argv[])
   std::string selEventsFileName = ( cfgTauIdEffPreselNumbers.exists("selEventsFileName") ) ?
     cfgTauIdEffPreselNumbers.getParameter<std::string>("selEventsFileName") : "";
 
+//--- read muon + tau-jet pairs from mini-tuples produced by FWLiteTauIdEffMiniTupleProducer 
+//    instead of PAT-tuples (optional)
+//   (HLT paths and maximum number of events are applied when producing the mini-tuples)
+  vstring miniTupleFileNames = ( cfgTauIdEffPreselNumbers.exists("miniTupleFileNames") ) ?
+    cfgTauIdEffPreselNumbers.getParameter<vstring>("miniTupleFileNames") : vstring();
+
+//--- write checkpoints at the end of each input file and every 'checkpointInterval' events (optional),
+//    in order to resume job from last checkpoint in case it gets killed before completion
+  std::string checkpointFileName = ( cfgTauIdEffPreselNumbers.exists("checkpointFileName") ) ?
+    cfgTauIdEffPreselNumbers.getParameter<std::string>("checkpointFileName") : "";
+  int checkpointInterval = ( cfgTauIdEffPreselNumbers.exists("checkpointInterval") ) ?
+    cfgTauIdEffPreselNumbers.getParameter<int>("checkpointInterval") : 0;
+
   fwlite::InputSource inputFiles(cfg); 
   int maxEvents = inputFiles.maxEvents();
 
   fwlite::OutputFiles outputFile(cfg);
-  fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
+  fwlite::TFileService* fs = new fwlite::TFileService(outputFile.file().data());
 
 //--- initialize selections and histograms
 //    for different ABCD regions
@@ -435,7 +532,7 @@ int main(int argc, char* argv[])
       vstring tauIdDiscriminators = cfgTauIdDiscriminator->getParameter<vstring>("discriminators");
       std::string tauIdName = cfgTauIdDiscriminator->getParameter<std::string>("name");
       regionEntryType* regionEntry = 
-	new regionEntryType(fs, process, *region, tauIdDiscriminators, tauIdName, sysShift, cfgBinning, cfgEventSelCuts);
+	new regionEntryType(*fs, process, *region, tauIdDiscriminators, tauIdName, sysShift, cfgBinning, cfgEventSelCuts);
       regionEntries.push_back(regionEntry);
     }
   }
@@ -450,18 +547,88 @@ int main(int argc, char* argv[])
   std::ofstream* selEventsFile = ( selEventsFileName != "" ) ?
     new std::ofstream(selEventsFileName.data(), std::ios::out) : 0;
 
+//--- determine tau id. discriminators the values of which need to be extracted per muon + tau-jet pair
+  vstring entryTauIdDiscriminators;
+  entryTauIdDiscriminators.push_back("decayModeFinding");
+  entryTauIdDiscriminators.push_back("byLooseCombinedIsolationDeltaBetaCorr");
+  for ( vParameterSet::const_iterator cfgTauIdDiscriminator = cfgTauIdDiscriminators.begin();
+	cfgTauIdDiscriminator != cfgTauIdDiscriminators.end(); ++cfgTauIdDiscriminator ) {
+    vstring tauIdDiscriminators = cfgTauIdDiscriminator->getParameter<vstring>("discriminators");
+    for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators.begin();
+	  tauIdDiscriminator != tauIdDiscriminators.end(); ++tauIdDiscriminator ) {
+      if ( std::find(entryTauIdDiscriminators.begin(), entryTauIdDiscriminators.end(), *tauIdDiscriminator) == entryTauIdDiscriminators.end() ) 
+	entryTauIdDiscriminators.push_back(*tauIdDiscriminator);
+    }
+  }
+  if ( miniTupleFileNames.size() > 0 ) {
+    TauIdEffMiniTupleReader miniTuple(miniTupleFileNames.front());
+    entryTauIdDiscriminators = miniTuple.tauIdDiscriminators();
+  }
+  for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
+	regionEntry != regionEntries.end(); ++regionEntry ) {
+    (*regionEntry)->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+  }
+  selectorABCD->setEntryTauIdDiscriminators(entryTauIdDiscriminators);
+  std::vector<int> selEventsTauIdDiscriminatorIndices;
+  if ( selEventsFile ) {
+    selEventsTauIdDiscriminatorIndices.push_back(std::find(entryTauIdDiscriminators.begin(), entryTauIdDiscriminators.end(), "decayModeFinding") 
+						 - entryTauIdDiscriminators.begin());
+    selEventsTauIdDiscriminatorIndices.push_back(std::find(entryTauIdDiscriminators.begin(), entryTauIdDiscriminators.end(), "byLooseCombinedIsolationDeltaBetaCorr") 
+						 - entryTauIdDiscriminators.begin());
+    for ( std::vector<int>::const_iterator idx = selEventsTauIdDiscriminatorIndices.begin();
+	  idx != selEventsTauIdDiscriminatorIndices.end(); ++idx ) {
+      if ( (*idx) >= (int)entryTauIdDiscriminators.size() )
+	throw cms::Exception("FWLiteTauIdEffPreselNumbers") 
+	  << "Tau id. discriminators 'decayModeFinding' and 'byLooseCombinedIsolationDeltaBetaCorr' needed for selEventsFile !!\n";
+    }
+  }
+
   int    numEvents_processed                     = 0; 
   double numEventsWeighted_processed             = 0.;
   int    numEvents_passedTrigger                 = 0;
   double numEventsWeighted_passedTrigger         = 0.;
   int    numEvents_passedDiMuonVeto              = 0;
   double numEventsWeighted_passedDiMuonVeto      = 0.;
-  int    numEvents_passedDiMuTauPairVeto         = 0;
-  double numEventsWeighted_passedDiMuTauPairVeto = 0.;
+
+  muTauPairAnalyzerType analyzeMuTauPairs(regionEntries, selectorABCD, selEventsTauIdDiscriminatorIndices, selEventsFile);
+
+//--- save histograms and event counters periodically (optional),
+//    so that job can be resumed in case it gets killed before completion
+  TauIdEffCheckpoint* checkpoint = 0;
+  unsigned idxInputFile_resume = 0;
+  long numEvents_resume = 0;
+  if ( checkpointFileName != "" ) {
+    if ( selEventsFileName != "" ) {
+      std::cout << "Warning: selEventsFileName = " << selEventsFileName << " --> disabling checkpoints !!" << std::endl;
+    } else {
+      checkpoint = new TauIdEffCheckpoint(checkpointFileName, cfg.toString(), &fs->file(), checkpointInterval);
+      checkpoint->addCounter("numEvents_processed", &numEvents_processed);
+      checkpoint->addCounter("numEventsWeighted_processed", &numEventsWeighted_processed);
+      checkpoint->addCounter("numEvents_passedTrigger", &numEvents_passedTrigger);
+      checkpoint->addCounter("numEventsWeighted_passedTrigger", &numEventsWeighted_passedTrigger);
+      checkpoint->addCounter("numEvents_passedDiMuonVeto", &numEvents_passedDiMuonVeto);
+      checkpoint->addCounter("numEventsWeighted_passedDiMuonVeto", &numEventsWeighted_passedDiMuonVeto);
+      checkpoint->addCounter("numEvents_passedDiMuTauPairVeto", &analyzeMuTauPairs.numEvents_passedDiMuTauPairVeto_);
+      checkpoint->addCounter("numEventsWeighted_passedDiMuTauPairVeto", &analyzeMuTauPairs.numEventsWeighted_passedDiMuTauPairVeto_);
+      for ( size_t idxRegionEntry = 0; idxRegionEntry < regionEntries.size(); ++idxRegionEntry ) {
+	regionEntryType* regionEntry = regionEntries[idxRegionEntry];
+	std::string counterName = Form("%s_%s", regionEntry->tauIdName_.data(), regionEntry->region_.data());
+	checkpoint->addCounter(std::string(counterName).append("_numMuTauPairs_selected"), &regionEntry->numMuTauPairs_selected_);
+	checkpoint->addCounter(std::string(counterName).append("_numMuTauPairsWeighted_selected"), &regionEntry->numMuTauPairsWeighted_selected_);
+      }
+      if ( checkpoint->resume(idxInputFile_resume, numEvents_resume) ) 
+	std::cout << "resuming job from checkpoint: inputFile #" << idxInputFile_resume << ", event #" << numEvents_resume << std::endl;
+    }
+  }
+  std::vector<TauIdEffMiniTupleEntry> muTauPairEntries;
   
-  bool maxEvents_processed = false;
+  bool maxEvents_processed = ( maxEvents > 0 && numEvents_processed >= maxEvents );
+  unsigned idxInputFile = 0;
   for ( vstring::const_iterator inputFileName = inputFiles.files().begin();
-	inputFileName != inputFiles.files().end() && !maxEvents_processed; ++inputFileName ) {
+	inputFileName != inputFiles.files().end() && !maxEvents_processed && miniTupleFileNames.size() == 0; ++inputFileName, ++idxInputFile ) {
+
+//--- skip input files processed completely before job got interrupted
+    if ( idxInputFile < idxInputFile_resume ) continue;
 
 //--- open input file
     TFile* inputFile = TFile::Open(inputFileName->data());
@@ -475,7 +642,15 @@ int main(int argc, char* argv[])
     std::cout << std::endl;
 
     fwlite::Event evt(inputFile);
-    for ( evt.toBegin(); !(evt.atEnd() || maxEvents_processed); ++evt ) {
+    long numEvents_inputFile = 0;
+    evt.toBegin();
+    if ( idxInputFile == idxInputFile_resume && numEvents_resume > 0 ) {
+      evt.to(numEvents_resume);
+      numEvents_inputFile = numEvents_resume;
+    }
+    for ( ; !(evt.atEnd() || maxEvents_processed); ++evt, ++numEvents_inputFile ) {
+
+      if ( checkpoint && checkpoint->isDue(numEvents_inputFile) ) checkpoint->write(idxInputFile, numEvents_inputFile);
 
       //std::cout << "processing run = " << evt.id().run() << ":" 
       //	  << " ls = " << evt.luminosityBlock() << ", event = " << evt.id().event() << std::endl;
@@ -529,8 +704,6 @@ int main(int argc, char* argv[])
       ++numEvents_passedDiMuonVeto;
       numEventsWeighted_passedDiMuonVeto += evtWeight;
 
-//--- require event to contain exactly one muon + tau-jet pair
-//    passing the selection criteria for region "ABCD"
       edm::Handle<PATMuTauPairCollection> muTauPairs;
       evt.getByLabel(srcMuTauPairs, muTauPairs);
 
@@ -541,17 +714,6 @@ int main(int argc, char* argv[])
 	throw cms::Exception("FWLiteTauIdEffPreselNumbers")
 	  << "Failed to find unique CaloMEt object !!\n";
 
-      unsigned numMuTauPairsABCD = 0; // Note: no b-jet veto applied
-      for ( PATMuTauPairCollection::const_iterator muTauPair = muTauPairs->begin();
-	    muTauPair != muTauPairs->end(); ++muTauPair ) {
-	pat::strbitset evtSelFlags;
-	if ( selectorABCD->operator()(*muTauPair, caloMEt->front(), 0, evtSelFlags) ) ++numMuTauPairsABCD;
-      }
-      
-      if ( !(numMuTauPairsABCD <= 1) ) continue;
-      ++numEvents_passedDiMuTauPairVeto;
-      numEventsWeighted_passedDiMuTauPairVeto += evtWeight;
-
       edm::Handle<pat::JetCollection> jets;
       evt.getByLabel(srcJets, jets);      
 
@@ -561,56 +723,100 @@ int main(int argc, char* argv[])
       evt.getByLabel(srcVertices, vertices);
       size_t numVertices = vertices->size();
 
-//--- iterate over collection of muon + tau-jet pairs:
-//    check which region muon + tau-jet pair is selected in
-//    and whether reconstructed tau-jet matches "true" hadronic tau decay on generator level or is fake,
-//    count number of "true" and fake taus selected in all regions
-      edm::Handle<reco::GenParticleCollection> genParticles;
-      evt.getByLabel(srcGenParticles, genParticles);
-
-      int muTauPairIdx = 0;
-      for ( PATMuTauPairCollection::const_iterator muTauPair = muTauPairs->begin();
-	    muTauPair != muTauPairs->end(); ++muTauPair, ++muTauPairIdx ) {
-
 //--- require event to contain to b-jets
 //   (not overlapping with muon or tau-jet candidate)
-	size_t numJets_bTagged = 0;
-	for ( pat::JetCollection::const_iterator jet = jets->begin();
-	      jet != jets->end(); ++jet ) {
-	  if ( jet->pt() > 30. && TMath::Abs(jet->eta()) < 2.4 && jetId(*jet) &&
-	       jet->bDiscriminator("combinedSecondaryVertexBJetTags") > 0.679 ) ++numJets_bTagged; // "medium" WP
-	}
+      size_t numJets_bTagged = 0;
+      for ( pat::JetCollection::const_iterator jet = jets->begin();
+	    jet != jets->end(); ++jet ) {
+	if ( jet->pt() > 30. && TMath::Abs(jet->eta()) < 2.4 && jetId(*jet) &&
+	     jet->bDiscriminator("combinedSecondaryVertexBJetTags") > 0.679 ) ++numJets_bTagged; // "medium" WP
+      }
 
-	double genTauCharge, recTauCharge;
-	int genMatchType = getGenMatchType(*muTauPair, *genParticles, &genTauCharge, &recTauCharge);
-	for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
-	      regionEntry != regionEntries.end(); ++regionEntry ) {   
-	  (*regionEntry)->analyze(*muTauPair, 
-				  genMatchType, genTauCharge, recTauCharge, 
-				  caloMEt->front(), 
-				  numJets_bTagged,
-				  numVertices, 
-				  evtWeight);
-	}
+//--- determine whether reconstructed tau-jet matches "true" hadronic tau decay on generator level or is fake
+      edm::Handle<reco::GenParticleCollection> genParticles;
+      evt.getByLabel(srcGenParticles, genParticles);
 
-	if ( genMatchType == kGenTauHadMatched &&
-	     muTauPair->leg2()->tauID("decayModeFinding") > 0.5 &&
-	     muTauPair->leg2()->tauID("byLooseCombinedIsolationDeltaBetaCorr") > 0.5 &&
-	     muTauPair->leg2()->userFloat("hasLeadTrack") > 0.5 &&
-	     muTauPair->leg2()->userFloat("leadTrackPt") > 5.0 &&     
-	     muTauPair->leg2()->userFloat("preselLoosePFIsoPt") > 2.5 ) {
-	  //std::cout << "run = " << evt.id().run() << "," 
-	  //	      << " ls = " << evt.luminosityBlock() << ", event = " << evt.id().event() << ":" << std::endl;
-	  
-	  if ( selEventsFile ) (*selEventsFile) << evt.id().run() << ":" << evt.luminosityBlock() << ":" << evt.id().event() << std::endl;
-	}
+      size_t numMuTauPairs = muTauPairs->size();
+      muTauPairEntries.resize(numMuTauPairs);
+      for ( size_t idxMuTauPair = 0; idxMuTauPair < numMuTauPairs; ++idxMuTauPair ) {
+	const PATMuTauPair& muTauPair = muTauPairs->at(idxMuTauPair);
+	TauIdEffMiniTupleEntry& muTauPairEntry = muTauPairEntries[idxMuTauPair];
+	fillMiniTupleEntry(muTauPair, 1., "", entryTauIdDiscriminators, muTauPairEntry);
+	muTauPairEntry.run_             = evt.id().run();
+	muTauPairEntry.ls_              = evt.luminosityBlock();
+	muTauPairEntry.event_           = evt.id().event();
+	muTauPairEntry.numVertices_     = numVertices;
+	muTauPairEntry.numJets_bTagged_ = numJets_bTagged;
+	double genTauCharge;
+	muTauPairEntry.genMatchType_    = getGenMatchType(muTauPair, *genParticles, &genTauCharge);
+	muTauPairEntry.genTauCharge_    = genTauCharge;
       }
+
+      analyzeMuTauPairs(muTauPairEntries, caloMEt->front().pt(), evtWeight);
     }
 
 //--- close input file
     delete inputFile;
+
+    if ( checkpoint ) checkpoint->write(idxInputFile + 1, 0);
   }
 
+//--- process mini-tuples
+//   (optional)
+  std::vector<TauIdEffMiniTupleEntry> miniTupleEntries;
+  unsigned idxMiniTupleFile = 0;
+  for ( vstring::const_iterator miniTupleFileName = miniTupleFileNames.begin();
+	miniTupleFileName != miniTupleFileNames.end(); ++miniTupleFileName, ++idxMiniTupleFile ) {
+    // CV: checkpoints are written after each mini-tuple file only
+    if ( idxMiniTupleFile < idxInputFile_resume ) continue;
+
+    TauIdEffMiniTupleReader miniTuple(*miniTupleFileName);
+    std::cout << "opening miniTupleFile = " << (*miniTupleFileName) 
+	      << " (" << miniTuple.numEntries() << " muon + tau-jet pairs)" << std::endl;
+
+    if ( miniTuple.tauIdDiscriminators() != entryTauIdDiscriminators )
+      throw cms::Exception("FWLiteTauIdEffPreselNumbers") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains different tau id. discriminators than first file !!\n";
+    if ( !miniTuple.hasColumn("genMatchType") )
+      throw cms::Exception("FWLiteTauIdEffPreselNumbers") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains no generator level matching information !!\n";
+    const vstring& miniTupleSysShifts = miniTuple.sysShifts();
+    vstring::const_iterator miniTupleSysShift = std::find(miniTupleSysShifts.begin(), miniTupleSysShifts.end(), sysShift);
+    if ( miniTupleSysShift == miniTupleSysShifts.end() )
+      throw cms::Exception("FWLiteTauIdEffPreselNumbers") 
+	<< "Mini-tuple file = " << (*miniTupleFileName) << " contains no muon + tau-jet pairs for sysShift = " << sysShift << " !!\n";
+    unsigned idxSysShift = miniTupleSysShift - miniTupleSysShifts.begin();
+
+//--- take event counters from mini-tuple
+    numEvents_processed                += TMath::Nint(miniTuple.getCounter("numEvents_processed"));
+    numEventsWeighted_processed        += miniTuple.getCounter("numEventsWeighted_processed");
+    numEvents_passedTrigger            += TMath::Nint(miniTuple.getCounter("numEvents_passedTrigger"));
+    numEventsWeighted_passedTrigger    += miniTuple.getCounter("numEventsWeighted_passedTrigger");
+    numEvents_passedDiMuonVeto         += TMath::Nint(miniTuple.getCounter("numEvents_passedDiMuonVeto"));
+    numEventsWeighted_passedDiMuonVeto += miniTuple.getCounter("numEventsWeighted_passedDiMuonVeto");
+
+    size_t idxEntry = 0;
+    while ( idxEntry < miniTuple.numEntries() ) {
+      idxEntry = miniTuple.readEvent(idxEntry, miniTupleEntries);
+
+      muTauPairEntries.clear();
+      for ( std::vector<TauIdEffMiniTupleEntry>::const_iterator miniTupleEntry = miniTupleEntries.begin();
+	    miniTupleEntry != miniTupleEntries.end(); ++miniTupleEntry ) {
+	if ( miniTupleEntry->idxSysShift_ != idxSysShift ) continue;
+	muTauPairEntries.push_back(*miniTupleEntry);
+	// CV: b-tagged jets are not cleaned wrt. muon and tau-jet when computing preselection numbers
+	muTauPairEntries.back().numJets_bTagged_ = miniTupleEntry->numJets_bTagged_noCleaning_;
+      }
+      if ( muTauPairEntries.size() == 0 ) continue;
+
+      analyzeMuTauPairs(muTauPairEntries, muTauPairEntries.front().caloMEtPt_, muTauPairEntries.front().evtWeight_);
+    }
+
+    if ( checkpoint ) checkpoint->write(idxMiniTupleFile + 1, 0);
+  }
+  int    numEvents_passedDiMuTauPairVeto         = analyzeMuTauPairs.numEvents_passedDiMuTauPairVeto_;
+  double numEventsWeighted_passedDiMuTauPairVeto = analyzeMuTauPairs.numEventsWeighted_passedDiMuTauPairVeto_;
+
   std::cout << "<FWLiteTauIdEffPreselNumbers>:" << std::endl;
   std::cout << " numEvents_processed: " << numEvents_processed 
 	    << " (weighted = " << numEventsWeighted_processed << ")" << std::endl;
@@ -641,6 +847,16 @@ int main(int argc, char* argv[])
     std::cout << "  purity = " << purity << std::endl;
   }
 
+//--- write output file before removing checkpoint,
+//    so that job can be resumed from last checkpoint in case it gets killed while the output is written
+  delete fs;
+
+//--- job completed successfully, checkpoint no longer needed
+  if ( checkpoint ) {
+    checkpoint->remove();
+    delete checkpoint;
+  }
+
   clock.Show("FWLiteTauIdEffPreselNumbers");
 
   return 0;
@@ -112,6 +112,32 @@ int main(int argc, const char* argv[])
     throw cms::Exception("compTauChargeMisIdFinalNumbers") 
       << "Directory = " << directory_presel << " does not exists in input file = " << inputFileName << " !!\n";
 
+//--- enumerate histograms contained in input directories once,
+//    to avoid repeated lookups by TDirectory::Get for every number retrieved by getNumber
+  TauIdEffKeyCatalog inputCatalog_fit(inputDirectory_fit);
+  TauIdEffKeyCatalog inputCatalog_presel(inputDirectory_presel);
+
+//--- read all histograms needed to compute the final numbers in one pass
+  const char* preselHistogramTypes[] = { "TauHadMatched", "FakeTauMatched", "TauHadMatchedCorrectCharge", "TauHadMatchedWrongCharge" };
+  const char* fitHistogramTypes[] = { "fitResult", "expResult", "fitNorm", "expNorm" };
+  vstring auxHistogramNames_presel;
+  vstring auxHistogramNames_fit;
+  for ( std::vector<std::string>::const_iterator tauId = tauIds.begin();
+	tauId != tauIds.end(); ++tauId ) {
+    for ( size_t iType = 0; iType < sizeof(preselHistogramTypes)/sizeof(preselHistogramTypes[0]); ++iType ) {
+      auxHistogramNames_presel.push_back(Form("Ztautau_%s_%s_%s", region_passed.data(), tauId->data(), preselHistogramTypes[iType]));
+      auxHistogramNames_presel.push_back(Form("Ztautau_%s_%s_%s", region_failed.data(), tauId->data(), preselHistogramTypes[iType]));
+    }
+    for ( std::vector<std::string>::const_iterator fitVariable = fitVariables.begin();
+	  fitVariable != fitVariables.end(); ++fitVariable ) {
+      for ( size_t iType = 0; iType < sizeof(fitHistogramTypes)/sizeof(fitHistogramTypes[0]); ++iType ) {
+	auxHistogramNames_fit.push_back(Form("%s_%s_%s", fitHistogramTypes[iType], fitVariable->data(), tauId->data()));
+      }
+    }
+  }
+  loadNumbers(inputCatalog_presel, auxHistogramNames_presel);
+  loadNumbers(inputCatalog_fit, auxHistogramNames_fit);
+
   std::map<std::string, std::map<std::string, double> > expTauChargeMisIdRate;     // key = (tauId, fitVariable)
   std::map<std::string, std::map<std::string, double> > measTauChargeMisIdRate;    // key = (tauId, fitVariable)
   std::map<std::string, std::map<std::string, double> > measTauChargeMisIdRateErr; // key = (tauId, fitVariable)  
@@ -130,44 +156,44 @@ int main(int argc, const char* argv[])
 
 //--- get fitResult and uncertainty on fitResult
       TString fitResultName = Form("fitResult_%s_%s", fitVariable->data(), tauId->data());   
-      double fitResult = 1. - getNumber(inputDirectory_fit, fitResultName, 0).first;
-      double fitStatErr = getNumber(inputDirectory_fit, fitResultName, 0).second;
+      double fitResult = 1. - getNumber(inputCatalog_fit, fitResultName, 0).first;
+      double fitStatErr = getNumber(inputCatalog_fit, fitResultName, 0).second;
       std::cout << " fitResult = " << fitResult << " +/- " << fitStatErr << std::endl;
 
 //--- get Monte Carlo expected fitResult
       TString mcExpName = Form("expResult_%s_%s", fitVariable->data(), tauId->data());  
-      double mcExp = 1. - getNumber(inputDirectory_fit, mcExpName, 0).first;
+      double mcExp = 1. - getNumber(inputCatalog_fit, mcExpName, 0).first;
       std::cout << " mcExp = " << mcExp << std::endl;
 
 //--- compute "purity" correction factor to account for contribution of jet --> tau fakes
 //    to Z --> tau+ tau- signal yield
       TString fitNormName = Form("fitNorm_%s_%s", fitVariable->data(), tauId->data());   
-      double fitNorm = getNumber(inputDirectory_fit, fitNormName, 0).first;
+      double fitNorm = getNumber(inputCatalog_fit, fitNormName, 0).first;
       double fitNorm_passed = fitNorm*(1. - fitResult);
       std::cout << " fitNorm_passed = " << fitNorm_passed << std::endl;
       double fitNorm_failed = fitNorm*fitResult;
       std::cout << " fitNorm_failed = " << fitNorm_failed << std::endl;
 
       TString expNormName = Form("expNorm_%s_%s", fitVariable->data(), tauId->data()); 
-      double expNorm = getNumber(inputDirectory_fit, expNormName, 0).first;
+      double expNorm = getNumber(inputCatalog_fit, expNormName, 0).first;
       double expNorm_passed = expNorm*(1. - mcExp);
       std::cout << " expNorm_passed = " << expNorm_passed << std::endl;
       double expNorm_failed = expNorm*mcExp;
       std::cout << " expNorm_failed = " << expNorm_failed << std::endl;
 
       TString matchedTauHadName_passed = Form("Ztautau_%s_%s_TauHadMatched", region_passed.data(), tauId->data());  
-      double matchedTauHad_passed = getNumber(inputDirectory_presel, matchedTauHadName_passed, 4, effSelectionNumBins).first;
+      double matchedTauHad_passed = getNumber(inputCatalog_presel, matchedTauHadName_passed, 4, effSelectionNumBins).first;
       TString matchedFakeTauName_passed = Form("Ztautau_%s_%s_FakeTauMatched", region_passed.data(), tauId->data());
-      double matchedFakeTau_passed = getNumber(inputDirectory_presel, matchedFakeTauName_passed, 4, effSelectionNumBins).first;
+      double matchedFakeTau_passed = getNumber(inputCatalog_presel, matchedFakeTauName_passed, 4, effSelectionNumBins).first;
       double expPurity_passed = matchedTauHad_passed/(matchedTauHad_passed + matchedFakeTau_passed);
       std::cout << " expPurity_passed = " << expPurity_passed << std::endl;
       double expFake_passed = expNorm_passed*(1. - expPurity_passed);
       std::cout << " expFake_passed = " << expFake_passed << std::endl;
 
       TString matchedTauHadName_failed = TString(matchedTauHadName_passed).ReplaceAll(key_passed, key_failed);
-      double matchedTauHad_failed = getNumber(inputDirectory_presel, matchedTauHadName_failed, 4, effSelectionNumBins).first;
+      double matchedTauHad_failed = getNumber(inputCatalog_presel, matchedTauHadName_failed, 4, effSelectionNumBins).first;
       TString matchedFakeTauName_failed = TString(matchedFakeTauName_passed).ReplaceAll(key_passed, key_failed);
-      double matchedFakeTau_failed = getNumber(inputDirectory_presel, matchedFakeTauName_failed, 4, effSelectionNumBins).first;
+      double matchedFakeTau_failed = getNumber(inputCatalog_presel, matchedFakeTauName_failed, 4, effSelectionNumBins).first;
       double expPurity_failed = matchedTauHad_failed/(matchedTauHad_failed + matchedFakeTau_failed);
       std::cout << " expPurity_failed = " << expPurity_failed << std::endl;
       double expFake_failed = expNorm_failed*(1. - expPurity_failed);
@@ -224,14 +250,14 @@ int main(int argc, const char* argv[])
       TString totRateExpName_control_cc1 = Form("Ztautau_%s_%s_TauHadMatchedCorrectCharge", region_passed.data(), tauId->data()); 
       TString totRateExpName_control_cc2 = TString(totRateExpName_control_cc1).ReplaceAll(region_passed.data(), region_failed.data());
       double totRateExp_control_cc = 
-	getNumber(inputDirectory_presel, totRateExpName_control_cc1, 4, effSelectionNumBins).first
-       + getNumber(inputDirectory_presel, totRateExpName_control_cc2, 4, effSelectionNumBins).first;
+	getNumber(inputCatalog_presel, totRateExpName_control_cc1, 4, effSelectionNumBins).first
+       + getNumber(inputCatalog_presel, totRateExpName_control_cc2, 4, effSelectionNumBins).first;
       std::cout << " totRateExp_control_cc = " << totRateExp_control_cc << std::endl;
       TString totRateExpName_control_wc1 = TString(totRateExpName_control_cc1).ReplaceAll("CorrectCharge", "WrongCharge");
       TString totRateExpName_control_wc2 = TString(totRateExpName_control_cc2).ReplaceAll("CorrectCharge", "WrongCharge");
       double totRateExp_control_wc = 
-	getNumber(inputDirectory_presel, totRateExpName_control_wc1, 4, effSelectionNumBins).first 
-       + getNumber(inputDirectory_presel, totRateExpName_control_wc2, 4, effSelectionNumBins).first;
+	getNumber(inputCatalog_presel, totRateExpName_control_wc1, 4, effSelectionNumBins).first 
+       + getNumber(inputCatalog_presel, totRateExpName_control_wc2, 4, effSelectionNumBins).first;
       std::cout << " totRateExp_control_wc = " << totRateExp_control_wc << std::endl;
       double totRateExp_control = totRateExp_control_wc/(totRateExp_control_cc + totRateExp_control_wc);
       std::cout << " MC exp. (2) = " << totRateExp_control << std::endl;
@@ -118,6 +118,32 @@ int main(int argc, const char* argv[])
     throw cms::Exception("compTauIdEffFinalNumbers") 
       << "Directory = " << directory_presel << " does not exists in input file = " << inputFileName << " !!\n";
 
+//--- enumerate histograms contained in input directories once,
+//    to avoid repeated lookups by TDirectory::Get for every number retrieved by getNumber
+  TauIdEffKeyCatalog inputCatalog_fit(inputDirectory_fit);
+  TauIdEffKeyCatalog inputCatalog_presel(inputDirectory_presel);
+
+//--- read all histograms needed to compute the final numbers in one pass
+  const char* preselHistogramTypes[] = { "TauHadMatched", "TauHadMatchedReversed", "FakeTauMatched" };
+  const char* fitHistogramTypes[] = { "fitResult", "expResult", "fitNorm", "expNorm" };
+  vstring auxHistogramNames_presel;
+  vstring auxHistogramNames_fit;
+  for ( std::vector<std::string>::const_iterator tauId = tauIds.begin();
+	tauId != tauIds.end(); ++tauId ) {
+    for ( size_t iType = 0; iType < sizeof(preselHistogramTypes)/sizeof(preselHistogramTypes[0]); ++iType ) {
+      auxHistogramNames_presel.push_back(Form("Ztautau_%s_%s_%s", region_passed.data(), tauId->data(), preselHistogramTypes[iType]));
+      auxHistogramNames_presel.push_back(Form("Ztautau_%s_%s_%s", region_failed.data(), tauId->data(), preselHistogramTypes[iType]));
+    }
+    for ( std::vector<std::string>::const_iterator fitVariable = fitVariables.begin();
+	  fitVariable != fitVariables.end(); ++fitVariable ) {
+      for ( size_t iType = 0; iType < sizeof(fitHistogramTypes)/sizeof(fitHistogramTypes[0]); ++iType ) {
+	auxHistogramNames_fit.push_back(Form("%s_%s_%s", fitHistogramTypes[iType], fitVariable->data(), tauId->data()));
+      }
+    }
+  }
+  loadNumbers(inputCatalog_presel, auxHistogramNames_presel);
+  loadNumbers(inputCatalog_fit, auxHistogramNames_fit);
+
   std::map<std::string, std::map<std::string, double> > expTauIdEfficiency;     // key = (tauId, fitVariable)
   std::map<std::string, std::map<std::string, double> > measTauIdEfficiency;    // key = (tauId, fitVariable)
   std::map<std::string, std::map<std::string, double> > measTauIdEfficiencyErr; // key = (tauId, fitVariable)  
@@ -140,24 +166,24 @@ int main(int argc, const char* argv[])
       TString effPreselectionName_failed = TString(effPreselectionName_passed).ReplaceAll(key_passed, key_failed);
       
       double numLeadTrackFindingEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 1, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 1, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 1, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 1, effPreselectionNumBins).first;
       double denomLeadTrackFindingEff = 
-        getNumber(inputDirectory_presel, effPreselectionName_passed, 0, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 0, effPreselectionNumBins).first;
+        getNumber(inputCatalog_presel, effPreselectionName_passed, 0, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 0, effPreselectionNumBins).first;
       double leadTrackFindingEff = numLeadTrackFindingEff/denomLeadTrackFindingEff;
       std::cout << " leadTrackFindingEff = " << leadTrackFindingEff  << " +/- " << leadTrackFindingEffErr << std::endl;
 
       double numLeadTrackPtEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 2, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 2, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 2, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 2, effPreselectionNumBins).first;
       double denomLeadTrackPtEff = numLeadTrackFindingEff;
       double leadTrackPtEff = numLeadTrackPtEff/denomLeadTrackPtEff;
       std::cout << " leadTrackPtEff = " << leadTrackPtEff << " +/- " << leadTrackPtEffErr << std::endl;
 
       double numPFLooseIsoEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 3, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 3, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 3, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 3, effPreselectionNumBins).first;
       std::cout << "numPFLooseIsoEff = " << numPFLooseIsoEff << std::endl;
       double denomPFLooseIsoEff = numLeadTrackPtEff;
       std::cout << "denomPFLooseIsoEff = " << denomPFLooseIsoEff << std::endl;
@@ -165,29 +191,29 @@ int main(int argc, const char* argv[])
       std::cout << " pfLooseIsoEff = " << pfLooseIsoEff << " +/- " << pfLooseIsoEffErr << std::endl;
 
       double numElecVetoEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 4, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 4, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 4, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 4, effPreselectionNumBins).first;
        double denomElecVetoEff = numPFLooseIsoEff;
       double elecVetoEff = numElecVetoEff/denomElecVetoEff;
       std::cout << " elecVetoEff = " << elecVetoEff << std::endl;
 
       double numMuVetoEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 5, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 5, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 5, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 5, effPreselectionNumBins).first;
        double denomMuVetoEff = numElecVetoEff;
       double muVetoEff = numMuVetoEff/denomMuVetoEff;
       std::cout << " muVetoEff = " << muVetoEff << std::endl;
 
       double numAbsDzEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 6, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 6, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 6, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 6, effPreselectionNumBins).first;
        double denomAbsDzEff = numMuVetoEff;
        double absDzEff = numAbsDzEff/denomAbsDzEff;
       std::cout << " absDzEff = " << absDzEff << std::endl;
 
       double numChargeProdEff = 
-	getNumber(inputDirectory_presel, effPreselectionName_passed, 7, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, effPreselectionName_failed, 7, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, effPreselectionName_passed, 7, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, effPreselectionName_failed, 7, effPreselectionNumBins).first;
        double denomChargeProdEff = numAbsDzEff;
        double chargeProdEff = numChargeProdEff/denomChargeProdEff;
       std::cout << " chargeProdEff = " << chargeProdEff << " +/- " << chargeProdEff << std::endl;
@@ -204,13 +230,13 @@ int main(int argc, const char* argv[])
 
 //--- get fitResult and uncertainty on fitResult
       TString fitResultName = Form("fitResult_%s_%s", fitVariable->data(), tauId->data());   
-      double fitResult = getNumber(inputDirectory_fit, fitResultName, 0).first;
-      double fitStatErr = getNumber(inputDirectory_fit, fitResultName, 0).second;
+      double fitResult = getNumber(inputCatalog_fit, fitResultName, 0).first;
+      double fitStatErr = getNumber(inputCatalog_fit, fitResultName, 0).second;
       std::cout << " fitResult = " << fitResult << " +/- " << fitStatErr << std::endl;
 
 //--- get Monte Carlo expected fitResult
       TString mcExpName = Form("expResult_%s_%s", fitVariable->data(), tauId->data());  
-      double mcExp = getNumber(inputDirectory_fit, mcExpName, 0).first;
+      double mcExp = getNumber(inputCatalog_fit, mcExpName, 0).first;
       std::cout << " mcExp = " << mcExp << std::endl;
 
 //--- compute correction factors for loose isolation requirement applied in preselection:
@@ -223,9 +249,9 @@ int main(int argc, const char* argv[])
 //    but failing the loose isolation requirement
 //
       TString pfLooseIsoCorrFactorName = Form("Ztautau_%s_%s_TauHadMatchedReversed", region_passed.data(), tauId->data());   
-      double numPFLooseIsoCorrFactor = getNumber(inputDirectory_presel, pfLooseIsoCorrFactorName, -7, effPreselectionNumBins).first;
+      double numPFLooseIsoCorrFactor = getNumber(inputCatalog_presel, pfLooseIsoCorrFactorName, -7, effPreselectionNumBins).first;
       //std::cout << " numPFLooseIsoCorrFactor = " << numPFLooseIsoCorrFactor << std::endl;
-      double denomPFLooseIsoCorrFactor = getNumber(inputDirectory_presel, pfLooseIsoCorrFactorName, -6, effPreselectionNumBins).first;
+      double denomPFLooseIsoCorrFactor = getNumber(inputCatalog_presel, pfLooseIsoCorrFactorName, -6, effPreselectionNumBins).first;
       //std::cout << " denomPFLooseIsoCorrFactor = " << denomPFLooseIsoCorrFactor << std::endl;
       double pfLooseIsoCorrFactor = numPFLooseIsoCorrFactor/denomPFLooseIsoCorrFactor;
       double pfLooseIsoCorrFactorErr = (1./pfLooseIsoCorrFactor  - 1.)*pfLooseIsoCorrRelErr;
@@ -242,11 +268,11 @@ int main(int argc, const char* argv[])
 //
       TString leadTrackPtCorrFactorName = pfLooseIsoCorrFactorName;
       double numLeadTrackPtCorrFactor = 
-	getNumber(inputDirectory_presel, pfLooseIsoCorrFactorName, 
+	getNumber(inputCatalog_presel, pfLooseIsoCorrFactorName, 
 		  -(6 + numTauIdDiscriminators[*tauId]), effPreselectionNumBins).first;
       //std::cout << " numLeadTrackPtCorrFactor = " << numLeadTrackPtCorrFactor << std::endl;
       double denomLeadTrackPtCorrFactor = 
-	getNumber(inputDirectory_presel, pfLooseIsoCorrFactorName, 
+	getNumber(inputCatalog_presel, pfLooseIsoCorrFactorName, 
 		  -(5 + numTauIdDiscriminators[*tauId]), effPreselectionNumBins).first;
       //std::cout << " denomLeadTrackPtCorrFactor = " << denomLeadTrackPtCorrFactor << std::endl;
       double leadTrackPtCorrFactor = numLeadTrackPtCorrFactor/denomLeadTrackPtCorrFactor;
@@ -257,22 +283,22 @@ int main(int argc, const char* argv[])
 //--- compute "purity" correction factor to account for contribution of jet --> tau fakes
 //    to Z --> tau+ tau- signal yield
       TString fitNormName = Form("fitNorm_%s_%s", fitVariable->data(), tauId->data());   
-      double fitNorm = getNumber(inputDirectory_fit, fitNormName, 0).first;
+      double fitNorm = getNumber(inputCatalog_fit, fitNormName, 0).first;
       double fitNorm_passed = fitNorm*fitResult;
       double fitNorm_failed = fitNorm*(1. - fitResult);
 
       TString expNormName = Form("expNorm_%s_%s", fitVariable->data(), tauId->data()); 
-      double expNorm = getNumber(inputDirectory_fit, expNormName, 0).first;
+      double expNorm = getNumber(inputCatalog_fit, expNormName, 0).first;
       double expNorm_passed = expNorm*mcExp;
       double expNorm_failed = expNorm*(1. - mcExp);
 
       TString matchedTauHadName_passed = Form("Ztautau_%s_%s_TauHadMatched", region_passed.data(), tauId->data());  
       double matchedTauHad_passed = 
-	getNumber(inputDirectory_presel, matchedTauHadName_passed, 
+	getNumber(inputCatalog_presel, matchedTauHadName_passed, 
 		  7 + numTauIdDiscriminators[*tauId], effPreselectionNumBins).first;
       TString matchedFakeTauName_passed = Form("Ztautau_%s_%s_FakeTauMatched", region_passed.data(), tauId->data());
       double matchedFakeTau_passed = 
-	getNumber(inputDirectory_presel, matchedFakeTauName_passed, 
+	getNumber(inputCatalog_presel, matchedFakeTauName_passed, 
 		  7 + numTauIdDiscriminators[*tauId], effPreselectionNumBins).first;
       double expPurity_passed = matchedTauHad_passed/(matchedTauHad_passed + matchedFakeTau_passed);
       std::cout << " expPurity_passed = " << expPurity_passed << std::endl;
@@ -280,11 +306,11 @@ int main(int argc, const char* argv[])
 
       TString matchedTauHadName_failed = TString(matchedTauHadName_passed).ReplaceAll(key_passed, key_failed);
       double matchedTauHad_failed = 
-	getNumber(inputDirectory_presel, matchedTauHadName_failed, 
+	getNumber(inputCatalog_presel, matchedTauHadName_failed, 
 		  7, effPreselectionNumBins).first;
       TString matchedFakeTauName_failed = TString(matchedFakeTauName_passed).ReplaceAll(key_passed, key_failed);
       double matchedFakeTau_failed = 
-	getNumber(inputDirectory_presel, matchedFakeTauName_failed, 
+	getNumber(inputCatalog_presel, matchedFakeTauName_failed, 
 		  7, effPreselectionNumBins).first;
       double expPurity_failed = matchedTauHad_failed/(matchedTauHad_failed + matchedFakeTau_failed);
       std::cout << " expPurity_failed = " << expPurity_failed << std::endl;
@@ -361,12 +387,12 @@ int main(int argc, const char* argv[])
       TString totEffExpName_control_passed = Form("Ztautau_%s_%s_TauHadMatchedReversed", region_passed.data(), tauId->data()); 
       TString totEffExpName_control_failed = TString(totEffExpName_control_passed).ReplaceAll(key_passed, key_failed);
       double numTotEffExp_control = 
-	getNumber(inputDirectory_presel, totEffExpName_control_passed, -9, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, totEffExpName_control_failed, -9, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, totEffExpName_control_passed, -9, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, totEffExpName_control_failed, -9, effPreselectionNumBins).first;
       //std::cout << " numTotEffExp_control = " << numTotEffExp_control << std::endl;
       double denomTotEffExp_control = 
-	getNumber(inputDirectory_presel, totEffExpName_control_passed, 0, effPreselectionNumBins).first
-       + getNumber(inputDirectory_presel, totEffExpName_control_failed, 0, effPreselectionNumBins).first;
+	getNumber(inputCatalog_presel, totEffExpName_control_passed, 0, effPreselectionNumBins).first
+       + getNumber(inputCatalog_presel, totEffExpName_control_failed, 0, effPreselectionNumBins).first;
       //std::cout << " denomTotEffExp_control = " << denomTotEffExp_control << std::endl;
       double totEffExp_control = numTotEffExp_control/denomTotEffExp_control;
       std::cout << " MC exp. (2) = " << totEffExp_control << std::endl;
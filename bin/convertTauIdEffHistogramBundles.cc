@@ -0,0 +1,143 @@
+
+/** \executable convertTauIdEffHistogramBundles
+ *
+ * Convert histograms stored in compact TauIdEffHistogramBundle format into plain TH1 objects,
+ * for interactive use of the output files of FWLiteTauIdEffAnalyzer and FWLiteTauFakeRateAnalyzer
+ * (run with writeHistogramBundles = True).
+ *
+ * The directory structure of the input file is kept;
+ * objects other than histogram bundles are copied to the output file unchanged
+ *
+ */
+
+#include "FWCore/FWLite/interface/AutoLibraryLoader.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "DataFormats/FWLite/interface/InputSource.h"
+#include "DataFormats/FWLite/interface/OutputFiles.h"
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+#include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
+
+#include <TFile.h>
+#include <TSystem.h>
+#include <TBenchmark.h>
+#include <TDirectory.h>
+#include <TKey.h>
+#include <TList.h>
+#include <TH1.h>
+
+#include <set>
+#include <string>
+#include <vector>
+#include <iostream>
+
+void convertDirectory(TDirectory* inputDirectory, TDirectory* outputDirectory,
+		      unsigned& numBundles, unsigned& numHistograms, unsigned& numObjects)
+{
+//--- collect names of objects stored individually first,
+//    as these take precedence over histograms of the same name stored in bundles
+//   (same convention as in TauIdEffKeyCatalog)
+  std::set<std::string> objectNames;
+  TIter next(inputDirectory->GetListOfKeys());
+  while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+    if ( std::string(key->GetClassName()) != TauIdEffHistogramBundle::Class_Name() ) objectNames.insert(key->GetName());
+  }
+
+  std::set<std::string> processedKeys;
+  next.Reset();
+  while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+    // CV: keys with the highest cycle number are listed first,
+    //     skip older cycles of objects that have been written multiple times
+    if ( processedKeys.find(key->GetName()) != processedKeys.end() ) continue;
+    processedKeys.insert(key->GetName());
+
+    TObject* object = key->ReadObj();
+    if ( TDirectory* inputSubdirectory = dynamic_cast<TDirectory*>(object) ) {
+      TDirectory* outputSubdirectory = outputDirectory->mkdir(key->GetName(), inputSubdirectory->GetTitle());
+      convertDirectory(inputSubdirectory, outputSubdirectory, numBundles, numHistograms, numObjects);
+    } else if ( TauIdEffHistogramBundle* bundle = dynamic_cast<TauIdEffHistogramBundle*>(object) ) {
+      for ( unsigned idx = 0; idx < bundle->getNumHistograms(); ++idx ) {
+	if ( objectNames.find(bundle->getHistogramName(idx)) != objectNames.end() ) {
+	  std::cout << "Warning in <convertDirectory>:"
+		    << " histogram = " << bundle->getHistogramName(idx) << " stored in bundle and individually"
+		    << " in directory = " << inputDirectory->GetPath() << " --> skipping histogram stored in bundle !!" << std::endl;
+	  continue;
+	}
+	TH1* histogram = bundle->makeHistogram(idx);
+	outputDirectory->WriteTObject(histogram);
+	delete histogram;
+	++numHistograms;
+      }
+      delete bundle;
+      ++numBundles;
+    } else {
+      outputDirectory->WriteTObject(object, key->GetName());
+      delete object;
+      ++numObjects;
+    }
+  }
+}
+
+int main(int argc, const char* argv[])
+{
+//--- parse command-line arguments
+  if ( argc < 2 ) {
+    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    return 0;
+  }
+
+  std::cout << "<convertTauIdEffHistogramBundles>:" << std::endl;
+
+//--- load framework libraries
+  gSystem->Load("libFWCoreFWLite");
+  AutoLibraryLoader::enable();
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("convertTauIdEffHistogramBundles");
+
+//--- read python configuration parameters
+  if ( !edm::readPSetsFrom(argv[1])->existsAs<edm::ParameterSet>("process") )
+    throw cms::Exception("convertTauIdEffHistogramBundles")
+      << "No ParameterSet 'process' found in configuration file = " << argv[1] << " !!\n";
+
+  edm::ParameterSet cfg = edm::readPSetsFrom(argv[1])->getParameter<edm::ParameterSet>("process");
+
+  fwlite::InputSource inputFiles(cfg);
+  if ( inputFiles.files().size() != 1 )
+    throw cms::Exception("convertTauIdEffHistogramBundles")
+      << "Input file must be unique, got = " << format_vstring(inputFiles.files()) << " !!\n";
+  std::string inputFileName = (*inputFiles.files().begin());
+
+  TFile* inputFile = TFile::Open(inputFileName.data());
+  if ( !inputFile )
+    throw cms::Exception("convertTauIdEffHistogramBundles")
+      << "Failed to open inputFile = " << inputFileName << " !!\n";
+
+  fwlite::OutputFiles outputFiles(cfg);
+  TFile* outputFile = new TFile(outputFiles.file().data(), "RECREATE");
+  if ( !outputFile || outputFile->IsZombie() )
+    throw cms::Exception("convertTauIdEffHistogramBundles")
+      << "Failed to create outputFile = " << outputFiles.file() << " !!\n";
+
+  unsigned numBundles = 0;
+  unsigned numHistograms = 0;
+  unsigned numObjects = 0;
+  convertDirectory(inputFile, outputFile, numBundles, numHistograms, numObjects);
+
+  delete outputFile;
+  delete inputFile;
+
+//--print time that it took macro to run
+  std::cout << "finished executing convertTauIdEffHistogramBundles macro:" << std::endl;
+  std::cout << " #histogram bundles converted = " << numBundles << " (" << numHistograms << " histograms)" << std::endl;
+  std::cout << " #objects copied              = " << numObjects << std::endl;
+  clock.Show("convertTauIdEffHistogramBundles");
+
+  return 0;
+}
@@ -24,7 +24,10 @@
 #include "DataFormats/FWLite/interface/InputSource.h"
 #include "DataFormats/FWLite/interface/OutputFiles.h"
 
-#include "HiggsAnalysis/CombinedLimit/interface/VerticalInterpPdf.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffBinnedLikelihood.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMorphedTemplatePdf.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffPlotQueue.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffTemplateStore.h"
 
 #include "TauAnalysis/TauIdEfficiency/bin/tauIdEffAuxFunctions.h"
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
@@ -39,7 +42,6 @@
 #include "RooFormulaVar.h"
 #include "RooGaussian.h"
 #include "RooHistPdf.h"
-#include "RooIntegralMorph.h"
 #include "RooProduct.h"
 #include "RooRealVar.h"
 #include "RooSimultaneous.h"
@@ -53,17 +55,27 @@
 #include <TString.h>
 #include <TCanvas.h>
 #include <TH1.h>
+#include <TH2.h>
+#include <TGraph.h>
+#include <TKey.h>
 #include <THStack.h>
 #include <TLegend.h>
 #include <TObjArray.h>
 #include <TBenchmark.h>
 #include <TMatrixD.h>
 
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <map>
 
 enum { kNoTemplateMorphing, kHorizontalTemplateMorphing, kVerticalTemplateMorphing };
 
@@ -147,6 +159,47 @@ void addToFormula(std::string& formula, const std::string& expression, TObjArray
   }
 }
 
+void getYieldFactorExpressions_6regions(const std::string& region, 
+					std::string& exprDiTauCharge, std::string& exprDiTauKine, std::string& exprMuonIso, std::string& exprTauId)
+{
+//-------------------------------------------------------------------------------
+// Determine whether fit parameters enter the normalization of a given region
+// as 'regular' (p) or 'inverted' (1 - p) factor, or not at all (empty string)
+//
+// NOTE: auxiliary function for makeRooFormulaVar_6regions
+//      (the regions are defined in the comment of makeRooFormulaVar_6regions)
+//
+//-------------------------------------------------------------------------------
+
+  exprDiTauCharge = "";
+  exprDiTauKine   = "";
+  exprMuonIso     = "";
+  exprTauId       = "";
+
+  if        ( region.find("A") != std::string::npos ) {
+    exprDiTauCharge = "regular";
+    exprMuonIso     = "inverted";
+  } else if ( region.find("B") != std::string::npos ) {
+    exprDiTauCharge = "inverted";
+    exprMuonIso     = "inverted";
+  } else if ( region.find("C") != std::string::npos ) {
+    exprDiTauCharge = "regular";
+    exprMuonIso     = "regular"; 
+  } else if ( region.find("D") != std::string::npos ) {
+    exprDiTauCharge = "inverted";
+    exprMuonIso     = "regular";
+  } else {
+    throw cms::Exception("makeRooFormulaVar_6regions") 
+      << "Region = " << region << " not defined !!\n";
+  }
+  
+  if      ( region.find("1") != std::string::npos ) exprDiTauKine = "regular";
+  else if ( region.find("2") != std::string::npos ) exprDiTauKine = "inverted";
+  
+  if      ( region.find("p") != std::string::npos ) exprTauId     = "regular";
+  else if ( region.find("f") != std::string::npos ) exprTauId     = "inverted";
+}
+
 RooFormulaVar* makeRooFormulaVar_6regions(const std::string& process, 
 					  const std::string& region, const std::string& region_passed, const std::string& region_failed, 
 					  RooAbsReal* norm, RooAbsReal* fittedFraction, unsigned numCategories,
@@ -190,33 +243,8 @@ RooFormulaVar* makeRooFormulaVar_6regions(const std::string& process,
 
   RooFormulaVar* retVal = 0;
 
-  std::string exprDiTauCharge = "";
-  std::string exprDiTauKine   = "";
-  std::string exprMuonIso     = "";
-  std::string exprTauId       = "";
-
-  if        ( region.find("A") != std::string::npos ) {
-    exprDiTauCharge = "regular";
-    exprMuonIso     = "inverted";
-  } else if ( region.find("B") != std::string::npos ) {
-    exprDiTauCharge = "inverted";
-    exprMuonIso     = "inverted";
-  } else if ( region.find("C") != std::string::npos ) {
-    exprDiTauCharge = "regular";
-    exprMuonIso     = "regular"; 
-  } else if ( region.find("D") != std::string::npos ) {
-    exprDiTauCharge = "inverted";
-    exprMuonIso     = "regular";
-  } else {
-    throw cms::Exception("makeRooFormulaVar_6regions") 
-      << "Region = " << region << " not defined !!\n";
-  }
-  
-  if      ( region.find("1") != std::string::npos ) exprDiTauKine = "regular";
-  else if ( region.find("2") != std::string::npos ) exprDiTauKine = "inverted";
-  
-  if      ( region.find("p") != std::string::npos ) exprTauId     = "regular";
-  else if ( region.find("f") != std::string::npos ) exprTauId     = "inverted";
+  std::string exprDiTauCharge, exprDiTauKine, exprMuonIso, exprTauId;
+  getYieldFactorExpressions_6regions(region, exprDiTauCharge, exprDiTauKine, exprMuonIso, exprTauId);
 
   // CV: fitted yields for all processes come-out factor N too high in closure test
   //    --> compensate by multiplying fittedFraction by fudge-factor N,
@@ -318,16 +346,16 @@ RooAbsPdf* makePdfHorizontalMorphing(histogramMap3& histograms,
   std::string templateHistName = histograms[region][fitVariable.name_][key_central_value]->GetName();
 
   TH1* templateHistUp = histograms[region][fitVariable.name_][std::string(sysUncertainty).append("Up")];
-  RooHistPdf* pdfUp = makeRooHistPdf(templateHistUp, fitVariable.xAxis_);
-
   TH1* templateHistDown = histograms[region][fitVariable.name_][std::string(sysUncertainty).append("Down")];
-  RooHistPdf* pdfDown = makeRooHistPdf(templateHistDown, fitVariable.xAxis_);
   
   RooRealVar* alpha = alphaParameters[sysUncertainty].alpha_;
 
+  // CV: use TauIdEffMorphedTemplatePdf instead of RooIntegralMorph,
+  //     in order to avoid numerical integration and sampling of the morphed template on a grid
+  //     in every evaluation of the likelihood function during the fit
   std::string pdfName = std::string(templateHistName).append("_pdf");
-  RooIntegralMorph* pdf = new RooIntegralMorph(pdfName.data(), pdfName.data(), *pdfUp, *pdfDown, *fitVariable.xAxis_, *alpha);
-  pdf->setCacheAlpha(true);
+  TauIdEffMorphedTemplatePdf* pdf = 
+    new TauIdEffMorphedTemplatePdf(pdfName.data(), pdfName.data(), *fitVariable.xAxis_, templateHistUp, templateHistDown, *alpha);
   return pdf;
 }
 
@@ -335,46 +363,38 @@ RooAbsPdf* makePdfVerticalMorphing(histogramMap3& histograms,
 				   const std::string& region, fitVariableType& fitVariable, const vstring& sysUncertainties,
 				   std::map<std::string, alphaParameterType>& alphaParameters)
 {
-  // NOTE: VerticalInterpPdf requires "up"/"down" systematic shifts to be passed as pdfs
-  //       The pdfs are assumed to be ordered in the following way, together with the  morphing parameters:
-  //      o pdfs   = { histogram_central_value, histogram_sys1Up, histogram_sys1Down, histogram_sys2Up, histogram_sys2Down,... }
-  //      o alphas = { alpha_sys1, alpha_sys2 }
-  //
-  //     --> number of pdfs = 2*(numbers of alphas) + 1)
+  // NOTE: "up"/"down" templates and morphing parameters are passed to TauIdEffMorphedTemplatePdf in the same order:
+  //      o templates_up   = { histogram_sys1Up, histogram_sys2Up,... }
+  //      o templates_down = { histogram_sys1Down, histogram_sys2Down,... }
+  //      o alphas         = { alpha_sys1, alpha_sys2,... }
   //
 
   //std::cout << "<makePdfVerticalMorphing>:" << std::endl;
 
-  TObjArray pdfs;
-  TObjArray alphas;
+  std::vector<const TH1*> templateHists_up;
+  std::vector<const TH1*> templateHists_down;
+  RooArgList alphas;
 
   std::string templateHistName = histograms[region][fitVariable.name_][key_central_value]->GetName();
 
   TH1* templateHist_central_value = histograms[region][fitVariable.name_][key_central_value];
-  RooHistPdf* pdf_central_value = makeRooHistPdf(templateHist_central_value, fitVariable.xAxis_);
-  pdfs.Add(pdf_central_value);
 
   for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
 	sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
     TH1* templateHist_up = histograms[region][fitVariable.name_][std::string(*sysUncertainty).append("Up")];
-    RooHistPdf* pdf_up = makeRooHistPdf(templateHist_up, fitVariable.xAxis_);
-    pdfs.Add(pdf_up);
+    templateHists_up.push_back(templateHist_up);
 
     TH1* templateHist_down = histograms[region][fitVariable.name_][std::string(*sysUncertainty).append("Down")];
-    RooHistPdf* pdf_down = makeRooHistPdf(templateHist_down, fitVariable.xAxis_);
-    pdfs.Add(pdf_down);
+    templateHists_down.push_back(templateHist_down);
 
     RooRealVar* alpha = alphaParameters[*sysUncertainty].alpha_;
-    alphas.Add(alpha);
+    alphas.add(*alpha);
   }
 
-  if ( pdfs.GetEntries() != (2*alphas.GetEntries() + 1) ) 
-    throw cms::Exception("makePdfVerticalMorphing") 
-      << "Number of 'pdf' = " << pdfs.GetEntries() << " and 'alpha' parameter = " << alphas.GetEntries()
-      << " arguments not compatible !!\n";
-
   std::string pdfName = std::string(templateHistName).append("_pdf");
-  VerticalInterpPdf* pdf = new VerticalInterpPdf(pdfName.data(), pdfName.data(), RooArgList(pdfs), RooArgList(alphas));
+  TauIdEffMorphedTemplatePdf* pdf = 
+    new TauIdEffMorphedTemplatePdf(pdfName.data(), pdfName.data(), *fitVariable.xAxis_, 
+				   templateHist_central_value, templateHists_up, templateHists_down, alphas);
   return pdf;
 }
 
@@ -488,6 +508,11 @@ struct processEntryType
     for ( vstring::const_iterator sysUncertainty = sysUncertainties_.begin();
 	  sysUncertainty != sysUncertainties_.end(); ++sysUncertainty ) {
       std::string alphaName = std::string(name).append("_alpha_").append(*sysUncertainty);
+//--- CV: convention for morphing parameters (same as for RooIntegralMorph/VerticalInterpPdf):
+//         o horizontal morphing: alpha = 0 (1) corresponds to the "down" ("up") template,
+//           nominal value 0.5 (halfway between "down" and "up" template)
+//         o vertical morphing: alpha = -1 (+1) corresponds to the "down" ("up") template,
+//           nominal value 0 ("central" template)
       if ( templateMorphingMode == kHorizontalTemplateMorphing ) {
 	RooRealVar* alpha = new RooRealVar(alphaName.data(), alphaName.data(), 0.5, 0., 1.);
 	alphaParameters_[*sysUncertainty] = alphaParameterType(alpha, false);
@@ -719,29 +744,18 @@ TH1* compFittedTemplateShape(processEntryType& processEntry, const std::string&
   std::string histogramName_fitted = std::string(histogram_central_value->GetName()).append("_fittedShape");
   TH1* histogram_fitted = (TH1*)histogram_central_value->Clone(histogramName_fitted.data());
 
-  TAxis* xAxis = histogram_central_value->GetXaxis();
-  for ( int iBin = 1; iBin <= (histogram_fitted->GetNbinsX() + 1); ++iBin ) {
-    double xMin = xAxis->GetBinLowEdge(iBin);
-    double xMax = xAxis->GetBinUpEdge(iBin);
-    if ( dynamic_cast<VerticalInterpPdf*>(pdf) ) { // special handling for Giovanni's vertical morphing pdf
-      double binContent = histogram_central_value->GetBinContent(iBin);
-      for ( vstring::const_iterator sysUncertainty = processEntry.sysUncertainties_.begin();
-	    sysUncertainty != processEntry.sysUncertainties_.end(); ++sysUncertainty ) {
-	std::string key_up = std::string(*sysUncertainty).append("Up");
-	TH1* histogram_up = processEntry.histograms_[region][fitVariableName][key_up];
-	//std::cout << " histogram_up = " << histogram_up << std::endl;
-
-	std::string key_down = std::string(*sysUncertainty).append("Down");
-	TH1* histogram_down = processEntry.histograms_[region][fitVariableName][key_down];
-	//std::cout << " histogram_down = " << histogram_down << std::endl;
-
-	double coeff = processEntry.alphaParameters_[*sysUncertainty].alpha_->getVal();
-
-	if      ( coeff > 0. ) binContent += coeff*(histogram_up->GetBinContent(iBin) - histogram_central_value->GetBinContent(iBin));
-	else if ( coeff < 0. ) binContent += coeff*(histogram_central_value->GetBinContent(iBin) - histogram_down->GetBinContent(iBin));
-      }
-      histogram_fitted->SetBinContent(iBin, binContent);
-    } else { // all other pdfs
+  TauIdEffMorphedTemplatePdf* morphedPdf = dynamic_cast<TauIdEffMorphedTemplatePdf*>(pdf);
+  if ( morphedPdf ) { // morphed bin-contents precomputed by pdf for current values of alpha parameters
+    histogram_fitted->Reset();
+    const std::vector<double>& binContents = morphedPdf->getMorphedBinContents();
+    for ( unsigned iBin = 0; iBin < binContents.size(); ++iBin ) {
+      histogram_fitted->SetBinContent(iBin + 1, binContents[iBin]);
+    }
+  } else { // all other pdfs
+    TAxis* xAxis = histogram_central_value->GetXaxis();
+    for ( int iBin = 1; iBin <= (histogram_fitted->GetNbinsX() + 1); ++iBin ) {
+      double xMin = xAxis->GetBinLowEdge(iBin);
+      double xMax = xAxis->GetBinUpEdge(iBin);
       RooRealVar* fitVariable = processEntry.fitVariables_[region].xAxis_;
       TString binLabel = Form("bin%i", iBin);
       fitVariable->getBinning(binLabel.Data(), false, true);
@@ -760,74 +774,106 @@ TH1* compFittedTemplateShape(processEntryType& processEntry, const std::string&
 //-------------------------------------------------------------------------------
 //
 
-void fitUsingRooFit(processEntryType& data, double intLumiData, 
-		    std::map<std::string, processEntryType*>& processEntries, // key = process name
-		    double sysVariedByNsigma, const std::string& processName_signal,
-		    const std::string& tauId, double& effValue, double& effError, bool& hasFitConverged,
-		    int verbosity = 0)
+struct fitConstraintType
 {
-  if ( verbosity ) {
-    std::cout << "<fitUsingRooFit>:" << std::endl;
-    std::cout << " performing Fit of variable = " << data.fitVariables_[data.region_passed_].name_ 
-	      << " for Tau id. = " << tauId << std::endl;
-  }
+  fitConstraintType(RooRealVar* p, double value, double error)
+    : p_(p),
+      value_(value),
+      error_(error)
+  {}
+  RooRealVar* p_;
+  double value_;
+  double error_;
+};
 
-  std::map<std::string, RooAddPdf*> pdfsSum;
-  
-  for ( vstring::const_iterator region = data.regionsToFit_.begin();
-	region != data.regionsToFit_.end(); ++region ) {
-    TObjArray pdfs_region;
-    TObjArray fitParameters_region;
-    for ( std::map<std::string, processEntryType*>::const_iterator processEntry = processEntries.begin();
-	  processEntry != processEntries.end(); ++processEntry ) {
-      if ( processEntry->first == "mcSum" ) continue;
-      pdfs_region.Add(processEntry->second->pdfs_[*region]);
-      fitParameters_region.Add(processEntry->second->normFactors_[*region]);
+typedef std::vector<fitConstraintType> vFitConstraints;
+
+struct fitStartingPointType // parameter values, uncertainties and covariance matrix obtained by previous fit
+{
+  std::vector<RooRealVar*> parameters_;
+  std::vector<double> values_;
+  std::vector<double> errors_;
+  std::vector<double> covariance_; // layout = (parameter1, parameter2)
+  double minNll_;                  // value of negative log-likelihood function at minimum
+};
+
+struct fitOptionsType
+{
+  fitOptionsType()
+    : runHesse_(true),
+      minosParameter_(0),
+      startingPoint_(0),
+      fixedParameter_(0),
+      fixedParameterValue_(0.)
+  {}
+  bool runHesse_;                             // set to false in case only fitted values (no uncertainties) are needed
+  RooRealVar* minosParameter_;                // compute MINOS errors for this parameter (if non-zero)
+  const fitStartingPointType* startingPoint_; // start fit from result of previous fit (if non-zero)
+  RooRealVar* fixedParameter_;                // keep this parameter constant at value fixedParameterValue_ during the fit (if non-zero),
+  double fixedParameterValue_;                // as needed for profile-likelihood scans
+};
+
+void saveFitStartingPoint(fitStartingPointType& fittedPoint, const std::vector<RooRealVar*>& parameters, const TMatrixD& cov, double minNll)
+{
+  unsigned numParameters = parameters.size();
+  fittedPoint.parameters_ = parameters;
+  fittedPoint.minNll_ = minNll;
+  fittedPoint.values_.resize(numParameters);
+  fittedPoint.errors_.resize(numParameters);
+  fittedPoint.covariance_.resize(numParameters*numParameters);
+  for ( unsigned iParameter = 0; iParameter < numParameters; ++iParameter ) {
+    fittedPoint.values_[iParameter] = parameters[iParameter]->getVal();
+    fittedPoint.errors_[iParameter] = ( parameters[iParameter]->isConstant() ) ? 0. : parameters[iParameter]->getError();
+    for ( unsigned jParameter = 0; jParameter < numParameters; ++jParameter ) {
+      fittedPoint.covariance_[iParameter*numParameters + jParameter] = cov(iParameter, jParameter);
     }
-    
-    std::string pdfSumName = std::string("pdfSum").append(*region);
-    pdfsSum[*region] = 
-      new RooAddPdf(pdfSumName.data(),
-		    pdfSumName.data(), RooArgList(pdfs_region), RooArgList(fitParameters_region));
   }
+}
+
+void applyFitStartingPoint(const fitStartingPointType& startingPoint)
+{
+//--- set fit parameters to values and uncertainties of previous fit
+//   (uncertainties are used as initial step-sizes by Minuit)
+  for ( unsigned iParameter = 0; iParameter < startingPoint.parameters_.size(); ++iParameter ) {
+    RooRealVar* parameter = startingPoint.parameters_[iParameter];
+    parameter->setVal(startingPoint.values_[iParameter]);
+    if ( startingPoint.errors_[iParameter] > 0. ) parameter->setError(startingPoint.errors_[iParameter]);
+  }
+}
+
+bool isRegionABC2D(const std::string& region)
+{
+  return ( region == "A" || region == "B" || region == "C2" || region == "D" );
+}
+
+bool isRegionC1(const std::string& region)
+{
+  return ( region == "C1p" || region == "C1f" || region == "D1p" );
+}
+
+void setFitConstraints(processEntryType& data,
+		       std::map<std::string, processEntryType*>& processEntries, // key = process name
+		       double sysVariedByNsigma, 
+		       vFitConstraints& fitConstraintsABC2D, vFitConstraints& fitConstraintsC1)
+{
+//-------------------------------------------------------------------------------
+// Fix fit parameters for which template histograms have low event statistics
+// and define Gaussian constraints on all other fit parameters.
 //
-// CV: due to limitation in RooFit
-//    (cf. http://root.cern.ch/phpBB3/viewtopic.php?f=15&t=9518)
-//     need to construct log-likelihood functions separately for regions { A, B, D } and { C1p, C1f }
+// NOTE: the constraints are shared by the RooFit and the native likelihood fit backends
 //
-  RooCategory* fitCategoriesABC2D = new RooCategory("categoriesABC2D", "categoriesABC2D");
-  RooSimultaneous* pdfSimultaneousFitABC2D = 
-    new RooSimultaneous("pdfSimultaneousFitABC2D", 
-			"pdfSimultaneousFitABC2D", *fitCategoriesABC2D);
-  histogramMap1 histogramDataMapABC2D; // key = region
-  TObjArray fitConstraintsABC2D;
-  bool doFitABC2D = false;
+//-------------------------------------------------------------------------------
 
-  RooCategory* fitCategoriesC1 = new RooCategory("categoriesC1", "categoriesC1");
-  RooSimultaneous* pdfSimultaneousFitC1 = 
-    new RooSimultaneous("pdfSimultaneousFitC1", 
-			"pdfSimultaneousFitC1", *fitCategoriesC1);
-  histogramMap1 histogramDataMapC1; // key = region
-  TObjArray fitConstraintsC1;
+  bool doFitABC2D = false;
   bool doFitC1 = false;
 
   for ( vstring::const_iterator region = data.regionsToFit_.begin();
 	region != data.regionsToFit_.end(); ++region ) {
-    TObjArray* fitConstraints = 0;
-    if ( (*region) == "A"  ||
-	 (*region) == "B"  ||
-	 (*region) == "C2" ||
-	 (*region) == "D"  ) {
-      fitCategoriesABC2D->defineType(region->data());
-      pdfSimultaneousFitABC2D->addPdf(*pdfsSum[*region], region->data());
-      histogramDataMapABC2D[*region] = data.histograms_[*region][data.fitVariables_[*region].name_][key_central_value];      
+    vFitConstraints* fitConstraints = 0;
+    if ( isRegionABC2D(*region) ) {
       fitConstraints = &fitConstraintsABC2D;
       doFitABC2D = true;
-    } else if ( (*region) == "C1p" ||
-		(*region) == "C1f" || (*region) == "D1p" ) {
-      fitCategoriesC1->defineType(region->data());
-      pdfSimultaneousFitC1->addPdf(*pdfsSum[*region], region->data());
-      histogramDataMapC1[*region] = data.histograms_[*region][data.fitVariables_[*region].name_][key_central_value];
+    } else if ( isRegionC1(*region) ) {
       fitConstraints = &fitConstraintsC1;
       doFitC1 = true;
     } 
@@ -855,19 +901,16 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 	    alphaParameter.alpha_->setConstant(true);
 	  } else {
 	    bool isAlreadyIncluded = false;
-	    for ( int iFitConstraint = 0; iFitConstraint < fitConstraints->GetEntries(); ++iFitConstraint ) {
-	      if ( dynamic_cast<RooGaussian*>(fitConstraints->At(iFitConstraint)) ) {
-		RooGaussian* fitConstraint = dynamic_cast<RooGaussian*>(fitConstraints->At(iFitConstraint));
-		if ( fitConstraint->GetName() == std::string(alphaParameter.alpha_->GetName()).append("_constraint") ) 
-		  isAlreadyIncluded = true;
-	      }
+	    for ( vFitConstraints::const_iterator fitConstraint = fitConstraints->begin();
+		  fitConstraint != fitConstraints->end(); ++fitConstraint ) {
+	      if ( fitConstraint->p_ == alphaParameter.alpha_ ) isAlreadyIncluded = true;
 	    }
 	    if ( !isAlreadyIncluded ) {
 	      std::cout << "process = " << processEntry->first << ": adding alpha-parameter = " << alphaParameter.name_ << std::endl;
 	      if ( !alphaParameter.isBiDirectional_ ) // horizontal morphing
-		fitConstraints->Add(makeFitConstraint(alphaParameter.alpha_, 0.5, 0.5/sysVariedByNsigma));
+		fitConstraints->push_back(fitConstraintType(alphaParameter.alpha_, 0.5, 0.5/sysVariedByNsigma));
 	      else                                    // vertical morphing
-		fitConstraints->Add(makeFitConstraint(alphaParameter.alpha_, 0.0, 1.0/sysVariedByNsigma));
+		fitConstraints->push_back(fitConstraintType(alphaParameter.alpha_, 0.0, 1.0/sysVariedByNsigma));
 	    } 
 	  }
 	}
@@ -888,17 +931,17 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 	 processEntry->first == "WplusJets"  ||
 	 processEntry->first == "EWKjetFake" ||
 	 processEntry->first == "TTplusJets" )
-      fitConstraintsC1.Add(makeFitConstraint(processEntry->second->norm_.fittedValue_, 
-					     processEntry->second->norm_.expectedValue_, TMath::Max(1.e+1, 0.5*processEntry->second->norm_.expectedValue_)));
+      fitConstraintsC1.push_back(fitConstraintType(processEntry->second->norm_.fittedValue_, 
+						   processEntry->second->norm_.expectedValue_, TMath::Max(1.e+1, 0.5*processEntry->second->norm_.expectedValue_)));
     else if ( processEntry->first == "QCD" ) {
-      //fitConstraintsC1.Add(makeFitConstraint(processEntry->second->norm_.fittedValue_, 
-      //                                       processEntry->second->norm_.expectedValue_, TMath::Max(1.e+1, 0.5*processEntry->second->norm_.expectedValue_)));
+      //fitConstraintsC1.push_back(fitConstraintType(processEntry->second->norm_.fittedValue_, 
+      //                                             processEntry->second->norm_.expectedValue_, TMath::Max(1.e+1, 0.5*processEntry->second->norm_.expectedValue_)));
       processEntry->second->norm_.fittedValue_->setVal(0.33*processEntry->second->norm_.fittedValue_->getVal());
       processEntry->second->norm_.fittedValue_->setConstant(true);
     } else if ( processEntry->first == "Zmumu"     || 
 	        processEntry->first == "EWKmuFake" )
-      fitConstraintsC1.Add(makeFitConstraint(processEntry->second->norm_.fittedValue_, 
-					     processEntry->second->norm_.expectedValue_, TMath::Max(1.e+1, 1.0*processEntry->second->norm_.expectedValue_)));
+      fitConstraintsC1.push_back(fitConstraintType(processEntry->second->norm_.fittedValue_, 
+						   processEntry->second->norm_.expectedValue_, TMath::Max(1.e+1, 1.0*processEntry->second->norm_.expectedValue_)));
     processEntry->second->norm_.fittedValue_->setMin(1.);
     if ( processEntry->first == "EWKmuFake" ) processEntry->second->norm_.fittedValue_->setMax(5.*processEntry->second->norm_.expectedValue_);
     
@@ -919,16 +962,16 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 	//} else {
 	  if ( processEntry->first == "Ztautau" )
 	    //fitParameter->second.fittedValue_->setConstant(true);
-	    fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						      fitParameter->second.expectedValue_, 0.025));
+	    fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							    fitParameter->second.expectedValue_, 0.025));
 	  else if ( processEntry->first == "Zmumu"      ||
 		    processEntry->first == "WplusJets"  ||
 		    processEntry->first == "EWKjetFake" )
-	    fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_,
-						      fitParameter->second.expectedValue_, 0.10));
+	    fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_,
+							    fitParameter->second.expectedValue_, 0.10));
 	  else 
-	    fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						      fitParameter->second.expectedValue_, 0.05));
+	    fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							    fitParameter->second.expectedValue_, 0.05));
 	//}
       } else if ( fitParameter->first == "pMuonIso_tight_loose" ) {
 	if ( isLowStatistics["A"] && 
@@ -944,15 +987,15 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 	       processEntry->first == "WplusJets"  ||
 	       processEntry->first == "EWKmuFake"  ||
 	       processEntry->first == "EWKjetFake" )
-	    fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						      fitParameter->second.expectedValue_, 0.01));
+	    fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							    fitParameter->second.expectedValue_, 0.01));
 	  else if ( processEntry->first == "TTplusJets" )
-	    fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						      fitParameter->second.expectedValue_, 0.02));
+	    fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							    fitParameter->second.expectedValue_, 0.02));
 	  //else if ( !(processEntry->first == "QCD") )
           else
-	    fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						      fitParameter->second.expectedValue_, TMath::Max(0.05, 0.5*fitParameter->second.expectedValue_)));
+	    fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							    fitParameter->second.expectedValue_, TMath::Max(0.05, 0.5*fitParameter->second.expectedValue_)));
 	}
       } else if ( fitParameter->first == "pDiTauKine_Sig_Bgr" ) {
 	if ( isLowStatistics["C1p"] && 
@@ -960,8 +1003,8 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 	     isLowStatistics["C2"]  ) {
 	  fitParameter->second.fittedValue_->setConstant(true);
 	} else {
-	  fitConstraintsABC2D.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						    fitParameter->second.expectedValue_, TMath::Max(0.01, 0.10*fitParameter->second.expectedValue_)));
+	  fitConstraintsABC2D.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							  fitParameter->second.expectedValue_, TMath::Max(0.01, 0.10*fitParameter->second.expectedValue_)));
 	}
       } else if ( fitParameter->first == "pTauId_passed_failed" ) {
 	if ( isLowStatistics["C1p"] && 
@@ -971,17 +1014,149 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 	  if ( processEntry->first == "WplusJets"  ||
 	       processEntry->first == "EWKjetFake" ||
 	       processEntry->first == "QCD"        )
-	    fitConstraintsC1.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						   fitParameter->second.expectedValue_, TMath::Max(0.01, 0.2*fitParameter->second.expectedValue_)));
+	    fitConstraintsC1.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							 fitParameter->second.expectedValue_, TMath::Max(0.01, 0.2*fitParameter->second.expectedValue_)));
 	  else if ( processEntry->first == "Zmumu"     ||
 		    processEntry->first == "EWKmuFake" )
-	    fitConstraintsC1.Add(makeFitConstraint(fitParameter->second.fittedValue_, 
-						   fitParameter->second.expectedValue_, TMath::Max(0.05, 0.5*fitParameter->second.expectedValue_)));
+	    fitConstraintsC1.push_back(fitConstraintType(fitParameter->second.fittedValue_, 
+							 fitParameter->second.expectedValue_, TMath::Max(0.05, 0.5*fitParameter->second.expectedValue_)));
 	}
       }
     }
   }
 
+//--- constraints on parameters of regions A, B, C2, D are applied in case these regions are fitted only
+  if ( !doFitABC2D ) fitConstraintsABC2D.clear();
+}
+
+void printFitResult(processEntryType& data,
+		    std::map<std::string, processEntryType*>& processEntries, // key = process name
+		    const std::string& tauId)
+{
+  std::cout << "Results of fitting variable = " << data.fitVariables_[data.region_passed_].name_ << " for Tau id. = " << tauId << std::endl;
+  for ( std::map<std::string, processEntryType*>::const_iterator processEntry = processEntries.begin();
+	processEntry != processEntries.end(); ++processEntry ) {
+    std::cout << " " << processEntry->second->name_ << ":" << std::endl;
+    std::cout << "  normalization = " << processEntry->second->norm_.fittedValue_->getVal()
+	      << " +/- " << processEntry->second->norm_.fittedValue_->getError()
+	      << " (MC exp. = " << processEntry->second->norm_.expectedValue_ << ")" << std::endl;
+
+    for ( std::map<std::string, fitParameterType>::const_iterator fitParameter = processEntry->second->fitParameters_.begin();
+	  fitParameter != processEntry->second->fitParameters_.end(); ++fitParameter ) {
+      std::cout << "  " << fitParameter->first << " = " << fitParameter->second.fittedValue_->getVal()
+		<< " +/- " << fitParameter->second.fittedValue_->getError()
+		<< " (MC exp. = " << fitParameter->second.expectedValue_ << ")" << std::endl;
+    }
+
+    if ( processEntry->second->alphaParameters_.begin() != processEntry->second->alphaParameters_.end() ) {
+      std::cout << "  nuissance parameters:" << std::endl;
+      for ( vstring::const_iterator sysUncertainty = processEntry->second->sysUncertainties_.begin();
+	    sysUncertainty != processEntry->second->sysUncertainties_.end(); ++sysUncertainty ) {
+	alphaParameterType& alphaParameter = processEntry->second->alphaParameters_[*sysUncertainty];
+	std::cout << "   " << (*sysUncertainty) << " = " << alphaParameter.alpha_->getVal() 
+		  << " +/- " << alphaParameter.alpha_->getError() << std::endl;
+      }
+    }
+
+    for ( vstring::const_iterator region = data.regionsToFit_.begin();
+	  region != data.regionsToFit_.end(); ++region ) {
+      std::cout << "  region " << (*region) << " = " 
+		<< processEntry->second->normFactors_[*region]->getVal()/
+ 	            (processEntry->second->fittedFractions_[*region][data.fitVariables_[*region].name_]->getVal()*processEntry->second->numCategories_[*region])
+		<< " (MC exp. = " << processEntry->second->numEvents_[*region][key_central_value] << ","
+		<< " fitted fraction = " << processEntry->second->fittedFractions_[*region][data.fitVariables_[*region].name_]->getVal() << ")" << std::endl;
+    }
+  }
+  std::cout << " Data:" << std::endl;
+  std::cout << "  events = " << data.numEvents_["ABCD"][key_central_value] 
+	    << " +/- " << TMath::Sqrt(data.numEvents_["ABCD"][key_central_value]) << std::endl;
+  for ( vstring::const_iterator region = data.regionsToFit_.begin();
+	region != data.regionsToFit_.end(); ++region ) {
+    std::cout << "  region " << (*region) << " = " << data.numEvents_[*region][key_central_value] 
+	      << " +/- " << TMath::Sqrt(data.numEvents_[*region][key_central_value]) << std::endl;
+  }
+}
+
+TH2D* makeCorrelationHistogram(const std::string& histogramName, const vstring& parameterNames, const TMatrixD& cov)
+{
+  int numParameters = parameterNames.size();
+  TH2D* histogram = new TH2D(histogramName.data(), histogramName.data(), 
+			     numParameters, -0.5, numParameters - 0.5, numParameters, -0.5, numParameters - 0.5);
+  for ( int iParameter = 0; iParameter < numParameters; ++iParameter ) {
+    histogram->GetXaxis()->SetBinLabel(iParameter + 1, parameterNames[iParameter].data());
+    histogram->GetYaxis()->SetBinLabel(iParameter + 1, parameterNames[iParameter].data());
+    for ( int jParameter = 0; jParameter < numParameters; ++jParameter ) {
+      double sigmaI2 = cov(iParameter, iParameter);
+      double sigmaJ2 = cov(jParameter, jParameter);
+      double corrIJ = ( sigmaI2 > 0. && sigmaJ2 > 0. ) ? cov(iParameter, jParameter)/TMath::Sqrt(sigmaI2*sigmaJ2) : 0.;
+      histogram->SetBinContent(iParameter + 1, jParameter + 1, corrIJ);
+    }
+  }
+  return histogram;
+}
+
+bool fitUsingRooFit(processEntryType& data, 
+		    std::map<std::string, processEntryType*>& processEntries, // key = process name
+		    const vFitConstraints& fitConstraintsABC2D, const vFitConstraints& fitConstraintsC1,
+		    const std::string& tauId, int verbosity = 0, const fitOptionsType& options = fitOptionsType(), 
+		    TH2D** histogramCorrelations = 0, fitStartingPointType* fittedPoint = 0)
+{
+  if ( verbosity ) {
+    std::cout << "<fitUsingRooFit>:" << std::endl;
+    std::cout << " performing Fit of variable = " << data.fitVariables_[data.region_passed_].name_ 
+	      << " for Tau id. = " << tauId << std::endl;
+  }
+
+  std::map<std::string, RooAddPdf*> pdfsSum;
+  
+  for ( vstring::const_iterator region = data.regionsToFit_.begin();
+	region != data.regionsToFit_.end(); ++region ) {
+    TObjArray pdfs_region;
+    TObjArray fitParameters_region;
+    for ( std::map<std::string, processEntryType*>::const_iterator processEntry = processEntries.begin();
+	  processEntry != processEntries.end(); ++processEntry ) {
+      if ( processEntry->first == "mcSum" ) continue;
+      pdfs_region.Add(processEntry->second->pdfs_[*region]);
+      fitParameters_region.Add(processEntry->second->normFactors_[*region]);
+    }
+    
+    std::string pdfSumName = std::string("pdfSum").append(*region);
+    pdfsSum[*region] = 
+      new RooAddPdf(pdfSumName.data(),
+		    pdfSumName.data(), RooArgList(pdfs_region), RooArgList(fitParameters_region));
+  }
+//
+// CV: due to limitation in RooFit
+//    (cf. http://root.cern.ch/phpBB3/viewtopic.php?f=15&t=9518)
+//     need to construct log-likelihood functions separately for regions { A, B, D } and { C1p, C1f }
+//
+  RooCategory* fitCategoriesABC2D = new RooCategory("categoriesABC2D", "categoriesABC2D");
+  RooSimultaneous* pdfSimultaneousFitABC2D = 
+    new RooSimultaneous("pdfSimultaneousFitABC2D", 
+			"pdfSimultaneousFitABC2D", *fitCategoriesABC2D);
+  histogramMap1 histogramDataMapABC2D; // key = region
+  bool doFitABC2D = false;
+
+  RooCategory* fitCategoriesC1 = new RooCategory("categoriesC1", "categoriesC1");
+  RooSimultaneous* pdfSimultaneousFitC1 = 
+    new RooSimultaneous("pdfSimultaneousFitC1", 
+			"pdfSimultaneousFitC1", *fitCategoriesC1);
+  histogramMap1 histogramDataMapC1; // key = region
+
+  for ( vstring::const_iterator region = data.regionsToFit_.begin();
+	region != data.regionsToFit_.end(); ++region ) {
+    if ( isRegionABC2D(*region) ) {
+      fitCategoriesABC2D->defineType(region->data());
+      pdfSimultaneousFitABC2D->addPdf(*pdfsSum[*region], region->data());
+      histogramDataMapABC2D[*region] = data.histograms_[*region][data.fitVariables_[*region].name_][key_central_value];      
+      doFitABC2D = true;
+    } else if ( isRegionC1(*region) ) {
+      fitCategoriesC1->defineType(region->data());
+      pdfSimultaneousFitC1->addPdf(*pdfsSum[*region], region->data());
+      histogramDataMapC1[*region] = data.histograms_[*region][data.fitVariables_[*region].name_][key_central_value];
+    } 
+  }
+
   TObjArray nlls;
   if ( doFitABC2D ) {
     RooRealVar* fitVariableABC2D = data.fitVariables_["A"].xAxis_;
@@ -990,9 +1165,14 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 		      "dataABC2D", *fitVariableABC2D, *fitCategoriesABC2D, histogramDataMapABC2D);
     RooLinkedList fitOptionsABC2D;
     fitOptionsABC2D.Add(new RooCmdArg(RooFit::Extended()));
-    std::cout << "#fitConstraintsABC2D = " << fitConstraintsABC2D.GetEntries() << std::endl;
-    if ( fitConstraintsABC2D.GetEntries() > 0 ) 
-      fitOptionsABC2D.Add(new RooCmdArg(RooFit::ExternalConstraints(RooArgSet(fitConstraintsABC2D))));
+    std::cout << "#fitConstraintsABC2D = " << fitConstraintsABC2D.size() << std::endl;
+    TObjArray fitConstraintsABC2D_pdfs;
+    for ( vFitConstraints::const_iterator fitConstraint = fitConstraintsABC2D.begin();
+	  fitConstraint != fitConstraintsABC2D.end(); ++fitConstraint ) {
+      fitConstraintsABC2D_pdfs.Add(makeFitConstraint(fitConstraint->p_, fitConstraint->value_, fitConstraint->error_));
+    }
+    if ( fitConstraintsABC2D_pdfs.GetEntries() > 0 ) 
+      fitOptionsABC2D.Add(new RooCmdArg(RooFit::ExternalConstraints(RooArgSet(fitConstraintsABC2D_pdfs))));
     pdfSimultaneousFitABC2D->printCompactTree();
     RooAbsReal* nllABC2D = pdfSimultaneousFitABC2D->createNLL(*dataABC2D, fitOptionsABC2D); 
     nlls.Add(nllABC2D);
@@ -1004,16 +1184,18 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
 		    "dataC1", *fitVariableC1, *fitCategoriesC1, histogramDataMapC1);
   RooLinkedList fitOptionsC1;
   fitOptionsC1.Add(new RooCmdArg(RooFit::Extended()));
-  std::cout << "#fitConstraintsC1 = " << fitConstraintsC1.GetEntries() << std::endl;
-  if ( fitConstraintsC1.GetEntries() > 0 ) 
-    fitOptionsC1.Add(new RooCmdArg(RooFit::ExternalConstraints(RooArgSet(fitConstraintsC1))));
+  std::cout << "#fitConstraintsC1 = " << fitConstraintsC1.size() << std::endl;
+  TObjArray fitConstraintsC1_pdfs;
+  for ( vFitConstraints::const_iterator fitConstraint = fitConstraintsC1.begin();
+	fitConstraint != fitConstraintsC1.end(); ++fitConstraint ) {
+    fitConstraintsC1_pdfs.Add(makeFitConstraint(fitConstraint->p_, fitConstraint->value_, fitConstraint->error_));
+  }
+  if ( fitConstraintsC1_pdfs.GetEntries() > 0 ) 
+    fitOptionsC1.Add(new RooCmdArg(RooFit::ExternalConstraints(RooArgSet(fitConstraintsC1_pdfs))));
   pdfSimultaneousFitC1->printCompactTree();
   RooAbsReal* nllC1 = pdfSimultaneousFitC1->createNLL(*dataC1, fitOptionsC1); 
   nlls.Add(nllC1);
 
-//--- set tau id. efficiency to "random" value
-  processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_->setVal(0.55);
-
   RooAddition nll("nll", "nll", RooArgSet(nlls));
   RooMinuit minuit(nll); 
   minuit.setErrorLevel(1);
@@ -1021,16 +1203,66 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
   minuit.setPrintEvalErrors(1);
   minuit.setPrintLevel(0);
   //minuit.setWarnLevel(1);
+  // CV: RooMinuit does not support to pass an initial error matrix;
+  //     in case the fit is started from the result of a previous fit,
+  //     only the parameter values and uncertainties (used as initial step-sizes) are taken from the previous fit
   minuit.migrad(); 
-  minuit.hesse(); 
+  if ( options.runHesse_ ) minuit.hesse(); 
+  if ( options.minosParameter_ ) minuit.minos(RooArgSet(*options.minosParameter_));
 
 //--- unpack covariance matrix of fit parameters
   std::string fitResultName = std::string("fitResult").append("_").append(tauId);
   RooFitResult*	fitResult = minuit.save(fitResultName.data(), fitResultName.data());
    
-  effValue = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_->getVal();
-  effError = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_->getError();
-  hasFitConverged = (fitResult->status() == 0) ? true : false;
+  bool hasFitConverged = (fitResult->status() == 0) ? true : false;
+
+  const RooArgList& fitParameter = fitResult->floatParsFinal();
+  
+  int numFitParameter = fitParameter.getSize();
+  
+  vstring fitParameterNames;
+  TMatrixD cov(numFitParameter, numFitParameter);
+  for ( int iParameter = 0; iParameter < numFitParameter; ++iParameter ) {
+    const RooAbsArg* paramI_arg = fitParameter.at(iParameter);
+    const RooRealVar* paramI = dynamic_cast<const RooRealVar*>(paramI_arg);    
+    double sigmaI = paramI->getError();
+    
+    fitParameterNames.push_back(paramI_arg->GetName());
+
+    for ( int jParameter = 0; jParameter < numFitParameter; ++jParameter ) {
+      const RooAbsArg* paramJ_arg = fitParameter.at(jParameter);
+      const RooRealVar* paramJ = dynamic_cast<const RooRealVar*>(paramJ_arg);
+      double sigmaJ = paramJ->getError();
+      
+      double corrIJ = fitResult->correlation(*paramI_arg, *paramJ_arg);
+      
+      cov(iParameter, jParameter) = sigmaI*sigmaJ*corrIJ;
+    }
+  }
+
+  if ( histogramCorrelations ) 
+    (*histogramCorrelations) = makeCorrelationHistogram(std::string("correlations").append("_").append(tauId), fitParameterNames, cov);
+
+  if ( fittedPoint ) {
+    RooArgSet* nllParameters = nll.getVariables();
+    std::vector<RooRealVar*> parameters;
+    for ( int iParameter = 0; iParameter < numFitParameter; ++iParameter ) {
+      parameters.push_back(dynamic_cast<RooRealVar*>(nllParameters->find(fitParameterNames[iParameter].data())));
+    }
+    const RooArgList& constParameter = fitResult->constPars();
+    for ( int iParameter = 0; iParameter < constParameter.getSize(); ++iParameter ) {
+      RooRealVar* parameter = dynamic_cast<RooRealVar*>(nllParameters->find(constParameter.at(iParameter)->GetName()));
+      if ( parameter ) parameters.push_back(parameter);
+    }
+    TMatrixD cov_all(parameters.size(), parameters.size());
+    for ( int iParameter = 0; iParameter < numFitParameter; ++iParameter ) {
+      for ( int jParameter = 0; jParameter < numFitParameter; ++jParameter ) {
+	cov_all(iParameter, jParameter) = cov(iParameter, jParameter);
+      }
+    }
+    saveFitStartingPoint(*fittedPoint, parameters, cov_all, fitResult->minNll());
+    delete nllParameters;
+  }
   
 //--- store fitted/morphed template shapes
   for ( std::map<std::string, processEntryType*>::const_iterator processEntry = processEntries.begin();
@@ -1051,77 +1283,313 @@ void fitUsingRooFit(processEntryType& data, double intLumiData,
     if ( hasFitConverged ) std::cout << " fit converged."          << std::endl; 
     else                   std::cout << " fit failed to converge." << std::endl;
     
-    const RooArgList& fitParameter = fitResult->floatParsFinal();
-    
-    int numFitParameter = fitParameter.getSize();
-    
-    TMatrixD cov(numFitParameter, numFitParameter);
     for ( int iParameter = 0; iParameter < numFitParameter; ++iParameter ) {
-      const RooAbsArg* paramI_arg = fitParameter.at(iParameter);
-      const RooRealVar* paramI = dynamic_cast<const RooRealVar*>(paramI_arg);    
-      double sigmaI = paramI->getError();
-      
-      std::cout << " parameter #" << iParameter << ": " << paramI_arg->GetName() 
-		<< " = " << paramI->getVal() << " +/- " << paramI->getError() << std::endl;
-      
-      for ( int jParameter = 0; jParameter < numFitParameter; ++jParameter ) {
-	const RooAbsArg* paramJ_arg = fitParameter.at(jParameter);
-	const RooRealVar* paramJ = dynamic_cast<const RooRealVar*>(paramJ_arg);
-	double sigmaJ = paramJ->getError();
-	
-	double corrIJ = fitResult->correlation(*paramI_arg, *paramJ_arg);
-	
-	cov(iParameter, jParameter) = sigmaI*sigmaJ*corrIJ;
-      }
+      const RooRealVar* paramI = dynamic_cast<const RooRealVar*>(fitParameter.at(iParameter));    
+      std::cout << " parameter #" << iParameter << ": " << fitParameterNames[iParameter] 
+		<< " = " << paramI->getVal() << " +/- " << paramI->getError();
+      if ( paramI->hasAsymError() ) std::cout << " (MINOS: " << paramI->getAsymErrorLo() << ", +" << paramI->getAsymErrorHi() << ")";
+      std::cout << std::endl;
     }
     
     cov.Print();
     
     std::cout << std::endl;
 
-    std::cout << "Results of fitting variable = " << fitVariableC1->GetName() << " for Tau id. = " << tauId << std::endl;
-    for ( std::map<std::string, processEntryType*>::const_iterator processEntry = processEntries.begin();
-	  processEntry != processEntries.end(); ++processEntry ) {
-      std::cout << " " << processEntry->second->name_ << ":" << std::endl;
-      std::cout << "  normalization = " << processEntry->second->norm_.fittedValue_->getVal()
-		<< " +/- " << processEntry->second->norm_.fittedValue_->getError()
-		<< " (MC exp. = " << processEntry->second->norm_.expectedValue_ << ")" << std::endl;
-
-      for ( std::map<std::string, fitParameterType>::const_iterator fitParameter = processEntry->second->fitParameters_.begin();
-	    fitParameter != processEntry->second->fitParameters_.end(); ++fitParameter ) {
-	std::cout << "  " << fitParameter->first << " = " << fitParameter->second.fittedValue_->getVal()
-		  << " +/- " << fitParameter->second.fittedValue_->getError()
-		  << " (MC exp. = " << fitParameter->second.expectedValue_ << ")" << std::endl;
-      }
+    printFitResult(data, processEntries, tauId);
+  }
 
-      if ( processEntry->second->alphaParameters_.begin() != processEntry->second->alphaParameters_.end() ) {
-	std::cout << "  nuissance parameters:" << std::endl;
-	for ( vstring::const_iterator sysUncertainty = processEntry->second->sysUncertainties_.begin();
-	      sysUncertainty != processEntry->second->sysUncertainties_.end(); ++sysUncertainty ) {
-	  alphaParameterType& alphaParameter = processEntry->second->alphaParameters_[*sysUncertainty];
-	  std::cout << "   " << (*sysUncertainty) << " = " << alphaParameter.alpha_->getVal() 
-		    << " +/- " << alphaParameter.alpha_->getError() << std::endl;
-	}
-      }
+  return hasFitConverged;
+}
 
-      for ( vstring::const_iterator region = data.regionsToFit_.begin();
-	    region != data.regionsToFit_.end(); ++region ) {
-	std::cout << "  region " << (*region) << " = " 
-		  << processEntry->second->normFactors_[*region]->getVal()/
-   	            (processEntry->second->fittedFractions_[*region][data.fitVariables_[*region].name_]->getVal()*processEntry->second->numCategories_[*region])
-		  << " (MC exp. = " << processEntry->second->numEvents_[*region][key_central_value] << ","
-		  << " fitted fraction = " << processEntry->second->fittedFractions_[*region][data.fitVariables_[*region].name_]->getVal() << ")" << std::endl;
-      }
-    }
-    std::cout << " Data:" << std::endl;
-    std::cout << "  events = " << data.numEvents_["ABCD"][key_central_value] 
-	      << " +/- " << TMath::Sqrt(data.numEvents_["ABCD"][key_central_value]) << std::endl;
-    for ( vstring::const_iterator region = data.regionsToFit_.begin();
-	  region != data.regionsToFit_.end(); ++region ) {
-      std::cout << "  region " << (*region) << " = " << data.numEvents_[*region][key_central_value] 
-		<< " +/- " << TMath::Sqrt(data.numEvents_[*region][key_central_value]) << std::endl;
-    }
+unsigned addFitParameter(TauIdEffBinnedLikelihood& nll, std::map<RooRealVar*, unsigned>& idxParameters, RooRealVar* p)
+{
+//-------------------------------------------------------------------------------
+// Define RooRealVar as fit parameter of native likelihood,
+// in case it has not been defined yet (RooRealVars may be shared between regions and constraints)
+//
+// NOTE: auxiliary function for fitUsingNativeLikelihood
+//
+//-------------------------------------------------------------------------------
+
+  std::map<RooRealVar*, unsigned>::const_iterator idxParameter = idxParameters.find(p);
+  if ( idxParameter != idxParameters.end() ) return idxParameter->second;
+  unsigned retVal = nll.addParameter(p->GetName(), p->getVal(), p->getMin(), p->getMax(), p->isConstant());
+  if ( p->getError() > 0. ) nll.setParameterError(retVal, p->getError());
+  idxParameters[p] = retVal;
+  return retVal;
+}
+
+double getFittedFraction(RooAbsReal* fittedFraction, 
+			 std::map<std::string, alphaParameterType>& alphaParameters, const std::string& sysUncertainty_shifted, double alpha_shifted)
+{
+//-------------------------------------------------------------------------------
+// Evaluate fitted fraction for all alpha-parameters set to zero,
+// except for the one given as function argument
+//
+// NOTE: auxiliary function for fitUsingNativeLikelihood
+//
+//-------------------------------------------------------------------------------
+
+  std::map<std::string, double> alphaValues; // key = systematic uncertainty
+  for ( std::map<std::string, alphaParameterType>::iterator alphaParameter = alphaParameters.begin();
+	alphaParameter != alphaParameters.end(); ++alphaParameter ) {
+    if ( !alphaParameter->second.alpha_ ) continue;
+    alphaValues[alphaParameter->first] = alphaParameter->second.alpha_->getVal();
+    alphaParameter->second.alpha_->setVal(( alphaParameter->first == sysUncertainty_shifted ) ? alpha_shifted : 0.);
+  }
+  double retVal = fittedFraction->getVal();
+  for ( std::map<std::string, double>::const_iterator alphaValue = alphaValues.begin();
+	alphaValue != alphaValues.end(); ++alphaValue ) {
+    alphaParameters[alphaValue->first].alpha_->setVal(alphaValue->second);
+  }
+  return retVal;
+}
+
+bool fitUsingNativeLikelihood(processEntryType& data, 
+			      std::map<std::string, processEntryType*>& processEntries, // key = process name
+			      const vFitConstraints& fitConstraintsABC2D, const vFitConstraints& fitConstraintsC1,
+			      const std::string& tauId, int verbosity = 0, const fitOptionsType& options = fitOptionsType(), 
+			      TH2D** histogramCorrelations = 0, fitStartingPointType* fittedPoint = 0)
+{
+//-------------------------------------------------------------------------------
+// Perform the same fit as fitUsingRooFit,
+// using the binned likelihood implemented in TauIdEffBinnedLikelihood
+// (flat arrays of bin-contents and analytic derivatives) instead of RooFit
+//
+//-------------------------------------------------------------------------------
+
+  if ( verbosity ) {
+    std::cout << "<fitUsingNativeLikelihood>:" << std::endl;
+    std::cout << " performing Fit of variable = " << data.fitVariables_[data.region_passed_].name_ 
+	      << " for Tau id. = " << tauId << std::endl;
+  }
+
+  TauIdEffBinnedLikelihood nll;
+  std::map<RooRealVar*, unsigned> idxParameters;
+  std::map<std::string, std::map<std::string, unsigned> > idxComponents; // key = (process, region)
+
+  for ( vstring::const_iterator region = data.regionsToFit_.begin();
+	region != data.regionsToFit_.end(); ++region ) {
+    unsigned idxChannel = nll.addChannel(*region, data.histograms_[*region][data.fitVariables_[*region].name_][key_central_value]);
+
+    for ( std::map<std::string, processEntryType*>::const_iterator processEntry = processEntries.begin();
+	  processEntry != processEntries.end(); ++processEntry ) {
+      if ( processEntry->first == "mcSum" ) continue;
+      processEntryType* process = processEntry->second;
+
+      if ( process->templateMorphingMode_ == kHorizontalTemplateMorphing )
+	throw cms::Exception("fitUsingNativeLikelihood") 
+	  << "Horizontal template morphing not supported by native likelihood fit, use fitBackend = 'RooFit' !!\n";
+
+      const std::string& fitVariableName = process->fitVariables_[*region].name_;
+      histogramMap1& histograms = process->histograms_[*region][fitVariableName];
+      RooAbsReal* fittedFraction = process->fittedFractions_[*region][fitVariableName];
+      unsigned idxComponent = 
+	nll.addComponent(idxChannel, histograms[key_central_value], process->numCategories_[*region], 
+			 getFittedFraction(fittedFraction, process->alphaParameters_, "", 0.));
+      idxComponents[processEntry->first][*region] = idxComponent;
+
+//--- factors entering expected event yield
+//   (same as in makeRooFormulaVar_6regions/makeRooFormulaVar_2regions)
+      std::map<std::string, fitParameterType>& fitParameters = process->fitParameters_;
+      if ( fitParameters.find("pDiTauCharge_OS_SS") != fitParameters.end() ) {
+	std::string exprDiTauCharge, exprDiTauKine, exprMuonIso, exprTauId;
+	getYieldFactorExpressions_6regions(*region, exprDiTauCharge, exprDiTauKine, exprMuonIso, exprTauId);
+	if ( exprDiTauCharge != "" ) 
+	  nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, fitParameters["pDiTauCharge_OS_SS"].fittedValue_), exprDiTauCharge == "inverted");
+	if ( exprDiTauKine != "" ) 
+	  nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, fitParameters["pDiTauKine_Sig_Bgr"].fittedValue_), exprDiTauKine == "inverted");
+	if ( exprMuonIso != "" ) 
+	  nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, fitParameters["pMuonIso_tight_loose"].fittedValue_), exprMuonIso == "inverted");
+	if ( exprTauId != "" ) 
+	  nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, fitParameters["pTauId_passed_failed"].fittedValue_), exprTauId == "inverted");
+      } else {
+	if      ( (*region) == data.region_passed_ ) 
+	  nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, fitParameters["pTauId_passed_failed"].fittedValue_), false);
+	else if ( (*region) == data.region_failed_ ) 
+	  nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, fitParameters["pTauId_passed_failed"].fittedValue_), true);
+	else throw cms::Exception("fitUsingNativeLikelihood") 
+	  << "Region = " << (*region) << " matches neither 'passed' nor 'failed' region !!\n";
+      }
+      nll.addYieldFactor(idxComponent, addFitParameter(nll, idxParameters, process->norm_.fittedValue_));
+
+//--- vertical template morphing
+//   (same as in makePdfVerticalMorphing)
+      if ( process->templateMorphingMode_ == kVerticalTemplateMorphing ) {
+	for ( vstring::const_iterator sysUncertainty = process->sysUncertainties_.begin();
+	      sysUncertainty != process->sysUncertainties_.end(); ++sysUncertainty ) {
+	  RooRealVar* alpha = process->alphaParameters_[*sysUncertainty].alpha_;
+	  nll.addMorphing(idxComponent, addFitParameter(nll, idxParameters, alpha), 
+			  histograms[std::string(*sysUncertainty).append("Up")], histograms[std::string(*sysUncertainty).append("Down")], 
+			  getFittedFraction(fittedFraction, process->alphaParameters_, *sysUncertainty, +1.), 
+			  getFittedFraction(fittedFraction, process->alphaParameters_, *sysUncertainty, -1.));
+	}
+      }
+    }
+  }
+
+  const vFitConstraints* fitConstraints[] = { &fitConstraintsABC2D, &fitConstraintsC1 };
+  for ( unsigned iFitConstraints = 0; iFitConstraints < 2; ++iFitConstraints ) {
+    for ( vFitConstraints::const_iterator fitConstraint = fitConstraints[iFitConstraints]->begin();
+	  fitConstraint != fitConstraints[iFitConstraints]->end(); ++fitConstraint ) {
+      nll.addGaussianConstraint(addFitParameter(nll, idxParameters, fitConstraint->p_), fitConstraint->value_, fitConstraint->error_);
+    }
+  }
+
+  RooRealVar* minosParameter = options.minosParameter_;
+  if ( minosParameter ) nll.setRunMinos(addFitParameter(nll, idxParameters, minosParameter));
+
+//--- take initial error matrix from result of previous fit
+  if ( options.startingPoint_ ) {
+    const fitStartingPointType& startingPoint = (*options.startingPoint_);
+    unsigned numParameters = startingPoint.parameters_.size();
+    for ( unsigned iParameter = 0; iParameter < numParameters; ++iParameter ) {
+      std::map<RooRealVar*, unsigned>::const_iterator idxParameterI = idxParameters.find(startingPoint.parameters_[iParameter]);
+      if ( idxParameterI == idxParameters.end() ) continue;
+      for ( unsigned jParameter = 0; jParameter <= iParameter; ++jParameter ) {
+	std::map<RooRealVar*, unsigned>::const_iterator idxParameterJ = idxParameters.find(startingPoint.parameters_[jParameter]);
+	if ( idxParameterJ == idxParameters.end() ) continue;
+	nll.setInitialCovariance(idxParameterI->second, idxParameterJ->second, startingPoint.covariance_[iParameter*numParameters + jParameter]);
+      }
+    }
+  }
+
+//--- use same Minuit settings as fitUsingRooFit
+  nll.setErrorLevel(1.);
+  nll.setStrategy(1);
+  nll.setTolerance(1.);
+  nll.setPrintLevel(( verbosity ) ? 0 : -1);
+  nll.setRunHesse(options.runHesse_);
+  bool hasFitConverged = nll.fit();
+
+  for ( std::map<RooRealVar*, unsigned>::const_iterator idxParameter = idxParameters.begin();
+	idxParameter != idxParameters.end(); ++idxParameter ) {
+    idxParameter->first->setVal(nll.getValue(idxParameter->second));
+    if ( !nll.isConstant(idxParameter->second) ) idxParameter->first->setError(nll.getError(idxParameter->second));
+    if ( idxParameter->first == minosParameter ) 
+      idxParameter->first->setAsymError(nll.getErrorLow(idxParameter->second), nll.getErrorHigh(idxParameter->second));
+    else 
+      idxParameter->first->removeAsymError();
+  }
+
+  std::vector<unsigned> idxFitParameters;
+  vstring fitParameterNames;
+  for ( unsigned idxParameter = 0; idxParameter < nll.getNumParameters(); ++idxParameter ) {
+    if ( !nll.isConstant(idxParameter) ) {
+      idxFitParameters.push_back(idxParameter);
+      fitParameterNames.push_back(nll.getParameterName(idxParameter));
+    }
+  }
+
+  int numFitParameter = idxFitParameters.size();
+
+  TMatrixD cov(numFitParameter, numFitParameter);
+  for ( int iParameter = 0; iParameter < numFitParameter; ++iParameter ) {
+    for ( int jParameter = 0; jParameter < numFitParameter; ++jParameter ) {
+      cov(iParameter, jParameter) = nll.getCovariance(idxFitParameters[iParameter], idxFitParameters[jParameter]);
+    }
+  }
+
+  if ( histogramCorrelations ) 
+    (*histogramCorrelations) = makeCorrelationHistogram(std::string("correlations").append("_").append(tauId), fitParameterNames, cov);
+
+  if ( fittedPoint ) {
+    std::vector<RooRealVar*> parameters(nll.getNumParameters());
+    for ( std::map<RooRealVar*, unsigned>::const_iterator idxParameter = idxParameters.begin();
+	  idxParameter != idxParameters.end(); ++idxParameter ) {
+      parameters[idxParameter->second] = idxParameter->first;
+    }
+    TMatrixD cov_all(parameters.size(), parameters.size());
+    for ( unsigned iParameter = 0; iParameter < parameters.size(); ++iParameter ) {
+      for ( unsigned jParameter = 0; jParameter < parameters.size(); ++jParameter ) {
+	cov_all(iParameter, jParameter) = nll.getCovariance(iParameter, jParameter);
+      }
+    }
+    saveFitStartingPoint(*fittedPoint, parameters, cov_all, nll.getMinimum());
   }
+
+//--- store fitted/morphed template shapes
+  for ( std::map<std::string, std::map<std::string, unsigned> >::const_iterator processEntry = idxComponents.begin();
+	processEntry != idxComponents.end(); ++processEntry ) {
+    processEntryType* process = processEntries[processEntry->first];
+    for ( std::map<std::string, unsigned>::const_iterator region = processEntry->second.begin();
+	  region != processEntry->second.end(); ++region ) {
+      const std::string& fitVariableName = data.fitVariables_[region->first].name_;
+      TH1* histogram_central_value = process->histograms_[region->first][fitVariableName][key_central_value];
+      std::string histogramName_fitted = std::string(histogram_central_value->GetName()).append("_fittedShape");
+      TH1* histogram_fitted = (TH1*)histogram_central_value->Clone(histogramName_fitted.data());
+      histogram_fitted->Reset();
+      std::vector<double> templateShape = nll.getTemplateShape(region->second);
+      for ( unsigned iBin = 0; iBin < templateShape.size(); ++iBin ) {
+	histogram_fitted->SetBinContent(iBin + 1, templateShape[iBin]);
+      }
+      process->fittedTemplateShapes_[region->first][fitVariableName] = histogram_fitted;
+    }
+  }
+
+  if ( verbosity ) {
+    std::cout << tauId << ":";
+    if ( hasFitConverged ) std::cout << " fit converged."          << std::endl; 
+    else                   std::cout << " fit failed to converge." << std::endl;
+    
+    for ( int iParameter = 0; iParameter < numFitParameter; ++iParameter ) {
+      unsigned idxParameterI = idxFitParameters[iParameter];
+      std::cout << " parameter #" << iParameter << ": " << fitParameterNames[iParameter] 
+		<< " = " << nll.getValue(idxParameterI) << " +/- " << nll.getError(idxParameterI);
+      if ( minosParameter && fitParameterNames[iParameter] == minosParameter->GetName() ) 
+	std::cout << " (MINOS: " << nll.getErrorLow(idxParameterI) << ", +" << nll.getErrorHigh(idxParameterI) << ")";
+      std::cout << std::endl;
+    }
+    
+    cov.Print();
+    
+    std::cout << std::endl;
+
+    printFitResult(data, processEntries, tauId);
+  }
+
+  return hasFitConverged;
+}
+
+enum { kFitBackendRooFit, kFitBackendNative };
+
+void runFit(processEntryType& data, 
+	    std::map<std::string, processEntryType*>& processEntries, // key = process name
+	    double sysVariedByNsigma, const std::string& processName_signal, int fitBackend,
+	    const std::string& tauId, double& effValue, double& effError, bool& hasFitConverged,
+	    int verbosity = 0, const fitOptionsType& options = fitOptionsType(), 
+	    TH2D** histogramCorrelations = 0, fitStartingPointType* fittedPoint = 0)
+{
+  vFitConstraints fitConstraintsABC2D;
+  vFitConstraints fitConstraintsC1;
+  setFitConstraints(data, processEntries, sysVariedByNsigma, fitConstraintsABC2D, fitConstraintsC1);
+
+  RooRealVar* pTauId_signal = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_;
+  if ( options.startingPoint_ ) {
+//--- start from result of previous fit
+    applyFitStartingPoint(*options.startingPoint_);
+  } else {
+//--- set tau id. efficiency to "random" value
+    pTauId_signal->setVal(0.55);
+  }
+
+  if ( options.fixedParameter_ ) {
+    options.fixedParameter_->setVal(options.fixedParameterValue_);
+    options.fixedParameter_->setConstant(true);
+  }
+
+  if      ( fitBackend == kFitBackendRooFit ) 
+    hasFitConverged = fitUsingRooFit(data, processEntries, fitConstraintsABC2D, fitConstraintsC1, tauId, verbosity, 
+				     options, histogramCorrelations, fittedPoint);
+  else if ( fitBackend == kFitBackendNative ) 
+    hasFitConverged = fitUsingNativeLikelihood(data, processEntries, fitConstraintsABC2D, fitConstraintsC1, tauId, verbosity, 
+					       options, histogramCorrelations, fittedPoint);
+  else assert(0);
+
+  if ( options.fixedParameter_ ) options.fixedParameter_->setConstant(false);
+
+  effValue = pTauId_signal->getVal();
+  effError = pTauId_signal->getError();
 }
 
 //
@@ -1165,6 +1633,285 @@ histogramMap3 sumHistograms(histogramMap4& histograms,
 //-------------------------------------------------------------------------------
 //
 
+void resetFitParameters(std::map<std::string, processEntryType*>& processEntries) // key = process name
+{
+//--- set all fit parameters to the values expected from Monte Carlo
+  for ( std::map<std::string, processEntryType*>::iterator processEntry = processEntries.begin();
+	processEntry != processEntries.end(); ++processEntry ) {
+    processEntry->second->norm_.fittedValue_->setVal(processEntry->second->norm_.expectedValue_);
+    for ( std::map<std::string, fitParameterType>::iterator fitParameter = processEntry->second->fitParameters_.begin();
+	  fitParameter != processEntry->second->fitParameters_.end(); ++fitParameter ) {
+      fitParameter->second.fittedValue_->setVal(fitParameter->second.expectedValue_);
+    }
+    for ( std::map<std::string, alphaParameterType>::iterator alphaParameter = processEntry->second->alphaParameters_.begin();
+	  alphaParameter != processEntry->second->alphaParameters_.end(); ++alphaParameter ) {
+      if ( alphaParameter->second.alpha_ ) alphaParameter->second.alpha_->setVal(( alphaParameter->second.isBiDirectional_ ) ? 0. : 0.5);
+    }
+  }
+}
+
+histogramMap3 makeAsimovHistograms(std::map<std::string, processEntryType*>& processEntries, // key = process name
+				   const vstring& processes, const vstring& regions, const vstring& observables)
+{
+//-------------------------------------------------------------------------------
+// Build "Asimov" dataset: sum of template histograms of all processes, 
+// each normalized to the event yield expected for the current values of the fit parameters
+// (no statistical fluctuations)
+//
+// NOTE: the event yields refer to the fit range (underflow and overflow bins excluded)
+//
+//-------------------------------------------------------------------------------
+
+  histogramMap3 retVal; // key = (region, observable, key_central_value)
+  for ( vstring::const_iterator process = processes.begin();
+	process != processes.end(); ++process ) {
+    processEntryType* processEntry = processEntries[*process];
+    for ( vstring::const_iterator region = regions.begin();
+	  region != regions.end(); ++region ) {
+      double norm = processEntry->normFactors_[*region]->getVal()/processEntry->numCategories_[*region];
+      for ( vstring::const_iterator observable = observables.begin();
+	    observable != observables.end(); ++observable ) {
+	TH1* histogram = processEntry->histograms_[*region][*observable][key_central_value];
+	if ( !histogram ) 
+	  throw cms::Exception("makeAsimovHistograms") 
+	    << "No template histogram for process = " << (*process) << ", region = " << (*region) << ", observable = " << (*observable) << " !!\n";
+	double integral = getIntegral(histogram, false, false);
+	double scaleFactor = ( integral > 0. ) ? norm/integral : 0.;
+
+	TH1* histogramSum = retVal[*region][*observable][key_central_value];
+	if ( !histogramSum ) {
+	  std::string histogramSumName = std::string("Asimov").append("_").append(*region).append("_").append(*observable);
+	  histogramSum = (TH1*)histogram->Clone(histogramSumName.data());
+	  histogramSum->Reset();
+	  if ( !histogramSum->GetSumw2N() ) histogramSum->Sumw2();
+	  retVal[*region][*observable][key_central_value] = histogramSum;
+	}
+	histogramSum->Add(histogram, scaleFactor);
+      }
+    }
+  }
+  return retVal;
+}
+
+//
+//-------------------------------------------------------------------------------
+//
+
+struct profileLikelihoodScanPointType
+{
+  double x_;             // value of tau id. efficiency
+  double minNll_;        // minimum of negative log-likelihood function w.r.t. all other fit parameters
+  bool hasFitConverged_;
+};
+
+void scanProfileLikelihood(processEntryType& data,
+			   std::map<std::string, processEntryType*>& processEntries, // key = process name
+			   double sysVariedByNsigma, const std::string& processName_signal, int fitBackend,
+			   const std::string& tauId, const fitStartingPointType& fittedPoint_nominal,
+			   std::vector<profileLikelihoodScanPointType>& scanPoints, unsigned idxFirst, unsigned idxLast)
+{
+//-------------------------------------------------------------------------------
+// Minimize negative log-likelihood w.r.t. all fit parameters except the tau id. efficiency,
+// which is kept constant at the values of scan points idxFirst..idxLast - 1.
+//
+// NOTE: the scan starts at the point closest to the minimum of the nominal fit
+//       and proceeds towards both ends of the range,
+//       each fit being started from the result of the fit for the neighbouring scan point
+//
+//-------------------------------------------------------------------------------
+
+  RooRealVar* pTauId_signal = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_;
+  double effValue_nominal = pTauId_signal->getVal();
+  for ( unsigned iParameter = 0; iParameter < fittedPoint_nominal.parameters_.size(); ++iParameter ) {
+    if ( fittedPoint_nominal.parameters_[iParameter] == pTauId_signal ) effValue_nominal = fittedPoint_nominal.values_[iParameter];
+  }
+
+  unsigned idxStart = idxFirst;
+  for ( unsigned idxPoint = idxFirst; idxPoint < idxLast; ++idxPoint ) {
+    if ( TMath::Abs(scanPoints[idxPoint].x_ - effValue_nominal) < TMath::Abs(scanPoints[idxStart].x_ - effValue_nominal) ) idxStart = idxPoint;
+  }
+
+  fitOptionsType fitOptions;
+  fitOptions.runHesse_ = false;
+  fitOptions.fixedParameter_ = pTauId_signal;
+
+  fitStartingPointType fittedPoint_start;
+  for ( int direction = +1; direction >= -1; direction -= 2 ) {
+    const fitStartingPointType* startingPoint = ( direction > 0 ) ? &fittedPoint_nominal : &fittedPoint_start;
+    fitStartingPointType fittedPoint_previous;
+    for ( int idxPoint = ( direction > 0 ) ? idxStart : (int)idxStart - 1;
+	  idxPoint >= (int)idxFirst && idxPoint < (int)idxLast; idxPoint += direction ) {
+      fitOptions.startingPoint_ = startingPoint;
+      fitOptions.fixedParameterValue_ = scanPoints[idxPoint].x_;
+
+      double effValue_i = 0.;
+      double effError_i = 1.;
+      bool hasFitConverged_i = false;
+      fitStartingPointType fittedPoint_i;
+      runFit(data, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+	     tauId, effValue_i, effError_i, hasFitConverged_i, 0, fitOptions, 0, &fittedPoint_i);
+
+      scanPoints[idxPoint].minNll_ = fittedPoint_i.minNll_;
+      scanPoints[idxPoint].hasFitConverged_ = hasFitConverged_i;
+
+      fittedPoint_previous = fittedPoint_i;
+      startingPoint = &fittedPoint_previous;
+      if ( idxPoint == (int)idxStart ) fittedPoint_start = fittedPoint_i;
+    }
+  }
+}
+
+TGraph* compProfileLikelihood(processEntryType& data,
+			      std::map<std::string, processEntryType*>& processEntries, // key = process name
+			      double sysVariedByNsigma, const std::string& processName_signal, int fitBackend,
+			      const std::string& tauId, const fitStartingPointType& fittedPoint_nominal,
+			      double effValue, double effError, unsigned numPoints, double numSigma, unsigned numWorkers,
+			      const std::string& graphName)
+{
+//-------------------------------------------------------------------------------
+// Compute profile-likelihood of tau id. efficiency
+// in range effValue -/+ numSigma*effError (restricted to the allowed range of the fit parameter)
+//
+// NOTE: in case numWorkers > 1, the scan points are divided into contiguous segments,
+//       which are scanned by forked worker processes and passed back to the main process via pipes.
+//
+//-------------------------------------------------------------------------------
+
+  if ( numPoints < 2 )
+    throw cms::Exception("compProfileLikelihood")
+      << "Number of scan points = " << numPoints << " must be at least 2 !!\n";
+
+  RooRealVar* pTauId_signal = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_;
+  double xMin = TMath::Max(effValue - numSigma*effError, pTauId_signal->getMin());
+  double xMax = TMath::Min(effValue + numSigma*effError, pTauId_signal->getMax());
+
+  std::vector<profileLikelihoodScanPointType> scanPoints(numPoints);
+  for ( unsigned idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    scanPoints[idxPoint].x_ = xMin + idxPoint*(xMax - xMin)/(numPoints - 1);
+    scanPoints[idxPoint].minNll_ = 0.;
+    scanPoints[idxPoint].hasFitConverged_ = false;
+  }
+
+  if ( numWorkers > numPoints ) numWorkers = numPoints;
+  if ( numWorkers <= 1 ) {
+    scanProfileLikelihood(data, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+			  tauId, fittedPoint_nominal, scanPoints, 0, numPoints);
+  } else {
+    std::vector<pid_t> pids;
+    std::vector<int> pipes;
+    for ( unsigned iWorker = 0; iWorker < numWorkers; ++iWorker ) {
+      unsigned idxFirst = (iWorker*numPoints)/numWorkers;
+      unsigned idxLast = ((iWorker + 1)*numPoints)/numWorkers;
+
+      int fd[2];
+      if ( pipe(fd) != 0 )
+	throw cms::Exception("compProfileLikelihood")
+	  << "Failed to create pipe, errno = " << errno << " !!\n";
+
+//--- CV: flush output buffers before forking,
+//        to avoid output of main process getting printed again by worker process
+      std::cout.flush();
+      std::cerr.flush();
+      fflush(0);
+
+      pid_t pid = fork();
+      if ( pid < 0 ) {
+	throw cms::Exception("compProfileLikelihood")
+	  << "Failed to start worker process for scan points " << idxFirst << ".." << (idxLast - 1) << " !!\n";
+      } else if ( pid == 0 ) {
+	close(fd[0]);
+	int exitStatus = 0;
+	try {
+	  scanProfileLikelihood(data, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+				tauId, fittedPoint_nominal, scanPoints, idxFirst, idxLast);
+	  const char* buffer = reinterpret_cast<const char*>(&scanPoints[idxFirst]);
+	  size_t numBytes = (idxLast - idxFirst)*sizeof(profileLikelihoodScanPointType);
+	  while ( numBytes > 0 ) {
+	    ssize_t numBytesWritten = write(fd[1], buffer, numBytes);
+	    if ( numBytesWritten < 0 ) {
+	      if ( errno == EINTR ) continue;
+	      exitStatus = 1;
+	      break;
+	    }
+	    buffer += numBytesWritten;
+	    numBytes -= numBytesWritten;
+	  }
+	} catch ( cms::Exception& e ) {
+	  std::cerr << e.what() << std::endl;
+	  exitStatus = 1;
+	} catch ( std::exception& e ) {
+	  std::cerr << e.what() << std::endl;
+	  exitStatus = 1;
+	}
+	close(fd[1]);
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(0);
+//--- CV: use _exit, in order not to run destructors of objects owned by main process
+	_exit(exitStatus);
+      }
+      close(fd[1]);
+      pids.push_back(pid);
+      pipes.push_back(fd[0]);
+    }
+
+    bool hasFailed = false;
+    for ( unsigned iWorker = 0; iWorker < numWorkers; ++iWorker ) {
+      unsigned idxFirst = (iWorker*numPoints)/numWorkers;
+      unsigned idxLast = ((iWorker + 1)*numPoints)/numWorkers;
+      char* buffer = reinterpret_cast<char*>(&scanPoints[idxFirst]);
+      size_t numBytes = (idxLast - idxFirst)*sizeof(profileLikelihoodScanPointType);
+      while ( numBytes > 0 ) {
+	ssize_t numBytesRead = read(pipes[iWorker], buffer, numBytes);
+	if ( numBytesRead < 0 && errno == EINTR ) continue;
+	if ( numBytesRead <= 0 ) break;
+	buffer += numBytesRead;
+	numBytes -= numBytesRead;
+      }
+      close(pipes[iWorker]);
+      int status = 0;
+      while ( waitpid(pids[iWorker], &status, 0) < 0 && errno == EINTR );
+      if ( numBytes > 0 || !(WIFEXITED(status) && WEXITSTATUS(status) == 0) ) {
+	std::cerr << "Worker process for scan points " << idxFirst << ".." << (idxLast - 1) << " failed (status = " << status << ") !!" << std::endl;
+	hasFailed = true;
+      }
+    }
+    if ( hasFailed )
+      throw cms::Exception("compProfileLikelihood")
+	<< "Profile-likelihood scan failed for tauId = " << tauId << " !!\n";
+  }
+
+//--- compute -2 ln(L/L_max), taking the maximum of the likelihood from nominal fit and all scan points
+  double minNll = fittedPoint_nominal.minNll_;
+  for ( unsigned idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    if ( scanPoints[idxPoint].hasFitConverged_ && scanPoints[idxPoint].minNll_ < minNll ) minNll = scanPoints[idxPoint].minNll_;
+  }
+
+  TGraph* graph = new TGraph();
+  graph->SetName(graphName.data());
+  graph->SetTitle(Form("Profile-likelihood of %s Efficiency", tauId.data()));
+  unsigned numFailedFits = 0;
+  for ( unsigned idxPoint = 0; idxPoint < numPoints; ++idxPoint ) {
+    if ( !scanPoints[idxPoint].hasFitConverged_ ) {
+      std::cout << "Warning in <compProfileLikelihood>:"
+		<< " fit failed to converge for tau id. efficiency = " << scanPoints[idxPoint].x_ << " --> skipping !!" << std::endl;
+      ++numFailedFits;
+      continue;
+    }
+    graph->SetPoint(graph->GetN(), scanPoints[idxPoint].x_, 2.*(scanPoints[idxPoint].minNll_ - minNll));
+  }
+  std::cout << "profile-likelihood scan: " << (numPoints - numFailedFits) << " out of " << numPoints << " fits converged." << std::endl;
+
+//--- restore fit parameters to result of nominal fit
+  applyFitStartingPoint(fittedPoint_nominal);
+
+  return graph;
+}
+
+//
+//-------------------------------------------------------------------------------
+//
+
 void drawHistograms(const std::string& region, const std::string& observable, 
 		    processEntryType& data, double intLumiData, 
 		    std::map<std::string, processEntryType*>& processEntries, // key = processEntry.name
@@ -1172,7 +1919,7 @@ void drawHistograms(const std::string& region, const std::string& observable,
 		    bool normalizeTemplatesToFit, // false: normalize to MC expectation
 		                                  // true:  normalize according to scale-factors determined by fit
 		    const std::string& histogramTitle, const std::string& xAxisTitle, 
-		    const std::string& outputFileName, 
+		    const std::string& outputFileName, TauIdEffPlotQueue& plotQueue,
 		    bool runStatTest = false)
 {
 //--------------------------------------------------------------------------------
@@ -1181,6 +1928,9 @@ void drawHistograms(const std::string& region, const std::string& observable,
 // normalize all MC distributions accordingly;
 // else assume MC distributions passed as function arguments
 // are already properly normalized (by cross-section)
+//
+// NOTE: the plots are rendered by the plot queue given as function argument,
+//       possibly in the background
 //--------------------------------------------------------------------------------
 
   //std::cout << "<drawHistograms>:" << std::endl;
@@ -1259,12 +2009,7 @@ void drawHistograms(const std::string& region, const std::string& observable,
 
   canvas->Update();
 
-  size_t idx = outputFileName.find_last_of('.');
-  std::string outputFileName_plot = std::string(outputFileName, 0, idx);
-  if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
-  canvas->Print(std::string(outputFileName_plot).append(".eps").data());
-  canvas->Print(std::string(outputFileName_plot).append(".png").data());
-  canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+  plotQueue.addPlot(canvas, TauIdEffPlotQueue::getOutputFileNames(outputFileName, ".eps .png .pdf"));
 
   if ( runStatTest ) {
     std::cout << "<runStatTest>:" << std::endl;
@@ -1292,140 +2037,75 @@ void drawHistograms(const std::string& region, const std::string& observable,
 //-------------------------------------------------------------------------------
 //
 
-void compSysHistograms(histogramMap4& histograms, const std::string& sysUncertainty)
+void compSysHistograms(TauIdEffTemplateStore<TH1*>& histograms, const std::string& sysUncertainty)
 {
-  for ( histogramMap4::iterator process = histograms.begin();
-	process != histograms.end(); ++process ) {
-    for ( histogramMap3::iterator region = process->second.begin();
-	  region != process->second.end(); ++region ) {
-      for ( histogramMap2::iterator observable = region->second.begin();
-	    observable != region->second.end(); ++observable ) {
-	for ( histogramMap1::iterator sysUncertainty = observable->second.begin();
-	      sysUncertainty != observable->second.end(); ++sysUncertainty ) {
-	  std::string key_up = std::string(sysUncertainty->first).append("Up");
-	  TH1* histogram_up = observable->second[key_up];
-	  assert(histogram_up);
-	  if ( !histogram_up->GetSumw2N() ) histogram_up->Sumw2();
-
-	  std::string key_down = std::string(sysUncertainty->first).append("Down");
-	  TH1* histogram_down = observable->second[key_down];
-	  assert(histogram_down);
-	  if ( !histogram_down->GetSumw2N() ) histogram_down->Sumw2();
-
-	  assert(isCompatibleBinning(histogram_up, histogram_down));
-  
-	  std::string histogramName_diff = std::string(histogram_up->GetName()).append("_diff");
-	  TH1* histogram_diff = (TH1*)histogram_up->Clone(histogramName_diff.data());
-	  
-	  unsigned numBins = histogram_up->GetNbinsX();
-	  for ( unsigned iBin = 0; iBin <= (numBins + 1); ++iBin ) {
-	    double binContent_diff = 0.5*(histogram_up->GetBinContent(iBin) - histogram_down->GetBinContent(iBin));
-	    histogram_diff->SetBinContent(iBin, binContent_diff);
-	    
-	    double binError_up   = histogram_up->GetBinError(iBin);
-	    double binError_down = histogram_down->GetBinError(iBin);
-	    double binError_diff = TMath::Sqrt(binError_up*binError_up + binError_down*binError_down);
-	    histogram_diff->SetBinError(iBin, binError_diff);
-	  }
-	  
-	  std::string key_diff =  std::string(sysUncertainty->first).append("Diff");
-	  observable->second[key_diff] = histogram_diff;
+  typedef TauIdEffTemplateStore<TH1*> templateStoreType;
+  unsigned idxSysShift_up   = histograms.intern(templateStoreType::kSysShift, std::string(sysUncertainty).append("Up"));
+  unsigned idxSysShift_down = histograms.intern(templateStoreType::kSysShift, std::string(sysUncertainty).append("Down"));
+  unsigned idxSysShift_diff = histograms.intern(templateStoreType::kSysShift, std::string(sysUncertainty).append("Diff"));
+
+  for ( unsigned idxProcess = 0; idxProcess < histograms.size(templateStoreType::kProcess); ++idxProcess ) {
+    for ( unsigned idxRegion = 0; idxRegion < histograms.size(templateStoreType::kRegion); ++idxRegion ) {
+      for ( unsigned idxObservable = 0; idxObservable < histograms.size(templateStoreType::kObservable); ++idxObservable ) {
+	if ( !(histograms.has(idxProcess, idxRegion, idxObservable, idxSysShift_up) &&
+	       histograms.has(idxProcess, idxRegion, idxObservable, idxSysShift_down)) ) continue;
+
+	TH1* histogram_up = histograms.get(idxProcess, idxRegion, idxObservable, idxSysShift_up);
+	assert(histogram_up);
+	if ( !histogram_up->GetSumw2N() ) histogram_up->Sumw2();
+
+	TH1* histogram_down = histograms.get(idxProcess, idxRegion, idxObservable, idxSysShift_down);
+	assert(histogram_down);
+	if ( !histogram_down->GetSumw2N() ) histogram_down->Sumw2();
+
+	assert(isCompatibleBinning(histogram_up, histogram_down));
+
+	std::string histogramName_diff = std::string(histogram_up->GetName()).append("_diff");
+	TH1* histogram_diff = (TH1*)histogram_up->Clone(histogramName_diff.data());
+
+	unsigned numBins = histogram_up->GetNbinsX();
+	for ( unsigned iBin = 0; iBin <= (numBins + 1); ++iBin ) {
+	  double binContent_diff = 0.5*(histogram_up->GetBinContent(iBin) - histogram_down->GetBinContent(iBin));
+	  histogram_diff->SetBinContent(iBin, binContent_diff);
+
+	  double binError_up   = histogram_up->GetBinError(iBin);
+	  double binError_down = histogram_down->GetBinError(iBin);
+	  double binError_diff = TMath::Sqrt(binError_up*binError_up + binError_down*binError_down);
+	  histogram_diff->SetBinError(iBin, binError_diff);
 	}
-      }	    
+
+	histograms.set(idxProcess, idxRegion, idxObservable, idxSysShift_diff, histogram_diff);
+      }
     }
   }
-} 
-
-void savePseudoExperimentHistograms(TH1* histogram, const std::string& xAxisLabel, const std::string& outputFileName)
-{
-  TCanvas* canvas = new TCanvas("canvas", "canvas", 800, 640);
-  canvas->SetFillColor(10);
-  canvas->SetBorderSize(2);
-
-  canvas->SetLeftMargin(0.12);
-  canvas->SetBottomMargin(0.12);
-
-  TH1* histogram_normalized = normalize(histogram);
-      
-  applyStyleOption(histogram_normalized, histogram->GetTitle(), xAxisLabel, "a.u");
-
-  canvas->Update();
-
-  size_t idx = outputFileName.find_last_of('.');
-  std::string outputFileName_plot = std::string(outputFileName, 0, idx);
-  outputFileName_plot.append("_").append(histogram->GetName());
-  if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
-  canvas->Print(std::string(outputFileName_plot).append(".png").data());
-  canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
-
-  delete canvas;
 }
 
-void saveValueAsHistogram(TFileDirectory& histogramOutputDirectory, double value, double error,
-			  const std::string& histogramName, const std::string& histogramTitle, 
+void saveValueAsHistogram(std::vector<TObject*>& fitResults, double value, double error,
+			  const std::string& histogramName, const std::string& histogramTitle,
 			  const std::string& fitVariable, const std::string& tauId)
 {
   TString histogramName_expanded = Form(histogramName.data(), fitVariable.data(), tauId.data());
   TString histogramTitle_expanded = Form(histogramTitle.data(), tauId.data(), fitVariable.data());
-  TH1* histogram = histogramOutputDirectory.make<TH1F>(histogramName_expanded.Data(), histogramTitle_expanded.Data(), 1, -0.5, +0.5);
+  TH1* histogram = new TH1F(histogramName_expanded.Data(), histogramTitle_expanded.Data(), 1, -0.5, +0.5);
+  histogram->SetDirectory(0);
   int bin = histogram->FindBin(0.);
   histogram->SetBinContent(bin, value);
   histogram->SetBinError(bin, error);
+  fitResults.push_back(histogram);
 }
 
 //
 //-------------------------------------------------------------------------------
 //
 
-int main(int argc, const char* argv[])
+void getFitVariables(const vstring& regionsToFit, const std::string& region_passed, const std::string& region_failed,
+		     const std::string& fitVariable,
+		     std::map<std::string, fitVariableType>& fitVariables, vstring& observables)
 {
-//--- parse command-line arguments
-  if ( argc < 2 ) {
-    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
-    return 0;
-  }
-
-  std::cout << "<fitTauIdEff>:" << std::endl;
-
-//--- disable pop-up windows showing graphics output
-  gROOT->SetBatch(true);
-
-//--- load framework libraries
-  gSystem->Load("libFWCoreFWLite");
-  AutoLibraryLoader::enable();
-
-//--- keep track of time it takes the macro to execute
-  TBenchmark clock;
-  clock.Start("fitTauIdEff");
-
-//--- read python configuration parameters
-  if ( !edm::readPSetsFrom(argv[1])->existsAs<edm::ParameterSet>("process") ) 
-    throw cms::Exception("fitTauIdEff") 
-      << "No ParameterSet 'process' found in configuration file = " << argv[1] << " !!\n";
-
-  edm::ParameterSet cfg = edm::readPSetsFrom(argv[1])->getParameter<edm::ParameterSet>("process");
-
-  edm::ParameterSet cfgFitTauIdEff = cfg.getParameter<edm::ParameterSet>("fitTauIdEff");
-
-  std::string tauId = cfgFitTauIdEff.getParameter<std::string>("tauId");
-  vstring tauIds;
-  tauIds.push_back(tauId);
-
-  double intLumiData = cfgFitTauIdEff.getParameter<double>("intLumiData"); // in units of fb^-1
-
-  bool runClosureTest = cfgFitTauIdEff.getParameter<bool>("runClosureTest");
-
-  std::string fitVariable = cfgFitTauIdEff.getParameter<std::string>("fitVariable");
-  std::map<std::string, fitVariableType> fitVariables;
-  vstring observables;  
   observables.push_back("EventCounter");
-  vstring regionsToFit = cfgFitTauIdEff.getParameter<vstring>("regions");
-  vstring regionsToLoad = regionsToFit;
-  std::string region_passed = cfgFitTauIdEff.getParameter<std::string>("region_passed");
-  std::string region_failed = cfgFitTauIdEff.getParameter<std::string>("region_failed");
   if ( regionsToFit.size() == 6 &&
        contains_string(regionsToFit, "A")           &&
-       contains_string(regionsToFit, "B")           &&	 
+       contains_string(regionsToFit, "B")           &&
        contains_string(regionsToFit, region_passed) &&
        contains_string(regionsToFit, region_failed) &&
        contains_string(regionsToFit, "C2")          &&
@@ -1436,88 +2116,50 @@ int main(int argc, const char* argv[])
     fitVariables[region_failed] = fitVariableType(fitVariable);
     fitVariables["C2"]          = fitVariableType("diTauMt");
     fitVariables["D"]           = fitVariableType("diTauMt");
-    observables.push_back(fitVariable);
-    observables.push_back(std::string("diTauMt"));
-    add_string_uniquely(regionsToLoad, "C");    // needed to initialize probabilities 
-    add_string_uniquely(regionsToLoad, "C1");   //  'pDiTauCharge_OS_SS', 'pMuonIso_tight_loose' and 'pDiTauKine_Sig_Bgr'
-    if ( runClosureTest ) 
-      add_string_uniquely(regionsToLoad, "A1"); // needed for QCD template 
+    add_string_uniquely(observables, fitVariable);
+    add_string_uniquely(observables, "diTauMt");
   } else if ( regionsToFit.size() == 2 &&
 	      contains_string(regionsToFit, region_passed) &&
 	      contains_string(regionsToFit, region_failed) ) {
     fitVariables[region_passed] = fitVariableType(fitVariable);
     fitVariables[region_failed] = fitVariableType(fitVariable);
-    observables.push_back(fitVariable);
-  } else throw cms::Exception("fitTauIdEff") 
+    add_string_uniquely(observables, fitVariable);
+  } else throw cms::Exception("fitTauIdEff")
       << "Invalid configuration parameter 'regions' = " << format_vstring(regionsToFit) << "!!\n";
+}
 
-  std::string regionQCDtemplate_passed = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_passed");
-  std::string regionQCDtemplate_failed = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_failed");
-  std::string regionQCDtemplate_D      = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_D");
-  vstring regionsQCDtemplate;
-  add_string_uniquely(regionsQCDtemplate, regionQCDtemplate_passed);
-  add_string_uniquely(regionsQCDtemplate, regionQCDtemplate_failed);
-  if ( regionQCDtemplate_D != "" ) add_string_uniquely(regionsQCDtemplate, regionQCDtemplate_D);
-
-  std::string templateMorphingMode_string = cfgFitTauIdEff.getParameter<std::string>("templateMorphingMode");
-  int templateMorphingMode = -1;
-  if      ( templateMorphingMode_string == "none"       ) templateMorphingMode = kNoTemplateMorphing;
-  else if ( templateMorphingMode_string == "horizontal" ) templateMorphingMode = kHorizontalTemplateMorphing;
-  else if ( templateMorphingMode_string == "vertical"   ) templateMorphingMode = kVerticalTemplateMorphing;
-  else throw cms::Exception("fitTauIdEff") 
-    << "Invalid configuration parameter 'templateMorphingMode' = " << templateMorphingMode_string << "!!\n";
-
-  vstring sysUncertainties = cfgFitTauIdEff.getParameter<vstring>("sysUncertainties");
-  vstring sysUncertainties_expanded;
-  sysUncertainties_expanded.push_back(key_central_value);
-  for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
-	sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
-    sysUncertainties_expanded.push_back(std::string(*sysUncertainty).append("Up"));
-    sysUncertainties_expanded.push_back(std::string(*sysUncertainty).append("Down"));
-  }
+//
+//-------------------------------------------------------------------------------
+//
 
-  double sysVariedByNsigma = cfgFitTauIdEff.getParameter<double>("sysVariedByNsigma");
+struct fitInputType
+{
+  vstring processes_;
+  std::string processName_signal_;
+  TauIdEffTemplateStore<TH1*> histograms_mc_; // key = (process, region, observable, central value/systematic uncertainty)
+  histogramMap3 histograms_data_;             // key = (region, observable, key_central_value)
+};
 
-  fwlite::InputSource inputFiles(cfg); 
-  if ( inputFiles.files().size() != 1 ) 
-    throw cms::Exception("fitTauIdEff") 
-      << "Input file must be unique, got = " << format_vstring(inputFiles.files()) << " !!\n";
-  std::string histogramFileName = (*inputFiles.files().begin());
-  
-  TFile* histogramInputFile = new TFile(histogramFileName.data());
-  std::string directory = cfgFitTauIdEff.getParameter<std::string>("directory");
-  TDirectory* histogramInputDirectory = ( directory != "" ) ?
-    dynamic_cast<TDirectory*>(histogramInputFile->Get(directory.data())) : histogramInputFile;
-  if ( !histogramInputDirectory ) 
-    throw cms::Exception("fitTauIdEff") 
-      << "Directory = " << directory << " does not exists in input file = " << histogramFileName << " !!\n";
+void loadFitInputs(fitInputType& fitInputs, TauIdEffKeyCatalog& histogramInputCatalog, const std::string& tauId,
+		   bool fitIndividualProcesses, bool runClosureTest,
+		   const vstring& regionsToLoad, const vstring& regionsToFit, const vstring& regionsQCDtemplate,
+		   const vstring& observables, const vstring& sysUncertainties_expanded)
+{
+//--------------------------------------------------------------------------------
+// Load template histograms for all processes and distributions observed in data
+// for one tau id. discriminator,
+// for all fit variables (the histograms are shared by the fits of all fit variables)
+//--------------------------------------------------------------------------------
 
-  std::map<std::string, processEntryType*> processEntries;
+  vstring& processes = fitInputs.processes_;
+  std::string& processName_signal = fitInputs.processName_signal_;
   histogramMap4 histograms_mc; // key = (process, region, observable, central value/systematic uncertainty)
+  histogramMap3& histograms_data = fitInputs.histograms_data_;
 
-  bool fitIndividualProcesses = cfgFitTauIdEff.getParameter<bool>("fitIndividualProcesses");
-  vstring processes;
-  std::string processName_signal;
-  std::map<std::string, std::string> legendEntries;
-  legendEntries["Ztautau"] = "Z/#gamma^{*} #rightarrow #tau^{+} #tau^{-}";
-  legendEntries["Zmumu"] = "Z/#gamma^{*} #rightarrow #mu^{+} #mu^{-}";
-  legendEntries["WplusJets"] = "W + jets";
-  legendEntries["EWKmuFake"] = "EWK, #mu #rightarrow #tau_{had}";
-  legendEntries["EWKjetFake"] = "EWK, jet #rightarrow #tau_{had}";
-  legendEntries["QCD"] = "QCD";
-  legendEntries["TTplusJets"] = "t#bar{t} + jets";
-  std::map<std::string, int> fillColors;
-  fillColors["Ztautau"] = 628;
-  fillColors["Zmumu"] = 596;
-  fillColors["WplusJets"] = 856;
-  fillColors["EWKmuFake"] = 596;
-  fillColors["EWKjetFake"] = 856;
-  fillColors["QCD"] = 797;
-  fillColors["TTplusJets"] = 618;
   // CV: need to add processes in reverse order in which they drawn,
   //     i.e. the process which is to be drawn on the bottom (top) needs to be added first (last)
   if ( fitIndividualProcesses ) {
-    processes.push_back(std::string("TTplusJets"));    
+    processes.push_back(std::string("TTplusJets"));
     processes.push_back(std::string("Zmumu"));
     processes.push_back(std::string("WplusJets"));
     processes.push_back(std::string("QCD"));
@@ -1526,13 +2168,8 @@ int main(int argc, const char* argv[])
 
     for ( vstring::const_iterator process = processes.begin();
 	  process != processes.end(); ++process ) {
-      histogramMap3 histograms_process;
-      loadHistograms(histograms_process, histogramInputDirectory, 
+      loadHistograms(histograms_mc[*process], histogramInputCatalog,
 		     *process, regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true);
-      processEntries[*process] = 
-	new processEntryType(*process, histograms_process, fitVariables, regionsToFit, region_passed, region_failed, 
-			     sysUncertainties, templateMorphingMode, legendEntries[*process], fillColors[*process]);
-      histograms_mc[*process] = histograms_process;
     }
   } else {
     processes.push_back(std::string("TTplusJets"));
@@ -1542,16 +2179,11 @@ int main(int argc, const char* argv[])
     processName_signal = "Ztautau";
     processes.push_back(processName_signal);
 
-    histogramMap3 histograms_Ztautau_genTau;
-    //loadHistograms(histograms_Ztautau_genTau, histogramInputDirectory, 
+    //loadHistograms(histograms_mc["Ztautau"], histogramInputCatalog,
     //	             "Ztautau", regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true, "GenTau");
-    loadHistograms(histograms_Ztautau_genTau, histogramInputDirectory, 
+    loadHistograms(histograms_mc["Ztautau"], histogramInputCatalog,
 		   "ZplusJets", regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true, "GenTau");
-    processEntries["Ztautau"] =
-      new processEntryType("Ztautau", histograms_Ztautau_genTau, fitVariables, regionsToFit, region_passed, region_failed, 
-			   sysUncertainties, templateMorphingMode, legendEntries["Ztautau"], fillColors["Ztautau"]);
-    histograms_mc["Ztautau"] = histograms_Ztautau_genTau;
-    
+
     histogramMap4 histograms_EWK_muFake;
     histogramMap4 histograms_EWK_jetFake;
     vstring processes_EWK;
@@ -1561,91 +2193,208 @@ int main(int argc, const char* argv[])
     processes_EWK.push_back(std::string("WplusJets"));
     for ( vstring::const_iterator process = processes_EWK.begin();
 	  process != processes_EWK.end(); ++process ) {
-      loadHistograms(histograms_EWK_muFake[*process], histogramInputDirectory, 
+      loadHistograms(histograms_EWK_muFake[*process], histogramInputCatalog,
 		     *process, regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true, "MuToTauFake");
-      loadHistograms(histograms_EWK_jetFake[*process], histogramInputDirectory, 
+      loadHistograms(histograms_EWK_jetFake[*process], histogramInputCatalog,
 		     *process, regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true, "JetToTauFake");
     }
+    histograms_mc["EWKmuFake"] = sumHistograms(histograms_EWK_muFake, processes_EWK, "EWKmuFake");
+    histograms_mc["EWKjetFake"] = sumHistograms(histograms_EWK_jetFake, processes_EWK, "EWKjetFake");
 
-    histogramMap3 histograms_EWKsum_muFake = sumHistograms(histograms_EWK_muFake, processes_EWK, "EWKmuFake");
-    processEntries["EWKmuFake"] = 
-      new processEntryType("EWKmuFake", histograms_EWKsum_muFake, fitVariables, regionsToFit, region_passed, region_failed, 
-			   sysUncertainties, templateMorphingMode, legendEntries["EWKmuFake"], fillColors["EWKmuFake"]);
-    histograms_mc["EWKmuFake"] = histograms_EWKsum_muFake;
-
-    histogramMap3 histograms_EWKsum_jetFake = sumHistograms(histograms_EWK_jetFake, processes_EWK, "EWKjetFake");
-    processEntries["EWKjetFake"] = 
-      new processEntryType("EWKjetFake", histograms_EWKsum_jetFake, fitVariables, regionsToFit, region_passed, region_failed, 
-			   sysUncertainties, templateMorphingMode, legendEntries["EWKjetFake"], fillColors["EWKjetFake"]);
-    histograms_mc["EWKjetFake"] = histograms_EWKsum_jetFake;
-
-    histogramMap3 histograms_QCD;
-    loadHistograms(histograms_QCD, histogramInputDirectory, 
+    loadHistograms(histograms_mc["QCD"], histogramInputCatalog,
 		   "QCD", regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true);
-    processEntries["QCD"] = 
-      new processEntryType("QCD", histograms_QCD, fitVariables, regionsToFit, region_passed, region_failed, 
-			   sysUncertainties, templateMorphingMode, legendEntries["QCD"], fillColors["QCD"]);
-    histograms_mc["QCD"] = histograms_QCD;
-    
-    histogramMap3 histograms_TTplusJets;
-    loadHistograms(histograms_TTplusJets, histogramInputDirectory, 
+    loadHistograms(histograms_mc["TTplusJets"], histogramInputCatalog,
 		   "TTplusJets", regionsToLoad, tauId, observables, sysUncertainties_expanded, true, true);
-    processEntries["TTplusJets"] = 
-      new processEntryType("TTplusJets", histograms_TTplusJets, fitVariables, regionsToFit, region_passed, region_failed, 
-			   sysUncertainties, templateMorphingMode, legendEntries["TTplusJets"], fillColors["TTplusJets"]);
-    histograms_mc["TTplusJets"] = histograms_TTplusJets;
   }
 
-  histogramMap3 histograms_mcSum = sumHistograms(histograms_mc, processes, "mcSum");
-  processEntries["mcSum"] = 
-    new processEntryType("mcSum", histograms_mcSum, fitVariables, regionsToFit, region_passed, region_failed, 
-			 sysUncertainties, templateMorphingMode, "Simulation", 10);
-  histograms_mc["mcSum"] = histograms_mcSum;
-  
+  histograms_mc["mcSum"] = sumHistograms(histograms_mc, processes, "mcSum");
+
   vstring sysUncertainties_data;
   sysUncertainties_data.push_back(key_central_value);
-  histogramMap3 histograms_data; // key = (region, observable, key_central_value)
 //--- closure test: fit sum(MC) instead of Data
   if ( runClosureTest ) {
     std::cout << "<fitTauIdEfficiency>:" << std::endl;
-    std::cout << " running closure-test...fluctuating histograms..." << std::endl; 
+    std::cout << " running closure-test...fluctuating histograms..." << std::endl;
     for ( vstring::const_iterator region = regionsToFit.begin();
 	  region != regionsToFit.end(); ++region ) {
-      for ( vstring::const_iterator observable = observables.begin();  
+      for ( vstring::const_iterator observable = observables.begin();
 	    observable != observables.end(); ++observable ) {
 	TH1* origHistogram = histograms_mc["mcSum"][*region][*observable][key_central_value];
-	    
+
 	TH1* fluctHistogram = (TH1*)origHistogram->Clone(TString(origHistogram->GetName()).Append("_fluctuated"));
 	fluctHistogram->Reset();
 	sampleHistogram_stat(origHistogram, fluctHistogram, -1., true);
-	
-	std::cout << "histograms_data[region = " << (*region) << "][observable = " << (*observable) << "]" 
+
+	std::cout << "histograms_data[region = " << (*region) << "][observable = " << (*observable) << "]"
 		  << " = " << fluctHistogram << " (original = " << origHistogram << ")" << std::endl;
 	std::cout << " (name = " << fluctHistogram->GetName() << ", integral = " << getIntegral(fluctHistogram, false, false) << ")" << std::endl;
 	histograms_data[*region][*observable][key_central_value] = fluctHistogram;
       }
     }
   } else {
-    loadHistograms(histograms_data, histogramInputDirectory, 
+    loadHistograms(histograms_data, histogramInputCatalog,
 		   "Data", regionsToLoad, tauId, observables, sysUncertainties_data, true, false);
-    loadHistograms(histograms_data, histogramInputDirectory, 
-		   "Data", regionsQCDtemplate, tauId, observables, sysUncertainties_expanded, true, false);  
+    loadHistograms(histograms_data, histogramInputCatalog,
+		   "Data", regionsQCDtemplate, tauId, observables, sysUncertainties_expanded, true, false);
   }
-  processEntryType* data = 
-    new processEntryType("Data", histograms_data, fitVariables, regionsToFit, region_passed, region_failed, 
+
+  for ( histogramMap4::const_iterator process = histograms_mc.begin();
+	process != histograms_mc.end(); ++process ) {
+    fitInputs.histograms_mc_.setEntries(process->first, process->second);
+  }
+}
+
+//
+//-------------------------------------------------------------------------------
+//
+
+struct toyTemplateType
+{
+  TH1* origHistogram_;
+  TH1* fluctHistogram_;
+  std::vector<TH1*> sysHistograms_; // difference between "up" and "down" shifts for each systematic uncertainty
+};
+
+void fitTauIdEfficiency(const edm::ParameterSet& cfgFitTauIdEff, const std::string& tauId, const std::string& fitVariable,
+			const fitInputType& fitInputs, std::vector<TObject*>& fitResults, TauIdEffPlotQueue& plotQueue)
+{
+//--------------------------------------------------------------------------------
+// Fit tau id. efficiency for one combination of tau id. discriminator and fit variable
+// and make the corresponding control plots and pseudo-experiments.
+//
+// NOTE: fit results are not written to the output file directly,
+//       but added to the 'fitResults' vector
+//      (the fits for different tau id. discriminators and fit variables may be run in separate worker processes);
+//       control plots are passed to the 'plotQueue', which renders them in the background
+//      (or stores them for rendering later, in case plotting is deferred)
+//--------------------------------------------------------------------------------
+
+  std::cout << "<fitTauIdEfficiency>:" << std::endl;
+  std::cout << " tauId = " << tauId << std::endl;
+  std::cout << " fitVariable = " << fitVariable << std::endl;
+
+  double intLumiData = cfgFitTauIdEff.getParameter<double>("intLumiData"); // in units of fb^-1
+
+  bool runClosureTest = cfgFitTauIdEff.getParameter<bool>("runClosureTest");
+
+  vstring regionsToFit = cfgFitTauIdEff.getParameter<vstring>("regions");
+  std::string region_passed = cfgFitTauIdEff.getParameter<std::string>("region_passed");
+  std::string region_failed = cfgFitTauIdEff.getParameter<std::string>("region_failed");
+  std::map<std::string, fitVariableType> fitVariables;
+  vstring observables;
+  getFitVariables(regionsToFit, region_passed, region_failed, fitVariable, fitVariables, observables);
+
+  std::string regionQCDtemplate_passed = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_passed");
+  std::string regionQCDtemplate_failed = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_failed");
+  std::string regionQCDtemplate_D      = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_D");
+
+  std::string templateMorphingMode_string = cfgFitTauIdEff.getParameter<std::string>("templateMorphingMode");
+  int templateMorphingMode = -1;
+  if      ( templateMorphingMode_string == "none"       ) templateMorphingMode = kNoTemplateMorphing;
+  else if ( templateMorphingMode_string == "horizontal" ) templateMorphingMode = kHorizontalTemplateMorphing;
+  else if ( templateMorphingMode_string == "vertical"   ) templateMorphingMode = kVerticalTemplateMorphing;
+  else throw cms::Exception("fitTauIdEff")
+    << "Invalid configuration parameter 'templateMorphingMode' = " << templateMorphingMode_string << "!!\n";
+
+  std::string fitBackend_string = ( cfgFitTauIdEff.exists("fitBackend") ) ?
+    cfgFitTauIdEff.getParameter<std::string>("fitBackend") : "RooFit";
+  int fitBackend = -1;
+  if      ( fitBackend_string == "RooFit" ) fitBackend = kFitBackendRooFit;
+  else if ( fitBackend_string == "native" ) fitBackend = kFitBackendNative;
+  else throw cms::Exception("fitTauIdEff")
+    << "Invalid configuration parameter 'fitBackend' = " << fitBackend_string << "!!\n";
+  if ( fitBackend == kFitBackendNative && templateMorphingMode == kHorizontalTemplateMorphing )
+    throw cms::Exception("fitTauIdEff")
+      << "Horizontal template morphing not supported by fitBackend = " << fitBackend_string << " !!\n";
+//--- CV: repeat nominal fit using RooFit in case native likelihood is used for fitting,
+//        and report differences in fitted tau id. efficiency and its uncertainty (self-check of native likelihood)
+  bool compareFitBackends = ( cfgFitTauIdEff.exists("compareFitBackends") ) ?
+    cfgFitTauIdEff.getParameter<bool>("compareFitBackends") : false;
+
+  vstring sysUncertainties = cfgFitTauIdEff.getParameter<vstring>("sysUncertainties");
+  vstring sysUncertainties_expanded;
+  sysUncertainties_expanded.push_back(key_central_value);
+  for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
+	sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
+    sysUncertainties_expanded.push_back(std::string(*sysUncertainty).append("Up"));
+    sysUncertainties_expanded.push_back(std::string(*sysUncertainty).append("Down"));
+  }
+
+  double sysVariedByNsigma = cfgFitTauIdEff.getParameter<double>("sysVariedByNsigma");
+
+//--- CV: copy histogram maps, as the entries get modified (not the histograms themselves)
+//        when taking QCD template from data and when running pseudo-experiments
+  const vstring& processes = fitInputs.processes_;
+  const std::string& processName_signal = fitInputs.processName_signal_;
+  TauIdEffTemplateStore<TH1*> histograms_mc = fitInputs.histograms_mc_;
+  histogramMap3 histograms_data = fitInputs.histograms_data_;
+
+  std::map<std::string, std::string> legendEntries;
+  legendEntries["Ztautau"] = "Z/#gamma^{*} #rightarrow #tau^{+} #tau^{-}";
+  legendEntries["Zmumu"] = "Z/#gamma^{*} #rightarrow #mu^{+} #mu^{-}";
+  legendEntries["WplusJets"] = "W + jets";
+  legendEntries["EWKmuFake"] = "EWK, #mu #rightarrow #tau_{had}";
+  legendEntries["EWKjetFake"] = "EWK, jet #rightarrow #tau_{had}";
+  legendEntries["QCD"] = "QCD";
+  legendEntries["TTplusJets"] = "t#bar{t} + jets";
+  std::map<std::string, int> fillColors;
+  fillColors["Ztautau"] = 628;
+  fillColors["Zmumu"] = 596;
+  fillColors["WplusJets"] = 856;
+  fillColors["EWKmuFake"] = 596;
+  fillColors["EWKjetFake"] = 856;
+  fillColors["QCD"] = 797;
+  fillColors["TTplusJets"] = 618;
+
+  std::map<std::string, processEntryType*> processEntries;
+  for ( vstring::const_iterator process = processes.begin();
+	process != processes.end(); ++process ) {
+    histogramMap3 histograms_process;
+    histograms_mc.getEntries(*process, histograms_process);
+    processEntries[*process] =
+      new processEntryType(*process, histograms_process, fitVariables, regionsToFit, region_passed, region_failed,
+			   sysUncertainties, templateMorphingMode, legendEntries[*process], fillColors[*process]);
+  }
+  histogramMap3 histograms_mcSum;
+  histograms_mc.getEntries("mcSum", histograms_mcSum);
+  processEntries["mcSum"] =
+    new processEntryType("mcSum", histograms_mcSum, fitVariables, regionsToFit, region_passed, region_failed,
+			 sysUncertainties, templateMorphingMode, "Simulation", 10);
+
+  vstring sysUncertainties_data;
+  sysUncertainties_data.push_back(key_central_value);
+  processEntryType* data =
+    new processEntryType("Data", histograms_data, fitVariables, regionsToFit, region_passed, region_failed,
 			 sysUncertainties_data, kNoTemplateMorphing, "Data", 1);
-  
+
   bool runPseudoExperiments = cfgFitTauIdEff.getParameter<bool>("runPseudoExperiments");
   unsigned numPseudoExperiments = cfgFitTauIdEff.getParameter<unsigned>("numPseudoExperiments");
 
+  bool runAsimovFit = ( cfgFitTauIdEff.exists("runAsimovFit") ) ?
+    cfgFitTauIdEff.getParameter<bool>("runAsimovFit") : false;
+  bool runMinosAsimovFit = ( cfgFitTauIdEff.exists("runMinosAsimovFit") ) ?
+    cfgFitTauIdEff.getParameter<bool>("runMinosAsimovFit") : false;
+
+  bool runHessePseudoExperiments = ( cfgFitTauIdEff.exists("runHessePseudoExperiments") ) ?
+    cfgFitTauIdEff.getParameter<bool>("runHessePseudoExperiments") : true;
+
+  bool runProfileLikelihoodScan = ( cfgFitTauIdEff.exists("runProfileLikelihoodScan") ) ?
+    cfgFitTauIdEff.getParameter<bool>("runProfileLikelihoodScan") : false;
+  unsigned profileLikelihoodScanNumPoints = ( cfgFitTauIdEff.exists("profileLikelihoodScanNumPoints") ) ?
+    cfgFitTauIdEff.getParameter<unsigned>("profileLikelihoodScanNumPoints") : 21;
+  double profileLikelihoodScanNumSigma = ( cfgFitTauIdEff.exists("profileLikelihoodScanNumSigma") ) ?
+    cfgFitTauIdEff.getParameter<double>("profileLikelihoodScanNumSigma") : 3.;
+  unsigned profileLikelihoodScanNumWorkers = ( cfgFitTauIdEff.exists("profileLikelihoodScanNumWorkers") ) ?
+    cfgFitTauIdEff.getParameter<unsigned>("profileLikelihoodScanNumWorkers") : 1;
+
   bool makeControlPlots = cfgFitTauIdEff.getParameter<bool>("makeControlPlots");
   std::string controlPlotFilePath = cfgFitTauIdEff.getParameter<std::string>("controlPlotFilePath");
 
 //--- scale initial values for normalization factors of all processes
-//    by ratio to Data to MC event yields in region 'ABCD', 
+//    by ratio to Data to MC event yields in region 'ABCD',
 //    in order to speed-up convergence of fit
   double scaleFactorMCtoData = data->numEvents_["ABCD"][key_central_value]/processEntries["mcSum"]->numEvents_["ABCD"][key_central_value];
-  std::cout << "number of events in region ABCD: data = " << data->numEvents_["ABCD"][key_central_value] << "," 
+  std::cout << "number of events in region ABCD: data = " << data->numEvents_["ABCD"][key_central_value] << ","
 	    << " sum(MC) = " << processEntries["mcSum"]->numEvents_["ABCD"][key_central_value] << std::endl;
   std::cout << "--> MC-to-Data scale-factor = " << scaleFactorMCtoData << std::endl;
   for ( std::map<std::string, processEntryType*>::iterator processEntry = processEntries.begin();
@@ -1657,7 +2406,7 @@ int main(int argc, const char* argv[])
 //--- obtain template for QCD background from data,
 //    from SS && Mt < 40 GeV && (Pzeta - 1.5 PzetaVis) > -20 GeV sideband
   if ( !runClosureTest ) {
-    for ( vstring::const_iterator observable = observables.begin();  
+    for ( vstring::const_iterator observable = observables.begin();
 	  observable != observables.end(); ++observable ) {
       for ( vstring::const_iterator sysUncertainty = sysUncertainties_expanded.begin();
 	    sysUncertainty != sysUncertainties_expanded.end(); ++sysUncertainty ) {
@@ -1672,7 +2421,7 @@ int main(int argc, const char* argv[])
     }
 
     std::cout << "<fitTauIdEfficiency>:" << std::endl;
-    std::cout << " taking QCD template from data...updating histogramMap..." << std::endl; 
+    std::cout << " taking QCD template from data...updating histogramMap..." << std::endl;
     for ( vstring::const_iterator region = regionsToFit.begin();
 	  region != regionsToFit.end(); ++region ) {
       for ( vstring::const_iterator observable = observables.begin();
@@ -1680,7 +2429,7 @@ int main(int argc, const char* argv[])
 	for ( vstring::const_iterator sysUncertainty = sysUncertainties_expanded.begin();
 	      sysUncertainty != sysUncertainties_expanded.end(); ++sysUncertainty ) {
 	  TH1* histogram = processEntries["QCD"]->histograms_[*region][*observable][*sysUncertainty];
-	  std::cout << "histogramMap[region = " << (*region) << "][observable = " << (*observable) << "]" 
+	  std::cout << "histogramMap[region = " << (*region) << "][observable = " << (*observable) << "]"
 		    << "[sysUncertainty = " << (*sysUncertainty) << "] = " << histogram << std::endl;
 	  std::cout << " (name = " << histogram->GetName() << ", integral = " << histogram->Integral() << ")" << std::endl;
 	}
@@ -1698,34 +2447,59 @@ int main(int argc, const char* argv[])
   if ( makeControlPlots ) {
     for ( vstring::const_iterator region = regionsToFit.begin();
 	  region != regionsToFit.end(); ++region ) {
-      for ( vstring::const_iterator observable = observables.begin();  
+      for ( vstring::const_iterator observable = observables.begin();
 	    observable != observables.end(); ++observable ) {
 	if ( (*observable) == "EventCounter" ) continue;
         std::string outputFileName = controlPlotFilePath;
 	if ( outputFileName.find_last_of("/") != (outputFileName.length() - 1) ) outputFileName.append("/");
 	outputFileName.append("controlPlotsTauIdEff_");
 	outputFileName.append(tauId).append("_");
-	outputFileName.append(*region).append("_").append(*observable).append("_prefit.pdf");
-	drawHistograms(*region, *observable, *data, intLumiData, processEntries, processes, false, 
-		       "", xAxisTitles[*observable], outputFileName, false);
+	outputFileName.append(*region).append("_").append(*observable).append("_prefit_");
+//--- CV: include fitVariable in name of output file,
+//        as fits for different fitVariables may run in parallel worker processes
+	outputFileName.append(fitVariable).append(".pdf");
+	drawHistograms(*region, *observable, *data, intLumiData, processEntries, processes, false,
+		       "", xAxisTitles[*observable], outputFileName, plotQueue, false);
       }
     }
   }
 
   std::cout << "running fit for central values..." << std::endl;
-  
+
   double effValue = 0.;
   double effError = 1.;
-  bool hasFitConverged = false;  
-  fitUsingRooFit(*data, intLumiData, processEntries, sysVariedByNsigma, processName_signal, 
-		 tauId, effValue, effError, hasFitConverged, 1);
-  
+  bool hasFitConverged = false;
+  fitStartingPointType fittedPoint_nominal;
+  runFit(*data, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+	 tauId, effValue, effError, hasFitConverged, 1, fitOptionsType(), 0, &fittedPoint_nominal);
+
+  if ( compareFitBackends && fitBackend == kFitBackendNative ) {
+    std::cout << "repeating fit for central values using RooFit..." << std::endl;
+    double effValue_RooFit = 0.;
+    double effError_RooFit = 1.;
+    bool hasFitConverged_RooFit = false;
+    runFit(*data, processEntries, sysVariedByNsigma, processName_signal, kFitBackendRooFit,
+	   tauId, effValue_RooFit, effError_RooFit, hasFitConverged_RooFit);
+    std::cout << "comparison of fit backends for tauId = " << tauId << ", fitVariable = " << fitVariable << ":" << std::endl;
+    std::cout << " native: effValue = " << effValue << " +/- " << effError 
+	      << " (fit " << ( hasFitConverged ? "converged" : "failed to converge" ) << ")" << std::endl;
+    std::cout << " RooFit: effValue = " << effValue_RooFit << " +/- " << effError_RooFit 
+	      << " (fit " << ( hasFitConverged_RooFit ? "converged" : "failed to converge" ) << ")" << std::endl;
+    std::cout << " difference: effValue = " << (effValue - effValue_RooFit) << ", effError = " << (effError - effError_RooFit) << std::endl;
+    if ( TMath::Abs(effValue - effValue_RooFit) > 0.1*effError || TMath::Abs(effError - effError_RooFit) > 0.1*effError )
+      std::cerr << "Warning: results of native and RooFit fits differ by more than 10% of fit uncertainty"
+		<< " for tauId = " << tauId << ", fitVariable = " << fitVariable << " !!" << std::endl;
+//--- restore parameter values determined by native fit,
+//    which are used by all subsequent steps (control plots, pseudo-experiments,...)
+    applyFitStartingPoint(fittedPoint_nominal);
+  }
+
 //--- make control plots of Data compared to sum(MC) scaled by normalization factors determined by fit
 //    for muonPt, tauPt, Mt, visMass,... distributions in different regions
   if ( makeControlPlots ) {
     for ( vstring::const_iterator region = regionsToFit.begin();
 	  region != regionsToFit.end(); ++region ) {
-      for ( vstring::const_iterator observable = observables.begin();  
+      for ( vstring::const_iterator observable = observables.begin();
 	    observable != observables.end(); ++observable ) {
 	if ( (*observable) == "EventCounter" ) continue;
 	std::string outputFileName = controlPlotFilePath;
@@ -1734,20 +2508,76 @@ int main(int argc, const char* argv[])
 	outputFileName.append(tauId).append("_");
 	outputFileName.append(*region).append("_").append(*observable).append("_postfit_");
 	outputFileName.append(fitVariable).append(".pdf");
-	drawHistograms(*region, *observable, *data, intLumiData, processEntries, processes, true, 
-		       "", xAxisTitles[*observable], outputFileName, false);
+	drawHistograms(*region, *observable, *data, intLumiData, processEntries, processes, true,
+		       "", xAxisTitles[*observable], outputFileName, plotQueue, false);
       }
     }
   }
 
-  std::cout << "Efficiency of Tau id. = " << tauId << ":" << std::endl;  
-  std::cout << " fitVariable = " << fitVariable << ":" 
+  std::cout << "Efficiency of Tau id. = " << tauId << ":" << std::endl;
+  std::cout << " fitVariable = " << fitVariable << ":"
 	    << " result = " << effValue*100. << " +/- " << effError*100. << "%";
   if  ( hasFitConverged ) std::cout << " (fit converged successfully)";
   else std::cout << " (fit failed to converge)";
-  std::cout << std::endl;   
+  std::cout << std::endl;
   double tauIdEffMCexp = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].expectedValue_;
-  std::cout << "(Monte Carlo prediction = " << tauIdEffMCexp*100. << "%)" << std::endl; 
+  std::cout << "(Monte Carlo prediction = " << tauIdEffMCexp*100. << "%)" << std::endl;
+
+//--- keep fitted number of signal events,
+//    as fit parameters get overwritten by fits of Asimov dataset and pseudo-experiments
+  double fitNormValue =
+    processEntries[processName_signal]->normFactors_[region_passed]->getVal()
+   + processEntries[processName_signal]->normFactors_[region_failed]->getVal();
+
+//--- scan profile-likelihood of tau id. efficiency around result of nominal fit
+  TGraph* profileLikelihood = 0;
+  if ( runProfileLikelihoodScan ) {
+    std::cout << "running profile-likelihood scan..." << std::endl;
+
+    std::string profileLikelihoodName = Form("profileLikelihood_%s_%s", fitVariable.data(), tauId.data());
+    profileLikelihood = compProfileLikelihood(*data, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+					      tauId, fittedPoint_nominal, effValue, effError,
+					      profileLikelihoodScanNumPoints, profileLikelihoodScanNumSigma, profileLikelihoodScanNumWorkers,
+					      profileLikelihoodName);
+  }
+
+//--- fit "Asimov" dataset built from sum of templates,
+//    in order to determine expected (median) uncertainty on tau id. efficiency
+//    and correlations between fit parameters without running pseudo-experiments
+  double effValue_asimov = 0.;
+  double effError_asimov = 1.;
+  double effErrorLow_asimov = -1.;
+  double effErrorHigh_asimov = +1.;
+  TH2D* correlations_asimov = 0;
+  if ( runAsimovFit ) {
+    std::cout << "running fit of Asimov dataset..." << std::endl;
+
+    resetFitParameters(processEntries);
+    histogramMap3 histograms_asimov = makeAsimovHistograms(processEntries, processes, regionsToFit, observables);
+    processEntryType* asimov =
+      new processEntryType("Asimov", histograms_asimov, fitVariables, regionsToFit, region_passed, region_failed,
+			   sysUncertainties_data, kNoTemplateMorphing, "Asimov", 1);
+
+    RooRealVar* pTauId_signal = processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].fittedValue_;
+
+    fitOptionsType fitOptions_asimov;
+    if ( runMinosAsimovFit ) fitOptions_asimov.minosParameter_ = pTauId_signal;
+
+    bool hasFitConverged_asimov = false;
+    runFit(*asimov, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+	   tauId, effValue_asimov, effError_asimov, hasFitConverged_asimov, 1, fitOptions_asimov, &correlations_asimov);
+
+    effErrorLow_asimov = ( pTauId_signal->hasAsymError() ) ? pTauId_signal->getAsymErrorLo() : -effError_asimov;
+    effErrorHigh_asimov = ( pTauId_signal->hasAsymError() ) ? pTauId_signal->getAsymErrorHi() : +effError_asimov;
+
+    std::cout << "Expected efficiency of Tau id. = " << tauId << " (Asimov dataset):" << std::endl;
+    std::cout << " fitVariable = " << fitVariable << ":"
+	      << " result = " << effValue_asimov*100. << " +/- " << effError_asimov*100. << "%";
+    if ( runMinosAsimovFit ) std::cout << " (MINOS: " << effErrorLow_asimov*100. << ", +" << effErrorHigh_asimov*100. << "%)";
+    if  ( hasFitConverged_asimov ) std::cout << " (fit converged successfully)";
+    else std::cout << " (fit failed to converge)";
+    std::cout << std::endl;
+  }
 
   if ( runPseudoExperiments ) {
 
@@ -1759,57 +2589,77 @@ int main(int argc, const char* argv[])
 
     TString effDistributionName = Form("effDistribution_%s_%s", tauId.data(), fitVariable.data());
     TString effDistributionTitle = Form("ToyMC: %s Efficiency for %s", tauId.data(), fitVariable.data());
-    TH1* effDistribution = 
-      new TH1D(effDistributionName.Data(), 
+    TH1* effDistribution =
+      new TH1D(effDistributionName.Data(),
 	       effDistributionTitle.Data(), 101, -0.005, +1.005);
 
     TString fitConvergenceDistributionName  = Form("fitConvergenceDistribution_%s_%s", tauId.data(), fitVariable.data());
     TString fitConvergenceDistributionTitle = Form("ToyMC: %s Efficiency for %s", tauId.data(), fitVariable.data());
-    TH1* fitConvergenceDistribution = 
-      new TH1D(fitConvergenceDistributionName.Data(), 
+    TH1* fitConvergenceDistribution =
+      new TH1D(fitConvergenceDistributionName.Data(),
 	       fitConvergenceDistributionTitle.Data(), 2, -0.005, +1.005);
     TAxis* xAxis = fitConvergenceDistribution->GetXaxis();
     xAxis->SetBinLabel(1, "Failure");
     xAxis->SetBinLabel(2, "Success");
 
-    histogramMap4 histograms_fluctuated; // key = (process, region, observable, central value/systematic uncertainty) 
+//--- resolve template histograms once, outside of loop over pseudo-experiments;
+//    the fluctuated histograms are resampled for each pseudo-experiment and used as templates by the fit
+    unsigned idxCentralValue = histograms_mc.intern(TauIdEffTemplateStore<TH1*>::kSysShift, key_central_value);
+    std::vector<unsigned> idxSysShifts_diff;
+    for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
+	  sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
+      idxSysShifts_diff.push_back(histograms_mc.intern(TauIdEffTemplateStore<TH1*>::kSysShift, std::string(*sysUncertainty).append("Diff")));
+    }
+    std::vector<toyTemplateType> toyTemplates;
+    for ( vstring::const_iterator process = processes.begin();
+	  process != processes.end(); ++process ) {
+      unsigned idxProcess = histograms_mc.intern(TauIdEffTemplateStore<TH1*>::kProcess, *process);
+      for ( vstring::const_iterator region = regionsToFit.begin();
+	    region != regionsToFit.end(); ++region ) {
+	unsigned idxRegion = histograms_mc.intern(TauIdEffTemplateStore<TH1*>::kRegion, *region);
+	for ( vstring::const_iterator observable = observables.begin();
+	      observable != observables.end(); ++observable ) {
+	  unsigned idxObservable = histograms_mc.intern(TauIdEffTemplateStore<TH1*>::kObservable, *observable);
+
+	  toyTemplateType toyTemplate;
+	  toyTemplate.origHistogram_ = histograms_mc.get(idxProcess, idxRegion, idxObservable, idxCentralValue);
+	  assert(toyTemplate.origHistogram_);
+	  toyTemplate.fluctHistogram_ = (TH1*)toyTemplate.origHistogram_->Clone(TString(toyTemplate.origHistogram_->GetName()).Append("_fluctuated"));
+	  for ( std::vector<unsigned>::const_iterator idxSysShift_diff = idxSysShifts_diff.begin();
+		idxSysShift_diff != idxSysShifts_diff.end(); ++idxSysShift_diff ) {
+	    TH1* sysHistogram = histograms_mc.get(idxProcess, idxRegion, idxObservable, *idxSysShift_diff);
+	    assert(sysHistogram);
+	    toyTemplate.sysHistograms_.push_back(sysHistogram);
+	  }
+	  toyTemplates.push_back(toyTemplate);
+
+	  processEntries[*process]->histograms_[*region][*observable][key_central_value] = toyTemplate.fluctHistogram_;
+	}
+      }
+    }
+
+//--- start fits of pseudo-experiments from parameter values and covariance matrix of nominal fit,
+//    in order to reduce number of function calls needed for fit to converge
+    fitOptionsType fitOptions_pseudoExperiments;
+    fitOptions_pseudoExperiments.runHesse_ = runHessePseudoExperiments;
+    fitOptions_pseudoExperiments.startingPoint_ = &fittedPoint_nominal;
 
     for ( unsigned i = 0; i < numPseudoExperiments; ++i ) {
-      for ( vstring::const_iterator process = processes.begin();
-	    process != processes.end(); ++process ) {
-	for ( vstring::const_iterator region = regionsToFit.begin();
-	      region != regionsToFit.end(); ++region ) {
-	  for ( vstring::const_iterator observable = observables.begin();  
-		observable != observables.end(); ++observable ) {
-	    TH1* origHistogram = histograms_mc[*process][*region][*observable][key_central_value];
-	    
-	    TH1* fluctHistogram = histograms_fluctuated[*process][*region][*observable][key_central_value];
-	    if ( !fluctHistogram ) {
-	      fluctHistogram = (TH1*)origHistogram->Clone(TString(origHistogram->GetName()).Append("_fluctuated"));
-	      histograms_fluctuated[*process][*region][*observable][key_central_value] = fluctHistogram;
-	    }
-	      
-	    sampleHistogram_stat(origHistogram, fluctHistogram);
-	      
-	    for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
-		  sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
-	      std::string key_systematic = std::string(*sysUncertainty).append("Diff");
-	      TH1* sysHistogram = histograms_mc[*process][*region][*observable][key_systematic];
-	      assert(sysHistogram);
-		
-	      sampleHistogram_sys(fluctHistogram, sysHistogram, 1.0/sysVariedByNsigma, -1.0, +1.0, kCoherent);
-	    }
+      for ( std::vector<toyTemplateType>::iterator toyTemplate = toyTemplates.begin();
+	    toyTemplate != toyTemplates.end(); ++toyTemplate ) {
+	sampleHistogram_stat(toyTemplate->origHistogram_, toyTemplate->fluctHistogram_);
 
-	    processEntries[*process]->histograms_[*region][*observable][key_central_value] = fluctHistogram;
-	  }
+	for ( std::vector<TH1*>::const_iterator sysHistogram = toyTemplate->sysHistograms_.begin();
+	      sysHistogram != toyTemplate->sysHistograms_.end(); ++sysHistogram ) {
+	  sampleHistogram_sys(toyTemplate->fluctHistogram_, *sysHistogram, 1.0/sysVariedByNsigma, -1.0, +1.0, kCoherent);
 	}
       }
-    
+
       double effValue_i = 0.;
       double effError_i = 1.;
       bool hasFitConverged_i = false;
-      fitUsingRooFit(*data, intLumiData, processEntries, sysVariedByNsigma, processName_signal, 
-		     tauId, effValue_i, effError_i, hasFitConverged_i, 0);
+      runFit(*data, processEntries, sysVariedByNsigma, processName_signal, fitBackend,
+	     tauId, effValue_i, effError_i, hasFitConverged_i, 0, fitOptions_pseudoExperiments);
 
       effDistribution->Fill(effValue_i);
       fitConvergenceDistribution->Fill(hasFitConverged_i);
@@ -1822,47 +2672,428 @@ int main(int argc, const char* argv[])
     savePseudoExperimentHistograms(fitConvergenceDistribution, "Fit status", outputFileName);
   }
 
-  delete histogramInputFile;
-
-//-- save fit results
-  fwlite::OutputFiles outputFile(cfg);
-  fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
-
-  TFileDirectory fitResultOutputDirectory = ( directory != "" ) ? 
-    fs.mkdir(directory.data()) : fs;
-  
-  saveValueAsHistogram(fitResultOutputDirectory, 
-		       effValue, effError, 
-		       "fitResult_%s_%s", 
-		       "%s Efficiency, obtained by fitting %s", 
+  saveValueAsHistogram(fitResults,
+		       effValue, effError,
+		       "fitResult_%s_%s",
+		       "%s Efficiency, obtained by fitting %s",
 		       fitVariable, tauId);
-  saveValueAsHistogram(fitResultOutputDirectory, 
-		       processEntries[processName_signal]->normFactors_[region_passed]->getVal() 
-		      + processEntries[processName_signal]->normFactors_[region_failed]->getVal(), 0.,
-		       "fitNorm_%s_%s", 
-		       "Fitted Number of Z #rightarrow #tau^{+} #tau^{-} Events in 'passed' + 'failed' regions", 
+  saveValueAsHistogram(fitResults,
+		       fitNormValue, 0.,
+		       "fitNorm_%s_%s",
+		       "Fitted Number of Z #rightarrow #tau^{+} #tau^{-} Events in 'passed' + 'failed' regions",
 		       fitVariable, tauId);
-  saveValueAsHistogram(fitResultOutputDirectory, 
+  saveValueAsHistogram(fitResults,
 		       processEntries[processName_signal]->fitParameters_["pTauId_passed_failed"].expectedValue_, 0.,
-		       "expResult_%s_%s", 
+		       "expResult_%s_%s",
 		       "Expected %s Efficiency",
 		       fitVariable, tauId);
-  saveValueAsHistogram(fitResultOutputDirectory, 
-		       processEntries[processName_signal]->numEvents_[region_passed][key_central_value] 
+  saveValueAsHistogram(fitResults,
+		       processEntries[processName_signal]->numEvents_[region_passed][key_central_value]
 		      + processEntries[processName_signal]->numEvents_[region_failed][key_central_value], 0.,
-		       "expNorm_%s_%s", 
+		       "expNorm_%s_%s",
 		       "Expected Number of Z #rightarrow #tau^{+} #tau^{-} Events in 'passed' + 'failed' regions",
 		       fitVariable, tauId);
- 
+  if ( runAsimovFit ) {
+    saveValueAsHistogram(fitResults,
+			 effValue_asimov, effError_asimov,
+			 "asimovResult_%s_%s",
+			 "Expected %s Efficiency and Uncertainty, obtained by fitting %s in Asimov dataset",
+			 fitVariable, tauId);
+    if ( runMinosAsimovFit ) {
+      saveValueAsHistogram(fitResults,
+			   effErrorLow_asimov, 0.,
+			   "asimovErrorLow_%s_%s",
+			   "Expected %s Efficiency Uncertainty (MINOS, negative), obtained by fitting %s in Asimov dataset",
+			   fitVariable, tauId);
+      saveValueAsHistogram(fitResults,
+			   effErrorHigh_asimov, 0.,
+			   "asimovErrorHigh_%s_%s",
+			   "Expected %s Efficiency Uncertainty (MINOS, positive), obtained by fitting %s in Asimov dataset",
+			   fitVariable, tauId);
+    }
+    if ( correlations_asimov ) {
+      TH2* histogramCorrelations = (TH2*)correlations_asimov->Clone(Form("asimovCorrelations_%s_%s", fitVariable.data(), tauId.data()));
+      histogramCorrelations->SetDirectory(0);
+      fitResults.push_back(histogramCorrelations);
+    }
+  }
+  if ( profileLikelihood ) fitResults.push_back(profileLikelihood);
+}
+
+//
+//-------------------------------------------------------------------------------
+//
+
+struct fitJobType
+{
+  fitJobType(const std::string& tauId, const std::string& fitVariable)
+    : tauId_(tauId),
+      fitVariable_(fitVariable),
+      pid_(-1),
+      hasSucceeded_(false),
+      plotQueue_(0)
+  {}
+  std::string tauId_;
+  std::string fitVariable_;
+  std::string fitResultFileName_; // temporary file in which worker process stores fit results
+  pid_t pid_;
+  bool hasSucceeded_;
+  std::vector<TObject*> fitResults_;
+  TauIdEffPlotQueue* plotQueue_;  // renders control plots made for this fit (not owned, may be shared with other fit jobs)
+};
+
+void waitForFitJob(std::map<pid_t, fitJobType*>& runningFitJobs)
+{
+//--- CV: wait only for the worker processes running fit jobs,
+//        in order not to reap the worker processes rendering control plots (cf. TauIdEffPlotQueue::waitForWorker)
+  while ( !runningFitJobs.empty() ) {
+    for ( std::map<pid_t, fitJobType*>::iterator fitJob = runningFitJobs.begin();
+	  fitJob != runningFitJobs.end(); ++fitJob ) {
+      int status = 0;
+      pid_t pid = waitpid(fitJob->first, &status, WNOHANG);
+      if ( pid == 0 ) continue; // CV: worker process still running
+      if ( pid < 0 ) {
+	if ( errno == EINTR ) continue;
+	throw cms::Exception("waitForFitJob")
+	  << "Failed to wait for worker process for tauId = " << fitJob->second->tauId_ << ", fitVariable = " << fitJob->second->fitVariable_ << ","
+	  << " errno = " << errno << " !!\n";
+      }
+      fitJob->second->hasSucceeded_ = (WIFEXITED(status) && WEXITSTATUS(status) == 0);
+      if ( !fitJob->second->hasSucceeded_ )
+	std::cerr << "Worker process for tauId = " << fitJob->second->tauId_ << ", fitVariable = " << fitJob->second->fitVariable_
+		  << " failed (status = " << status << ") !!" << std::endl;
+      runningFitJobs.erase(fitJob);
+      return;
+    }
+    usleep(10000);
+  }
+}
+
+void runFitJobs(const edm::ParameterSet& cfgFitTauIdEff, std::vector<fitJobType*>& fitJobs,
+		std::map<std::string, fitInputType>& fitInputs, unsigned numWorkers)
+{
+//--------------------------------------------------------------------------------
+// Run fits for all combinations of tau id. discriminators and fit variables.
+//
+// NOTE: in case numWorkers > 1, each fit is run by a forked worker process,
+//       which passes the fit results back to the main process via a temporary ROOT file.
+//--------------------------------------------------------------------------------
+
+//--- CV: a failing fit does not abort the remaining fits;
+//        failed fits are reported by the caller once all fits have been run
+  if ( numWorkers <= 1 ) {
+    for ( std::vector<fitJobType*>::iterator fitJob = fitJobs.begin();
+	  fitJob != fitJobs.end(); ++fitJob ) {
+      try {
+	fitTauIdEfficiency(cfgFitTauIdEff, (*fitJob)->tauId_, (*fitJob)->fitVariable_, fitInputs[(*fitJob)->tauId_], (*fitJob)->fitResults_,
+			   *(*fitJob)->plotQueue_);
+	(*fitJob)->hasSucceeded_ = true;
+      } catch ( cms::Exception& e ) {
+	std::cerr << e.what() << std::endl;
+      } catch ( std::exception& e ) {
+	std::cerr << e.what() << std::endl;
+      }
+      if ( !(*fitJob)->hasSucceeded_ )
+	std::cerr << "Fit for tauId = " << (*fitJob)->tauId_ << ", fitVariable = " << (*fitJob)->fitVariable_ << " failed !!" << std::endl;
+    }
+    return;
+  }
+
+  std::map<pid_t, fitJobType*> runningFitJobs;
+  for ( std::vector<fitJobType*>::iterator fitJob = fitJobs.begin();
+	fitJob != fitJobs.end(); ++fitJob ) {
+    while ( runningFitJobs.size() >= numWorkers ) {
+      waitForFitJob(runningFitJobs);
+    }
+
+//--- CV: flush output buffers before forking,
+//        to avoid output of main process getting printed again by worker process
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(0);
+
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+      throw cms::Exception("runFitJobs")
+	<< "Failed to start worker process for tauId = " << (*fitJob)->tauId_ << ", fitVariable = " << (*fitJob)->fitVariable_ << " !!\n";
+    } else if ( pid == 0 ) {
+      int exitStatus = 0;
+      try {
+	std::vector<TObject*> fitResults;
+	fitTauIdEfficiency(cfgFitTauIdEff, (*fitJob)->tauId_, (*fitJob)->fitVariable_, fitInputs[(*fitJob)->tauId_], fitResults,
+			   *(*fitJob)->plotQueue_);
+	TFile* fitResultFile = new TFile((*fitJob)->fitResultFileName_.data(), "RECREATE");
+	for ( std::vector<TObject*>::iterator fitResult = fitResults.begin();
+	      fitResult != fitResults.end(); ++fitResult ) {
+	  (*fitResult)->Write();
+	}
+	delete fitResultFile;
+//--- CV: wait for control plots of this fit to be rendered before exiting
+//       (the plots are rendered by worker processes started by this worker process)
+	(*fitJob)->plotQueue_->finish();
+      } catch ( cms::Exception& e ) {
+	std::cerr << e.what() << std::endl;
+	exitStatus = 1;
+      } catch ( std::exception& e ) {
+	std::cerr << e.what() << std::endl;
+	exitStatus = 1;
+      }
+      std::cout.flush();
+      std::cerr.flush();
+      fflush(0);
+//--- CV: use _exit, in order not to run destructors of objects owned by main process
+      _exit(exitStatus);
+    }
+    (*fitJob)->pid_ = pid;
+    runningFitJobs[pid] = (*fitJob);
+  }
+  while ( !runningFitJobs.empty() ) {
+    waitForFitJob(runningFitJobs);
+  }
+
+//--- read fit results from temporary files
+  for ( std::vector<fitJobType*>::iterator fitJob = fitJobs.begin();
+	fitJob != fitJobs.end(); ++fitJob ) {
+    if ( !(*fitJob)->hasSucceeded_ ) continue;
+    TFile* fitResultFile = new TFile((*fitJob)->fitResultFileName_.data());
+    if ( fitResultFile->IsZombie() ) {
+      std::cerr << "Failed to open file = " << (*fitJob)->fitResultFileName_ << " !!" << std::endl;
+      (*fitJob)->hasSucceeded_ = false;
+    } else {
+      TIter next(fitResultFile->GetListOfKeys());
+      while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+	TObject* fitResult = key->ReadObj();
+	if ( !fitResult ) continue;
+	if ( dynamic_cast<TH1*>(fitResult) ) dynamic_cast<TH1*>(fitResult)->SetDirectory(0);
+	(*fitJob)->fitResults_.push_back(fitResult);
+      }
+    }
+    delete fitResultFile;
+    gSystem->Unlink((*fitJob)->fitResultFileName_.data());
+  }
+}
+
+//
+//-------------------------------------------------------------------------------
+//
+
+int main(int argc, const char* argv[])
+{
+//--- parse command-line arguments
+  if ( argc < 2 ) {
+    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    return 0;
+  }
+
+  std::cout << "<fitTauIdEff>:" << std::endl;
+
+//--- disable pop-up windows showing graphics output
+  gROOT->SetBatch(true);
+
+//--- load framework libraries
+  gSystem->Load("libFWCoreFWLite");
+  AutoLibraryLoader::enable();
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("fitTauIdEff");
+
+//--- read python configuration parameters
+  if ( !edm::readPSetsFrom(argv[1])->existsAs<edm::ParameterSet>("process") )
+    throw cms::Exception("fitTauIdEff")
+      << "No ParameterSet 'process' found in configuration file = " << argv[1] << " !!\n";
+
+  edm::ParameterSet cfg = edm::readPSetsFrom(argv[1])->getParameter<edm::ParameterSet>("process");
+
+  edm::ParameterSet cfgFitTauIdEff = cfg.getParameter<edm::ParameterSet>("fitTauIdEff");
+
+//--- CV: lists of tau id. discriminators and fit variables take precedence over individual ones;
+//        fits for all combinations of tau id. discriminators and fit variables are run
+  vstring tauIds;
+  if ( cfgFitTauIdEff.exists("tauIds") ) tauIds = cfgFitTauIdEff.getParameter<vstring>("tauIds");
+  else tauIds.push_back(cfgFitTauIdEff.getParameter<std::string>("tauId"));
+
+  vstring fitVariables;
+  if ( cfgFitTauIdEff.exists("fitVariables") ) fitVariables = cfgFitTauIdEff.getParameter<vstring>("fitVariables");
+  else fitVariables.push_back(cfgFitTauIdEff.getParameter<std::string>("fitVariable"));
+
+  if ( tauIds.size() == 0 || fitVariables.size() == 0 )
+    throw cms::Exception("fitTauIdEff")
+      << "Configuration parameters 'tauIds' and 'fitVariables' must not be empty !!\n";
+
+  unsigned numWorkers = ( cfgFitTauIdEff.exists("numWorkers") ) ?
+    cfgFitTauIdEff.getParameter<unsigned>("numWorkers") : 1;
+
+//--- CV: number of worker processes used to render control plots in the background
+//       (0 = render control plots in the process running the fit);
+//        in case 'deferPlots' is enabled, control plots are not rendered at all,
+//        but stored in ROOT files, to be rendered later by the renderTauIdEffPlots executable
+  unsigned numPlotWorkers = ( cfgFitTauIdEff.exists("numPlotWorkers") ) ?
+    cfgFitTauIdEff.getParameter<unsigned>("numPlotWorkers") : 0;
+  bool deferPlots = ( cfgFitTauIdEff.exists("deferPlots") ) ?
+    cfgFitTauIdEff.getParameter<bool>("deferPlots") : false;
+  std::string controlPlotFilePath = cfgFitTauIdEff.getParameter<std::string>("controlPlotFilePath");
+
+  bool runClosureTest = cfgFitTauIdEff.getParameter<bool>("runClosureTest");
+
+//--- load histograms for all observables needed by fits of any fit variable
+  vstring observables;
+  vstring regionsToFit = cfgFitTauIdEff.getParameter<vstring>("regions");
+  vstring regionsToLoad = regionsToFit;
+  std::string region_passed = cfgFitTauIdEff.getParameter<std::string>("region_passed");
+  std::string region_failed = cfgFitTauIdEff.getParameter<std::string>("region_failed");
+  for ( vstring::const_iterator fitVariable = fitVariables.begin();
+	fitVariable != fitVariables.end(); ++fitVariable ) {
+    std::map<std::string, fitVariableType> fitVariables_regions;
+    vstring observables_fitVariable;
+    getFitVariables(regionsToFit, region_passed, region_failed, *fitVariable, fitVariables_regions, observables_fitVariable);
+    for ( vstring::const_iterator observable = observables_fitVariable.begin();
+	  observable != observables_fitVariable.end(); ++observable ) {
+      add_string_uniquely(observables, *observable);
+    }
+  }
+  if ( regionsToFit.size() == 6 ) {
+    add_string_uniquely(regionsToLoad, "C");    // needed to initialize probabilities
+    add_string_uniquely(regionsToLoad, "C1");   //  'pDiTauCharge_OS_SS', 'pMuonIso_tight_loose' and 'pDiTauKine_Sig_Bgr'
+    if ( runClosureTest )
+      add_string_uniquely(regionsToLoad, "A1"); // needed for QCD template
+  }
+
+  std::string regionQCDtemplate_passed = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_passed");
+  std::string regionQCDtemplate_failed = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_failed");
+  std::string regionQCDtemplate_D      = cfgFitTauIdEff.getParameter<std::string>("regionQCDtemplate_D");
+  vstring regionsQCDtemplate;
+  add_string_uniquely(regionsQCDtemplate, regionQCDtemplate_passed);
+  add_string_uniquely(regionsQCDtemplate, regionQCDtemplate_failed);
+  if ( regionQCDtemplate_D != "" ) add_string_uniquely(regionsQCDtemplate, regionQCDtemplate_D);
+
+  vstring sysUncertainties = cfgFitTauIdEff.getParameter<vstring>("sysUncertainties");
+  vstring sysUncertainties_expanded;
+  sysUncertainties_expanded.push_back(key_central_value);
+  for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
+	sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
+    sysUncertainties_expanded.push_back(std::string(*sysUncertainty).append("Up"));
+    sysUncertainties_expanded.push_back(std::string(*sysUncertainty).append("Down"));
+  }
+
+  bool fitIndividualProcesses = cfgFitTauIdEff.getParameter<bool>("fitIndividualProcesses");
+
+  bool runPseudoExperiments = cfgFitTauIdEff.getParameter<bool>("runPseudoExperiments");
+  unsigned numPseudoExperiments = cfgFitTauIdEff.getParameter<unsigned>("numPseudoExperiments");
+
+  fwlite::InputSource inputFiles(cfg);
+  if ( inputFiles.files().size() != 1 )
+    throw cms::Exception("fitTauIdEff")
+      << "Input file must be unique, got = " << format_vstring(inputFiles.files()) << " !!\n";
+  std::string histogramFileName = (*inputFiles.files().begin());
+
+  TFile* histogramInputFile = new TFile(histogramFileName.data());
+  std::string directory = cfgFitTauIdEff.getParameter<std::string>("directory");
+  TDirectory* histogramInputDirectory = ( directory != "" ) ?
+    dynamic_cast<TDirectory*>(histogramInputFile->Get(directory.data())) : histogramInputFile;
+  if ( !histogramInputDirectory )
+    throw cms::Exception("fitTauIdEff")
+      << "Directory = " << directory << " does not exists in input file = " << histogramFileName << " !!\n";
+  TauIdEffKeyCatalog histogramInputCatalog(histogramInputDirectory);
+
+  std::map<std::string, fitInputType> fitInputs; // key = tauId
+  for ( vstring::const_iterator tauId = tauIds.begin();
+	tauId != tauIds.end(); ++tauId ) {
+    loadFitInputs(fitInputs[*tauId], histogramInputCatalog, *tauId, fitIndividualProcesses, runClosureTest,
+		  regionsToLoad, regionsToFit, regionsQCDtemplate, observables, sysUncertainties_expanded);
+  }
+
+  fwlite::OutputFiles outputFile(cfg);
+
+//--- CV: control plots of all fit jobs are rendered by a single queue,
+//        so that at most 'numPlotWorkers' plots are rendered at the same time
+//       (each worker process running a fit uses its own copy of the queue);
+//        in case 'deferPlots' is enabled, each fit job stores its control plots in a separate file
+  std::vector<TauIdEffPlotQueue*> plotQueues;
+  if ( !deferPlots ) plotQueues.push_back(new TauIdEffPlotQueue(numPlotWorkers));
+
+  std::vector<fitJobType*> fitJobs;
+  for ( vstring::const_iterator tauId = tauIds.begin();
+	tauId != tauIds.end(); ++tauId ) {
+    for ( vstring::const_iterator fitVariable = fitVariables.begin();
+	  fitVariable != fitVariables.end(); ++fitVariable ) {
+      fitJobType* fitJob = new fitJobType(*tauId, *fitVariable);
+      std::string outputFileName = outputFile.file();
+      size_t idx = outputFileName.find_last_of('.');
+      fitJob->fitResultFileName_ = std::string(outputFileName, 0, idx);
+      fitJob->fitResultFileName_.append("_").append(*tauId).append("_").append(*fitVariable).append("_fitResults.root");
+      if ( deferPlots ) {
+	std::string plotInputFileName = controlPlotFilePath;
+	if ( plotInputFileName.find_last_of("/") != (plotInputFileName.length() - 1) ) plotInputFileName.append("/");
+	plotInputFileName.append("controlPlotsTauIdEff_");
+	plotInputFileName.append(*tauId).append("_").append(*fitVariable).append("_plotInputs.root");
+	plotQueues.push_back(new TauIdEffPlotQueue(numPlotWorkers, plotInputFileName));
+      }
+      fitJob->plotQueue_ = plotQueues.back();
+      fitJobs.push_back(fitJob);
+    }
+  }
+
+  runFitJobs(cfgFitTauIdEff, fitJobs, fitInputs, numWorkers);
+
+  delete histogramInputFile;
+
+//-- save fit results
+//  (the output file is closed when the TFileService goes out of scope,
+//   so that the fit results are available before rendering of the control plots has finished)
+  vstring failedFitJobs;
+  {
+    fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
+
+    TFileDirectory fitResultOutputDirectory = ( directory != "" ) ?
+      fs.mkdir(directory.data()) : fs;
+
+    for ( std::vector<fitJobType*>::const_iterator fitJob = fitJobs.begin();
+	  fitJob != fitJobs.end(); ++fitJob ) {
+      if ( !(*fitJob)->hasSucceeded_ ) {
+	failedFitJobs.push_back(std::string((*fitJob)->tauId_).append(":").append((*fitJob)->fitVariable_));
+	continue;
+      }
+      for ( std::vector<TObject*>::const_iterator fitResult = (*fitJob)->fitResults_.begin();
+	    fitResult != (*fitJob)->fitResults_.end(); ++fitResult ) {
+	if      ( dynamic_cast<TH2D*>(*fitResult)   ) fitResultOutputDirectory.make<TH2D>(*dynamic_cast<TH2D*>(*fitResult));
+	else if ( dynamic_cast<TH1F*>(*fitResult)   ) fitResultOutputDirectory.make<TH1F>(*dynamic_cast<TH1F*>(*fitResult));
+	else if ( dynamic_cast<TGraph*>(*fitResult) ) fitResultOutputDirectory.make<TGraph>(*dynamic_cast<TGraph*>(*fitResult));
+      }
+    }
+  }
+  std::cout << "fit results written to file = " << outputFile.file() << std::endl;
+
+//--- wait for control plots to be rendered
+  unsigned numPlotsFailed = 0;
+  for ( std::vector<TauIdEffPlotQueue*>::iterator plotQueue = plotQueues.begin();
+	plotQueue != plotQueues.end(); ++plotQueue ) {
+    numPlotsFailed += (*plotQueue)->finish();
+  }
+
 //--print time that it took macro to run
   std::cout << "finished executing fitTauIdEff macro:" << std::endl;
-  std::cout << " tauId  = " << tauId << std::endl;
-  std::cout << " fitVariable = " << fitVariable << std::endl;
+  std::cout << " tauIds = " << format_vstring(tauIds) << std::endl;
+  std::cout << " fitVariables = " << format_vstring(fitVariables) << std::endl;
   if ( runPseudoExperiments ) {
-    std::cout << " #sysUncertainties    = " << sysUncertainties.size() 
+    std::cout << " #sysUncertainties    = " << sysUncertainties.size()
 	      << " (numPseudoExperiments = " << numPseudoExperiments << ")" << std::endl;
   }
+  if ( numPlotsFailed > 0 ) std::cout << " #control plots failed to render = " << numPlotsFailed << std::endl;
   clock.Show("fitTauIdEff");
 
+  for ( std::vector<fitJobType*>::iterator it = fitJobs.begin();
+	it != fitJobs.end(); ++it ) {
+    delete (*it);
+  }
+  for ( std::vector<TauIdEffPlotQueue*>::iterator it = plotQueues.begin();
+	it != plotQueues.end(); ++it ) {
+    delete (*it);
+  }
+
+  if ( failedFitJobs.size() > 0 )
+    throw cms::Exception("fitTauIdEff")
+      << "Fits failed for (tauId:fitVariable) = " << format_vstring(failedFitJobs) << " !!\n";
+
   return 0;
 }
@@ -10,6 +10,7 @@
 
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
 #include "TauAnalysis/TauIdEfficiency/bin/tauFakeRateAuxFunctions.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffPlotQueue.h"
 
 #include <TFile.h>
 #include <TSystem.h>
@@ -142,6 +143,23 @@ int main(int argc, const char* argv[])
       
   std::string outputFileName = cfgMakeTauFakeRatePlots.getParameter<std::string>("outputFileName");
 
+//--- CV: number of worker processes used to render plots in the background
+//       (0 = render plots directly);
+//        in case 'deferPlots' is enabled, plots are not rendered at all,
+//        but stored in a ROOT file, to be rendered later by the renderTauIdEffPlots executable
+  unsigned numPlotWorkers = ( cfgMakeTauFakeRatePlots.exists("numPlotWorkers") ) ?
+    cfgMakeTauFakeRatePlots.getParameter<unsigned>("numPlotWorkers") : 0;
+  bool deferPlots = ( cfgMakeTauFakeRatePlots.exists("deferPlots") ) ?
+    cfgMakeTauFakeRatePlots.getParameter<bool>("deferPlots") : false;
+  std::string plotInputFileName;
+  if ( deferPlots ) {
+    std::string outputFilePath = getOutputFilePath(outputFileName);
+    gSystem->mkdir(outputFilePath.data(), true);
+    plotInputFileName = std::string(outputFilePath).append(getOutputFileName(outputFileName, "_plotInputs"));
+    plotInputFileName = std::string(plotInputFileName, 0, plotInputFileName.find_last_of('.')).append(".root");
+  }
+  TauIdEffPlotQueue plotQueue(numPlotWorkers, plotInputFileName);
+
   fwlite::InputSource inputFiles(cfg); 
   if ( inputFiles.files().size() != 1 ) 
     throw cms::Exception("makeTauFakeRatePlots") 
@@ -176,15 +194,15 @@ int main(int argc, const char* argv[])
 //--- make control plots 
 //    comparing jetPt, jetEta, jetPhi distributions observed in analyzed dataset to Monte Carlo predictions
   drawHistograms("jetPt", "P_{T}^{jet} / GeV", 
-		 canvas, histogramMap, processNamesSim, processNameData, drawOptionsProcesses,
+		 canvas, plotQueue, histogramMap, processNamesSim, processNameData, drawOptionsProcesses,
 		 eventSelectionsToPlot, tauIdsToPlot, regions, 
 		 labels, outputFileName);
   drawHistograms("jetEta", "#eta_{jet}", 
-		 canvas, histogramMap, processNamesSim, processNameData, drawOptionsProcesses,
+		 canvas, plotQueue, histogramMap, processNamesSim, processNameData, drawOptionsProcesses,
 		 eventSelectionsToPlot, tauIdsToPlot, regions, 
 		 labels, outputFileName);
   drawHistograms("jetPhi", "#phi_{jet}", 
-		 canvas, histogramMap, processNamesSim, processNameData, drawOptionsProcesses,
+		 canvas, plotQueue, histogramMap, processNamesSim, processNameData, drawOptionsProcesses,
 		 eventSelectionsToPlot, tauIdsToPlot, regions, 
 		 labels, outputFileName);
 
@@ -202,21 +220,21 @@ int main(int argc, const char* argv[])
     std::string label_eventSelection = drawOptionsEventSelections[*eventSelectionToPlot].legendEntry_;
     
     drawGraphs("jetPt", 8, 20., 100., "P_{T}^{jet} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
 	       *eventSelectionToPlot, labels, label_eventSelection, outputFileName);
     drawGraphs("jetEta", 25, -2.5, +2.5, "#eta_{jet} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
 	       *eventSelectionToPlot, labels, label_eventSelection, outputFileName);
     drawGraphs("jetPhi", 36, -TMath::Pi(), +TMath::Pi(), "#phi_{jet} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
 	       *eventSelectionToPlot, labels, label_eventSelection, outputFileName);
     
     drawGraphs("sumEt", 8, 100., 500., "#Sigma E_{T} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
 	       *eventSelectionToPlot, labels, label_eventSelection, outputFileName);
     
     drawGraphs("numVertices", 20, -0.5, 19.5, "Num. Vertices", 
-	       canvas, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, tauIdsToPlot, drawOptionsTauIds, 
 	       *eventSelectionToPlot, labels, label_eventSelection, outputFileName);
   }
 
@@ -234,30 +252,33 @@ int main(int argc, const char* argv[])
     std::string label_tauId = drawOptionsTauIds[*tauIdToPlot].legendEntry_;
     
     drawGraphs("jetPt", 8, 20., 100., "P_{T}^{jet} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
 	       *tauIdToPlot, labels, label_tauId, outputFileName);
     drawGraphs("jetEta", 25, -2.5, +2.5, "#eta_{jet} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
 	       *tauIdToPlot, labels, label_tauId, outputFileName);
     drawGraphs("jetPhi", 36, -TMath::Pi(), +TMath::Pi(), "#phi_{jet} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
 	       *tauIdToPlot, labels, label_tauId, outputFileName);
 
     drawGraphs("sumEt", 8, 100., 500., "#Sigma E_{T} / GeV", 
-	       canvas, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
 	       *tauIdToPlot, labels, label_tauId, outputFileName);
     
     drawGraphs("numVertices", 20, -0.5, 19.5, "Num. Vertices", 
-	       canvas, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
+	       canvas, plotQueue, frMapToPlot, "sum", processNameData, eventSelectionsToPlot, drawOptionsEventSelections, 
 	       *tauIdToPlot, labels, label_tauId, outputFileName);
   }
   
   delete canvas;
 
+  unsigned numPlotsFailed = plotQueue.finish();
+
 //--print time that it took macro to run
   std::cout << "finished executing makeTauFakeRatePlots macro:" << std::endl;
   std::cout << " #tauIdDiscr.   = " << tauIdsToPlot.size() << std::endl;
   std::cout << " #evtSelections = " << eventSelectionsToPlot.size() << std::endl;
+  if ( numPlotsFailed > 0 ) std::cout << " #plots failed to render = " << numPlotsFailed << std::endl;
   clock.Show("makeTauFakeRatePlots");
 
   return 0;
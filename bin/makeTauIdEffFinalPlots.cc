@@ -10,6 +10,7 @@
 
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
 #include "TauAnalysis/TauIdEfficiency/bin/tauIdEffAuxFunctions.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffPlotQueue.h"
 
 #include <TFile.h>
 #include <TSystem.h>
@@ -152,6 +153,21 @@ int main(int argc, const char* argv[])
 
   std::string outputFileName = cfgMakeTauIdEffPlots.getParameter<std::string>("outputFileName");
 
+//--- CV: number of worker processes used to render plots in the background
+//       (0 = render plots directly);
+//        in case 'deferPlots' is enabled, plots are not rendered at all,
+//        but stored in a ROOT file, to be rendered later by the renderTauIdEffPlots executable
+  unsigned numPlotWorkers = ( cfgMakeTauIdEffPlots.exists("numPlotWorkers") ) ?
+    cfgMakeTauIdEffPlots.getParameter<unsigned>("numPlotWorkers") : 0;
+  bool deferPlots = ( cfgMakeTauIdEffPlots.exists("deferPlots") ) ?
+    cfgMakeTauIdEffPlots.getParameter<bool>("deferPlots") : false;
+  std::string plotInputFileName;
+  if ( deferPlots ) {
+    plotInputFileName = std::string(outputFileName, 0, outputFileName.find_last_of('.'));
+    plotInputFileName.append("_plotInputs.root");
+  }
+  TauIdEffPlotQueue plotQueue(numPlotWorkers, plotInputFileName);
+
   fwlite::InputSource inputFiles(cfg); 
   if ( inputFiles.files().size() != 1 ) 
     throw cms::Exception("makeTauIdEffFinalPlots") 
@@ -185,6 +201,8 @@ int main(int argc, const char* argv[])
   bottomPad->SetBottomMargin(0.20);
   bottomPad->SetRightMargin(0.05);
   
+  std::map<std::string, TauIdEffKeyCatalog*> inputCatalogs; // key = directory
+
   for ( std::vector<std::string>::const_iterator fitVariable = fitVariables.begin();
 	fitVariable != fitVariables.end(); ++fitVariable ) {
 
@@ -207,20 +225,24 @@ int main(int argc, const char* argv[])
 	double binUpperEdge = xAxisBinning[binIdx + 1];
 	double binCenter  = 0.5*(binLowerEdge + binUpperEdge);
 
-	TDirectory* inputDirectory = ( tauIdValue->directory_ != "" ) ?
-	  dynamic_cast<TDirectory*>(inputFile->Get(tauIdValue->directory_.data())) : inputFile;
-	if ( !inputDirectory ) 
-	  throw cms::Exception("makeTauIdEffFinalPlots") 
-	    << "Directory = " << tauIdValue->directory_ << " does not exists in input file = " << inputFileName << " !!\n";
+	if ( inputCatalogs.find(tauIdValue->directory_) == inputCatalogs.end() ) {
+	  TDirectory* inputDirectory = ( tauIdValue->directory_ != "" ) ?
+	    dynamic_cast<TDirectory*>(inputFile->Get(tauIdValue->directory_.data())) : inputFile;
+	  if ( !inputDirectory ) 
+	    throw cms::Exception("makeTauIdEffFinalPlots") 
+	      << "Directory = " << tauIdValue->directory_ << " does not exists in input file = " << inputFileName << " !!\n";
+	  inputCatalogs[tauIdValue->directory_] = new TauIdEffKeyCatalog(inputDirectory);
+	}
+	TauIdEffKeyCatalog& inputCatalog = *inputCatalogs[tauIdValue->directory_];
 
 	std::string expEffName = std::string(expEff_label).append("_").append(*fitVariable).append("_").append(tauId->name_);
-	double expEff = getNumber(inputDirectory, expEffName.data(), 0).first;
+	double expEff = getNumber(inputCatalog, expEffName.data(), 0).first;
         expEffGraphs[tauId->name_]->SetPoint(binIdx, binCenter, expEff);
 	expEffGraphs[tauId->name_]->SetPointError(binIdx, 0.5*(binUpperEdge - binLowerEdge), 0.01);
 	
 	std::string measEffName = std::string(measEff_label).append("_").append(*fitVariable).append("_").append(tauId->name_);
-	double measEff = getNumber(inputDirectory, measEffName.data(), 0).first;
-	double measEffErr = getNumber(inputDirectory, measEffName.data(), 0).second;
+	double measEff = getNumber(inputCatalog, measEffName.data(), 0).first;
+	double measEffErr = getNumber(inputCatalog, measEffName.data(), 0).second;
 	measEffGraphs[tauId->name_]->SetPoint(binIdx, binCenter, measEff);
 	measEffGraphs[tauId->name_]->SetPointError(binIdx, 0.5*(binUpperEdge - binLowerEdge), measEffErr);
 
@@ -327,9 +349,8 @@ int main(int argc, const char* argv[])
     size_t idx = outputFileName.find_last_of('.');
     std::string outputFileName_plot = std::string(outputFileName, 0, idx);
     outputFileName_plot.append("_").append(*fitVariable);
-    if ( idx != std::string::npos ) canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName, idx)).data());
-    canvas->Print(std::string(outputFileName_plot).append(".png").data());
-    canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+    if ( idx != std::string::npos ) outputFileName_plot.append(std::string(outputFileName, idx));
+    plotQueue.addPlot(canvas, TauIdEffPlotQueue::getOutputFileNames(outputFileName_plot, ".png .pdf"));
 
     delete legend;
 
@@ -342,12 +363,20 @@ int main(int argc, const char* argv[])
   delete bottomPad;
   delete canvas;
 
+  for ( std::map<std::string, TauIdEffKeyCatalog*>::iterator it = inputCatalogs.begin();
+	it != inputCatalogs.end(); ++it ) {
+    delete it->second;
+  }
+
   delete inputFile;
 
+  unsigned numPlotsFailed = plotQueue.finish();
+
 //--print time that it took macro to run
   std::cout << "finished executing makeTauIdEffFinalPlots macro:" << std::endl;
   std::cout << " #tauIdDiscr.  = " << tauIds.size() << std::endl;
   std::cout << " #fitVariables = " << fitVariables.size() << std::endl;
+  if ( numPlotsFailed > 0 ) std::cout << " #plots failed to render = " << numPlotsFailed << std::endl;
   clock.Show("makeTauIdEffFinalPlots");
 
   return 0;
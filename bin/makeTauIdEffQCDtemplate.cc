@@ -24,6 +24,7 @@
 #include "DataFormats/FWLite/interface/OutputFiles.h"
 
 #include "TauAnalysis/TauIdEfficiency/bin/tauIdEffAuxFunctions.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffTemplateStore.h"
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
 
 #include <TROOT.h>
@@ -39,8 +40,8 @@
 #include <string>
 #include <vector>
 
-typedef std::map<std::string, std::map<std::string, TH1*> > histogramMap;
-typedef std::map<std::string, std::map<std::string, std::map<std::string, double> > > numEventsMap;
+typedef TauIdEffTemplateStore<TH1*> histogramStoreType;
+typedef TauIdEffTemplateStore<double> valueStoreType;
 
 struct regionEntryType
 {
@@ -58,7 +59,7 @@ struct regionEntryType
   ~regionEntryType() {}
 
   void makeQCDtemplate(TFileDirectory& dir, 
-		       histogramMap3& histograms_data, histogramMap4& histograms_mc, valueMap3& numEvents_mc)
+		       const histogramStoreType& histograms, const valueStoreType& numEvents)
   {
     //std::cout << "<regionEntryType::makeQCDtemplate>" << std::endl;
     //std::cout << " regionWplusJetsSideband = " << regionWplusJetsSideband_ << std::endl;
@@ -67,14 +68,14 @@ struct regionEntryType
     //std::cout << " sysUncertainty = " << sysUncertainty_ << std::endl;
 
     double numEventsWplusJetsSideband_data = 
-      getIntegral(histograms_data[regionWplusJetsSideband_]["EventCounter"][key_central_value], true, true);
+      getIntegral(histograms.get("Data", regionWplusJetsSideband_, "EventCounter", key_central_value), true, true);
     double numEventsWplusJetsSideband_expBgr = 
-      (numEvents_mc["ZplusJets"][regionWplusJetsSideband_][sysUncertainty_]
-     + numEvents_mc["QCD"][regionWplusJetsSideband_][sysUncertainty_]
-     + numEvents_mc["TTplusJets"][regionWplusJetsSideband_][sysUncertainty_]);
+      (numEvents.get("ZplusJets", regionWplusJetsSideband_, "EventCounter", sysUncertainty_)
+     + numEvents.get("QCD", regionWplusJetsSideband_, "EventCounter", sysUncertainty_)
+     + numEvents.get("TTplusJets", regionWplusJetsSideband_, "EventCounter", sysUncertainty_));
     double numEventsWplusJetsSideband_obsWplusJets = numEventsWplusJetsSideband_data - numEventsWplusJetsSideband_expBgr;
     double numEventsWplusJetsSideband_expWplusJets = 
-      numEvents_mc["WplusJets"][regionWplusJetsSideband_][sysUncertainty_];    
+      numEvents.get("WplusJets", regionWplusJetsSideband_, "EventCounter", sysUncertainty_);    
     //std::cout << "WplusJets sideband: observed = " << numEventsWplusJetsSideband_data << ","
     //	        << " expected background = " << numEventsWplusJetsSideband_expBgr 
     //	        << " --> observed WplusJets contribution = " << numEventsWplusJetsSideband_obsWplusJets << ","
@@ -82,10 +83,10 @@ struct regionEntryType
     
     double scaleFactorWplusJets = numEventsWplusJetsSideband_obsWplusJets/numEventsWplusJetsSideband_expWplusJets;
 
-    TH1* distributionDataQCDsideband = histograms_data[regionTakeQCDtemplateFromData_][fitVariable_][key_central_value];
-    TH1* templateZtautauQCDsideband = histograms_mc["ZplusJets"][regionTakeQCDtemplateFromData_][fitVariable_][sysUncertainty_];
-    TH1* templateWplusJetsQCDsideband = histograms_mc["WplusJets"][regionTakeQCDtemplateFromData_][fitVariable_][sysUncertainty_];
-    TH1* templateTTplusJetsQCDsideband = histograms_mc["TTplusJets"][regionTakeQCDtemplateFromData_][fitVariable_][sysUncertainty_];
+    TH1* distributionDataQCDsideband = histograms.get("Data", regionTakeQCDtemplateFromData_, fitVariable_, key_central_value);
+    TH1* templateZtautauQCDsideband = histograms.get("ZplusJets", regionTakeQCDtemplateFromData_, fitVariable_, sysUncertainty_);
+    TH1* templateWplusJetsQCDsideband = histograms.get("WplusJets", regionTakeQCDtemplateFromData_, fitVariable_, sysUncertainty_);
+    TH1* templateTTplusJetsQCDsideband = histograms.get("TTplusJets", regionTakeQCDtemplateFromData_, fitVariable_, sysUncertainty_);
 
     TString templateQCDsidebandName = distributionDataQCDsideband->GetName();    
     templateQCDsidebandName.ReplaceAll(Form("_%s_", regionTakeQCDtemplateFromData_.data()), Form("_%s_", regionStoreQCDtemplate_.data()));
@@ -184,6 +185,7 @@ int main(int argc, const char* argv[])
   if ( !histogramInputDirectory ) 
     throw cms::Exception("makeTauIdEffQCDtemplate") 
       << "Directory = " << directory << " does not exists in input file = " << histogramFileName << " !!\n";
+  TauIdEffKeyCatalog histogramInputCatalog(histogramInputDirectory);
 
   fwlite::OutputFiles outputFile(cfg);
   fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
@@ -253,30 +255,33 @@ int main(int argc, const char* argv[])
       }
     }
 
-    histogramMap4 histograms_mc; // key = (process, region, observable, central value/systematic uncertainty)
-    valueMap3 numEvents_mc; // key = (process, region, central value/systematic uncertainty)
+    histogramStoreType histograms; // key = (process, region, observable, central value/systematic uncertainty)
+    valueStoreType numEvents;      // key = (process, region, "EventCounter", central value/systematic uncertainty)
     for ( vstring::const_iterator process = processes.begin();
 	  process != processes.end(); ++process ) {
-      loadHistograms(histograms_mc[*process], histogramInputDirectory, 
+      histogramMap3 histograms_process;
+      loadHistograms(histograms_process, histogramInputCatalog, 
 		     *process, regions, *tauId, fitVariables, sysUncertainties_expanded, false, true);
+      histograms.setEntries(*process, histograms_process);
       
       for ( vstring::const_iterator region = regions.begin();
 	    region != regions.end(); ++region ) {
 	for ( vstring::const_iterator sysUncertainty = sysUncertainties_expanded.begin();
 	      sysUncertainty != sysUncertainties_expanded.end(); ++sysUncertainty ) {
-	  numEvents_mc[*process][*region][*sysUncertainty] = 
-	    getIntegral(histograms_mc[*process][*region]["EventCounter"][*sysUncertainty], true, true);
+	  numEvents.set(*process, *region, "EventCounter", *sysUncertainty,
+			getIntegral(histograms.get(*process, *region, "EventCounter", *sysUncertainty), true, true));
 	}
       }
     }
     
     histogramMap3 histograms_data; // key = (region, observable, key_central_value)
-    loadHistograms(histograms_data, histogramInputDirectory, 
+    loadHistograms(histograms_data, histogramInputCatalog, 
 		   "Data", regions, *tauId, fitVariables, sysUncertainties_data, false, false);
+    histograms.setEntries("Data", histograms_data);
 
     for ( std::vector<regionEntryType*>::iterator regionEntry = regionEntries.begin();
 	  regionEntry != regionEntries.end(); ++regionEntry ) {
-      (*regionEntry)->makeQCDtemplate(histogramOutputDirectory, histograms_data, histograms_mc, numEvents_mc);
+      (*regionEntry)->makeQCDtemplate(histogramOutputDirectory, histograms, numEvents);
     }
   }
 
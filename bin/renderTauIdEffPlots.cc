@@ -0,0 +1,133 @@
+
+/** \executable renderTauIdEffPlots
+ *
+ * Render plots stored by fitTauIdEff, makeTauIdEffFinalPlots and makeTauFakeRatePlots
+ * (run with deferPlots = True) into .eps/.png/.pdf files.
+ *
+ * The plots are rendered in parallel by 'numWorkers' worker processes.
+ *
+ */
+
+#include "FWCore/FWLite/interface/AutoLibraryLoader.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "DataFormats/FWLite/interface/InputSource.h"
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffPlotQueue.h"
+
+#include <TFile.h>
+#include <TSystem.h>
+#include <TROOT.h>
+#include <TBenchmark.h>
+#include <TKey.h>
+#include <TList.h>
+#include <TCanvas.h>
+#include <TObjString.h>
+
+#include <set>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+int main(int argc, const char* argv[])
+{
+//--- parse command-line arguments
+  if ( argc < 2 ) {
+    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    return 0;
+  }
+
+  std::cout << "<renderTauIdEffPlots>:" << std::endl;
+
+//--- disable pop-up windows showing graphics output
+  gROOT->SetBatch(true);
+
+//--- load framework libraries
+  gSystem->Load("libFWCoreFWLite");
+  AutoLibraryLoader::enable();
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("renderTauIdEffPlots");
+
+//--- read python configuration parameters
+  if ( !edm::readPSetsFrom(argv[1])->existsAs<edm::ParameterSet>("process") )
+    throw cms::Exception("renderTauIdEffPlots")
+      << "No ParameterSet 'process' found in configuration file = " << argv[1] << " !!\n";
+
+  edm::ParameterSet cfg = edm::readPSetsFrom(argv[1])->getParameter<edm::ParameterSet>("process");
+
+  edm::ParameterSet cfgRenderTauIdEffPlots = cfg.getParameter<edm::ParameterSet>("renderTauIdEffPlots");
+
+  unsigned numWorkers = ( cfgRenderTauIdEffPlots.exists("numWorkers") ) ?
+    cfgRenderTauIdEffPlots.getParameter<unsigned>("numWorkers") : 1;
+
+  fwlite::InputSource inputFiles(cfg);
+
+  TauIdEffPlotQueue plotQueue(numWorkers);
+
+  for ( std::vector<std::string>::const_iterator inputFileName = inputFiles.files().begin();
+	inputFileName != inputFiles.files().end(); ++inputFileName ) {
+    TFile* inputFile = TFile::Open(inputFileName->data());
+    if ( !inputFile || inputFile->IsZombie() )
+      throw cms::Exception("renderTauIdEffPlots")
+	<< "Failed to open inputFile = " << (*inputFileName) << " !!\n";
+
+    std::set<std::string> processedKeys;
+    TIter next(inputFile->GetListOfKeys());
+    while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+      if ( std::string(key->GetClassName()) != "TCanvas" ) continue;
+      // CV: skip older cycles of canvases that have been written multiple times
+      if ( processedKeys.find(key->GetName()) != processedKeys.end() ) continue;
+      processedKeys.insert(key->GetName());
+
+      std::string outputFileNamesKey = std::string(key->GetName()).append(TauIdEffPlotQueue::outputFileNamesSuffix());
+      TObjString* outputFileNames_object = dynamic_cast<TObjString*>(inputFile->Get(outputFileNamesKey.data()));
+      if ( !outputFileNames_object )
+	throw cms::Exception("renderTauIdEffPlots")
+	  << "Failed to find names of output files for plot = " << key->GetName() << " in inputFile = " << (*inputFileName) << " !!\n";
+
+      std::vector<std::string> outputFileNames;
+      std::istringstream outputFileNames_stream(outputFileNames_object->GetString().Data());
+      std::string outputFileName;
+      while ( std::getline(outputFileNames_stream, outputFileName) ) {
+	if ( outputFileName == "" ) continue;
+	outputFileNames.push_back(outputFileName);
+//--- CV: plots may be rendered on a different machine than the one on which they have been made,
+//        create output directories in case they do not exist
+	gSystem->mkdir(gSystem->DirName(outputFileName.data()), true);
+      }
+      delete outputFileNames_object;
+
+      TCanvas* canvas = dynamic_cast<TCanvas*>(key->ReadObj());
+      if ( !canvas )
+	throw cms::Exception("renderTauIdEffPlots")
+	  << "Failed to read plot = " << key->GetName() << " from inputFile = " << (*inputFileName) << " !!\n";
+      canvas->Draw();
+      plotQueue.addPlot(canvas, outputFileNames);
+      delete canvas;
+    }
+
+    delete inputFile;
+  }
+
+  unsigned numPlotsFailed = plotQueue.finish();
+
+//--print time that it took macro to run
+  std::cout << "finished executing renderTauIdEffPlots macro:" << std::endl;
+  std::cout << " #input files            = " << inputFiles.files().size() << std::endl;
+  std::cout << " #plots rendered         = " << (plotQueue.numPlots() - numPlotsFailed) << std::endl;
+  std::cout << " #plots failed to render = " << numPlotsFailed << std::endl;
+  clock.Show("renderTauIdEffPlots");
+
+  if ( numPlotsFailed > 0 )
+    throw cms::Exception("renderTauIdEffPlots")
+      << "Failed to render " << numPlotsFailed << " plot(s) !!\n";
+
+  return 0;
+}
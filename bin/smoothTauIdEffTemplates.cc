@@ -573,6 +573,7 @@ struct histogramEntryType
   if ( !histogramInputDirectory ) 
     throw cms::Exception("smoothTauIdEffTemplates") 
       << "Directory = " << directory << " does not exists in input file = " << histogramFileName << " !!\n";
+  TauIdEffKeyCatalog histogramInputCatalog(histogramInputDirectory);
 
   fwlite::OutputFiles outputFile(cfg);
   fwlite::TFileService fs = fwlite::TFileService(outputFile.file().data());
@@ -582,11 +583,15 @@ struct histogramEntryType
   
   for ( std::vector<histogramEntryType>::const_iterator inputHistogramEntry = inputHistogramEntries.begin();
 	inputHistogramEntry != inputHistogramEntries.end(); ++inputHistogramEntry ) {
-    // retrieve template histogram to be fitted from input file
+    // retrieve template histogram to be fitted from input file;
+    // histogram names are given relative to the top level of the input file,
+    // histograms stored in bundles are taken from the configured directory
     TH1* inputHistogram = dynamic_cast<TH1*>(histogramInputFile->Get(inputHistogramEntry->histogramName_.data()));
+    if ( !inputHistogram ) inputHistogram = dynamic_cast<TH1*>(histogramInputCatalog.get(inputHistogramEntry->histogramName_));
     if ( !inputHistogram ) 
       throw cms::Exception("smoothTauIdEffTemplates") 
-	<< "Failed to find histogram = " << inputHistogramEntry->histogramName_ << " in input file = " << histogramFileName << " !!\n";
+	<< "Failed to find histogram = " << inputHistogramEntry->histogramName_ << " in input file = " << histogramFileName << "," 
+	<< " neither at top level nor in directory = " << directory << " !!\n";
 
     // fit template histogram by analytic function;
     // store smoothed shape template in outputFile
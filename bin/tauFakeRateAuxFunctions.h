@@ -2,6 +2,8 @@
 #define TauAnalysis_TauIdEfficiency_tauFakeRateAuxFunctions_h
 
 #include "TauAnalysis/DQMTools/interface/histogramAuxFunctions.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffKeyCatalog.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffPlotQueue.h"
 
 #include "FWCore/Utilities/interface/Exception.h"
 
@@ -25,12 +27,18 @@
 #include <TSystem.h>
 #include <TMatrixD.h>
 
+#include <Math/QuantFuncMathCore.h>
+
 #include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <map>
 
+// CV: histograms are filled and summed once per job, outside of any event loop;
+//     their five-dimensional key (event selection, process, tau id. discriminator, observable, region)
+//     does not match TauIdEffTemplateStore, so nested maps are kept for the fake-rate tools
 typedef std::map<std::string, TH1*>               histogramMapType1;
 typedef std::map<std::string, histogramMapType1>  histogramMapType2;
 typedef std::map<std::string, histogramMapType2>  histogramMapType3;
@@ -235,6 +243,7 @@ void loadHistograms(
       throw cms::Exception("loadHistograms") 
 	<< "Failed to load histograms for event selection = " << (*eventSelection) << "," 
 	<< " directory = " << inputDirectoryName << " does not exists in input file = " << inputFile->GetName() << " !!\n";
+    TauIdEffKeyCatalog inputCatalog(inputDirectory); // CV: needed to read histograms stored in TauIdEffHistogramBundle format
     
     if ( avTriggerPrescales.find(*eventSelection) == avTriggerPrescales.end() ) 
       throw cms::Exception("loadHistograms") 
@@ -253,7 +262,7 @@ void loadHistograms(
 	    std::string histogramName = std::string(*process).append("_").append(*region).append("_").append(*observable);
 	    histogramName.append("_").append(*tauId);
 	    
-	    TH1* histogram = dynamic_cast<TH1*>(inputDirectory->Get(histogramName.data()));
+	    TH1* histogram = dynamic_cast<TH1*>(inputCatalog.get(histogramName));
 	    if ( !histogram ) {
 	      throw cms::Exception("loadHistograms") 
 		<< "Failed to load histogram = " << histogramName << " from directory = " << inputDirectory->GetName() << " !!\n";
@@ -278,6 +287,12 @@ void loadHistograms(
 //-------------------------------------------------------------------------------
 //
 
+//--- cache bounds computed for (n, r) pairs of previous calls,
+//    as the same (integer) numbers of entries occur repeatedly in different bins and histograms
+//   (key = (n, r), value = (rMin, rMax))
+typedef std::map<std::pair<Int_t, Int_t>, std::pair<Float_t, Float_t> > binomialBoundsCacheType;
+binomialBoundsCacheType binomialBoundsCache;
+
 void getBinomialBounds(Int_t n, Int_t r, Float_t& rMin, Float_t& rMax)
 {
   //std::cout << "<getBinomialBounds>:" << std::endl;
@@ -300,64 +315,52 @@ void getBinomialBounds(Int_t n, Int_t r, Float_t& rMin, Float_t& rMax)
     return;
   }
 
-  Double_t rMinLeft       = 0.;
-  Double_t rMinMiddle     = TMath::Max(0.5*r, n - 1.5*r);
-  Double_t rMinRight      = n;
-  Double_t rMinLeftProb   = 0.;
-  Double_t rMinMiddleProb = 0.5;
-  Double_t rMinRightProb  = 1.;
-  while ( (rMinRight - rMinLeft) > (0.001*n) ){
-
-    rMinMiddleProb = TMath::BinomialI(rMinMiddle/n, n, r);
-
-    if ( rMinMiddleProb > 0.16 ){
-      rMinRight     = rMinMiddle;
-      rMinRightProb = rMinMiddleProb;
-    } else if ( rMinMiddleProb < 0.16 ){
-      rMinLeft      = rMinMiddle;
-      rMinLeftProb  = rMinMiddleProb;
-    } else {
-      rMinLeft      = rMinRight     = rMinMiddle;
-      rMinLeftProb  = rMinRightProb = rMinMiddleProb;
-    }
-
-    rMinMiddle = 0.5*(rMinLeft + rMinRight);
-
-    if ( rMinLeft > r ){
-      rMinMiddle = rMinLeft = rMinRight = 0.;
-    }
+  std::pair<Int_t, Int_t> key(n, r);
+  binomialBoundsCacheType::const_iterator cacheEntry = binomialBoundsCache.find(key);
+  if ( cacheEntry != binomialBoundsCache.end() ){
+    rMin = cacheEntry->second.first;
+    rMax = cacheEntry->second.second;
+    return;
   }
 
-  Double_t rMaxLeft       = 0.;
-  Double_t rMaxMiddle     = TMath::Min(1.5*r, n - 0.5*r);
-  Double_t rMaxRight      = n;
-  Double_t rMaxLeftProb   = 1.;
-  Double_t rMaxMiddleProb = 0.5;
-  Double_t rMaxRightProb  = 0.;
-  while ( (rMaxRight - rMaxLeft) > (0.001*n) ){
-
-    rMaxMiddleProb = 1. - TMath::BinomialI(rMaxMiddle/n, n, r);
-
-    if ( rMaxMiddleProb > 0.16 ){
-      rMaxLeft      = rMaxMiddle;
-      rMaxLeftProb  = rMaxMiddleProb;
-    } else if ( rMaxMiddleProb < 0.16 ){
-      rMaxRight     = rMaxMiddle;
-      rMaxRightProb = rMaxMiddleProb;
-    } else {
-      rMaxLeft      = rMaxRight     = rMaxMiddle;
-      rMaxLeftProb  = rMaxRightProb = rMaxMiddleProb;
-    }
+//--- lower (upper) bound is given by the value of p for which
+//    the probability to observe r or more entries out of n, TMath::BinomialI(p, n, r), equals 0.16 (0.84).
+//    As TMath::BinomialI(p, n, r) is the regularized incomplete beta function I_p(r, n - r + 1),
+//    the bounds are obtained from the quantiles of the beta distribution directly,
+//    instead of searching for them by bisection.
+//
+//    NOTE: bounds are set to zero (n) in case the lower (upper) bound is above (below) r,
+//          as done by the bisection used previously
+//
+  if ( r == 0 ){
+    rMin = 0.;
+    rMax = 0.;
+  } else if ( r > n ){
+    rMin = n;
+    rMax = n;
+  } else {
+    Double_t pMin = ROOT::Math::beta_quantile(0.16, r, n - r + 1);
+    rMin = ( (pMin*n) > r ) ? 0. : pMin*n;
+    Double_t pMax = ROOT::Math::beta_quantile(0.84, r, n - r + 1);
+    rMax = ( (pMax*n) < r ) ? n : pMax*n;
+  }
 
-    rMaxMiddle = 0.5*(rMaxLeft + rMaxRight);
+  binomialBoundsCache[key] = std::pair<Float_t, Float_t>(rMin, rMax);
+}
 
-    if ( rMaxRight < r ){
-      rMaxMiddle = rMaxLeft = rMaxRight = n;
-    }
+void getBinomialBounds(const std::vector<Int_t>& n, const std::vector<Int_t>& r, 
+		       std::vector<Float_t>& rMin, std::vector<Float_t>& rMax)
+{
+  if ( n.size() != r.size() )
+    throw cms::Exception("getBinomialBounds") 
+      << "Size of arrays n = " << n.size() << " and r = " << r.size() << " passed as function arguments does not match !!\n";
+
+  size_t numPoints = n.size();
+  rMin.resize(numPoints);
+  rMax.resize(numPoints);
+  for ( size_t iPoint = 0; iPoint < numPoints; ++iPoint ){
+    getBinomialBounds(n[iPoint], r[iPoint], rMin[iPoint], rMax[iPoint]);
   }
-
-  rMin = rMinMiddle;
-  rMax = rMaxMiddle;
 }
 
 TGraphAsymmErrors* getEfficiency(const TH1* histogram_numerator, const TH1* histogram_denominator,
@@ -383,6 +386,8 @@ TGraphAsymmErrors* getEfficiency(const TH1* histogram_numerator, const TH1* hist
   TArrayF dyUp(nBins);
   TArrayF dyDown(nBins);
 
+  std::vector<Int_t> nObs(nBins);
+  std::vector<Int_t> rObs(nBins);
   for ( Int_t iBin = 1; iBin <= nBins; iBin++ ){
     Float_t nObs_float = histogram_denominator->GetBinContent(iBin);
     Float_t rObs_float = histogram_numerator->GetBinContent(iBin);
@@ -394,9 +399,16 @@ TGraphAsymmErrors* getEfficiency(const TH1* histogram_numerator, const TH1* hist
       rObs_float *= scaleFactor;
     }
 
-    Int_t nObs = TMath::Nint(nObs_float);
-    Int_t rObs = TMath::Nint(rObs_float);
+    nObs[iBin - 1] = TMath::Nint(nObs_float);
+    rObs[iBin - 1] = TMath::Nint(rObs_float);
+  }
+
+//--- compute bounds for all bins at once
+  std::vector<Float_t> rMin;
+  std::vector<Float_t> rMax;
+  getBinomialBounds(nObs, rObs, rMin, rMax);
 
+  for ( Int_t iBin = 1; iBin <= nBins; iBin++ ){
     Float_t xCenter = histogram_denominator->GetBinCenter(iBin);
     Float_t xWidth  = histogram_denominator->GetBinWidth(iBin);
 
@@ -404,15 +416,12 @@ TGraphAsymmErrors* getEfficiency(const TH1* histogram_numerator, const TH1* hist
     dxUp[iBin - 1]   = 0.5*xWidth;
     dxDown[iBin - 1] = 0.5*xWidth;
     
-    if ( nObs > 0 ){
-      Float_t rMin = 0.;
-      Float_t rMax = 0.;
-      
-      getBinomialBounds(nObs, rObs, rMin, rMax);
-
-      y[iBin - 1]      = rObs/((Float_t)nObs);
-      dyUp[iBin - 1]   = (rMax - rObs)/((Float_t)nObs);
-      dyDown[iBin - 1] = (rObs - rMin)/((Float_t)nObs);
+    Int_t n = nObs[iBin - 1];
+    Int_t r = rObs[iBin - 1];
+    if ( n > 0 ){
+      y[iBin - 1]      = r/((Float_t)n);
+      dyUp[iBin - 1]   = (rMax[iBin - 1] - r)/((Float_t)n);
+      dyDown[iBin - 1] = (r - rMin[iBin - 1])/((Float_t)n);
     } else{
       y[iBin - 1]      = 0.;
       dyUp[iBin - 1]   = 0.;
@@ -619,7 +628,7 @@ std::string getOutputFileName(const std::string& outputFileName, const std::stri
 
 void drawHistograms(
   const std::string& observable, const std::string& xAxisTitle,
-  TCanvas* canvas, histogramMapType5& histogramMap, 
+  TCanvas* canvas, TauIdEffPlotQueue& plotQueue, histogramMapType5& histogramMap, 
   const vstring& processNamesSim, const std::string& processNameData, std::map<std::string, histogramDrawOptionType>& drawOptions,
   const vstring& eventSelectionsToPlot, const vstring& tauIdsToPlot, const vstring& regionsToPlot,
   const vstring& labels, const std::string& outputFileName)
@@ -687,12 +696,7 @@ void drawHistograms(
 	std::string suffix = std::string("_").append(*eventSelection).append("_").append(*tauId).append("_").append(*region);
 	suffix.append("_").append(observable);
 	std::string outputFileName_full = std::string(outputFilePath).append(getOutputFileName(outputFileName, suffix));
-	size_t idx = outputFileName_full.find_last_of('.');
-	std::string outputFileName_plot = std::string(outputFileName_full, 0, idx);
-	if ( idx != std::string::npos ) 
-	  canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName_full, idx)).data());
-	canvas->Print(std::string(outputFileName_plot).append(".png").data());
-	canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+	plotQueue.addPlot(canvas, TauIdEffPlotQueue::getOutputFileNames(outputFileName_full, ".png .pdf"));
 
 	for ( std::vector<TPaveText*>::iterator it = labels_text.begin();
 	      it != labels_text.end(); ++it ) {
@@ -705,7 +709,7 @@ void drawHistograms(
 
 void drawGraphs(
   const std::string& observable, int numBinsX, double xMin, double xMax, const std::string& xAxisTitle,
-  TCanvas* canvas, frMapType3& frMapToPlot, 
+  TCanvas* canvas, TauIdEffPlotQueue& plotQueue, frMapType3& frMapToPlot, 
   const std::string& processNameSim, const std::string& processNameData, 
   const vstring& graphsToPlot, std::map<std::string, graphDrawOptionType>& drawOptions,
   const std::string& plotName, const vstring& labels, const std::string& addPlotLabel, const std::string& outputFileName)
@@ -895,12 +899,7 @@ void drawGraphs(
   gSystem->mkdir(outputFilePath.data(), true);
   std::string suffix = std::string("_fr").append(plotName).append("_").append(observable);
   std::string outputFileName_full = std::string(outputFilePath).append(getOutputFileName(outputFileName, suffix));
-  size_t idx = outputFileName_full.find_last_of('.');
-  std::string outputFileName_plot = std::string(outputFileName_full, 0, idx);
-  if ( idx != std::string::npos ) 
-    canvas->Print(std::string(outputFileName_plot).append(std::string(outputFileName_full, idx)).data());
-  canvas->Print(std::string(outputFileName_plot).append(".png").data());
-  canvas->Print(std::string(outputFileName_plot).append(".pdf").data());
+  plotQueue.addPlot(canvas, TauIdEffPlotQueue::getOutputFileNames(outputFileName_full, ".png .pdf"));
 
   for ( std::vector<TPaveText*>::iterator it = labels_text.begin();
 	it != labels_text.end(); ++it ) {
@@ -3,6 +3,7 @@
 
 #include "TauAnalysis/DQMTools/interface/histogramAuxFunctions.h"
 #include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffKeyCatalog.h"
 
 #include "FWCore/Utilities/interface/Exception.h"
 
@@ -18,6 +19,7 @@
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <map>
 #include <time.h>
 
 typedef std::map<std::string, TH1*> histogramMap1;
@@ -180,14 +182,57 @@ std::string getTauIdValue(const std::string& region)
   return retVal;
 }
 
+std::string getHistogramName(const std::string& process, const std::string& region, const std::string& observable,
+			     const std::string& tauId, const std::string& sysUncertainty, const std::string& genMatch = "")
+{
+  std::string tauIdValue = getTauIdValue(region);
+
+  std::string histogramName = std::string(process).append("_").append(region).append("_").append(observable);
+  histogramName.append("_").append(tauId).append("_").append(tauIdValue);
+  if ( sysUncertainty != key_central_value ) histogramName.append("_").append(sysUncertainty);
+  if ( genMatch       != ""                ) histogramName.append("_").append(genMatch);
+  
+  // CV: switch to smoothed histograms if requested
+  //    (for now the combinations of processes + regions for which template smoothing is applied
+  //     is hardcoded here... this is to be changed later)
+  if ( (process == "WplusJets" && (genMatch == "" || genMatch == "JetToTauFake") && 
+	(observable == "diTauVisMass" || observable == "diTauMt") &&
+	(region == "A" || region == "A_mW" || region == "A_mW" || 
+	 region == "B" ||
+	 region == "C1p" || region == "C1f" ||
+	 region == "D")) ||
+       (process == "QCD" && 
+	(observable == "diTauVisMass" || observable == "diTauMt") &&
+	(region == "A" || region == "A_mW" || region == "A_mW" || 
+	 region == "B")) ) {
+    histogramName.append("_smoothed");
+    histogramName.append("__x"); // CV: this suffix is added by RooFit when running smoothTauIdEffTemplates macro
+  }
+
+  return histogramName;
+}
+
+//
+//-------------------------------------------------------------------------------
+//
+
+struct histogramEntryType 
+{
+  std::string region_;
+  std::string observable_;
+  std::string sysUncertainty_;
+  std::string histogramName_;
+};
+
 void loadHistograms(histogramMap3& histogramMap,
-		    TDirectory* inputDirectory, const std::string& process, const vstring& regions,
+		    TauIdEffKeyCatalog& inputCatalog, const std::string& process, const vstring& regions,
 		    const std::string& tauId, 
 		    const vstring& fitVariables, 
 		    const vstring& sysUncertainties, bool allowRebinning, bool applySmoothing, const std::string& genMatch = "")
 {
 //--------------------------------------------------------------------------------
 // Load template histograms/distributions observed in data from ROOT file
+// (the catalog is built once per input directory by the caller and shared by all calls)
 //--------------------------------------------------------------------------------
 
   std::cout << "<loadHistograms>:" << std::endl;
@@ -197,85 +242,84 @@ void loadHistograms(histogramMap3& histogramMap,
   std::cout << " fitVariables = " << format_vstring(fitVariables) << std::endl;
   std::cout << " sysUncertainties = " << format_vstring(sysUncertainties) << std::endl;
   std::cout << " genMatch = " << genMatch << std::endl;
+
+//--- build names of all histograms to be loaded first,
+//    then read them from the file in one pass
+  std::vector<histogramEntryType> histogramEntries;
   
   for ( vstring::const_iterator region = regions.begin();
 	region != regions.end(); ++region ) {
 
     vstring observables = getObservables(*region, fitVariables);
     add_string_uniquely(observables, "EventCounter"); // CV: for normalization purposes, always add 'EventCounter'
-    std::string tauIdValue = getTauIdValue(*region);
 
     for ( vstring::const_iterator observable = observables.begin();
 	  observable != observables.end(); ++observable ) {
       for ( vstring::const_iterator sysUncertainty = sysUncertainties.begin();
 	    sysUncertainty != sysUncertainties.end(); ++sysUncertainty ) {
 
-	std::string histogramName = std::string(process).append("_").append(*region).append("_").append(*observable);
-	histogramName.append("_").append(tauId).append("_").append(tauIdValue);
-	if ( (*sysUncertainty) != key_central_value ) histogramName.append("_").append(*sysUncertainty);
-	if (   genMatch        != ""                ) histogramName.append("_").append(genMatch);
-	
-	// CV: switch to smoothed histograms if requested
-	//    (for now the combinations of processes + regions for which template smoothing is applied
-	//     is hardcoded here... this is to be changed later)
-	if ( (process == "WplusJets" && (genMatch == "" || genMatch == "JetToTauFake") && 
-	      ((*observable) == "diTauVisMass" || (*observable) == "diTauMt") &&
-	      ((*region) == "A" || (*region) == "A_mW" || (*region) == "A_mW" || 
-	       (*region) == "B" ||
-	       (*region) == "C1p" || (*region) == "C1f" ||
-	       (*region) == "D")) ||
-	     (process == "QCD" && 
-	      ((*observable) == "diTauVisMass" || (*observable) == "diTauMt") &&
-	      ((*region) == "A" || (*region) == "A_mW" || (*region) == "A_mW" || 
-	       (*region) == "B")) ) {
-	  histogramName.append("_smoothed");
-	  histogramName.append("__x"); // CV: this suffix is added by RooFit when running smoothTauIdEffTemplates macro
-	}
+	std::string histogramName = getHistogramName(process, *region, *observable, tauId, *sysUncertainty, genMatch);
 
 	if ( histogramMap[*region][*observable].find(*sysUncertainty) != histogramMap[*region][*observable].end() ) {
 	  std::cout << "Warning in <loadHistograms>:" 
 		    << " histogram = " << histogramName << " already exists --> skipping !!" << std::endl;
 	  continue;
 	}
+
+	histogramEntryType histogramEntry;
+	histogramEntry.region_ = (*region);
+	histogramEntry.observable_ = (*observable);
+	histogramEntry.sysUncertainty_ = (*sysUncertainty);
+	histogramEntry.histogramName_ = histogramName;
+	histogramEntries.push_back(histogramEntry);
 	
-	TH1* histogram = dynamic_cast<TH1*>(inputDirectory->Get(histogramName.data()));
-	if ( !histogram ) {
-	  std::cout << "available histograms:" << std::endl;
-	  inputDirectory->ls();
-	  throw cms::Exception("loadHistograms")  
-	    << "Failed to load histogram = " << histogramName << " from file/directory = " << inputDirectory->GetName() << " !!\n";
-	}
-	
-	// CV: rebin histograms to avoid problem with too low Monte Carlo event statistics
-	//     and large pile-up reweighting factors in Spring'12 MC production
-	//if ( allowRebinning ) {
-	//  int numBins = histogram->GetNbinsX();
-	//  if      ( (numBins % 2) == 0 ) histogram->Rebin(2);
-	//  else if ( (numBins % 3) == 0 ) histogram->Rebin(3);
-	//}
-	
-	// CV: check that contents of all bins are positive,
-	//     print warning if not
-	int numBins = histogram->GetNbinsX();
-	for ( int iBin = 0; iBin <= (numBins + 1); ++iBin ) {
-	  double binContent = histogram->GetBinContent(iBin);
-	  if ( binContent < 0. ) {
-	    double x = histogram->GetBinCenter(iBin);
-	    std::cout << "Warning in <loadHistograms>:" 
-		      << " histogram = " << histogramName << ":" 
-		      << " bin(x = " << x << ") = " << binContent << " --> setting it to 0." << std::endl;
-	    histogram->SetBinContent(iBin, 0.);
-	  }
-	}
+	inputCatalog.request(histogramName);
+      }
+    }
+  }
+
+  inputCatalog.loadRequested();
+
+  for ( std::vector<histogramEntryType>::const_iterator histogramEntry = histogramEntries.begin();
+	histogramEntry != histogramEntries.end(); ++histogramEntry ) {
+    const std::string& histogramName = histogramEntry->histogramName_;
+
+    TH1* histogram = dynamic_cast<TH1*>(inputCatalog.get(histogramName));
+    if ( !histogram ) {
+      std::cout << "available histograms:" << std::endl;
+      inputCatalog.getDirectory()->ls();
+      throw cms::Exception("loadHistograms")  
+	<< "Failed to load histogram = " << histogramName << " from file/directory = " << inputCatalog.getDirectory()->GetName() << " !!\n";
+    }
 	
-	if ( histogram != 0 ) {
-	  histogramMap[*region][*observable][*sysUncertainty] = histogram;
-	  std::cout << "histogramMap[region = " << (*region) << "][observable = " << (*observable) << "]" 
-		    << "[sysUncertainty = " << (*sysUncertainty) << "] = " << histogram << std::endl;
-	  std::cout << " (name = " << histogram->GetName() << ", integral = " << histogram->Integral() << ")" << std::endl;
-	}
+    // CV: rebin histograms to avoid problem with too low Monte Carlo event statistics
+    //     and large pile-up reweighting factors in Spring'12 MC production
+    //if ( allowRebinning ) {
+    //  int numBins = histogram->GetNbinsX();
+    //  if      ( (numBins % 2) == 0 ) histogram->Rebin(2);
+    //  else if ( (numBins % 3) == 0 ) histogram->Rebin(3);
+    //}
+    
+    // CV: check that contents of all bins are positive,
+    //     print warning if not
+    int numBins = histogram->GetNbinsX();
+    for ( int iBin = 0; iBin <= (numBins + 1); ++iBin ) {
+      double binContent = histogram->GetBinContent(iBin);
+      if ( binContent < 0. ) {
+	double x = histogram->GetBinCenter(iBin);
+	std::cout << "Warning in <loadHistograms>:" 
+		  << " histogram = " << histogramName << ":" 
+		  << " bin(x = " << x << ") = " << binContent << " --> setting it to 0." << std::endl;
+	histogram->SetBinContent(iBin, 0.);
       }
     }
+    
+    if ( histogram != 0 ) {
+      histogramMap[histogramEntry->region_][histogramEntry->observable_][histogramEntry->sysUncertainty_] = histogram;
+      std::cout << "histogramMap[region = " << histogramEntry->region_ << "][observable = " << histogramEntry->observable_ << "]" 
+		<< "[sysUncertainty = " << histogramEntry->sysUncertainty_ << "] = " << histogram << std::endl;
+      std::cout << " (name = " << histogram->GetName() << ", integral = " << histogram->Integral() << ")" << std::endl;
+    }
   }
 }
 
@@ -283,19 +327,9 @@ void loadHistograms(histogramMap3& histogramMap,
 //-------------------------------------------------------------------------------
 //
 
-std::pair<double, double> getNumber(TDirectory* inputDirectory, const TString& auxHistogramName, 
-				    int auxHistogramBin, int assertAuxHistogramNumBins = 1)
+std::pair<double, double> getNumber(TH1* histogram, const TString& auxHistogramName, 
+				    int auxHistogramBin, int assertAuxHistogramNumBins)
 {
-  //std::cout << "<getNumber>:" << std::endl;
-  //std::cout << " auxHistogramName = " << auxHistogramName << std::endl;
-  //std::cout << " auxHistogramBin = " << auxHistogramBin << std::endl;
-  //std::cout << " assertAuxHistogramNumBins = " << assertAuxHistogramNumBins << std::endl;
-
-  TH1* histogram = dynamic_cast<TH1*>(inputDirectory->Get(auxHistogramName.Data()));
-  if ( !histogram ) 
-    throw cms::Exception("getNumber")  
-      << "Failed to find histogram = " << auxHistogramName << " in input file/directory = " << inputDirectory->GetName() << " !!\n";
-  
   int numBins = histogram->GetNbinsX();
   // CV: check that histogram has the expected number of bins,
   //     if it hasn't, FWLiteTauIdEffPreselNumbers/TauIdEffCutFlowTable has probably changed
@@ -324,6 +358,45 @@ std::pair<double, double> getNumber(TDirectory* inputDirectory, const TString& a
   return retVal;
 }
 
+std::pair<double, double> getNumber(TDirectory* inputDirectory, const TString& auxHistogramName, 
+				    int auxHistogramBin, int assertAuxHistogramNumBins = 1)
+{
+  //std::cout << "<getNumber>:" << std::endl;
+  //std::cout << " auxHistogramName = " << auxHistogramName << std::endl;
+  //std::cout << " auxHistogramBin = " << auxHistogramBin << std::endl;
+  //std::cout << " assertAuxHistogramNumBins = " << assertAuxHistogramNumBins << std::endl;
+
+  TH1* histogram = dynamic_cast<TH1*>(inputDirectory->Get(auxHistogramName.Data()));
+  if ( !histogram ) 
+    throw cms::Exception("getNumber")  
+      << "Failed to find histogram = " << auxHistogramName << " in input file/directory = " << inputDirectory->GetName() << " !!\n";
+
+  return getNumber(histogram, auxHistogramName, auxHistogramBin, assertAuxHistogramNumBins);
+}
+
+std::pair<double, double> getNumber(TauIdEffKeyCatalog& inputCatalog, const TString& auxHistogramName, 
+				    int auxHistogramBin, int assertAuxHistogramNumBins = 1)
+{
+  TH1* histogram = dynamic_cast<TH1*>(inputCatalog.get(auxHistogramName.Data()));
+  if ( !histogram ) 
+    throw cms::Exception("getNumber")  
+      << "Failed to find histogram = " << auxHistogramName << " in input file/directory = " << inputCatalog.getDirectory()->GetName() << " !!\n";
+
+  return getNumber(histogram, auxHistogramName, auxHistogramBin, assertAuxHistogramNumBins);
+}
+
+void loadNumbers(TauIdEffKeyCatalog& inputCatalog, const vstring& auxHistogramNames)
+{
+//--- read histograms from which numbers are retrieved by getNumber in one pass,
+//    ordered by their position in the file
+//   (histograms not contained in the directory are skipped here and reported by getNumber)
+  for ( vstring::const_iterator auxHistogramName = auxHistogramNames.begin();
+	auxHistogramName != auxHistogramNames.end(); ++auxHistogramName ) {
+    inputCatalog.request(*auxHistogramName);
+  }
+  inputCatalog.loadRequested();
+}
+
 //
 //-------------------------------------------------------------------------------
 //
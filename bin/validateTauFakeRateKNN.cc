@@ -0,0 +1,472 @@
+
+/** \executable validateTauFakeRateKNN
+ *
+ * Check that k-NearestNeighbour tree storing fake-rates has been filled correctly,
+ * by comparing the fraction of jets passing the tau id. discriminator
+ * to the average k-NN fake-rate weight, as function of jet Pt, eta and width.
+ *
+ * NOTE: replaces macros/validateTauFakeRateKNN.C
+ *       All variables are filled in a single loop over the test tree of each validation sample;
+ *       different samples are processed in parallel by forked worker processes,
+ *       each of which writes its histograms to a temporary file
+ *       that is merged into the output file once all workers have finished.
+ *
+ */
+
+#include "FWCore/FWLite/interface/AutoLibraryLoader.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TKey.h>
+#include <TSystem.h>
+#include <TROOT.h>
+#include <TBenchmark.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TCanvas.h>
+#include <TLegend.h>
+#include <TString.h>
+#include <TMath.h>
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef std::vector<std::string> vstring;
+
+struct sampleEntryType
+{
+  std::string name_;
+  std::string inputFileName_;
+  std::string tempFileName_;
+};
+
+struct variableEntryType
+{
+  variableEntryType(const edm::ParameterSet& cfg)
+    : name_(cfg.getParameter<std::string>("name")),
+      branchNames_(cfg.getParameter<vstring>("branchNames")),
+      numBinsX_(cfg.getParameter<unsigned>("numBinsX")),
+      xMin_(cfg.getParameter<double>("xMin")),
+      xMax_(cfg.getParameter<double>("xMax")),
+      value_(0.),
+      histogramTauIdPassed_(0),
+      histogramTauIdFailed_(0),
+      histogramFakeRateWeighted_(0)
+  {}
+  std::string name_;
+  vstring branchNames_; // CV: first branch existing in test tree is used
+  std::string branchName_;
+  unsigned numBinsX_;
+  double xMin_;
+  double xMax_;
+  Float_t value_;
+  TH1* histogramTauIdPassed_;
+  TH1* histogramTauIdFailed_;
+  TH1* histogramFakeRateWeighted_;
+};
+
+TH1* bookHistogram(const std::string& histogramName, const variableEntryType& variable)
+{
+  TH1* histogram = new TH1F(histogramName.data(), histogramName.data(), variable.numBinsX_, variable.xMin_, variable.xMax_);
+  histogram->Sumw2();
+  return histogram;
+}
+
+std::string getPlotFileName(const std::string& plotFileName, const std::string& suffix)
+{
+  size_t pos = plotFileName.find_last_of('.');
+  if ( pos == std::string::npos )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "Failed to find '.' in plotFileName = " << plotFileName << " !!\n";
+  return std::string(plotFileName, 0, pos).append(suffix).append(std::string(plotFileName, pos));
+}
+
+void makePlot(TCanvas* canvas, const std::string& plotFileName, const std::string& title,
+	      TH1* histogramFakeRate, TH1* histogramFakeRateWeighted)
+{
+  histogramFakeRate->SetTitle(title.data());
+  histogramFakeRate->SetStats(false);
+  histogramFakeRate->SetMinimum(1.e-4);
+  histogramFakeRate->SetMaximum(1.e+1);
+  histogramFakeRate->SetLineColor(2);
+  histogramFakeRate->SetLineWidth(2);
+  histogramFakeRate->SetMarkerStyle(20);
+  histogramFakeRate->SetMarkerColor(2);
+  histogramFakeRate->SetMarkerSize(1);
+  histogramFakeRate->Draw("e1p");
+
+  histogramFakeRateWeighted->SetLineColor(4);
+  histogramFakeRateWeighted->SetLineWidth(2);
+  histogramFakeRateWeighted->SetMarkerStyle(24);
+  histogramFakeRateWeighted->SetMarkerColor(4);
+  histogramFakeRateWeighted->SetMarkerSize(1);
+  histogramFakeRateWeighted->Draw("e1psame");
+
+  TLegend legend(0.11, 0.73, 0.31, 0.89);
+  legend.SetBorderSize(0);
+  legend.SetFillColor(0);
+  legend.AddEntry(histogramFakeRate, "Tau id. discr.", "p");
+  legend.AddEntry(histogramFakeRateWeighted, "Fake-Rate weight", "p");
+  legend.Draw();
+
+  canvas->Update();
+  canvas->Print(plotFileName.data());
+}
+
+void processSample(const sampleEntryType& sample, std::vector<variableEntryType>& variables,
+		   const std::string& treeName, const std::string& frWeightName, double maxAbsFrWeight,
+		   const std::string& plotFileName)
+{
+  std::cout << "<processSample>: sample = " << sample.name_ << ", inputFileName = " << sample.inputFileName_ << std::endl;
+
+  TFile* inputFile = TFile::Open(sample.inputFileName_.data());
+  if ( !inputFile || inputFile->IsZombie() )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "Failed to open input file = " << sample.inputFileName_ << " !!\n";
+
+  TTree* testTree = dynamic_cast<TTree*>(inputFile->Get(treeName.data()));
+  if ( !testTree )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "Failed to find tree = " << treeName << " in input file = " << sample.inputFileName_ << " !!\n";
+
+//--- read only the branches needed to fill the histograms
+  testTree->SetBranchStatus("*", 0);
+
+  Int_t type = 0;
+  testTree->SetBranchStatus("type", 1);
+  testTree->SetBranchAddress("type", &type);
+  Float_t eventWeight = 1.;
+  testTree->SetBranchStatus("weight", 1);
+  testTree->SetBranchAddress("weight", &eventWeight);
+  Float_t frWeight = 0.;
+  if ( !testTree->GetBranch(frWeightName.data()) )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "Failed to find branch = " << frWeightName << " in input file = " << sample.inputFileName_ << " !!\n";
+  testTree->SetBranchStatus(frWeightName.data(), 1);
+  testTree->SetBranchAddress(frWeightName.data(), &frWeight);
+
+//--- book histograms in memory, so that they do not get attached to input file
+  gROOT->cd();
+  for ( std::vector<variableEntryType>::iterator variable = variables.begin();
+	variable != variables.end(); ++variable ) {
+//--- check if fake-rates are parametrized by jet or tau variables
+    variable->branchName_ = "";
+    for ( vstring::const_iterator branchName = variable->branchNames_.begin();
+	  branchName != variable->branchNames_.end() && variable->branchName_ == ""; ++branchName ) {
+      if ( testTree->GetBranch(branchName->data()) ) variable->branchName_ = (*branchName);
+    }
+    if ( variable->branchName_ == "" )
+      throw cms::Exception("validateTauFakeRateKNN")
+	<< "Failed to find any branch for variable = " << variable->name_ << " in input file = " << sample.inputFileName_ << " !!\n";
+    std::cout << " using branch = " << variable->branchName_ << " for variable = " << variable->name_ << std::endl;
+    testTree->SetBranchStatus(variable->branchName_.data(), 1);
+    testTree->SetBranchAddress(variable->branchName_.data(), &variable->value_);
+
+    variable->histogramTauIdPassed_ =
+      bookHistogram(std::string("histogramTauIdPassed_").append(variable->branchName_), *variable);
+    variable->histogramTauIdFailed_ =
+      bookHistogram(std::string("histogramTauIdFailed_").append(variable->branchName_), *variable);
+    variable->histogramFakeRateWeighted_ =
+      bookHistogram(std::string("histogramFakeRateWeighted_").append(variable->branchName_), *variable);
+  }
+
+//--- fill histograms for all variables in one pass over the test tree
+  long numEntries = testTree->GetEntries();
+  long numEntries_frWeightOutOfRange = 0;
+  for ( long iEntry = 0; iEntry < numEntries; ++iEntry ) {
+    testTree->GetEntry(iEntry);
+
+    // CV: some entries have weight O(-100)
+    //    --> indication of technical problem with k-NearestNeighbour tree ?
+    bool isValidFrWeight = ( TMath::Abs(frWeight) < maxAbsFrWeight );
+    if ( !isValidFrWeight ) ++numEntries_frWeightOutOfRange;
+
+    for ( std::vector<variableEntryType>::iterator variable = variables.begin();
+	  variable != variables.end(); ++variable ) {
+      if      ( type == 1 ) variable->histogramTauIdPassed_->Fill(variable->value_, eventWeight);
+      else if ( type == 0 ) variable->histogramTauIdFailed_->Fill(variable->value_, eventWeight);
+      if ( isValidFrWeight ) variable->histogramFakeRateWeighted_->Fill(variable->value_, frWeight*eventWeight);
+    }
+  }
+  std::cout << " processed " << numEntries << " entries"
+	    << " (" << numEntries_frWeightOutOfRange << " with |" << frWeightName << "| >= " << maxAbsFrWeight << ")." << std::endl;
+
+  delete inputFile;
+
+//--- compute fake-rates and closure ratios
+  TFile* tempFile = TFile::Open(sample.tempFileName_.data(), "RECREATE");
+  if ( !tempFile || tempFile->IsZombie() )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "Failed to create temporary file = " << sample.tempFileName_ << " !!\n";
+  gROOT->cd();
+
+  TCanvas* canvas = new TCanvas("canvas", "canvas", 1, 1, 800, 600);
+  canvas->SetFillColor(10);
+  canvas->SetBorderSize(2);
+  canvas->SetLogy();
+
+  for ( std::vector<variableEntryType>::iterator variable = variables.begin();
+	variable != variables.end(); ++variable ) {
+    TH1* histogramTauIdDenominator =
+      bookHistogram(std::string("histogramTauIdDenominator_").append(variable->branchName_), *variable);
+    histogramTauIdDenominator->Add(variable->histogramTauIdPassed_);
+    histogramTauIdDenominator->Add(variable->histogramTauIdFailed_);
+
+    TH1* histogramFakeRate =
+      bookHistogram(std::string("histogramFakeRate_").append(variable->branchName_), *variable);
+    histogramFakeRate->Add(variable->histogramTauIdPassed_);
+    histogramFakeRate->Divide(histogramTauIdDenominator);
+
+    TH1* histogramFakeRateWeighted = variable->histogramFakeRateWeighted_;
+    histogramFakeRateWeighted->Divide(histogramTauIdDenominator);
+
+//--- closure ratio: average fake-rate weight divided by fraction of jets passing tau id. discriminator
+//   (expected to be compatible with one in case k-NN tree has been filled correctly)
+    TH1* histogramClosure =
+      bookHistogram(std::string("histogramFakeRateClosure_").append(variable->branchName_), *variable);
+    histogramClosure->Add(histogramFakeRateWeighted);
+    histogramClosure->Divide(histogramFakeRate);
+
+    std::cout << " " << variable->name_ << ":" << std::endl;
+    for ( unsigned iBin = 1; iBin <= variable->numBinsX_; ++iBin ) {
+      std::cout << "  bin #" << std::setw(2) << iBin
+		<< " (" << histogramFakeRate->GetXaxis()->GetBinLowEdge(iBin) << ".." << histogramFakeRate->GetXaxis()->GetBinUpEdge(iBin) << "):"
+		<< " fake-rate = " << histogramFakeRate->GetBinContent(iBin)
+		<< ", weighted = " << histogramFakeRateWeighted->GetBinContent(iBin)
+		<< ", closure = " << histogramClosure->GetBinContent(iBin) << " +/- " << histogramClosure->GetBinError(iBin) << std::endl;
+    }
+
+    tempFile->WriteTObject(variable->histogramTauIdPassed_);
+    tempFile->WriteTObject(variable->histogramTauIdFailed_);
+    tempFile->WriteTObject(histogramTauIdDenominator);
+    tempFile->WriteTObject(histogramFakeRate);
+    tempFile->WriteTObject(histogramFakeRateWeighted);
+    tempFile->WriteTObject(histogramClosure);
+
+    if ( plotFileName != "" ) {
+      std::string plotFileName_variable = getPlotFileName(plotFileName, Form("_%s_%s", sample.name_.data(), variable->name_.data()));
+      makePlot(canvas, plotFileName_variable, variable->branchName_, histogramFakeRate, histogramFakeRateWeighted);
+    }
+
+    delete variable->histogramTauIdPassed_;
+    variable->histogramTauIdPassed_ = 0;
+    delete variable->histogramTauIdFailed_;
+    variable->histogramTauIdFailed_ = 0;
+    delete histogramTauIdDenominator;
+    delete histogramFakeRate;
+    delete histogramFakeRateWeighted;
+    variable->histogramFakeRateWeighted_ = 0;
+    delete histogramClosure;
+  }
+
+  delete canvas;
+
+  delete tempFile;
+}
+
+void copyHistograms(const std::string& tempFileName, TDirectory* outputDirectory)
+{
+  TFile* tempFile = TFile::Open(tempFileName.data());
+  if ( !tempFile || tempFile->IsZombie() )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "Failed to open temporary file = " << tempFileName << " !!\n";
+
+  TIter next(tempFile->GetListOfKeys());
+  while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+    TObject* obj = key->ReadObj();
+    outputDirectory->WriteTObject(obj, key->GetName());
+    delete obj;
+  }
+
+  delete tempFile;
+}
+
+void removeTempFiles(const std::vector<sampleEntryType>& samples)
+{
+  for ( std::vector<sampleEntryType>::const_iterator sample = samples.begin();
+	sample != samples.end(); ++sample ) {
+    if ( !gSystem->AccessPathName(sample->tempFileName_.data()) ) gSystem->Unlink(sample->tempFileName_.data());
+  }
+}
+
+bool waitForWorker(std::map<pid_t, std::string>& runningWorkers)
+{
+//--- CV: wait only for the worker processes started for the validation samples, never call waitpid(-1, ...)
+  while ( !runningWorkers.empty() ) {
+    for ( std::map<pid_t, std::string>::iterator worker = runningWorkers.begin();
+	  worker != runningWorkers.end(); ++worker ) {
+      int status = 0;
+      pid_t pid = waitpid(worker->first, &status, WNOHANG);
+      if ( pid == 0 ) continue; // CV: worker process still running
+      if ( pid < 0 && errno == EINTR ) continue;
+      bool isSuccess = ( pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0 );
+      if ( !isSuccess )
+	std::cerr << "Worker process for sample = " << worker->second << " failed (status = " << status << ") !!" << std::endl;
+      runningWorkers.erase(worker);
+      return isSuccess;
+    }
+    usleep(10000);
+  }
+  return true;
+}
+
+int main(int argc, const char* argv[])
+{
+//--- parse command-line arguments
+  if ( argc < 2 ) {
+    std::cout << "Usage: " << argv[0] << " [parameters.py]" << std::endl;
+    return 0;
+  }
+
+  std::cout << "<validateTauFakeRateKNN>:" << std::endl;
+
+//--- disable pop-up windows showing graphics output
+  gROOT->SetBatch(true);
+
+//--- load framework libraries
+  gSystem->Load("libFWCoreFWLite");
+  AutoLibraryLoader::enable();
+
+//--- keep track of time it takes the macro to execute
+  TBenchmark clock;
+  clock.Start("validateTauFakeRateKNN");
+
+//--- read python configuration parameters
+  if ( !edm::readPSetsFrom(argv[1])->existsAs<edm::ParameterSet>("process") )
+    throw cms::Exception("validateTauFakeRateKNN")
+      << "No ParameterSet 'process' found in configuration file = " << argv[1] << " !!\n";
+
+  edm::ParameterSet cfg = edm::readPSetsFrom(argv[1])->getParameter<edm::ParameterSet>("process");
+
+  edm::ParameterSet cfgValidateTauFakeRateKNN = cfg.getParameter<edm::ParameterSet>("validateTauFakeRateKNN");
+
+  std::string treeName = ( cfgValidateTauFakeRateKNN.exists("treeName") ) ?
+    cfgValidateTauFakeRateKNN.getParameter<std::string>("treeName") : "TestTree";
+  std::string frWeightName = ( cfgValidateTauFakeRateKNN.exists("frWeightName") ) ?
+    cfgValidateTauFakeRateKNN.getParameter<std::string>("frWeightName") : "MVA_KNN";
+  double maxAbsFrWeight = ( cfgValidateTauFakeRateKNN.exists("maxAbsFrWeight") ) ?
+    cfgValidateTauFakeRateKNN.getParameter<double>("maxAbsFrWeight") : 1.;
+  std::string plotFileName = cfgValidateTauFakeRateKNN.getParameter<std::string>("plotFileName");
+  unsigned numWorkers = ( cfgValidateTauFakeRateKNN.exists("numWorkers") ) ?
+    cfgValidateTauFakeRateKNN.getParameter<unsigned>("numWorkers") : 1;
+  if ( numWorkers < 1 ) numWorkers = 1;
+
+  std::string outputFileName = cfg.getParameter<edm::ParameterSet>("fwliteOutput").getParameter<std::string>("fileName");
+
+  typedef std::vector<edm::ParameterSet> vParameterSet;
+  std::vector<sampleEntryType> samples;
+  vParameterSet cfgSamples = cfgValidateTauFakeRateKNN.getParameter<vParameterSet>("samples");
+  for ( vParameterSet::const_iterator cfgSample = cfgSamples.begin();
+	cfgSample != cfgSamples.end(); ++cfgSample ) {
+    sampleEntryType sample;
+    sample.name_ = cfgSample->getParameter<std::string>("name");
+    sample.inputFileName_ = cfgSample->getParameter<std::string>("inputFileName");
+    sample.tempFileName_ = std::string(outputFileName).append(Form(".%s.tmp%i", sample.name_.data(), (int)getpid()));
+    samples.push_back(sample);
+  }
+
+  std::vector<variableEntryType> variables;
+  vParameterSet cfgVariables = cfgValidateTauFakeRateKNN.getParameter<vParameterSet>("variables");
+  for ( vParameterSet::const_iterator cfgVariable = cfgVariables.begin();
+	cfgVariable != cfgVariables.end(); ++cfgVariable ) {
+    variables.push_back(variableEntryType(*cfgVariable));
+  }
+
+//--- process validation samples;
+//    in case more than one worker is configured, each sample is processed by a separate (forked) process
+//   (temporary files are removed in case of failure, too)
+  try {
+    if ( numWorkers == 1 || samples.size() == 1 ) {
+      for ( std::vector<sampleEntryType>::const_iterator sample = samples.begin();
+	    sample != samples.end(); ++sample ) {
+	processSample(*sample, variables, treeName, frWeightName, maxAbsFrWeight, plotFileName);
+      }
+    } else {
+      std::cout << "processing " << samples.size() << " samples using " << numWorkers << " worker processes." << std::endl;
+      std::map<pid_t, std::string> runningWorkers;
+      bool isFailure = false;
+      for ( size_t idxSample = 0; idxSample < samples.size() && !isFailure; ++idxSample ) {
+//--- wait for a worker to finish in case maximum number of workers is running
+	while ( runningWorkers.size() >= numWorkers ) {
+	  if ( !waitForWorker(runningWorkers) ) isFailure = true;
+	}
+	if ( isFailure ) break;
+
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(0);
+	pid_t pid = fork();
+	if ( pid == -1 ) {
+	  std::cerr << "Failed to fork worker process for sample = " << samples[idxSample].name_ << ", errno = " << errno << " !!" << std::endl;
+	  isFailure = true;
+	} else if ( pid == 0 ) {
+	  int exitCode = 0;
+	  try {
+	    processSample(samples[idxSample], variables, treeName, frWeightName, maxAbsFrWeight, plotFileName);
+	  } catch ( cms::Exception& e ) {
+	    std::cerr << "Error in worker process for sample = " << samples[idxSample].name_ << ":" << std::endl;
+	    std::cerr << e.what() << std::endl;
+	    exitCode = 1;
+	  } catch ( std::exception& e ) {
+	    std::cerr << "Error in worker process for sample = " << samples[idxSample].name_ << ":" << std::endl;
+	    std::cerr << e.what() << std::endl;
+	    exitCode = 1;
+	  } catch ( ... ) {
+	    std::cerr << "Unknown error in worker process for sample = " << samples[idxSample].name_ << " !!" << std::endl;
+	    exitCode = 1;
+	  }
+	  std::cout.flush();
+	  std::cerr.flush();
+	  fflush(0);
+//--- CV: use _exit, in order not to run destructors of objects owned by main process
+	  _exit(exitCode);
+	} else {
+	  runningWorkers[pid] = samples[idxSample].name_;
+	}
+      }
+//--- wait for all workers to finish, also in case of failure,
+//    in order not to remove temporary files still written by running workers
+      while ( !runningWorkers.empty() ) {
+	if ( !waitForWorker(runningWorkers) ) isFailure = true;
+      }
+      if ( isFailure )
+	throw cms::Exception("validateTauFakeRateKNN")
+	  << "Processing of validation samples failed !!\n";
+    }
+
+//--- merge histograms of all samples into output file
+    TFile* outputFile = TFile::Open(outputFileName.data(), "RECREATE");
+    if ( !outputFile || outputFile->IsZombie() )
+      throw cms::Exception("validateTauFakeRateKNN")
+	<< "Failed to create output file = " << outputFileName << " !!\n";
+    for ( std::vector<sampleEntryType>::const_iterator sample = samples.begin();
+	  sample != samples.end(); ++sample ) {
+      TDirectory* outputDirectory = outputFile->mkdir(sample->name_.data());
+      copyHistograms(sample->tempFileName_, outputDirectory);
+      gSystem->Unlink(sample->tempFileName_.data());
+    }
+    delete outputFile;
+  } catch ( ... ) {
+    removeTempFiles(samples);
+    throw;
+  }
+
+  clock.Show("validateTauFakeRateKNN");
+
+  return 0;
+}
@@ -0,0 +1,610 @@
+#ifndef TauAnalysis_TauIdEfficiency_CompiledStringCutObjectSelector_h
+#define TauAnalysis_TauIdEfficiency_CompiledStringCutObjectSelector_h
+
+/** \class CompiledStringCutObjectSelector
+ *
+ * Drop-in replacement for StringCutObjectSelector, intended for use in "hot" loops.
+ *
+ * The cut-string is parsed once, at configuration time,
+ * bound to typed accessor functions (no reflection needed for member access)
+ * and compiled into a flat program that is executed by a simple stack machine.
+ * Cut-strings which use syntax not supported by the compiler
+ * (e.g. chained method calls like 'pfJetRef.pt', methods with numeric arguments)
+ * are passed to StringCutObjectSelector, which interprets them as usual.
+ *
+ * Supported syntax:
+ *   o numbers, '+', '-', '*', '/', parentheses
+ *   o comparisons '<', '<=', '>', '>=', '==', '!=' (including chained comparisons 'a < x < b')
+ *   o logical operators '&&', '&', 'and', '||', '|', 'or', '!', 'not'
+ *   o functions of one argument (abs, sqrt, exp, log, log10, sin, cos, tan, ...)
+ *   o accessor methods, with optional empty parentheses or a single string argument,
+ *     as defined in CompiledStringCutAccessorTable<T>
+ *
+ * In case 'crossCheck' is enabled, each evaluation of a compiled cut-string is repeated by StringCutObjectSelector
+ * and an exception is thrown in case the two results differ (debug mode, to validate the compiler for new cut-strings).
+ *
+ */
+
+#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/PatCandidates/interface/Electron.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+#include "DataFormats/PatCandidates/interface/Tau.h"
+#include "DataFormats/PatCandidates/interface/Jet.h"
+
+#include <TMath.h>
+
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+#include <cmath>
+
+namespace compiledStringCut
+{
+  //-----------------------------------------------------------------------------
+  // typed accessor functions
+  // (string argument is ignored by accessors that do not take an argument)
+  //-----------------------------------------------------------------------------
+
+  template<typename T> double pt(const T& obj, const std::string&) { return obj.pt(); }
+  template<typename T> double eta(const T& obj, const std::string&) { return obj.eta(); }
+  template<typename T> double phi(const T& obj, const std::string&) { return obj.phi(); }
+  template<typename T> double energy(const T& obj, const std::string&) { return obj.energy(); }
+  template<typename T> double et(const T& obj, const std::string&) { return obj.et(); }
+  template<typename T> double mass(const T& obj, const std::string&) { return obj.mass(); }
+  template<typename T> double mt(const T& obj, const std::string&) { return obj.mt(); }
+  template<typename T> double p(const T& obj, const std::string&) { return obj.p(); }
+  template<typename T> double px(const T& obj, const std::string&) { return obj.px(); }
+  template<typename T> double py(const T& obj, const std::string&) { return obj.py(); }
+  template<typename T> double pz(const T& obj, const std::string&) { return obj.pz(); }
+  template<typename T> double theta(const T& obj, const std::string&) { return obj.theta(); }
+  template<typename T> double rapidity(const T& obj, const std::string&) { return obj.rapidity(); }
+  template<typename T> double charge(const T& obj, const std::string&) { return obj.charge(); }
+  template<typename T> double pdgId(const T& obj, const std::string&) { return obj.pdgId(); }
+  template<typename T> double userFloat(const T& obj, const std::string& arg) { return obj.userFloat(arg); }
+  template<typename T> double userInt(const T& obj, const std::string& arg) { return obj.userInt(arg); }
+  template<typename T> double hasUserFloat(const T& obj, const std::string& arg) { return obj.hasUserFloat(arg); }
+
+  inline double tauID(const pat::Tau& tau, const std::string& arg) { return tau.tauID(arg); }
+  inline double isTauIDAvailable(const pat::Tau& tau, const std::string& arg) { return tau.isTauIDAvailable(arg); }
+  inline double isPFTau(const pat::Tau& tau, const std::string&) { return tau.isPFTau(); }
+  inline double isCaloTau(const pat::Tau& tau, const std::string&) { return tau.isCaloTau(); }
+  inline double decayMode(const pat::Tau& tau, const std::string&) { return tau.decayMode(); }
+
+  inline double isGlobalMuon(const pat::Muon& muon, const std::string&) { return muon.isGlobalMuon(); }
+  inline double isTrackerMuon(const pat::Muon& muon, const std::string&) { return muon.isTrackerMuon(); }
+  inline double isStandAloneMuon(const pat::Muon& muon, const std::string&) { return muon.isStandAloneMuon(); }
+  inline double numberOfMatches(const pat::Muon& muon, const std::string&) { return muon.numberOfMatches(); }
+  inline double trackIso(const pat::Muon& muon, const std::string&) { return muon.trackIso(); }
+  inline double ecalIso(const pat::Muon& muon, const std::string&) { return muon.ecalIso(); }
+  inline double hcalIso(const pat::Muon& muon, const std::string&) { return muon.hcalIso(); }
+
+  inline double electronID(const pat::Electron& electron, const std::string& arg) { return electron.electronID(arg); }
+
+  inline double bDiscriminator(const pat::Jet& jet, const std::string& arg) { return jet.bDiscriminator(arg); }
+  inline double chargedHadronEnergyFraction(const pat::Jet& jet, const std::string&) { return jet.chargedHadronEnergyFraction(); }
+
+  //-----------------------------------------------------------------------------
+  // tables binding method names to typed accessor functions
+  //-----------------------------------------------------------------------------
+
+  template<typename T>
+  struct accessorTraits
+  {
+    typedef double (*accessorType)(const T&, const std::string&);
+  };
+
+  template<typename T>
+  typename accessorTraits<T>::accessorType findKinematicAccessor(const std::string& name, bool hasArgument)
+  {
+    if ( hasArgument ) return 0;
+    if ( name == "pt"       ) return &pt<T>;
+    if ( name == "eta"      ) return &eta<T>;
+    if ( name == "phi"      ) return &phi<T>;
+    if ( name == "energy"   ) return &energy<T>;
+    if ( name == "et"       ) return &et<T>;
+    if ( name == "mass"     ) return &mass<T>;
+    if ( name == "mt"       ) return &mt<T>;
+    if ( name == "p"        ) return &p<T>;
+    if ( name == "px"       ) return &px<T>;
+    if ( name == "py"       ) return &py<T>;
+    if ( name == "pz"       ) return &pz<T>;
+    if ( name == "theta"    ) return &theta<T>;
+    if ( name == "rapidity" ) return &rapidity<T>;
+    if ( name == "charge"   ) return &charge<T>;
+    if ( name == "pdgId"    ) return &pdgId<T>;
+    return 0;
+  }
+
+  template<typename T>
+  typename accessorTraits<T>::accessorType findPATObjectAccessor(const std::string& name, bool hasArgument)
+  {
+    if ( hasArgument ) {
+      if ( name == "userFloat"    ) return &userFloat<T>;
+      if ( name == "userInt"      ) return &userInt<T>;
+      if ( name == "hasUserFloat" ) return &hasUserFloat<T>;
+      return 0;
+    }
+    return findKinematicAccessor<T>(name, hasArgument);
+  }
+
+  /// default: kinematic quantities only
+  /// (used for reco::Candidate, pat::TriggerObject, ...)
+  template<typename T>
+  struct CompiledStringCutAccessorTable
+  {
+    static typename accessorTraits<T>::accessorType find(const std::string& name, bool hasArgument)
+    {
+      return findKinematicAccessor<T>(name, hasArgument);
+    }
+  };
+
+  template<>
+  struct CompiledStringCutAccessorTable<pat::Tau>
+  {
+    static accessorTraits<pat::Tau>::accessorType find(const std::string& name, bool hasArgument)
+    {
+      if ( hasArgument ) {
+	if ( name == "tauID"            ) return &tauID;
+	if ( name == "isTauIDAvailable" ) return &isTauIDAvailable;
+      } else {
+	if ( name == "isPFTau"          ) return &isPFTau;
+	if ( name == "isCaloTau"        ) return &isCaloTau;
+	if ( name == "decayMode"        ) return &decayMode;
+      }
+      return findPATObjectAccessor<pat::Tau>(name, hasArgument);
+    }
+  };
+
+  template<>
+  struct CompiledStringCutAccessorTable<pat::Muon>
+  {
+    static accessorTraits<pat::Muon>::accessorType find(const std::string& name, bool hasArgument)
+    {
+      if ( !hasArgument ) {
+	if ( name == "isGlobalMuon"     ) return &isGlobalMuon;
+	if ( name == "isTrackerMuon"    ) return &isTrackerMuon;
+	if ( name == "isStandAloneMuon" ) return &isStandAloneMuon;
+	if ( name == "numberOfMatches"  ) return &numberOfMatches;
+	if ( name == "trackIso"         ) return &trackIso;
+	if ( name == "ecalIso"          ) return &ecalIso;
+	if ( name == "hcalIso"          ) return &hcalIso;
+      }
+      return findPATObjectAccessor<pat::Muon>(name, hasArgument);
+    }
+  };
+
+  template<>
+  struct CompiledStringCutAccessorTable<pat::Electron>
+  {
+    static accessorTraits<pat::Electron>::accessorType find(const std::string& name, bool hasArgument)
+    {
+      if ( hasArgument && name == "electronID" ) return &electronID;
+      return findPATObjectAccessor<pat::Electron>(name, hasArgument);
+    }
+  };
+
+  template<>
+  struct CompiledStringCutAccessorTable<pat::Jet>
+  {
+    static accessorTraits<pat::Jet>::accessorType find(const std::string& name, bool hasArgument)
+    {
+      if (  hasArgument && name == "bDiscriminator"              ) return &bDiscriminator;
+      if ( !hasArgument && name == "chargedHadronEnergyFraction" ) return &chargedHadronEnergyFraction;
+      return findPATObjectAccessor<pat::Jet>(name, hasArgument);
+    }
+  };
+
+  //-----------------------------------------------------------------------------
+  // functions of one argument
+  //-----------------------------------------------------------------------------
+
+  typedef double (*functionType)(double);
+
+  inline double fAbs(double x)   { return TMath::Abs(x); }
+  inline double fSqrt(double x)  { return TMath::Sqrt(x); }
+  inline double fExp(double x)   { return TMath::Exp(x); }
+  inline double fLog(double x)   { return TMath::Log(x); }
+  inline double fLog10(double x) { return TMath::Log10(x); }
+  inline double fSin(double x)   { return TMath::Sin(x); }
+  inline double fCos(double x)   { return TMath::Cos(x); }
+  inline double fTan(double x)   { return TMath::Tan(x); }
+  inline double fASin(double x)  { return TMath::ASin(x); }
+  inline double fACos(double x)  { return TMath::ACos(x); }
+  inline double fATan(double x)  { return TMath::ATan(x); }
+  inline double fSinh(double x)  { return TMath::SinH(x); }
+  inline double fCosh(double x)  { return TMath::CosH(x); }
+  inline double fTanh(double x)  { return TMath::TanH(x); }
+
+  inline functionType findFunction(const std::string& name)
+  {
+    if ( name == "abs"   ) return &fAbs;
+    if ( name == "sqrt"  ) return &fSqrt;
+    if ( name == "exp"   ) return &fExp;
+    if ( name == "log"   ) return &fLog;
+    if ( name == "log10" ) return &fLog10;
+    if ( name == "sin"   ) return &fSin;
+    if ( name == "cos"   ) return &fCos;
+    if ( name == "tan"   ) return &fTan;
+    if ( name == "asin"  ) return &fASin;
+    if ( name == "acos"  ) return &fACos;
+    if ( name == "atan"  ) return &fATan;
+    if ( name == "sinh"  ) return &fSinh;
+    if ( name == "cosh"  ) return &fCosh;
+    if ( name == "tanh"  ) return &fTanh;
+    return 0;
+  }
+
+  enum { kPushConstant, kPushAccessor, kFunction,
+	 kNegate, kAdd, kSubtract, kMultiply, kDivide,
+	 kLess, kLessEqual, kGreater, kGreaterEqual, kEqual, kNotEqual,
+	 kNot, kToBool, kAnd, kJumpIfFalse, kJumpIfTrue, kPop };
+}
+
+template<typename T>
+class CompiledStringCutObjectSelector
+{
+ public:
+  /// constructor
+  /// (in case second argument is true, results of compiled cut-string are cross-checked with StringCutObjectSelector)
+  explicit CompiledStringCutObjectSelector(const std::string& cut, bool crossCheck = false)
+    : cut_(cut),
+      stackDepth_(0),
+      maxStackDepth_(0),
+      isCompiled_(false),
+      crossCheck_(false),
+      interpreter_(0)
+  {
+    pos_ = 0;
+    bool isCompiled = parseExpression();
+    skipWhitespace();
+    if ( isCompiled && pos_ == cut_.length() && maxStackDepth_ <= kMaxStackDepth && stackDepth_ == 1 ) {
+      emit(compiledStringCut::kToBool);
+      isCompiled_ = true;
+      crossCheck_ = crossCheck;
+    } else {
+      program_.clear();
+    }
+    if ( !isCompiled_ || crossCheck_ ) interpreter_ = new StringCutObjectSelector<T>(cut_);
+  }
+
+  /// destructor
+  ~CompiledStringCutObjectSelector()
+  {
+    delete interpreter_;
+  }
+
+  /// evaluate cut-string for given object
+  bool operator()(const T& obj) const
+  {
+    if ( !isCompiled_ ) return (*interpreter_)(obj);
+
+    bool retVal = execute(obj);
+    if ( crossCheck_ ) {
+      bool retVal_interpreted = (*interpreter_)(obj);
+      if ( retVal != retVal_interpreted )
+	throw cms::Exception("CompiledStringCutObjectSelector")
+	  << "Result of compiled cut-string = '" << cut_ << "' (" << retVal << ")"
+	  << " differs from result of StringCutObjectSelector (" << retVal_interpreted << ") !!\n";
+    }
+    return retVal;
+  }
+
+  /// return flag indicating whether cut-string has been compiled
+  /// or is evaluated by StringCutObjectSelector
+  bool isCompiled() const { return isCompiled_; }
+
+  const std::string& cut() const { return cut_; }
+
+ private:
+  /// copying not supported
+  /// (StringCutObjectSelector used for cut-strings that cannot be compiled is owned by this object)
+  CompiledStringCutObjectSelector(const CompiledStringCutObjectSelector&);
+  CompiledStringCutObjectSelector& operator=(const CompiledStringCutObjectSelector&);
+
+  /// execute compiled program
+  bool execute(const T& obj) const
+  {
+    double stack[kMaxStackDepth];
+    int idx = -1;
+    size_t numInstructions = program_.size();
+    for ( size_t pc = 0; pc < numInstructions; ++pc ) {
+      const instructionType& instruction = program_[pc];
+      switch ( instruction.opcode_ ) {
+      case compiledStringCut::kPushConstant  : stack[++idx] = instruction.value_;                                break;
+      case compiledStringCut::kPushAccessor  : stack[++idx] = (*instruction.accessor_)(obj, instruction.argument_); break;
+      case compiledStringCut::kFunction      : stack[idx]   = (*instruction.function_)(stack[idx]);              break;
+      case compiledStringCut::kNegate        : stack[idx]   = -stack[idx];                                       break;
+      case compiledStringCut::kAdd           : --idx; stack[idx] = stack[idx] + stack[idx + 1];                  break;
+      case compiledStringCut::kSubtract      : --idx; stack[idx] = stack[idx] - stack[idx + 1];                  break;
+      case compiledStringCut::kMultiply      : --idx; stack[idx] = stack[idx] * stack[idx + 1];                  break;
+      case compiledStringCut::kDivide        : --idx; stack[idx] = stack[idx] / stack[idx + 1];                  break;
+      case compiledStringCut::kLess          : --idx; stack[idx] = ( stack[idx] <  stack[idx + 1] );             break;
+      case compiledStringCut::kLessEqual     : --idx; stack[idx] = ( stack[idx] <= stack[idx + 1] );             break;
+      case compiledStringCut::kGreater       : --idx; stack[idx] = ( stack[idx] >  stack[idx + 1] );             break;
+      case compiledStringCut::kGreaterEqual  : --idx; stack[idx] = ( stack[idx] >= stack[idx + 1] );             break;
+      case compiledStringCut::kEqual         : --idx; stack[idx] = ( stack[idx] == stack[idx + 1] );             break;
+      case compiledStringCut::kNotEqual      : --idx; stack[idx] = ( stack[idx] != stack[idx + 1] );             break;
+      case compiledStringCut::kAnd           : --idx; stack[idx] = ( stack[idx] != 0. && stack[idx + 1] != 0. ); break;
+      case compiledStringCut::kNot           : stack[idx]   = ( stack[idx] == 0. );                              break;
+      case compiledStringCut::kToBool        : stack[idx]   = ( stack[idx] != 0. );                              break;
+      case compiledStringCut::kJumpIfFalse   : if ( stack[idx] == 0. ) pc = instruction.target_ - 1;             break;
+      case compiledStringCut::kJumpIfTrue    : if ( stack[idx] != 0. ) pc = instruction.target_ - 1;             break;
+      case compiledStringCut::kPop           : --idx;                                                            break;
+      }
+    }
+
+    return ( stack[0] != 0. );
+  }
+
+  static const int kMaxStackDepth = 32;
+
+  typedef typename compiledStringCut::accessorTraits<T>::accessorType accessorType;
+
+  struct instructionType
+  {
+    instructionType(int opcode, double value = 0.)
+      : opcode_(opcode),
+	value_(value),
+	accessor_(0),
+	function_(0),
+	target_(0)
+    {}
+    int opcode_;
+    double value_;
+    accessorType accessor_;
+    std::string argument_;
+    compiledStringCut::functionType function_;
+    size_t target_;
+  };
+
+//--- auxiliary functions for code generation
+  void emit(const instructionType& instruction)
+  {
+    switch ( instruction.opcode_ ) {
+    case compiledStringCut::kPushConstant :
+    case compiledStringCut::kPushAccessor :
+      ++stackDepth_;
+      break;
+    case compiledStringCut::kAdd          : case compiledStringCut::kSubtract  : case compiledStringCut::kMultiply     :
+    case compiledStringCut::kDivide       : case compiledStringCut::kLess      : case compiledStringCut::kLessEqual    :
+    case compiledStringCut::kGreater      : case compiledStringCut::kEqual     : case compiledStringCut::kGreaterEqual :
+    case compiledStringCut::kNotEqual     : case compiledStringCut::kAnd       : case compiledStringCut::kPop          :
+      --stackDepth_;
+      break;
+    }
+    if ( stackDepth_ > maxStackDepth_ ) maxStackDepth_ = stackDepth_;
+    program_.push_back(instruction);
+  }
+  void emit(int opcode) { emit(instructionType(opcode)); }
+
+//--- auxiliary functions for parsing
+  void skipWhitespace()
+  {
+    while ( pos_ < cut_.length() && isspace(cut_[pos_]) ) ++pos_;
+  }
+  bool match(const char* token)
+  {
+    skipWhitespace();
+    size_t length = std::string(token).length();
+    if ( cut_.compare(pos_, length, token) == 0 ) {
+      pos_ += length;
+      return true;
+    }
+    return false;
+  }
+  bool matchKeyword(const char* keyword)
+  {
+    skipWhitespace();
+    size_t length = std::string(keyword).length();
+    if ( cut_.compare(pos_, length, keyword) == 0 &&
+	 !(pos_ + length < cut_.length() && (isalnum(cut_[pos_ + length]) || cut_[pos_ + length] == '_')) ) {
+      pos_ += length;
+      return true;
+    }
+    return false;
+  }
+  std::string parseIdentifier()
+  {
+    skipWhitespace();
+    size_t start = pos_;
+    if ( pos_ < cut_.length() && (isalpha(cut_[pos_]) || cut_[pos_] == '_') ) {
+      while ( pos_ < cut_.length() && (isalnum(cut_[pos_]) || cut_[pos_] == '_') ) ++pos_;
+    }
+    return std::string(cut_, start, pos_ - start);
+  }
+  bool parseStringLiteral(std::string& value)
+  {
+    skipWhitespace();
+    if ( pos_ >= cut_.length() || !(cut_[pos_] == '\'' || cut_[pos_] == '"') ) return false;
+    char quote = cut_[pos_];
+    size_t end = cut_.find(quote, pos_ + 1);
+    if ( end == std::string::npos ) return false;
+    value = std::string(cut_, pos_ + 1, end - (pos_ + 1));
+    pos_ = end + 1;
+    return true;
+  }
+
+//--- recursive descent parser,
+//    generating code while parsing
+//   (operator precedence: '||' < '&&' < '!' < comparison < '+', '-' < '*', '/' < unary '-')
+  bool parseExpression()
+  {
+    if ( !parseAndExpression() ) return false;
+    while ( matchKeyword("or") || match("||") || match("|") ) {
+      // short-circuit evaluation: skip right-hand side in case left-hand side is true
+      emit(compiledStringCut::kToBool);
+      size_t jump = program_.size();
+      emit(compiledStringCut::kJumpIfTrue);
+      emit(compiledStringCut::kPop);
+      if ( !parseAndExpression() ) return false;
+      emit(compiledStringCut::kToBool);
+      program_[jump].target_ = program_.size();
+    }
+    return true;
+  }
+  bool parseAndExpression()
+  {
+    if ( !parseNotExpression() ) return false;
+    while ( matchKeyword("and") || match("&&") || match("&") ) {
+      // short-circuit evaluation: skip right-hand side in case left-hand side is false
+      emit(compiledStringCut::kToBool);
+      size_t jump = program_.size();
+      emit(compiledStringCut::kJumpIfFalse);
+      emit(compiledStringCut::kPop);
+      if ( !parseNotExpression() ) return false;
+      emit(compiledStringCut::kToBool);
+      program_[jump].target_ = program_.size();
+    }
+    return true;
+  }
+  bool parseNotExpression()
+  {
+    skipWhitespace();
+    if ( matchKeyword("not") || (cut_.compare(pos_, 1, "!") == 0 && cut_.compare(pos_, 2, "!=") != 0 && match("!")) ) {
+      if ( !parseNotExpression() ) return false;
+      emit(compiledStringCut::kNot);
+      return true;
+    }
+    return parseComparison();
+  }
+  int parseComparisonOperator()
+  {
+    if ( match("<=") ) return compiledStringCut::kLessEqual;
+    if ( match(">=") ) return compiledStringCut::kGreaterEqual;
+    if ( match("==") ) return compiledStringCut::kEqual;
+    if ( match("!=") ) return compiledStringCut::kNotEqual;
+    if ( match("<")  ) return compiledStringCut::kLess;
+    if ( match(">")  ) return compiledStringCut::kGreater;
+    return -1;
+  }
+  bool parseComparison()
+  {
+    if ( !parseSum() ) return false;
+    int comparisonOperator = parseComparisonOperator();
+    if ( comparisonOperator == -1 ) return true;
+    size_t rhsStart = program_.size();
+    if ( !parseSum() ) return false;
+    size_t rhsEnd = program_.size();
+    emit(comparisonOperator);
+    int comparisonOperator2 = parseComparisonOperator();
+    if ( comparisonOperator2 != -1 ) {
+      // chained comparison 'a < x < b' --> (a < x) && (x < b);
+      // re-emit code of middle operand (no jumps allowed within operand)
+      for ( size_t idx = rhsStart; idx < rhsEnd; ++idx ) {
+	instructionType instruction = program_[idx];
+	if ( instruction.opcode_ == compiledStringCut::kJumpIfFalse ||
+	     instruction.opcode_ == compiledStringCut::kJumpIfTrue  ) return false;
+	emit(instruction);
+      }
+      if ( !parseSum() ) return false;
+      emit(comparisonOperator2);
+      emit(compiledStringCut::kAnd);
+    }
+    return true;
+  }
+  bool parseSum()
+  {
+    if ( !parseProduct() ) return false;
+    while ( true ) {
+      if      ( match("+") ) { if ( !parseProduct() ) return false; emit(compiledStringCut::kAdd);      }
+      else if ( match("-") ) { if ( !parseProduct() ) return false; emit(compiledStringCut::kSubtract); }
+      else break;
+    }
+    return true;
+  }
+  bool parseProduct()
+  {
+    if ( !parseUnary() ) return false;
+    while ( true ) {
+      if      ( match("*") ) { if ( !parseUnary() ) return false; emit(compiledStringCut::kMultiply); }
+      else if ( match("/") ) { if ( !parseUnary() ) return false; emit(compiledStringCut::kDivide);   }
+      else break;
+    }
+    return true;
+  }
+  bool parseUnary()
+  {
+    if ( match("-") ) {
+      if ( !parseUnary() ) return false;
+      emit(compiledStringCut::kNegate);
+      return true;
+    }
+    if ( match("+") ) return parseUnary();
+    return parsePrimary();
+  }
+  bool parsePrimary()
+  {
+    skipWhitespace();
+    if ( pos_ >= cut_.length() ) return false;
+
+    if ( match("(") ) {
+      if ( !parseExpression() ) return false;
+      return match(")");
+    }
+
+    if ( isdigit(cut_[pos_]) || cut_[pos_] == '.' ) {
+      const char* start = cut_.data() + pos_;
+      char* end = 0;
+      double value = strtod(start, &end);
+      if ( end == start ) return false;
+      pos_ += (end - start);
+      emit(instructionType(compiledStringCut::kPushConstant, value));
+      return true;
+    }
+
+    std::string name = parseIdentifier();
+    if ( name == "" ) return false;
+    if ( name == "true"  ) { emit(instructionType(compiledStringCut::kPushConstant, 1.)); return true; }
+    if ( name == "false" ) { emit(instructionType(compiledStringCut::kPushConstant, 0.)); return true; }
+
+    compiledStringCut::functionType function = compiledStringCut::findFunction(name);
+
+    bool hasArgument = false;
+    std::string argument;
+    if ( match("(") ) {
+      skipWhitespace();
+      if ( function && !(pos_ < cut_.length() && (cut_[pos_] == '\'' || cut_[pos_] == '"')) ) {
+	if ( !parseExpression() ) return false;
+	if ( !match(")") ) return false;
+	instructionType instruction(compiledStringCut::kFunction);
+	instruction.function_ = function;
+	emit(instruction);
+	return true;
+      }
+      if ( parseStringLiteral(argument) ) hasArgument = true;
+      if ( !match(")") ) return false; // method with numeric argument(s) --> not supported
+    }
+
+    // chained method calls (e.g. 'pfJetRef.pt') are not supported
+    skipWhitespace();
+    if ( pos_ < cut_.length() && cut_[pos_] == '.' ) return false;
+
+    accessorType accessor = compiledStringCut::CompiledStringCutAccessorTable<T>::find(name, hasArgument);
+    if ( !accessor ) return false;
+
+    instructionType instruction(compiledStringCut::kPushAccessor);
+    instruction.accessor_ = accessor;
+    instruction.argument_ = argument;
+    emit(instruction);
+    return true;
+  }
+
+  std::string cut_;
+
+  size_t pos_;
+
+  std::vector<instructionType> program_;
+  int stackDepth_;
+  int maxStackDepth_;
+
+  bool isCompiled_;
+  bool crossCheck_;
+
+  StringCutObjectSelector<T>* interpreter_;
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef TauAnalysis_TauIdEfficiency_PATMuonLUTvalueGridFromKNN_h
+#define TauAnalysis_TauIdEfficiency_PATMuonLUTvalueGridFromKNN_h
+
+/** \class PATMuonLUTvalueGridFromKNN
+ *
+ * Speed-up evaluation of k-NN based look-up tables (e.g. muon isolation probabilities)
+ * compared to PATMuonLUTvalueExtractorFromKNN, which performs a search for the nearest neighbours
+ * in the full training sample for each muon.
+ * The k-NN response is computed by a single TMVA::Reader, booked with the configured 'inputFileName',
+ * which is used for building the grid as well as for all exact evaluations.
+ *
+ * Two optimizations are applied:
+ *   o values are memoized per event,
+ *     so that repeated look-ups for the same muon (in different regions, systematic shifts,...) are computed once only
+ *   o in case 'useGrid' is enabled in the configuration parameters,
+ *     the k-NN response is precomputed on a dense grid of its input variables (given by 'gridMin', 'gridMax', 'gridNumPoints'
+ *     for each entry in 'parametrization') and the look-up is performed by multilinear interpolation.
+ *     When the grid is built, the interpolated values are compared to the exact k-NN response in the center of each grid cell
+ *     and at 'gridNumValidationPoints' points drawn at random (with fixed seed) within the grid;
+ *     cells in which the difference exceeds 'gridTolerance' and muons outside the grid
+ *     are evaluated exactly. The number of grid cells is limited to 'gridMaxNumCells'.
+ *     In addition, the first 'gridNumValidationMuons' interpolated values are cross-checked against the exact k-NN response.
+ *     In case the deviation exceeds 'gridTolerance' for any of these muons, the grid is considered unreliable:
+ *     the exact value is returned and the grid is not used for the remaining muons of the job.
+ *
+ */
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "CommonTools/Utils/interface/StringObjectFunction.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+
+#include <Rtypes.h>
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace TMVA
+{
+  class Reader;
+}
+
+class PATMuonLUTvalueGridFromKNN
+{
+ public:
+  /// constructor
+  /// (takes the same configuration parameters as PATMuonLUTvalueExtractorFromKNN)
+  PATMuonLUTvalueGridFromKNN(const edm::ParameterSet&);
+
+  /// destructor
+  ~PATMuonLUTvalueGridFromKNN();
+
+  /// clear values memoized for muons of previous event
+  void beginEvent() 
+  { 
+    memoizedInputs_.clear(); 
+    memoizedValues_.clear(); 
+  }
+
+  /// compute value of look-up table for muon given as function argument
+  double operator()(const pat::Muon&);
+
+  void print(std::ostream&) const;
+
+ private:
+  typedef std::vector<double> vdouble;
+
+  void bookReader(const std::string&);
+  void buildGrid(unsigned, unsigned);
+  void validateCell(const vdouble&, unsigned&);
+  double evaluateKNN(const vdouble&);
+
+  /// find grid cell containing point given as function argument;
+  /// returns false in case point is outside grid
+  bool findCell(const vdouble&, unsigned&, std::vector<unsigned>&, vdouble&) const;
+  double interpolate(const std::vector<unsigned>&, const vdouble&) const;
+
+  struct variableEntryType
+  {
+    std::string name_;
+    StringObjectFunction<pat::Muon>* function_;
+    double min_;
+    double max_;
+    unsigned numPoints_;
+    double step_;
+    unsigned nodeStride_;
+    unsigned cellStride_;
+  };
+  std::vector<variableEntryType> variables_;
+
+  bool useGrid_;
+  double tolerance_;
+  bool gridFailedValidation_; // set in case cross-check of interpolated with exact values fails
+
+  TMVA::Reader* mvaReader_;
+  std::vector<Float_t> mvaInputs_;
+
+  std::vector<double> gridValues_; // k-NN response at grid nodes
+  std::vector<bool> cellIsExact_;  // cells failing comparison with exact k-NN response
+
+  unsigned numValidationMuons_;
+
+  // values memoized for muons of current event
+  // (input variables of memoized muon i are stored at positions i*numVariables..(i + 1)*numVariables - 1)
+  vdouble memoizedInputs_;
+  vdouble memoizedValues_;
+
+  // buffers reused for each look-up
+  vdouble x_;
+  std::vector<unsigned> idxPoints_;
+  vdouble f_;
+
+  long numLookups_;
+  long numMemoized_;
+  long numInterpolated_;
+  long numExact_;
+  long numValidated_;
+  long numValidationFailures_;
+  double maxDeviation_;
+
+  unsigned numCellsExact_;
+  double maxDeviationGrid_;
+};
+
+#endif
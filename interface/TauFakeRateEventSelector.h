@@ -18,7 +18,7 @@
 
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "TauAnalysis/TauIdEfficiency/interface/CompiledStringCutObjectSelector.h"
 
 #include "DataFormats/PatCandidates/interface/Tau.h"
 
@@ -26,6 +26,8 @@ class TauFakeRateEventSelector : public EventSelector
 {
 
  public:
+  typedef std::vector<std::string> vstring;
+
   /// constructor
   TauFakeRateEventSelector(edm::ParameterSet const&);
 
@@ -36,6 +38,21 @@ class TauFakeRateEventSelector : public EventSelector
   bool operator()(const edm::EventBase& event, pat::strbitset& result) { return true; }
   bool operator()(const pat::Tau& tauJetCand, pat::strbitset& result);
 
+  /// selection split into parts that are common to all regions and tau id. discriminators
+  /// and parts that are specific to the region/tau id. discriminators,
+  /// so that the common part can be evaluated once per tau-jet candidate
+  /// and shared between selectors:
+  ///  o Pt and eta cuts plus preselection criteria (same for all selectors using default preselection)
+  ///  o tau id. discriminators                     (same for all regions of a given tau id.)
+  ///  o passed/failed tau id. requirement          (region specific)
+  bool passesPreselection(const pat::Tau&) const;
+  bool passesTauIdDiscriminators(const pat::Tau&) const;
+  bool passesRegion(bool) const;
+
+  /// return cut-strings of preselection criteria,
+  /// to check whether preselection can be shared between two selectors
+  vstring getPreselCriteria() const;
+
   friend class regionEntryType; // allow regionEntryType to overwrite cut values
 
  private:
@@ -45,7 +62,6 @@ class TauFakeRateEventSelector : public EventSelector
  
   /// list of tau id. discrimators
   /// (e.g. 'decayModeFinding' && 'byLooseCombinedIsolationDeltaBetaCorr')
-  typedef std::vector<std::string> vstring;
   vstring tauIdDiscriminators_;
 
   double tauIdDiscriminatorMin_;
@@ -55,7 +71,7 @@ class TauFakeRateEventSelector : public EventSelector
   /// list of preselection criteria applied on tau-jet candidates
   /// to enter fake-rate measurement
   /// (e.g. jetId, discriminators against electrons/muons)
-  typedef StringCutObjectSelector<pat::Tau> StringCutTauSelector;
+  typedef CompiledStringCutObjectSelector<pat::Tau> StringCutTauSelector;
   struct StringCutTauSelectorType
   {
     StringCutTauSelectorType(const std::string& cut)
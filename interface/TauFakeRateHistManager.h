@@ -44,6 +44,9 @@ class TauFakeRateHistManager
   TH1* book1D(TFileDirectory&, const std::string&, const std::string&, int, double, double);
   TH1* book1D(TFileDirectory&, const std::string&, const std::string&, int, float*);
 
+  /// register histogram with TFileService (or with histogram bundle of directory)
+  TH1* registerHistogram(TFileDirectory&, TH1*);
+
   std::string getHistogramName(const std::string&);
 
  private:
@@ -66,6 +69,10 @@ class TauFakeRateHistManager
   TH1* histogramNumVertices_;
   
   std::vector<TH1*> histograms_;
+
+  /// write histograms in compact TauIdEffHistogramBundle format
+  /// instead of writing each histogram individually
+  bool writeHistogramBundle_;
 };
 
 #endif
@@ -0,0 +1,212 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffBinnedLikelihood_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffBinnedLikelihood_h
+
+/** \class TauIdEffBinnedLikelihood
+ *
+ * Extended binned likelihood for template fits,
+ * evaluated over flat arrays of bin contents and providing analytic derivatives to Minuit.
+ *
+ * The negative log-likelihood is given by
+ *
+ *   NLL = sum_{channels} [ sum_{k} Y_k - sum_{bins} n_i * log(sum_{k} Y_k * s_k,i) ] + sum_{constraints} 0.5*((p - value)/error)^2
+ *
+ * where n_i denote the observed event yields, s_k,i the (normalized) template shapes
+ * and Y_k the expected event yields of the processes contributing to each channel ("components").
+ * The expected event yields are given by
+ *
+ *   Y_k = coefficient * fittedFraction(alpha) * prod_{j} p_j (or 1 - p_j)
+ *
+ * Systematic uncertainties are taken into account by vertical template morphing:
+ * the template bin-contents and fitted fractions are shifted linearly by
+ * alpha*(up - central) for alpha > 0 and alpha*(central - down) for alpha < 0,
+ * the morphed templates are normalized to unit area afterwards.
+ *
+ * NOTE: up to constant terms, the negative log-likelihood is identical
+ *       to the one computed by RooFit for an extended RooSimultaneous fit of RooAddPdfs of RooHistPdfs
+ *       (or VerticalInterpPdfs) to binned data, with Gaussian external constraints.
+ *       Set compareFitBackends = True in the fitTauIdEff configuration
+ *       to repeat the nominal fit using RooFit and compare the results.
+ *
+ * NOTE: horizontal template morphing is not supported;
+ *       fitTauIdEff refuses to run with fitBackend = 'native' and templateMorphingMode = 'horizontal'.
+ *
+ */
+
+#include <Math/IFunction.h>
+#include <TH1.h>
+
+#include <string>
+#include <vector>
+
+class TauIdEffBinnedLikelihood : public ROOT::Math::IMultiGradFunction
+{
+ public:
+  /// constructor
+  TauIdEffBinnedLikelihood();
+
+  /// destructor
+  ~TauIdEffBinnedLikelihood();
+
+  /// define fit parameter; returns index of parameter
+  /// (no limits are applied in case min >= max)
+  unsigned addParameter(const std::string&, double, double, double, bool = false);
+
+  /// define channel (region) and event yields observed in it; returns index of channel
+  unsigned addChannel(const std::string&, const TH1*);
+
+  /// add process contributing to channel, with template shape given by histogram; returns index of component
+  unsigned addComponent(unsigned, const TH1*, double, double);
+
+  /// multiply expected event yield of component by parameter p (or 1 - p in case last argument is true)
+  void addYieldFactor(unsigned, unsigned, bool = false);
+
+  /// add vertical template morphing of component,
+  /// controlled by parameter given as second function argument
+  void addMorphing(unsigned, unsigned, const TH1*, const TH1*, double, double);
+
+  /// add Gaussian constraint on parameter
+  void addGaussianConstraint(unsigned, double, double);
+
+  void setParameterValue(unsigned, double);
+  void setParameterConstant(unsigned, bool);
+  /// set parameter uncertainty, used as initial step-size by Minuit
+  void setParameterError(unsigned, double);
+
+  /// set element of initial error matrix of Minuit
+  /// (used in case the initial covariance is defined for all floating parameters,
+  ///  e.g. in order to start fits of pseudo-experiments from result of nominal fit)
+  void setInitialCovariance(unsigned, unsigned, double);
+
+  /// enable computation of asymmetric (MINOS) errors for parameter
+  void setRunMinos(unsigned, bool = true);
+
+  /// set Minuit options
+  /// (default error level is 0.5, as appropriate for negative log-likelihood functions)
+  void setErrorLevel(double errorLevel) { errorLevel_ = errorLevel; }
+  void setTolerance(double tolerance) { tolerance_ = tolerance; }
+  void setStrategy(int strategy) { strategy_ = strategy; }
+  void setPrintLevel(int printLevel) { printLevel_ = printLevel; }
+  /// skip HESSE in case only fitted parameter values are needed
+  /// (uncertainties are then taken from error matrix estimated by MIGRAD)
+  void setRunHesse(bool runHesse) { runHesse_ = runHesse; }
+
+  /// minimize negative log-likelihood by Minuit2 (MIGRAD followed by HESSE, unless disabled,
+  /// and by MINOS for the parameters selected by setRunMinos);
+  /// fitted values are used as starting values of subsequent fits.
+  /// Returns true in case fit converged
+  bool fit();
+
+  unsigned getNumParameters() const { return parameters_.size(); }
+  const std::string& getParameterName(unsigned) const;
+  double getValue(unsigned) const;
+  double getError(unsigned) const;
+  /// asymmetric errors computed by MINOS (negative/positive);
+  /// symmetric (HESSE) errors are returned in case MINOS has not been run for parameter
+  double getErrorLow(unsigned) const;
+  double getErrorHigh(unsigned) const;
+  double getCovariance(unsigned, unsigned) const;
+  bool isConstant(unsigned) const;
+  int getStatus() const { return status_; }
+  double getMinimum() const { return minimum_; }
+  unsigned getNumFunctionCalls() const { return numFunctionCalls_; }
+
+  /// expected (morphed) template shape of component for current parameter values,
+  /// normalized to unit area
+  std::vector<double> getTemplateShape(unsigned) const;
+
+  /// interface to ROOT::Math::Minimizer
+  ROOT::Math::IMultiGradFunction* Clone() const;
+  unsigned int NDim() const { return parameters_.size(); }
+  void Gradient(const double*, double*) const;
+  void FdF(const double*, double&, double*) const;
+
+ private:
+  double DoEval(const double*) const;
+  double DoDerivative(const double*, unsigned int) const;
+
+  /// compute negative log-likelihood and, in case second argument is non-zero, its gradient
+  double evaluate(const double*, double*) const;
+
+  std::vector<double> getBinContents(const TH1*, unsigned) const;
+
+  struct parameterEntryType
+  {
+    std::string name_;
+    double value_;
+    double min_;
+    double max_;
+    bool isConstant_;
+    double error_;
+    bool runMinos_;
+    bool hasMinosErrors_;
+    double errorLow_;
+    double errorHigh_;
+  };
+  std::vector<parameterEntryType> parameters_;
+
+  struct channelEntryType
+  {
+    std::string name_;
+    unsigned firstBin_; // offset in data_ array
+    unsigned numBins_;
+    std::vector<unsigned> components_;
+  };
+  std::vector<channelEntryType> channels_;
+  std::vector<double> data_;
+
+  struct yieldFactorEntryType
+  {
+    unsigned idxParameter_;
+    bool isInverted_;
+  };
+  struct morphingEntryType
+  {
+    unsigned idxParameter_;
+    unsigned firstBinUp_;   // offset in shapes_ array of (up - central)
+    unsigned firstBinDown_; // offset in shapes_ array of (central - down)
+    double fittedFractionUp_;
+    double fittedFractionDown_;
+  };
+  struct componentEntryType
+  {
+    unsigned idxChannel_;
+    unsigned firstBin_; // offset in shapes_ array
+    double integral_;   // integral of central value template, before normalization
+    double coefficient_;
+    double fittedFraction_;
+    std::vector<yieldFactorEntryType> yieldFactors_;
+    std::vector<morphingEntryType> morphings_;
+  };
+  std::vector<componentEntryType> components_;
+  std::vector<double> shapes_;
+
+  struct constraintEntryType
+  {
+    unsigned idxParameter_;
+    double value_;
+    double error_;
+  };
+  std::vector<constraintEntryType> constraints_;
+
+  double errorLevel_;
+  double tolerance_;
+  int strategy_;
+  int printLevel_;
+  bool runHesse_;
+
+  std::vector<double> initialCovariance_;
+
+  int status_;
+  double minimum_;
+  unsigned numFunctionCalls_;
+  std::vector<double> covariance_;
+
+  // CV: buffers used for computation of likelihood values and derivatives,
+  //     allocated once, in order to avoid memory allocations in every call
+  mutable std::vector<double> morphedShapes_; // layout identical to shapes_
+  mutable std::vector<double> shapeNorms_;    // integral of morphed templates, before normalization
+  mutable std::vector<double> yields_;
+  mutable std::vector<double> weights_;       // layout identical to data_ (observed/expected event yield)
+};
+
+#endif
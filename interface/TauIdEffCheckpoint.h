@@ -0,0 +1,93 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffCheckpoint_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffCheckpoint_h
+
+/** \class TauIdEffCheckpoint
+ *
+ * Periodically save histograms and event counters of FWLite analyzers,
+ * together with the position (input file, event) up to which events have been processed,
+ * so that jobs killed before completion (batch wall-time limits, node preemption,...)
+ * can be resumed from the last checkpoint instead of being restarted from scratch.
+ *
+ * Usage:
+ *   o book all histograms (and set all counters to their initial values) before the checkpoint is created
+ *   o call resume before the event loop; in case a valid checkpoint exists,
+ *     histograms and counters are restored and the event loop continues from the position stored in the checkpoint
+ *   o call write at the beginning of each input file and every 'interval' events
+ *   o call remove once the output has been written
+ *
+ * NOTE: Histograms and counters are restored bit-by-bit,
+ *       hence the final output of a resumed job is identical to that of a job that was not interrupted.
+ *       The checkpoint is only accepted in case it has been written for the same configuration
+ *      (including the list of input files).
+ *
+ */
+
+#include <TDirectory.h>
+#include <TH1.h>
+
+#include <string>
+#include <vector>
+
+class TauIdEffCheckpoint
+{
+ public:
+  /// constructor
+  /// (all histograms contained in output directory and its subdirectories are saved,
+  ///  including histograms registered with TauIdEffHistogramBundle objects)
+  TauIdEffCheckpoint(const std::string&, const std::string&, TDirectory*, long = 0);
+
+  /// destructor
+  ~TauIdEffCheckpoint();
+
+  /// register event counters
+  /// (names need to be unique)
+  void addCounter(const std::string&, int*);
+  void addCounter(const std::string&, unsigned*);
+  void addCounter(const std::string&, double*);
+
+  /// restore histograms and counters from checkpoint file;
+  /// returns false in case no valid checkpoint exists.
+  /// Index of input file and number of events in that file processed already are returned via function arguments
+  bool resume(unsigned&, long&);
+
+  /// check if checkpoint needs to be written for given number of events processed in current input file
+  bool isDue(long numEvents) const { return ( numEvents > 0 && interval_ > 0 && (numEvents % interval_) == 0 ); }
+
+  /// write checkpoint
+  /// (index of input file, number of events in that file processed already)
+  void write(unsigned, long);
+
+  /// remove checkpoint file
+  /// (to be called once output has been written successfully)
+  void remove();
+
+ private:
+  void collectHistograms(TDirectory*, const std::string&);
+
+  std::string fileName_;
+  std::string configDigest_;
+
+  long interval_;
+
+  struct histogramEntryType
+  {
+    std::string path_; // relative to output directory
+    std::string name_;
+    TH1* histogram_;
+  };
+  std::vector<histogramEntryType> histograms_;
+
+  struct counterEntryType
+  {
+    std::string name_;
+    int* intCounter_;
+    unsigned* unsignedCounter_;
+    double* doubleCounter_;
+  };
+  std::vector<counterEntryType> counters_;
+
+  double getCounterValue(const counterEntryType&) const;
+  void setCounterValue(counterEntryType&, double);
+};
+
+#endif
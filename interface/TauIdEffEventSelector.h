@@ -21,10 +21,69 @@
 #include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEt.h"
 #include "DataFormats/PatCandidates/interface/MET.h"
 
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMiniTuple.h"
+
+#include <vector>
+#include <string>
+
 class TauIdEffEventSelector : public EventSelector 
 {
 
  public:
+  typedef std::vector<std::string> vstring;
+
+  /// quantities on which the selection is based,
+  /// extracted for a batch of muon + tau-jet pairs and stored in contiguous arrays
+  /// (one array per quantity, so that cuts can be evaluated for all pairs in tight loops)
+  struct inputBatchType
+  {
+    inputBatchType() {}
+    ~inputBatchType() {}
+
+    /// add tau id. discriminators the values of which need to be extracted
+    /// (union of discriminators used by all selectors that evaluate the batch)
+    void addTauIdDiscriminators(const vstring&);
+
+    /// extract quantities for one muon + tau-jet pair and append them to the arrays
+    /// (last parameter allows to shift/smear the tau-jet momentum "on-the-fly")
+    void push_back(const PATMuTauPair&, const pat::MET&, size_t, double = 1.);
+
+    /// specify order of tau id. discriminator values in TauIdEffMiniTupleEntry
+    /// (needs to be called before first entry gets added)
+    void setEntryTauIdDiscriminators(const vstring&);
+
+    /// take quantities from mini-tuple entry and append them to the arrays
+    /// (CaloMEt is given separately, as it may be shifted by systematic uncertainties)
+    void push_back(const TauIdEffMiniTupleEntry&, double);
+
+    void clear();
+
+    size_t size() const { return muonPt_.size(); }
+
+    std::vector<double> numJets_bTagged_;
+    std::vector<double> muonPt_;
+    std::vector<double> muonEta_;
+    std::vector<double> muonIso_;
+    std::vector<double> muonCharge_;
+    std::vector<double> tauPt_;
+    std::vector<double> tauEta_;
+    std::vector<double> tauLeadTrackPt_;
+    std::vector<double> tauIso_;
+    std::vector<double> tauLeadTrackCharge_;
+    std::vector<double> tauSignalChargedHadronSum_;
+    std::vector<double> muTauPairAbsDz_;
+    std::vector<double> visMass_;
+    std::vector<double> caloMEtPt_;
+    std::vector<double> pfMEtPt_;
+    std::vector<double> Mt_;
+    std::vector<double> PzetaDiff_;
+
+    vstring tauIdDiscriminatorNames_;
+    std::vector<std::vector<double> > tauIdDiscriminatorValues_;
+
+    std::vector<int> entryTauIdDiscriminatorIndices_;
+  };
+
   /// constructor
   TauIdEffEventSelector(edm::ParameterSet const&);
 
@@ -32,8 +91,26 @@ class TauIdEffEventSelector : public EventSelector
   virtual ~TauIdEffEventSelector();
 
   /// here is where the selection occurs
+  /// (selection of single muon + tau-jet pair is evaluated as batch of size one)
   bool operator()(const edm::EventBase&, pat::strbitset&) { return true; }
-  bool operator()(const PATMuTauPair&, const pat::MET&, size_t, pat::strbitset&);
+  bool operator()(const PATMuTauPair&, const pat::MET&, size_t, pat::strbitset&, double = 1.);
+  bool operator()(const TauIdEffMiniTupleEntry&, double, pat::strbitset&);
+
+  /// specify order of tau id. discriminator values in TauIdEffMiniTupleEntry
+  /// (needs to be called before selection of single mini-tuple entries is evaluated)
+  void setEntryTauIdDiscriminators(const vstring& entryTauIdDiscriminators) 
+  { 
+    singlePairInput_.setEntryTauIdDiscriminators(entryTauIdDiscriminators); 
+  }
+
+  /// evaluate selection for all muon + tau-jet pairs contained in batch;
+  /// flag is set to 1 (0) for pairs passing (failing) the selection
+  void operator()(const inputBatchType&, std::vector<unsigned char>&);
+
+  /// check if tau-jet candidate passes all tau id. discriminators given by their indices in TauIdEffMiniTupleEntry,
+  /// using the same thresholds as applied in the regions "p" and "f"
+  /// (used to evaluate nested working-points in one go)
+  bool passesTauIdDiscriminators(const TauIdEffMiniTupleEntry&, const std::vector<int>&) const;
 
   friend class regionEntryType; // allow regionEntryType to overwrite cut values
 
@@ -44,7 +121,6 @@ class TauIdEffEventSelector : public EventSelector
  
   /// list of tau id. discrimators
   /// (e.g. 'decayModeFinding' && 'byLooseCombinedIsolationDeltaBetaCorr')
-  typedef std::vector<std::string> vstring;
   vstring tauIdDiscriminators_;
 
   /// flag indicating whether to take charge of tau-jet candidate 
@@ -96,6 +172,15 @@ class TauIdEffEventSelector : public EventSelector
   double MtCutoffMax_;
 
   int debugMode_;
+
+  /// buffers used for evaluating selection of single muon + tau-jet pairs
+  /// and for intermediate results of batch evaluation
+  inputBatchType singlePairInput_;
+  std::vector<unsigned char> singlePairFlag_;
+  std::vector<unsigned char> tauCandPreselFlags_;
+  std::vector<unsigned char> MtAndPzetaDiffFlags_;
+  std::vector<unsigned char> tauIdDiscriminatorFlags_;
+  std::vector<double> muTauPairChargeProd_;
 };
 
 #endif
@@ -17,8 +17,7 @@
 
 #include "CommonTools/Utils/interface/TFileDirectory.h"
 
-#include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEt.h"
-#include "DataFormats/PatCandidates/interface/MET.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMiniTuple.h"
 
 #include <TH1.h>
 
@@ -34,7 +33,9 @@ class TauIdEffHistManager
 
   /// book and fill histograms
   void bookHistograms(TFileDirectory&);
-  void fillHistograms(const PATMuTauPair&, const pat::MET&, size_t, size_t, size_t, const std::map<std::string, bool>&, double);
+  /// (quantities of muon + tau-jet pair are taken from mini-tuple entry;
+  ///  CaloMEt is given separately, as it may be shifted by systematic uncertainties)
+  void fillHistograms(const TauIdEffMiniTupleEntry&, double, const std::map<std::string, bool>&, double);
   
   /// scale all bin-contents/bin-errors by factor given as function argument
   /// (to account for events lost, due to aborted skimming/crab or PAT-tuple production/lxbatch jobs)
@@ -45,6 +46,9 @@ class TauIdEffHistManager
   TH1* book1D(TFileDirectory&, const std::string&, const std::string&, int, double, double);
   TH1* book1D(TFileDirectory&, const std::string&, const std::string&, int, float*);
 
+  /// register histogram with TFileService (or with histogram bundle of directory)
+  TH1* registerHistogram(TFileDirectory&, TH1*);
+
   std::string getHistogramName(const std::string&);
 
  private:
@@ -101,6 +105,10 @@ class TauIdEffHistManager
   TH1* histogramEventCounter_;
   
   std::vector<TH1*> histograms_;
+
+  /// write histograms in compact TauIdEffHistogramBundle format
+  /// instead of writing each histogram individually
+  bool writeHistogramBundle_;
 };
 
 #endif
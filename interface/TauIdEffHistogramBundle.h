@@ -0,0 +1,122 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffHistogramBundle_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffHistogramBundle_h
+
+/** \class TauIdEffHistogramBundle
+ *
+ * Compact storage format for the one-dimensional histograms of one ROOT directory.
+ *
+ * The binning definitions, bin-contents and sums of squared weights of all histograms
+ * are kept in a few contiguous arrays, together with the names and titles of the histograms,
+ * so that the whole directory is written, merged (by hadd) and read as one single object,
+ * avoiding the per-object TKey and TH1 streaming overhead.
+ *
+ * Histograms to be written are booked as ordinary (detached) TH1 objects and registered with the bundle,
+ * which takes ownership of them. Their bin-contents are copied into the bundle when the bundle is written,
+ * so that the histograms may still be filled and scaled after they have been registered.
+ *
+ * Histograms are restored as ordinary TH1D objects by the makeHistogram methods
+ * (TauIdEffKeyCatalog does that transparently for all bundles contained in a directory,
+ *  the convertTauIdEffHistogramBundles executable converts whole files for interactive use).
+ *
+ */
+
+#include "CommonTools/Utils/interface/TFileDirectory.h"
+
+#include <TNamed.h>
+#include <TH1.h>
+#include <TCollection.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class TauIdEffHistogramBundle : public TNamed
+{
+ public:
+  /// default constructor (needed for reading bundles from ROOT files)
+  TauIdEffHistogramBundle();
+
+  /// constructor
+  TauIdEffHistogramBundle(const char*, const char*);
+
+  /// destructor
+  ~TauIdEffHistogramBundle();
+
+  /// register histogram to be written as part of the bundle;
+  /// the bundle takes ownership of the histogram
+  void addHistogram(TH1*);
+
+  /// copy bin-contents of all registered histograms into the bundle
+  /// (done automatically when the bundle is written)
+  void pack();
+
+  unsigned getNumHistograms() const { return histogramNames_.size(); }
+  const std::string& getHistogramName(unsigned idx) const { return histogramNames_.at(idx); }
+
+  /// return histogram registered by addHistogram
+  /// (0 in case the histogram has been read from file)
+  TH1* getRegisteredHistogram(unsigned idx) const { return ( idx < histograms_.size() ) ? histograms_[idx] : 0; }
+
+  /// return index of histogram given as function argument,
+  /// -1 in case the histogram is not contained in the bundle
+  int findHistogram(const std::string&) const;
+
+  /// restore histogram as TH1D object;
+  /// the histogram is not attached to any directory, the caller takes ownership
+  TH1* makeHistogram(unsigned) const;
+  TH1* makeHistogram(const std::string&) const;
+
+  /// add bin-contents of bundles given as function argument
+  /// (called by hadd; histograms with equal names are added, others are appended)
+  Long64_t Merge(TCollection*);
+
+  /// pack registered histograms before writing
+  /// (both overloads of TObject::Write are overridden, so that neither is hidden)
+  Int_t Write(const char* = 0, Int_t = 0, Int_t = 0) const;
+  Int_t Write(const char* = 0, Int_t = 0, Int_t = 0);
+
+  /// return bundle stored in directory given as function argument,
+  /// creating a new bundle in case none exists yet
+  static TauIdEffHistogramBundle* getBundle(TFileDirectory&);
+
+  static const char* defaultName() { return "histogramBundle"; }
+
+ private:
+  /// reserve space for histogram with given name, title and binning;
+  /// return index of the new histogram
+  unsigned addEntry(const std::string&, const std::string&, int, double, double, const double*);
+
+  /// check if histogram idx1 of this bundle and histogram idx2 of bundle given as function argument
+  /// have the same binning
+  bool isCompatibleBinning(unsigned, const TauIdEffHistogramBundle&, unsigned) const;
+
+  /// names and titles of histograms
+  std::vector<std::string> histogramNames_;
+  std::vector<std::string> histogramTitles_;
+
+  /// binning definitions:
+  /// number of bins, range and offset of bin-edges in binEdges_ array
+  /// (-1 in case of uniform binning)
+  std::vector<int> numBins_;
+  std::vector<double> xMin_;
+  std::vector<double> xMax_;
+  std::vector<int> binEdgesOffsets_;
+  std::vector<double> binEdges_;
+
+  /// bin-contents and sums of squared weights (including underflow and overflow bins);
+  /// the bins of histogram i start at binContentsOffsets_[i]
+  std::vector<int> binContentsOffsets_;
+  std::vector<double> binContents_;
+  std::vector<double> sumw2_;
+  std::vector<double> numEntries_;
+
+  /// histograms registered by addHistogram (not written to file)
+  std::vector<TH1*> histograms_; //!
+
+  /// index of histograms by name (not written to file, rebuilt after reading)
+  mutable std::map<std::string, unsigned> index_; //!
+
+  ClassDef(TauIdEffHistogramBundle, 1)
+};
+
+#endif
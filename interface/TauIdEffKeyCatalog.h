@@ -0,0 +1,84 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffKeyCatalog_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffKeyCatalog_h
+
+/** \class TauIdEffKeyCatalog
+ *
+ * Catalog of the objects stored in one ROOT file/directory,
+ * used to load many histograms from large (merged) files efficiently.
+ *
+ * The keys of the directory are enumerated once, when the catalog is created,
+ * and indexed by name in a hash table (the key with the highest cycle number is taken in case of multiple cycles).
+ * Objects are either loaded one at a time on first access,
+ * or in bulk: all objects requested before calling loadRequested are read in one pass,
+ * ordered by their position in the file.
+ * Objects are loaded only once and kept for subsequent accesses.
+ *
+ * Histograms stored in TauIdEffHistogramBundle objects are indexed like ordinary keys;
+ * they are restored as TH1D objects on access and attached to the directory,
+ * so that callers cannot tell them apart from histograms stored individually
+ * (in case a histogram is stored both individually and in a bundle, the individual histogram takes precedence).
+ *
+ */
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include <TDirectory.h>
+#include <TKey.h>
+#include <TObject.h>
+
+#include <string>
+#include <vector>
+#include <tr1/unordered_map>
+
+class TauIdEffKeyCatalog
+{
+ public:
+  /// constructor
+  TauIdEffKeyCatalog(TDirectory*);
+
+  /// destructor
+  ~TauIdEffKeyCatalog();
+
+  /// check if object of given name exists in directory
+  bool contains(const std::string&) const;
+
+  /// request object of given name to be loaded by next call to loadRequested
+  /// (names of objects that do not exist in directory are ignored)
+  void request(const std::string&);
+
+  /// load all requested objects in one pass
+  void loadRequested();
+
+  /// return object of given name,
+  /// loading it in case it has not been loaded yet (0 in case object does not exist)
+  TObject* get(const std::string&);
+
+  TDirectory* getDirectory() const { return directory_; }
+
+  unsigned numKeys() const { return keys_.size(); }
+  unsigned numObjectsLoaded() const { return numObjectsLoaded_; }
+
+ private:
+  TDirectory* directory_;
+
+  struct keyEntryType
+  {
+    TKey* key_;
+    TauIdEffHistogramBundle* bundle_; // set instead of key_ for histograms stored in bundles
+    unsigned bundleIdx_;
+    TObject* object_;
+    bool isRequested_;
+  };
+
+  void loadObject(keyEntryType&);
+  typedef std::tr1::unordered_map<std::string, keyEntryType> keyIndexType;
+  keyIndexType keys_;
+
+  std::vector<keyEntryType*> requestedKeys_;
+
+  std::vector<TauIdEffHistogramBundle*> bundles_;
+
+  unsigned numObjectsLoaded_;
+};
+
+#endif
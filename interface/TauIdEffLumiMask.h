@@ -0,0 +1,62 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffLumiMask_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffLumiMask_h
+
+/** \class TauIdEffLumiMask
+ *
+ * Select events by run-range and certified luminosity sections,
+ * given in the JSON format used by the CMS DQM certification
+ * ( { "run1" : [ [ firstLumiSection1, lastLumiSection1 ], [ firstLumiSection2, lastLumiSection2 ],... ], "run2" : ... } ).
+ *
+ * NOTE: The certified luminosity sections of each run are stored as bit-mask indexed by luminosity section number.
+ *       Events are sorted by run number within input files,
+ *       so that the look-up of the run in the map is needed once per run only
+ *       and the check if a given (run, luminosity section) pair is selected takes constant time.
+ *
+ */
+
+#include "DataFormats/Provenance/interface/EventID.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+class TauIdEffLumiMask
+{
+ public:
+  /// constructor
+  /// (all luminosity sections are selected in case no JSON file is given;
+  ///  first and last run are ignored in case they are set to -1)
+  TauIdEffLumiMask(const std::string&, int = -1, int = -1);
+
+  /// destructor
+  ~TauIdEffLumiMask();
+
+  /// check if any luminosity section of given run is selected
+  bool passesRun(edm::RunNumber_t) const;
+
+  /// check if given (run, luminosity section) pair is selected
+  bool operator()(edm::RunNumber_t, edm::LuminosityBlockNumber_t) const;
+
+  /// string representing run-range and all selected luminosity sections;
+  /// used as part of configuration digests
+  std::string toString() const;
+
+  bool isEmpty() const { return ( !hasLumiMask_ && firstRun_ == -1 && lastRun_ == -1 ); }
+
+ private:
+  void readJSON(const std::string&);
+
+  int firstRun_;
+  int lastRun_;
+
+  bool hasLumiMask_;
+
+  typedef std::vector<bool> lumiSectionMask;
+  std::map<edm::RunNumber_t, lumiSectionMask> runs_;
+
+  mutable edm::RunNumber_t lastRun_cached_;
+  mutable const lumiSectionMask* lastRunEntry_cached_;
+  mutable bool lastRun_isCached_;
+};
+
+#endif
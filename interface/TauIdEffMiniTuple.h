@@ -0,0 +1,239 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffMiniTuple_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffMiniTuple_h
+
+/** \class TauIdEffMiniTuple
+ *
+ * Compact "mini-tuple" format for fast re-analysis of muon + tau-jet pairs
+ * selected for the tau id. efficiency and tau charge misidentification rate measurements:
+ * all quantities needed by FWLiteTauIdEffAnalyzer, FWLiteTauIdEffPreselNumbers and FWLiteTauChargeMisIdPreselNumbers
+ * are extracted once per muon + tau-jet pair (by FWLiteTauIdEffMiniTupleProducer)
+ * and stored as flat columns of 32-bit numbers (64-bit for the event weight), so that changes of cuts and regions
+ * can be studied without deserializing PAT objects.
+ *
+ * File layout:
+ *   o preamble:  magic string, version, offset of trailer
+ *   o blocks:    number of rows, followed by the values of each column for these rows
+ *               (at most 'blockSize' rows per block, all blocks but the last one are full)
+ *   o trailer:   block size, column names and sizes, names of systematic shifts, trigger bits and tau id. discriminators,
+ *                named event counters and offsets of all blocks
+ *
+ * NOTE: numbers are stored in the byte order of the machine writing the file.
+ *       The reader maps the file into memory and accesses the columns in place.
+ *
+ */
+
+#include "AnalysisDataFormats/TauAnalysis/interface/CompositePtrCandidateT1T2MEt.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdint.h>
+
+// define codes for generator level tau decay modes
+// (cf. TauAnalysis/CandidateTools/interface/candidateAuxFunctions.h)
+enum { kGenTauDecayModeUndefined, kGenTauDecayOneProng, kGenTauDecayThreeProng, kGenTauDecayRare,
+       kGenTauDecayElectron, kGenTauDecayMuon, kGenTauDecayOther };
+
+int getGenTauDecayModeCode(const std::string&);
+
+/// quantities stored for one muon + tau-jet pair
+/// (kept in double precision in memory, so that cuts applied to muon + tau-jet pairs read from PAT-tuples
+///  are not affected by the mini-tuple format; narrowed to 32-bit floats by TauIdEffMiniTupleWriter only)
+struct TauIdEffMiniTupleEntry
+{
+  TauIdEffMiniTupleEntry();
+
+  // event level quantities
+  unsigned run_;
+  unsigned ls_;
+  unsigned event_;
+  unsigned idxSysShift_;          // index in list of systematic shifts stored in file
+  double   evtWeight_;            // product of event weights, before cut-off and trigger efficiency correction
+  unsigned numVertices_;
+  unsigned triggerBits_;          // bit i set if trigger bit i in list stored in file passed
+  double   caloMEtPt_;            // not shifted by CaloMEt response uncertainty
+  double   caloMEtSumEt_;
+
+  // muon + tau-jet pair level quantities
+  unsigned idxMuTauPair_;
+  unsigned numJets_;
+  unsigned numJets_bTagged_;
+  unsigned numJets_bTagged_noCleaning_; // b-tagged jets not cleaned wrt. muon and tau-jet
+  unsigned genMatchType_;         // cf. TauAnalysis/TauIdEfficiency/interface/tauIdEffAuxFunctions.h
+  double   genTauCharge_;
+  unsigned genTauDecayMode_;
+  double   muonPt_;
+  double   muonEta_;
+  double   muonPhi_;
+  double   muonCharge_;
+  double   muonIso_;              // absolute, deltaBeta corrected isolation Pt sum
+  double   muonIsoProb_;          // muon isolation probability for "_mW" regions
+  double   tauPt_;
+  double   tauEta_;
+  double   tauPhi_;
+  double   tauCharge_;            // sum of charges of all "signal" charged hadrons
+  double   tauLeadTrackPt_;
+  double   tauLeadTrackCharge_;
+  double   tauIso_;
+  double   tauHasLeadTrack_;
+  double   tauPFElectronMVA_;
+  double   tauDRnearestMuon_;
+  double   tauNumTracks_;
+  double   tauNumSelTracks_;
+  double   muTauPairAbsDz_;
+  double   visMass_;
+  double   svFitMass_;            // -1 if no SVfit solution available
+  double   Mt_;
+  double   PzetaDiff_;
+  double   pfMEtPt_;
+  double   pfMEtSumEt_;
+
+  std::vector<double> tauIdDiscriminatorValues_; // in order of list of tau id. discriminators stored in file
+};
+
+/// extract pair level quantities
+/// (shift factor allows to shift/smear the tau-jet momentum "on-the-fly",
+///  optionally together with the matching shifted MEt, cf. compMuTauPairKinematics;
+///  SVfit mass is shifted by the same ratio as the visible mass)
+void fillMiniTupleEntry(const PATMuTauPair&, double, const std::string&,
+			const std::vector<std::string>&, TauIdEffMiniTupleEntry&,
+			const reco::Candidate::LorentzVector* = 0);
+
+namespace TauIdEffMiniTuple
+{
+  typedef std::vector<std::string> vstring;
+
+  enum { kUInt, kFloat, kDouble };
+  enum { kAlways, kMuonIsoProb, kSVfitMass, kGenMatch };
+
+  struct columnDefType
+  {
+    const char* name_;
+    int type_;
+    int group_; // columns not belonging to group 'kAlways' are optional
+    unsigned TauIdEffMiniTupleEntry::* uintMember_;
+    double TauIdEffMiniTupleEntry::* doubleMember_; // stored as 32-bit (kFloat) or 64-bit (kDouble) number
+    double defaultValue_;
+  };
+
+  const columnDefType* getColumnDefs(size_t&);
+}
+
+class TauIdEffMiniTupleWriter
+{
+ public:
+  typedef std::vector<std::string> vstring;
+
+  /// constructor
+  /// (optional columns: muon isolation probability, SVfit mass and generator level matching)
+  TauIdEffMiniTupleWriter(const std::string&, const vstring&, const vstring&, const vstring&,
+			  bool, bool, bool, unsigned = 4096);
+
+  /// destructor
+  /// (closes file in case it has not been closed yet)
+  ~TauIdEffMiniTupleWriter();
+
+  /// append muon + tau-jet pair
+  void fill(const TauIdEffMiniTupleEntry&);
+
+  /// set value of named event counter
+  /// (e.g. number of processed events, needed for normalization of Monte Carlo samples)
+  void setCounter(const std::string&, double);
+
+  /// write pending rows and trailer
+  void close();
+
+ private:
+  /// copying not supported (owns output file)
+  TauIdEffMiniTupleWriter(const TauIdEffMiniTupleWriter&);
+  TauIdEffMiniTupleWriter& operator=(const TauIdEffMiniTupleWriter&);
+
+  void writeBlock();
+
+  std::string fileName_;
+  std::ofstream* outputFile_;
+
+  vstring sysShifts_;
+  vstring triggerBits_;
+  vstring tauIdDiscriminators_;
+
+  std::vector<const TauIdEffMiniTuple::columnDefType*> columns_;
+  size_t numFixedColumns_;
+
+  unsigned blockSize_;
+  std::vector<std::vector<uint32_t> > columnBuffers_;
+  size_t numRowsBuffered_;
+
+  std::vector<uint64_t> blockOffsets_;
+  std::vector<uint32_t> blockNumRows_;
+
+  std::map<std::string, double> counters_;
+};
+
+class TauIdEffMiniTupleReader
+{
+ public:
+  typedef std::vector<std::string> vstring;
+
+  /// constructor
+  /// (maps file into memory, throws cms::Exception in case file cannot be read)
+  TauIdEffMiniTupleReader(const std::string&);
+
+  /// destructor
+  ~TauIdEffMiniTupleReader();
+
+  size_t numEntries() const { return numEntries_; }
+
+  /// retrieve muon + tau-jet pair given by index
+  void getEntry(size_t, TauIdEffMiniTupleEntry&) const;
+
+  /// retrieve all muon + tau-jet pairs of the event (and all systematic shifts) starting at given index;
+  /// returns index of first muon + tau-jet pair of next event
+  size_t readEvent(size_t, std::vector<TauIdEffMiniTupleEntry>&) const;
+
+  const vstring& sysShifts() const { return sysShifts_; }
+  const vstring& triggerBits() const { return triggerBits_; }
+  const vstring& tauIdDiscriminators() const { return tauIdDiscriminators_; }
+
+  bool hasColumn(const std::string&) const;
+
+  bool hasCounter(const std::string& name) const { return counters_.find(name) != counters_.end(); }
+  double getCounter(const std::string&) const;
+
+ private:
+  /// copying not supported (owns memory mapping and file descriptor)
+  TauIdEffMiniTupleReader(const TauIdEffMiniTupleReader&);
+  TauIdEffMiniTupleReader& operator=(const TauIdEffMiniTupleReader&);
+
+  /// parse preamble and trailer of mapped file
+  void readTrailer();
+
+  std::string fileName_;
+
+  int fileDescriptor_;
+  const char* data_;
+  size_t dataSize_;
+
+  size_t numEntries_;
+  unsigned blockSize_;
+
+  vstring sysShifts_;
+  vstring triggerBits_;
+  vstring tauIdDiscriminators_;
+
+  vstring columnNames_;
+  std::vector<uint32_t> columnSizes_;   // in units of 32-bit words
+  std::vector<size_t> columnOffsets_;   // in units of 32-bit words per row of the block
+  size_t rowSize_;                      // in units of 32-bit words
+  std::vector<const TauIdEffMiniTuple::columnDefType*> columns_; // 0 for tau id. discriminator columns
+  std::vector<int> columnTauIdDiscriminatorIndices_;
+  std::vector<const TauIdEffMiniTuple::columnDefType*> missingColumns_;
+
+  std::vector<uint64_t> blockOffsets_;
+  std::vector<uint32_t> blockNumRows_;
+
+  std::map<std::string, double> counters_;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffMorphedTemplatePdf_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffMorphedTemplatePdf_h
+
+/** \class TauIdEffMorphedTemplatePdf
+ *
+ * Binned pdf for template fits with shape systematics,
+ * replacing VerticalInterpPdf (vertical morphing) and RooIntegralMorph (horizontal morphing).
+ *
+ * All quantities needed for the interpolation are precomputed once, when the pdf is constructed:
+ *   o vertical morphing:
+ *       per-bin differences (up - central) and (central - down) of the templates normalized to unit area;
+ *       the morphed template is central + sum_{i} alpha_i*(up - central) for alpha_i > 0
+ *       (alpha_i*(central - down) for alpha_i < 0), same as for VerticalInterpPdf
+ *   o horizontal morphing:
+ *       table of x-values at which the cumulative distributions of the "up" and "down" templates
+ *       reach the same value y (interpolation technique of A. Read, NIM A 425 (1999) 357, as used by RooIntegralMorph).
+ *       For morphing parameter alpha, the cumulative distribution of the morphed template
+ *       reaches value y at x = alpha*x_up(y) + (1 - alpha)*x_down(y);
+ *       alpha = 1 (0) corresponds to the "up" ("down") template, alpha = 0.5 is halfway between the two
+ *      (same convention as for RooIntegralMorph with the "up" ("down") template passed as first (second) pdf).
+ *       As the cumulative distributions of histograms are piecewise linear,
+ *       the morphed template is computed exactly, without sampling on a grid.
+ *
+ * In case of vertical morphing, bin-contents which are zero or negative after morphing are set to 1.e-9,
+ * so that the pdf stays positive and the logarithm of the likelihood function remains finite
+ * (VerticalInterpPdf applies the same protection to the morphed pdf values).
+ * The floor is far below the (normalized) bin-contents of any template used in the fit,
+ * so it affects the fit only in case the morphed template becomes negative.
+ *
+ * The morphed bin-contents are computed once per set of morphing parameter values
+ * and cached for all subsequent evaluations of the pdf.
+ *
+ */
+
+#include "RooAbsPdf.h"
+#include "RooAbsReal.h"
+#include "RooArgList.h"
+#include "RooArgSet.h"
+#include "RooRealProxy.h"
+#include "RooListProxy.h"
+
+#include <TH1.h>
+
+#include <vector>
+
+class TauIdEffMorphedTemplatePdf : public RooAbsPdf
+{
+ public:
+  enum { kVerticalMorphing, kHorizontalMorphing };
+
+  /// default constructor (needed by ROOT I/O)
+  TauIdEffMorphedTemplatePdf();
+
+  /// constructor for vertical morphing:
+  /// template histograms for "up" and "down" shifts are given in same order as morphing parameters
+  TauIdEffMorphedTemplatePdf(const char*, const char*, RooAbsReal&,
+			     const TH1*, const std::vector<const TH1*>&, const std::vector<const TH1*>&, const RooArgList&);
+
+  /// constructor for horizontal morphing
+  TauIdEffMorphedTemplatePdf(const char*, const char*, RooAbsReal&,
+			     const TH1*, const TH1*, RooAbsReal&);
+
+  /// copy constructor
+  TauIdEffMorphedTemplatePdf(const TauIdEffMorphedTemplatePdf&, const char* = 0);
+
+  /// destructor
+  ~TauIdEffMorphedTemplatePdf() {}
+
+  TObject* clone(const char* newName) const { return new TauIdEffMorphedTemplatePdf(*this, newName); }
+
+  Int_t getAnalyticalIntegral(RooArgSet&, RooArgSet&, const char* = 0) const;
+  Double_t analyticalIntegral(Int_t, const char* = 0) const;
+
+  /// morphed bin-contents for current values of morphing parameters
+  /// (bin-contents of underflow and overflow bins not included)
+  const std::vector<double>& getMorphedBinContents() const;
+
+ protected:
+  Double_t evaluate() const;
+
+ private:
+  std::vector<double> getBinContents(const TH1*) const;
+  void initializeHorizontalMorphing(const TH1*, const TH1*);
+
+  void updateMorphedBinContents() const;
+
+  RooRealProxy x_;
+  RooListProxy alphas_;
+
+  int mode_;
+
+  std::vector<double> binEdges_;
+  unsigned numBins_;
+
+  // vertical morphing
+  std::vector<double> central_;
+  std::vector<std::vector<double> > shiftsUp_;   // (up - central) for each morphing parameter
+  std::vector<std::vector<double> > shiftsDown_; // (central - down) for each morphing parameter
+
+  // horizontal morphing
+  std::vector<double> quantileY_;     // values of cumulative distribution
+  std::vector<double> quantileXup_;   // x-values at which cumulative distribution of "up" template reaches value y
+  std::vector<double> quantileXdown_; // x-values at which cumulative distribution of "down" template reaches value y
+
+  // cached morphed bin-contents
+  mutable std::vector<double> lastAlphas_;         //!
+  mutable bool isCacheValid_;                      //!
+  mutable std::vector<double> morphedBinContents_; //!
+
+  ClassDef(TauIdEffMorphedTemplatePdf, 1)
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffPlotQueue_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffPlotQueue_h
+
+/** \class TauIdEffPlotQueue
+ *
+ * Render control plots and final plots in the background,
+ * so that the numerical results of fitTauIdEff, makeTauIdEffFinalPlots and makeTauFakeRatePlots
+ * do not need to wait for the canvases to be painted and the .eps/.png/.pdf files to be written.
+ *
+ * The plots are passed to the queue as fully drawn canvases. Three modes of operation are supported:
+ *   o numWorkers = 0 (default):
+ *       canvases are printed immediately, by the calling process
+ *   o numWorkers > 0:
+ *       each canvas is printed by a forked worker process, which inherits a copy of the canvas and of all objects drawn on it;
+ *       at most numWorkers canvases are printed at the same time (addPlot waits for a worker to finish in case all are busy)
+ *   o plotInputFileName != "":
+ *       canvases are not printed at all, but written to a ROOT file (including all objects drawn on them),
+ *       to be rendered later by the renderTauIdEffPlots executable
+ *
+ * The caller may modify or delete the canvas and the objects drawn on it as soon as addPlot returns.
+ *
+ * NOTE: ROOT is not thread-safe, so the plots are rendered by worker processes instead of threads.
+ *
+ */
+
+#include <TCanvas.h>
+#include <TFile.h>
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class TauIdEffPlotQueue
+{
+ public:
+  /// constructor
+  /// (number of worker processes, name of ROOT file in which canvases are stored in case rendering is deferred)
+  TauIdEffPlotQueue(unsigned, const std::string& = "");
+
+  /// destructor (waits for all plots to be rendered)
+  ~TauIdEffPlotQueue();
+
+  /// print canvas into the files given as function argument
+  /// (file type is determined by extension of file name)
+  void addPlot(TCanvas*, const std::vector<std::string>&);
+
+  /// wait for all worker processes to finish
+  /// (or close ROOT file in which canvases are stored in case rendering is deferred);
+  /// return number of plots that failed to be rendered
+  unsigned finish();
+
+  unsigned numPlots() const { return numPlots_; }
+  bool isDeferred() const { return ( plotInputFileName_ != "" ); }
+
+  /// return names of files into which a plot is printed:
+  /// the file type given by the extension of outputFileName (if any)
+  /// plus the file types given by the space separated list of extensions passed as second function argument
+  static std::vector<std::string> getOutputFileNames(const std::string&, const std::string&);
+
+  /// print canvas into the files given as function argument
+  static void printCanvas(TCanvas*, const std::vector<std::string>&);
+
+  /// suffix of keys under which the names of the files into which a canvas is printed
+  /// are stored in case rendering is deferred
+  static const char* outputFileNamesSuffix() { return "_outputFileNames"; }
+
+ private:
+  /// store canvas in ROOT file, to be rendered later
+  void writePlot(TCanvas*, const std::vector<std::string>&);
+
+  /// wait for one of the worker processes started by this queue to finish
+  /// (child processes not started by this queue are left untouched)
+  void waitForWorker();
+
+  unsigned numWorkers_;
+
+  std::string plotInputFileName_;
+  TFile* plotInputFile_;
+
+  std::map<pid_t, std::string> runningWorkers_; // value = name of first file into which canvas is printed (for error messages)
+
+  unsigned numPlots_;
+  unsigned numPlotsFailed_;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffResultCache_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffResultCache_h
+
+/** \class TauIdEffResultCache
+ *
+ * Cache histograms and event counters filled by FWLite analyzers per input file,
+ * in order to avoid reprocessing input files that did not change when an analysis job is rerun.
+ *
+ * The partial result of each input file is stored in a separate ROOT file in the cache directory.
+ * The name of that file is the MD5 digest of the input file identity
+ * (file name, size and modification time; or ROOT file UUID in case the file is not accessible via the local file-system)
+ * and of a "digest" string representing all configuration parameters that affect the result.
+ *
+ * Usage:
+ *   o book all histograms (and set all counters to their initial values) before the cache is created
+ *   o for each input file, either call load (cache hit) or beginFile + processing + endFile (cache miss)
+ *   o call finish, which sets histograms and counters to the sum over all input files
+ *
+ * Histograms registered with a TauIdEffHistogramBundle (writeHistogramBundles = True) are cached as ordinary histograms.
+ *
+ * Counters registered via addLumiBlockCounter (e.g. integrated luminosity) are incremented once per luminosity section.
+ * The increments are cached per luminosity section, so that luminosity sections split across input files are counted once only,
+ * independent of which input files are taken from the cache.
+ *
+ * NOTE: The cache keys do not account for changes of the code or of auxiliary files referenced in the configuration
+ *      (e.g. weight files of k-NN trees); the cache directory needs to be cleared manually in such cases.
+ *
+ */
+
+#include <TDirectory.h>
+#include <TH1.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <utility>
+
+class TauIdEffResultCache
+{
+ public:
+  /// constructor
+  /// (all histograms contained in output directory and its subdirectories are cached)
+  TauIdEffResultCache(const std::string&, const std::string&, TDirectory*);
+
+  /// destructor
+  ~TauIdEffResultCache();
+
+  /// register event counters
+  /// (names need to be unique)
+  void addCounter(const std::string&, int*);
+  void addCounter(const std::string&, double*);
+
+  /// register event counters which are incremented once per luminosity section
+  void addLumiBlockCounter(const std::string&, double*);
+
+  /// record increments of counters registered via addLumiBlockCounter for luminosity section (run, ls) of current input file
+  /// (increments need to be given in the order in which the counters have been registered)
+  void addLumiBlock(unsigned, unsigned, const std::vector<double>&);
+
+  /// check if result for input file given as function argument is cached;
+  /// if it is, add cached histograms and counters to sum over all input files
+  bool load(const std::string&);
+
+  /// reset histograms and counters before processing an input file
+  void beginFile();
+
+  /// store histograms and counters after processing an input file
+  /// and add them to sum over all input files
+  void endFile(const std::string&);
+
+  /// set histograms and counters to sum over all input files
+  void finish();
+
+  unsigned numFilesLoaded() const { return numFilesLoaded_; }
+  unsigned numFilesStored() const { return numFilesStored_; }
+
+ private:
+  std::string getCacheFileName(const std::string&) const;
+
+  void collectHistograms(TDirectory*, const std::string&);
+  void addHistogram(TH1*, const std::string&);
+
+  std::string cacheDirectory_;
+  std::string configDigest_;
+
+  struct histogramEntryType
+  {
+    std::string path_; // relative to output directory
+    std::string name_;
+    TH1* histogram_;
+    TH1* histogramSum_;
+  };
+  std::vector<histogramEntryType> histograms_;
+
+  struct counterEntryType
+  {
+    std::string name_;
+    int* intCounter_;
+    double* doubleCounter_;
+    double sum_;
+  };
+  std::vector<counterEntryType> counters_;
+
+  std::vector<size_t> lumiBlockCounterIndices_;
+
+  struct lumiBlockEntryType
+  {
+    unsigned run_;
+    unsigned ls_;
+    std::vector<double> increments_;
+  };
+  std::vector<lumiBlockEntryType> currentLumiBlocks_;
+
+  typedef std::pair<unsigned, unsigned> lumiBlockType;
+  std::set<lumiBlockType> countedLumiBlocks_;
+
+  /// subtract increments of luminosity sections counted already for another input file from sums over all input files
+  void subtractDuplicateLumiBlocks(const std::vector<lumiBlockEntryType>&);
+
+  unsigned numFilesLoaded_;
+  unsigned numFilesStored_;
+};
+
+#endif
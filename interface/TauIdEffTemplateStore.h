@@ -0,0 +1,228 @@
+#ifndef TauAnalysis_TauIdEfficiency_TauIdEffTemplateStore_h
+#define TauAnalysis_TauIdEfficiency_TauIdEffTemplateStore_h
+
+/** \class TauIdEffTemplateStore
+ *
+ * Store for template histograms (or event yields), indexed by process, region, observable and systematic shift.
+ *
+ * Replacement for the nested std::map<std::string, ...> types histogramMap4/valueMap3 defined in bin/tauIdEffAuxFunctions.h:
+ * the keys of each dimension are interned, i.e. mapped to dense integer indices once, when they are first added,
+ * and the entries are kept in one contiguous array, which is addressed by the integer indices.
+ * Inner loops resolve the indices of all keys they need before the loop,
+ * so that no strings need to be compared or allocated inside the loop.
+ *
+ * Entries that have not been set are distinguished from entries that have been set to the default value of T.
+ *
+ * NOTE: the store is used by fitTauIdEff (fit inputs and pseudo-experiments) and makeTauIdEffQCDtemplate.
+ *       The nested maps are kept where they do not index (process, region, observable, systematic shift)
+ *       or are accessed at setup time only:
+ *        o processEntryType in fitTauIdEff, which builds the RooFit model once per fit
+ *          from the histograms of one process (setEntries/getEntries convert at that interface)
+ *        o compTauIdEffFinalNumbers, whose maps are keyed by (tau id. discriminator, fit variable)
+ *        o the fake-rate tools (bin/tauFakeRateAuxFunctions.h), whose histograms are keyed by
+ *          (event selection, process, tau id. discriminator, observable, region)
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <tr1/unordered_map>
+
+class TauIdEffKeyIndex
+{
+ public:
+  /// constructor
+  TauIdEffKeyIndex() {}
+
+  /// destructor
+  ~TauIdEffKeyIndex() {}
+
+  /// return index of key given as function argument,
+  /// adding the key in case it does not yet exist
+  unsigned intern(const std::string&);
+
+  /// return index of key given as function argument,
+  /// -1 in case the key does not exist
+  int find(const std::string&) const;
+
+  const std::string& getKey(unsigned idx) const { return keys_.at(idx); }
+  const std::vector<std::string>& getKeys() const { return keys_; }
+
+  unsigned size() const { return keys_.size(); }
+
+ private:
+  typedef std::tr1::unordered_map<std::string, unsigned> indexMapType;
+  indexMapType indices_;
+  std::vector<std::string> keys_;
+};
+
+template <typename T>
+class TauIdEffTemplateStore
+{
+ public:
+  enum { kProcess, kRegion, kObservable, kSysShift, kNumDimensions };
+
+  /// constructor
+  TauIdEffTemplateStore(const T& defaultValue = T())
+    : defaultValue_(defaultValue)
+  {
+    for ( int iDimension = 0; iDimension < kNumDimensions; ++iDimension ) {
+      capacities_[iDimension] = 0;
+    }
+  }
+
+  /// destructor
+  ~TauIdEffTemplateStore() {}
+
+  /// return index of key in dimension (process, region, observable or systematic shift) given as function argument,
+  /// adding the key in case it does not yet exist
+  unsigned intern(int dimension, const std::string& key)
+  {
+    unsigned idx = keyIndices_[dimension].intern(key);
+    if ( idx >= capacities_[dimension] ) resize(dimension, ( capacities_[dimension] > 0 ) ? 2*capacities_[dimension] : 4);
+    return idx;
+  }
+
+  /// return index of key, -1 in case the key does not exist
+  int find(int dimension, const std::string& key) const { return keyIndices_[dimension].find(key); }
+
+  const std::string& getKey(int dimension, unsigned idx) const { return keyIndices_[dimension].getKey(idx); }
+  const std::vector<std::string>& getKeys(int dimension) const { return keyIndices_[dimension].getKeys(); }
+  unsigned size(int dimension) const { return keyIndices_[dimension].size(); }
+
+  /// access entries by index
+  bool has(unsigned iProcess, unsigned iRegion, unsigned iObservable, unsigned iSysShift) const
+  {
+    return isSet_[getOffset(iProcess, iRegion, iObservable, iSysShift)];
+  }
+  const T& get(unsigned iProcess, unsigned iRegion, unsigned iObservable, unsigned iSysShift) const
+  {
+    return entries_[getOffset(iProcess, iRegion, iObservable, iSysShift)];
+  }
+  void set(unsigned iProcess, unsigned iRegion, unsigned iObservable, unsigned iSysShift, const T& value)
+  {
+    unsigned offset = getOffset(iProcess, iRegion, iObservable, iSysShift);
+    entries_[offset] = value;
+    isSet_[offset] = true;
+  }
+
+  /// access entries by key
+  /// (default value is returned in case entry does not exist)
+  bool has(const std::string& process, const std::string& region, const std::string& observable, const std::string& sysShift) const
+  {
+    int iProcess, iRegion, iObservable, iSysShift;
+    if ( !findIndices(process, region, observable, sysShift, iProcess, iRegion, iObservable, iSysShift) ) return false;
+    return has(iProcess, iRegion, iObservable, iSysShift);
+  }
+  const T& get(const std::string& process, const std::string& region, const std::string& observable, const std::string& sysShift) const
+  {
+    int iProcess, iRegion, iObservable, iSysShift;
+    if ( !findIndices(process, region, observable, sysShift, iProcess, iRegion, iObservable, iSysShift) ) return defaultValue_;
+    return get(iProcess, iRegion, iObservable, iSysShift);
+  }
+  void set(const std::string& process, const std::string& region, const std::string& observable, const std::string& sysShift, const T& value)
+  {
+    unsigned iProcess    = intern(kProcess, process);
+    unsigned iRegion     = intern(kRegion, region);
+    unsigned iObservable = intern(kObservable, observable);
+    unsigned iSysShift   = intern(kSysShift, sysShift);
+    set(iProcess, iRegion, iObservable, iSysShift, value);
+  }
+
+  /// conversion from/to nested maps with key = (region, observable, systematic shift),
+  /// for one process
+  template <typename M>
+  void setEntries(const std::string& process, const M& entries)
+  {
+    unsigned iProcess = intern(kProcess, process);
+    for ( typename M::const_iterator region = entries.begin();
+	  region != entries.end(); ++region ) {
+      unsigned iRegion = intern(kRegion, region->first);
+      for ( typename M::mapped_type::const_iterator observable = region->second.begin();
+	    observable != region->second.end(); ++observable ) {
+	unsigned iObservable = intern(kObservable, observable->first);
+	for ( typename M::mapped_type::mapped_type::const_iterator sysShift = observable->second.begin();
+	      sysShift != observable->second.end(); ++sysShift ) {
+	  unsigned iSysShift = intern(kSysShift, sysShift->first);
+	  set(iProcess, iRegion, iObservable, iSysShift, sysShift->second);
+	}
+      }
+    }
+  }
+  template <typename M>
+  void getEntries(const std::string& process, M& entries) const
+  {
+    int iProcess = find(kProcess, process);
+    if ( iProcess < 0 ) return;
+    for ( unsigned iRegion = 0; iRegion < size(kRegion); ++iRegion ) {
+      for ( unsigned iObservable = 0; iObservable < size(kObservable); ++iObservable ) {
+	for ( unsigned iSysShift = 0; iSysShift < size(kSysShift); ++iSysShift ) {
+	  if ( !has(iProcess, iRegion, iObservable, iSysShift) ) continue;
+	  entries[getKey(kRegion, iRegion)][getKey(kObservable, iObservable)][getKey(kSysShift, iSysShift)] =
+	    get(iProcess, iRegion, iObservable, iSysShift);
+	}
+      }
+    }
+  }
+
+ private:
+  unsigned getOffset(unsigned iProcess, unsigned iRegion, unsigned iObservable, unsigned iSysShift) const
+  {
+    return ((iProcess*capacities_[kRegion] + iRegion)*capacities_[kObservable] + iObservable)*capacities_[kSysShift] + iSysShift;
+  }
+
+  bool findIndices(const std::string& process, const std::string& region, const std::string& observable, const std::string& sysShift,
+		   int& iProcess, int& iRegion, int& iObservable, int& iSysShift) const
+  {
+    iProcess    = find(kProcess, process);
+    iRegion     = find(kRegion, region);
+    iObservable = find(kObservable, observable);
+    iSysShift   = find(kSysShift, sysShift);
+    return ( iProcess >= 0 && iRegion >= 0 && iObservable >= 0 && iSysShift >= 0 );
+  }
+
+  /// increase capacity of one dimension,
+  /// moving existing entries to their position in the enlarged array
+  void resize(int dimension, unsigned capacity)
+  {
+    unsigned capacities_new[kNumDimensions];
+    unsigned numEntries_new = 1;
+    for ( int iDimension = 0; iDimension < kNumDimensions; ++iDimension ) {
+      capacities_new[iDimension] = ( iDimension == dimension ) ? capacity : capacities_[iDimension];
+      numEntries_new *= capacities_new[iDimension];
+    }
+    std::vector<T> entries_new(numEntries_new, defaultValue_);
+    std::vector<bool> isSet_new(numEntries_new, false);
+    if ( entries_.size() > 0 ) {
+      for ( unsigned iProcess = 0; iProcess < capacities_[kProcess]; ++iProcess ) {
+	for ( unsigned iRegion = 0; iRegion < capacities_[kRegion]; ++iRegion ) {
+	  for ( unsigned iObservable = 0; iObservable < capacities_[kObservable]; ++iObservable ) {
+	    for ( unsigned iSysShift = 0; iSysShift < capacities_[kSysShift]; ++iSysShift ) {
+	      unsigned offset = getOffset(iProcess, iRegion, iObservable, iSysShift);
+	      if ( !isSet_[offset] ) continue;
+	      unsigned offset_new =
+		((iProcess*capacities_new[kRegion] + iRegion)*capacities_new[kObservable] + iObservable)*capacities_new[kSysShift] + iSysShift;
+	      entries_new[offset_new] = entries_[offset];
+	      isSet_new[offset_new] = true;
+	    }
+	  }
+	}
+      }
+    }
+    for ( int iDimension = 0; iDimension < kNumDimensions; ++iDimension ) {
+      capacities_[iDimension] = capacities_new[iDimension];
+    }
+    entries_.swap(entries_new);
+    isSet_.swap(isSet_new);
+  }
+
+  TauIdEffKeyIndex keyIndices_[kNumDimensions];
+  unsigned capacities_[kNumDimensions];
+
+  std::vector<T> entries_;
+  std::vector<bool> isSet_;
+
+  T defaultValue_;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef TauAnalysis_TauIdEfficiency_TriggerPrescaleProbabilityCache_h
+#define TauAnalysis_TauIdEfficiency_TriggerPrescaleProbabilityCache_h
+
+/** \class TriggerPrescaleProbabilityCache
+ *
+ * Compute probability for an event to fail the HLT and L1 prescales
+ * of the trigger paths it has passed.
+ * The probability is used to weight Data events,
+ * in order to match the pile-up distribution in Monte Carlo with Data.
+ *
+ * NOTE: Prescales change at luminosity section boundaries only.
+ *       The prescales of all configured HLT paths and their L1 seeds,
+ *       together with the positions of the paths/algorithms in the pat::TriggerEvent collections,
+ *       are looked-up (by name) once per (run, luminosity section) and cached.
+ *       For each event only the trigger decisions (pat::TriggerPath::wasAccept, pat::TriggerAlgorithm::gtlResult)
+ *       are retrieved, by index.
+ *
+ *       The prescales of all HLT paths are assumed to be uncorrelated
+ *      (assumption is not valid in case HLT paths share L1 conditions and those L1 conditions are prescaled)
+ *
+ */
+
+#include "DataFormats/PatCandidates/interface/TriggerEvent.h"
+#include "DataFormats/PatCandidates/interface/TriggerPath.h"
+#include "DataFormats/PatCandidates/interface/TriggerAlgorithm.h"
+#include "DataFormats/Provenance/interface/EventID.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+class TriggerPrescaleProbabilityCache
+{
+ public:
+  typedef std::vector<std::string> vstring;
+
+  /// constructor
+  /// (HLT paths are checked in the order given;
+  ///  the wildcard character "*" accepts all events)
+  TriggerPrescaleProbabilityCache(const vstring&, int = 0);
+
+  /// destructor
+  ~TriggerPrescaleProbabilityCache();
+
+  /// check if event passed any of the HLT paths;
+  /// in case it did, compute probability for event to fail the prescales
+  bool operator()(edm::RunNumber_t, edm::LuminosityBlockNumber_t, const pat::TriggerEvent&, double&);
+
+  /// number of (run, luminosity section) pairs for which prescales have been looked-up
+  size_t numLumiSectionsCached() const { return lumiSectionEntries_.size(); }
+
+ private:
+
+  struct l1SeedEntryType
+  {
+    std::string name_;
+    int idxAlgorithm_;    // index in pat::TriggerEvent::algorithms(), -1 if not available
+    double probFailedL1Prescale_;
+  };
+
+  struct hltPathEntryType
+  {
+    std::string name_;
+    bool isWildcard_;
+    int idxPath_;         // index in pat::TriggerEvent::paths(), -1 if not available
+    double hltPrescale_;
+    std::vector<l1SeedEntryType> l1Seeds_;
+  };
+
+  typedef std::vector<hltPathEntryType> hltPathEntryCollection;
+
+  /// look-up prescales of all HLT paths and their L1 seeds by name
+  void buildLumiSectionEntry(const pat::TriggerEvent&, hltPathEntryCollection&);
+
+  /// retrieve HLT path/L1 algorithm by cached index,
+  /// fall back to look-up by name in case collection in pat::TriggerEvent does not match
+  const pat::TriggerPath* getPath(const pat::TriggerEvent&, const hltPathEntryType&);
+  const pat::TriggerAlgorithm* getAlgorithm(const pat::TriggerEvent&, const l1SeedEntryType&);
+
+  vstring hltPaths_;
+
+  typedef std::pair<edm::RunNumber_t, edm::LuminosityBlockNumber_t> lumiSectionIdType;
+  std::map<lumiSectionIdType, hltPathEntryCollection> lumiSectionEntries_;
+
+  lumiSectionIdType currentLumiSection_;
+  hltPathEntryCollection* currentLumiSectionEntry_;
+
+  int verbosity_;
+};
+
+#endif
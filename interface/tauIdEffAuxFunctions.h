@@ -13,6 +13,23 @@ const pat::Jet* getJet_Tau(const pat::Tau&, const pat::JetCollection&);
 
 enum { kUnmatched, kJetToTauFakeMatched, kMuToTauFakeMatched, kGenTauHadMatched, kGenTauOtherMatched };
 
-int getGenMatchType(const PATMuTauPair&, const reco::GenParticleCollection&, double* = 0, double* = 0);
+int getGenMatchType(const PATMuTauPair&, const reco::GenParticleCollection&, double* = 0, double* = 0, std::string* = 0);
+
+/// kinematic quantities of muon + tau-jet pair used in event selection and histograms;
+/// in case the tau-jet momentum is shifted/smeared "on-the-fly" (shift factor != 1),
+/// the quantities depending on the tau-jet momentum are recomputed.
+/// The PF MEt is taken from the shifted MEt given as last function argument
+/// (e.g. patType1CorrectedPFMetJetEnUp, as used for the shifted muon + tau-jet pair collections);
+/// in case no shifted MEt is given, only the shift of the tau-jet momentum itself is propagated to the PF MEt
+struct muTauPairKinematicsType
+{
+  double tauPt_;
+  double visMass_;
+  double Mt_;
+  double PzetaDiff_;
+  double pfMEtPt_;
+};
+
+void compMuTauPairKinematics(const PATMuTauPair&, double, muTauPairKinematicsType&, const reco::Candidate::LorentzVector* = 0);
 
 #endif
@@ -20,7 +20,9 @@ NumSelObjExtractor<T>::NumSelObjExtractor(const edm::ParameterSet& cfg)
 
   if ( cfg.exists("value") ) {
     std::string cut_string = cfg.getParameter<std::string>("value");
-    cut_ = new StringCutObjectSelector<T>(cut_string);
+    bool crossCheckCompiledCuts = ( cfg.exists("crossCheckCompiledCuts") ) ?
+      cfg.getParameter<bool>("crossCheckCompiledCuts") : false;
+    cut_ = new CompiledStringCutObjectSelector<T>(cut_string, crossCheckCompiledCuts);
   }
 }
 
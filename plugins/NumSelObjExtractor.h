@@ -20,7 +20,7 @@
 #include "FWCore/Utilities/interface/InputTag.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "TauAnalysis/TauIdEfficiency/interface/CompiledStringCutObjectSelector.h"
 
 #include "TauAnalysis/BgEstimationTools/interface/ObjValExtractorBase.h"
 
@@ -45,7 +45,7 @@ class NumSelObjExtractor : public ObjValExtractorBase
   vInputTag srcNotToBeFiltered_;
   double dRmin_;
 
-  StringCutObjectSelector<T>* cut_;
+  CompiledStringCutObjectSelector<T>* cut_;
 };
 
 #endif  
@@ -48,9 +48,13 @@ PATPFTauSelectorForTauIdEff::PATPFTauSelectorForTauIdEff(const edm::ParameterSet
   maxLeadTrackPFElectronMVA_ = cfg.getParameter<double>("maxLeadTrackPFElectronMVA");
   applyECALcrackVeto_ = cfg.getParameter<bool>("applyECALcrackVeto");
 
+//--- CV: cross-check results of compiled cut-strings with StringCutObjectSelector (debug mode)
+  bool crossCheckCompiledCuts = ( cfg.exists("crossCheckCompiledCuts") ) ?
+    cfg.getParameter<bool>("crossCheckCompiledCuts") : false;
+
   minDeltaRtoNearestMuon_ = cfg.getParameter<double>("minDeltaRtoNearestMuon");
   if ( cfg.exists("muonSelection") ) {
-    muonSelection_ = new StringCutObjectSelector<pat::Muon>(cfg.getParameter<std::string>("muonSelection"));
+    muonSelection_ = new CompiledStringCutObjectSelector<pat::Muon>(cfg.getParameter<std::string>("muonSelection"), crossCheckCompiledCuts);
   }
   srcMuon_ = cfg.getParameter<edm::InputTag>("srcMuon");
 
@@ -68,7 +72,7 @@ PATPFTauSelectorForTauIdEff::PATPFTauSelectorForTauIdEff(const edm::ParameterSet
     std::cout << " src = " << src_.label() << std::endl;
     std::string save_string = cfg.getParameter<std::string>("save");
     std::cout << "--> saving pat::Taus passing: " << save_string << std::endl;
-    save_ = new StringCutObjectSelector<pat::Tau>(cfg.getParameter<std::string>("save"));
+    save_ = new CompiledStringCutObjectSelector<pat::Tau>(cfg.getParameter<std::string>("save"), crossCheckCompiledCuts);
   }
 
   produceAll_ = ( cfg.exists("produceAll") ) ? 
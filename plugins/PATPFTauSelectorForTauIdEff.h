@@ -26,7 +26,7 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "TauAnalysis/TauIdEfficiency/interface/CompiledStringCutObjectSelector.h"
 #include "CommonTools/Utils/interface/PtComparator.h"
 
 #include "RecoTauTag/RecoTau/interface/RecoTauQualityCuts.h"
@@ -64,7 +64,7 @@ private:
   bool applyECALcrackVeto_;
 
   double minDeltaRtoNearestMuon_;
-  StringCutObjectSelector<pat::Muon>* muonSelection_;
+  CompiledStringCutObjectSelector<pat::Muon>* muonSelection_;
   edm::InputTag srcMuon_;
 
   ParticlePFIsolationExtractor<pat::Tau>* pfIsolationExtractor_;
@@ -77,7 +77,7 @@ private:
   // special flag to save pat::Taus failing selection cuts,
   // but passing tau id. discriminators
   // (for measurement of tau charge misidentification rate)
-  StringCutObjectSelector<pat::Tau>* save_;
+  CompiledStringCutObjectSelector<pat::Tau>* save_;
 
   // special flag to add userFloats to all pat::Taus
   // without applying any selection cuts
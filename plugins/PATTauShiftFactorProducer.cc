@@ -0,0 +1,89 @@
+#include "TauAnalysis/TauIdEfficiency/plugins/PATTauShiftFactorProducer.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+
+#include "CondFormats/JetMETObjects/interface/JetCorrectorParameters.h"
+
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include "DataFormats/PatCandidates/interface/Tau.h"
+
+#include <vector>
+
+PATTauShiftFactorProducer::PATTauShiftFactorProducer(const edm::ParameterSet& cfg)
+  : moduleLabel_(cfg.getParameter<std::string>("@module_label")),
+    shiftBy_(0.),
+    jecUncertainty_(0)
+{
+  src_ = cfg.getParameter<edm::InputTag>("src");
+  if ( cfg.exists("srcShifted") ) {
+    srcShifted_ = cfg.getParameter<edm::InputTag>("srcShifted");
+  } else {
+    jetCorrPayloadName_ = cfg.getParameter<std::string>("jetCorrPayloadName");
+    jetCorrUncertaintyTag_ = cfg.getParameter<std::string>("jetCorrUncertaintyTag");
+    shiftBy_ = cfg.getParameter<double>("shiftBy");
+  }
+
+  produces<edm::ValueMap<float> >();
+}
+
+PATTauShiftFactorProducer::~PATTauShiftFactorProducer()
+{
+  delete jecUncertainty_;
+}
+
+void PATTauShiftFactorProducer::produce(edm::Event& evt, const edm::EventSetup& es)
+{
+  typedef edm::View<pat::Tau> patTauCollectionType;
+  edm::Handle<patTauCollectionType> inputTaus;
+  evt.getByLabel(src_, inputTaus);
+
+  std::vector<float> shiftFactors;
+  shiftFactors.reserve(inputTaus->size());
+
+  if ( srcShifted_.label() != "" ) {
+    edm::Handle<patTauCollectionType> shiftedTaus;
+    evt.getByLabel(srcShifted_, shiftedTaus);
+
+    if ( shiftedTaus->size() != inputTaus->size() )
+      throw cms::Exception("PATTauShiftFactorProducer")
+	<< "Configuration error in module = " << moduleLabel_ << ":" 
+	<< " collections src = " << src_.label() << " (" << inputTaus->size() << " entries) and"
+	<< " srcShifted = " << srcShifted_.label() << " (" << shiftedTaus->size() << " entries) differ in size !!\n";
+
+    for ( size_t idxTau = 0; idxTau < inputTaus->size(); ++idxTau ) {
+      double inputTauEn = inputTaus->at(idxTau).energy();
+      double shiftedTauEn = shiftedTaus->at(idxTau).energy();
+      shiftFactors.push_back(( inputTauEn > 0. ) ? (shiftedTauEn/inputTauEn) : 1.);
+    }
+  } else {
+//--- CV: (re)load jet energy scale uncertainties only in case they have changed
+    if ( !jecUncertainty_ || jetCorrRecordWatcher_.check(es) ) {
+      edm::ESHandle<JetCorrectorParametersCollection> jetCorrParameterSet;
+      es.get<JetCorrectionsRecord>().get(jetCorrPayloadName_, jetCorrParameterSet);
+      const JetCorrectorParameters& jetCorrParameters = (*jetCorrParameterSet)[jetCorrUncertaintyTag_];
+      delete jecUncertainty_;
+      jecUncertainty_ = new JetCorrectionUncertainty(jetCorrParameters);
+    }
+
+    for ( size_t idxTau = 0; idxTau < inputTaus->size(); ++idxTau ) {
+      const pat::Tau& inputTau = inputTaus->at(idxTau);
+      jecUncertainty_->setJetEta(inputTau.eta());
+      jecUncertainty_->setJetPt(inputTau.pt());
+      double shift = shiftBy_*jecUncertainty_->getUncertainty(true);
+      shiftFactors.push_back(1. + shift);
+    }
+  }
+
+  std::auto_ptr<edm::ValueMap<float> > shiftFactorMap(new edm::ValueMap<float>());
+  edm::ValueMap<float>::Filler filler(*shiftFactorMap);
+  filler.insert(inputTaus, shiftFactors.begin(), shiftFactors.end());
+  filler.fill();
+
+  evt.put(shiftFactorMap);
+}
+
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+DEFINE_FWK_MODULE(PATTauShiftFactorProducer);
@@ -0,0 +1,66 @@
+#ifndef TauAnalysis_TauIdEfficiency_PATTauShiftFactorProducer_h  
+#define TauAnalysis_TauIdEfficiency_PATTauShiftFactorProducer_h
+
+/** \class PATTauShiftFactorProducer
+ *
+ * Compute for each tau-jet candidate in the "central" collection
+ * the factor by which the tau-jet momentum is shifted/smeared.
+ * The factors are stored as edm::ValueMap<float> associated to the "central" collection,
+ * so that the shifted/smeared pat::Tau collections and the muon + tau-jet pairs built from them
+ * do not need to be kept in the PAT-tuple.
+ * The FWLite analyzers apply the factors "on-the-fly" when reading the "central" collection.
+ *
+ * Two modes of operation are supported:
+ *   o 'srcShifted' given:
+ *       the factors are taken from the ratio of energies of the tau-jet candidates
+ *       shifted/smeared by ShiftedPATTauJetProducer or SmearedPATTauJetProducer
+ *       and the tau-jet candidates in the "central" collection
+ *   o 'jetCorrPayloadName', 'jetCorrUncertaintyTag' and 'shiftBy' given:
+ *       the factors are computed directly from the jet energy scale uncertainty,
+ *       in the same way as by ShiftedPATTauJetProducer (with addResidualJES = False),
+ *       so that no shifted tau-jet collection needs to be produced
+ * 
+ * NOTE: ShiftedPATTauJetProducer and SmearedPATTauJetProducer
+ *       produce one output tau-jet candidate per input tau-jet candidate,
+ *       in the same order; the ratio of energies is computed by index.
+ *
+ */
+
+#include "FWCore/Framework/interface/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include "CondFormats/JetMETObjects/interface/JetCorrectionUncertainty.h"
+#include "JetMETCorrections/Objects/interface/JetCorrectionsRecord.h"
+
+#include <string>
+
+class PATTauShiftFactorProducer : public edm::EDProducer
+{
+ public:
+  
+  explicit PATTauShiftFactorProducer(const edm::ParameterSet&);
+  ~PATTauShiftFactorProducer();
+    
+  void produce(edm::Event&, const edm::EventSetup&);
+
+ private:
+
+  std::string moduleLabel_;
+  
+//--- configuration parameters
+  edm::InputTag src_;        // "central" tau-jet collection
+  edm::InputTag srcShifted_; // shifted/smeared tau-jet collection
+
+  std::string jetCorrPayloadName_;
+  std::string jetCorrUncertaintyTag_;
+  double shiftBy_;
+
+  JetCorrectionUncertainty* jecUncertainty_;
+  edm::ESWatcher<JetCorrectionsRecord> jetCorrRecordWatcher_;
+};
+
+#endif  
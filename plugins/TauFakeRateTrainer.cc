@@ -10,6 +10,8 @@
 #include "RecoTauTag/TauTagTools/interface/TauMVADBConfiguration.h"
 
 #include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
 #include "TArrayD.h"
 #include "TPolyMarker3D.h"
 
@@ -22,38 +24,128 @@ const PhysicsTools::AtomicId tauEtaId("AbsEta");
 const PhysicsTools::AtomicId jetPtId("JetPt");
 const PhysicsTools::AtomicId jetEtaId("AbsJetEta");
 
-// Check if a value is Nan and print a warning if so
-double checkNan(const PhysicsTools::AtomicId &name, double value) {
-  if (std::isnan(value)) {
-    std::cerr << "Found a nan in variable: " << name << ", returning zero!"
-      << std::endl;
-    value = 0.;
+// Names of the branches in the columnar (TTree) input format
+const char* ptBranchName = "pt";
+const char* etaBranchName = "absEta";
+const char* widthBranchName = "jetWidth";
+
+// Size of the TTreeCache used to read the columnar input in batches
+const Long64_t treeCacheSize = 10000000;
+
+// In-memory, columnar copy of the training sample of one source
+struct TrainingSample {
+  std::vector<double> pt_;
+  std::vector<double> eta_;
+  std::vector<double> width_;
+  size_t size() const {
+    return pt_.size();
+  }
+};
+
+// Check a whole column for Nans, replace them by zero and print a warning if
+// any are found
+void checkNan(const PhysicsTools::AtomicId &name, std::vector<double>& column) {
+  size_t numNans = 0;
+  for (size_t i = 0; i < column.size(); ++i) {
+    if (std::isnan(column[i])) {
+      column[i] = 0.;
+      ++numNans;
+    }
+  }
+  if (numNans > 0) {
+    std::cerr << "Found " << numNans << " nans in variable: " << name
+      << ", replaced them by zero!" << std::endl;
+  }
+}
+
+// Copy the (pt, eta, width) triplets stored in a TPolyMarker3D into columns.
+// The points are accessed as one contiguous array instead of point-by-point.
+void loadPolyMarker(const TPolyMarker3D* points, TrainingSample& sample) {
+  size_t numPoints = points->Size();
+  const Float_t* p = const_cast<TPolyMarker3D*>(points)->GetP();
+  sample.pt_.resize(numPoints);
+  sample.eta_.resize(numPoints);
+  sample.width_.resize(numPoints);
+  for (size_t i = 0; i < numPoints; ++i) {
+    sample.pt_[i] = p[3*i];
+    sample.eta_[i] = p[3*i + 1];
+    sample.width_[i] = p[3*i + 2];
+  }
+}
+
+// Read the pt, eta and width branches of a plain TTree into columns.
+// All other branches are disabled and the baskets are prefetched through
+// the TTreeCache, so the input is read in large batches.
+void loadTree(TTree* tree, TrainingSample& sample) {
+  const char* branchNames[3] = { ptBranchName, etaBranchName, widthBranchName };
+  std::vector<double>* columns[3] = { &sample.pt_, &sample.eta_, &sample.width_ };
+  Float_t values[3];
+  tree->SetBranchStatus("*", 0);
+  TBranch* branches[3];
+  for (int var = 0; var < 3; ++var) {
+    branches[var] = tree->GetBranch(branchNames[var]);
+    if (!branches[var]) {
+      throw cms::Exception("Missing branch") << "Can't find branch "
+        << branchNames[var] << " in tree " << tree->GetName();
+    }
+    tree->SetBranchStatus(branchNames[var], 1);
+    branches[var]->SetAddress(&values[var]);
+  }
+  tree->SetCacheSize(treeCacheSize);
+  for (int var = 0; var < 3; ++var) {
+    tree->AddBranchToCache(branches[var], true);
+  }
+  Long64_t numEntries = tree->GetEntries();
+  for (int var = 0; var < 3; ++var) {
+    columns[var]->resize(numEntries);
+  }
+  for (Long64_t i = 0; i < numEntries; ++i) {
+    tree->LoadTree(i);
+    for (int var = 0; var < 3; ++var) {
+      branches[var]->GetEntry(i);
+      (*columns[var])[i] = values[var];
+    }
   }
-  return value;
+  tree->SetCacheSize(0);
+}
+
+// Load the training sample of one source, either from a TTree (columnar
+// format) or from a TPolyMarker3D (legacy format)
+void loadSample(TFile* file, const std::string& name, TrainingSample& sample) {
+  TObject* object = file->Get(name.c_str());
+  if (TTree* tree = dynamic_cast<TTree*>(object)) {
+    loadTree(tree, sample);
+  } else if (const TPolyMarker3D* points =
+      dynamic_cast<const TPolyMarker3D*>(object)) {
+    loadPolyMarker(points, sample);
+    // The points have been copied, free the memory
+    delete points;
+  } else {
+    throw cms::Exception("Missing ntuple") << "Can't Get() ntuple " << name;
+  }
+  checkNan(tauPtId, sample.pt_);
+  checkNan(tauEtaId, sample.eta_);
+  checkNan(widthId, sample.width_);
 }
 
 // The Phys tools version of this doesn't compile due to const issues.
 struct Extractor {
-  const TPolyMarker3D* data_;
+  TrainingSample data_;
   size_t index_;
-  double pt_;
-  double eta_;
-  double width_;
   double weight_;
   void setIndex(size_t index) {
     index_ = index;
-    data_->GetPoint(index_, pt_, eta_, width_);
   }
   size_t size() const {
-    return data_->Size();
+    return data_.size();
   }
   double compute(const PhysicsTools::AtomicId &name) const {
     if (name == tauPtId || name == jetPtId)
-      return checkNan(tauPtId, pt_);
+      return data_.pt_[index_];
     if (name == tauEtaId || name == jetEtaId)
-      return checkNan(tauEtaId, eta_);
+      return data_.eta_[index_];
     if (name == widthId)
-      return checkNan(widthId, width_);
+      return data_.width_[index_];
     return -1000;
   }
 };
@@ -138,6 +230,8 @@ TauFakeRateTrainer::TauFakeRateTrainer(const edm::ParameterSet &pset)
     throw cms::Exception("Missing ntuple") << "Weights in numerator and denominator files don't match!";
 
   // Build each extractor source
+  numerators_.reserve(num_weights->GetSize());
+  denominators_.reserve(den_weights->GetSize());
   for (int i = 0; i < num_weights->GetSize(); i++) {
     std::cout << "Building sample " << i << std::endl;
     std::stringstream passing_name;
@@ -155,14 +249,12 @@ TauFakeRateTrainer::TauFakeRateTrainer(const edm::ParameterSet &pset)
     failing_index_name << i;
 
     // Build extractors
-    Extractor numerator;
+    numerators_.push_back(Extractor());
+    Extractor& numerator = numerators_.back();
     numerator.weight_ = num_weights->At(i);
-    numerator.data_ = dynamic_cast<const TPolyMarker3D*>(
-        numeratorFile->Get(passing_name.str().c_str()));
-    if (!numerator.data_) {
-      throw cms::Exception("Missing ntuple") << "Can't Get() passing ntuple";
-    }
+    loadSample(numeratorFile, passing_name.str(), numerator.data_);
     numerator.setIndex(0);
+    std::cout << " loaded " << numerator.size() << " passing entries" << std::endl;
 
     const TPolyMarker3D* passingIndices = dynamic_cast<const TPolyMarker3D*>(
         numeratorFile->Get(passing_index_name.str().c_str()));
@@ -171,13 +263,10 @@ TauFakeRateTrainer::TauFakeRateTrainer(const edm::ParameterSet &pset)
       printIndices(passingIndices, "index_pass");
     }
 
-    Extractor denominator;
+    denominators_.push_back(Extractor());
+    Extractor& denominator = denominators_.back();
     denominator.weight_ = den_weights->At(i);
-    denominator.data_ = dynamic_cast<const TPolyMarker3D*>(
-        denominatorFile->Get(failing_name.str().c_str()));
-    if (!denominator.data_) {
-      throw cms::Exception("Missing ntuple") << "Can't Get() failing ntuple";
-    }
+    loadSample(denominatorFile, failing_name.str(), denominator.data_);
 
     const TPolyMarker3D* failingIndices = dynamic_cast<const TPolyMarker3D*>(
         denominatorFile->Get(failing_index_name.str().c_str()));
@@ -187,9 +276,7 @@ TauFakeRateTrainer::TauFakeRateTrainer(const edm::ParameterSet &pset)
     }
 
     denominator.setIndex(0);
-
-    numerators_.push_back(numerator);
-    denominators_.push_back(denominator);
+    std::cout << " loaded " << denominator.size() << " failing entries" << std::endl;
   }
 }
 
@@ -10,7 +10,7 @@
 
 #include "DataFormats/PatCandidates/interface/Tau.h"
 
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "TauAnalysis/TauIdEfficiency/interface/CompiledStringCutObjectSelector.h"
 #include "DataFormats/PatCandidates/interface/TriggerObject.h"
 
 #include <vector>
@@ -28,7 +28,7 @@ class TauIdTagAndProbeProducer : public edm::EDProducer
   
   edm::InputTag src_;
 
-  typedef StringCutObjectSelector<pat::TriggerObject> StringCutTriggerObjectSelector;
+  typedef CompiledStringCutObjectSelector<pat::TriggerObject> StringCutTriggerObjectSelector;
   typedef std::vector<StringCutTriggerObjectSelector*> vStringCutTriggerObjectSelector;
   std::map<std::string, vStringCutTriggerObjectSelector> triggerPaths_;
 };
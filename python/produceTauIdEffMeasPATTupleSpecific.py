@@ -4,10 +4,12 @@ from TauAnalysis.CandidateTools.tools.composeModuleName import composeModuleName
 from TauAnalysis.TauIdEfficiency.produceTauIdEffMeasPATTuple_base import produceTauIdEffMeasPATTuple_base
 from PhysicsTools.PatAlgos.patEventContent_cff import patTriggerEventContent
 
-def produceTauIdEffMeasPATTuple(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit):
+def produceTauIdEffMeasPATTuple(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit,
+                                storeTauShiftFactors = False):
 
     # produce PAT objects common between PAT-tuple and Ntuple production
-    produceTauIdEffMeasPATTuple_base(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit)
+    patTupleConfig = produceTauIdEffMeasPATTuple_base(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit,
+                                                      storeTauShiftFactors = storeTauShiftFactors)
 
     #--------------------------------------------------------------------------------
     #
@@ -164,6 +166,13 @@ def produceTauIdEffMeasPATTuple(process, isMC, isEmbedded, HLTprocessName, pfCan
                 #'keep *_smearedAK5PFJets_*_*'
             )
         )
+        # CV: in case Tau-jet energy shifts/smearing are stored as shift factors,
+        #     do not keep shifted/smeared Tau-jet collections
+        if storeTauShiftFactors:
+            for algorithm in patTupleConfig["algorithms"]:
+                for patTauCollection in patTupleConfig[algorithm]["patTauCollections"]:
+                    if patTauCollection.find("TauJetEn") != -1 or patTauCollection.find("TauJetRes") != -1:
+                        process.patTupleOutputModule.outputCommands.append('drop *_%s_*_*' % patTauCollection)
     #--------------------------------------------------------------------------------
 
     process.printEventContent = cms.EDAnalyzer("EventContentAnalyzer") 
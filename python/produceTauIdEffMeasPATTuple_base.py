@@ -3,7 +3,8 @@ import FWCore.ParameterSet.Config as cms
 from TauAnalysis.TauIdEfficiency.tools.configurePrePatProduction import configurePrePatProduction
 from TauAnalysis.TauIdEfficiency.tools.configurePatTupleProductionTauIdEffMeasSpecific import *
  
-def produceTauIdEffMeasPATTuple_base(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit):
+def produceTauIdEffMeasPATTuple_base(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit,
+                                     storeTauShiftFactors = False):
 
     # import of standard configurations for RECOnstruction
     # of electrons, muons and tau-jets with non-standard isolation cones
@@ -77,7 +78,8 @@ def produceTauIdEffMeasPATTuple_base(process, isMC, isEmbedded, HLTprocessName,
     # import utility function for configurating PAT-tuple production
    
     patTupleConfig = configurePatTupleProductionTauIdEffMeasSpecific(
-        process, hltProcess = HLTprocessName, isMC = isMC, isEmbedded = isEmbedded, runSVfit = runSVfit)
+        process, hltProcess = HLTprocessName, isMC = isMC, isEmbedded = isEmbedded, runSVfit = runSVfit,
+        storeTauShiftFactors = storeTauShiftFactors)
     #--------------------------------------------------------------------------------
 
     return patTupleConfig
@@ -29,7 +29,8 @@ def make_drawOptions_string(drawOptions, namesToPlot):
 
 def buildConfigFile_FWLiteTauFakeRateAnalyzer(sampleToAnalyze, evtSel, version, inputFilePath, tauIds, 
                                               tauJetCandSelection, srcTauJetCandidates, srcMET, intLumiData, hltPaths, srcWeights,
-                                              configFilePath, logFilePath, outputFilePath, recoSampleDefinitions):
+                                              configFilePath, logFilePath, outputFilePath, recoSampleDefinitions,
+                                              writeHistogramBundles = False):
 
     """Build cfg.py file to run FWLiteTauFakeRateAnalyzer macro to run on PAT-tuples,
        and fill histograms for passed/failed samples"""
@@ -153,6 +154,10 @@ process.tauFakeRateAnalyzer = cms.PSet(
 
     weights = cms.VInputTag(%s),
 
+    # CV: write histograms in compact TauIdEffHistogramBundle format (one object per directory);
+    #     use convertTauIdEffHistogramBundles to convert output files into plain TH1 objects for interactive use
+    writeHistogramBundles = cms.bool(%s),
+
     # CV: 'srcEventCounter' is defined in TauAnalysis/Skimming/test/skimTauIdEffSample_cfg.py
     srcEventCounter = cms.InputTag('totalEventsProcessed'),
     allEvents_DBS = cms.int32(%i),
@@ -166,7 +171,7 @@ process.tauFakeRateAnalyzer = cms.PSet(
 """ % (inputFileName_sample, outputFileName,
        process_matched, processType, evtSel,
        tauIds_string, srcTauJetCandidates, tauJetCandSelection, hltPaths_string, srcMET, weights_string,
-       allEvents_DBS, xSection, intLumiData)
+       getStringRep_bool(writeHistogramBundles), allEvents_DBS, xSection, intLumiData)
 
         outputFileNames.append(outputFileName)
 
@@ -196,7 +201,8 @@ process.tauFakeRateAnalyzer = cms.PSet(
 
 def buildConfigFile_makeTauFakeRatePlots(inputFileName,
                                          eventSelections, eventSelectionsToPlot, tauIds, tauIdsToPlot, labels,
-                                         outputFilePath, outputFileName, recoSampleDefinitions):
+                                         outputFilePath, outputFileName, recoSampleDefinitions,
+                                         numPlotWorkers = 0, deferPlots = False):
 
     """Make plots of jet --> tau fake-rate as function of jetPt, jetEta,..."""
 
@@ -267,14 +273,21 @@ process.makeTauFakeRatePlots = cms.PSet(
 %s
     ),
 
-    outputFileName = cms.string('%s')
+    outputFileName = cms.string('%s'),
+
+    # CV: render plots in background by 'numPlotWorkers' worker processes
+    #    (0 = render plots directly);
+    #     in case 'deferPlots' is enabled, plots are not rendered,
+    #     but stored in a ROOT file, to be rendered later by the 'renderTauIdEffPlots' macro
+    numPlotWorkers = cms.uint32(%i),
+    deferPlots = cms.bool(%s)
 )
 """ % (inputFileName,
        processes_string, make_inputFileNames_vstring(processesToPlot),
        eventSelections_string, make_inputFileNames_vstring(eventSelectionsToPlot),
        tauIds_string, make_inputFileNames_vstring(tauIdsToPlot),
        make_inputFileNames_vstring(labels),
-       outputFileName_full)
+       outputFileName_full, numPlotWorkers, getStringRep_bool(deferPlots))
 
     configFileName = outputFileName;
     configFileName = configFileName.replace('.eps', '_cfg.py')
@@ -57,10 +57,25 @@ def buildConfigFile_FWLiteTauIdEffAnalyzer(sampleToAnalyze, jobId, inputFilePath
                                            recoSampleDefinitions, regions, intLumiData, hltPaths, srcWeights,
                                            tauChargeMode, disableTauCandPreselCuts,
                                            muonPtMin, tauLeadTrackPtMin, tauAbsIsoMax, caloMEtPtMin, pfMEtPtMin,
-                                           plot_hltPaths, fillControlPlots, requireUniqueMuTauPair = False):
+                                           plot_hltPaths, fillControlPlots, requireUniqueMuTauPair = False,
+                                           processSysShiftsInSingleJob = True, useTauShiftFactors = False,
+                                           propagateTauShiftToMEt = False,
+                                           fwliteInput_lumiMaskFileName = None, writeHistogramBundles = False):
 
     """Build cfg.py file to run FWLiteTauIdEffAnalyzer macro to run on PAT-tuples,
-       apply event selections and fill histograms for A/B/C/D regions"""
+       apply event selections and fill histograms for A/B/C/D regions
+       (in case 'processSysShiftsInSingleJob' is set, the central value and all systematic shifts
+        are processed in one pass over the PAT-tuples and the histograms for all systematic shifts
+        are written to the output file of the central value, which is then the only output file returned for the sample;
+        in case 'useTauShiftFactors' is set, Tau-jet energy shifts/smearing are applied "on-the-fly"
+        to the "central" Muon + Tau-jet pairs, using the shift factors stored in the PAT-tuples
+        (SVfit cannot be rerun on-the-fly: the SVfit mass of the shifted pairs is approximated
+         by scaling the SVfit mass of the "central" pair by the ratio of shifted to "central" visible mass;
+         the PF MEt is taken from the patType1CorrectedPFMet JetEn/JetRes Up/Down collections,
+         as for the shifted Muon + Tau-jet pair collections, unless 'propagateTauShiftToMEt' is set,
+         in which case only the shift of the Tau-jet momentum itself is propagated to the PF MEt,
+         which changes the meaning of the TauJetEn/TauJetRes systematics for Mt and PzetaDiff);
+        in case 'fwliteInput_lumiMaskFileName' is given, only luminosity sections certified in that JSON file are analyzed)"""
 
     print "<buildConfigFile_FWLiteTauIdEffAnalyzer>:"
     print " processing sample %s" % sampleToAnalyze
@@ -88,6 +103,10 @@ def buildConfigFile_FWLiteTauIdEffAnalyzer(sampleToAnalyze, jobId, inputFilePath
             fwliteInput_fileNames += "process.fwliteInput.fileNames.append('%s')\n" % os.path.join(inputFilePath, inputFileName)
 
     print " found %i input files." % len(inputFileNames_sample)
+
+    fwliteInput_lumiMask_string = ""
+    if fwliteInput_lumiMaskFileName:
+        fwliteInput_lumiMask_string = "    lumiMaskFileName = cms.string('%s'),\n" % fwliteInput_lumiMaskFileName
     
     if len(inputFileNames_sample) == 0:
         print("Sample %s has no input files --> skipping !!" % sampleToAnalyze)
@@ -149,7 +168,50 @@ def buildConfigFile_FWLiteTauIdEffAnalyzer(sampleToAnalyze, jobId, inputFilePath
     outputFileNames = []
     logFileNames    = []
 
-    for sysUncertainty in sysUncertainties_expanded:
+    def isTauShiftFactorSysUncertainty(sysUncertainty):
+        return useTauShiftFactors and (sysUncertainty.startswith("TauJetEn") or sysUncertainty.startswith("TauJetRes"))
+
+    def getSrcMuTauPairs(sysUncertainty):
+        srcMuTauPairs = 'selectedMuPFTauHPSpairsDzForTauIdEff'
+        if sysUncertainty not in [ "CENTRAL_VALUE", "CaloMEtResponseUp", "CaloMEtResponseDown" ] and \
+           not isTauShiftFactorSysUncertainty(sysUncertainty):
+            srcMuTauPairs = composeModuleName([ srcMuTauPairs, sysUncertainty, "cumulative" ])            
+        else:
+            srcMuTauPairs = composeModuleName([ srcMuTauPairs, "cumulative" ])
+        return srcMuTauPairs
+
+    def getSrcTauShiftFactors(sysUncertainty):
+        # CV: shift factors are produced by PATTauShiftFactorProducer modules,
+        #     defined in TauAnalysis/TauIdEfficiency/python/tools/sequenceBuilderTauIdEffMeasSpecific.py
+        srcTauShiftFactors = ''
+        if isTauShiftFactorSysUncertainty(sysUncertainty):
+            srcTauShiftFactors = composeModuleName([ composeModuleName([ "selectedPatPFTausHPS", "ForTauIdEff" ]), "TauShiftFactor", sysUncertainty ])
+        return srcTauShiftFactors
+
+    def getSrcMEt(sysUncertainty):
+        # CV: the shifted Muon + Tau-jet pair collections take their MEt from the shifted MEt collections
+        #     defined in TauAnalysis/TauIdEfficiency/python/tools/sequenceBuilderTauIdEffMeasSpecific.py;
+        #     use the same MEt in case shift factors are applied "on-the-fly"
+        srcMEt = ''
+        if isTauShiftFactorSysUncertainty(sysUncertainty) and not propagateTauShiftToMEt:
+            srcMEt = composeModuleName([ "patType1CorrectedPFMet", sysUncertainty.replace("TauJet", "Jet") ])
+        return srcMEt
+
+    sysShifts_string = ""
+    sysUncertainties_jobs = sysUncertainties_expanded
+    if processSysShiftsInSingleJob:
+        for sysUncertainty in sysUncertainties_expanded:
+            if sysUncertainty == "CENTRAL_VALUE":
+                continue
+            sysShifts_string += "        cms.PSet(\n"
+            sysShifts_string += "            sysShift = cms.string('%s'),\n" % sysUncertainty
+            sysShifts_string += "            srcMuTauPairs = cms.InputTag('%s'),\n" % getSrcMuTauPairs(sysUncertainty)
+            sysShifts_string += "            srcTauShiftFactors = cms.InputTag('%s'),\n" % getSrcTauShiftFactors(sysUncertainty)
+            sysShifts_string += "            srcMEt = cms.InputTag('%s')\n" % getSrcMEt(sysUncertainty)
+            sysShifts_string += "        ),\n"
+        sysUncertainties_jobs = [ "CENTRAL_VALUE" ]
+
+    for sysUncertainty in sysUncertainties_jobs:
 
         outputFileName = None
         if sysUncertainty != "CENTRAL_VALUE":            
@@ -158,11 +220,9 @@ def buildConfigFile_FWLiteTauIdEffAnalyzer(sampleToAnalyze, jobId, inputFilePath
             outputFileName = 'analyzeTauIdEffHistograms_%s_%s.root' % (sampleToAnalyze, jobId)
         outputFileName_full = os.path.join(outputFilePath, outputFileName)
 
-        srcMuTauPairs = 'selectedMuPFTauHPSpairsDzForTauIdEff'
-        if sysUncertainty not in [ "CENTRAL_VALUE", "CaloMEtResponseUp", "CaloMEtResponseDown" ]:  
-            srcMuTauPairs = composeModuleName([ srcMuTauPairs, sysUncertainty, "cumulative" ])            
-        else:
-            srcMuTauPairs = composeModuleName([ srcMuTauPairs, "cumulative" ])
+        srcMuTauPairs = getSrcMuTauPairs(sysUncertainty)
+        srcTauShiftFactors = getSrcTauShiftFactors(sysUncertainty)
+        srcMEt = getSrcMEt(sysUncertainty)
         srcJets = None
         if not processType == 'Data':
             srcJets = 'patJetsSmearedAK5PF'
@@ -186,7 +246,7 @@ process.fwliteInput = cms.PSet(
 
     firstRun = cms.int32(%i),
     lastRun = cms.int32(%i),
-    
+%s
     maxEvents = cms.int32(-1),
     
     outputEvery = cms.uint32(1000)
@@ -216,6 +276,9 @@ process.tauIdEffAnalyzer = cms.PSet(
     ),
     
     sysShift = cms.string('%s'),
+    sysShifts = cms.VPSet(
+%s
+    ),
 
     srcHLTresults = cms.InputTag('TriggerResults::HLT'),
     hltPaths = cms.vstring(%s),
@@ -226,6 +289,8 @@ process.tauIdEffAnalyzer = cms.PSet(
     requireUniqueMuTauPair = cms.bool(%s),
     srcCaloMEt = cms.InputTag('patCaloMetNoHF'),
     srcJets = cms.InputTag('%s'),
+    srcTauShiftFactors = cms.InputTag('%s'),
+    srcMEt = cms.InputTag('%s'),
     #svFitMassHypothesis = cms.string('psKine_MEt_logM_fit'),
     svFitMassHypothesis = cms.string('psKine_MEt_int'),
     tauChargeMode = cms.string('%s'),
@@ -257,18 +322,35 @@ process.tauIdEffAnalyzer = cms.PSet(
         parametrization = cms.VPSet(            
             cms.PSet(
                 name = cms.string('logMuonPt'),
-                expression = cms.string('log(pt)')
+                expression = cms.string('log(pt)'),
+                gridMin = cms.double(2.7),
+                gridMax = cms.double(5.5),
+                gridNumPoints = cms.uint32(57)
             ),
             cms.PSet(
                 name = cms.string('absMuonEta'),
-                expression = cms.string('abs(eta)')
+                expression = cms.string('abs(eta)'),
+                gridMin = cms.double(0.),
+                gridMax = cms.double(2.1),
+                gridNumPoints = cms.uint32(22)
             )
         ),
         selection = cms.string(
             '(userIsolation("pat::User1Iso")' + \
             ' + max(0., userIsolation("pat::PfNeutralHadronIso") + userIsolation("pat::PfGammaIso")' + \
             '          - 0.5*userIsolation("pat::User2Iso"))) > 0.20*pt'
-        )
+        ),
+        # CV: set 'useGrid' to True in order to take muon isolation probabilities
+        #     from k-NN response precomputed on grid of logMuonPt and absMuonEta values
+        #    (muons in grid cells for which interpolated and exact values differ by more than 'gridTolerance'
+        #     in the cell center or in any of 'gridNumValidationPoints' random points checked when the grid is built,
+        #     and muons outside the grid are evaluated exactly;
+        #     the first 'gridNumValidationMuons' interpolated values are cross-checked for monitoring purposes)
+        useGrid = cms.bool(False),
+        gridTolerance = cms.double(0.01),
+        gridNumValidationPoints = cms.uint32(10000),
+        gridMaxNumCells = cms.uint32(100000),
+        gridNumValidationMuons = cms.uint32(1000)
     ),
     #applyMuonIsoWeights = cms.bool(False),
     applyMuonIsoWeights = cms.bool(True),
@@ -277,6 +359,10 @@ process.tauIdEffAnalyzer = cms.PSet(
     #     drop all control plots
     fillControlPlots = cms.bool(%s),
 
+    # CV: write histograms in compact TauIdEffHistogramBundle format (one object per directory);
+    #     use convertTauIdEffHistogramBundles to convert output files into plain TH1 objects for interactive use
+    writeHistogramBundles = cms.bool(%s),
+
     # CV: 'srcEventCounter' is defined in TauAnalysis/Skimming/test/skimTauIdEffSample_cfg.py
     srcEventCounter = cms.InputTag('processedEventsSkimming'),
     allEvents_DBS = cms.int32(%i),
@@ -287,13 +373,13 @@ process.tauIdEffAnalyzer = cms.PSet(
 
     srcLumiProducer = cms.InputTag('lumiProducer')
 )
-""" % (fwliteInput_firstRun, fwliteInput_lastRun, fwliteInput_fileNames, outputFileName_full,
+""" % (fwliteInput_firstRun, fwliteInput_lastRun, fwliteInput_lumiMask_string, fwliteInput_fileNames, outputFileName_full,
        process_matched, processType,
-       regions_string, tauIds_string, binning_string, sysUncertainty, hltPaths_string,
-       srcMuTauPairs, getStringRep_bool(requireUniqueMuTauPair), srcJets, tauChargeMode, disableTauCandPreselCuts_string,
+       regions_string, tauIds_string, binning_string, sysUncertainty, sysShifts_string, hltPaths_string,
+       srcMuTauPairs, getStringRep_bool(requireUniqueMuTauPair), srcJets, srcTauShiftFactors, srcMEt, tauChargeMode, disableTauCandPreselCuts_string,
        muonPtMin, tauLeadTrackPtMin, tauAbsIsoMax, caloMEtPtMin, pfMEtPtMin,
        srcGenParticles, getStringRep_bool(fillGenMatchHistograms), plot_hltPaths_string,
-       weights_string, getStringRep_bool(fillControlPlots), allEvents_DBS, xSection, intLumiData)
+       weights_string, getStringRep_bool(fillControlPlots), getStringRep_bool(writeHistogramBundles), allEvents_DBS, xSection, intLumiData)
 
         outputFileNames.append(outputFileName_full)
 
@@ -549,7 +635,11 @@ def buildConfigFile_fitTauIdEff(fitMethod, jobId, directory, inputFileName, tauI
                                 templateMorphingMode, sysUncertainties, outputFilePath,
                                 regionsToFit, passed_region, failed_region, 
                                 regionQCDtemplateFromData_passed, regionQCDtemplateFromData_failed, regionQCDtemplateFromData_D,
-                                fitIndividualProcesses, intLumiData, runClosureTest, makeControlPlots, outputFilePath_plots):
+                                fitIndividualProcesses, intLumiData, runClosureTest, makeControlPlots, outputFilePath_plots,
+                                fitBackend = 'RooFit', runAsimovFit = False, runMinosAsimovFit = False,
+                                tauIds = None, fitVariables = None, numWorkers = 1,
+                                runProfileLikelihoodScan = False, numPlotWorkers = 0, deferPlots = False,
+                                compareFitBackends = False):
 
     """Fit Ztautau signal plus background templates to Mt and visMass distributions
        observed in regions A/B/C/D, in order to determined Ztautau signal contribution
@@ -570,6 +660,15 @@ def buildConfigFile_fitTauIdEff(fitMethod, jobId, directory, inputFileName, tauI
 
     makeControlPlots_string = getStringRep_bool(makeControlPlots)
 
+    # CV: fit all combinations of tau id. discriminators and fit variables in one job,
+    #     in case lists of tau id. discriminators and/or fit variables are given
+    if tauIds is None:
+        tauIds = [ tauId ]
+    tauIds_string = make_inputFileNames_vstring(tauIds)
+    if fitVariables is None:
+        fitVariables = [ fitVariable ]
+    fitVariables_string = make_inputFileNames_vstring(fitVariables)
+
     config = \
 """
 import FWCore.ParameterSet.Config as cms
@@ -606,9 +705,16 @@ process.%s = cms.PSet(
     region_passed = cms.string('%s'),
     region_failed = cms.string('%s'),
     
-    tauId = cms.string('%s'),
+    tauIds = cms.vstring(
+%s
+    ),
 
-    fitVariable = cms.string('%s'),
+    fitVariables = cms.vstring(
+%s
+    ),
+
+    # CV: number of worker processes used to run fits for different tau id. discriminators and fit variables in parallel
+    numWorkers = cms.uint32(%i),
 
     fitIndividualProcesses = cms.bool(%s),
 
@@ -619,22 +725,53 @@ process.%s = cms.PSet(
     ),
     sysVariedByNsigma = cms.double(3.0),
 
+    # CV: set to 'native' in order to fit using binned likelihood with analytic derivatives instead of RooFit
+    #    (not supported for templateMorphingMode = 'horizontal')
+    fitBackend = cms.string('%s'),
+    # CV: repeat nominal fit using RooFit in case fitBackend = 'native' and report
+    #     differences in fitted tau id. efficiency and uncertainty (self-check of native likelihood)
+    compareFitBackends = cms.bool(%s),
+
+    # CV: fit "Asimov" dataset (sum of templates, without statistical fluctuations)
+    #     in order to determine expected tau id. efficiency uncertainty without running pseudo-experiments;
+    #     MINOS errors are computed in addition to HESSE errors in case 'runMinosAsimovFit' is enabled
+    runAsimovFit = cms.bool(%s),
+    runMinosAsimovFit = cms.bool(%s),
+
+    # CV: scan profile-likelihood of tau id. efficiency in range fitted value -/+ 'profileLikelihoodScanNumSigma' uncertainties;
+    #     the fits for different scan points are run in parallel by 'profileLikelihoodScanNumWorkers' worker processes
+    runProfileLikelihoodScan = cms.bool(%s),
+    profileLikelihoodScanNumPoints = cms.uint32(21),
+    profileLikelihoodScanNumSigma = cms.double(3.0),
+    profileLikelihoodScanNumWorkers = cms.uint32(4),
+
     runPseudoExperiments = cms.bool(False),
     #runPseudoExperiments = cms.bool(True),
     numPseudoExperiments = cms.uint32(10000),
+    # CV: fits of pseudo-experiments are started from result of nominal fit;
+    #     set to False in case only the distribution of fitted tau id. efficiencies is needed
+    runHessePseudoExperiments = cms.bool(True),
 
     intLumiData = cms.double(%f),
 
     makeControlPlots = cms.bool(%s),
-    controlPlotFilePath = cms.string('%s')
+    controlPlotFilePath = cms.string('%s'),
+
+    # CV: render control plots in background by 'numPlotWorkers' worker processes
+    #    (0 = render control plots in the process running the fit);
+    #     in case 'deferPlots' is enabled, control plots are not rendered,
+    #     but stored in ROOT files, to be rendered later by the 'renderTauIdEffPlots' macro
+    numPlotWorkers = cms.uint32(%i),
+    deferPlots = cms.bool(%s)
 )
 """ % (inputFileName, outputFileName_full,
        fitMethod, directory, getStringRep_bool(runClosureTest),
        regionsToFit_string,
        regionQCDtemplateFromData_passed, regionQCDtemplateFromData_failed, regionQCDtemplateFromData_D, 
        passed_region, failed_region, 
-       tauId, fitVariable, fitIndividualProcesses_string, templateMorphingMode, sysUncertainties_string,
-       intLumiData*1.e-3, makeControlPlots_string, outputFilePath_plots)
+       tauIds_string, fitVariables_string, numWorkers, fitIndividualProcesses_string, templateMorphingMode, sysUncertainties_string, fitBackend,
+       getStringRep_bool(compareFitBackends), getStringRep_bool(runAsimovFit), getStringRep_bool(runMinosAsimovFit), getStringRep_bool(runProfileLikelihoodScan),
+       intLumiData*1.e-3, makeControlPlots_string, outputFilePath_plots, numPlotWorkers, getStringRep_bool(deferPlots))
     
     configFileName = outputFileName.replace('.root', '_cfg.py')
     configFileName_full = os.path.join(outputFilePath, configFileName)
@@ -835,7 +972,8 @@ process.%s = cms.PSet(
     return retVal
 
 def buildConfigFile_makeTauIdEffFinalPlots(inputFileName, tauIds, tauIdNamesToPlot, binning, fitVariables,
-                                           outputFilePath, outputFileName, expEff_label, measEff_label, intLumiData):
+                                           outputFilePath, outputFileName, expEff_label, measEff_label, intLumiData,
+                                           numPlotWorkers = 0, deferPlots = False):
 
     """Make plots of tau id. efficiency as function of tauPt, tauEta,..."""
 
@@ -908,10 +1046,18 @@ process.makeTauIdEffFinalPlots = cms.PSet(
 %s    
     ),
 
-    outputFileName = cms.string('%s')
+    outputFileName = cms.string('%s'),
+
+    # CV: render plots in background by 'numPlotWorkers' worker processes
+    #    (0 = render plots directly);
+    #     in case 'deferPlots' is enabled, plots are not rendered,
+    #     but stored in a ROOT file, to be rendered later by the 'renderTauIdEffPlots' macro
+    numPlotWorkers = cms.uint32(%i),
+    deferPlots = cms.bool(%s)
 )
 """ % (inputFileName, tauIds_string, expEff_label, measEff_label, intLumiData*1.e-3,
-       fitVariables, xAxisBinning_string, binning['xAxisTitle'], values_string, outputFileName_full)
+       fitVariables, xAxisBinning_string, binning['xAxisTitle'], values_string, outputFileName_full,
+       numPlotWorkers, getStringRep_bool(deferPlots))
 
     configFileName = outputFileName;
     configFileName = configFileName.replace('.eps', '_cfg.py')
@@ -13,7 +13,8 @@ from PhysicsTools.PatAlgos.tools.jetTools import *
 def configurePatTupleProductionTauIdEffMeasSpecific(process, patSequenceBuilder = buildGenericTauSequence,
                                                     hltProcess = "HLT",
                                                     isMC = False, isEmbedded = False,
-                                                    runSVfit = False):
+                                                    runSVfit = False,
+                                                    storeTauShiftFactors = False):
 
     # check that patSequenceBuilder and patTauCleanerPrototype are defined and non-null
     if patSequenceBuilder is None:
@@ -245,7 +246,8 @@ def configurePatTupleProductionTauIdEffMeasSpecific(process, patSequenceBuilder
                                           savePFTauHPS,
                                           'patType1CorrectedPFMet',
                                           isMC = isMC, isEmbedded = isEmbedded,
-                                          runSVfit = runSVfit)
+                                          runSVfit = runSVfit,
+                                          storeTauShiftFactors = storeTauShiftFactors)
     process.producePatTupleTauIdEffMeasSpecific += retVal_pfTauHPS["sequence"]
     # CV: save HPS+TaNC taus passing the following tau id. discriminators
     #     for measurement of tau charge misidentification rate
@@ -12,7 +12,8 @@ def buildSequenceTauIdEffMeasSpecific(process,
                                       savePatTaus = None,
                                       patMEtCollectionName = "patType1CorrectedPFMet",
                                       isMC = False, isEmbedded = False,
-                                      runSVfit = False):
+                                      runSVfit = False,
+                                      storeTauShiftFactors = False):
 
     #print("<buildSequenceTauIdEffMeasSpecific>:")
     #print(" patTauCollectionName = %s" % patTauCollectionName)
@@ -147,7 +148,6 @@ def buildSequenceTauIdEffMeasSpecific(process,
     if isMC:
         # CV: shift Tau-jet energy by 3 standard-deviations,
         #     so that template morphing remains an interpolation and no extrapolation is needed
-        patTausJECshiftUpModuleName = composeModuleName([patTauSelectionModule.label(), "TauJetEnUp", "cumulative"])
         patTausJECshiftUpModule = cms.EDProducer("ShiftedPATTauJetProducer",
             src = cms.InputTag(composeModuleName([selTauCollectionName, "cumulative"])),
             jetCorrPayloadName = cms.string('AK5PF'),
@@ -155,16 +155,24 @@ def buildSequenceTauIdEffMeasSpecific(process,
             addResidualJES = cms.bool(False),                                     
             shiftBy = cms.double(+3.)
         )
-        setattr(process, patTausJECshiftUpModuleName, patTausJECshiftUpModule)
-        sequence += patTausJECshiftUpModule
-
-        patTausJECshiftDownModuleName = composeModuleName([patTauSelectionModule.label(), "TauJetEnDown", "cumulative"])
         patTausJECshiftDownModule = patTausJECshiftUpModule.clone(
             shiftBy = cms.double(-3.)
         )
-        setattr(process, patTausJECshiftDownModuleName, patTausJECshiftDownModule)
-        sequence += patTausJECshiftDownModule
+        # CV: in case shift factors are stored, the factors for the Tau-jet energy scale shifts
+        #     are computed directly from the jet energy scale uncertainty by PATTauShiftFactorProducer,
+        #     so that the shifted Tau-jet collections need not be produced
+        if not storeTauShiftFactors:
+            patTausJECshiftUpModuleName = composeModuleName([patTauSelectionModule.label(), "TauJetEnUp", "cumulative"])
+            setattr(process, patTausJECshiftUpModuleName, patTausJECshiftUpModule)
+            sequence += patTausJECshiftUpModule
+
+            patTausJECshiftDownModuleName = composeModuleName([patTauSelectionModule.label(), "TauJetEnDown", "cumulative"])
+            setattr(process, patTausJECshiftDownModuleName, patTausJECshiftDownModule)
+            sequence += patTausJECshiftDownModule
 
+        # CV: smearing of the Tau-jet energy resolution requires the matching of Tau-jets to generator level jets
+        #     implemented in SmearedPATTauJetProducer, so the smeared Tau-jet collections are produced
+        #     also in case shift factors are stored (the collections are not kept in the PAT-tuple in that case)
         process.load("RecoMET.METProducers.METSigParams_cfi")
         patTausJERshiftUpModuleName = composeModuleName([patTauSelectionModule.label(), "TauJetResUp", "cumulative"])
         patTausJERshiftUpModule = cms.EDProducer("SmearedPATTauJetProducer",
@@ -188,6 +196,45 @@ def buildSequenceTauIdEffMeasSpecific(process,
         setattr(process, patTausJERshiftDownModuleName, patTausJERshiftDownModule)
         sequence += patTausJERshiftDownModule
 
+    # CV: instead of building Muon + Tau-jet candidate pairs from the shifted/smeared Tau-jet collections,
+    #     store per Tau-jet the factors by which its momentum is shifted/smeared
+    #    (the factors are applied "on-the-fly" by FWLiteTauIdEffAnalyzer
+    #     to the Muon + Tau-jet pairs built from the "central" Tau-jet collection)
+    #
+    # NOTE: SVfit cannot be rerun "on-the-fly" in FWLite;
+    #       the SVfit mass of the shifted Muon + Tau-jet pairs is approximated
+    #       by scaling the SVfit mass of the "central" pair by the ratio of shifted to "central" visible mass.
+    #       The approximation is exact only in case the mass reconstructed by SVfit scales linearly with the visible mass;
+    #       the effect of the shift on the missing transverse momentum in the SVfit likelihood is not taken into account.
+    #       Set storeTauShiftFactors = False in case the TauJetEn/TauJetRes templates of the SVfit mass need to be exact.
+    #       The PF MEt of the shifted pairs is taken from the patType1CorrectedPFMet JetEn/JetRes Up/Down collections
+    #       kept in the PAT-tuple, as for the shifted Muon + Tau-jet pair collections
+    #      (cf. 'srcMEt' parameter of FWLiteTauIdEffAnalyzer).
+    tauShiftFactorModuleNames = {}
+    if isMC and storeTauShiftFactors:
+        for sysShift, patTausJECshiftModule in [ [ "TauJetEnUp",   patTausJECshiftUpModule   ],
+                                                 [ "TauJetEnDown", patTausJECshiftDownModule ] ]:
+            tauShiftFactorModule = cms.EDProducer("PATTauShiftFactorProducer",
+                src = patTausJECshiftModule.src,
+                jetCorrPayloadName = patTausJECshiftModule.jetCorrPayloadName,
+                jetCorrUncertaintyTag = patTausJECshiftModule.jetCorrUncertaintyTag,
+                shiftBy = patTausJECshiftModule.shiftBy
+            )
+            tauShiftFactorModuleName = composeModuleName([selTauCollectionName, "TauShiftFactor", sysShift])
+            setattr(process, tauShiftFactorModuleName, tauShiftFactorModule)
+            sequence += tauShiftFactorModule
+            tauShiftFactorModuleNames[sysShift] = tauShiftFactorModuleName
+        for sysShift, patTausShiftedModuleName in [ [ "TauJetResUp",   patTausJERshiftUpModuleName   ],
+                                                    [ "TauJetResDown", patTausJERshiftDownModuleName ] ]:
+            tauShiftFactorModule = cms.EDProducer("PATTauShiftFactorProducer",
+                src = cms.InputTag(composeModuleName([selTauCollectionName, "cumulative"])),
+                srcShifted = cms.InputTag(patTausShiftedModuleName)
+            )
+            tauShiftFactorModuleName = composeModuleName([selTauCollectionName, "TauShiftFactor", sysShift])
+            setattr(process, tauShiftFactorModuleName, tauShiftFactorModule)
+            sequence += tauShiftFactorModule
+            tauShiftFactorModuleNames[sysShift] = tauShiftFactorModuleName
+
     #--------------------------------------------------------------------------------
     # define selection of Muon + Tau-jet candidate pairs
     #--------------------------------------------------------------------------------
@@ -222,22 +269,6 @@ def buildSequenceTauIdEffMeasSpecific(process,
     muTauPairProdConfigurator_systematics = None
     if isMC:
         muTauPairProdConfigurator_systematics = {
-            "TauJetEnUp" : {
-                "srcLeg2" : cms.InputTag(patTausJECshiftUpModuleName),
-                "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetEnUp"]))
-            },
-            "TauJetEnDown" : {
-                "srcLeg2" : cms.InputTag(patTausJECshiftDownModuleName),
-                "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetEnDown"]))
-            },
-            "TauJetResUp" : {
-                "srcLeg2" : cms.InputTag(patTausJERshiftUpModuleName),
-                "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetResUp"]))
-            },
-            "TauJetResDown" : {
-                "srcLeg2" : cms.InputTag(patTausJERshiftDownModuleName),
-                "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetResDown"]))
-            },
             "JetEnUp" : {
                 "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetEnUp"]))
             },
@@ -251,6 +282,25 @@ def buildSequenceTauIdEffMeasSpecific(process,
                 "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "UnclusteredEnDown"]))
             }
         }
+        if not storeTauShiftFactors:
+            muTauPairProdConfigurator_systematics.update({
+                "TauJetEnUp" : {
+                    "srcLeg2" : cms.InputTag(patTausJECshiftUpModuleName),
+                    "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetEnUp"]))
+                },
+                "TauJetEnDown" : {
+                    "srcLeg2" : cms.InputTag(patTausJECshiftDownModuleName),
+                    "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetEnDown"]))
+                },
+                "TauJetResUp" : {
+                    "srcLeg2" : cms.InputTag(patTausJERshiftUpModuleName),
+                    "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetResUp"]))
+                },
+                "TauJetResDown" : {
+                    "srcLeg2" : cms.InputTag(patTausJERshiftDownModuleName),
+                    "srcMET"  : cms.InputTag(composeModuleName([patMEtCollectionName, "JetResDown"]))
+                }
+            })
     muTauPairProdConfigurator = objProdConfigurator(
         allMuTauPairsModule,
         pyModuleName = __name__
@@ -264,15 +314,18 @@ def buildSequenceTauIdEffMeasSpecific(process,
     sequence += prodMuTauPairSequence
 
     muTauPairSystematicsForTauIdEff = {
-        "TauJetEnUp"        : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetEnUp"])),
-        "TauJetEnDown"      : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetEnDown"])),
-        "TauJetResUp"       : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetResUp"])),
-        "TauJetResDown"     : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetResDown"])),
         "JetEnUp"           : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "JetEnUp"])),
         "JetEnDown"         : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "JetEnDown"])),
         "UnclusteredEnUp"   : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "UnclusteredEnUp"])),
         "UnclusteredEnDown" : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "UnclusteredEnDown"]))
     }
+    if not storeTauShiftFactors:
+        muTauPairSystematicsForTauIdEff.update({
+            "TauJetEnUp"    : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetEnUp"])),
+            "TauJetEnDown"  : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetEnDown"])),
+            "TauJetResUp"   : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetResUp"])),
+            "TauJetResDown" : cms.InputTag(composeModuleName([allMuTauPairsModuleName, "TauJetResDown"]))
+        })
 
     #print("muTauPairSystematicsForTauIdEff:", muTauPairSystematicsForTauIdEff)
 
@@ -326,18 +379,25 @@ def buildSequenceTauIdEffMeasSpecific(process,
     retVal["muTauPairCollections"] = [
         composeModuleName([selectedMuTauPairsDzModuleName,                                                "cumulative"])
     ]
+    retVal["tauShiftFactorCollections"] = tauShiftFactorModuleNames
     if isMC:
+        if not storeTauShiftFactors:
+            retVal["patTauCollections"].extend([
+                composeModuleName([selTauCollectionName,                             "TauJetEnUp",        "cumulative"]),
+                composeModuleName([selTauCollectionName,                             "TauJetEnDown",      "cumulative"])
+            ])
         retVal["patTauCollections"].extend([
-            composeModuleName([selTauCollectionName,                                 "TauJetEnUp",        "cumulative"]),
-            composeModuleName([selTauCollectionName,                                 "TauJetEnDown",      "cumulative"]),
             composeModuleName([selTauCollectionName,                                 "TauJetResUp",       "cumulative"]),
             composeModuleName([selTauCollectionName,                                 "TauJetResDown",     "cumulative"])
         ])
+        if not storeTauShiftFactors:
+            retVal["muTauPairCollections"].extend([
+                composeModuleName([selectedMuTauPairsDzModuleName,                   "TauJetEnUp",        "cumulative"]),
+                composeModuleName([selectedMuTauPairsDzModuleName,                   "TauJetEnDown",      "cumulative"]),
+                composeModuleName([selectedMuTauPairsDzModuleName,                   "TauJetResUp",       "cumulative"]),
+                composeModuleName([selectedMuTauPairsDzModuleName,                   "TauJetResDown",     "cumulative"])
+            ])
         retVal["muTauPairCollections"].extend([
-            composeModuleName([selectedMuTauPairsDzModuleName,                       "TauJetEnUp",        "cumulative"]),
-            composeModuleName([selectedMuTauPairsDzModuleName,                       "TauJetEnDown",      "cumulative"]),
-            composeModuleName([selectedMuTauPairsDzModuleName,                       "TauJetResUp",       "cumulative"]),
-            composeModuleName([selectedMuTauPairsDzModuleName,                       "TauJetResDown",     "cumulative"]),
             composeModuleName([selectedMuTauPairsDzModuleName,                       "JetEnUp",           "cumulative"]),
             composeModuleName([selectedMuTauPairsDzModuleName,                       "JetEnDown",         "cumulative"]),
             composeModuleName([selectedMuTauPairsDzModuleName,                       "UnclusteredEnUp",   "cumulative"]),
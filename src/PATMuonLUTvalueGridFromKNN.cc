@@ -0,0 +1,296 @@
+#include "TauAnalysis/TauIdEfficiency/interface/PATMuonLUTvalueGridFromKNN.h"
+
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TMVA/Reader.h>
+#include <TMath.h>
+#include <TRandom3.h>
+
+#include <algorithm>
+
+typedef std::vector<edm::ParameterSet> vParameterSet;
+
+PATMuonLUTvalueGridFromKNN::PATMuonLUTvalueGridFromKNN(const edm::ParameterSet& cfg)
+  : useGrid_(false),
+    tolerance_(0.),
+    gridFailedValidation_(false),
+    mvaReader_(0),
+    numValidationMuons_(0),
+    numLookups_(0),
+    numMemoized_(0),
+    numInterpolated_(0),
+    numExact_(0),
+    numValidated_(0),
+    numValidationFailures_(0),
+    maxDeviation_(0.),
+    numCellsExact_(0),
+    maxDeviationGrid_(0.)
+{
+  vParameterSet cfgParametrization = cfg.getParameter<vParameterSet>("parametrization");
+  for ( vParameterSet::const_iterator cfgVariable = cfgParametrization.begin();
+	cfgVariable != cfgParametrization.end(); ++cfgVariable ) {
+    variableEntryType variable;
+    variable.name_ = cfgVariable->getParameter<std::string>("name");
+    variable.function_ = new StringObjectFunction<pat::Muon>(cfgVariable->getParameter<std::string>("expression"));
+    variable.min_ = 0.;
+    variable.max_ = 0.;
+    variable.numPoints_ = 0;
+    variable.step_ = 0.;
+    variable.nodeStride_ = 0;
+    variable.cellStride_ = 0;
+    variables_.push_back(variable);
+  }
+
+  edm::FileInPath inputFileName = cfg.getParameter<edm::FileInPath>("inputFileName");
+  bookReader(inputFileName.fullPath());
+
+  useGrid_ = ( cfg.exists("useGrid") ) ?
+    cfg.getParameter<bool>("useGrid") : false;
+  if ( useGrid_ ) {
+    tolerance_ = cfg.getParameter<double>("gridTolerance");
+    numValidationMuons_ = ( cfg.exists("gridNumValidationMuons") ) ?
+      cfg.getParameter<unsigned>("gridNumValidationMuons") : 1000;
+    unsigned numValidationPoints = ( cfg.exists("gridNumValidationPoints") ) ?
+      cfg.getParameter<unsigned>("gridNumValidationPoints") : 10000;
+    unsigned maxNumCells = ( cfg.exists("gridMaxNumCells") ) ?
+      cfg.getParameter<unsigned>("gridMaxNumCells") : 100000;
+
+    unsigned nodeStride = 1;
+    unsigned cellStride = 1;
+    double numCells = 1.; // CV: computed as double, in order to detect overflows
+    for ( size_t idxVariable = 0; idxVariable < variables_.size(); ++idxVariable ) {
+      variableEntryType& variable = variables_[idxVariable];
+      const edm::ParameterSet& cfgVariable = cfgParametrization[idxVariable];
+      variable.min_ = cfgVariable.getParameter<double>("gridMin");
+      variable.max_ = cfgVariable.getParameter<double>("gridMax");
+      variable.numPoints_ = cfgVariable.getParameter<unsigned>("gridNumPoints");
+      if ( !(variable.max_ > variable.min_ && variable.numPoints_ >= 2) )
+	throw cms::Exception("PATMuonLUTvalueGridFromKNN")
+	  << "Invalid grid = [ " << variable.min_ << ", " << variable.max_ << " ] (" << variable.numPoints_ << " points)"
+	  << " defined for variable = " << variable.name_ << " !!\n";
+      variable.step_ = (variable.max_ - variable.min_)/(variable.numPoints_ - 1);
+      numCells *= (variable.numPoints_ - 1);
+      if ( numCells > maxNumCells )
+	throw cms::Exception("PATMuonLUTvalueGridFromKNN")
+	  << "Number of grid cells exceeds limit = " << maxNumCells << " given by 'gridMaxNumCells',"
+	  << " reduce number of grid points !!\n";
+      variable.nodeStride_ = nodeStride;
+      variable.cellStride_ = cellStride;
+      nodeStride *= variable.numPoints_;
+      cellStride *= (variable.numPoints_ - 1);
+    }
+
+    buildGrid((unsigned)numCells, numValidationPoints);
+  }
+
+  x_.resize(variables_.size());
+  idxPoints_.resize(variables_.size());
+  f_.resize(variables_.size());
+}
+
+PATMuonLUTvalueGridFromKNN::~PATMuonLUTvalueGridFromKNN()
+{
+  for ( std::vector<variableEntryType>::iterator variable = variables_.begin();
+	variable != variables_.end(); ++variable ) {
+    delete variable->function_;
+  }
+
+  delete mvaReader_;
+}
+
+double PATMuonLUTvalueGridFromKNN::evaluateKNN(const vdouble& x)
+{
+  for ( size_t idxVariable = 0; idxVariable < variables_.size(); ++idxVariable ) {
+    mvaInputs_[idxVariable] = x[idxVariable];
+  }
+  return mvaReader_->EvaluateMVA("kNN");
+}
+
+void PATMuonLUTvalueGridFromKNN::validateCell(const vdouble& x, unsigned& numPointsValidated)
+{
+  unsigned idxCell = 0;
+  std::vector<unsigned> idxPoints(variables_.size());
+  vdouble f(variables_.size());
+  if ( !findCell(x, idxCell, idxPoints, f) ) return;
+  double deviation = TMath::Abs(interpolate(idxPoints, f) - evaluateKNN(x));
+  if ( deviation > maxDeviationGrid_ ) maxDeviationGrid_ = deviation;
+  if ( deviation > tolerance_ && !cellIsExact_[idxCell] ) {
+    cellIsExact_[idxCell] = true;
+    ++numCellsExact_;
+  }
+  ++numPointsValidated;
+}
+
+void PATMuonLUTvalueGridFromKNN::bookReader(const std::string& inputFileName)
+{
+  size_t numVariables = variables_.size();
+
+  mvaReader_ = new TMVA::Reader("!Color:Silent");
+  mvaInputs_.resize(numVariables);
+  for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+    mvaReader_->AddVariable(variables_[idxVariable].name_.data(), &mvaInputs_[idxVariable]);
+  }
+  mvaReader_->BookMVA("kNN", inputFileName.data());
+}
+
+void PATMuonLUTvalueGridFromKNN::buildGrid(unsigned numCells, unsigned numValidationPoints)
+{
+  size_t numVariables = variables_.size();
+
+//--- compute k-NN response at grid nodes
+  unsigned numNodes = 1;
+  for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+    numNodes *= variables_[idxVariable].numPoints_;
+  }
+  std::cout << "<PATMuonLUTvalueGridFromKNN>: precomputing k-NN response for " << numNodes << " grid nodes..." << std::endl;
+
+  gridValues_.resize(numNodes);
+  vdouble x(numVariables);
+  for ( unsigned idxNode = 0; idxNode < numNodes; ++idxNode ) {
+    for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+      const variableEntryType& variable = variables_[idxVariable];
+      unsigned idxPoint = (idxNode/variable.nodeStride_) % variable.numPoints_;
+      x[idxVariable] = variable.min_ + idxPoint*variable.step_;
+    }
+    gridValues_[idxNode] = evaluateKNN(x);
+  }
+
+//--- compare interpolated values to exact k-NN response in center of each grid cell
+//    and at points drawn at random within the grid;
+//    cells in which the difference exceeds the tolerance are evaluated exactly
+//
+// NOTE: the decision which cells are evaluated exactly is taken here, once,
+//       in order for the values not to depend on the order in which events are processed;
+//       a fixed seed is used for the random points, so that the decision is reproducible
+  cellIsExact_.assign(numCells, false);
+  unsigned numPointsValidated = 0;
+  for ( unsigned idxCell = 0; idxCell < numCells; ++idxCell ) {
+    for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+      const variableEntryType& variable = variables_[idxVariable];
+      unsigned idxPoint = (idxCell/variable.cellStride_) % (variable.numPoints_ - 1);
+      x[idxVariable] = variable.min_ + (idxPoint + 0.5)*variable.step_;
+    }
+    validateCell(x, numPointsValidated);
+  }
+  TRandom3 rnd(12345);
+  for ( unsigned idxValidationPoint = 0; idxValidationPoint < numValidationPoints; ++idxValidationPoint ) {
+    for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+      const variableEntryType& variable = variables_[idxVariable];
+      x[idxVariable] = rnd.Uniform(variable.min_, variable.max_);
+    }
+    validateCell(x, numPointsValidated);
+  }
+  std::cout << " " << numCellsExact_ << " out of " << numCells << " grid cells exceed tolerance = " << tolerance_
+	    << " (max. deviation = " << maxDeviationGrid_ << " in " << numPointsValidated << " points)"
+	    << " --> computing k-NN response exactly for muons within these cells." << std::endl;
+}
+
+bool PATMuonLUTvalueGridFromKNN::findCell(const vdouble& x, unsigned& idxCell, std::vector<unsigned>& idxPoints, vdouble& f) const
+{
+  idxCell = 0;
+  for ( size_t idxVariable = 0; idxVariable < variables_.size(); ++idxVariable ) {
+    const variableEntryType& variable = variables_[idxVariable];
+    if ( !(x[idxVariable] >= variable.min_ && x[idxVariable] <= variable.max_) ) return false;
+    double u = (x[idxVariable] - variable.min_)/variable.step_;
+    unsigned idxPoint = TMath::Min((unsigned)u, variable.numPoints_ - 2);
+    idxPoints[idxVariable] = idxPoint;
+    f[idxVariable] = u - idxPoint;
+    idxCell += idxPoint*variable.cellStride_;
+  }
+  return true;
+}
+
+double PATMuonLUTvalueGridFromKNN::interpolate(const std::vector<unsigned>& idxPoints, const vdouble& f) const
+{
+//--- multilinear interpolation between the 2^N nodes at the corners of the grid cell
+  size_t numVariables = variables_.size();
+  unsigned numCorners = (1 << numVariables);
+  double retVal = 0.;
+  for ( unsigned idxCorner = 0; idxCorner < numCorners; ++idxCorner ) {
+    unsigned idxNode = 0;
+    double weight = 1.;
+    for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+      const variableEntryType& variable = variables_[idxVariable];
+      if ( (idxCorner >> idxVariable) & 1 ) {
+	idxNode += (idxPoints[idxVariable] + 1)*variable.nodeStride_;
+	weight *= f[idxVariable];
+      } else {
+	idxNode += idxPoints[idxVariable]*variable.nodeStride_;
+	weight *= (1. - f[idxVariable]);
+      }
+    }
+    if ( weight != 0. ) retVal += weight*gridValues_[idxNode];
+  }
+  return retVal;
+}
+
+double PATMuonLUTvalueGridFromKNN::operator()(const pat::Muon& muon)
+{
+  ++numLookups_;
+
+  size_t numVariables = variables_.size();
+  for ( size_t idxVariable = 0; idxVariable < numVariables; ++idxVariable ) {
+    x_[idxVariable] = (*variables_[idxVariable].function_)(muon);
+  }
+
+//--- check if value has been computed for same muon before
+//   (linear search, as the number of muons per event is small)
+  size_t numMemoized = memoizedValues_.size();
+  for ( size_t idxMemoized = 0; idxMemoized < numMemoized; ++idxMemoized ) {
+    if ( std::equal(x_.begin(), x_.end(), memoizedInputs_.begin() + idxMemoized*numVariables) ) {
+      ++numMemoized_;
+      return memoizedValues_[idxMemoized];
+    }
+  }
+
+  double retVal = 0.;
+  unsigned idxCell = 0;
+  bool isInterpolated = false;
+  if ( useGrid_ && !gridFailedValidation_ && findCell(x_, idxCell, idxPoints_, f_) && !cellIsExact_[idxCell] ) {
+    retVal = interpolate(idxPoints_, f_);
+    isInterpolated = true;
+
+//--- cross-check interpolated value with exact k-NN response for first muons;
+//    in case the deviation exceeds the tolerance, the validation of the grid performed in buildGrid
+//    has missed a region in which the interpolation is inaccurate:
+//    return the exact value and stop using the grid for the remaining muons
+    if ( numValidated_ < (long)numValidationMuons_ ) {
+      double exactValue = evaluateKNN(x_);
+      double deviation = TMath::Abs(retVal - exactValue);
+      if ( deviation > maxDeviation_ ) maxDeviation_ = deviation;
+      ++numValidated_;
+      if ( deviation > tolerance_ ) {
+	++numValidationFailures_;
+	gridFailedValidation_ = true;
+	std::cerr << "Warning in <PATMuonLUTvalueGridFromKNN>: interpolated value = " << retVal 
+		  << " deviates from exact k-NN response = " << exactValue << " by more than tolerance = " << tolerance_ 
+		  << " --> computing k-NN response exactly for all further muons." << std::endl;
+	retVal = exactValue;
+	isInterpolated = false;
+      }
+    }
+  } else {
+    retVal = evaluateKNN(x_);
+  }
+  if ( isInterpolated ) ++numInterpolated_;
+  else ++numExact_;
+
+  memoizedInputs_.insert(memoizedInputs_.end(), x_.begin(), x_.end());
+  memoizedValues_.push_back(retVal);
+
+  return retVal;
+}
+
+void PATMuonLUTvalueGridFromKNN::print(std::ostream& stream) const
+{
+  stream << "<PATMuonLUTvalueGridFromKNN::print>:" << std::endl;
+  stream << " numLookups = " << numLookups_ << ":"
+	 << " memoized = " << numMemoized_ << ", interpolated = " << numInterpolated_ << ", exact = " << numExact_ << std::endl;
+  if ( useGrid_ ) {
+    stream << " " << numCellsExact_ << " grid cells evaluated exactly (max. deviation at grid validation = " << maxDeviationGrid_ << ")" << std::endl;
+    stream << " cross-checked " << numValidated_ << " interpolated values:"
+	   << " max. deviation = " << maxDeviation_ << ", " << numValidationFailures_ << " exceed tolerance = " << tolerance_ << std::endl;
+    if ( gridFailedValidation_ ) stream << " grid disabled after failed cross-check --> k-NN response computed exactly." << std::endl;
+  }
+}
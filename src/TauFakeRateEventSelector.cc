@@ -71,54 +71,71 @@ bool TauFakeRateEventSelector::operator()(const pat::Tau& tauJetCand, pat::strbi
 {
   //std::cout << "<TauFakeRateEventSelector::operator()>:" << std::endl;
 
+  if ( !passesPreselection(tauJetCand) ) return false;
+
+  bool tauIdDiscriminators_passed = ( tauIdDiscriminatorCut_ != kNotApplied ) ?
+    passesTauIdDiscriminators(tauJetCand) : true;
+
+  return passesRegion(tauIdDiscriminators_passed);
+}
+
+bool TauFakeRateEventSelector::passesPreselection(const pat::Tau& tauJetCand) const
+{
   double jetPt  = tauJetCand.p4Jet().pt();
   double jetEta = tauJetCand.p4Jet().eta();
 
 //--- check if tau-jet candidates passes Pt and eta cuts
-  if ( jetPt  > jetPtMin_  && jetPt  < jetPtMax_  &&
-       jetEta > jetEtaMin_ && jetEta < jetEtaMax_ ) {
-    //std::cout << "passed Pt and eta cuts." << std::endl;
+  if ( !(jetPt  > jetPtMin_  && jetPt  < jetPtMax_  &&
+	 jetEta > jetEtaMin_ && jetEta < jetEtaMax_) ) return false;
+  //std::cout << "passed Pt and eta cuts." << std::endl;
 
 //--- check if tau-jet candidates passes preselection criteria
-    bool preselCriteria_passed = true;
-    for ( std::vector<StringCutTauSelectorType*>::iterator tauJetCandPreselCriterion = tauJetCandPreselCriteria_.begin();
-	  tauJetCandPreselCriterion != tauJetCandPreselCriteria_.end(); ++tauJetCandPreselCriterion ) {
-      //std::cout << "checking " << (*tauJetCandPreselCriterion)->cut_ << std::endl;
-      if ( !(*(*tauJetCandPreselCriterion)->selector_)(tauJetCand) ) {
-	//std::cout << " failed." << std::endl;
-	preselCriteria_passed = false;
-	break;
-      }
+  for ( std::vector<StringCutTauSelectorType*>::const_iterator tauJetCandPreselCriterion = tauJetCandPreselCriteria_.begin();
+	tauJetCandPreselCriterion != tauJetCandPreselCriteria_.end(); ++tauJetCandPreselCriterion ) {
+    //std::cout << "checking " << (*tauJetCandPreselCriterion)->cut_ << std::endl;
+    if ( !(*(*tauJetCandPreselCriterion)->selector_)(tauJetCand) ) {
+      //std::cout << " failed." << std::endl;
+      return false;
     }
+  }
 
-    if ( preselCriteria_passed ) {
-      bool tauIdDiscriminators_passed = true;
-      for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators_.begin();
-	    tauIdDiscriminator != tauIdDiscriminators_.end(); ++tauIdDiscriminator ) {
-	double tauIdDiscriminator_value = tauJetCand.tauID(*tauIdDiscriminator);
-	//std::cout << "checking " << (*tauIdDiscriminator) << ": " << tauIdDiscriminator_value << std::endl;
-	if ( !(tauIdDiscriminator_value > tauIdDiscriminatorMin_  && 
-	       tauIdDiscriminator_value < tauIdDiscriminatorMax_) ) {
-	  tauIdDiscriminators_passed = false;
-	  break;
-	}
-	//std::cout << " passed." << std::endl;
-      }
-
-      tauIdDiscriminators_passed &= (tauJetCand.pt() > 15.0); // require tauPt > 15 GeV, in order to compare with "old" HPS/TaNC results
-
-      //std::cout << "tauIdDiscriminatorCut = ";
-      //if      ( tauIdDiscriminatorCut_ == kNotApplied     ) std::cout << "not applied.";
-      //else if ( tauIdDiscriminatorCut_ == kSignalLike     ) std::cout << "signal-like.";
-      //else if ( tauIdDiscriminatorCut_ == kBackgroundLike ) std::cout << "background-like.";
-      //else std::cout << "undefined.";
-      //std::cout << std::endl;
-
-      if ( tauIdDiscriminatorCut_ == kNotApplied                                     ||
-	  (tauIdDiscriminatorCut_ == kSignalLike     &&  tauIdDiscriminators_passed) ||
-	  (tauIdDiscriminatorCut_ == kBackgroundLike && !tauIdDiscriminators_passed) ) return true;
-    }
+  return true;
+}
+
+bool TauFakeRateEventSelector::passesTauIdDiscriminators(const pat::Tau& tauJetCand) const
+{
+  for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators_.begin();
+	tauIdDiscriminator != tauIdDiscriminators_.end(); ++tauIdDiscriminator ) {
+    double tauIdDiscriminator_value = tauJetCand.tauID(*tauIdDiscriminator);
+    //std::cout << "checking " << (*tauIdDiscriminator) << ": " << tauIdDiscriminator_value << std::endl;
+    if ( !(tauIdDiscriminator_value > tauIdDiscriminatorMin_  && 
+	   tauIdDiscriminator_value < tauIdDiscriminatorMax_) ) return false;
+    //std::cout << " passed." << std::endl;
   }
 
-  return false;
+  return (tauJetCand.pt() > 15.0); // require tauPt > 15 GeV, in order to compare with "old" HPS/TaNC results
+}
+
+bool TauFakeRateEventSelector::passesRegion(bool tauIdDiscriminators_passed) const
+{
+  //std::cout << "tauIdDiscriminatorCut = ";
+  //if      ( tauIdDiscriminatorCut_ == kNotApplied     ) std::cout << "not applied.";
+  //else if ( tauIdDiscriminatorCut_ == kSignalLike     ) std::cout << "signal-like.";
+  //else if ( tauIdDiscriminatorCut_ == kBackgroundLike ) std::cout << "background-like.";
+  //else std::cout << "undefined.";
+  //std::cout << std::endl;
+
+  return ( tauIdDiscriminatorCut_ == kNotApplied                                     ||
+	  (tauIdDiscriminatorCut_ == kSignalLike     &&  tauIdDiscriminators_passed) ||
+	  (tauIdDiscriminatorCut_ == kBackgroundLike && !tauIdDiscriminators_passed) );
+}
+
+TauFakeRateEventSelector::vstring TauFakeRateEventSelector::getPreselCriteria() const
+{
+  vstring retVal;
+  for ( std::vector<StringCutTauSelectorType*>::const_iterator tauJetCandPreselCriterion = tauJetCandPreselCriteria_.begin();
+	tauJetCandPreselCriterion != tauJetCandPreselCriteria_.end(); ++tauJetCandPreselCriterion ) {
+    retVal.push_back((*tauJetCandPreselCriterion)->cut_);
+  }
+  return retVal;
 }
@@ -1,5 +1,9 @@
 #include "TauAnalysis/TauIdEfficiency/interface/TauFakeRateHistManager.h"
 
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include "CommonTools/Utils/interface/TH1AddDirectorySentry.h"
+
 #include "FWCore/Utilities/interface/Exception.h"
 
 #include "DataFormats/Candidate/interface/Candidate.h"
@@ -11,6 +15,8 @@ TauFakeRateHistManager::TauFakeRateHistManager(const edm::ParameterSet& cfg)
   process_            = cfg.getParameter<std::string>("process");
   region_             = cfg.getParameter<std::string>("region");
   tauIdDiscriminator_ = cfg.getParameter<std::string>("tauIdDiscriminator");
+  writeHistogramBundle_ = cfg.exists("writeHistogramBundle") ?
+    cfg.getParameter<bool>("writeHistogramBundle") : false;
 }
 
 TauFakeRateHistManager::~TauFakeRateHistManager()
@@ -58,21 +64,37 @@ void TauFakeRateHistManager::scaleHistograms(double factor)
 TH1* TauFakeRateHistManager::book1D(TFileDirectory& dir,
 				    const std::string& distribution, const std::string& title, int numBins, double min, double max)
 {
-  TH1* retVal = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, min, max);
-  if ( !retVal->GetSumw2N() ) retVal->Sumw2();
-  histograms_.push_back(retVal);
-  return retVal;
+  TH1* histogram = 0;
+  if ( writeHistogramBundle_ ) {
+    TH1AddDirectorySentry sentry;
+    histogram = new TH1D(getHistogramName(distribution).data(), title.data(), numBins, min, max);
+  } else {
+    histogram = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, min, max);
+  }
+  return registerHistogram(dir, histogram);
 }
  
 TH1* TauFakeRateHistManager::book1D(TFileDirectory& dir,
 				    const std::string& distribution, const std::string& title, int numBins, float* binning)
 {
-  TH1* retVal = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, binning);
-  if ( !retVal->GetSumw2N() ) retVal->Sumw2();
-  histograms_.push_back(retVal);
-  return retVal;
+  TH1* histogram = 0;
+  if ( writeHistogramBundle_ ) {
+    TH1AddDirectorySentry sentry;
+    histogram = new TH1D(getHistogramName(distribution).data(), title.data(), numBins, binning);
+  } else {
+    histogram = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, binning);
+  }
+  return registerHistogram(dir, histogram);
 }
  
+TH1* TauFakeRateHistManager::registerHistogram(TFileDirectory& dir, TH1* histogram)
+{
+  if ( !histogram->GetSumw2N() ) histogram->Sumw2();
+  if ( writeHistogramBundle_ ) TauIdEffHistogramBundle::getBundle(dir)->addHistogram(histogram);
+  histograms_.push_back(histogram);
+  return histogram;
+}
+
 std::string TauFakeRateHistManager::getHistogramName(const std::string& distribution)
 {
   std::string retVal = std::string(process_).append("_").append(region_).append("_").append(distribution);
@@ -0,0 +1,576 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffBinnedLikelihood.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <Minuit2/FCNGradAdapter.h>
+#include <Minuit2/FunctionMinimum.h>
+#include <Minuit2/MinosError.h>
+#include <Minuit2/MnHesse.h>
+#include <Minuit2/MnMigrad.h>
+#include <Minuit2/MnMinos.h>
+#include <Minuit2/MnPrint.h>
+#include <Minuit2/MnStrategy.h>
+#include <Minuit2/MnUserCovariance.h>
+#include <Minuit2/MnUserParameters.h>
+#include <Minuit2/MnUserParameterState.h>
+#include <TMath.h>
+
+#include <iostream>
+
+// CV: expected event yields below this value are treated as this value,
+//     in order to avoid infinite log-likelihood values in bins with observed events
+//    (same floor as used by VerticalInterpPdf)
+const double minExpected = 1.e-9;
+
+TauIdEffBinnedLikelihood::TauIdEffBinnedLikelihood()
+  : errorLevel_(0.5),
+    tolerance_(1.),
+    strategy_(1),
+    printLevel_(-1),
+    runHesse_(true),
+    status_(-1),
+    minimum_(0.),
+    numFunctionCalls_(0)
+{}
+
+TauIdEffBinnedLikelihood::~TauIdEffBinnedLikelihood()
+{
+// nothing to be done yet...
+}
+
+ROOT::Math::IMultiGradFunction* TauIdEffBinnedLikelihood::Clone() const
+{
+  return new TauIdEffBinnedLikelihood(*this);
+}
+
+unsigned TauIdEffBinnedLikelihood::addParameter(const std::string& name, double value, double min, double max, bool isConstant)
+{
+  parameterEntryType parameter;
+  parameter.name_ = name;
+  parameter.value_ = ( min < max ) ? TMath::Min(TMath::Max(value, min), max) : value;
+  parameter.min_ = min;
+  parameter.max_ = max;
+  parameter.isConstant_ = isConstant;
+  parameter.error_ = 0.;
+  parameter.runMinos_ = false;
+  parameter.hasMinosErrors_ = false;
+  parameter.errorLow_ = 0.;
+  parameter.errorHigh_ = 0.;
+  parameters_.push_back(parameter);
+  covariance_.assign(parameters_.size()*parameters_.size(), 0.);
+  return parameters_.size() - 1;
+}
+
+std::vector<double> TauIdEffBinnedLikelihood::getBinContents(const TH1* histogram, unsigned numBins) const
+{
+  if ( (unsigned)histogram->GetNbinsX() != numBins )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Histogram = " << histogram->GetName() << " has " << histogram->GetNbinsX() << " bins,"
+      << " expected " << numBins << " !!\n";
+
+//--- underflow and overflow bins are outside of fit range
+  std::vector<double> binContents(numBins);
+  for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+    binContents[iBin] = histogram->GetBinContent(iBin + 1);
+  }
+  return binContents;
+}
+
+unsigned TauIdEffBinnedLikelihood::addChannel(const std::string& name, const TH1* histogramData)
+{
+  channelEntryType channel;
+  channel.name_ = name;
+  channel.firstBin_ = data_.size();
+  channel.numBins_ = histogramData->GetNbinsX();
+  std::vector<double> binContents = getBinContents(histogramData, channel.numBins_);
+  data_.insert(data_.end(), binContents.begin(), binContents.end());
+  channels_.push_back(channel);
+  weights_.resize(data_.size());
+  return channels_.size() - 1;
+}
+
+unsigned TauIdEffBinnedLikelihood::addComponent(unsigned idxChannel, const TH1* histogramTemplate, double coefficient, double fittedFraction)
+{
+  if ( idxChannel >= channels_.size() )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Invalid channel index = " << idxChannel << " !!\n";
+  channelEntryType& channel = channels_[idxChannel];
+
+  componentEntryType component;
+  component.idxChannel_ = idxChannel;
+  component.firstBin_ = shapes_.size();
+  component.coefficient_ = coefficient;
+  component.fittedFraction_ = fittedFraction;
+  std::vector<double> shape = getBinContents(histogramTemplate, channel.numBins_);
+  component.integral_ = 0.;
+  for ( unsigned iBin = 0; iBin < channel.numBins_; ++iBin ) {
+    component.integral_ += shape[iBin];
+  }
+  // CV: template histograms may be empty in case of low Monte Carlo statistics;
+  //     keep template shape zero in that case
+  if ( !(component.integral_ > 0.) ) component.integral_ = 1.;
+  for ( unsigned iBin = 0; iBin < channel.numBins_; ++iBin ) {
+    shape[iBin] /= component.integral_;
+  }
+  shapes_.insert(shapes_.end(), shape.begin(), shape.end());
+  components_.push_back(component);
+  channel.components_.push_back(components_.size() - 1);
+  morphedShapes_.resize(shapes_.size());
+  yields_.resize(components_.size());
+  shapeNorms_.resize(components_.size());
+  return components_.size() - 1;
+}
+
+void TauIdEffBinnedLikelihood::addYieldFactor(unsigned idxComponent, unsigned idxParameter, bool isInverted)
+{
+  if ( idxComponent >= components_.size() || idxParameter >= parameters_.size() )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Invalid component index = " << idxComponent << " or parameter index = " << idxParameter << " !!\n";
+  yieldFactorEntryType yieldFactor;
+  yieldFactor.idxParameter_ = idxParameter;
+  yieldFactor.isInverted_ = isInverted;
+  components_[idxComponent].yieldFactors_.push_back(yieldFactor);
+}
+
+void TauIdEffBinnedLikelihood::addMorphing(unsigned idxComponent, unsigned idxParameter,
+					   const TH1* histogramTemplateUp, const TH1* histogramTemplateDown,
+					   double fittedFractionUp, double fittedFractionDown)
+{
+  if ( idxComponent >= components_.size() || idxParameter >= parameters_.size() )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Invalid component index = " << idxComponent << " or parameter index = " << idxParameter << " !!\n";
+  componentEntryType& component = components_[idxComponent];
+  unsigned numBins = channels_[component.idxChannel_].numBins_;
+
+//--- store differences of shifted templates with respect to central value,
+//    scaled by the same factor as the central value
+//   (same as VerticalInterpPdf, bin-contents are interpolated first and the morphed template is normalized afterwards)
+  std::vector<double> shapeUp = getBinContents(histogramTemplateUp, numBins);
+  std::vector<double> shapeDown = getBinContents(histogramTemplateDown, numBins);
+  for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+    double shape_central_value = shapes_[component.firstBin_ + iBin];
+    shapeUp[iBin] = shapeUp[iBin]/component.integral_ - shape_central_value;
+    shapeDown[iBin] = shape_central_value - shapeDown[iBin]/component.integral_;
+  }
+
+  morphingEntryType morphing;
+  morphing.idxParameter_ = idxParameter;
+  morphing.firstBinUp_ = shapes_.size();
+  shapes_.insert(shapes_.end(), shapeUp.begin(), shapeUp.end());
+  morphing.firstBinDown_ = shapes_.size();
+  shapes_.insert(shapes_.end(), shapeDown.begin(), shapeDown.end());
+  morphing.fittedFractionUp_ = fittedFractionUp - component.fittedFraction_;
+  morphing.fittedFractionDown_ = component.fittedFraction_ - fittedFractionDown;
+  component.morphings_.push_back(morphing);
+  morphedShapes_.resize(shapes_.size());
+}
+
+void TauIdEffBinnedLikelihood::addGaussianConstraint(unsigned idxParameter, double value, double error)
+{
+  if ( idxParameter >= parameters_.size() )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Invalid parameter index = " << idxParameter << " !!\n";
+  if ( !(error > 0.) )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Invalid error = " << error << " given for constraint on parameter = " << parameters_[idxParameter].name_ << " !!\n";
+  constraintEntryType constraint;
+  constraint.idxParameter_ = idxParameter;
+  constraint.value_ = value;
+  constraint.error_ = error;
+  constraints_.push_back(constraint);
+}
+
+void TauIdEffBinnedLikelihood::setParameterValue(unsigned idxParameter, double value)
+{
+  parameterEntryType& parameter = parameters_.at(idxParameter);
+  parameter.value_ = ( parameter.min_ < parameter.max_ ) ? TMath::Min(TMath::Max(value, parameter.min_), parameter.max_) : value;
+}
+
+void TauIdEffBinnedLikelihood::setParameterConstant(unsigned idxParameter, bool isConstant)
+{
+  parameters_.at(idxParameter).isConstant_ = isConstant;
+}
+
+void TauIdEffBinnedLikelihood::setParameterError(unsigned idxParameter, double error)
+{
+  parameters_.at(idxParameter).error_ = error;
+}
+
+void TauIdEffBinnedLikelihood::setInitialCovariance(unsigned idxParameter1, unsigned idxParameter2, double covariance)
+{
+  size_t numParameters = parameters_.size();
+  if ( !(idxParameter1 < numParameters && idxParameter2 < numParameters) )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "Invalid parameter indices = " << idxParameter1 << "," << idxParameter2 << " !!\n";
+  if ( initialCovariance_.size() != (numParameters*numParameters) ) initialCovariance_.assign(numParameters*numParameters, 0.);
+  initialCovariance_[idxParameter1*numParameters + idxParameter2] = covariance;
+  initialCovariance_[idxParameter2*numParameters + idxParameter1] = covariance;
+}
+
+void TauIdEffBinnedLikelihood::setRunMinos(unsigned idxParameter, bool runMinos)
+{
+  parameters_.at(idxParameter).runMinos_ = runMinos;
+}
+
+const std::string& TauIdEffBinnedLikelihood::getParameterName(unsigned idxParameter) const
+{
+  return parameters_.at(idxParameter).name_;
+}
+
+double TauIdEffBinnedLikelihood::getValue(unsigned idxParameter) const
+{
+  return parameters_.at(idxParameter).value_;
+}
+
+double TauIdEffBinnedLikelihood::getError(unsigned idxParameter) const
+{
+  return parameters_.at(idxParameter).error_;
+}
+
+double TauIdEffBinnedLikelihood::getErrorLow(unsigned idxParameter) const
+{
+  const parameterEntryType& parameter = parameters_.at(idxParameter);
+  return ( parameter.hasMinosErrors_ ) ? parameter.errorLow_ : -parameter.error_;
+}
+
+double TauIdEffBinnedLikelihood::getErrorHigh(unsigned idxParameter) const
+{
+  const parameterEntryType& parameter = parameters_.at(idxParameter);
+  return ( parameter.hasMinosErrors_ ) ? parameter.errorHigh_ : +parameter.error_;
+}
+
+double TauIdEffBinnedLikelihood::getCovariance(unsigned idxParameter1, unsigned idxParameter2) const
+{
+  return covariance_.at(idxParameter1*parameters_.size() + idxParameter2);
+}
+
+bool TauIdEffBinnedLikelihood::isConstant(unsigned idxParameter) const
+{
+  return parameters_.at(idxParameter).isConstant_;
+}
+
+namespace
+{
+  double getYieldFactor(double p, bool isInverted)
+  {
+    return ( isInverted ) ? (1. - p) : p;
+  }
+}
+
+double TauIdEffBinnedLikelihood::evaluate(const double* x, double* grad) const
+{
+  size_t numParameters = parameters_.size();
+  if ( grad ) {
+    for ( size_t idxParameter = 0; idxParameter < numParameters; ++idxParameter ) {
+      grad[idxParameter] = 0.;
+    }
+  }
+
+//--- compute morphed template shapes and expected event yields of all components
+  size_t numComponents = components_.size();
+  for ( size_t idxComponent = 0; idxComponent < numComponents; ++idxComponent ) {
+    const componentEntryType& component = components_[idxComponent];
+    unsigned numBins = channels_[component.idxChannel_].numBins_;
+    const double* shape = &shapes_[component.firstBin_];
+    double* morphedShape = &morphedShapes_[component.firstBin_];
+    for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+      morphedShape[iBin] = shape[iBin];
+    }
+    double fittedFraction = component.fittedFraction_;
+    for ( std::vector<morphingEntryType>::const_iterator morphing = component.morphings_.begin();
+	  morphing != component.morphings_.end(); ++morphing ) {
+      double alpha = x[morphing->idxParameter_];
+      if ( alpha == 0. ) continue;
+      const double* shapeShift = ( alpha > 0. ) ? &shapes_[morphing->firstBinUp_] : &shapes_[morphing->firstBinDown_];
+      for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+	morphedShape[iBin] += alpha*shapeShift[iBin];
+      }
+      fittedFraction += alpha*(( alpha > 0. ) ? morphing->fittedFractionUp_ : morphing->fittedFractionDown_);
+    }
+    double shapeNorm = 1.;
+    if ( !component.morphings_.empty() ) {
+      shapeNorm = 0.;
+      for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+	if ( morphedShape[iBin] < 0. ) morphedShape[iBin] = 0.;
+	shapeNorm += morphedShape[iBin];
+      }
+      if ( shapeNorm > 0. ) {
+	for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+	  morphedShape[iBin] /= shapeNorm;
+	}
+      }
+    }
+    shapeNorms_[idxComponent] = shapeNorm;
+    double yield = component.coefficient_*fittedFraction;
+    for ( std::vector<yieldFactorEntryType>::const_iterator yieldFactor = component.yieldFactors_.begin();
+	  yieldFactor != component.yieldFactors_.end(); ++yieldFactor ) {
+      yield *= getYieldFactor(x[yieldFactor->idxParameter_], yieldFactor->isInverted_);
+    }
+    yields_[idxComponent] = yield;
+  }
+
+//--- compute extended likelihood for each channel;
+//    the ratio of observed to expected event yield in each bin is kept for the computation of derivatives
+  double nll = 0.;
+  for ( std::vector<channelEntryType>::const_iterator channel = channels_.begin();
+	channel != channels_.end(); ++channel ) {
+    unsigned numBins = channel->numBins_;
+    const double* data = &data_[channel->firstBin_];
+    double* weights = &weights_[channel->firstBin_];
+    for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+      weights[iBin] = 0.;
+    }
+    for ( std::vector<unsigned>::const_iterator idxComponent = channel->components_.begin();
+	  idxComponent != channel->components_.end(); ++idxComponent ) {
+      double yield = yields_[*idxComponent];
+      nll += yield;
+      const double* morphedShape = &morphedShapes_[components_[*idxComponent].firstBin_];
+      for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+	weights[iBin] += yield*morphedShape[iBin];
+      }
+    }
+    for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+      double expected = weights[iBin];
+      if ( data[iBin] != 0. ) {
+	if ( expected > minExpected ) {
+	  nll -= data[iBin]*TMath::Log(expected);
+	  weights[iBin] = data[iBin]/expected;
+	} else {
+	  nll -= data[iBin]*TMath::Log(minExpected);
+	  weights[iBin] = 0.;
+	}
+      } else {
+	weights[iBin] = 0.;
+      }
+    }
+  }
+
+//--- compute derivatives with respect to yield factors and morphing parameters:
+//
+//      d(NLL)/dp = sum_{k} [ dY_k/dp * (1 - sum_{i} w_i * s_k,i) - Y_k * sum_{i} w_i * ds_k,i/dp ]
+//
+//    with w_i = n_i/(sum_{k} Y_k * s_k,i)
+//
+  if ( grad ) {
+    for ( size_t idxComponent = 0; idxComponent < numComponents; ++idxComponent ) {
+      const componentEntryType& component = components_[idxComponent];
+      unsigned numBins = channels_[component.idxChannel_].numBins_;
+      const double* weights = &weights_[channels_[component.idxChannel_].firstBin_];
+      const double* morphedShape = &morphedShapes_[component.firstBin_];
+      double dNLLdYield = 1.;
+      for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+	dNLLdYield -= weights[iBin]*morphedShape[iBin];
+      }
+
+      double fittedFraction = component.fittedFraction_;
+      for ( std::vector<morphingEntryType>::const_iterator morphing = component.morphings_.begin();
+	    morphing != component.morphings_.end(); ++morphing ) {
+	double alpha = x[morphing->idxParameter_];
+	fittedFraction += alpha*(( alpha > 0. ) ? morphing->fittedFractionUp_ : morphing->fittedFractionDown_);
+      }
+
+      size_t numYieldFactors = component.yieldFactors_.size();
+      double prodYieldFactors = 1.;
+      for ( size_t idxYieldFactor = 0; idxYieldFactor < numYieldFactors; ++idxYieldFactor ) {
+	const yieldFactorEntryType& yieldFactor = component.yieldFactors_[idxYieldFactor];
+	prodYieldFactors *= getYieldFactor(x[yieldFactor.idxParameter_], yieldFactor.isInverted_);
+
+//--- compute product of all other yield factors,
+//    in order to avoid division by zero in case yield factor is zero
+	double dYield = component.coefficient_*fittedFraction;
+	for ( size_t idxOtherYieldFactor = 0; idxOtherYieldFactor < numYieldFactors; ++idxOtherYieldFactor ) {
+	  if ( idxOtherYieldFactor == idxYieldFactor ) continue;
+	  const yieldFactorEntryType& otherYieldFactor = component.yieldFactors_[idxOtherYieldFactor];
+	  dYield *= getYieldFactor(x[otherYieldFactor.idxParameter_], otherYieldFactor.isInverted_);
+	}
+	if ( yieldFactor.isInverted_ ) dYield = -dYield;
+	grad[yieldFactor.idxParameter_] += dNLLdYield*dYield;
+      }
+
+      double yield = yields_[idxComponent];
+      for ( std::vector<morphingEntryType>::const_iterator morphing = component.morphings_.begin();
+	    morphing != component.morphings_.end(); ++morphing ) {
+	double alpha = x[morphing->idxParameter_];
+	double dFittedFraction = ( alpha > 0. ) ? morphing->fittedFractionUp_ : morphing->fittedFractionDown_;
+	const double* shapeShift = ( alpha > 0. ) ? &shapes_[morphing->firstBinUp_] : &shapes_[morphing->firstBinDown_];
+	double sumShapeShift = 0.;
+	double sumWeightedShapeShift = 0.;
+	for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+	  if ( morphedShape[iBin] > 0. ) {
+	    sumShapeShift += shapeShift[iBin];
+	    sumWeightedShapeShift += weights[iBin]*shapeShift[iBin];
+	  }
+	}
+//--- derivative of normalized template shape: ds_i/dalpha = (shift_i - s_i * sum_{j} shift_j)/norm
+	double shapeNorm = shapeNorms_[idxComponent];
+	double sumWeightedShapeDerivative = ( shapeNorm > 0. ) ?
+	  (sumWeightedShapeShift - (1. - dNLLdYield)*sumShapeShift)/shapeNorm : 0.;
+	grad[morphing->idxParameter_] += dNLLdYield*component.coefficient_*dFittedFraction*prodYieldFactors - yield*sumWeightedShapeDerivative;
+      }
+    }
+  }
+
+//--- add Gaussian constraints
+  for ( std::vector<constraintEntryType>::const_iterator constraint = constraints_.begin();
+	constraint != constraints_.end(); ++constraint ) {
+    double pull = (x[constraint->idxParameter_] - constraint->value_)/constraint->error_;
+    nll += 0.5*pull*pull;
+    if ( grad ) grad[constraint->idxParameter_] += pull/constraint->error_;
+  }
+
+  return nll;
+}
+
+double TauIdEffBinnedLikelihood::DoEval(const double* x) const
+{
+  return evaluate(x, 0);
+}
+
+double TauIdEffBinnedLikelihood::DoDerivative(const double* x, unsigned int idxParameter) const
+{
+  std::vector<double> grad(parameters_.size());
+  evaluate(x, &grad[0]);
+  return grad[idxParameter];
+}
+
+void TauIdEffBinnedLikelihood::Gradient(const double* x, double* grad) const
+{
+  evaluate(x, grad);
+}
+
+void TauIdEffBinnedLikelihood::FdF(const double* x, double& f, double* grad) const
+{
+  f = evaluate(x, grad);
+}
+
+bool TauIdEffBinnedLikelihood::fit()
+{
+  size_t numParameters = parameters_.size();
+  if ( numParameters == 0 || channels_.empty() )
+    throw cms::Exception("TauIdEffBinnedLikelihood")
+      << "No parameters or channels defined !!\n";
+
+  ROOT::Minuit2::MnPrint::SetLevel(printLevel_);
+
+  ROOT::Minuit2::MnUserParameters userParameters;
+  std::vector<unsigned> idxFloatingParameters;
+  for ( size_t idxParameter = 0; idxParameter < numParameters; ++idxParameter ) {
+    const parameterEntryType& parameter = parameters_[idxParameter];
+//--- choose initial step-size in the same way as RooMinuit
+    double step = parameter.error_;
+    bool hasLimits = ( parameter.min_ < parameter.max_ );
+    if ( !(step > 0.) ) {
+      if ( hasLimits ) {
+	step = 0.1*(parameter.max_ - parameter.min_);
+	if      ( (parameter.max_ - parameter.value_) < (2.*step) ) step = 0.5*(parameter.max_ - parameter.value_);
+	else if ( (parameter.value_ - parameter.min_) < (2.*step) ) step = 0.5*(parameter.value_ - parameter.min_);
+	if ( step == 0. ) step = 0.1*(parameter.max_ - parameter.min_);
+      } else {
+	step = 1.;
+      }
+    }
+    if ( hasLimits ) userParameters.Add(parameter.name_.data(), parameter.value_, step, parameter.min_, parameter.max_);
+    else userParameters.Add(parameter.name_.data(), parameter.value_, step);
+    if ( parameter.isConstant_ ) userParameters.Fix(idxParameter);
+    else idxFloatingParameters.push_back(idxParameter);
+  }
+
+//--- use covariance matrix given by user (e.g. obtained by previous fit) as initial error matrix,
+//    provided it is defined for all floating parameters
+  bool useInitialCovariance = ( initialCovariance_.size() == (numParameters*numParameters) );
+  for ( std::vector<unsigned>::const_iterator idxParameter = idxFloatingParameters.begin();
+	idxParameter != idxFloatingParameters.end() && useInitialCovariance; ++idxParameter ) {
+    if ( !(initialCovariance_[(*idxParameter)*numParameters + (*idxParameter)] > 0.) ) useInitialCovariance = false;
+  }
+  ROOT::Minuit2::MnUserParameterState userState(userParameters);
+  if ( useInitialCovariance && idxFloatingParameters.size() > 0 ) {
+    unsigned numFloatingParameters = idxFloatingParameters.size();
+    ROOT::Minuit2::MnUserCovariance userCovariance(numFloatingParameters);
+    for ( unsigned iParameter = 0; iParameter < numFloatingParameters; ++iParameter ) {
+      for ( unsigned jParameter = 0; jParameter <= iParameter; ++jParameter ) {
+	userCovariance(iParameter, jParameter) = 
+	  initialCovariance_[idxFloatingParameters[iParameter]*numParameters + idxFloatingParameters[jParameter]];
+      }
+    }
+    userState = ROOT::Minuit2::MnUserParameterState(userParameters, userCovariance);
+  }
+
+  ROOT::Minuit2::FCNGradAdapter<ROOT::Math::IMultiGradFunction> fcn(*this, errorLevel_);
+  ROOT::Minuit2::MnStrategy strategy(strategy_);
+  unsigned maxFunctionCalls = 500*numParameters;
+
+  ROOT::Minuit2::MnMigrad migrad(fcn, userState, strategy);
+  ROOT::Minuit2::FunctionMinimum minimum = migrad(maxFunctionCalls, tolerance_);
+  bool isMinimized = minimum.IsValid();
+
+  bool isHesse = true;
+  if ( runHesse_ ) {
+    ROOT::Minuit2::MnHesse hesse(strategy);
+    hesse(fcn, minimum, maxFunctionCalls);
+    isHesse = ( !minimum.HesseFailed() && minimum.UserState().HasCovariance() );
+  }
+
+  const ROOT::Minuit2::MnUserParameterState& fittedState = minimum.UserState();
+  for ( size_t idxParameter = 0; idxParameter < numParameters; ++idxParameter ) {
+    parameterEntryType& parameter = parameters_[idxParameter];
+    parameter.value_ = fittedState.Value(idxParameter);
+    if ( !parameter.isConstant_ ) parameter.error_ = fittedState.Error(idxParameter);
+    for ( size_t idxParameter2 = 0; idxParameter2 < numParameters; ++idxParameter2 ) {
+      double covariance = 0.;
+      if ( !(parameter.isConstant_ || parameters_[idxParameter2].isConstant_) && fittedState.HasCovariance() )
+	covariance = fittedState.Covariance()(fittedState.IntOfExt(idxParameter), fittedState.IntOfExt(idxParameter2));
+      covariance_[idxParameter*numParameters + idxParameter2] = covariance;
+    }
+  }
+  minimum_ = minimum.Fval();
+  numFunctionCalls_ = minimum.NFcn();
+
+//--- set status code in the same way as ROOT::Minuit2::Minuit2Minimizer
+  status_ = 0;
+  if ( !isMinimized ) {
+    status_ = 5;
+    if ( minimum.HasMadePosDefCovar()  ) status_ = 1;
+    if ( minimum.HesseFailed()         ) status_ = 2;
+    if ( minimum.IsAboveMaxEdm()       ) status_ = 3;
+    if ( minimum.HasReachedCallLimit() ) status_ = 4;
+  }
+  if ( !(isMinimized && isHesse) && status_ == 0 ) status_ = -1;
+
+//--- run MINOS for selected parameters
+//   (only in case MIGRAD converged, as MINOS errors are meaningless otherwise)
+  ROOT::Minuit2::MnMinos minos(fcn, minimum, strategy);
+  for ( size_t idxParameter = 0; idxParameter < numParameters; ++idxParameter ) {
+    parameterEntryType& parameter = parameters_[idxParameter];
+    parameter.hasMinosErrors_ = false;
+    if ( !(parameter.runMinos_ && !parameter.isConstant_ && isMinimized) ) continue;
+    ROOT::Minuit2::MinosError minosError = minos.Minos(idxParameter, maxFunctionCalls);
+    if ( minosError.IsValid() ) {
+      parameter.errorLow_ = minosError.Lower();
+      parameter.errorHigh_ = minosError.Upper();
+      parameter.hasMinosErrors_ = true;
+    } else {
+      std::cerr << "Warning in <TauIdEffBinnedLikelihood::fit>: MINOS failed for parameter = " << parameter.name_ << " !!" << std::endl;
+    }
+  }
+  if ( printLevel_ >= 0 ) {
+    std::cout << "<TauIdEffBinnedLikelihood::fit>: status = " << status_ << ", min(NLL) = " << minimum_ 
+	      << " (" << numFunctionCalls_ << " function calls)" << std::endl;
+  }
+
+  return ( status_ == 0 );
+}
+
+std::vector<double> TauIdEffBinnedLikelihood::getTemplateShape(unsigned idxComponent) const
+{
+  const componentEntryType& component = components_.at(idxComponent);
+  unsigned numBins = channels_[component.idxChannel_].numBins_;
+
+  std::vector<double> x(parameters_.size());
+  for ( size_t idxParameter = 0; idxParameter < parameters_.size(); ++idxParameter ) {
+    x[idxParameter] = parameters_[idxParameter].value_;
+  }
+  evaluate(&x[0], 0);
+
+  std::vector<double> retVal(morphedShapes_.begin() + component.firstBin_, morphedShapes_.begin() + component.firstBin_ + numBins);
+  return retVal;
+}
@@ -0,0 +1,242 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffCheckpoint.h"
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TFile.h>
+#include <TList.h>
+#include <TMath.h>
+#include <TObjString.h>
+#include <TSystem.h>
+#include <TString.h>
+
+#include <iostream>
+
+#include <unistd.h>
+
+const std::string checkpointCounterHistogramName = "checkpointCounters";
+const std::string checkpointPositionHistogramName = "checkpointPosition";
+
+namespace
+{
+  TDirectory* getSubdirectory(TDirectory* dir, const std::string& path)
+  {
+    TDirectory* subdir = dir;
+    size_t pos = 0;
+    while ( pos < path.length() ) {
+      size_t idx = path.find("/", pos);
+      if ( idx == std::string::npos ) idx = path.length();
+      std::string subdirName = std::string(path, pos, idx - pos);
+      if ( subdirName != "" ) {
+	TDirectory* subdir_next = dynamic_cast<TDirectory*>(subdir->Get(subdirName.data()));
+	if ( !subdir_next ) subdir_next = subdir->mkdir(subdirName.data());
+	subdir = subdir_next;
+      }
+      pos = idx + 1;
+    }
+    return subdir;
+  }
+}
+
+TauIdEffCheckpoint::TauIdEffCheckpoint(const std::string& fileName, const std::string& configDigest, TDirectory* outputDirectory, long interval)
+  : fileName_(fileName),
+    configDigest_(configDigest),
+    interval_(interval)
+{
+  if ( !outputDirectory )
+    throw cms::Exception("TauIdEffCheckpoint")
+      << "No output directory given !!\n";
+  collectHistograms(outputDirectory, "");
+}
+
+TauIdEffCheckpoint::~TauIdEffCheckpoint()
+{
+// nothing to be done yet...
+}
+
+void TauIdEffCheckpoint::collectHistograms(TDirectory* dir, const std::string& path)
+{
+  TIter next(dir->GetList());
+  while ( TObject* obj = next() ) {
+    if ( TH1* histogram = dynamic_cast<TH1*>(obj) ) {
+      histogramEntryType histogramEntry;
+      histogramEntry.path_ = path;
+      histogramEntry.name_ = histogram->GetName();
+      histogramEntry.histogram_ = histogram;
+      histograms_.push_back(histogramEntry);
+    } else if ( TauIdEffHistogramBundle* bundle = dynamic_cast<TauIdEffHistogramBundle*>(obj) ) {
+      for ( unsigned idx = 0; idx < bundle->getNumHistograms(); ++idx ) {
+	TH1* histogram = bundle->getRegisteredHistogram(idx);
+	if ( !histogram ) continue;
+	histogramEntryType histogramEntry;
+	histogramEntry.path_ = path;
+	histogramEntry.name_ = histogram->GetName();
+	histogramEntry.histogram_ = histogram;
+	histograms_.push_back(histogramEntry);
+      }
+    } else if ( TDirectory* subdir = dynamic_cast<TDirectory*>(obj) ) {
+      collectHistograms(subdir, std::string(path).append(subdir->GetName()).append("/"));
+    }
+  }
+}
+
+void TauIdEffCheckpoint::addCounter(const std::string& name, int* counter)
+{
+  counterEntryType counterEntry;
+  counterEntry.name_ = name;
+  counterEntry.intCounter_ = counter;
+  counterEntry.unsignedCounter_ = 0;
+  counterEntry.doubleCounter_ = 0;
+  counters_.push_back(counterEntry);
+}
+
+void TauIdEffCheckpoint::addCounter(const std::string& name, unsigned* counter)
+{
+  counterEntryType counterEntry;
+  counterEntry.name_ = name;
+  counterEntry.intCounter_ = 0;
+  counterEntry.unsignedCounter_ = counter;
+  counterEntry.doubleCounter_ = 0;
+  counters_.push_back(counterEntry);
+}
+
+void TauIdEffCheckpoint::addCounter(const std::string& name, double* counter)
+{
+  counterEntryType counterEntry;
+  counterEntry.name_ = name;
+  counterEntry.intCounter_ = 0;
+  counterEntry.unsignedCounter_ = 0;
+  counterEntry.doubleCounter_ = counter;
+  counters_.push_back(counterEntry);
+}
+
+double TauIdEffCheckpoint::getCounterValue(const counterEntryType& counterEntry) const
+{
+  if      ( counterEntry.intCounter_      ) return (*counterEntry.intCounter_);
+  else if ( counterEntry.unsignedCounter_ ) return (*counterEntry.unsignedCounter_);
+  else                                      return (*counterEntry.doubleCounter_);
+}
+
+void TauIdEffCheckpoint::setCounterValue(counterEntryType& counterEntry, double value)
+{
+  if      ( counterEntry.intCounter_      ) (*counterEntry.intCounter_)      = TMath::Nint(value);
+  else if ( counterEntry.unsignedCounter_ ) (*counterEntry.unsignedCounter_) = (unsigned)value; // CV: values are stored exactly
+  else                                      (*counterEntry.doubleCounter_)   = value;
+}
+
+bool TauIdEffCheckpoint::resume(unsigned& idxInputFile, long& numEvents)
+{
+  idxInputFile = 0;
+  numEvents = 0;
+
+  if ( gSystem->AccessPathName(fileName_.data()) ) return false; // CV: returns true in case path does **not** exist
+
+  TFile* checkpointFile = TFile::Open(fileName_.data());
+  if ( !checkpointFile || checkpointFile->IsZombie() ) {
+    std::cerr << "Warning: Failed to open checkpoint file = " << fileName_ << " --> ignoring checkpoint !!" << std::endl;
+    delete checkpointFile;
+    return false;
+  }
+
+  TObjString* configDigest = dynamic_cast<TObjString*>(checkpointFile->Get("configDigest"));
+  if ( !(configDigest && configDigest->GetString() == configDigest_.data()) ) {
+    std::cerr << "Warning: Checkpoint file = " << fileName_ << " has been written for different configuration"
+	      << " --> ignoring checkpoint !!" << std::endl;
+    delete checkpointFile;
+    return false;
+  }
+
+//--- retrieve all histograms and counters first,
+//    in order to leave histograms and counters unchanged in case checkpoint file is incomplete
+  std::vector<TH1*> savedHistograms;
+  for ( std::vector<histogramEntryType>::const_iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    std::string histogramName = std::string(histogramEntry->path_).append(histogramEntry->name_);
+    TH1* savedHistogram = dynamic_cast<TH1*>(checkpointFile->Get(histogramName.data()));
+    if ( !savedHistogram ) {
+      std::cerr << "Warning: Failed to find histogram = " << histogramName << " in checkpoint file = " << fileName_
+		<< " --> ignoring checkpoint !!" << std::endl;
+      delete checkpointFile;
+      return false;
+    }
+    savedHistograms.push_back(savedHistogram);
+  }
+
+  TH1* savedCounters = dynamic_cast<TH1*>(checkpointFile->Get(checkpointCounterHistogramName.data()));
+  bool isValidCounters = ( savedCounters && savedCounters->GetNbinsX() == TMath::Max(1, (int)counters_.size()) );
+  for ( size_t idxCounter = 0; idxCounter < counters_.size() && isValidCounters; ++idxCounter ) {
+    if ( counters_[idxCounter].name_ != savedCounters->GetXaxis()->GetBinLabel(idxCounter + 1) ) isValidCounters = false;
+  }
+  TH1* savedPosition = dynamic_cast<TH1*>(checkpointFile->Get(checkpointPositionHistogramName.data()));
+  if ( !(isValidCounters && savedPosition) ) {
+    std::cerr << "Warning: Event counters stored in checkpoint file = " << fileName_ << " do not match"
+	      << " --> ignoring checkpoint !!" << std::endl;
+    delete checkpointFile;
+    return false;
+  }
+
+  for ( size_t idxHistogram = 0; idxHistogram < histograms_.size(); ++idxHistogram ) {
+    TH1* histogram = histograms_[idxHistogram].histogram_;
+    histogram->Reset();
+    histogram->Add(savedHistograms[idxHistogram]);
+  }
+  for ( size_t idxCounter = 0; idxCounter < counters_.size(); ++idxCounter ) {
+    setCounterValue(counters_[idxCounter], savedCounters->GetBinContent(idxCounter + 1));
+  }
+  idxInputFile = TMath::Nint(savedPosition->GetBinContent(1));
+  numEvents = TMath::Nint(savedPosition->GetBinContent(2));
+
+  delete checkpointFile;
+
+  return true;
+}
+
+void TauIdEffCheckpoint::write(unsigned idxInputFile, long numEvents)
+{
+//--- write checkpoint file under temporary name first and rename it when complete,
+//    so that previous checkpoint stays valid in case job gets killed while checkpoint is written
+  std::string fileName_tmp = std::string(fileName_).append(Form(".tmp%i", (int)getpid()));
+
+  TDirectory* currentDirectory = gDirectory;
+
+  TFile* checkpointFile = TFile::Open(fileName_tmp.data(), "RECREATE");
+  if ( !checkpointFile || checkpointFile->IsZombie() )
+    throw cms::Exception("TauIdEffCheckpoint")
+      << "Failed to create checkpoint file = " << fileName_tmp << " !!\n";
+
+  for ( std::vector<histogramEntryType>::const_iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    TDirectory* dir = getSubdirectory(checkpointFile, histogramEntry->path_);
+    dir->WriteTObject(histogramEntry->histogram_, histogramEntry->name_.data());
+  }
+
+  checkpointFile->cd();
+  int numCounters = counters_.size();
+  TH1* savedCounters = new TH1D(checkpointCounterHistogramName.data(), checkpointCounterHistogramName.data(),
+				TMath::Max(1, numCounters), -0.5, TMath::Max(1, numCounters) - 0.5);
+  for ( int idxCounter = 0; idxCounter < numCounters; ++idxCounter ) {
+    savedCounters->GetXaxis()->SetBinLabel(idxCounter + 1, counters_[idxCounter].name_.data());
+    savedCounters->SetBinContent(idxCounter + 1, getCounterValue(counters_[idxCounter]));
+  }
+  checkpointFile->WriteTObject(savedCounters);
+  TH1* savedPosition = new TH1D(checkpointPositionHistogramName.data(), checkpointPositionHistogramName.data(), 2, -0.5, 1.5);
+  savedPosition->SetBinContent(1, idxInputFile);
+  savedPosition->SetBinContent(2, numEvents);
+  checkpointFile->WriteTObject(savedPosition);
+  TObjString configDigest_string(configDigest_.data());
+  checkpointFile->WriteTObject(&configDigest_string, "configDigest");
+
+  delete checkpointFile;
+
+  if ( currentDirectory ) currentDirectory->cd();
+
+  if ( gSystem->Rename(fileName_tmp.data(), fileName_.data()) != 0 )
+    throw cms::Exception("TauIdEffCheckpoint")
+      << "Failed to rename checkpoint file = " << fileName_tmp << " to " << fileName_ << " !!\n";
+}
+
+void TauIdEffCheckpoint::remove()
+{
+  if ( !gSystem->AccessPathName(fileName_.data()) ) gSystem->Unlink(fileName_.data());
+}
@@ -4,6 +4,12 @@
 
 #include "FWCore/Utilities/interface/Exception.h"
 
+#include "TauAnalysis/TauIdEfficiency/interface/tauIdEffAuxFunctions.h"
+
+#include <TMath.h>
+
+#include <algorithm>
+
 // define flag for Mt && Pzeta cut (not appplied, Mt && Pzeta cut passed, Mt || Pzeta cut failed) 
 // and tau id. discriminators      (no tau id. discriminators applied, all discriminators passed, at least one discriminator failed)
 enum { kNotApplied, kSignalLike, kBackgroundLike, kWplusJetBackgroundLike };
@@ -115,6 +121,8 @@ TauIdEffEventSelector::TauIdEffEventSelector(const edm::ParameterSet& cfg)
   if      ( region_full.find("_DEBUG1") != std::string::npos ) debugMode_ = kDEBUG1;
   else if ( region_full.find("_DEBUG2") != std::string::npos ) debugMode_ = kDEBUG2;
   else                                                         debugMode_ = kNoDEBUG;
+
+  singlePairInput_.addTauIdDiscriminators(tauIdDiscriminators_);
 }
 
 TauIdEffEventSelector::~TauIdEffEventSelector()
@@ -144,86 +152,296 @@ void printCutValue(const std::string& variable, double value, double min, double
   std::cout << std::endl;
 }
 
-bool TauIdEffEventSelector::operator()(const PATMuTauPair& muTauPair, const pat::MET& caloMEt, 
-				       size_t numJets_bTagged, pat::strbitset& result)
+void TauIdEffEventSelector::inputBatchType::addTauIdDiscriminators(const vstring& tauIdDiscriminators)
 {
-  //std::cout << "<TauIdEffEventSelector::operator()>:" << std::endl;
+  if ( size() > 0 ) throw cms::Exception("TauIdEffEventSelector::inputBatchType")
+    << "Tau id. discriminators must be added before first muon + tau-jet pair gets added to batch !!\n";
 
-  double muonPt              = muTauPair.leg1()->pt();
-  double muonEta             = muTauPair.leg1()->eta();
+  for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators.begin();
+	tauIdDiscriminator != tauIdDiscriminators.end(); ++tauIdDiscriminator ) {
+    if ( std::find(tauIdDiscriminatorNames_.begin(), tauIdDiscriminatorNames_.end(), *tauIdDiscriminator) == tauIdDiscriminatorNames_.end() ) {
+      tauIdDiscriminatorNames_.push_back(*tauIdDiscriminator);
+      tauIdDiscriminatorValues_.push_back(std::vector<double>());
+    }
+  }
+}
+
+void TauIdEffEventSelector::inputBatchType::push_back(const PATMuTauPair& muTauPair, const pat::MET& caloMEt, size_t numJets_bTagged, 
+						       double tauShiftFactor)
+{
+  muTauPairKinematicsType muTauPairKinematics;
+  compMuTauPairKinematics(muTauPair, tauShiftFactor, muTauPairKinematics);
+
+  numJets_bTagged_.push_back(numJets_bTagged);
+  muonPt_.push_back(muTauPair.leg1()->pt());
+  muonEta_.push_back(muTauPair.leg1()->eta());
   // compute deltaBeta corrected isolation Pt sum "by hand":
   //   muonIsoPtSum = pfChargedParticles(noPileUp) + pfNeutralHadrons + pfGammas - deltaBetaCorr, deltaBetaCorr = 0.5*pfChargedParticlesPileUp
   // ( User1Iso = pfAllChargedHadrons(noPileUp), User2Iso = pfAllChargedHadronsPileUp
   //   as defined in TauAnalysis/TauIdEfficiency/test/commissioning/produceMuonIsolationPATtuple_cfg.py )
-  double muonIso             = muTauPair.leg1()->userIsolation(pat::User1Iso) 
-  	                      + TMath::Max(0., muTauPair.leg1()->userIsolation(pat::PfNeutralHadronIso) 
-                                              + muTauPair.leg1()->userIsolation(pat::PfGammaIso) 
-                                              - 0.5*muTauPair.leg1()->userIsolation(pat::User2Iso));
-  double tauPt               = muTauPair.leg2()->pt();
-  double tauEta              = muTauPair.leg2()->eta();
-  double tauLeadTrackPt      = muTauPair.leg2()->userFloat("leadTrackPt");
-  double tauIso              = muTauPair.leg2()->userFloat("preselLoosePFIsoPt");
-  double tauCharge           = 0.;
-  if      ( tauChargeMode_ == kLeadTrackCharge        ) tauCharge = muTauPair.leg2()->userFloat("leadTrackCharge");
-  else if ( tauChargeMode_ == kSignalChargedHadronSum ) tauCharge = muTauPair.leg2()->charge();
+  muonIso_.push_back(muTauPair.leg1()->userIsolation(pat::User1Iso) 
+		   + TMath::Max(0., muTauPair.leg1()->userIsolation(pat::PfNeutralHadronIso) 
+			           + muTauPair.leg1()->userIsolation(pat::PfGammaIso) 
+			           - 0.5*muTauPair.leg1()->userIsolation(pat::User2Iso)));
+  muonCharge_.push_back(muTauPair.leg1()->charge());
+  tauPt_.push_back(muTauPairKinematics.tauPt_);
+  tauEta_.push_back(muTauPair.leg2()->eta());
+  tauLeadTrackPt_.push_back(muTauPair.leg2()->userFloat("leadTrackPt"));
+  tauIso_.push_back(muTauPair.leg2()->userFloat("preselLoosePFIsoPt"));
+  tauLeadTrackCharge_.push_back(muTauPair.leg2()->userFloat("leadTrackCharge"));
+  tauSignalChargedHadronSum_.push_back(muTauPair.leg2()->charge());
+  muTauPairAbsDz_.push_back(TMath::Abs(muTauPair.leg1()->vertex().z() - muTauPair.leg2()->vertex().z()));
+  visMass_.push_back(muTauPairKinematics.visMass_);
+  caloMEtPt_.push_back(caloMEt.pt());
+  pfMEtPt_.push_back(muTauPairKinematics.pfMEtPt_);
+  Mt_.push_back(muTauPairKinematics.Mt_);
+  PzetaDiff_.push_back(muTauPairKinematics.PzetaDiff_);
+
+  size_t numTauIdDiscriminators = tauIdDiscriminatorNames_.size();
+  for ( size_t iTauIdDiscriminator = 0; iTauIdDiscriminator < numTauIdDiscriminators; ++iTauIdDiscriminator ) {
+    tauIdDiscriminatorValues_[iTauIdDiscriminator].push_back(muTauPair.leg2()->tauID(tauIdDiscriminatorNames_[iTauIdDiscriminator]));
+  }
+}
+
+void TauIdEffEventSelector::inputBatchType::setEntryTauIdDiscriminators(const vstring& entryTauIdDiscriminators)
+{
+  if ( size() > 0 ) throw cms::Exception("TauIdEffEventSelector::inputBatchType")
+    << "Order of tau id. discriminators must be set before first muon + tau-jet pair gets added to batch !!\n";
+
+  entryTauIdDiscriminatorIndices_.clear();
+  for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminatorNames_.begin();
+	tauIdDiscriminator != tauIdDiscriminatorNames_.end(); ++tauIdDiscriminator ) {
+    vstring::const_iterator entryTauIdDiscriminator = 
+      std::find(entryTauIdDiscriminators.begin(), entryTauIdDiscriminators.end(), *tauIdDiscriminator);
+    if ( entryTauIdDiscriminator == entryTauIdDiscriminators.end() )
+      throw cms::Exception("TauIdEffEventSelector::inputBatchType")
+	<< "Values of tau id. discriminator = " << (*tauIdDiscriminator) << " not contained in mini-tuple entries !!\n";
+    entryTauIdDiscriminatorIndices_.push_back(entryTauIdDiscriminator - entryTauIdDiscriminators.begin());
+  }
+}
+
+void TauIdEffEventSelector::inputBatchType::push_back(const TauIdEffMiniTupleEntry& entry, double caloMEtPt)
+{
+  size_t numTauIdDiscriminators = tauIdDiscriminatorNames_.size();
+  if ( entryTauIdDiscriminatorIndices_.size() != numTauIdDiscriminators )
+    throw cms::Exception("TauIdEffEventSelector::inputBatchType")
+      << "Order of tau id. discriminators in mini-tuple entries not set !!\n";
+
+  numJets_bTagged_.push_back(entry.numJets_bTagged_);
+  muonPt_.push_back(entry.muonPt_);
+  muonEta_.push_back(entry.muonEta_);
+  muonIso_.push_back(entry.muonIso_);
+  muonCharge_.push_back(entry.muonCharge_);
+  tauPt_.push_back(entry.tauPt_);
+  tauEta_.push_back(entry.tauEta_);
+  tauLeadTrackPt_.push_back(entry.tauLeadTrackPt_);
+  tauIso_.push_back(entry.tauIso_);
+  tauLeadTrackCharge_.push_back(entry.tauLeadTrackCharge_);
+  tauSignalChargedHadronSum_.push_back(entry.tauCharge_);
+  muTauPairAbsDz_.push_back(entry.muTauPairAbsDz_);
+  visMass_.push_back(entry.visMass_);
+  caloMEtPt_.push_back(caloMEtPt);
+  pfMEtPt_.push_back(entry.pfMEtPt_);
+  Mt_.push_back(entry.Mt_);
+  PzetaDiff_.push_back(entry.PzetaDiff_);
+
+  for ( size_t iTauIdDiscriminator = 0; iTauIdDiscriminator < numTauIdDiscriminators; ++iTauIdDiscriminator ) {
+    tauIdDiscriminatorValues_[iTauIdDiscriminator].push_back(entry.tauIdDiscriminatorValues_[entryTauIdDiscriminatorIndices_[iTauIdDiscriminator]]);
+  }
+}
+
+void TauIdEffEventSelector::inputBatchType::clear()
+{
+  numJets_bTagged_.clear();
+  muonPt_.clear();
+  muonEta_.clear();
+  muonIso_.clear();
+  muonCharge_.clear();
+  tauPt_.clear();
+  tauEta_.clear();
+  tauLeadTrackPt_.clear();
+  tauIso_.clear();
+  tauLeadTrackCharge_.clear();
+  tauSignalChargedHadronSum_.clear();
+  muTauPairAbsDz_.clear();
+  visMass_.clear();
+  caloMEtPt_.clear();
+  pfMEtPt_.clear();
+  Mt_.clear();
+  PzetaDiff_.clear();
+  for ( std::vector<std::vector<double> >::iterator tauIdDiscriminatorValues = tauIdDiscriminatorValues_.begin();
+	tauIdDiscriminatorValues != tauIdDiscriminatorValues_.end(); ++tauIdDiscriminatorValues ) {
+    tauIdDiscriminatorValues->clear();
+  }
+}
+
+//-------------------------------------------------------------------------------
+//
+// auxiliary functions for evaluating cuts on arrays of input quantities
+// (loops are kept free of branches, so that the compiler can auto-vectorize them)
+//
+void applyCutBatch(const std::vector<double>& values, double min, double max, std::vector<unsigned char>& flags)
+{
+  size_t numEntries = flags.size();
+  if ( numEntries == 0 ) return;
+  const double* x = &values[0];
+  unsigned char* flag = &flags[0];
+  for ( size_t idx = 0; idx < numEntries; ++idx ) {
+    flag[idx] &= ((x[idx] > min) & (x[idx] < max));
+  }
+}
+
+void applyLowerCutBatch(const std::vector<double>& values, double min, std::vector<unsigned char>& flags)
+{
+  size_t numEntries = flags.size();
+  if ( numEntries == 0 ) return;
+  const double* x = &values[0];
+  unsigned char* flag = &flags[0];
+  for ( size_t idx = 0; idx < numEntries; ++idx ) {
+    flag[idx] &= (x[idx] > min);
+  }
+}
+
+void applyUpperCutBatch(const std::vector<double>& values, double max, std::vector<unsigned char>& flags)
+{
+  size_t numEntries = flags.size();
+  if ( numEntries == 0 ) return;
+  const double* x = &values[0];
+  unsigned char* flag = &flags[0];
+  for ( size_t idx = 0; idx < numEntries; ++idx ) {
+    flag[idx] &= (x[idx] < max);
+  }
+}
+
+void applyRelativeCutBatch(const std::vector<double>& values, const std::vector<double>& norms, double min, double max, 
+			   std::vector<unsigned char>& flags)
+{
+  size_t numEntries = flags.size();
+  if ( numEntries == 0 ) return;
+  const double* x = &values[0];
+  const double* norm = &norms[0];
+  unsigned char* flag = &flags[0];
+  for ( size_t idx = 0; idx < numEntries; ++idx ) {
+    flag[idx] &= ((x[idx] > (min*norm[idx])) & (x[idx] < (max*norm[idx])));
+  }
+}
+
+// flag = flag && (other || flag_or)
+void combineFlagsBatch(const std::vector<unsigned char>& otherFlags, bool invert, bool flag_or, std::vector<unsigned char>& flags)
+{
+  size_t numEntries = flags.size();
+  if ( numEntries == 0 ) return;
+  const unsigned char* other = &otherFlags[0];
+  unsigned char* flag = &flags[0];
+  unsigned char mask_invert = ( invert  ) ? 1 : 0;
+  unsigned char mask_or     = ( flag_or ) ? 1 : 0;
+  for ( size_t idx = 0; idx < numEntries; ++idx ) {
+    flag[idx] &= ((other[idx] ^ mask_invert) | mask_or);
+  }
+}
+//-------------------------------------------------------------------------------
+
+bool TauIdEffEventSelector::operator()(const PATMuTauPair& muTauPair, const pat::MET& caloMEt, 
+				       size_t numJets_bTagged, pat::strbitset& result, double tauShiftFactor)
+{
+  //std::cout << "<TauIdEffEventSelector::operator()>:" << std::endl;
+
+  singlePairInput_.clear();
+  singlePairInput_.push_back(muTauPair, caloMEt, numJets_bTagged, tauShiftFactor);
+  (*this)(singlePairInput_, singlePairFlag_);
+
+  return singlePairFlag_[0];
+}
+
+bool TauIdEffEventSelector::operator()(const TauIdEffMiniTupleEntry& entry, double caloMEtPt, pat::strbitset& result)
+{
+  singlePairInput_.clear();
+  singlePairInput_.push_back(entry, caloMEtPt);
+  (*this)(singlePairInput_, singlePairFlag_);
+
+  return singlePairFlag_[0];
+}
+
+void TauIdEffEventSelector::operator()(const inputBatchType& input, std::vector<unsigned char>& flags)
+{
+  //std::cout << "<TauIdEffEventSelector::operator()>:" << std::endl;
+
+  size_t numMuTauPairs = input.size();
+  flags.assign(numMuTauPairs, 1);
+  if ( numMuTauPairs == 0 ) return;
+
+  const std::vector<double>* tauCharge = 0;
+  if      ( tauChargeMode_ == kLeadTrackCharge        ) tauCharge = &input.tauLeadTrackCharge_;
+  else if ( tauChargeMode_ == kSignalChargedHadronSum ) tauCharge = &input.tauSignalChargedHadronSum_;
   else assert(0);
-  double muTauPairAbsDz      = TMath::Abs(muTauPair.leg1()->vertex().z() - muTauPair.leg2()->vertex().z());
-  double muTauPairChargeProd = muTauPair.leg1()->charge()*tauCharge;
-  double visMass             = (muTauPair.leg1()->p4() + muTauPair.leg2()->p4()).mass();
-  double caloMEtPt           = caloMEt.pt();
-  double pfMEtPt             = muTauPair.met()->pt();
-  double Mt                  = muTauPair.mt1MET();
-  double PzetaDiff           = muTauPair.pZeta() - 1.5*muTauPair.pZetaVis();
-
-  //printCutValue("tauLeadTrackPt", tauLeadTrackPt, tauLeadTrackPtMin_, +1.e+3);
-  //printCutValue("tauIso", tauIso, tauAbsIsoMin_, tauAbsIsoMax_); 
-  //printCutValue("muTauPairAbsDz", muTauPairAbsDz, -1.e+3, muTauPairAbsDzMax_);
-  //printCutValue("muTauPairChargeProd", muTauPairChargeProd, muTauPairChargeProdMin_, muTauPairChargeProdMax_);
-  //printCutValue("Mt", Mt, TMath::Min(MtMin_, MtCutoffMin_), TMath::Max(MtMax_, MtCutoffMax_));
-  //printCutValue("PzetaDiff", PzetaDiff, PzetaDiffMin_, PzetaDiffMax_);
-
-  //std::cout << "MtAndPzetaDiffCut = " << getCutStatus_string(MtAndPzetaDiffCut_) << std::endl;
-  //std::cout << "tauIdDiscriminatorCut = " << getCutStatus_string(tauIdDiscriminatorCut_) << std::endl;
-
-  if ( numJets_bTagged     >= numJets_bTaggedMin_     && numJets_bTagged         <= numJets_bTaggedMax_     &&
-       muonPt              >  muonPtMin_              && muonPt                  <  muonPtMax_              &&
-       muonEta             >  muonEtaMin_             && muonEta                 <  muonEtaMax_             &&
-       muonIso             > (muonRelIsoMin_*muonPt)  && muonIso                 < (muonRelIsoMax_*muonPt)  && 
-       tauPt               >  tauPtMin_               && tauPt                   <  tauPtMax_               &&
-       tauEta              >  tauEtaMin_              && tauEta                  <  tauEtaMax_              &&
-       tauCharge           >  tauChargeMin_           && tauCharge               <  tauChargeMax_           &&
-       ((tauLeadTrackPt    >  tauLeadTrackPtMin_      &&
-         tauIso            >  tauAbsIsoMin_           && tauIso                  <  tauAbsIsoMax_           ) ||
-        disableTauCandPreselCuts_                                                                           ) &&
-       muTauPairAbsDz      <  muTauPairAbsDzMax_      &&
-       muTauPairChargeProd >  muTauPairChargeProdMin_ && muTauPairChargeProd     <  muTauPairChargeProdMax_ && 
-       visMass             >  visMassCutoffMin_       && visMass                 <  visMassCutoffMax_       &&
-       caloMEtPt           >  caloMEtPtMin_           && caloMEtPt               <  caloMEtPtMax_           &&
-       pfMEtPt             >  pfMEtPtMin_             && pfMEtPt                 <  pfMEtPtMax_             &&
-       Mt                  >  MtCutoffMin_            && Mt                      <  MtCutoffMax_            ) {
-    bool MtAndPzetaDiffCut_passed = (Mt > MtMin_ && Mt < MtMax_ && PzetaDiff > PzetaDiffMin_ && PzetaDiff < PzetaDiffMax_);
-    //bool MtAndPzetaDiffCut_passed = (Mt > MtMin_ && Mt < MtMax_);
-
-    bool tauIdDiscriminators_passed = true;
-    for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators_.begin();
-	  tauIdDiscriminator != tauIdDiscriminators_.end(); ++tauIdDiscriminator ) {
-      double tauIdDiscriminator_value = muTauPair.leg2()->tauID(*tauIdDiscriminator);
-      //std::cout << " " << (*tauIdDiscriminator) << ": " << tauIdDiscriminator_value << std::endl;
-      if ( !(tauIdDiscriminator_value > tauIdDiscriminatorMin_  && 
-	     tauIdDiscriminator_value < tauIdDiscriminatorMax_) ) tauIdDiscriminators_passed = false;
+
+  muTauPairChargeProd_.resize(numMuTauPairs);
+  for ( size_t idx = 0; idx < numMuTauPairs; ++idx ) {
+    muTauPairChargeProd_[idx] = input.muonCharge_[idx]*(*tauCharge)[idx];
+  }
+
+  // CV: number of b-tagged jets is stored as double;
+  //     shift boundaries by 0.5 to obtain equivalent of integer comparisons '>=' and '<='
+  applyCutBatch(input.numJets_bTagged_, (double)numJets_bTaggedMin_ - 0.5, (double)numJets_bTaggedMax_ + 0.5, flags);
+  applyCutBatch(input.muonPt_, muonPtMin_, muonPtMax_, flags);
+  applyCutBatch(input.muonEta_, muonEtaMin_, muonEtaMax_, flags);
+  applyRelativeCutBatch(input.muonIso_, input.muonPt_, muonRelIsoMin_, muonRelIsoMax_, flags);
+  applyCutBatch(input.tauPt_, tauPtMin_, tauPtMax_, flags);
+  applyCutBatch(input.tauEta_, tauEtaMin_, tauEtaMax_, flags);
+  applyCutBatch(*tauCharge, tauChargeMin_, tauChargeMax_, flags);
+
+  tauCandPreselFlags_.assign(numMuTauPairs, 1);
+  applyLowerCutBatch(input.tauLeadTrackPt_, tauLeadTrackPtMin_, tauCandPreselFlags_);
+  applyCutBatch(input.tauIso_, tauAbsIsoMin_, tauAbsIsoMax_, tauCandPreselFlags_);
+  combineFlagsBatch(tauCandPreselFlags_, false, disableTauCandPreselCuts_, flags);
+
+  applyUpperCutBatch(input.muTauPairAbsDz_, muTauPairAbsDzMax_, flags);
+  applyCutBatch(muTauPairChargeProd_, muTauPairChargeProdMin_, muTauPairChargeProdMax_, flags);
+  applyCutBatch(input.visMass_, visMassCutoffMin_, visMassCutoffMax_, flags);
+  applyCutBatch(input.caloMEtPt_, caloMEtPtMin_, caloMEtPtMax_, flags);
+  applyCutBatch(input.pfMEtPt_, pfMEtPtMin_, pfMEtPtMax_, flags);
+  applyCutBatch(input.Mt_, MtCutoffMin_, MtCutoffMax_, flags);
+
+  if ( debugMode_ == kDEBUG1 ) applyCutBatch(input.visMass_, 120., 140., flags);
+  if ( debugMode_ == kDEBUG2 ) {
+    for ( size_t idx = 0; idx < numMuTauPairs; ++idx ) {
+      double visMass = input.visMass_[idx];
+      flags[idx] &= (((visMass > 105.) & (visMass < 115.)) | ((visMass > 145.) & (visMass < 155.)));
     }
+  }
 
-    if ( debugMode_ == kDEBUG1 && ! (visMass > 120. && visMass < 140.)                                        ) return false;
-    if ( debugMode_ == kDEBUG2 && !((visMass > 105. && visMass < 115.) || (visMass > 145. && visMass < 155.)) ) return false;
+  if        ( MtAndPzetaDiffCut_ == kSignalLike || MtAndPzetaDiffCut_ == kBackgroundLike ) {
+    MtAndPzetaDiffFlags_.assign(numMuTauPairs, 1);
+    applyCutBatch(input.Mt_, MtMin_, MtMax_, MtAndPzetaDiffFlags_);
+    applyCutBatch(input.PzetaDiff_, PzetaDiffMin_, PzetaDiffMax_, MtAndPzetaDiffFlags_);
+    combineFlagsBatch(MtAndPzetaDiffFlags_, MtAndPzetaDiffCut_ == kBackgroundLike, false, flags);
+  } else if ( MtAndPzetaDiffCut_ == kWplusJetBackgroundLike                             ) {
+    applyCutBatch(input.Mt_, 70., 120., flags);
+  }
 
-    if ( ( MtAndPzetaDiffCut_ == kNotApplied                                           ||
-	  (MtAndPzetaDiffCut_ == kSignalLike             &&  MtAndPzetaDiffCut_passed) ||
-	  (MtAndPzetaDiffCut_ == kBackgroundLike         && !MtAndPzetaDiffCut_passed) ||
-	  (MtAndPzetaDiffCut_ == kWplusJetBackgroundLike &&  Mt > 70. && Mt < 120.   ) ) &&
-	 ( tauIdDiscriminatorCut_ == kNotApplied                                       ||
-	  (tauIdDiscriminatorCut_ == kSignalLike     &&  tauIdDiscriminators_passed)   ||
-	  (tauIdDiscriminatorCut_ == kBackgroundLike && !tauIdDiscriminators_passed)   ) ) return true;
+  if ( tauIdDiscriminatorCut_ == kSignalLike || tauIdDiscriminatorCut_ == kBackgroundLike ) {
+    tauIdDiscriminatorFlags_.assign(numMuTauPairs, 1);
+    for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators_.begin();
+	  tauIdDiscriminator != tauIdDiscriminators_.end(); ++tauIdDiscriminator ) {
+      vstring::const_iterator tauIdDiscriminatorName = 
+	std::find(input.tauIdDiscriminatorNames_.begin(), input.tauIdDiscriminatorNames_.end(), *tauIdDiscriminator);
+      if ( tauIdDiscriminatorName == input.tauIdDiscriminatorNames_.end() ) 
+	throw cms::Exception("TauIdEffEventSelector") 
+	  << "Values of tau id. discriminator = " << (*tauIdDiscriminator) << " not contained in input batch !!\n";
+      const std::vector<double>& tauIdDiscriminatorValues = 
+	input.tauIdDiscriminatorValues_[tauIdDiscriminatorName - input.tauIdDiscriminatorNames_.begin()];
+      applyCutBatch(tauIdDiscriminatorValues, tauIdDiscriminatorMin_, tauIdDiscriminatorMax_, tauIdDiscriminatorFlags_);
+    }
+    combineFlagsBatch(tauIdDiscriminatorFlags_, tauIdDiscriminatorCut_ == kBackgroundLike, false, flags);
   }
+}
 
-  return false;
+bool TauIdEffEventSelector::passesTauIdDiscriminators(const TauIdEffMiniTupleEntry& entry, const std::vector<int>& tauIdDiscriminatorIndices) const
+{
+  for ( std::vector<int>::const_iterator tauIdDiscriminatorIndex = tauIdDiscriminatorIndices.begin();
+	tauIdDiscriminatorIndex != tauIdDiscriminatorIndices.end(); ++tauIdDiscriminatorIndex ) {
+    double tauIdDiscriminatorValue = entry.tauIdDiscriminatorValues_[*tauIdDiscriminatorIndex];
+    if ( !(tauIdDiscriminatorValue > tauIdDiscriminatorMin_ && tauIdDiscriminatorValue < tauIdDiscriminatorMax_) ) return false;
+  }
+  return true;
 }
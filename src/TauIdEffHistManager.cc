@@ -1,5 +1,9 @@
 #include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistManager.h"
 
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include "CommonTools/Utils/interface/TH1AddDirectorySentry.h"
+
 #include <TMath.h>
 
 TauIdEffHistManager::TauIdEffHistManager(const edm::ParameterSet& cfg)
@@ -12,6 +16,8 @@ TauIdEffHistManager::TauIdEffHistManager(const edm::ParameterSet& cfg)
     cfg.getParameter<std::string>("svFitMassHypothesis") : "";
   fillControlPlots_     = cfg.getParameter<bool>("fillControlPlots");
   triggerBits_          = cfg.getParameter<vstring>("triggerBits");
+  writeHistogramBundle_ = cfg.exists("writeHistogramBundle") ?
+    cfg.getParameter<bool>("writeHistogramBundle") : false;
 }
 
 TauIdEffHistManager::~TauIdEffHistManager()
@@ -73,47 +79,42 @@ void TauIdEffHistManager::bookHistograms(TFileDirectory& dir)
   }
 }
 
-void TauIdEffHistManager::fillHistograms(const PATMuTauPair& muTauPair, const pat::MET& caloMEt, 
-					 size_t numJets, size_t numJets_bTagged, 
-					 size_t numVertices, const std::map<std::string, bool>& triggerBits_passed, double weight)
+void TauIdEffHistManager::fillHistograms(const TauIdEffMiniTupleEntry& entry, double caloMEtPt, 
+					 const std::map<std::string, bool>& triggerBits_passed, double weight)
 {
   // fill histograms for fit variables
-  histogramTauNumTracks_->Fill(muTauPair.leg2()->userFloat("numTracks"), weight);
-  histogramTauNumSelTracks_->Fill(muTauPair.leg2()->userFloat("numSelTracks"), weight);
-
-  histogramVisMass_->Fill((muTauPair.leg1()->p4() + muTauPair.leg2()->p4()).mass(), weight); 
-  if ( svFitMassHypothesis_ != "" ) {
-    int errorFlag;
-    const NSVfitResonanceHypothesisSummary* svFitSolution = muTauPair.nSVfitSolution(svFitMassHypothesis_, &errorFlag);
-    if ( svFitSolution ) histogramSVfitMass_->Fill(svFitSolution->mass(), weight); 
-  }
-  histogramMt_->Fill(muTauPair.mt1MET(), weight);
+  histogramTauNumTracks_->Fill(entry.tauNumTracks_, weight);
+  histogramTauNumSelTracks_->Fill(entry.tauNumSelTracks_, weight);
+
+  histogramVisMass_->Fill(entry.visMass_, weight); 
+  if ( svFitMassHypothesis_ != "" && entry.svFitMass_ >= 0. ) histogramSVfitMass_->Fill(entry.svFitMass_, weight); 
+  histogramMt_->Fill(entry.Mt_, weight);
 
   // book histogram needed to keep track of number of processed events
   histogramEventCounter_->Fill(0., weight);
 
   // book histograms for control plots
   if ( fillControlPlots_ ) {
-    histogramMuonPt_->Fill(muTauPair.leg1()->pt(), weight);
-    histogramMuonEta_->Fill(muTauPair.leg1()->eta(), weight);
-    histogramMuonPhi_->Fill(muTauPair.leg1()->phi(), weight);
+    histogramMuonPt_->Fill(entry.muonPt_, weight);
+    histogramMuonEta_->Fill(entry.muonEta_, weight);
+    histogramMuonPhi_->Fill(entry.muonPhi_, weight);
   
-    histogramTauPt_->Fill(muTauPair.leg2()->pt(), weight);
-    histogramTauEta_->Fill(muTauPair.leg2()->eta(), weight);
-    histogramTauPhi_->Fill(muTauPair.leg2()->phi(), weight);
+    histogramTauPt_->Fill(entry.tauPt_, weight);
+    histogramTauEta_->Fill(entry.tauEta_, weight);
+    histogramTauPhi_->Fill(entry.tauPhi_, weight);
   
-    histogramPzetaDiff_->Fill(muTauPair.pZeta() - 1.5*muTauPair.pZetaVis(), weight);
-    histogramDPhi_->Fill(TMath::ACos(TMath::Cos(muTauPair.leg1()->phi() - muTauPair.leg2()->phi())), weight);
+    histogramPzetaDiff_->Fill(entry.PzetaDiff_, weight);
+    histogramDPhi_->Fill(TMath::ACos(TMath::Cos(entry.muonPhi_ - entry.tauPhi_)), weight);
 
-    histogramNumJets_->Fill(numJets, weight);
-    histogramNumJetsBtagged_->Fill(numJets_bTagged, weight);
+    histogramNumJets_->Fill(entry.numJets_, weight);
+    histogramNumJetsBtagged_->Fill(entry.numJets_bTagged_, weight);
     
-    histogramPFMEt_->Fill(muTauPair.met()->pt(), weight);
-    histogramPFSumEt_->Fill(muTauPair.met()->sumEt(), weight);
-    histogramCaloMEt_->Fill(caloMEt.pt(), weight);
-    histogramCaloSumEt_->Fill(caloMEt.sumEt(), weight);
+    histogramPFMEt_->Fill(entry.pfMEtPt_, weight);
+    histogramPFSumEt_->Fill(entry.pfMEtSumEt_, weight);
+    histogramCaloMEt_->Fill(caloMEtPt, weight);
+    histogramCaloSumEt_->Fill(entry.caloMEtSumEt_, weight);
     
-    histogramNumVertices_->Fill(numVertices, weight);
+    histogramNumVertices_->Fill(entry.numVertices_, weight);
     
     if ( weight > 0. ) {
       double logWeight = TMath::Log(weight);
@@ -128,9 +129,9 @@ void TauIdEffHistManager::fillHistograms(const PATMuTauPair& muTauPair, const pa
       //          << histogramNumCaloMEt_[triggerBit_passed->first] << std::endl;
       std::cout << triggerBit_passed->first << ": " << triggerBit_passed->second << std::endl;
       assert(histogramNumCaloMEt_[triggerBit_passed->first]);
-      if ( triggerBit_passed->second ) histogramNumCaloMEt_[triggerBit_passed->first]->Fill(caloMEt.pt(), weight);
+      if ( triggerBit_passed->second ) histogramNumCaloMEt_[triggerBit_passed->first]->Fill(caloMEtPt, weight);
     }
-    histogramDenomCaloMEt_->Fill(caloMEt.pt(), weight);
+    histogramDenomCaloMEt_->Fill(caloMEtPt, weight);
   }
 }
 
@@ -146,21 +147,37 @@ void TauIdEffHistManager::scaleHistograms(double factor)
 TH1* TauIdEffHistManager::book1D(TFileDirectory& dir,
 				 const std::string& distribution, const std::string& title, int numBins, double min, double max)
 {
-  TH1* retVal = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, min, max);
-  if ( !retVal->GetSumw2N() ) retVal->Sumw2();
-  histograms_.push_back(retVal);
-  return retVal;
+  TH1* histogram = 0;
+  if ( writeHistogramBundle_ ) {
+    TH1AddDirectorySentry sentry;
+    histogram = new TH1D(getHistogramName(distribution).data(), title.data(), numBins, min, max);
+  } else {
+    histogram = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, min, max);
+  }
+  return registerHistogram(dir, histogram);
 }
  
 TH1* TauIdEffHistManager::book1D(TFileDirectory& dir,
 				 const std::string& distribution, const std::string& title, int numBins, float* binning)
 {
-  TH1* retVal = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, binning);
-  if ( !retVal->GetSumw2N() ) retVal->Sumw2();
-  histograms_.push_back(retVal);
-  return retVal;
+  TH1* histogram = 0;
+  if ( writeHistogramBundle_ ) {
+    TH1AddDirectorySentry sentry;
+    histogram = new TH1D(getHistogramName(distribution).data(), title.data(), numBins, binning);
+  } else {
+    histogram = dir.make<TH1D>(getHistogramName(distribution).data(), title.data(), numBins, binning);
+  }
+  return registerHistogram(dir, histogram);
 }
  
+TH1* TauIdEffHistManager::registerHistogram(TFileDirectory& dir, TH1* histogram)
+{
+  if ( !histogram->GetSumw2N() ) histogram->Sumw2();
+  if ( writeHistogramBundle_ ) TauIdEffHistogramBundle::getBundle(dir)->addHistogram(histogram);
+  histograms_.push_back(histogram);
+  return histogram;
+}
+
 std::string TauIdEffHistManager::getHistogramName(const std::string& distribution)
 {
   std::string retVal = std::string(process_).append("_").append(region_).append("_").append(distribution);
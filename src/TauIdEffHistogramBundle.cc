@@ -0,0 +1,212 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "CommonTools/Utils/interface/TH1AddDirectorySentry.h"
+
+#include <TDirectory.h>
+#include <TArrayD.h>
+#include <TMath.h>
+
+ClassImp(TauIdEffHistogramBundle)
+
+TauIdEffHistogramBundle::TauIdEffHistogramBundle()
+  : TNamed()
+{}
+
+TauIdEffHistogramBundle::TauIdEffHistogramBundle(const char* name, const char* title)
+  : TNamed(name, title)
+{}
+
+TauIdEffHistogramBundle::~TauIdEffHistogramBundle()
+{
+  for ( std::vector<TH1*>::iterator it = histograms_.begin();
+	it != histograms_.end(); ++it ) {
+    delete (*it);
+  }
+}
+
+unsigned TauIdEffHistogramBundle::addEntry(const std::string& histogramName, const std::string& histogramTitle,
+					   int numBins, double xMin, double xMax, const double* binEdges)
+{
+  unsigned idx = histogramNames_.size();
+  histogramNames_.push_back(histogramName);
+  histogramTitles_.push_back(histogramTitle);
+  numBins_.push_back(numBins);
+  xMin_.push_back(xMin);
+  xMax_.push_back(xMax);
+  if ( binEdges ) {
+    binEdgesOffsets_.push_back(binEdges_.size());
+    binEdges_.insert(binEdges_.end(), binEdges, binEdges + (numBins + 1));
+  } else {
+    binEdgesOffsets_.push_back(-1);
+  }
+  binContentsOffsets_.push_back(binContents_.size());
+  binContents_.resize(binContents_.size() + (numBins + 2), 0.);
+  sumw2_.resize(sumw2_.size() + (numBins + 2), 0.);
+  numEntries_.push_back(0.);
+  index_[histogramName] = idx;
+  return idx;
+}
+
+void TauIdEffHistogramBundle::addHistogram(TH1* histogram)
+{
+  if ( !histogram || histogram->GetDimension() != 1 )
+    throw cms::Exception("TauIdEffHistogramBundle::addHistogram")
+      << "Only one-dimensional histograms can be added to bundle = " << GetName() << " !!\n";
+
+  std::string histogramName = histogram->GetName();
+  if ( findHistogram(histogramName) != -1 )
+    throw cms::Exception("TauIdEffHistogramBundle::addHistogram")
+      << "Histogram = " << histogramName << " already exists in bundle = " << GetName() << " !!\n";
+
+  const TAxis* xAxis = histogram->GetXaxis();
+  const double* binEdges = ( xAxis->GetXbins()->GetSize() > 0 ) ? xAxis->GetXbins()->GetArray() : 0;
+  unsigned idx = addEntry(histogramName, histogram->GetTitle(), xAxis->GetNbins(), xAxis->GetXmin(), xAxis->GetXmax(), binEdges);
+
+  histogram->SetDirectory(0);
+  if ( histograms_.size() <= idx ) histograms_.resize(idx + 1, 0);
+  histograms_[idx] = histogram;
+}
+
+void TauIdEffHistogramBundle::pack()
+{
+  for ( unsigned idx = 0; idx < histograms_.size(); ++idx ) {
+    const TH1* histogram = histograms_[idx];
+    if ( !histogram ) continue;
+    int numBins = numBins_[idx];
+    int offset = binContentsOffsets_[idx];
+    bool hasSumw2 = ( histogram->GetSumw2N() > 0 );
+    for ( int iBin = 0; iBin <= (numBins + 1); ++iBin ) {
+      double binContent = histogram->GetBinContent(iBin);
+      binContents_[offset + iBin] = binContent;
+      sumw2_[offset + iBin] = ( hasSumw2 ) ? histogram->GetSumw2()->At(iBin) : TMath::Abs(binContent);
+    }
+    numEntries_[idx] = histogram->GetEntries();
+  }
+}
+
+int TauIdEffHistogramBundle::findHistogram(const std::string& histogramName) const
+{
+//--- rebuild index in case bundle has been read from file
+  if ( index_.size() != histogramNames_.size() ) {
+    index_.clear();
+    for ( unsigned idx = 0; idx < histogramNames_.size(); ++idx ) {
+      index_[histogramNames_[idx]] = idx;
+    }
+  }
+
+  std::map<std::string, unsigned>::const_iterator idx = index_.find(histogramName);
+  return ( idx != index_.end() ) ? (int)idx->second : -1;
+}
+
+TH1* TauIdEffHistogramBundle::makeHistogram(unsigned idx) const
+{
+  if ( idx >= histogramNames_.size() )
+    throw cms::Exception("TauIdEffHistogramBundle::makeHistogram")
+      << "Invalid index = " << idx << ", bundle = " << GetName() << " contains " << histogramNames_.size() << " histograms !!\n";
+
+  TH1* histogram = 0;
+  {
+    TH1AddDirectorySentry sentry;
+    int numBins = numBins_[idx];
+    if ( binEdgesOffsets_[idx] >= 0 )
+      histogram = new TH1D(histogramNames_[idx].data(), histogramTitles_[idx].data(), numBins, &binEdges_[binEdgesOffsets_[idx]]);
+    else
+      histogram = new TH1D(histogramNames_[idx].data(), histogramTitles_[idx].data(), numBins, xMin_[idx], xMax_[idx]);
+  }
+  histogram->Sumw2();
+
+  int numBins = numBins_[idx];
+  int offset = binContentsOffsets_[idx];
+  TArrayD* sumw2 = histogram->GetSumw2();
+  for ( int iBin = 0; iBin <= (numBins + 1); ++iBin ) {
+    histogram->SetBinContent(iBin, binContents_[offset + iBin]);
+    sumw2->SetAt(sumw2_[offset + iBin], iBin);
+  }
+  histogram->SetEntries(numEntries_[idx]);
+
+  return histogram;
+}
+
+TH1* TauIdEffHistogramBundle::makeHistogram(const std::string& histogramName) const
+{
+  int idx = findHistogram(histogramName);
+  return ( idx != -1 ) ? makeHistogram(idx) : 0;
+}
+
+bool TauIdEffHistogramBundle::isCompatibleBinning(unsigned idx1, const TauIdEffHistogramBundle& bundle, unsigned idx2) const
+{
+  if ( numBins_[idx1] != bundle.numBins_[idx2] ) return false;
+  if ( (binEdgesOffsets_[idx1] >= 0) != (bundle.binEdgesOffsets_[idx2] >= 0) ) return false;
+  if ( binEdgesOffsets_[idx1] >= 0 ) {
+    for ( int iEdge = 0; iEdge <= numBins_[idx1]; ++iEdge ) {
+      if ( !TMath::AreEqualRel(binEdges_[binEdgesOffsets_[idx1] + iEdge],
+			       bundle.binEdges_[bundle.binEdgesOffsets_[idx2] + iEdge], 1.e-6) ) return false;
+    }
+    return true;
+  } else {
+    return ( TMath::AreEqualRel(xMin_[idx1], bundle.xMin_[idx2], 1.e-6) &&
+	     TMath::AreEqualRel(xMax_[idx1], bundle.xMax_[idx2], 1.e-6) );
+  }
+}
+
+Long64_t TauIdEffHistogramBundle::Merge(TCollection* list)
+{
+  if ( !list ) return 0;
+
+  pack();
+
+  TIter next(list);
+  while ( TObject* object = next() ) {
+    TauIdEffHistogramBundle* bundle = dynamic_cast<TauIdEffHistogramBundle*>(object);
+    if ( !bundle )
+      throw cms::Exception("TauIdEffHistogramBundle::Merge")
+	<< "Cannot merge object = " << object->GetName() << " of type = " << object->ClassName() << " with bundle = " << GetName() << " !!\n";
+    bundle->pack();
+
+    for ( unsigned idx2 = 0; idx2 < bundle->getNumHistograms(); ++idx2 ) {
+      const std::string& histogramName = bundle->histogramNames_[idx2];
+      int idx1 = findHistogram(histogramName);
+      if ( idx1 == -1 ) {
+	const double* binEdges = ( bundle->binEdgesOffsets_[idx2] >= 0 ) ? &bundle->binEdges_[bundle->binEdgesOffsets_[idx2]] : 0;
+	idx1 = addEntry(histogramName, bundle->histogramTitles_[idx2],
+			bundle->numBins_[idx2], bundle->xMin_[idx2], bundle->xMax_[idx2], binEdges);
+      } else if ( !isCompatibleBinning(idx1, *bundle, idx2) ) {
+	throw cms::Exception("TauIdEffHistogramBundle::Merge")
+	  << "Histogram = " << histogramName << " has incompatible binning in bundles to be merged !!\n";
+      }
+      int offset1 = binContentsOffsets_[idx1];
+      int offset2 = bundle->binContentsOffsets_[idx2];
+      for ( int iBin = 0; iBin <= (numBins_[idx1] + 1); ++iBin ) {
+	binContents_[offset1 + iBin] += bundle->binContents_[offset2 + iBin];
+	sumw2_[offset1 + iBin] += bundle->sumw2_[offset2 + iBin];
+      }
+      numEntries_[idx1] += bundle->numEntries_[idx2];
+    }
+  }
+
+  return getNumHistograms();
+}
+
+Int_t TauIdEffHistogramBundle::Write(const char* name, Int_t option, Int_t bufsize) const
+{
+  // CV: the non-const overload forwards to this function,
+  //     so that bin-contents are up-to-date whenever the bundle is written,
+  //     in particular when it is written by TFileService at the end of the job
+  const_cast<TauIdEffHistogramBundle*>(this)->pack();
+  return TNamed::Write(name, option, bufsize);
+}
+
+Int_t TauIdEffHistogramBundle::Write(const char* name, Int_t option, Int_t bufsize)
+{
+  return static_cast<const TauIdEffHistogramBundle*>(this)->Write(name, option, bufsize);
+}
+
+TauIdEffHistogramBundle* TauIdEffHistogramBundle::getBundle(TFileDirectory& dir)
+{
+  TDirectory* bareDir = dir.getBareDirectory();
+  TauIdEffHistogramBundle* bundle = dynamic_cast<TauIdEffHistogramBundle*>(bareDir->FindObject(defaultName()));
+  if ( !bundle ) bundle = dir.make<TauIdEffHistogramBundle>(defaultName(), "");
+  return bundle;
+}
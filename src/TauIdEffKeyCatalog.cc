@@ -0,0 +1,132 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffKeyCatalog.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TList.h>
+#include <TH1.h>
+
+#include <algorithm>
+#include <utility>
+
+TauIdEffKeyCatalog::TauIdEffKeyCatalog(TDirectory* directory)
+  : directory_(directory),
+    numObjectsLoaded_(0)
+{
+  if ( !directory_ )
+    throw cms::Exception("TauIdEffKeyCatalog")
+      << "Invalid directory pointer !!\n";
+
+  TList* keys = directory_->GetListOfKeys();
+  if ( !keys ) return;
+
+  TIter next(keys);
+  while ( TKey* key = dynamic_cast<TKey*>(next()) ) {
+    keyIndexType::iterator keyEntry = keys_.find(key->GetName());
+    if ( keyEntry == keys_.end() ) {
+      keyEntryType keyEntry_new;
+      keyEntry_new.key_ = key;
+      keyEntry_new.bundle_ = 0;
+      keyEntry_new.bundleIdx_ = 0;
+      keyEntry_new.object_ = 0;
+      keyEntry_new.isRequested_ = false;
+      keys_.insert(std::pair<std::string, keyEntryType>(key->GetName(), keyEntry_new));
+    } else if ( key->GetCycle() > keyEntry->second.key_->GetCycle() ) {
+      keyEntry->second.key_ = key;
+    }
+  }
+
+//--- index histograms stored in bundles
+  std::vector<std::string> bundleNames;
+  for ( keyIndexType::const_iterator keyEntry = keys_.begin();
+	keyEntry != keys_.end(); ++keyEntry ) {
+    if ( std::string(keyEntry->second.key_->GetClassName()) == TauIdEffHistogramBundle::Class_Name() )
+      bundleNames.push_back(keyEntry->first);
+  }
+  std::sort(bundleNames.begin(), bundleNames.end());
+  for ( std::vector<std::string>::const_iterator bundleName = bundleNames.begin();
+	bundleName != bundleNames.end(); ++bundleName ) {
+    TauIdEffHistogramBundle* bundle = dynamic_cast<TauIdEffHistogramBundle*>(get(*bundleName));
+    if ( !bundle )
+      throw cms::Exception("TauIdEffKeyCatalog")
+	<< "Failed to read histogram bundle = " << (*bundleName) << " from file/directory = " << directory_->GetName() << " !!\n";
+    bundles_.push_back(bundle);
+    for ( unsigned idx = 0; idx < bundle->getNumHistograms(); ++idx ) {
+      const std::string& histogramName = bundle->getHistogramName(idx);
+      if ( keys_.find(histogramName) != keys_.end() ) continue;
+      keyEntryType keyEntry_new;
+      keyEntry_new.key_ = 0;
+      keyEntry_new.bundle_ = bundle;
+      keyEntry_new.bundleIdx_ = idx;
+      keyEntry_new.object_ = 0;
+      keyEntry_new.isRequested_ = false;
+      keys_.insert(std::pair<std::string, keyEntryType>(histogramName, keyEntry_new));
+    }
+  }
+}
+
+TauIdEffKeyCatalog::~TauIdEffKeyCatalog()
+{
+// CV: histograms restored from bundles are attached to the directory,
+//     so that the bundles can be deleted without affecting them
+  for ( std::vector<TauIdEffHistogramBundle*>::iterator it = bundles_.begin();
+	it != bundles_.end(); ++it ) {
+    delete (*it);
+  }
+}
+
+bool TauIdEffKeyCatalog::contains(const std::string& name) const
+{
+  return ( keys_.find(name) != keys_.end() );
+}
+
+void TauIdEffKeyCatalog::request(const std::string& name)
+{
+  keyIndexType::iterator keyEntry = keys_.find(name);
+  if ( keyEntry == keys_.end() || keyEntry->second.object_ || keyEntry->second.isRequested_ ) return;
+  keyEntry->second.isRequested_ = true;
+  requestedKeys_.push_back(&keyEntry->second);
+}
+
+void TauIdEffKeyCatalog::loadObject(keyEntryType& keyEntry)
+{
+  if ( keyEntry.object_ ) return;
+  if ( keyEntry.bundle_ ) {
+    TH1* histogram = keyEntry.bundle_->makeHistogram(keyEntry.bundleIdx_);
+    histogram->SetDirectory(directory_);
+    keyEntry.object_ = histogram;
+  } else {
+    keyEntry.object_ = keyEntry.key_->ReadObj();
+  }
+  ++numObjectsLoaded_;
+}
+
+void TauIdEffKeyCatalog::loadRequested()
+{
+//--- read objects in order of their position in the file,
+//    in order to avoid seeking back and forth
+//   (histograms stored in bundles are already in memory)
+  typedef std::pair<Long64_t, keyEntryType*> seekKeyEntryPair;
+  std::vector<seekKeyEntryPair> requestedKeys_sorted;
+  for ( std::vector<keyEntryType*>::const_iterator keyEntry = requestedKeys_.begin();
+	keyEntry != requestedKeys_.end(); ++keyEntry ) {
+    Long64_t seekKey = ( (*keyEntry)->key_ ) ? (*keyEntry)->key_->GetSeekKey() : -1;
+    requestedKeys_sorted.push_back(seekKeyEntryPair(seekKey, *keyEntry));
+  }
+  std::sort(requestedKeys_sorted.begin(), requestedKeys_sorted.end());
+
+  for ( std::vector<seekKeyEntryPair>::const_iterator requestedKey = requestedKeys_sorted.begin();
+	requestedKey != requestedKeys_sorted.end(); ++requestedKey ) {
+    keyEntryType* keyEntry = requestedKey->second;
+    loadObject(*keyEntry);
+    keyEntry->isRequested_ = false;
+  }
+  requestedKeys_.clear();
+}
+
+TObject* TauIdEffKeyCatalog::get(const std::string& name)
+{
+  keyIndexType::iterator keyEntry = keys_.find(name);
+  if ( keyEntry == keys_.end() ) return 0;
+  loadObject(keyEntry->second);
+  return keyEntry->second.object_;
+}
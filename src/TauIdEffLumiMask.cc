@@ -0,0 +1,150 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffLumiMask.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <cctype>
+#include <cstdlib>
+
+TauIdEffLumiMask::TauIdEffLumiMask(const std::string& lumiMaskFileName, int firstRun, int lastRun)
+  : firstRun_(firstRun),
+    lastRun_(lastRun),
+    hasLumiMask_(false),
+    lastRun_cached_(0),
+    lastRunEntry_cached_(0),
+    lastRun_isCached_(false)
+{
+  if ( lumiMaskFileName != "" ) {
+    readJSON(lumiMaskFileName);
+    hasLumiMask_ = true;
+  }
+}
+
+TauIdEffLumiMask::~TauIdEffLumiMask()
+{
+// nothing to be done yet...
+}
+
+namespace
+{
+  unsigned parseNumber(const std::string& json, size_t& pos)
+  {
+    size_t pos_start = pos;
+    while ( pos < json.length() && isdigit(json[pos]) ) ++pos;
+    return strtoul(std::string(json, pos_start, pos - pos_start).data(), 0, 10);
+  }
+}
+
+void TauIdEffLumiMask::readJSON(const std::string& fileName)
+{
+  std::ifstream file(fileName.data());
+  if ( !file )
+    throw cms::Exception("TauIdEffLumiMask")
+      << "Failed to open JSON file = " << fileName << " !!\n";
+  std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+//--- parse JSON file:
+//    run numbers are given as (quoted) keys,
+//    followed by a list of [ firstLumiSection, lastLumiSection ] pairs
+  size_t pos = json.find('"');
+  while ( pos != std::string::npos ) {
+    ++pos;
+    if ( !(pos < json.length() && isdigit(json[pos])) )
+      throw cms::Exception("TauIdEffLumiMask")
+	<< "Failed to parse run number at position " << pos << " of JSON file = " << fileName << " !!\n";
+    edm::RunNumber_t run = parseNumber(json, pos);
+    if ( !(pos < json.length() && json[pos] == '"') )
+      throw cms::Exception("TauIdEffLumiMask")
+	<< "Failed to parse run number at position " << pos << " of JSON file = " << fileName << " !!\n";
+
+    pos = json.find('[', pos);
+    if ( pos == std::string::npos )
+      throw cms::Exception("TauIdEffLumiMask")
+	<< "No luminosity sections given for run = " << run << " in JSON file = " << fileName << " !!\n";
+    std::vector<unsigned> lumiSectionNumbers;
+    int depth = 0;
+    while ( pos < json.length() ) {
+      char c = json[pos];
+      if ( c == '[' ) {
+	++depth;
+      } else if ( c == ']' ) {
+	--depth;
+	if ( depth == 0 ) break;
+      } else if ( isdigit(c) ) {
+	lumiSectionNumbers.push_back(parseNumber(json, pos));
+	continue;
+      } else if ( !(isspace(c) || c == ',') ) {
+	break;
+      }
+      ++pos;
+    }
+    if ( depth != 0 || (lumiSectionNumbers.size() % 2) != 0 )
+      throw cms::Exception("TauIdEffLumiMask")
+	<< "Failed to parse luminosity sections of run = " << run << " in JSON file = " << fileName << " !!\n";
+
+    lumiSectionMask& runEntry = runs_[run];
+    for ( size_t idx = 0; idx < lumiSectionNumbers.size(); idx += 2 ) {
+      unsigned firstLumiSection = lumiSectionNumbers[idx];
+      unsigned lastLumiSection = lumiSectionNumbers[idx + 1];
+      if ( lastLumiSection < firstLumiSection )
+	throw cms::Exception("TauIdEffLumiMask")
+	  << "Invalid range of luminosity sections = [ " << firstLumiSection << ", " << lastLumiSection << " ]"
+	  << " given for run = " << run << " in JSON file = " << fileName << " !!\n";
+      if ( runEntry.size() <= lastLumiSection ) runEntry.resize(lastLumiSection + 1, false);
+      for ( unsigned lumiSection = firstLumiSection; lumiSection <= lastLumiSection; ++lumiSection ) {
+	runEntry[lumiSection] = true;
+      }
+    }
+
+    pos = json.find('"', pos);
+  }
+}
+
+bool TauIdEffLumiMask::passesRun(edm::RunNumber_t run) const
+{
+  if ( (firstRun_ != -1 && (int)run < firstRun_) ||
+       (lastRun_  != -1 && (int)run > lastRun_ ) ) return false;
+  if ( !hasLumiMask_ ) return true;
+
+//--- events are sorted by run number;
+//    look-up run in map only in case it differs from the one of the previous call
+  if ( !(lastRun_isCached_ && run == lastRun_cached_) ) {
+    std::map<edm::RunNumber_t, lumiSectionMask>::const_iterator runEntry = runs_.find(run);
+    lastRunEntry_cached_ = ( runEntry != runs_.end() ) ? &runEntry->second : 0;
+    lastRun_cached_ = run;
+    lastRun_isCached_ = true;
+  }
+  return ( lastRunEntry_cached_ != 0 );
+}
+
+bool TauIdEffLumiMask::operator()(edm::RunNumber_t run, edm::LuminosityBlockNumber_t lumiSection) const
+{
+  if ( !passesRun(run) ) return false;
+  if ( !hasLumiMask_ ) return true;
+  return ( lumiSection < lastRunEntry_cached_->size() && (*lastRunEntry_cached_)[lumiSection] );
+}
+
+std::string TauIdEffLumiMask::toString() const
+{
+  std::ostringstream lumiMask_string;
+  lumiMask_string << "runs = " << firstRun_ << ":" << lastRun_;
+  if ( hasLumiMask_ ) {
+    lumiMask_string << ", lumiSections = {";
+    for ( std::map<edm::RunNumber_t, lumiSectionMask>::const_iterator runEntry = runs_.begin();
+	  runEntry != runs_.end(); ++runEntry ) {
+      lumiSectionMask::size_type numLumiSections = runEntry->second.size();
+      lumiMask_string << " " << runEntry->first << ":";
+      for ( lumiSectionMask::size_type lumiSection = 0; lumiSection < numLumiSections; ++lumiSection ) {
+	if ( !runEntry->second[lumiSection] ) continue;
+	lumiSectionMask::size_type lastLumiSection = lumiSection;
+	while ( lastLumiSection + 1 < numLumiSections && runEntry->second[lastLumiSection + 1] ) ++lastLumiSection;
+	lumiMask_string << "[" << lumiSection << "," << lastLumiSection << "]";
+	lumiSection = lastLumiSection;
+      }
+    }
+    lumiMask_string << " }";
+  }
+  return lumiMask_string.str();
+}
@@ -0,0 +1,640 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMiniTuple.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauIdEfficiency/interface/tauIdEffAuxFunctions.h"
+
+#include <TMath.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char miniTupleMagic[8] = { 'T', 'A', 'U', 'I', 'D', 'M', 'T', 'P' };
+const uint32_t miniTupleVersion = 2;
+const size_t miniTuplePreambleSize = 8 + 4 + 4 + 8; // magic, version, padding, trailer offset
+const size_t miniTupleTrailerOffsetPosition = 16;
+
+const std::string tauIdDiscriminatorColumnPrefix = "tauId_";
+
+int getGenTauDecayModeCode(const std::string& genTauDecayMode)
+{
+  if      ( genTauDecayMode == ""                ) return kGenTauDecayModeUndefined;
+  else if ( genTauDecayMode == "oneProng0Pi0"    ||
+	    genTauDecayMode == "oneProng1Pi0"    ||
+	    genTauDecayMode == "oneProng2Pi0"    ||
+	    genTauDecayMode == "oneProngOther"   ) return kGenTauDecayOneProng;
+  else if ( genTauDecayMode == "threeProng0Pi0"  ||
+	    genTauDecayMode == "threeProngOther" ) return kGenTauDecayThreeProng;
+  else if ( genTauDecayMode == "rare"            ) return kGenTauDecayRare;
+  else if ( genTauDecayMode == "electron"        ) return kGenTauDecayElectron;
+  else if ( genTauDecayMode == "muon"            ) return kGenTauDecayMuon;
+  else                                             return kGenTauDecayOther;
+}
+
+TauIdEffMiniTupleEntry::TauIdEffMiniTupleEntry()
+  : run_(0), ls_(0), event_(0), idxSysShift_(0), evtWeight_(1.), numVertices_(0), triggerBits_(0), caloMEtPt_(0.), caloMEtSumEt_(0.),
+    idxMuTauPair_(0), numJets_(0), numJets_bTagged_(0), numJets_bTagged_noCleaning_(0),
+    genMatchType_(kUnmatched), genTauCharge_(0.), genTauDecayMode_(kGenTauDecayModeUndefined),
+    muonPt_(0.), muonEta_(0.), muonPhi_(0.), muonCharge_(0.), muonIso_(0.), muonIsoProb_(1.),
+    tauPt_(0.), tauEta_(0.), tauPhi_(0.), tauCharge_(0.), tauLeadTrackPt_(0.), tauLeadTrackCharge_(0.), tauIso_(0.),
+    tauHasLeadTrack_(0.), tauPFElectronMVA_(0.), tauDRnearestMuon_(0.), tauNumTracks_(0.), tauNumSelTracks_(0.),
+    muTauPairAbsDz_(0.), visMass_(0.), svFitMass_(-1.), Mt_(0.), PzetaDiff_(0.), pfMEtPt_(0.), pfMEtSumEt_(0.)
+{}
+
+void fillMiniTupleEntry(const PATMuTauPair& muTauPair, double tauShiftFactor, const std::string& svFitMassHypothesis,
+			const std::vector<std::string>& tauIdDiscriminators, TauIdEffMiniTupleEntry& entry,
+			const reco::Candidate::LorentzVector* metP4_shifted)
+{
+  muTauPairKinematicsType muTauPairKinematics;
+  compMuTauPairKinematics(muTauPair, tauShiftFactor, muTauPairKinematics, metP4_shifted);
+
+  entry.muonPt_             = muTauPair.leg1()->pt();
+  entry.muonEta_            = muTauPair.leg1()->eta();
+  entry.muonPhi_            = muTauPair.leg1()->phi();
+  entry.muonCharge_         = muTauPair.leg1()->charge();
+  // compute deltaBeta corrected isolation Pt sum "by hand"
+  // (cf. TauIdEffEventSelector::inputBatchType::push_back)
+  entry.muonIso_            = muTauPair.leg1()->userIsolation(pat::User1Iso)
+                            + TMath::Max(0., muTauPair.leg1()->userIsolation(pat::PfNeutralHadronIso)
+				           + muTauPair.leg1()->userIsolation(pat::PfGammaIso)
+				           - 0.5*muTauPair.leg1()->userIsolation(pat::User2Iso));
+  entry.tauPt_              = muTauPairKinematics.tauPt_;
+  entry.tauEta_             = muTauPair.leg2()->eta();
+  entry.tauPhi_             = muTauPair.leg2()->phi();
+  entry.tauCharge_          = muTauPair.leg2()->charge();
+  entry.tauLeadTrackPt_     = muTauPair.leg2()->userFloat("leadTrackPt");
+  entry.tauLeadTrackCharge_ = muTauPair.leg2()->userFloat("leadTrackCharge");
+  entry.tauIso_             = muTauPair.leg2()->userFloat("preselLoosePFIsoPt");
+  entry.tauHasLeadTrack_    = muTauPair.leg2()->userFloat("hasLeadTrack");
+  entry.tauPFElectronMVA_   = muTauPair.leg2()->userFloat("PFElectronMVA");
+  entry.tauDRnearestMuon_   = muTauPair.leg2()->userFloat("dRnearestMuon");
+  entry.tauNumTracks_       = muTauPair.leg2()->userFloat("numTracks");
+  entry.tauNumSelTracks_    = muTauPair.leg2()->userFloat("numSelTracks");
+  entry.muTauPairAbsDz_     = TMath::Abs(muTauPair.leg1()->vertex().z() - muTauPair.leg2()->vertex().z());
+  entry.visMass_            = muTauPairKinematics.visMass_;
+  entry.svFitMass_          = -1.;
+  if ( svFitMassHypothesis != "" ) {
+    int errorFlag;
+    const NSVfitResonanceHypothesisSummary* svFitSolution = muTauPair.nSVfitSolution(svFitMassHypothesis, &errorFlag);
+    if ( svFitSolution ) {
+      // CV: SVfit cannot be rerun "on-the-fly";
+      //     in case tau-jet momentum is shifted, approximate shift of SVfit mass by shift of visible mass
+      double svFitMass_shiftFactor = 1.;
+      if ( tauShiftFactor != 1. ) {
+	double visMass = (muTauPair.leg1()->p4() + muTauPair.leg2()->p4()).mass();
+	if ( visMass > 0. ) svFitMass_shiftFactor = muTauPairKinematics.visMass_/visMass;
+      }
+      entry.svFitMass_      = svFitMass_shiftFactor*svFitSolution->mass();
+    }
+  }
+  entry.Mt_                 = muTauPairKinematics.Mt_;
+  entry.PzetaDiff_          = muTauPairKinematics.PzetaDiff_;
+  entry.pfMEtPt_            = muTauPairKinematics.pfMEtPt_;
+  entry.pfMEtSumEt_         = muTauPair.met()->sumEt();
+
+  size_t numTauIdDiscriminators = tauIdDiscriminators.size();
+  entry.tauIdDiscriminatorValues_.resize(numTauIdDiscriminators);
+  for ( size_t iTauIdDiscriminator = 0; iTauIdDiscriminator < numTauIdDiscriminators; ++iTauIdDiscriminator ) {
+    entry.tauIdDiscriminatorValues_[iTauIdDiscriminator] = muTauPair.leg2()->tauID(tauIdDiscriminators[iTauIdDiscriminator]);
+  }
+}
+
+//-------------------------------------------------------------------------------
+//
+// definition of columns
+//
+namespace TauIdEffMiniTuple
+{
+  typedef TauIdEffMiniTupleEntry E;
+
+  const columnDefType columnDefs[] = {
+    { "run",                        kUInt,   kAlways,      &E::run_,                        0,                        0. },
+    { "ls",                         kUInt,   kAlways,      &E::ls_,                         0,                        0. },
+    { "event",                      kUInt,   kAlways,      &E::event_,                      0,                        0. },
+    { "idxSysShift",                kUInt,   kAlways,      &E::idxSysShift_,                0,                        0. },
+    { "evtWeight",                  kDouble, kAlways,      0,                               &E::evtWeight_,           1. },
+    { "numVertices",                kUInt,   kAlways,      &E::numVertices_,                0,                        0. },
+    { "triggerBits",                kUInt,   kAlways,      &E::triggerBits_,                0,                        0. },
+    { "caloMEtPt",                  kFloat,  kAlways,      0,                               &E::caloMEtPt_,           0. },
+    { "caloMEtSumEt",               kFloat,  kAlways,      0,                               &E::caloMEtSumEt_,        0. },
+    { "idxMuTauPair",               kUInt,   kAlways,      &E::idxMuTauPair_,               0,                        0. },
+    { "numJets",                    kUInt,   kAlways,      &E::numJets_,                    0,                        0. },
+    { "numJets_bTagged",            kUInt,   kAlways,      &E::numJets_bTagged_,            0,                        0. },
+    { "numJets_bTagged_noCleaning", kUInt,   kAlways,      &E::numJets_bTagged_noCleaning_, 0,                        0. },
+    { "genMatchType",               kUInt,   kGenMatch,    &E::genMatchType_,               0,                        kUnmatched },
+    { "genTauCharge",               kFloat,  kGenMatch,    0,                               &E::genTauCharge_,        0. },
+    { "genTauDecayMode",            kUInt,   kGenMatch,    &E::genTauDecayMode_,            0,                        kGenTauDecayModeUndefined },
+    { "muonPt",                     kFloat,  kAlways,      0,                               &E::muonPt_,              0. },
+    { "muonEta",                    kFloat,  kAlways,      0,                               &E::muonEta_,             0. },
+    { "muonPhi",                    kFloat,  kAlways,      0,                               &E::muonPhi_,             0. },
+    { "muonCharge",                 kFloat,  kAlways,      0,                               &E::muonCharge_,          0. },
+    { "muonIso",                    kFloat,  kAlways,      0,                               &E::muonIso_,             0. },
+    { "muonIsoProb",                kFloat,  kMuonIsoProb, 0,                               &E::muonIsoProb_,         1. },
+    { "tauPt",                      kFloat,  kAlways,      0,                               &E::tauPt_,               0. },
+    { "tauEta",                     kFloat,  kAlways,      0,                               &E::tauEta_,              0. },
+    { "tauPhi",                     kFloat,  kAlways,      0,                               &E::tauPhi_,              0. },
+    { "tauCharge",                  kFloat,  kAlways,      0,                               &E::tauCharge_,           0. },
+    { "tauLeadTrackPt",             kFloat,  kAlways,      0,                               &E::tauLeadTrackPt_,      0. },
+    { "tauLeadTrackCharge",         kFloat,  kAlways,      0,                               &E::tauLeadTrackCharge_,  0. },
+    { "tauIso",                     kFloat,  kAlways,      0,                               &E::tauIso_,              0. },
+    { "tauHasLeadTrack",            kFloat,  kAlways,      0,                               &E::tauHasLeadTrack_,     0. },
+    { "tauPFElectronMVA",           kFloat,  kAlways,      0,                               &E::tauPFElectronMVA_,    0. },
+    { "tauDRnearestMuon",           kFloat,  kAlways,      0,                               &E::tauDRnearestMuon_,    0. },
+    { "tauNumTracks",               kFloat,  kAlways,      0,                               &E::tauNumTracks_,        0. },
+    { "tauNumSelTracks",            kFloat,  kAlways,      0,                               &E::tauNumSelTracks_,     0. },
+    { "muTauPairAbsDz",             kFloat,  kAlways,      0,                               &E::muTauPairAbsDz_,      0. },
+    { "visMass",                    kFloat,  kAlways,      0,                               &E::visMass_,             0. },
+    { "svFitMass",                  kFloat,  kSVfitMass,   0,                               &E::svFitMass_,          -1. },
+    { "Mt",                         kFloat,  kAlways,      0,                               &E::Mt_,                  0. },
+    { "PzetaDiff",                  kFloat,  kAlways,      0,                               &E::PzetaDiff_,           0. },
+    { "pfMEtPt",                    kFloat,  kAlways,      0,                               &E::pfMEtPt_,             0. },
+    { "pfMEtSumEt",                 kFloat,  kAlways,      0,                               &E::pfMEtSumEt_,          0. }
+  };
+
+  const columnDefType* getColumnDefs(size_t& numColumnDefs)
+  {
+    numColumnDefs = sizeof(columnDefs)/sizeof(columnDefType);
+    return columnDefs;
+  }
+}
+
+namespace
+{
+  /// size of column values in units of 32-bit words
+  uint32_t getColumnSize(const TauIdEffMiniTuple::columnDefType& columnDef)
+  {
+    return ( columnDef.type_ == TauIdEffMiniTuple::kDouble ) ? 2 : 1;
+  }
+
+  void encodeColumnValue(const TauIdEffMiniTuple::columnDefType& columnDef, const TauIdEffMiniTupleEntry& entry, std::vector<uint32_t>& buffer)
+  {
+    uint32_t value[2];
+    if ( columnDef.type_ == TauIdEffMiniTuple::kUInt ) {
+      value[0] = entry.*(columnDef.uintMember_);
+    } else if ( columnDef.type_ == TauIdEffMiniTuple::kFloat ) {
+      float value_float = entry.*(columnDef.doubleMember_); // narrow to 32-bit
+      memcpy(value, &value_float, sizeof(float));
+    } else {
+      double value_double = entry.*(columnDef.doubleMember_);
+      memcpy(value, &value_double, sizeof(double));
+    }
+    buffer.insert(buffer.end(), value, value + getColumnSize(columnDef));
+  }
+
+  void decodeColumnValue(const TauIdEffMiniTuple::columnDefType& columnDef, const char* data, TauIdEffMiniTupleEntry& entry)
+  {
+    if ( columnDef.type_ == TauIdEffMiniTuple::kUInt ) {
+      uint32_t value;
+      memcpy(&value, data, sizeof(uint32_t));
+      entry.*(columnDef.uintMember_) = value;
+    } else if ( columnDef.type_ == TauIdEffMiniTuple::kFloat ) {
+      float value;
+      memcpy(&value, data, sizeof(float));
+      entry.*(columnDef.doubleMember_) = value;
+    } else {
+      double value;
+      memcpy(&value, data, sizeof(double));
+      entry.*(columnDef.doubleMember_) = value;
+    }
+  }
+
+  void setDefaultColumnValue(const TauIdEffMiniTuple::columnDefType& columnDef, TauIdEffMiniTupleEntry& entry)
+  {
+    if ( columnDef.type_ == TauIdEffMiniTuple::kUInt ) entry.*(columnDef.uintMember_) = (unsigned)columnDef.defaultValue_;
+    else                                               entry.*(columnDef.doubleMember_) = columnDef.defaultValue_;
+  }
+
+//-------------------------------------------------------------------------------
+//
+// auxiliary functions for writing/reading trailer
+//
+  template <typename T>
+  void writeValue(std::ofstream& outputFile, const T& value)
+  {
+    outputFile.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeString(std::ofstream& outputFile, const std::string& value)
+  {
+    writeValue<uint32_t>(outputFile, value.size());
+    outputFile.write(value.data(), value.size());
+  }
+
+  void writeStrings(std::ofstream& outputFile, const std::vector<std::string>& values)
+  {
+    writeValue<uint32_t>(outputFile, values.size());
+    for ( std::vector<std::string>::const_iterator value = values.begin();
+	  value != values.end(); ++value ) {
+      writeString(outputFile, *value);
+    }
+  }
+
+  struct bufferCursorType
+  {
+    bufferCursorType(const std::string& fileName, const char* data, size_t size, size_t pos)
+      : fileName_(fileName),
+        data_(data),
+        size_(size),
+        pos_(pos)
+    {}
+    void checkSize(size_t numBytes)
+    {
+      if ( (pos_ + numBytes) > size_ )
+        throw cms::Exception("TauIdEffMiniTupleReader")
+	  << "Unexpected end of file = " << fileName_ << " --> file is corrupted !!\n";
+    }
+    template <typename T>
+    T readValue()
+    {
+      checkSize(sizeof(T));
+      T value;
+      memcpy(&value, data_ + pos_, sizeof(T));
+      pos_ += sizeof(T);
+      return value;
+    }
+    std::string readString()
+    {
+      uint32_t length = readValue<uint32_t>();
+      checkSize(length);
+      std::string value(data_ + pos_, length);
+      pos_ += length;
+      return value;
+    }
+    std::vector<std::string> readStrings()
+    {
+      uint32_t numValues = readValue<uint32_t>();
+      std::vector<std::string> values;
+      for ( uint32_t iValue = 0; iValue < numValues; ++iValue ) {
+        values.push_back(readString());
+      }
+      return values;
+    }
+    std::string fileName_;
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+  };
+}
+//-------------------------------------------------------------------------------
+
+TauIdEffMiniTupleWriter::TauIdEffMiniTupleWriter(const std::string& fileName,
+						 const vstring& sysShifts, const vstring& triggerBits, const vstring& tauIdDiscriminators,
+						 bool writeMuonIsoProb, bool writeSVfitMass, bool writeGenMatch, unsigned blockSize)
+  : fileName_(fileName),
+    outputFile_(0),
+    sysShifts_(sysShifts),
+    triggerBits_(triggerBits),
+    tauIdDiscriminators_(tauIdDiscriminators),
+    blockSize_(blockSize),
+    numRowsBuffered_(0)
+{
+  if ( triggerBits_.size() > 32 )
+    throw cms::Exception("TauIdEffMiniTupleWriter")
+      << "Number of trigger bits = " << triggerBits_.size() << " exceeds maximum of 32 !!\n";
+  if ( blockSize_ == 0 )
+    throw cms::Exception("TauIdEffMiniTupleWriter")
+      << "Invalid block size = " << blockSize_ << " !!\n";
+
+  size_t numColumnDefs;
+  const TauIdEffMiniTuple::columnDefType* columnDefs = TauIdEffMiniTuple::getColumnDefs(numColumnDefs);
+  for ( size_t iColumnDef = 0; iColumnDef < numColumnDefs; ++iColumnDef ) {
+    const TauIdEffMiniTuple::columnDefType& columnDef = columnDefs[iColumnDef];
+    if ( (columnDef.group_ == TauIdEffMiniTuple::kMuonIsoProb && !writeMuonIsoProb) ||
+	 (columnDef.group_ == TauIdEffMiniTuple::kSVfitMass   && !writeSVfitMass  ) ||
+	 (columnDef.group_ == TauIdEffMiniTuple::kGenMatch    && !writeGenMatch   ) ) continue;
+    columns_.push_back(&columnDef);
+  }
+  numFixedColumns_ = columns_.size();
+
+  columnBuffers_.resize(numFixedColumns_ + tauIdDiscriminators_.size());
+  for ( size_t iColumn = 0; iColumn < columnBuffers_.size(); ++iColumn ) {
+    uint32_t columnSize = ( iColumn < numFixedColumns_ ) ? getColumnSize(*columns_[iColumn]) : 1;
+    columnBuffers_[iColumn].reserve(columnSize*blockSize_);
+  }
+
+  outputFile_ = new std::ofstream(fileName_.data(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if ( !outputFile_->good() ) {
+    delete outputFile_;
+    outputFile_ = 0;
+    throw cms::Exception("TauIdEffMiniTupleWriter")
+      << "Failed to open outputFile = " << fileName_ << " !!\n";
+  }
+
+//--- write preamble;
+//    offset of trailer gets overwritten once file is closed
+  outputFile_->write(miniTupleMagic, sizeof(miniTupleMagic));
+  writeValue<uint32_t>(*outputFile_, miniTupleVersion);
+  writeValue<uint32_t>(*outputFile_, 0);
+  writeValue<uint64_t>(*outputFile_, 0);
+}
+
+TauIdEffMiniTupleWriter::~TauIdEffMiniTupleWriter()
+{
+  close();
+}
+
+void TauIdEffMiniTupleWriter::fill(const TauIdEffMiniTupleEntry& entry)
+{
+  if ( !outputFile_ )
+    throw cms::Exception("TauIdEffMiniTupleWriter")
+      << "Cannot add entries to outputFile = " << fileName_ << ", which has already been closed !!\n";
+  if ( entry.tauIdDiscriminatorValues_.size() != tauIdDiscriminators_.size() )
+    throw cms::Exception("TauIdEffMiniTupleWriter")
+      << "Number of tau id. discriminator values = " << entry.tauIdDiscriminatorValues_.size() << " does not match"
+      << " number of tau id. discriminators = " << tauIdDiscriminators_.size() << " !!\n";
+
+  for ( size_t iColumn = 0; iColumn < numFixedColumns_; ++iColumn ) {
+    encodeColumnValue(*columns_[iColumn], entry, columnBuffers_[iColumn]);
+  }
+  size_t numTauIdDiscriminators = tauIdDiscriminators_.size();
+  for ( size_t iTauIdDiscriminator = 0; iTauIdDiscriminator < numTauIdDiscriminators; ++iTauIdDiscriminator ) {
+    float value_float = entry.tauIdDiscriminatorValues_[iTauIdDiscriminator]; // narrow to 32-bit
+    uint32_t value;
+    memcpy(&value, &value_float, sizeof(uint32_t));
+    columnBuffers_[numFixedColumns_ + iTauIdDiscriminator].push_back(value);
+  }
+
+  ++numRowsBuffered_;
+  if ( numRowsBuffered_ >= blockSize_ ) writeBlock();
+}
+
+void TauIdEffMiniTupleWriter::setCounter(const std::string& name, double value)
+{
+  counters_[name] = value;
+}
+
+void TauIdEffMiniTupleWriter::writeBlock()
+{
+  if ( numRowsBuffered_ == 0 ) return;
+
+  blockOffsets_.push_back(outputFile_->tellp());
+  blockNumRows_.push_back(numRowsBuffered_);
+
+  writeValue<uint32_t>(*outputFile_, numRowsBuffered_);
+  for ( std::vector<std::vector<uint32_t> >::iterator columnBuffer = columnBuffers_.begin();
+	columnBuffer != columnBuffers_.end(); ++columnBuffer ) {
+    outputFile_->write(reinterpret_cast<const char*>(&columnBuffer->front()), columnBuffer->size()*sizeof(uint32_t));
+    columnBuffer->clear();
+  }
+  numRowsBuffered_ = 0;
+}
+
+void TauIdEffMiniTupleWriter::close()
+{
+  if ( !outputFile_ ) return;
+
+  writeBlock();
+
+  uint64_t trailerOffset = outputFile_->tellp();
+
+  writeValue<uint32_t>(*outputFile_, blockSize_);
+  vstring columnNames;
+  std::vector<uint32_t> columnSizes;
+  for ( std::vector<const TauIdEffMiniTuple::columnDefType*>::const_iterator column = columns_.begin();
+	column != columns_.end(); ++column ) {
+    columnNames.push_back((*column)->name_);
+    columnSizes.push_back(getColumnSize(**column));
+  }
+  for ( vstring::const_iterator tauIdDiscriminator = tauIdDiscriminators_.begin();
+	tauIdDiscriminator != tauIdDiscriminators_.end(); ++tauIdDiscriminator ) {
+    columnNames.push_back(std::string(tauIdDiscriminatorColumnPrefix).append(*tauIdDiscriminator));
+    columnSizes.push_back(1);
+  }
+  writeStrings(*outputFile_, columnNames);
+  for ( std::vector<uint32_t>::const_iterator columnSize = columnSizes.begin();
+	columnSize != columnSizes.end(); ++columnSize ) {
+    writeValue<uint32_t>(*outputFile_, *columnSize);
+  }
+  writeStrings(*outputFile_, sysShifts_);
+  writeStrings(*outputFile_, triggerBits_);
+  writeStrings(*outputFile_, tauIdDiscriminators_);
+  writeValue<uint32_t>(*outputFile_, counters_.size());
+  for ( std::map<std::string, double>::const_iterator counter = counters_.begin();
+	counter != counters_.end(); ++counter ) {
+    writeString(*outputFile_, counter->first);
+    writeValue<double>(*outputFile_, counter->second);
+  }
+  writeValue<uint32_t>(*outputFile_, blockOffsets_.size());
+  for ( size_t iBlock = 0; iBlock < blockOffsets_.size(); ++iBlock ) {
+    writeValue<uint64_t>(*outputFile_, blockOffsets_[iBlock]);
+    writeValue<uint32_t>(*outputFile_, blockNumRows_[iBlock]);
+  }
+
+  outputFile_->seekp(miniTupleTrailerOffsetPosition);
+  writeValue<uint64_t>(*outputFile_, trailerOffset);
+
+  bool isGood = outputFile_->good();
+  outputFile_->close();
+  delete outputFile_;
+  outputFile_ = 0;
+
+  if ( !isGood )
+    throw cms::Exception("TauIdEffMiniTupleWriter")
+      << "Failed to write outputFile = " << fileName_ << " !!\n";
+}
+
+//-------------------------------------------------------------------------------
+
+TauIdEffMiniTupleReader::TauIdEffMiniTupleReader(const std::string& fileName)
+  : fileName_(fileName),
+    fileDescriptor_(-1),
+    data_(0),
+    dataSize_(0),
+    numEntries_(0),
+    blockSize_(0),
+    rowSize_(0)
+{
+  fileDescriptor_ = open(fileName_.data(), O_RDONLY);
+  if ( fileDescriptor_ == -1 )
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "Failed to open inputFile = " << fileName_ << " !!\n";
+
+  struct stat fileStatus;
+  if ( fstat(fileDescriptor_, &fileStatus) == -1 || fileStatus.st_size < (off_t)miniTuplePreambleSize ) {
+    ::close(fileDescriptor_);
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "InputFile = " << fileName_ << " is not a valid mini-tuple !!\n";
+  }
+  dataSize_ = fileStatus.st_size;
+
+  void* data = mmap(0, dataSize_, PROT_READ, MAP_SHARED, fileDescriptor_, 0);
+  if ( data == MAP_FAILED ) {
+    ::close(fileDescriptor_);
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "Failed to map inputFile = " << fileName_ << " into memory !!\n";
+  }
+  data_ = static_cast<const char*>(data);
+  // CV: entries are typically read in sequence
+  madvise(data, dataSize_, MADV_SEQUENTIAL);
+
+//--- release memory mapping and file descriptor in case file turns out to be invalid,
+//    as the destructor does not get called if the constructor throws
+  try {
+    readTrailer();
+  } catch ( ... ) {
+    munmap(data, dataSize_);
+    ::close(fileDescriptor_);
+    throw;
+  }
+}
+
+TauIdEffMiniTupleReader::~TauIdEffMiniTupleReader()
+{
+  munmap(const_cast<char*>(data_), dataSize_);
+  ::close(fileDescriptor_);
+}
+
+void TauIdEffMiniTupleReader::readTrailer()
+{
+//--- check preamble
+  bufferCursorType cursor(fileName_, data_, dataSize_, 0);
+  if ( memcmp(data_, miniTupleMagic, sizeof(miniTupleMagic)) != 0 )
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "InputFile = " << fileName_ << " is not a valid mini-tuple !!\n";
+  cursor.pos_ += sizeof(miniTupleMagic);
+  uint32_t version = cursor.readValue<uint32_t>();
+  if ( version != miniTupleVersion )
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "InputFile = " << fileName_ << " has unsupported version = " << version << " !!\n";
+  cursor.readValue<uint32_t>();
+  uint64_t trailerOffset = cursor.readValue<uint64_t>();
+  if ( trailerOffset == 0 )
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "InputFile = " << fileName_ << " has not been closed properly --> file is corrupted !!\n";
+
+//--- read trailer
+  cursor.pos_ = trailerOffset;
+  blockSize_ = cursor.readValue<uint32_t>();
+  columnNames_ = cursor.readStrings();
+  for ( size_t iColumn = 0; iColumn < columnNames_.size(); ++iColumn ) {
+    uint32_t columnSize = cursor.readValue<uint32_t>();
+    columnSizes_.push_back(columnSize);
+    columnOffsets_.push_back(rowSize_);
+    rowSize_ += columnSize;
+  }
+  sysShifts_ = cursor.readStrings();
+  triggerBits_ = cursor.readStrings();
+  tauIdDiscriminators_ = cursor.readStrings();
+  uint32_t numCounters = cursor.readValue<uint32_t>();
+  for ( uint32_t iCounter = 0; iCounter < numCounters; ++iCounter ) {
+    std::string name = cursor.readString();
+    counters_[name] = cursor.readValue<double>();
+  }
+  uint32_t numBlocks = cursor.readValue<uint32_t>();
+  for ( uint32_t iBlock = 0; iBlock < numBlocks; ++iBlock ) {
+    blockOffsets_.push_back(cursor.readValue<uint64_t>());
+    blockNumRows_.push_back(cursor.readValue<uint32_t>());
+  }
+
+//--- check consistency of blocks
+  for ( uint32_t iBlock = 0; iBlock < numBlocks; ++iBlock ) {
+    if ( (blockNumRows_[iBlock] != blockSize_ && iBlock != (numBlocks - 1)) || blockNumRows_[iBlock] > blockSize_ ||
+	 (blockOffsets_[iBlock] + sizeof(uint32_t) + rowSize_*blockNumRows_[iBlock]*sizeof(uint32_t)) > trailerOffset )
+      throw cms::Exception("TauIdEffMiniTupleReader")
+	<< "Block #" << iBlock << " of inputFile = " << fileName_ << " is corrupted !!\n";
+    numEntries_ += blockNumRows_[iBlock];
+  }
+
+//--- associate columns stored in file to quantities of TauIdEffMiniTupleEntry
+//   (columns unknown to the reader are ignored,
+//    optional columns not stored in the file are set to default values)
+  size_t numColumnDefs;
+  const TauIdEffMiniTuple::columnDefType* columnDefs = TauIdEffMiniTuple::getColumnDefs(numColumnDefs);
+  for ( size_t iColumn = 0; iColumn < columnNames_.size(); ++iColumn ) {
+    const std::string* columnName = &columnNames_[iColumn];
+    const TauIdEffMiniTuple::columnDefType* column = 0;
+    int idxTauIdDiscriminator = -1;
+    if ( columnName->find(tauIdDiscriminatorColumnPrefix) == 0 ) {
+      std::string tauIdDiscriminator = std::string(*columnName, tauIdDiscriminatorColumnPrefix.length());
+      vstring::const_iterator it = std::find(tauIdDiscriminators_.begin(), tauIdDiscriminators_.end(), tauIdDiscriminator);
+      if ( it != tauIdDiscriminators_.end() ) idxTauIdDiscriminator = it - tauIdDiscriminators_.begin();
+    } else {
+      for ( size_t iColumnDef = 0; iColumnDef < numColumnDefs; ++iColumnDef ) {
+	if ( (*columnName) == columnDefs[iColumnDef].name_ ) column = &columnDefs[iColumnDef];
+      }
+    }
+    if ( (column && columnSizes_[iColumn] != getColumnSize(*column)) || (idxTauIdDiscriminator != -1 && columnSizes_[iColumn] != 1) )
+      throw cms::Exception("TauIdEffMiniTupleReader")
+	<< "Column = " << (*columnName) << " of inputFile = " << fileName_ << " has unexpected size = " << columnSizes_[iColumn] << " !!\n";
+    columns_.push_back(column);
+    columnTauIdDiscriminatorIndices_.push_back(idxTauIdDiscriminator);
+  }
+  for ( size_t iColumnDef = 0; iColumnDef < numColumnDefs; ++iColumnDef ) {
+    const TauIdEffMiniTuple::columnDefType& columnDef = columnDefs[iColumnDef];
+    if ( std::find(columns_.begin(), columns_.end(), &columnDef) != columns_.end() ) continue;
+    if ( columnDef.group_ == TauIdEffMiniTuple::kAlways )
+      throw cms::Exception("TauIdEffMiniTupleReader")
+	<< "InputFile = " << fileName_ << " does not contain column = " << columnDef.name_ << " !!\n";
+    missingColumns_.push_back(&columnDef);
+  }
+}
+
+void TauIdEffMiniTupleReader::getEntry(size_t idx, TauIdEffMiniTupleEntry& entry) const
+{
+  if ( idx >= numEntries_ )
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "Invalid entry = " << idx << ", inputFile = " << fileName_ << " contains " << numEntries_ << " entries only !!\n";
+
+  size_t idxBlock = idx / blockSize_;
+  size_t idxRow = idx % blockSize_;
+  size_t numRows = blockNumRows_[idxBlock];
+  const char* blockData = data_ + blockOffsets_[idxBlock] + sizeof(uint32_t);
+
+  entry.tauIdDiscriminatorValues_.resize(tauIdDiscriminators_.size());
+
+  size_t numColumns = columns_.size();
+  for ( size_t iColumn = 0; iColumn < numColumns; ++iColumn ) {
+    const char* value = blockData + (columnOffsets_[iColumn]*numRows + idxRow*columnSizes_[iColumn])*sizeof(uint32_t);
+    if ( columns_[iColumn] ) {
+      decodeColumnValue(*columns_[iColumn], value, entry);
+    } else if ( columnTauIdDiscriminatorIndices_[iColumn] != -1 ) {
+      float value_float;
+      memcpy(&value_float, value, sizeof(float));
+      entry.tauIdDiscriminatorValues_[columnTauIdDiscriminatorIndices_[iColumn]] = value_float;
+    }
+  }
+
+  for ( std::vector<const TauIdEffMiniTuple::columnDefType*>::const_iterator missingColumn = missingColumns_.begin();
+	missingColumn != missingColumns_.end(); ++missingColumn ) {
+    setDefaultColumnValue(**missingColumn, entry);
+  }
+}
+
+size_t TauIdEffMiniTupleReader::readEvent(size_t idx, std::vector<TauIdEffMiniTupleEntry>& entries) const
+{
+  entries.resize(1);
+  getEntry(idx, entries.front());
+  ++idx;
+
+  TauIdEffMiniTupleEntry entry;
+  while ( idx < numEntries_ ) {
+    getEntry(idx, entry);
+    if ( !(entry.run_   == entries.front().run_ &&
+	   entry.ls_    == entries.front().ls_  &&
+	   entry.event_ == entries.front().event_) ) break;
+    entries.push_back(entry);
+    ++idx;
+  }
+
+  return idx;
+}
+
+bool TauIdEffMiniTupleReader::hasColumn(const std::string& name) const
+{
+  return ( std::find(columnNames_.begin(), columnNames_.end(), name) != columnNames_.end() );
+}
+
+double TauIdEffMiniTupleReader::getCounter(const std::string& name) const
+{
+  std::map<std::string, double>::const_iterator counter = counters_.find(name);
+  if ( counter == counters_.end() )
+    throw cms::Exception("TauIdEffMiniTupleReader")
+      << "InputFile = " << fileName_ << " does not contain counter = " << name << " !!\n";
+  return counter->second;
+}
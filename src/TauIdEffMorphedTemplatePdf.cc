@@ -0,0 +1,313 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMorphedTemplatePdf.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TAxis.h>
+#include <TMath.h>
+
+#include <algorithm>
+#include <string>
+#include <assert.h>
+
+namespace
+{
+  std::vector<double> getBinEdges(const TH1* histogram)
+  {
+    const TAxis* xAxis = histogram->GetXaxis();
+    int numBins = xAxis->GetNbins();
+    std::vector<double> binEdges(numBins + 1);
+    for ( int iBin = 1; iBin <= (numBins + 1); ++iBin ) {
+      binEdges[iBin - 1] = xAxis->GetBinLowEdge(iBin);
+    }
+    return binEdges;
+  }
+
+  void normalizeBinContents(std::vector<double>& binContents, const std::string& histogramName)
+  {
+    double integral = 0.;
+    for ( unsigned iBin = 0; iBin < binContents.size(); ++iBin ) {
+      integral += binContents[iBin];
+    }
+    if ( !(integral > 0.) )
+      throw cms::Exception("TauIdEffMorphedTemplatePdf")
+	<< "Template histogram = " << histogramName << " used for vertical morphing is empty !!\n";
+    for ( unsigned iBin = 0; iBin < binContents.size(); ++iBin ) {
+      binContents[iBin] /= integral;
+    }
+  }
+
+  std::vector<double> getCumulativeDistribution(const std::vector<double>& binContents, const std::string& histogramName)
+  {
+    unsigned numBins = binContents.size();
+    std::vector<double> cdf(numBins + 1);
+    cdf[0] = 0.;
+    for ( unsigned iBin = 0; iBin < numBins; ++iBin ) {
+      cdf[iBin + 1] = cdf[iBin] + TMath::Max(0., binContents[iBin]);
+    }
+    double integral = cdf[numBins];
+    if ( !(integral > 0.) )
+      throw cms::Exception("TauIdEffMorphedTemplatePdf")
+	<< "Template histogram = " << histogramName << " used for horizontal morphing is empty !!\n";
+    for ( unsigned iBin = 1; iBin < numBins; ++iBin ) {
+      cdf[iBin] /= integral;
+    }
+    cdf[numBins] = 1.;
+    return cdf;
+  }
+
+  void getQuantiles(const std::vector<double>& cdf, const std::vector<double>& binEdges, double y, double& xLeft, double& xRight)
+  {
+//--- find x-values at which cumulative distribution reaches value y;
+//    in case the cumulative distribution is flat at value y (empty bins),
+//    xLeft and xRight refer to the beginning and end of the flat region
+    std::vector<double>::const_iterator cdfValue = std::lower_bound(cdf.begin(), cdf.end(), y);
+    if ( cdfValue == cdf.end() ) {
+      xLeft = binEdges.back();
+      xRight = binEdges.back();
+      return;
+    }
+    unsigned idx = cdfValue - cdf.begin();
+    if ( (*cdfValue) == y ) {
+      xLeft = binEdges[idx];
+      while ( (idx + 1) < cdf.size() && cdf[idx + 1] == y ) ++idx;
+      xRight = binEdges[idx];
+    } else {
+      assert(idx >= 1);
+      double x = binEdges[idx - 1] + (y - cdf[idx - 1])*(binEdges[idx] - binEdges[idx - 1])/(cdf[idx] - cdf[idx - 1]);
+      xLeft = x;
+      xRight = x;
+    }
+  }
+}
+
+ClassImp(TauIdEffMorphedTemplatePdf)
+
+TauIdEffMorphedTemplatePdf::TauIdEffMorphedTemplatePdf()
+  : mode_(kVerticalMorphing),
+    numBins_(0),
+    isCacheValid_(false)
+{}
+
+TauIdEffMorphedTemplatePdf::TauIdEffMorphedTemplatePdf(const char* name, const char* title, RooAbsReal& x,
+						       const TH1* histogram_central_value,
+						       const std::vector<const TH1*>& histograms_up, const std::vector<const TH1*>& histograms_down,
+						       const RooArgList& alphas)
+  : RooAbsPdf(name, title),
+    x_("x", "x", this, x),
+    alphas_("alphas", "alphas", this),
+    mode_(kVerticalMorphing),
+    isCacheValid_(false)
+{
+  if ( !(histograms_up.size() == (unsigned)alphas.getSize() && histograms_down.size() == (unsigned)alphas.getSize()) )
+    throw cms::Exception("TauIdEffMorphedTemplatePdf")
+      << "Number of 'up' = " << histograms_up.size() << " and 'down' = " << histograms_down.size() << " templates"
+      << " and 'alpha' parameters = " << alphas.getSize() << " not compatible !!\n";
+
+  binEdges_ = getBinEdges(histogram_central_value);
+  numBins_ = binEdges_.size() - 1;
+
+//--- CV: templates are normalized to unit area before computing the differences,
+//        as VerticalInterpPdf interpolates between the normalized pdfs
+  central_ = getBinContents(histogram_central_value);
+  normalizeBinContents(central_, histogram_central_value->GetName());
+  for ( unsigned iShift = 0; iShift < histograms_up.size(); ++iShift ) {
+    std::vector<double> shiftUp = getBinContents(histograms_up[iShift]);
+    normalizeBinContents(shiftUp, histograms_up[iShift]->GetName());
+    std::vector<double> shiftDown = getBinContents(histograms_down[iShift]);
+    normalizeBinContents(shiftDown, histograms_down[iShift]->GetName());
+    for ( unsigned iBin = 0; iBin < numBins_; ++iBin ) {
+      shiftUp[iBin] -= central_[iBin];
+      shiftDown[iBin] = central_[iBin] - shiftDown[iBin];
+    }
+    shiftsUp_.push_back(shiftUp);
+    shiftsDown_.push_back(shiftDown);
+  }
+
+  alphas_.add(alphas);
+  lastAlphas_.resize(alphas_.getSize());
+}
+
+TauIdEffMorphedTemplatePdf::TauIdEffMorphedTemplatePdf(const char* name, const char* title, RooAbsReal& x,
+						       const TH1* histogram_up, const TH1* histogram_down, RooAbsReal& alpha)
+  : RooAbsPdf(name, title),
+    x_("x", "x", this, x),
+    alphas_("alphas", "alphas", this),
+    mode_(kHorizontalMorphing),
+    isCacheValid_(false)
+{
+  binEdges_ = getBinEdges(histogram_up);
+  numBins_ = binEdges_.size() - 1;
+
+  initializeHorizontalMorphing(histogram_up, histogram_down);
+
+  alphas_.add(alpha);
+  lastAlphas_.resize(alphas_.getSize());
+}
+
+TauIdEffMorphedTemplatePdf::TauIdEffMorphedTemplatePdf(const TauIdEffMorphedTemplatePdf& bluePrint, const char* name)
+  : RooAbsPdf(bluePrint, name),
+    x_("x", this, bluePrint.x_),
+    alphas_("alphas", this, bluePrint.alphas_),
+    mode_(bluePrint.mode_),
+    binEdges_(bluePrint.binEdges_),
+    numBins_(bluePrint.numBins_),
+    central_(bluePrint.central_),
+    shiftsUp_(bluePrint.shiftsUp_),
+    shiftsDown_(bluePrint.shiftsDown_),
+    quantileY_(bluePrint.quantileY_),
+    quantileXup_(bluePrint.quantileXup_),
+    quantileXdown_(bluePrint.quantileXdown_),
+    lastAlphas_(bluePrint.lastAlphas_),
+    isCacheValid_(false)
+{}
+
+std::vector<double> TauIdEffMorphedTemplatePdf::getBinContents(const TH1* histogram) const
+{
+  std::vector<double> binEdges = getBinEdges(histogram);
+  bool isCompatible = ( binEdges.size() == binEdges_.size() );
+  for ( unsigned iEdge = 0; iEdge < binEdges.size() && isCompatible; ++iEdge ) {
+    if ( TMath::Abs(binEdges[iEdge] - binEdges_[iEdge]) > 1.e-6*(binEdges_.back() - binEdges_.front()) ) isCompatible = false;
+  }
+  if ( !isCompatible )
+    throw cms::Exception("TauIdEffMorphedTemplatePdf")
+      << "Binning of template histogram = " << histogram->GetName() << " not compatible !!\n";
+
+  std::vector<double> binContents(numBins_);
+  for ( unsigned iBin = 0; iBin < numBins_; ++iBin ) {
+    binContents[iBin] = histogram->GetBinContent(iBin + 1);
+  }
+  return binContents;
+}
+
+void TauIdEffMorphedTemplatePdf::initializeHorizontalMorphing(const TH1* histogram_up, const TH1* histogram_down)
+{
+  std::vector<double> cdfUp = getCumulativeDistribution(getBinContents(histogram_up), histogram_up->GetName());
+  std::vector<double> cdfDown = getCumulativeDistribution(getBinContents(histogram_down), histogram_down->GetName());
+
+//--- the inverse cumulative distributions are piecewise linear in y,
+//    with nodes at the values of either cumulative distribution at the bin edges
+  std::vector<double> yValues(cdfUp);
+  yValues.insert(yValues.end(), cdfDown.begin(), cdfDown.end());
+  std::sort(yValues.begin(), yValues.end());
+  yValues.erase(std::unique(yValues.begin(), yValues.end()), yValues.end());
+
+  for ( std::vector<double>::const_iterator y = yValues.begin();
+	y != yValues.end(); ++y ) {
+    double xUpLeft, xUpRight, xDownLeft, xDownRight;
+    getQuantiles(cdfUp, binEdges_, *y, xUpLeft, xUpRight);
+    getQuantiles(cdfDown, binEdges_, *y, xDownLeft, xDownRight);
+    quantileY_.push_back(*y);
+    quantileXup_.push_back(xUpLeft);
+    quantileXdown_.push_back(xDownLeft);
+    if ( xUpRight != xUpLeft || xDownRight != xDownLeft ) {
+      quantileY_.push_back(*y);
+      quantileXup_.push_back(xUpRight);
+      quantileXdown_.push_back(xDownRight);
+    }
+  }
+}
+
+void TauIdEffMorphedTemplatePdf::updateMorphedBinContents() const
+{
+  morphedBinContents_.resize(numBins_);
+
+  if ( mode_ == kVerticalMorphing ) {
+    for ( unsigned iBin = 0; iBin < numBins_; ++iBin ) {
+      morphedBinContents_[iBin] = central_[iBin];
+    }
+    for ( unsigned iShift = 0; iShift < lastAlphas_.size(); ++iShift ) {
+      double alpha = lastAlphas_[iShift];
+      if ( alpha == 0. ) continue;
+      const std::vector<double>& shift = ( alpha > 0. ) ? shiftsUp_[iShift] : shiftsDown_[iShift];
+      for ( unsigned iBin = 0; iBin < numBins_; ++iBin ) {
+	morphedBinContents_[iBin] += alpha*shift[iBin];
+      }
+    }
+    // CV: same protection against negative values as in VerticalInterpPdf
+    //     (keeps the pdf positive and the logarithm of the likelihood function finite)
+    for ( unsigned iBin = 0; iBin < numBins_; ++iBin ) {
+      if ( !(morphedBinContents_[iBin] > 0.) ) morphedBinContents_[iBin] = 1.e-9;
+    }
+  } else if ( mode_ == kHorizontalMorphing ) {
+    double alpha = lastAlphas_[0];
+    unsigned numQuantiles = quantileY_.size();
+    std::vector<double> xMorphed(numQuantiles);
+    for ( unsigned iQuantile = 0; iQuantile < numQuantiles; ++iQuantile ) {
+      xMorphed[iQuantile] = alpha*quantileXup_[iQuantile] + (1. - alpha)*quantileXdown_[iQuantile];
+    }
+
+//--- compute cumulative distribution of morphed template at bin edges
+//   (bin edges and x-values of quantiles are both sorted in increasing order)
+    unsigned iQuantile = 0;
+    double cdfLast = 0.;
+    for ( unsigned iEdge = 0; iEdge <= numBins_; ++iEdge ) {
+      double binEdge = binEdges_[iEdge];
+      while ( (iQuantile + 1) < numQuantiles && xMorphed[iQuantile + 1] <= binEdge ) ++iQuantile;
+      double cdf = 0.;
+      if      ( binEdge < xMorphed[0]                ) cdf = 0.;
+      else if ( (iQuantile + 1) >= numQuantiles      ) cdf = 1.;
+      else {
+	double y0 = quantileY_[iQuantile];
+	double y1 = quantileY_[iQuantile + 1];
+	cdf = y0 + (binEdge - xMorphed[iQuantile])*(y1 - y0)/(xMorphed[iQuantile + 1] - xMorphed[iQuantile]);
+      }
+      if ( iEdge > 0 ) morphedBinContents_[iEdge - 1] = cdf - cdfLast;
+      cdfLast = cdf;
+    }
+  } else assert(0);
+}
+
+const std::vector<double>& TauIdEffMorphedTemplatePdf::getMorphedBinContents() const
+{
+//--- recompute morphed bin-contents only in case values of morphing parameters have changed
+//   (values of morphing parameters are not stored in ROOT files, initialize them in case pdf has been read from file)
+  if ( lastAlphas_.size() != (unsigned)alphas_.getSize() ) {
+    lastAlphas_.resize(alphas_.getSize());
+    isCacheValid_ = false;
+  }
+  bool isChanged = !isCacheValid_;
+  for ( int iAlpha = 0; iAlpha < alphas_.getSize(); ++iAlpha ) {
+    double alpha = static_cast<RooAbsReal&>(alphas_[iAlpha]).getVal();
+    if ( alpha != lastAlphas_[iAlpha] ) {
+      lastAlphas_[iAlpha] = alpha;
+      isChanged = true;
+    }
+  }
+  if ( isChanged ) {
+    updateMorphedBinContents();
+    isCacheValid_ = true;
+  }
+  return morphedBinContents_;
+}
+
+Double_t TauIdEffMorphedTemplatePdf::evaluate() const
+{
+  double x = x_;
+  if ( x < binEdges_.front() || x > binEdges_.back() ) return 0.;
+  unsigned idxBin = (std::upper_bound(binEdges_.begin(), binEdges_.end(), x) - binEdges_.begin()) - 1;
+  if ( idxBin >= numBins_ ) idxBin = numBins_ - 1;
+  const std::vector<double>& morphedBinContents = getMorphedBinContents();
+  return morphedBinContents[idxBin]/(binEdges_[idxBin + 1] - binEdges_[idxBin]);
+}
+
+Int_t TauIdEffMorphedTemplatePdf::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* rangeName) const
+{
+  if ( matchArgs(allVars, analVars, x_) ) return 1;
+  return 0;
+}
+
+Double_t TauIdEffMorphedTemplatePdf::analyticalIntegral(Int_t code, const char* rangeName) const
+{
+  assert(code == 1);
+  double xMin = x_.min(rangeName);
+  double xMax = x_.max(rangeName);
+  const std::vector<double>& morphedBinContents = getMorphedBinContents();
+  double integral = 0.;
+  for ( unsigned iBin = 0; iBin < numBins_; ++iBin ) {
+    double binLowEdge = binEdges_[iBin];
+    double binUpEdge = binEdges_[iBin + 1];
+    double overlap = TMath::Min(xMax, binUpEdge) - TMath::Max(xMin, binLowEdge);
+    if ( overlap > 0. ) integral += morphedBinContents[iBin]*overlap/(binUpEdge - binLowEdge);
+  }
+  return integral;
+}
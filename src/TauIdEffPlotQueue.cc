@@ -0,0 +1,177 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffPlotQueue.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TDirectory.h>
+#include <TObjString.h>
+#include <TString.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+TauIdEffPlotQueue::TauIdEffPlotQueue(unsigned numWorkers, const std::string& plotInputFileName)
+  : numWorkers_(numWorkers),
+    plotInputFileName_(plotInputFileName),
+    plotInputFile_(0),
+    numPlots_(0),
+    numPlotsFailed_(0)
+{}
+
+TauIdEffPlotQueue::~TauIdEffPlotQueue()
+{
+  finish();
+}
+
+void TauIdEffPlotQueue::addPlot(TCanvas* canvas, const std::vector<std::string>& outputFileNames)
+{
+  ++numPlots_;
+
+  if ( isDeferred() ) {
+    writePlot(canvas, outputFileNames);
+    return;
+  }
+
+  if ( numWorkers_ == 0 ) {
+    printCanvas(canvas, outputFileNames);
+    return;
+  }
+
+  while ( runningWorkers_.size() >= numWorkers_ ) {
+    waitForWorker();
+  }
+
+//--- CV: flush output buffers before forking,
+//        to avoid output of main process getting printed again by worker process
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(0);
+
+  pid_t pid = fork();
+  if ( pid < 0 ) {
+//--- CV: print canvas in calling process in case no worker process can be started
+    std::cerr << "Warning in <TauIdEffPlotQueue::addPlot>: failed to start worker process, errno = " << errno
+	      << " --> printing plot directly !!" << std::endl;
+    printCanvas(canvas, outputFileNames);
+    return;
+  } else if ( pid == 0 ) {
+    int exitStatus = 0;
+    try {
+      printCanvas(canvas, outputFileNames);
+    } catch ( cms::Exception& e ) {
+      std::cerr << e.what() << std::endl;
+      exitStatus = 1;
+    } catch ( std::exception& e ) {
+      std::cerr << e.what() << std::endl;
+      exitStatus = 1;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(0);
+//--- CV: use _exit, in order not to run destructors of objects owned by main process
+    _exit(exitStatus);
+  }
+  runningWorkers_[pid] = ( outputFileNames.size() > 0 ) ? outputFileNames.front() : "";
+}
+
+void TauIdEffPlotQueue::waitForWorker()
+{
+//--- CV: wait only for the worker processes started by this queue, never call waitpid(-1, ...):
+//        other child processes of the calling process (e.g. the workers of another queue
+//        or the fit jobs of fitTauIdEff) must not be reaped here, as their exit status would get lost
+  while ( !runningWorkers_.empty() ) {
+    for ( std::map<pid_t, std::string>::iterator worker = runningWorkers_.begin();
+	  worker != runningWorkers_.end(); ++worker ) {
+      int status = 0;
+      pid_t pid = waitpid(worker->first, &status, WNOHANG);
+      if ( pid == 0 ) continue; // CV: worker process still running
+      if ( pid < 0 ) {
+	if ( errno == EINTR ) continue;
+	std::cerr << "Warning in <TauIdEffPlotQueue::waitForWorker>: failed to wait for worker process for plot = " << worker->second << ","
+		  << " errno = " << errno << " --> assuming plot to be finished !!" << std::endl;
+      } else if ( !(WIFEXITED(status) && WEXITSTATUS(status) == 0) ) {
+	std::cerr << "Worker process for plot = " << worker->second << " failed (status = " << status << ") !!" << std::endl;
+	++numPlotsFailed_;
+      }
+      runningWorkers_.erase(worker);
+      return;
+    }
+    usleep(10000);
+  }
+}
+
+unsigned TauIdEffPlotQueue::finish()
+{
+  while ( !runningWorkers_.empty() ) {
+    waitForWorker();
+  }
+
+  if ( plotInputFile_ ) {
+    std::cout << "<TauIdEffPlotQueue::finish>: stored " << numPlots_ << " plot(s) in file = " << plotInputFileName_ << ","
+	      << " run renderTauIdEffPlots to render them." << std::endl;
+    delete plotInputFile_;
+    plotInputFile_ = 0;
+  }
+
+  return numPlotsFailed_;
+}
+
+void TauIdEffPlotQueue::writePlot(TCanvas* canvas, const std::vector<std::string>& outputFileNames)
+{
+  TDirectory* currentDirectory = gDirectory;
+
+  if ( !plotInputFile_ ) {
+    plotInputFile_ = new TFile(plotInputFileName_.data(), "RECREATE");
+    if ( plotInputFile_->IsZombie() )
+      throw cms::Exception("TauIdEffPlotQueue")
+	<< "Failed to create file = " << plotInputFileName_ << " for storing plots !!\n";
+  }
+
+//--- CV: store canvas together with names of files into which it is to be printed;
+//        both are stored under keys with unique names, as the same canvas may be passed multiple times
+  std::string plotName = Form("plot%u", numPlots_);
+  plotInputFile_->WriteTObject(canvas, plotName.data());
+
+  std::string outputFileNames_string;
+  for ( std::vector<std::string>::const_iterator outputFileName = outputFileNames.begin();
+	outputFileName != outputFileNames.end(); ++outputFileName ) {
+    if ( outputFileName != outputFileNames.begin() ) outputFileNames_string.append("\n");
+    outputFileNames_string.append(*outputFileName);
+  }
+  TObjString outputFileNames_object(outputFileNames_string.data());
+  plotInputFile_->WriteTObject(&outputFileNames_object, std::string(plotName).append(outputFileNamesSuffix()).data());
+
+  if ( currentDirectory ) currentDirectory->cd();
+}
+
+std::vector<std::string> TauIdEffPlotQueue::getOutputFileNames(const std::string& outputFileName, const std::string& fileExtensions)
+{
+  std::vector<std::string> retVal;
+
+  size_t idx = outputFileName.find_last_of('.');
+  std::string outputFileName_plot = std::string(outputFileName, 0, idx);
+  if ( idx != std::string::npos ) retVal.push_back(outputFileName);
+
+  std::istringstream fileExtensions_stream(fileExtensions);
+  std::string fileExtension;
+  while ( fileExtensions_stream >> fileExtension ) {
+    std::string outputFileName_i = std::string(outputFileName_plot).append(fileExtension);
+    // CV: skip file type in case it is the same as given by extension of outputFileName
+    if ( idx != std::string::npos && outputFileName_i == outputFileName ) continue;
+    retVal.push_back(outputFileName_i);
+  }
+
+  return retVal;
+}
+
+void TauIdEffPlotQueue::printCanvas(TCanvas* canvas, const std::vector<std::string>& outputFileNames)
+{
+  for ( std::vector<std::string>::const_iterator outputFileName = outputFileNames.begin();
+	outputFileName != outputFileNames.end(); ++outputFileName ) {
+    canvas->Print(outputFileName->data());
+  }
+}
@@ -0,0 +1,391 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffResultCache.h"
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TFile.h>
+#include <TList.h>
+#include <TMD5.h>
+#include <TMath.h>
+#include <TObjString.h>
+#include <TSystem.h>
+#include <TTree.h>
+#include <TUUID.h>
+#include <TString.h>
+
+#include <iostream>
+#include <algorithm>
+
+#include <unistd.h>
+
+// version of cache file format;
+// to be increased whenever the content of cache files changes
+const std::string resultCacheVersion = "3";
+
+const std::string resultCacheCounterHistogramName = "resultCacheCounters";
+const std::string resultCacheLumiBlockTreeName = "resultCacheLumiBlocks";
+
+namespace
+{
+  std::string getFileIdentity(const std::string& fileName)
+  {
+    std::string fileName_local = fileName;
+    if ( fileName_local.find("file:") == 0 ) fileName_local = std::string(fileName_local, 5);
+
+//--- use size and modification time in case file is accessible via local file-system
+    FileStat_t fileStat;
+    if ( gSystem->GetPathInfo(fileName_local.data(), fileStat) == 0 ) {
+      return std::string(Form("%s:%lld:%ld", fileName.data(), (long long)fileStat.fSize, (long)fileStat.fMtime));
+    }
+
+//--- use ROOT file UUID otherwise
+//   (file is opened, but no event is read)
+    TFile* file = TFile::Open(fileName.data());
+    if ( !file || file->IsZombie() )
+      throw cms::Exception("TauIdEffResultCache")
+	<< "Failed to determine identity of file = " << fileName << " !!\n";
+    std::string fileIdentity = Form("%s:%lld:%s", fileName.data(), (long long)file->GetSize(), file->GetUUID().AsString());
+    delete file;
+    return fileIdentity;
+  }
+
+  std::string getMD5digest(const std::string& value)
+  {
+    TMD5 md5;
+    md5.Update((const UChar_t*)value.data(), value.length());
+    md5.Final();
+    return md5.AsString();
+  }
+
+  TDirectory* getSubdirectory(TDirectory* dir, const std::string& path)
+  {
+    TDirectory* subdir = dir;
+    size_t pos = 0;
+    while ( pos < path.length() ) {
+      size_t idx = path.find("/", pos);
+      if ( idx == std::string::npos ) idx = path.length();
+      std::string subdirName = std::string(path, pos, idx - pos);
+      if ( subdirName != "" ) {
+	TDirectory* subdir_next = dynamic_cast<TDirectory*>(subdir->Get(subdirName.data()));
+	if ( !subdir_next ) subdir_next = subdir->mkdir(subdirName.data());
+	subdir = subdir_next;
+      }
+      pos = idx + 1;
+    }
+    return subdir;
+  }
+}
+
+TauIdEffResultCache::TauIdEffResultCache(const std::string& cacheDirectory, const std::string& configDigest, TDirectory* outputDirectory)
+  : cacheDirectory_(cacheDirectory),
+    configDigest_(configDigest),
+    numFilesLoaded_(0),
+    numFilesStored_(0)
+{
+  if ( gSystem->AccessPathName(cacheDirectory_.data()) ) { // CV: returns true in case path does **not** exist
+    if ( gSystem->mkdir(cacheDirectory_.data(), true) != 0 )
+      throw cms::Exception("TauIdEffResultCache")
+	<< "Failed to create cache directory = " << cacheDirectory_ << " !!\n";
+  }
+
+  if ( !outputDirectory )
+    throw cms::Exception("TauIdEffResultCache")
+      << "No output directory given !!\n";
+  collectHistograms(outputDirectory, "");
+
+//--- CV: refuse to cache results in case no histograms have been found,
+//        as cache files would then only contain the event counters
+  if ( histograms_.size() == 0 )
+    throw cms::Exception("TauIdEffResultCache")
+      << "No histograms found in output directory = " << outputDirectory->GetPath() << ","
+      << " histograms need to be booked before the cache is created !!\n";
+}
+
+TauIdEffResultCache::~TauIdEffResultCache()
+{
+  for ( std::vector<histogramEntryType>::iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    delete histogramEntry->histogramSum_;
+  }
+}
+
+void TauIdEffResultCache::addHistogram(TH1* histogram, const std::string& path)
+{
+  histogramEntryType histogramEntry;
+  histogramEntry.path_ = path;
+  histogramEntry.name_ = histogram->GetName();
+  histogramEntry.histogram_ = histogram;
+//--- sum over all input files starts from current content of histogram
+//   (e.g. number of events given in configuration file)
+  std::string histogramSumName = std::string(histogram->GetName()).append("_resultCacheSum");
+  histogramEntry.histogramSum_ = (TH1*)histogram->Clone(histogramSumName.data());
+  histogramEntry.histogramSum_->SetDirectory(0);
+  histograms_.push_back(histogramEntry);
+}
+
+void TauIdEffResultCache::collectHistograms(TDirectory* dir, const std::string& path)
+{
+  TIter next(dir->GetList());
+  while ( TObject* obj = next() ) {
+    if ( TH1* histogram = dynamic_cast<TH1*>(obj) ) {
+      addHistogram(histogram, path);
+    } else if ( TauIdEffHistogramBundle* bundle = dynamic_cast<TauIdEffHistogramBundle*>(obj) ) {
+//--- CV: histograms registered with bundles are not attached to any directory,
+//        collect them via the bundle (same as in TauIdEffCheckpoint)
+      for ( unsigned idx = 0; idx < bundle->getNumHistograms(); ++idx ) {
+	TH1* histogram = bundle->getRegisteredHistogram(idx);
+	if ( histogram ) addHistogram(histogram, path);
+      }
+    } else if ( TDirectory* subdir = dynamic_cast<TDirectory*>(obj) ) {
+      collectHistograms(subdir, std::string(path).append(subdir->GetName()).append("/"));
+    }
+  }
+}
+
+void TauIdEffResultCache::addCounter(const std::string& name, int* counter)
+{
+  counterEntryType counterEntry;
+  counterEntry.name_ = name;
+  counterEntry.intCounter_ = counter;
+  counterEntry.doubleCounter_ = 0;
+  counterEntry.sum_ = (*counter);
+  counters_.push_back(counterEntry);
+}
+
+void TauIdEffResultCache::addCounter(const std::string& name, double* counter)
+{
+  counterEntryType counterEntry;
+  counterEntry.name_ = name;
+  counterEntry.intCounter_ = 0;
+  counterEntry.doubleCounter_ = counter;
+  counterEntry.sum_ = (*counter);
+  counters_.push_back(counterEntry);
+}
+
+void TauIdEffResultCache::addLumiBlockCounter(const std::string& name, double* counter)
+{
+  lumiBlockCounterIndices_.push_back(counters_.size());
+  addCounter(name, counter);
+}
+
+void TauIdEffResultCache::addLumiBlock(unsigned run, unsigned ls, const std::vector<double>& increments)
+{
+  if ( increments.size() != lumiBlockCounterIndices_.size() )
+    throw cms::Exception("TauIdEffResultCache")
+      << "Number of increments = " << increments.size() << " given for run = " << run << ", ls = " << ls 
+      << " does not match number of counters = " << lumiBlockCounterIndices_.size() << " registered per luminosity section !!\n";
+  lumiBlockEntryType lumiBlockEntry;
+  lumiBlockEntry.run_ = run;
+  lumiBlockEntry.ls_ = ls;
+  lumiBlockEntry.increments_ = increments;
+  currentLumiBlocks_.push_back(lumiBlockEntry);
+}
+
+void TauIdEffResultCache::subtractDuplicateLumiBlocks(const std::vector<lumiBlockEntryType>& lumiBlocks)
+{
+  for ( std::vector<lumiBlockEntryType>::const_iterator lumiBlockEntry = lumiBlocks.begin();
+	lumiBlockEntry != lumiBlocks.end(); ++lumiBlockEntry ) {
+    if ( countedLumiBlocks_.insert(lumiBlockType(lumiBlockEntry->run_, lumiBlockEntry->ls_)).second ) continue;
+    for ( size_t idxCounter = 0; idxCounter < lumiBlockCounterIndices_.size(); ++idxCounter ) {
+      counters_[lumiBlockCounterIndices_[idxCounter]].sum_ -= lumiBlockEntry->increments_[idxCounter];
+    }
+  }
+}
+
+std::string TauIdEffResultCache::getCacheFileName(const std::string& inputFileName) const
+{
+  std::string cacheKey = getFileIdentity(inputFileName);
+  cacheKey.append("\n").append(configDigest_);
+  cacheKey.append("\n").append(resultCacheVersion);
+  return std::string(cacheDirectory_).append("/").append(getMD5digest(cacheKey)).append(".root");
+}
+
+bool TauIdEffResultCache::load(const std::string& inputFileName)
+{
+  std::string cacheFileName = getCacheFileName(inputFileName);
+  if ( gSystem->AccessPathName(cacheFileName.data()) ) return false;
+
+  TFile* cacheFile = TFile::Open(cacheFileName.data());
+  if ( !cacheFile || cacheFile->IsZombie() ) {
+    std::cerr << "Warning: Failed to open cache file = " << cacheFileName << " --> ignoring cache file !!" << std::endl;
+    delete cacheFile;
+    return false;
+  }
+
+//--- retrieve all histograms and counters first,
+//    in order to leave sums over input files unchanged in case cache file is incomplete
+  std::vector<TH1*> cachedHistograms;
+  for ( std::vector<histogramEntryType>::const_iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    std::string histogramName = std::string(histogramEntry->path_).append(histogramEntry->name_);
+    TH1* cachedHistogram = dynamic_cast<TH1*>(cacheFile->Get(histogramName.data()));
+    if ( !cachedHistogram ) {
+      std::cerr << "Warning: Failed to find histogram = " << histogramName << " in cache file = " << cacheFileName
+		<< " --> ignoring cache file !!" << std::endl;
+      delete cacheFile;
+      return false;
+    }
+    cachedHistograms.push_back(cachedHistogram);
+  }
+
+  TH1* cachedCounters = dynamic_cast<TH1*>(cacheFile->Get(resultCacheCounterHistogramName.data()));
+  bool isValidCounters = ( cachedCounters && cachedCounters->GetNbinsX() == TMath::Max(1, (int)counters_.size()) );
+  for ( size_t idxCounter = 0; idxCounter < counters_.size() && isValidCounters; ++idxCounter ) {
+    if ( counters_[idxCounter].name_ != cachedCounters->GetXaxis()->GetBinLabel(idxCounter + 1) ) isValidCounters = false;
+  }
+  if ( !isValidCounters ) {
+    std::cerr << "Warning: Event counters stored in cache file = " << cacheFileName << " do not match"
+	      << " --> ignoring cache file !!" << std::endl;
+    delete cacheFile;
+    return false;
+  }
+
+  std::vector<lumiBlockEntryType> cachedLumiBlocks;
+  TTree* cachedLumiBlockTree = dynamic_cast<TTree*>(cacheFile->Get(resultCacheLumiBlockTreeName.data()));
+  bool isValidLumiBlocks = ( cachedLumiBlockTree && cachedLumiBlockTree->GetBranch("run") && cachedLumiBlockTree->GetBranch("ls") );
+  for ( size_t idxCounter = 0; idxCounter < lumiBlockCounterIndices_.size() && isValidLumiBlocks; ++idxCounter ) {
+    if ( !cachedLumiBlockTree->GetBranch(counters_[lumiBlockCounterIndices_[idxCounter]].name_.data()) ) isValidLumiBlocks = false;
+  }
+  if ( !isValidLumiBlocks ) {
+    std::cerr << "Warning: Failed to find luminosity sections in cache file = " << cacheFileName
+	      << " --> ignoring cache file !!" << std::endl;
+    delete cacheFile;
+    return false;
+  }
+  UInt_t run, ls;
+  cachedLumiBlockTree->SetBranchAddress("run", &run);
+  cachedLumiBlockTree->SetBranchAddress("ls", &ls);
+  std::vector<Double_t> increments(lumiBlockCounterIndices_.size());
+  for ( size_t idxCounter = 0; idxCounter < lumiBlockCounterIndices_.size(); ++idxCounter ) {
+    cachedLumiBlockTree->SetBranchAddress(counters_[lumiBlockCounterIndices_[idxCounter]].name_.data(), &increments[idxCounter]);
+  }
+  Long64_t numLumiBlocks = cachedLumiBlockTree->GetEntries();
+  for ( Long64_t idxLumiBlock = 0; idxLumiBlock < numLumiBlocks; ++idxLumiBlock ) {
+    cachedLumiBlockTree->GetEntry(idxLumiBlock);
+    lumiBlockEntryType lumiBlockEntry;
+    lumiBlockEntry.run_ = run;
+    lumiBlockEntry.ls_ = ls;
+    lumiBlockEntry.increments_.assign(increments.begin(), increments.end());
+    cachedLumiBlocks.push_back(lumiBlockEntry);
+  }
+
+  for ( size_t idxHistogram = 0; idxHistogram < histograms_.size(); ++idxHistogram ) {
+    histograms_[idxHistogram].histogramSum_->Add(cachedHistograms[idxHistogram]);
+  }
+  for ( size_t idxCounter = 0; idxCounter < counters_.size(); ++idxCounter ) {
+    counters_[idxCounter].sum_ += cachedCounters->GetBinContent(idxCounter + 1);
+  }
+  subtractDuplicateLumiBlocks(cachedLumiBlocks);
+
+  delete cacheFile;
+
+  ++numFilesLoaded_;
+
+  return true;
+}
+
+void TauIdEffResultCache::beginFile()
+{
+  for ( std::vector<histogramEntryType>::iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    histogramEntry->histogram_->Reset();
+  }
+  for ( std::vector<counterEntryType>::iterator counterEntry = counters_.begin();
+	counterEntry != counters_.end(); ++counterEntry ) {
+    if ( counterEntry->intCounter_    ) (*counterEntry->intCounter_)    = 0;
+    if ( counterEntry->doubleCounter_ ) (*counterEntry->doubleCounter_) = 0.;
+  }
+  currentLumiBlocks_.clear();
+}
+
+void TauIdEffResultCache::endFile(const std::string& inputFileName)
+{
+  std::string cacheFileName = getCacheFileName(inputFileName);
+
+//--- write cache file under temporary name first and rename it when complete,
+//    so that no incomplete cache files are left behind in case job gets killed
+//   (and in order to support multiple jobs sharing the same cache directory)
+  std::string cacheFileName_tmp = std::string(cacheFileName).append(Form(".tmp%i", (int)getpid()));
+
+  TDirectory* currentDirectory = gDirectory;
+
+  TFile* cacheFile = TFile::Open(cacheFileName_tmp.data(), "RECREATE");
+  if ( !cacheFile || cacheFile->IsZombie() )
+    throw cms::Exception("TauIdEffResultCache")
+      << "Failed to create cache file = " << cacheFileName_tmp << " !!\n";
+
+  for ( std::vector<histogramEntryType>::const_iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    TDirectory* dir = getSubdirectory(cacheFile, histogramEntry->path_);
+    dir->WriteTObject(histogramEntry->histogram_, histogramEntry->name_.data());
+  }
+
+  cacheFile->cd();
+  int numCounters = counters_.size();
+  TH1* cachedCounters = new TH1D(resultCacheCounterHistogramName.data(), resultCacheCounterHistogramName.data(),
+				 TMath::Max(1, numCounters), -0.5, TMath::Max(1, numCounters) - 0.5);
+  for ( int idxCounter = 0; idxCounter < numCounters; ++idxCounter ) {
+    const counterEntryType& counterEntry = counters_[idxCounter];
+    cachedCounters->GetXaxis()->SetBinLabel(idxCounter + 1, counterEntry.name_.data());
+    double value = ( counterEntry.intCounter_ ) ? (*counterEntry.intCounter_) : (*counterEntry.doubleCounter_);
+    cachedCounters->SetBinContent(idxCounter + 1, value);
+  }
+  cacheFile->WriteTObject(cachedCounters);
+  TTree* cachedLumiBlockTree = new TTree(resultCacheLumiBlockTreeName.data(), resultCacheLumiBlockTreeName.data());
+  UInt_t run, ls;
+  cachedLumiBlockTree->Branch("run", &run, "run/i");
+  cachedLumiBlockTree->Branch("ls", &ls, "ls/i");
+  std::vector<Double_t> increments(lumiBlockCounterIndices_.size());
+  for ( size_t idxCounter = 0; idxCounter < lumiBlockCounterIndices_.size(); ++idxCounter ) {
+    const std::string& counterName = counters_[lumiBlockCounterIndices_[idxCounter]].name_;
+    cachedLumiBlockTree->Branch(counterName.data(), &increments[idxCounter], std::string(counterName).append("/D").data());
+  }
+  for ( std::vector<lumiBlockEntryType>::const_iterator lumiBlockEntry = currentLumiBlocks_.begin();
+	lumiBlockEntry != currentLumiBlocks_.end(); ++lumiBlockEntry ) {
+    run = lumiBlockEntry->run_;
+    ls = lumiBlockEntry->ls_;
+    std::copy(lumiBlockEntry->increments_.begin(), lumiBlockEntry->increments_.end(), increments.begin());
+    cachedLumiBlockTree->Fill();
+  }
+  cacheFile->WriteTObject(cachedLumiBlockTree);
+  TObjString inputFileName_string(inputFileName.data());
+  cacheFile->WriteTObject(&inputFileName_string, "inputFileName");
+  TObjString configDigest_string(configDigest_.data());
+  cacheFile->WriteTObject(&configDigest_string, "configDigest");
+
+  delete cacheFile;
+
+  if ( currentDirectory ) currentDirectory->cd();
+
+  if ( gSystem->Rename(cacheFileName_tmp.data(), cacheFileName.data()) != 0 )
+    throw cms::Exception("TauIdEffResultCache")
+      << "Failed to rename cache file = " << cacheFileName_tmp << " to " << cacheFileName << " !!\n";
+
+//--- add histograms and counters to sums over all input files
+  for ( std::vector<histogramEntryType>::iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    histogramEntry->histogramSum_->Add(histogramEntry->histogram_);
+  }
+  for ( std::vector<counterEntryType>::iterator counterEntry = counters_.begin();
+	counterEntry != counters_.end(); ++counterEntry ) {
+    counterEntry->sum_ += ( counterEntry->intCounter_ ) ? (*counterEntry->intCounter_) : (*counterEntry->doubleCounter_);
+  }
+  subtractDuplicateLumiBlocks(currentLumiBlocks_);
+
+  ++numFilesStored_;
+}
+
+void TauIdEffResultCache::finish()
+{
+  for ( std::vector<histogramEntryType>::iterator histogramEntry = histograms_.begin();
+	histogramEntry != histograms_.end(); ++histogramEntry ) {
+    histogramEntry->histogram_->Reset();
+    histogramEntry->histogram_->Add(histogramEntry->histogramSum_);
+  }
+  for ( std::vector<counterEntryType>::iterator counterEntry = counters_.begin();
+	counterEntry != counters_.end(); ++counterEntry ) {
+    if ( counterEntry->intCounter_    ) (*counterEntry->intCounter_)    = TMath::Nint(counterEntry->sum_);
+    if ( counterEntry->doubleCounter_ ) (*counterEntry->doubleCounter_) = counterEntry->sum_;
+  }
+}
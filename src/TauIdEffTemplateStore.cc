@@ -0,0 +1,17 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffTemplateStore.h"
+
+unsigned TauIdEffKeyIndex::intern(const std::string& key)
+{
+  indexMapType::const_iterator idx = indices_.find(key);
+  if ( idx != indices_.end() ) return idx->second;
+  unsigned retVal = keys_.size();
+  indices_.insert(std::pair<std::string, unsigned>(key, retVal));
+  keys_.push_back(key);
+  return retVal;
+}
+
+int TauIdEffKeyIndex::find(const std::string& key) const
+{
+  indexMapType::const_iterator idx = indices_.find(key);
+  return ( idx != indices_.end() ) ? (int)idx->second : -1;
+}
@@ -0,0 +1,145 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TriggerPrescaleProbabilityCache.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/CandidateTools/interface/generalAuxFunctions.h"
+
+#include <iostream>
+
+TriggerPrescaleProbabilityCache::TriggerPrescaleProbabilityCache(const vstring& hltPaths, int verbosity)
+  : hltPaths_(hltPaths),
+    currentLumiSection_(0, 0),
+    currentLumiSectionEntry_(0),
+    verbosity_(verbosity)
+{}
+
+TriggerPrescaleProbabilityCache::~TriggerPrescaleProbabilityCache()
+{
+// nothing to be done yet...
+}
+
+void TriggerPrescaleProbabilityCache::buildLumiSectionEntry(const pat::TriggerEvent& hltEvent, hltPathEntryCollection& hltPathEntries)
+{
+  const pat::TriggerPathCollection* paths = hltEvent.paths();
+  const pat::TriggerAlgorithmCollection* algorithms = hltEvent.algorithms();
+
+  for ( vstring::const_iterator hltPathName = hltPaths_.begin();
+	hltPathName != hltPaths_.end(); ++hltPathName ) {
+    hltPathEntryType hltPathEntry;
+    hltPathEntry.name_ = (*hltPathName);
+    hltPathEntry.isWildcard_ = ( (*hltPathName) == "*" ); // check for wildcard character "*" that accepts all events
+    hltPathEntry.idxPath_ = -1;
+    hltPathEntry.hltPrescale_ = 1.;
+
+    if ( !hltPathEntry.isWildcard_ ) {
+      const pat::TriggerPath* hltPath = hltEvent.path(*hltPathName);
+      if ( hltPath && paths ) {
+	hltPathEntry.idxPath_ = hltPath - &paths->front();
+	unsigned hltPrescale = hltPath->prescale();
+	if ( hltPrescale < 1 ) hltPrescale = 1;
+	hltPathEntry.hltPrescale_ = hltPrescale;
+	if ( verbosity_ ) std::cout << "HLT path = " << hltPath->name() << ": prescale = " << hltPrescale << std::endl;
+
+	const pat::L1SeedCollection& l1Seeds = hltPath->l1Seeds();
+	for ( pat::L1SeedCollection::const_iterator l1Seed_status = l1Seeds.begin();
+	      l1Seed_status != l1Seeds.end(); ++l1Seed_status ) {
+	  const std::string& l1SeedName = l1Seed_status->second;
+	  if ( verbosity_ ) std::cout << "l1SeedName = " << l1SeedName << std::endl;
+	  const pat::TriggerAlgorithm* l1Seed = hltEvent.algorithm(l1SeedName);
+	  if ( !(l1Seed && algorithms) ) {
+	    if ( verbosity_ ) {
+	      std::cout << "Failed to access L1 seed = " << l1SeedName << ","
+			<< " needed for HLT path = " << hltPath->name() << " !!" << std::endl;
+	      if ( algorithms ) {
+		vstring l1SeedNames;
+		for ( pat::TriggerAlgorithmCollection::const_iterator algorithm = algorithms->begin();
+		      algorithm != algorithms->end(); ++algorithm ) {
+		  l1SeedNames.push_back(algorithm->name());
+		}
+		std::cout << "Available L1 seeds = " << format_vstring(l1SeedNames) << std::endl;
+	      } else {
+		std::cout << "No L1 seeds available in pat::TriggerEvent !!" << std::endl;
+	      }
+	    }
+	    continue;
+	  }
+	  l1SeedEntryType l1SeedEntry;
+	  l1SeedEntry.name_ = l1SeedName;
+	  l1SeedEntry.idxAlgorithm_ = l1Seed - &algorithms->front();
+	  unsigned l1Prescale = l1Seed->prescale();
+	  if ( l1Prescale < 1 ) l1Prescale = 1;
+	  if ( verbosity_ ) std::cout << " L1 seed = " << l1Seed->name() << ": prescale = " << l1Prescale << std::endl;
+	  l1SeedEntry.probFailedL1Prescale_ = ( l1Prescale <= 1 ) ? 0. : (1. - 1./l1Prescale);
+	  hltPathEntry.l1Seeds_.push_back(l1SeedEntry);
+	}
+      }
+    }
+
+    hltPathEntries.push_back(hltPathEntry);
+  }
+}
+
+const pat::TriggerPath* TriggerPrescaleProbabilityCache::getPath(const pat::TriggerEvent& hltEvent, const hltPathEntryType& hltPathEntry)
+{
+  const pat::TriggerPathCollection* paths = hltEvent.paths();
+  if ( paths && hltPathEntry.idxPath_ < (int)paths->size() ) {
+    const pat::TriggerPath& hltPath = (*paths)[hltPathEntry.idxPath_];
+    if ( hltPath.name() == hltPathEntry.name_ ) return &hltPath;
+  }
+  return hltEvent.path(hltPathEntry.name_);
+}
+
+const pat::TriggerAlgorithm* TriggerPrescaleProbabilityCache::getAlgorithm(const pat::TriggerEvent& hltEvent, const l1SeedEntryType& l1SeedEntry)
+{
+  const pat::TriggerAlgorithmCollection* algorithms = hltEvent.algorithms();
+  if ( algorithms && l1SeedEntry.idxAlgorithm_ < (int)algorithms->size() ) {
+    const pat::TriggerAlgorithm& l1Seed = (*algorithms)[l1SeedEntry.idxAlgorithm_];
+    if ( l1Seed.name() == l1SeedEntry.name_ ) return &l1Seed;
+  }
+  return hltEvent.algorithm(l1SeedEntry.name_);
+}
+
+bool TriggerPrescaleProbabilityCache::operator()(edm::RunNumber_t run, edm::LuminosityBlockNumber_t ls,
+						 const pat::TriggerEvent& hltEvent, double& probFailedPrescale)
+{
+//--- check if new luminosity section has started;
+//    if so, retrieve prescales from cache or look them up
+  lumiSectionIdType lumiSection(run, ls);
+  if ( !currentLumiSectionEntry_ || lumiSection != currentLumiSection_ ) {
+    std::map<lumiSectionIdType, hltPathEntryCollection>::iterator lumiSectionEntry = lumiSectionEntries_.find(lumiSection);
+    if ( lumiSectionEntry == lumiSectionEntries_.end() ) {
+      lumiSectionEntry = lumiSectionEntries_.insert(std::make_pair(lumiSection, hltPathEntryCollection())).first;
+      buildLumiSectionEntry(hltEvent, lumiSectionEntry->second);
+    }
+    currentLumiSection_ = lumiSection;
+    currentLumiSectionEntry_ = &lumiSectionEntry->second;
+  }
+
+//--- find first HLT path passed by the event
+//    and compute probability to fail HLT and L1 prescales
+  bool isTriggered = false;
+  probFailedPrescale = 1.;
+  for ( hltPathEntryCollection::const_iterator hltPathEntry = currentLumiSectionEntry_->begin();
+	hltPathEntry != currentLumiSectionEntry_->end() && !isTriggered; ++hltPathEntry ) {
+    if ( verbosity_ ) std::cout << "hltPathName = " << hltPathEntry->name_ << std::endl;
+    if ( hltPathEntry->isWildcard_ ) {
+      isTriggered = true;
+      probFailedPrescale = 0.;
+      break;
+    }
+    if ( hltPathEntry->idxPath_ == -1 ) continue;
+    const pat::TriggerPath* hltPath = getPath(hltEvent, *hltPathEntry);
+    if ( hltPath && hltPath->wasAccept() ) {
+      isTriggered = true;
+      double probFailedL1Prescale = 1.;
+      for ( std::vector<l1SeedEntryType>::const_iterator l1SeedEntry = hltPathEntry->l1Seeds_.begin();
+	    l1SeedEntry != hltPathEntry->l1Seeds_.end(); ++l1SeedEntry ) {
+	const pat::TriggerAlgorithm* l1Seed = getAlgorithm(hltEvent, *l1SeedEntry);
+	if ( l1Seed && l1Seed->gtlResult() ) probFailedL1Prescale *= l1SeedEntry->probFailedL1Prescale_;
+      }
+      probFailedPrescale *= (1. - (1./hltPathEntry->hltPrescale_)*(1. - probFailedL1Prescale));
+    }
+  }
+
+  return isTriggered;
+}
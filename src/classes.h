@@ -0,0 +1,10 @@
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMorphedTemplatePdf.h"
+
+namespace {
+  struct TauAnalysis_TauIdEfficiency
+  {
+    TauIdEffHistogramBundle dummyTauIdEffHistogramBundle;
+    TauIdEffMorphedTemplatePdf dummyTauIdEffMorphedTemplatePdf;
+  };
+}
@@ -33,7 +33,7 @@ const pat::Jet* getJet_Tau(const pat::Tau& tau, const pat::JetCollection& patJet
 //
 
 int getGenMatchType(const PATMuTauPair& muTauPair, const reco::GenParticleCollection& genParticles,
-		    double* genTauCharge, double* recTauCharge)
+		    double* genTauCharge, double* recTauCharge, std::string* genTauDecayMode_matched)
 {
 //--- check if reconstructed tau-jet candidate matches "true" hadronic tau decay on generator level,
 //    is a "fake" tau (i.e. matches a quark/gluon/e/mu/photon on generator level)
@@ -59,6 +59,8 @@ int getGenMatchType(const PATMuTauPair& muTauPair, const reco::GenParticleCollec
     getGenTauDecayMode(matchingGenParticle) : "";
   //std::cout << " genTauDecayMode = " << genTauDecayMode << std::endl;
 
+  if ( genTauDecayMode_matched ) (*genTauDecayMode_matched) = genTauDecayMode;
+
   if      ( (matchingGenParticleAbsPdgId >=  1 && matchingGenParticleAbsPdgId <=  6) ||
 	     matchingGenParticleAbsPdgId == 11 || matchingGenParticleAbsPdgId == 22  ||
 	     matchingGenParticleAbsPdgId == 21                                            ) return kJetToTauFakeMatched;
@@ -76,3 +78,62 @@ int getGenMatchType(const PATMuTauPair& muTauPair, const reco::GenParticleCollec
   else                                                                                      return kUnmatched;
 }
 
+
+//
+//-------------------------------------------------------------------------------
+//
+
+void compMuTauPairKinematics(const PATMuTauPair& muTauPair, double tauShiftFactor, muTauPairKinematicsType& kinematics,
+			     const reco::Candidate::LorentzVector* metP4_shifted)
+{
+  const reco::Candidate::LorentzVector& muonP4 = muTauPair.leg1()->p4();
+  const reco::Candidate::LorentzVector& tauP4 = muTauPair.leg2()->p4();
+
+  if ( tauShiftFactor == 1. && !metP4_shifted ) {
+    kinematics.tauPt_     = tauP4.pt();
+    kinematics.visMass_   = (muonP4 + tauP4).mass();
+    kinematics.Mt_        = muTauPair.mt1MET();
+    kinematics.PzetaDiff_ = muTauPair.pZeta() - 1.5*muTauPair.pZetaVis();
+    kinematics.pfMEtPt_   = muTauPair.met()->pt();
+    return;
+  }
+
+  reco::Candidate::LorentzVector tauP4_shifted = tauP4*tauShiftFactor;
+
+//--- take MEt from shifted MEt collection, if given
+//   (the shifted MEt collections account for the shift of all jets in the event, not only of the tau-jet);
+//    else propagate shift of tau-jet momentum to MEt 
+//   (MEt is balanced against the shifted tau-jet momentum in the transverse plane)
+  double metPx, metPy;
+  if ( metP4_shifted ) {
+    metPx = metP4_shifted->px();
+    metPy = metP4_shifted->py();
+  } else {
+    metPx = muTauPair.met()->px() - (tauShiftFactor - 1.)*tauP4.px();
+    metPy = muTauPair.met()->py() - (tauShiftFactor - 1.)*tauP4.py();
+  }
+  double metPt = TMath::Sqrt(metPx*metPx + metPy*metPy);
+
+  kinematics.tauPt_     = tauP4_shifted.pt();
+  kinematics.visMass_   = (muonP4 + tauP4_shifted).mass();
+  kinematics.Mt_        = TMath::Sqrt(TMath::Max(0., 2.*(muonP4.pt()*metPt - (muonP4.px()*metPx + muonP4.py()*metPy))));
+  
+//--- compute projections onto the bisector of muon and tau-jet directions in the transverse plane
+//   (direction of bisector is unchanged by the shift of tau-jet momentum)
+  double muonPx_unit = muonP4.px()/muonP4.pt();
+  double muonPy_unit = muonP4.py()/muonP4.pt();
+  double tauPx_unit  = tauP4.px()/tauP4.pt();
+  double tauPy_unit  = tauP4.py()/tauP4.pt();
+  double zetaX = muonPx_unit + tauPx_unit;
+  double zetaY = muonPy_unit + tauPy_unit;
+  double zetaR = TMath::Sqrt(zetaX*zetaX + zetaY*zetaY);
+  if ( zetaR > 0. ) {
+    zetaX /= zetaR;
+    zetaY /= zetaR;
+  }
+  double pZetaVis = (muonP4.px() + tauP4_shifted.px())*zetaX + (muonP4.py() + tauP4_shifted.py())*zetaY;
+  double pZeta = pZetaVis + metPx*zetaX + metPy*zetaY;
+  kinematics.PzetaDiff_ = pZeta - 1.5*pZetaVis;
+  
+  kinematics.pfMEtPt_   = metPt;
+}
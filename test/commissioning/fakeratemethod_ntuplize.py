@@ -27,6 +27,11 @@ parser.add_argument('--config', help="Configuration file")
 parser.add_argument('--index', help="Sample index")
 parser.add_argument(
     '--kin', help='[tau] or [jet], default = tau', default='jet')
+parser.add_argument(
+    '--format', help='[polymarker] or [tree], default = polymarker.'
+    ' In tree format the points are written into a plain TTree with'
+    ' one branch per variable, which TauFakeRateTrainer reads in batches',
+    default='polymarker')
 
 options=parser.parse_args()
 
@@ -102,9 +107,45 @@ else:
     raise ValueError("bad kinematic var option - use jet or tau!")
 print "Parameterization string:", draw_string
 
+if options.format not in ['polymarker', 'tree']:
+    raise ValueError("bad format option - use polymarker or tree!")
+
 output_file = ROOT.TFile(options.output, "RECREATE")
 output_file.cd()
 
+import array
+
+def write_tree(events, selection, name):
+    " Write points selected by TTree::Draw into a plain TTree "
+    drawn = events.Draw(str(draw_string), str(selection), "goff")
+    print "TTree::Drew ntuple with %i events" % drawn
+    if drawn == events.GetEstimate():
+        raise ValueError("Number of entries produced is at the upper limit " \
+                         "of TTree::Draw.  You need to set events.SetEstimate to " \
+                         "be larger than the total number of selected rows.")
+    # CV: draw_string is of format width:eta:pt,
+    #     values are stored as floats, like in TPolyMarker3D objects
+    output_file.cd()
+    tree = ROOT.TTree(name, name)
+    pt = array.array('f', [0.])
+    eta = array.array('f', [0.])
+    width = array.array('f', [0.])
+    tree.Branch("pt", pt, "pt/F")
+    tree.Branch("absEta", eta, "absEta/F")
+    tree.Branch("jetWidth", width, "jetWidth/F")
+    v_width = events.GetV1()
+    v_eta = events.GetV2()
+    v_pt = events.GetV3()
+    for i in xrange(drawn):
+        pt[0] = v_pt[i]
+        eta[0] = v_eta[i]
+        width[0] = v_width[i]
+        tree.Fill()
+    print "Built '%s' tree with %i entries" % (name, tree.GetEntries())
+    bytes = tree.Write()
+    print "Wrote %i bytes" % bytes
+    tree.IsA().Destructor(tree)
+
 events_list = list(getattr(samples, options.sample).events_and_weights())
 
 # WARNING: current method of filling k-NN tree using TPolyMarker3D objects
@@ -165,6 +206,12 @@ for index, (events, weight) in enumerate(events_list):
     #if index != 1:
     #    continue
     weights[index] = weight/weight_norm
+    if options.format == 'tree':
+        if options.passing:
+            write_tree(events, passing, "passing_%i" % index)
+        if options.failing:
+            write_tree(events, failing, "failing_%i" % index)
+        continue
     if options.passing:
         # Build a TPolyMaker3D with our points
         selected_events = events.Draw(str(draw_string), str(passing))
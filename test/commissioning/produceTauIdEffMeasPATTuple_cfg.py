@@ -15,6 +15,9 @@ pfCandidateCollection = "particleFlow" # pile-up removal disabled
 ##pfCandidateCollection = "pfNoPileUp" # pile-up removal enabled
 ##runSVfit = True
 runSVfit = False
+# store Tau-jet energy shifts/smearing as shift factors,
+# instead of shifted/smeared Tau-jet collections and Muon + Tau-jet pairs
+storeTauShiftFactors = False
 #--------------------------------------------------------------------------------
 
 #--------------------------------------------------------------------------------
@@ -29,7 +32,8 @@ runSVfit = False
 #--------------------------------------------------------------------------------
 
 from TauAnalysis.TauIdEfficiency.produceTauIdEffMeasPATTupleSpecific import produceTauIdEffMeasPATTuple
-produceTauIdEffMeasPATTuple(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit)
+produceTauIdEffMeasPATTuple(process, isMC, isEmbedded, HLTprocessName, pfCandidateCollection, runSVfit,
+                            storeTauShiftFactors = storeTauShiftFactors)
 
 processDumpFile = open('produceTauIdEffMeasPATTuple.dump' , 'w')
 print >> processDumpFile, process.dumpPython()
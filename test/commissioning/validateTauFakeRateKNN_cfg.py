@@ -0,0 +1,47 @@
+import FWCore.ParameterSet.Config as cms
+
+process = cms.PSet()
+
+process.fwliteOutput = cms.PSet(
+    fileName = cms.string('validateTauFakeRateKNN.root')
+)
+
+process.validateTauFakeRateKNN = cms.PSet(
+    samples = cms.VPSet(
+        cms.PSet(
+            name = cms.string('train'),
+            inputFileName = cms.string('train/train_FakeRateMethod_output.root')
+        )
+    ),
+    treeName = cms.string('TestTree'),
+    frWeightName = cms.string('MVA_KNN'),
+    # CV: some entries have weight O(-100) --> skip entries with |fake-rate weight| >= maxAbsFrWeight
+    maxAbsFrWeight = cms.double(1.),
+    variables = cms.VPSet(
+        cms.PSet(
+            name = cms.string('JetPt'),
+            # CV: fake-rates are parametrized either by jet or by tau variables
+            branchNames = cms.vstring('JetPt', 'Pt'),
+            numBinsX = cms.uint32(10),
+            xMin = cms.double(0.),
+            xMax = cms.double(100.)
+        ),
+        cms.PSet(
+            name = cms.string('JetEta'),
+            branchNames = cms.vstring('AbsJetEta', 'AbsEta'),
+            numBinsX = cms.uint32(10),
+            xMin = cms.double(-2.5),
+            xMax = cms.double(+2.5)
+        ),
+        cms.PSet(
+            name = cms.string('JetRadius'),
+            branchNames = cms.vstring('JetWidth'),
+            numBinsX = cms.uint32(10),
+            xMin = cms.double(-0.01),
+            xMax = cms.double(0.51)
+        )
+    ),
+    plotFileName = cms.string('validateTauFakeRateKNN.png'),
+    # number of validation samples processed in parallel
+    numWorkers = cms.uint32(1)
+)
@@ -0,0 +1,11 @@
+import FWCore.ParameterSet.Config as cms
+
+process = cms.PSet()
+
+process.fwliteInput = cms.PSet(
+    fileNames = cms.vstring('/data1/veelken/tmp/muonPtGt20/V4b/analyzeTauIdEffHistograms_all.root')
+)
+    
+process.fwliteOutput = cms.PSet(
+    fileName = cms.string('/data1/veelken/tmp/muonPtGt20/V4b/analyzeTauIdEffHistograms_all_plainTH1.root')
+)
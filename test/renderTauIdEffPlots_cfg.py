@@ -0,0 +1,11 @@
+import FWCore.ParameterSet.Config as cms
+
+process = cms.PSet()
+
+process.fwliteInput = cms.PSet(
+    fileNames = cms.vstring('/data1/veelken/tmp/muonPtGt20/V4b/plots/controlPlotsTauIdEff_tauDiscrHPScombLooseDBcorr_diTauVisMass_plotInputs.root')
+)
+
+process.renderTauIdEffPlots = cms.PSet(
+    numWorkers = cms.uint32(4)
+)
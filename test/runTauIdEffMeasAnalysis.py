@@ -108,6 +108,12 @@ fitIndividualProcesses = False
 fillControlPlots = True
 #fillControlPlots = False
 
+# CV: process central value and all systematic shifts in one pass over the PAT-tuples;
+#     histograms for all systematic shifts are written to the output file of the central value,
+#     which is the only FWLiteTauIdEffAnalyzer output file per sample merged by 'hadd' in this case
+processSysShiftsInSingleJob = True
+#processSysShiftsInSingleJob = False
+
 tauIds = {
     # HPS combined isolation discriminators
     # (based on isolation sumPt of PFChargedHadrons + PFGammas)
@@ -507,7 +513,8 @@ for sampleToAnalyze in samplesToAnalyze:
                                              tauChargeMode, disableTauCandPreselCuts,
                                              cut_muonPtMin, cut_tauLeadTrackPtMin, cut_tauAbsIsoMax, cut_caloMEtPtMin, cut_pfMEtPtMin,
                                              plot_hltPaths,
-                                             fillControlPlots)
+                                             fillControlPlots,
+                                             processSysShiftsInSingleJob = processSysShiftsInSingleJob)
 
     if retVal_FWLiteTauIdEffAnalyzer is None:
         continue
@@ -0,0 +1,202 @@
+/*
+ * Compare the templates morphed by TauIdEffMorphedTemplatePdf
+ * to the templates morphed by VerticalInterpPdf (vertical morphing) and RooIntegralMorph (horizontal morphing),
+ * which have been used by fitTauIdEff before, for the morphing parameter at the "down", nominal and "up" values,
+ * and to hand-computed expectations for fractional values of the morphing parameter
+ */
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffMorphedTemplatePdf.h"
+
+#include "HiggsAnalysis/CombinedLimit/interface/VerticalInterpPdf.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "RooAbsPdf.h"
+#include "RooArgList.h"
+#include "RooArgSet.h"
+#include "RooDataHist.h"
+#include "RooGlobalFunc.h"
+#include "RooHistPdf.h"
+#include "RooIntegralMorph.h"
+#include "RooRealVar.h"
+
+#include <TH1.h>
+#include <TMath.h>
+#include <TString.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+TH1* makeTemplateHistogram(const std::string& name, double norm, double mean, double sigma)
+{
+  TH1* histogram = new TH1D(name.data(), name.data(), 20, 0., 200.);
+  for ( int iBin = 1; iBin <= histogram->GetNbinsX(); ++iBin ) {
+    double x = histogram->GetBinCenter(iBin);
+    histogram->SetBinContent(iBin, norm*TMath::Gaus(x, mean, sigma, true)*histogram->GetBinWidth(iBin));
+  }
+  return histogram;
+}
+
+TH1* makeBoxHistogram(const std::string& name, double norm, double xMin, double xMax)
+{
+  TH1* histogram = new TH1D(name.data(), name.data(), 20, 0., 200.);
+  for ( int iBin = 1; iBin <= histogram->GetNbinsX(); ++iBin ) {
+    double x = histogram->GetBinCenter(iBin);
+    if ( x > xMin && x < xMax ) histogram->SetBinContent(iBin, norm*histogram->GetBinWidth(iBin)/(xMax - xMin));
+  }
+  return histogram;
+}
+
+RooHistPdf* makeRooHistPdf(TH1* histogram, RooRealVar& x)
+{
+  std::string dataHistName = std::string(histogram->GetName()).append("_dataHist");
+  RooDataHist* dataHist = new RooDataHist(dataHistName.data(), dataHistName.data(), x, histogram);
+  std::string pdfName = std::string(histogram->GetName()).append("_histPdf");
+  return new RooHistPdf(pdfName.data(), pdfName.data(), x, *dataHist);
+}
+
+std::vector<double> getBinFractions(RooAbsPdf& pdf, RooRealVar& x, const TH1* histogram)
+{
+  std::vector<double> binFractions;
+  for ( int iBin = 1; iBin <= histogram->GetNbinsX(); ++iBin ) {
+    std::string rangeName = Form("bin%i", iBin);
+    x.setRange(rangeName.data(), histogram->GetBinLowEdge(iBin), histogram->GetBinLowEdge(iBin) + histogram->GetBinWidth(iBin));
+    RooAbsReal* integral = pdf.createIntegral(x, RooFit::NormSet(x), RooFit::Range(rangeName.data()));
+    binFractions.push_back(integral->getVal());
+    delete integral;
+  }
+  return binFractions;
+}
+
+std::vector<double> getBinFractions(const TH1* histogram)
+{
+  std::vector<double> binFractions;
+  for ( int iBin = 1; iBin <= histogram->GetNbinsX(); ++iBin ) {
+    binFractions.push_back(histogram->GetBinContent(iBin)/histogram->Integral());
+  }
+  return binFractions;
+}
+
+bool compareBinFractions(const std::vector<double>& binFractions_test, const std::vector<double>& binFractions_ref, 
+			 double tolerance, const std::string& label)
+{
+  bool isPassed = true;
+  for ( size_t iBin = 0; iBin < binFractions_ref.size(); ++iBin ) {
+    if ( TMath::Abs(binFractions_test[iBin] - binFractions_ref[iBin]) > tolerance ) {
+      std::cerr << label << ": bin " << (iBin + 1) << " differs,"
+		<< " TauIdEffMorphedTemplatePdf = " << binFractions_test[iBin] << ", reference = " << binFractions_ref[iBin] << " !!" << std::endl;
+      isPassed = false;
+    }
+  }
+  return isPassed;
+}
+
+int main(int argc, const char* argv[])
+{
+  bool isPassed = true;
+
+  try {
+    RooRealVar x("x", "x", 0., 200.);
+    x.setBins(20);
+
+    TH1* histogram_central = makeTemplateHistogram("central", 1000., 80., 20.);
+    TH1* histogram_up      = makeTemplateHistogram("up",      1100., 90., 25.);
+    TH1* histogram_down    = makeTemplateHistogram("down",     900., 70., 15.);
+
+//--- vertical morphing: alpha = -1, 0, +1 correspond to "down", "central" and "up" template
+    RooRealVar alphaVertical("alphaVertical", "alphaVertical", 0., -1., +1.);
+    std::vector<const TH1*> histograms_up(1, histogram_up);
+    std::vector<const TH1*> histograms_down(1, histogram_down);
+    TauIdEffMorphedTemplatePdf pdfVertical("pdfVertical", "pdfVertical", x, 
+					   histogram_central, histograms_up, histograms_down, RooArgList(alphaVertical));
+    RooArgList pdfsVerticalInterp;
+    pdfsVerticalInterp.add(*makeRooHistPdf(histogram_central, x));
+    pdfsVerticalInterp.add(*makeRooHistPdf(histogram_up, x));
+    pdfsVerticalInterp.add(*makeRooHistPdf(histogram_down, x));
+    VerticalInterpPdf pdfVertical_ref("pdfVertical_ref", "pdfVertical_ref", pdfsVerticalInterp, RooArgList(alphaVertical));
+
+    double alphaValuesVertical[] = { -1., 0., +1. };
+    const TH1* histogramsVertical[] = { histogram_down, histogram_central, histogram_up };
+    for ( int iAlpha = 0; iAlpha < 3; ++iAlpha ) {
+      alphaVertical.setVal(alphaValuesVertical[iAlpha]);
+      std::string label = Form("vertical morphing, alpha = %+1.0f", alphaValuesVertical[iAlpha]);
+      std::vector<double> binFractions = getBinFractions(pdfVertical, x, histogram_central);
+      isPassed &= compareBinFractions(binFractions, getBinFractions(pdfVertical_ref, x, histogram_central), 1.e-6, 
+				      std::string(label).append(" (VerticalInterpPdf)"));
+      isPassed &= compareBinFractions(binFractions, getBinFractions(histogramsVertical[iAlpha]), 1.e-6, 
+				      std::string(label).append(" (template)"));
+    }
+
+//--- vertical morphing for fractional alpha:
+//    expected bin fractions are f_central + alpha*(f_up - f_central) for alpha > 0
+//    and f_central + alpha*(f_central - f_down) for alpha < 0, computed from the templates normalized to unit area
+    std::vector<double> binFractions_central = getBinFractions(histogram_central);
+    std::vector<double> binFractions_up = getBinFractions(histogram_up);
+    std::vector<double> binFractions_down = getBinFractions(histogram_down);
+    double alphaValuesVertical_fractional[] = { 0.5, -0.3 };
+    for ( int iAlpha = 0; iAlpha < 2; ++iAlpha ) {
+      double alpha = alphaValuesVertical_fractional[iAlpha];
+      alphaVertical.setVal(alpha);
+      std::string label = Form("vertical morphing, alpha = %+1.1f", alpha);
+      std::vector<double> binFractions_expected;
+      for ( size_t iBin = 0; iBin < binFractions_central.size(); ++iBin ) {
+	double shift = ( alpha > 0. ) ? 
+	  (binFractions_up[iBin] - binFractions_central[iBin]) : (binFractions_central[iBin] - binFractions_down[iBin]);
+	binFractions_expected.push_back(binFractions_central[iBin] + alpha*shift);
+      }
+      std::vector<double> binFractions = getBinFractions(pdfVertical, x, histogram_central);
+      isPassed &= compareBinFractions(binFractions, getBinFractions(pdfVertical_ref, x, histogram_central), 1.e-6, 
+				      std::string(label).append(" (VerticalInterpPdf)"));
+      isPassed &= compareBinFractions(binFractions, binFractions_expected, 1.e-6, 
+				      std::string(label).append(" (expected)"));
+    }
+
+//--- horizontal morphing: alpha = 0, 0.5, 1 correspond to "down" template, halfway between "down" and "up" and "up" template
+//   (RooIntegralMorph samples the morphed template on a grid, so results agree only within the sampling precision)
+    RooRealVar alphaHorizontal("alphaHorizontal", "alphaHorizontal", 0.5, 0., 1.);
+    TauIdEffMorphedTemplatePdf pdfHorizontal("pdfHorizontal", "pdfHorizontal", x, histogram_up, histogram_down, alphaHorizontal);
+    RooIntegralMorph pdfHorizontal_ref("pdfHorizontal_ref", "pdfHorizontal_ref", 
+				       *makeRooHistPdf(histogram_up, x), *makeRooHistPdf(histogram_down, x), x, alphaHorizontal);
+    pdfHorizontal_ref.setCacheAlpha(true);
+
+    double alphaValuesHorizontal[] = { 0., 0.5, 1. };
+    for ( int iAlpha = 0; iAlpha < 3; ++iAlpha ) {
+      alphaHorizontal.setVal(alphaValuesHorizontal[iAlpha]);
+      std::string label = Form("horizontal morphing, alpha = %1.1f", alphaValuesHorizontal[iAlpha]);
+      std::vector<double> binFractions = getBinFractions(pdfHorizontal, x, histogram_central);
+      isPassed &= compareBinFractions(binFractions, getBinFractions(pdfHorizontal_ref, x, histogram_central), 1.e-2, 
+				      std::string(label).append(" (RooIntegralMorph)"));
+      if ( alphaValuesHorizontal[iAlpha] == 0. ) 
+	isPassed &= compareBinFractions(binFractions, getBinFractions(histogram_down), 1.e-6, std::string(label).append(" (template)"));
+      if ( alphaValuesHorizontal[iAlpha] == 1. ) 
+	isPassed &= compareBinFractions(binFractions, getBinFractions(histogram_up), 1.e-6, std::string(label).append(" (template)"));
+    }
+
+//--- horizontal morphing for fractional alpha, using uniform templates:
+//    "down" template uniform in [20,60], "up" template uniform in [100,180];
+//    the cumulative distribution of the morphed template reaches value y at x = alpha*(100 + 80*y) + (1 - alpha)*(20 + 40*y),
+//    so that for alpha = 0.25 the morphed template is uniform in [40,90], i.e. has bin fractions 0.2 for bins 5 to 9
+//   (had the convention been reversed, the morphed template would be uniform in [80,150])
+    TH1* histogramBox_up   = makeBoxHistogram("box_up",   1100., 100., 180.);
+    TH1* histogramBox_down = makeBoxHistogram("box_down",  900.,  20.,  60.);
+    TauIdEffMorphedTemplatePdf pdfHorizontalBox("pdfHorizontalBox", "pdfHorizontalBox", x, histogramBox_up, histogramBox_down, alphaHorizontal);
+    alphaHorizontal.setVal(0.25);
+    std::vector<double> binFractionsBox_expected(histogramBox_up->GetNbinsX(), 0.);
+    for ( int iBin = 5; iBin <= 9; ++iBin ) {
+      binFractionsBox_expected[iBin - 1] = 0.2;
+    }
+    isPassed &= compareBinFractions(getBinFractions(pdfHorizontalBox, x, histogramBox_up), binFractionsBox_expected, 1.e-6, 
+				    "horizontal morphing, alpha = 0.25 (expected)");
+  } catch ( cms::Exception& e ) {
+    std::cerr << e.what() << std::endl;
+    isPassed = false;
+  }
+
+  if ( !isPassed ) {
+    std::cerr << "testTauIdEffMorphedTemplatePdf: FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "testTauIdEffMorphedTemplatePdf: passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * Check that results restored from TauIdEffResultCache (cache hit)
+ * are identical to the results obtained by processing the input file (cache miss),
+ * for histograms attached to a directory as well as for histograms registered with a TauIdEffHistogramBundle,
+ * and that luminosity sections split across input files are counted once only,
+ * independent of which input files are taken from the cache
+ */
+
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffResultCache.h"
+#include "TauAnalysis/TauIdEfficiency/interface/TauIdEffHistogramBundle.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TFile.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TSystem.h>
+#include <TString.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+struct jobResultType
+{
+  bool isCacheHit_;
+  std::vector<double> binContents_;
+  int numEvents_;
+};
+
+jobResultType runJob(const std::string& workDirectory, const std::string& inputFileName, bool writeHistogramBundle)
+{
+  TFile* outputFile = new TFile(Form("%s/output.root", workDirectory.data()), "RECREATE");
+  TDirectory* outputDirectory = outputFile->mkdir("region");
+
+  TH1* histogram = 0;
+  if ( writeHistogramBundle ) {
+    TauIdEffHistogramBundle* bundle = new TauIdEffHistogramBundle(TauIdEffHistogramBundle::defaultName(), "");
+    outputDirectory->Append(bundle);
+    histogram = new TH1D("diTauVisMass", "diTauVisMass", 5, -0.5, 4.5);
+    histogram->Sumw2();
+    bundle->addHistogram(histogram);
+  } else {
+    outputDirectory->cd();
+    histogram = new TH1D("diTauVisMass", "diTauVisMass", 5, -0.5, 4.5);
+    histogram->Sumw2();
+  }
+  int numEvents = 0;
+
+  jobResultType jobResult;
+  {
+    TauIdEffResultCache resultCache(std::string(workDirectory).append("/cache"), "configDigest", outputFile);
+    resultCache.addCounter("numEvents", &numEvents);
+    jobResult.isCacheHit_ = resultCache.load(inputFileName);
+    if ( !jobResult.isCacheHit_ ) {
+      resultCache.beginFile();
+      histogram->Fill(1., 2.);
+      histogram->Fill(3., 0.5);
+      histogram->Fill(3.);
+      numEvents = 3;
+      resultCache.endFile(inputFileName);
+    }
+    resultCache.finish();
+  }
+
+  for ( int iBin = 0; iBin <= (histogram->GetNbinsX() + 1); ++iBin ) {
+    jobResult.binContents_.push_back(histogram->GetBinContent(iBin));
+  }
+  jobResult.numEvents_ = numEvents;
+
+  delete outputFile;
+
+  return jobResult;
+}
+
+bool checkCacheHit(const std::string& workDirectory, bool writeHistogramBundle)
+{
+  std::string inputFileName = std::string(workDirectory).append("/input.root");
+  std::ofstream inputFile(inputFileName.data());
+  inputFile << "dummy input file" << std::endl;
+  inputFile.close();
+
+  std::string label = ( writeHistogramBundle ) ? "histogram bundle" : "plain histograms";
+
+  jobResultType jobResult_miss = runJob(workDirectory, inputFileName, writeHistogramBundle);
+  jobResultType jobResult_hit = runJob(workDirectory, inputFileName, writeHistogramBundle);
+
+  bool isFailed = false;
+  if ( jobResult_miss.isCacheHit_ || !jobResult_hit.isCacheHit_ ) {
+    std::cerr << label << ": expected cache miss followed by cache hit !!" << std::endl;
+    isFailed = true;
+  }
+  if ( jobResult_hit.numEvents_ != jobResult_miss.numEvents_ ) {
+    std::cerr << label << ": event counter differs, cache miss = " << jobResult_miss.numEvents_ << ","
+	      << " cache hit = " << jobResult_hit.numEvents_ << " !!" << std::endl;
+    isFailed = true;
+  }
+  double integral_miss = 0.;
+  for ( size_t iBin = 0; iBin < jobResult_miss.binContents_.size(); ++iBin ) {
+    integral_miss += jobResult_miss.binContents_[iBin];
+    if ( jobResult_hit.binContents_[iBin] != jobResult_miss.binContents_[iBin] ) {
+      std::cerr << label << ": bin " << iBin << " differs, cache miss = " << jobResult_miss.binContents_[iBin] << ","
+		<< " cache hit = " << jobResult_hit.binContents_[iBin] << " !!" << std::endl;
+      isFailed = true;
+    }
+  }
+  if ( integral_miss != 3.5 ) {
+    std::cerr << label << ": histogram not filled, integral = " << integral_miss << " !!" << std::endl;
+    isFailed = true;
+  }
+
+  gSystem->Exec(Form("rm -rf %s/cache %s/output.root %s", workDirectory.data(), workDirectory.data(), inputFileName.data()));
+
+  return !isFailed;
+}
+
+//--- luminosity sections (run, ls, integrated luminosity) contained in input files 'A' and 'B';
+//    luminosity section 2 is split across the two files
+struct lumiBlockType
+{
+  unsigned run_;
+  unsigned ls_;
+  double intLumi_;
+};
+
+std::vector<lumiBlockType> getLumiBlocks(const std::string& inputFileLabel)
+{
+  std::vector<lumiBlockType> lumiBlocks;
+  lumiBlockType lumiBlock;
+  lumiBlock.run_ = 1;
+  if ( inputFileLabel == "A" ) {
+    lumiBlock.ls_ = 1;
+    lumiBlock.intLumi_ = 10.;
+    lumiBlocks.push_back(lumiBlock);
+  }
+  lumiBlock.ls_ = 2;
+  lumiBlock.intLumi_ = 5.;
+  lumiBlocks.push_back(lumiBlock);
+  if ( inputFileLabel == "B" ) {
+    lumiBlock.ls_ = 3;
+    lumiBlock.intLumi_ = 7.;
+    lumiBlocks.push_back(lumiBlock);
+  }
+  return lumiBlocks;
+}
+
+double runLumiJob(const std::string& workDirectory, const std::vector<std::string>& inputFileLabels)
+{
+  TFile* outputFile = new TFile(Form("%s/output.root", workDirectory.data()), "RECREATE");
+  outputFile->cd();
+  new TH1D("numEventsProcessed", "numEventsProcessed", 3, -0.5, 2.5);
+  double intLumi = 0.;
+
+  {
+    TauIdEffResultCache resultCache(std::string(workDirectory).append("/cache"), "configDigest", outputFile);
+    resultCache.addLumiBlockCounter("intLumi", &intLumi);
+    for ( std::vector<std::string>::const_iterator inputFileLabel = inputFileLabels.begin();
+	  inputFileLabel != inputFileLabels.end(); ++inputFileLabel ) {
+      std::string inputFileName = Form("%s/input%s.root", workDirectory.data(), inputFileLabel->data());
+      if ( resultCache.load(inputFileName) ) continue;
+      resultCache.beginFile();
+      std::vector<lumiBlockType> lumiBlocks = getLumiBlocks(*inputFileLabel);
+      for ( std::vector<lumiBlockType>::const_iterator lumiBlock = lumiBlocks.begin();
+	    lumiBlock != lumiBlocks.end(); ++lumiBlock ) {
+	intLumi += lumiBlock->intLumi_;
+	resultCache.addLumiBlock(lumiBlock->run_, lumiBlock->ls_, std::vector<double>(1, lumiBlock->intLumi_));
+      }
+      resultCache.endFile(inputFileName);
+    }
+    resultCache.finish();
+  }
+
+  delete outputFile;
+
+  return intLumi;
+}
+
+bool checkSplitLumiBlocks(const std::string& workDirectory)
+{
+  std::vector<std::string> inputFileLabels;
+  inputFileLabels.push_back("A");
+  inputFileLabels.push_back("B");
+  for ( std::vector<std::string>::const_iterator inputFileLabel = inputFileLabels.begin();
+	inputFileLabel != inputFileLabels.end(); ++inputFileLabel ) {
+    std::ofstream inputFile(Form("%s/input%s.root", workDirectory.data(), inputFileLabel->data()));
+    inputFile << "dummy input file " << (*inputFileLabel) << std::endl;
+    inputFile.close();
+  }
+
+  const double intLumi_expected = 22.;
+
+  bool isFailed = false;
+  for ( std::vector<std::string>::const_iterator inputFileLabel_cached = inputFileLabels.begin();
+	inputFileLabel_cached != inputFileLabels.end(); ++inputFileLabel_cached ) {
+    gSystem->Exec(Form("rm -rf %s/cache", workDirectory.data()));
+
+//--- fill cache for one of the two input files first,
+//    then process the other one with the first taken from the cache, and finally take both from the cache
+    runLumiJob(workDirectory, std::vector<std::string>(1, *inputFileLabel_cached));
+    double intLumi_partial = runLumiJob(workDirectory, inputFileLabels);
+    double intLumi_full = runLumiJob(workDirectory, inputFileLabels);
+    if ( intLumi_partial != intLumi_expected || intLumi_full != intLumi_expected ) {
+      std::cerr << "split luminosity sections, input file " << (*inputFileLabel_cached) << " cached first:"
+		<< " intLumi = " << intLumi_partial << " (partially cached), " << intLumi_full << " (fully cached),"
+		<< " expected = " << intLumi_expected << " !!" << std::endl;
+      isFailed = true;
+    }
+  }
+
+  gSystem->Exec(Form("rm -rf %s/cache %s/output.root %s/inputA.root %s/inputB.root", 
+		     workDirectory.data(), workDirectory.data(), workDirectory.data(), workDirectory.data()));
+
+  return !isFailed;
+}
+
+int main(int argc, const char* argv[])
+{
+  std::string workDirectory = Form("%s/testTauIdEffResultCache_%i", gSystem->TempDirectory(), (int)getpid());
+  gSystem->mkdir(workDirectory.data(), true);
+
+  bool isPassed = true;
+  try {
+    isPassed &= checkCacheHit(workDirectory, false);
+    isPassed &= checkCacheHit(workDirectory, true);
+    isPassed &= checkSplitLumiBlocks(workDirectory);
+  } catch ( cms::Exception& e ) {
+    std::cerr << e.what() << std::endl;
+    isPassed = false;
+  }
+
+  gSystem->Exec(Form("rm -rf %s", workDirectory.data()));
+
+  if ( !isPassed ) {
+    std::cerr << "testTauIdEffResultCache: FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "testTauIdEffResultCache: passed" << std::endl;
+  return 0;
+}